@@ -1,9 +1,18 @@
 /*
  * Facility for queueing callback functions to be run from the
  * top-level event loop after the current top-level activity finishes.
+ *
+ * Other threads can queue callbacks too. Those go on a separate
+ * lock-free stack: each producer thread pushes with a compare-and-swap,
+ * and the main thread takes the whole stack at once with an atomic
+ * swap. (Since nothing ever pops a single element, the usual ABA
+ * problem with lock-free stacks doesn't arise.) The main thread then
+ * reverses what it took, to recover the order the callbacks were
+ * queued in, and moves them on to the ordinary queue.
  */
 
 #include <stddef.h>
+#include <assert.h>
 
 #include "putty.h"
 
@@ -16,6 +25,9 @@ struct callback {
 
 static struct callback *cbcurr = NULL, *cbhead = NULL, *cbtail = NULL;
 
+/* Callbacks from other threads not yet collected, newest first */
+static struct callback *thread_cbs = NULL;
+
 static toplevel_callback_notify_fn_t notify_frontend = NULL;
 static void *notify_ctx = NULL;
 
@@ -26,6 +38,13 @@ void request_callback_notifications(toplevel_callback_notify_fn_t fn,
     notify_ctx = ctx;
 }
 
+static thread_wakeup_fn_t thread_wakeup = NULL;
+
+void request_thread_wakeups(thread_wakeup_fn_t wakeup)
+{
+    thread_wakeup = wakeup;
+}
+
 static void run_idempotent_callback(void *ctx)
 {
     struct IdempotentCallback *ic = (struct IdempotentCallback *)ctx;
@@ -45,6 +64,9 @@ void delete_callbacks_for_context(void *ctx)
 {
     struct callback *newhead, *newtail;
 
+    /* Catch any callbacks for ctx still on their way from a thread */
+    collect_toplevel_callbacks_from_threads();
+
     newhead = newtail = NULL;
     while (cbhead) {
         struct callback *cb = cbhead;
@@ -69,14 +91,8 @@ void delete_callbacks_for_context(void *ctx)
         newtail->next = NULL;
 }
 
-void queue_toplevel_callback(toplevel_callback_fn_t fn, void *ctx)
+static void enqueue_callback(struct callback *cb)
 {
-    struct callback *cb;
-
-    cb = snew(struct callback);
-    cb->fn = fn;
-    cb->ctx = ctx;
-
     /*
      * If the front end has requested notification of pending
      * callbacks, and we didn't already have one queued, let it know
@@ -99,6 +115,67 @@ void queue_toplevel_callback(toplevel_callback_fn_t fn, void *ctx)
     cb->next = NULL;
 }
 
+void queue_toplevel_callback(toplevel_callback_fn_t fn, void *ctx)
+{
+    struct callback *cb;
+
+    cb = snew(struct callback);
+    cb->fn = fn;
+    cb->ctx = ctx;
+    enqueue_callback(cb);
+}
+
+void queue_toplevel_callback_from_thread(toplevel_callback_fn_t fn,
+                                         void *ctx)
+{
+    struct callback *cb, *head, *prev;
+
+    cb = snew(struct callback);
+    cb->fn = fn;
+    cb->ctx = ctx;
+
+    /*
+     * Guess that the stack is empty, and correct the guess from what
+     * the compare-and-swap found there if it wasn't.
+     */
+    head = NULL;
+    while (true) {
+        cb->next = head;
+        prev = ATOMIC_PTR_CAS(&thread_cbs, head, cb);
+        if (prev == head)
+            break;
+        head = prev;
+    }
+
+    /*
+     * The main thread only needs waking when the stack goes from
+     * empty to non-empty, because it will collect everything on the
+     * stack when it gets round to it.
+     */
+    assert(thread_wakeup && "thread_wakeup_setup was not called");
+    if (!head)
+        thread_wakeup();
+}
+
+void collect_toplevel_callbacks_from_threads(void)
+{
+    struct callback *cb, *list, *reversed = NULL;
+
+    list = ATOMIC_PTR_SWAP(&thread_cbs, NULL);
+    while (list) {
+        cb = list;
+        list = cb->next;
+        cb->next = reversed;
+        reversed = cb;
+    }
+
+    while (reversed) {
+        cb = reversed;
+        reversed = cb->next;
+        enqueue_callback(cb);
+    }
+}
+
 bool run_toplevel_callbacks(void)
 {
     bool done_something = false;
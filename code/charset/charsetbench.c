@@ -0,0 +1,240 @@
+/*
+ * charsetbench.c - throughput benchmark for conversion to Unicode.
+ *
+ * Usage: charsetbench [-t seconds] [-s size] [charset...]
+ *
+ * Each charset is given by its local name (as in localenc.c), and
+ * the default is a representative selection. For each one, three
+ * kinds of input are converted: plain ASCII, text typical of the
+ * charset (for UTF-8, a mixture of scripts with characters of every
+ * encoded length), and random bytes, which contain plenty of errors.
+ * Each is converted both as a whole buffer in one call, and one byte
+ * per call as a terminal reading a byte stream would.
+ *
+ * Before measuring anything, every charset the library knows about is
+ * checked to make sure the two methods produce the same output, since
+ * they go through different code. If they don't, the program reports
+ * the difference and exits with status 1.
+ *
+ * Output is one line per measurement, with tab-separated fields:
+ *
+ *   charset  input  method  size  iterations  seconds  MB/s
+ *
+ * where the MB/s figure counts input bytes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "charset.h"
+#include "internal.h"
+
+static double duration = 0.1;
+
+static unsigned long rngstate = 1;
+static unsigned rng(void)
+{
+    rngstate = rngstate * 1103515245 + 12345;
+    return (rngstate >> 16) & 0x7FFF;
+}
+
+enum { IN_ASCII, IN_TEXT, IN_RANDOM, N_INPUTS };
+static const char *const input_names[] = { "ascii", "text", "random" };
+
+/* Append the UTF-8 encoding of c to p, and return the new end */
+static char *put_utf8(char *p, unsigned long c)
+{
+    wchar_t wc = c;
+    const wchar_t *wp = &wc;
+    int wlen = 1;
+    return p + charset_from_unicode(&wp, &wlen, p, 8, CS_UTF8, NULL, NULL, 0);
+}
+
+static void make_input(char *buf, int size, int charset, int kind)
+{
+    char *p = buf, *end = buf + size;
+
+    while (p < end) {
+        unsigned r = rng();
+        char tmp[8], *q = tmp;
+
+        if (kind == IN_RANDOM) {
+            *q++ = r;
+        } else if (kind == IN_ASCII || r % 8 < 5) {
+            *q++ = (r % 16 == 0 ? '\n' : ' ' + r % 95);
+        } else if (charset != CS_UTF8) {
+            *q++ = 0xA0 + r % 0x60;
+        } else {
+            switch (r % 8) {
+              case 5: q = put_utf8(q, 0xC0 + r % 0x40); break;   /* Latin-1 */
+              case 6: q = put_utf8(q, 0x410 + r % 0x40); break;  /* Cyrillic */
+              case 7:
+                if (r % 64 == 7)
+                    q = put_utf8(q, 0x1F600 + r % 0x50);     /* emoji */
+                else
+                    q = put_utf8(q, 0x4E00 + r % 0x5000);    /* CJK */
+                break;
+            }
+        }
+
+        if (q - tmp > end - p)
+            q = tmp + (end - p);
+        memcpy(p, tmp, q - tmp);
+        p += q - tmp;
+    }
+}
+
+/* Convert a whole buffer, in as few calls as possible */
+static int convert_buffer(const char *buf, int size, int charset,
+                          wchar_t *out, int outlen)
+{
+    charset_state state = { 0 };
+    int n = 0;
+
+    while (size > 0)
+        n += charset_to_unicode(&buf, &size, out + n, outlen - n,
+                                charset, &state, NULL, 0);
+    return n;
+}
+
+/* Convert a buffer one byte per call */
+static int convert_bytewise(const char *buf, int size, int charset,
+                            wchar_t *out, int outlen)
+{
+    charset_state state = { 0 };
+    int n = 0;
+
+    while (size > 0) {
+        int len = 1;
+        n += charset_to_unicode(&buf, &len, out + n, outlen - n,
+                                charset, &state, NULL, 0);
+        size--;
+    }
+    return n;
+}
+
+static int check(int charset, const char *buf, int size,
+                 wchar_t *out1, wchar_t *out2)
+{
+    int n1 = convert_buffer(buf, size, charset, out1, 2 * size);
+    int n2 = convert_bytewise(buf, size, charset, out2, 2 * size);
+    int i;
+
+    for (i = 0; i < n1 && i < n2; i++)
+        if (out1[i] != out2[i])
+            break;
+    if (i < n1 || i < n2) {
+        printf("# %s: mismatch at output character %d: "
+               "buffer gave %04lx, bytewise gave %04lx\n",
+               charset_to_localenc(charset), i,
+               i < n1 ? (unsigned long)out1[i] : 0UL,
+               i < n2 ? (unsigned long)out2[i] : 0UL);
+        return 1;
+    }
+    return 0;
+}
+
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void measure(int charset, int kind, int bytewise,
+                    const char *buf, int size, wchar_t *out)
+{
+    unsigned long iterations = 0, batch = 1, i;
+    clock_t start;
+    double secs;
+
+    /* warm up */
+    (bytewise ? convert_bytewise : convert_buffer)(
+        buf, size, charset, out, 2 * size);
+
+    start = clock();
+    while (1) {
+        for (i = 0; i < batch; i++)
+            (bytewise ? convert_bytewise : convert_buffer)(
+                buf, size, charset, out, 2 * size);
+        iterations += batch;
+        if ((secs = seconds_since(start)) >= duration)
+            break;
+        if (secs < duration / 64)
+            batch *= 2;
+    }
+
+    printf("%s\t%s\t%s\t%d\t%lu\t%.4f\t%.2f\n", charset_to_localenc(charset),
+           input_names[kind], bytewise ? "bytewise" : "buffer", size,
+           iterations, secs, (double)iterations * size / secs / 1e6);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    static const char *const defaults[] = {
+        "UTF-8", "ISO-8859-1", "ISO-8859-5", "CP437",
+    };
+    const char *names[64];
+    int nnames = 0, size = 16384, errs = 0, i, cs, kind;
+    char *buf;
+    wchar_t *out1, *out2;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t") && i+1 < argc) {
+            duration = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") && i+1 < argc) {
+            size = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: charsetbench [-t seconds] [-s size] "
+                    "[charset...]\n");
+            return 1;
+        } else if (nnames < (int)lenof(names)) {
+            names[nnames++] = argv[i];
+        }
+    }
+    if (size <= 0 || duration <= 0) {
+        fprintf(stderr, "charsetbench: bad size or duration\n");
+        return 1;
+    }
+    if (!nnames) {
+        for (i = 0; i < (int)lenof(defaults); i++)
+            names[nnames++] = defaults[i];
+    }
+
+    buf = malloc(size);
+    out1 = malloc(2 * size * sizeof(wchar_t));
+    out2 = malloc(2 * size * sizeof(wchar_t));
+    if (!buf || !out1 || !out2) {
+        fprintf(stderr, "charsetbench: out of memory\n");
+        return 1;
+    }
+
+    for (i = 0; (cs = charset_localenc_nth(i)) != CS_NONE; i++) {
+        for (kind = 0; kind < N_INPUTS; kind++) {
+            make_input(buf, size, cs, kind);
+            errs += check(cs, buf, size, out1, out2);
+        }
+    }
+    if (errs)
+        return 1;
+    printf("# all charsets: buffer and bytewise conversion agree\n");
+
+    printf("# charset\tinput\tmethod\tsize\titerations\tseconds\tMB/s\n");
+    for (i = 0; i < nnames; i++) {
+        if ((cs = charset_from_localenc(names[i])) == CS_NONE) {
+            printf("# %s: unknown charset\n", names[i]);
+            continue;
+        }
+        for (kind = 0; kind < N_INPUTS; kind++) {
+            make_input(buf, size, cs, kind);
+            measure(cs, kind, 0, buf, size, out1);
+            measure(cs, kind, 1, buf, size, out1);
+        }
+    }
+
+    free(buf);
+    free(out1);
+    free(out2);
+    return 0;
+}
@@ -36,6 +36,19 @@ struct charset_spec {
                   charset_state *state,
                   void (*emit)(void *ctx, long int output), void *emitctx);
     void const *data;
+    /*
+     * Optionally, a function to convert a whole buffer to Unicode
+     * in one go, which charset_to_unicode uses in preference to
+     * calling `read' once per byte. It's only called when the state
+     * is zero, and must leave it zero. It advances `input' and
+     * `output' and decrements `inlen' and `outlen' to show how far
+     * it got, and may stop at any point it likes: on anything that
+     * would be an error, or a multibyte character that runs off the
+     * end of the input, it should stop and leave that to `read'.
+     */
+    void (*read_bulk)(charset_spec const *charset,
+                      const unsigned char **input, int *inlen,
+                      wchar_t **output, int *outlen);
 };
 
 /*
@@ -67,6 +80,13 @@ struct sbcs_data {
      */
     unsigned char ucs2sbcs[256];
     int nvalid;
+
+    /*
+     * Nonzero if the bottom half of sbcs2ucs is the identity
+     * mapping, so that read_sbcs_bulk can convert runs of ASCII
+     * without looking them up.
+     */
+    int ascii_compatible;
 };
 
 /*
@@ -79,6 +99,10 @@ void read_sbcs(charset_spec const *charset, long int input_chr,
 void write_sbcs(charset_spec const *charset, long int input_chr,
                 charset_state *state,
                 void (*emit)(void *ctx, long int output), void *emitctx);
+void read_sbcs_bulk(charset_spec const *charset,
+                    const unsigned char **input, int *inlen,
+                    wchar_t **output, int *outlen);
+int widen_ascii(const unsigned char *input, int len, wchar_t *output);
 
 /*
  * Placate compiler warning about unused parameters, of which we
@@ -23,6 +23,43 @@ void read_sbcs(charset_spec const *charset, long int input_chr,
     emit(emitctx, sd->sbcs2ucs[input_chr]);
 }
 
+void read_sbcs_bulk(charset_spec const *charset,
+                    const unsigned char **input, int *inlen,
+                    wchar_t **output, int *outlen)
+{
+    const struct sbcs_data *sd = charset->data;
+    const unsigned char *p = *input;
+    wchar_t *q = *output;
+    int len = (*inlen < *outlen ? *inlen : *outlen);
+    int i = 0;
+
+    while (i < len) {
+        int end;
+
+        if (sd->ascii_compatible && p[i] < 0x80)
+            i += widen_ascii(p + i, len - i, q + i);
+
+        /*
+         * Then look up the next few bytes individually, which is
+         * quicker than looking for ASCII runs in text where they're
+         * short.
+         */
+        end = (len - i < 16 ? len : i + 16);
+        for (; i < end; i++) {
+            unsigned long c = sd->sbcs2ucs[p[i]];
+            if (c == ERROR)
+                goto done;             /* let read_sbcs report it */
+            q[i] = c;
+        }
+    }
+
+  done:
+    *input += i;
+    *inlen -= i;
+    *output += i;
+    *outlen -= i;
+}
+
 void write_sbcs(charset_spec const *charset, long int input_chr,
                 charset_state *state,
                 void (*emit)(void *ctx, long int output), void *emitctx)
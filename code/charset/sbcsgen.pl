@@ -111,8 +111,13 @@ sub outcharset($$$) {
         }
         $j++;
     }
-    printf "\n    },\n    %d\n", $j;
+    $ascii = 1;
+    for ($i = 0; $i < 128; $i++) {
+        $ascii = 0 if $vals->[$i] != $i;
+    }
+    printf "\n    },\n    %d, %d\n", $j, $ascii;
     print "};\n";
     print "const charset_spec charset_$name = {\n" .
-          "    $name, read_sbcs, write_sbcs, &data_$name\n};\n\n";
+          "    $name, read_sbcs, write_sbcs, &data_$name, read_sbcs_bulk\n" .
+          "};\n\n";
 }
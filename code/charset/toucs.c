@@ -5,6 +5,56 @@
 #include "charset.h"
 #include "internal.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WIDEN_SSE2
+#endif
+
+/*
+ * Copy the longest prefix of the input that is pure ASCII to the
+ * output, widening it to wchar_t, and return its length. This is the
+ * common case for text in nearly every character set we support, so
+ * it's worth doing 16 bytes at a time where we can.
+ */
+int widen_ascii(const unsigned char *input, int len, wchar_t *output)
+{
+    int i = 0;
+
+#ifdef WIDEN_SSE2
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; len - i >= 16; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(input + i));
+        __m128i lo, hi;
+
+        if (_mm_movemask_epi8(v))
+            break;                     /* some byte has its top bit set */
+
+        lo = _mm_unpacklo_epi8(v, zero);
+        hi = _mm_unpackhi_epi8(v, zero);
+        if (sizeof(wchar_t) == 2) {
+            _mm_storeu_si128((__m128i *)(output + i), lo);
+            _mm_storeu_si128((__m128i *)(output + i + 8), hi);
+        } else {
+            _mm_storeu_si128((__m128i *)(output + i),
+                             _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128((__m128i *)(output + i + 4),
+                             _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128((__m128i *)(output + i + 8),
+                             _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128((__m128i *)(output + i + 12),
+                             _mm_unpackhi_epi16(hi, zero));
+        }
+    }
+#endif
+
+    for (; i < len && input[i] < 0x80; i++)
+        output[i] = input[i];
+
+    return i;
+}
+
 struct unicode_emit_param {
     wchar_t *output;
     int outlen;
@@ -68,7 +118,17 @@ int charset_to_unicode(const char **input, int *inlen,
     }
 
     while (*inlen > 0) {
-        int lenbefore = param.output - output;
+        int lenbefore;
+
+        if (spec->read_bulk && localstate.s0 == 0) {
+            const unsigned char *p = (const unsigned char *)*input;
+            spec->read_bulk(spec, &p, inlen, &param.output, &param.outlen);
+            *input = (const char *)p;
+            if (*inlen == 0)
+                break;
+        }
+
+        lenbefore = param.output - output;
         spec->read(spec, (unsigned char)**input, &localstate,
                    unicode_emit, &param);
         if (param.stopped) {
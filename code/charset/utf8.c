@@ -174,6 +174,66 @@ static void read_utf8(charset_spec const *charset, long int input_chr,
     }
 }
 
+/*
+ * Bulk version of read_utf8, which decodes runs of well-formed UTF-8
+ * and stops at the first thing that isn't, leaving read_utf8 to deal
+ * with it (and with anything else unusual, such as a character split
+ * across two calls). So it must accept exactly the sequences that
+ * read_utf8 would decode without error, and nothing more.
+ */
+static void read_utf8_bulk(charset_spec const *charset,
+                           const unsigned char **input, int *inlen,
+                           wchar_t **output, int *outlen)
+{
+    const unsigned char *p = *input, *end = p + *inlen;
+    wchar_t *q = *output, *qend = q + *outlen;
+
+    UNUSEDARG(charset);
+
+    while (p < end && q < qend) {
+        unsigned long c = *p;
+
+        if (c < 0x80) {
+            int n = end - p < qend - q ? end - p : qend - q;
+            n = widen_ascii(p, n, q);
+            p += n;
+            q += n;
+        } else if (c >= 0xC2 && c < 0xE0) {
+            if (end - p < 2 || (p[1] & 0xC0) != 0x80)
+                break;
+            *q++ = ((c & 0x1F) << 6) | (p[1] & 0x3F);
+            p += 2;
+        } else if (c >= 0xE0 && c < 0xF0) {
+            if (end - p < 3 || (p[1] & 0xC0) != 0x80 ||
+                (p[2] & 0xC0) != 0x80)
+                break;
+            c = ((c & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+            if (c < 0x800 || (c >= 0xD800 && c < 0xE000) ||
+                c == 0xFFFE || c == 0xFFFF)
+                break;
+            *q++ = c;
+            p += 3;
+        } else if (c >= 0xF0 && c < 0xF8) {
+            if (end - p < 4 || (p[1] & 0xC0) != 0x80 ||
+                (p[2] & 0xC0) != 0x80 || (p[3] & 0xC0) != 0x80)
+                break;
+            c = ((c & 0x07) << 18) | ((p[1] & 0x3F) << 12) |
+                ((p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+            if (c < 0x10000)
+                break;
+            *q++ = c;
+            p += 4;
+        } else {
+            break;
+        }
+    }
+
+    *inlen -= p - *input;
+    *input = p;
+    *outlen -= q - *output;
+    *output = q;
+}
+
 /*
  * UTF-8 is a stateless multi-byte encoding (in the sense that just
  * after any character has been completed, the state is always the
@@ -867,7 +927,7 @@ int main(void)
 #endif /* TESTMODE */
 
 const charset_spec charset_CS_UTF8 = {
-    CS_UTF8, read_utf8, write_utf8, NULL
+    CS_UTF8, read_utf8, write_utf8, NULL, read_utf8_bulk
 };
 
 #else /* ENUM_CHARSETS */
@@ -39,6 +39,16 @@ check_symbol_exists(elf_aux_info "sys/auxv.h" HAVE_ELF_AUX_INFO)
 check_symbol_exists(sysctlbyname "sys/types.h;sys/sysctl.h" HAVE_SYSCTLBYNAME)
 check_symbol_exists(CLOCK_MONOTONIC "time.h" HAVE_CLOCK_MONOTONIC)
 check_symbol_exists(clock_gettime "time.h" HAVE_CLOCK_GETTIME)
+check_symbol_exists(splice "fcntl.h" HAVE_SPLICE)
+check_symbol_exists(eventfd "sys/eventfd.h" HAVE_EVENTFD)
+check_symbol_exists(copy_file_range "unistd.h" HAVE_COPY_FILE_RANGE)
+check_symbol_exists(sendfile "sys/sendfile.h" HAVE_SENDFILE)
+
+# The SSH code can run compression on a worker thread, so everything
+# that links against the eventloop library needs the threads library.
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
+link_libraries(Threads::Threads)
 
 check_c_source_compiles("
 #define _GNU_SOURCE
@@ -21,6 +21,8 @@ set(PUTTY_COMPRESS_SCROLLBACK ON
   # disable it. So there's a #ifdef in terminal.c, and a cmake option
   # to enable that ifdef just in case it needs testing or debugging.
   CACHE BOOL "Store terminal scrollback in compressed form")
+set(PUTTY_WIDE_TREE234 OFF
+  CACHE BOOL "Use the wide-node B+-tree implementation of tree234")
 
 set(STRICT OFF
   CACHE BOOL "Enable extra compiler warnings and make them errors")
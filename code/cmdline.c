@@ -732,6 +732,20 @@ int cmdline_process_param(const char *p, char *value,
         conf_set_bool(conf, CONF_compression, true);
     }
 
+    if (!strcmp(p, "-compress-thread")) {
+        RETURN(1);
+        UNAVAILABLE_IN(TOOLTYPE_NONNETWORK);
+        SAVEABLE(0);
+        conf_set_bool(conf, CONF_compress_in_thread, true);
+    }
+
+    if (!strcmp(p, "-cipher-threads")) {
+        RETURN(2);
+        UNAVAILABLE_IN(TOOLTYPE_NONNETWORK);
+        SAVEABLE(0);
+        conf_set_int(conf, CONF_cipher_threads, atoi(value));
+    }
+
     if (!strcmp(p, "-1")) {
         RETURN(1);
         UNAVAILABLE_IN(TOOLTYPE_NONNETWORK);
@@ -2602,6 +2602,9 @@ void setup_config_box(struct controlbox *b, bool midsession,
     ctrl_editbox(s, "Lines of scrollback", 's', 50,
                  HELPCTX(window_scrollback),
                  conf_editbox_handler, I(CONF_savelines), ED_INT);
+    ctrl_editbox(s, "Lines kept in memory (0 = all)", 'y', 50,
+                 HELPCTX(window_scrollback),
+                 conf_editbox_handler, I(CONF_savelines_in_memory), ED_INT);
     ctrl_checkbox(s, "Display scrollbar", 'd',
                   HELPCTX(window_scrollback),
                   conf_checkbox_handler, I(CONF_scrollbar));
@@ -3071,6 +3074,15 @@ void setup_config_box(struct controlbox *b, bool midsession,
                           I(CONF_compression));
         }
 
+        if (!midsession) {
+            s = ctrl_getset(b, "Connection/SSH", "protocol", "Protocol options");
+
+            ctrl_checkbox(s, "Compress on a separate thread", NO_SHORTCUT,
+                          HELPCTX(ssh_compress_thread),
+                          conf_checkbox_handler,
+                          I(CONF_compress_in_thread));
+        }
+
         if (!midsession) {
             s = ctrl_getset(b, "Connection/SSH", "sharing", "Sharing an SSH connection between PuTTY tools");
 
@@ -3242,6 +3254,16 @@ void setup_config_box(struct controlbox *b, bool midsession,
                           I(CONF_ssh2_des_cbc));
         }
 
+        if (!midsession) {
+            s = ctrl_getset(b, "Connection/SSH/Cipher",
+                            "threads", "Parallel encryption");
+            ctrl_editbox(s, "Worker threads (0 for none)", 'w', 20,
+                         HELPCTX(ssh_cipher_threads),
+                         conf_editbox_handler,
+                         I(CONF_cipher_threads),
+                         ED_INT);
+        }
+
         if (!midsession) {
 #ifdef PUTTY_CAC
 			/*
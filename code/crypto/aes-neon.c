@@ -355,5 +355,5 @@ NEON_ENC_DEC(128)
 NEON_ENC_DEC(192)
 NEON_ENC_DEC(256)
 
-AES_EXTRA(_neon);
+AES_EXTRA(_neon, );
 AES_ALL_VTABLES(_neon, "NEON accelerated");
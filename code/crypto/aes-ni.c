@@ -4,9 +4,7 @@
 
 #include "ssh.h"
 #include "aes.h"
-
-#include <wmmintrin.h>
-#include <smmintrin.h>
+#include "aes-ni.h"
 
 #if defined(__clang__) || defined(__GNUC__)
 #include <cpuid.h>
@@ -26,26 +24,6 @@ static bool aes_ni_available(void)
     return (CPUInfo[2] & (1 << 25)) && (CPUInfo[2] & (1 << 19));
 }
 
-/*
- * Core AES-NI encrypt/decrypt functions, one per length and direction.
- */
-
-#define NI_CIPHER(len, dir, dirlong, repmacro)                          \
-    static inline __m128i aes_ni_##len##_##dir(                         \
-        __m128i v, const __m128i *keysched)                             \
-    {                                                                   \
-        v = _mm_xor_si128(v, *keysched++);                              \
-        repmacro(v = _mm_aes##dirlong##_si128(v, *keysched++););        \
-        return _mm_aes##dirlong##last_si128(v, *keysched);              \
-    }
-
-NI_CIPHER(128, e, enc, REP9)
-NI_CIPHER(128, d, dec, REP9)
-NI_CIPHER(192, e, enc, REP11)
-NI_CIPHER(192, d, dec, REP11)
-NI_CIPHER(256, e, enc, REP13)
-NI_CIPHER(256, d, dec, REP13)
-
 /*
  * The main key expansion.
  */
@@ -114,62 +92,10 @@ static void aes_ni_key_expand(
     }
 }
 
-/*
- * Auxiliary routine to increment the 128-bit counter used in SDCTR
- * mode.
- */
-static inline __m128i aes_ni_sdctr_increment(__m128i v)
-{
-    const __m128i ONE  = _mm_setr_epi32(1,0,0,0);
-    const __m128i ZERO = _mm_setzero_si128();
-
-    /* Increment the low-order 64 bits of v */
-    v  = _mm_add_epi64(v, ONE);
-    /* Check if they've become zero */
-    __m128i cmp = _mm_cmpeq_epi64(v, ZERO);
-    /* If so, the low half of cmp is all 1s. Pack that into the high
-     * half of addend with zero in the low half. */
-    __m128i addend = _mm_unpacklo_epi64(ZERO, cmp);
-    /* And subtract that from v, which increments the high 64 bits iff
-     * the low 64 wrapped round. */
-    v = _mm_sub_epi64(v, addend);
-
-    return v;
-}
-
-/*
- * Much simpler auxiliary routine to increment the counter for GCM
- * mode. This only has to increment the low word.
- */
-static inline __m128i aes_ni_gcm_increment(__m128i v)
-{
-    const __m128i ONE  = _mm_setr_epi32(1,0,0,0);
-    return _mm_add_epi32(v, ONE);
-}
-
-/*
- * Auxiliary routine to reverse the byte order of a vector, so that
- * the SDCTR IV can be made big-endian for feeding to the cipher.
- */
-static inline __m128i aes_ni_sdctr_reverse(__m128i v)
-{
-    v = _mm_shuffle_epi8(
-        v, _mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0));
-    return v;
-}
-
 /*
  * The SSH interface and the cipher modes.
  */
 
-typedef struct aes_ni_context aes_ni_context;
-struct aes_ni_context {
-    __m128i keysched_e[MAXROUNDKEYS], keysched_d[MAXROUNDKEYS], iv;
-
-    void *pointer_to_free;
-    ssh_cipher ciph;
-};
-
 static ssh_cipher *aes_ni_new(const ssh_cipheralg *alg)
 {
     const struct aes_extra *extra = (const struct aes_extra *)alg->extra;
@@ -260,13 +186,33 @@ static inline void aes_cbc_ni_encrypt(
     }
 }
 
+typedef void (*aes_ni_batch_fn)(__m128i *v, const __m128i *keysched);
+
 static inline void aes_cbc_ni_decrypt(
-    ssh_cipher *ciph, void *vblk, int blklen, aes_ni_fn decrypt)
+    ssh_cipher *ciph, void *vblk, int blklen,
+    aes_ni_fn decrypt, aes_ni_batch_fn decrypt_batch)
 {
     aes_ni_context *ctx = container_of(ciph, aes_ni_context, ciph);
+    uint8_t *blk = (uint8_t *)vblk, *finish = blk + blklen;
+
+    /* Unlike encryption, CBC decryption of each block doesn't depend
+     * on the result of the previous one, so we can do whole batches
+     * of blocks at once */
+    for (; finish - blk >= 16 * AES_NI_BATCH; blk += 16 * AES_NI_BATCH) {
+        __m128i ciphertext[AES_NI_BATCH], v[AES_NI_BATCH];
+        for (size_t i = 0; i < AES_NI_BATCH; i++)
+            v[i] = ciphertext[i] = _mm_loadu_si128(
+                (const __m128i *)(blk + 16 * i));
+        decrypt_batch(v, ctx->keysched_d);
+        for (size_t i = 0; i < AES_NI_BATCH; i++) {
+            __m128i prev = i ? ciphertext[i-1] : ctx->iv;
+            _mm_storeu_si128((__m128i *)(blk + 16 * i),
+                             _mm_xor_si128(v[i], prev));
+        }
+        ctx->iv = ciphertext[AES_NI_BATCH-1];
+    }
 
-    for (uint8_t *blk = (uint8_t *)vblk, *finish = blk + blklen;
-         blk < finish; blk += 16) {
+    for (; blk < finish; blk += 16) {
         __m128i ciphertext = _mm_loadu_si128((const __m128i *)blk);
         __m128i decrypted = decrypt(ciphertext, ctx->keysched_d);
         __m128i plaintext = _mm_xor_si128(decrypted, ctx->iv);
@@ -276,12 +222,28 @@ static inline void aes_cbc_ni_decrypt(
 }
 
 static inline void aes_sdctr_ni(
-    ssh_cipher *ciph, void *vblk, int blklen, aes_ni_fn encrypt)
+    ssh_cipher *ciph, void *vblk, int blklen,
+    aes_ni_fn encrypt, aes_ni_batch_fn encrypt_batch)
 {
     aes_ni_context *ctx = container_of(ciph, aes_ni_context, ciph);
+    uint8_t *blk = (uint8_t *)vblk, *finish = blk + blklen;
+
+    /* Whole batches of blocks, with all their counters in flight at once */
+    for (; finish - blk >= 16 * AES_NI_BATCH; blk += 16 * AES_NI_BATCH) {
+        __m128i v[AES_NI_BATCH];
+        for (size_t i = 0; i < AES_NI_BATCH; i++) {
+            v[i] = aes_ni_sdctr_reverse(ctx->iv);
+            ctx->iv = aes_ni_sdctr_increment(ctx->iv);
+        }
+        encrypt_batch(v, ctx->keysched_e);
+        for (size_t i = 0; i < AES_NI_BATCH; i++) {
+            __m128i *p = (__m128i *)blk + i;
+            _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), v[i]));
+        }
+    }
 
-    for (uint8_t *blk = (uint8_t *)vblk, *finish = blk + blklen;
-         blk < finish; blk += 16) {
+    /* And any remainder one at a time */
+    for (; blk < finish; blk += 16) {
         __m128i counter = aes_ni_sdctr_reverse(ctx->iv);
         __m128i keystream = encrypt(counter, ctx->keysched_e);
         __m128i input = _mm_loadu_si128((const __m128i *)blk);
@@ -301,12 +263,26 @@ static inline void aes_encrypt_ecb_block_ni(
 }
 
 static inline void aes_gcm_ni(
-    ssh_cipher *ciph, void *vblk, int blklen, aes_ni_fn encrypt)
+    ssh_cipher *ciph, void *vblk, int blklen,
+    aes_ni_fn encrypt, aes_ni_batch_fn encrypt_batch)
 {
     aes_ni_context *ctx = container_of(ciph, aes_ni_context, ciph);
+    uint8_t *blk = (uint8_t *)vblk, *finish = blk + blklen;
 
-    for (uint8_t *blk = (uint8_t *)vblk, *finish = blk + blklen;
-         blk < finish; blk += 16) {
+    for (; finish - blk >= 16 * AES_NI_BATCH; blk += 16 * AES_NI_BATCH) {
+        __m128i v[AES_NI_BATCH];
+        for (size_t i = 0; i < AES_NI_BATCH; i++) {
+            v[i] = aes_ni_sdctr_reverse(ctx->iv);
+            ctx->iv = aes_ni_gcm_increment(ctx->iv);
+        }
+        encrypt_batch(v, ctx->keysched_e);
+        for (size_t i = 0; i < AES_NI_BATCH; i++) {
+            __m128i *p = (__m128i *)blk + i;
+            _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p), v[i]));
+        }
+    }
+
+    for (; blk < finish; blk += 16) {
         __m128i counter = aes_ni_sdctr_reverse(ctx->iv);
         __m128i keystream = encrypt(counter, ctx->keysched_e);
         __m128i input = _mm_loadu_si128((const __m128i *)blk);
@@ -322,13 +298,16 @@ static inline void aes_gcm_ni(
     { aes_cbc_ni_encrypt(ciph, vblk, blklen, aes_ni_##len##_e); }       \
     static void aes##len##_ni_cbc_decrypt(                              \
         ssh_cipher *ciph, void *vblk, int blklen)                       \
-    { aes_cbc_ni_decrypt(ciph, vblk, blklen, aes_ni_##len##_d); }       \
+    { aes_cbc_ni_decrypt(ciph, vblk, blklen, aes_ni_##len##_d,          \
+                         aes_ni_##len##_d_batch); }                     \
     static void aes##len##_ni_sdctr(                                    \
         ssh_cipher *ciph, void *vblk, int blklen)                       \
-    { aes_sdctr_ni(ciph, vblk, blklen, aes_ni_##len##_e); }             \
+    { aes_sdctr_ni(ciph, vblk, blklen, aes_ni_##len##_e,                \
+                   aes_ni_##len##_e_batch); }                           \
     static void aes##len##_ni_gcm(                                      \
         ssh_cipher *ciph, void *vblk, int blklen)                       \
-    { aes_gcm_ni(ciph, vblk, blklen, aes_ni_##len##_e); }               \
+    { aes_gcm_ni(ciph, vblk, blklen, aes_ni_##len##_e,                  \
+                 aes_ni_##len##_e_batch); }                             \
     static void aes##len##_ni_encrypt_ecb_block(                        \
         ssh_cipher *ciph, void *vblk)                                   \
     { aes_encrypt_ecb_block_ni(ciph, vblk, aes_ni_##len##_e); }
@@ -337,5 +316,69 @@ NI_ENC_DEC(128)
 NI_ENC_DEC(192)
 NI_ENC_DEC(256)
 
-AES_EXTRA(_ni);
+#if HAVE_AESGCM_NI
+#define NI_GCM_STITCHED .gcm_stitched = aes_ni_gcm_stitched
+#else
+#define NI_GCM_STITCHED
+#endif
+
+AES_EXTRA(_ni, NI_GCM_STITCHED);
 AES_ALL_VTABLES(_ni, "AES-NI accelerated");
+
+#if HAVE_VAES
+
+/*
+ * The VAES variant is the AES-NI one in every respect except that
+ * the counter modes hand as much of their input as they can to the
+ * 512-bit kernels in aes-vaes.c first. (The CBC modes can't benefit:
+ * encryption is inherently serial, and decryption is dominated by
+ * the XOR chaining rather than the AES rounds.) So most of its
+ * vtable entries are just the AES-NI functions under another name.
+ */
+
+static bool aes_vaes_available(void)
+{
+    return aes_ni_available() && aes_vaes_cpu_available();
+}
+
+#define aes_vaes_new aes_ni_new
+#define aes_vaes_free aes_ni_free
+#define aes_vaes_setkey aes_ni_setkey
+#define aes_vaes_setiv_cbc aes_ni_setiv_cbc
+#define aes_vaes_setiv_sdctr aes_ni_setiv_sdctr
+#define aes_vaes_setiv_gcm aes_ni_setiv_gcm
+#define aes_vaes_next_message_gcm aes_ni_next_message_gcm
+
+#define VAES_ENC_DEC(len)                                               \
+    static void aes##len##_vaes_sdctr(                                  \
+        ssh_cipher *ciph, void *vblk, int blklen)                       \
+    {                                                                   \
+        aes_ni_context *ctx = container_of(ciph, aes_ni_context, ciph); \
+        size_t done = 16 * aes_vaes_sdctr(ctx, vblk, blklen / 16);      \
+        aes##len##_ni_sdctr(ciph, (uint8_t *)vblk + done, blklen - done); \
+    }                                                                   \
+    static void aes##len##_vaes_gcm(                                    \
+        ssh_cipher *ciph, void *vblk, int blklen)                       \
+    {                                                                   \
+        aes_ni_context *ctx = container_of(ciph, aes_ni_context, ciph); \
+        size_t done = 16 * aes_vaes_gcm(ctx, vblk, blklen / 16);        \
+        aes##len##_ni_gcm(ciph, (uint8_t *)vblk + done, blklen - done); \
+    }
+#define aes128_vaes_cbc_encrypt aes128_ni_cbc_encrypt
+#define aes192_vaes_cbc_encrypt aes192_ni_cbc_encrypt
+#define aes256_vaes_cbc_encrypt aes256_ni_cbc_encrypt
+#define aes128_vaes_cbc_decrypt aes128_ni_cbc_decrypt
+#define aes192_vaes_cbc_decrypt aes192_ni_cbc_decrypt
+#define aes256_vaes_cbc_decrypt aes256_ni_cbc_decrypt
+#define aes128_vaes_encrypt_ecb_block aes128_ni_encrypt_ecb_block
+#define aes192_vaes_encrypt_ecb_block aes192_ni_encrypt_ecb_block
+#define aes256_vaes_encrypt_ecb_block aes256_ni_encrypt_ecb_block
+
+VAES_ENC_DEC(128)
+VAES_ENC_DEC(192)
+VAES_ENC_DEC(256)
+
+AES_EXTRA(_vaes, .gcm_stitched = aes_vaes_gcm_stitched);
+AES_ALL_VTABLES(_vaes, "VAES accelerated");
+
+#endif /* HAVE_VAES */
@@ -0,0 +1,140 @@
+/*
+ * Definitions shared between the AES-NI implementation in aes-ni.c
+ * and the modules that extend it with other x86 instruction set
+ * extensions (aesgcm-ni.c for stitched AES-GCM using CLMUL as well,
+ * and aes-vaes.c for the AVX-512 vector AES instructions). Each of
+ * those has to be compiled with different flags, so they can't all
+ * live in one source file.
+ */
+
+#include <wmmintrin.h>
+#include <smmintrin.h>
+
+/*
+ * Core AES-NI encrypt/decrypt functions, one per length and direction.
+ */
+
+#define NI_CIPHER(len, dir, dirlong, repmacro)                          \
+    static inline __m128i aes_ni_##len##_##dir(                         \
+        __m128i v, const __m128i *keysched)                             \
+    {                                                                   \
+        v = _mm_xor_si128(v, *keysched++);                              \
+        repmacro(v = _mm_aes##dirlong##_si128(v, *keysched++););        \
+        return _mm_aes##dirlong##last_si128(v, *keysched);              \
+    }
+
+NI_CIPHER(128, e, enc, REP9)
+NI_CIPHER(128, d, dec, REP9)
+NI_CIPHER(192, e, enc, REP11)
+NI_CIPHER(192, d, dec, REP11)
+NI_CIPHER(256, e, enc, REP13)
+NI_CIPHER(256, d, dec, REP13)
+
+/*
+ * The same, but for AES_NI_BATCH independent blocks at once. The
+ * AESENC instruction has a latency of several cycles but can start a
+ * new one every cycle or so, so feeding it a block at a time leaves
+ * the unit mostly idle; interleaving eight independent blocks keeps
+ * it busy.
+ */
+#define AES_NI_BATCH 8
+
+#define NI_CIPHER_BATCH(len, dir, dirlong, rounds)                      \
+    static inline void aes_ni_##len##_##dir##_batch(                    \
+        __m128i *v, const __m128i *keysched)                            \
+    {                                                                   \
+        for (size_t i = 0; i < AES_NI_BATCH; i++)                       \
+            v[i] = _mm_xor_si128(v[i], keysched[0]);                    \
+        for (size_t r = 1; r < rounds; r++) {                           \
+            __m128i k = keysched[r];                                    \
+            for (size_t i = 0; i < AES_NI_BATCH; i++)                   \
+                v[i] = _mm_aes##dirlong##_si128(v[i], k);               \
+        }                                                               \
+        for (size_t i = 0; i < AES_NI_BATCH; i++)                       \
+            v[i] = _mm_aes##dirlong##last_si128(v[i], keysched[rounds]); \
+    }
+
+NI_CIPHER_BATCH(128, e, enc, 10)
+NI_CIPHER_BATCH(128, d, dec, 10)
+NI_CIPHER_BATCH(192, e, enc, 12)
+NI_CIPHER_BATCH(192, d, dec, 12)
+NI_CIPHER_BATCH(256, e, enc, 14)
+NI_CIPHER_BATCH(256, d, dec, 14)
+
+/*
+ * Auxiliary routine to increment the 128-bit counter used in SDCTR
+ * mode.
+ */
+static inline __m128i aes_ni_sdctr_increment(__m128i v)
+{
+    const __m128i ONE  = _mm_setr_epi32(1,0,0,0);
+    const __m128i ZERO = _mm_setzero_si128();
+
+    /* Increment the low-order 64 bits of v */
+    v  = _mm_add_epi64(v, ONE);
+    /* Check if they've become zero */
+    __m128i cmp = _mm_cmpeq_epi64(v, ZERO);
+    /* If so, the low half of cmp is all 1s. Pack that into the high
+     * half of addend with zero in the low half. */
+    __m128i addend = _mm_unpacklo_epi64(ZERO, cmp);
+    /* And subtract that from v, which increments the high 64 bits iff
+     * the low 64 wrapped round. */
+    v = _mm_sub_epi64(v, addend);
+
+    return v;
+}
+
+/*
+ * Much simpler auxiliary routine to increment the counter for GCM
+ * mode. This only has to increment the low word.
+ */
+static inline __m128i aes_ni_gcm_increment(__m128i v)
+{
+    const __m128i ONE  = _mm_setr_epi32(1,0,0,0);
+    return _mm_add_epi32(v, ONE);
+}
+
+/*
+ * Auxiliary routine to reverse the byte order of a vector, so that
+ * the SDCTR IV can be made big-endian for feeding to the cipher.
+ */
+static inline __m128i aes_ni_sdctr_reverse(__m128i v)
+{
+    v = _mm_shuffle_epi8(
+        v, _mm_setr_epi8(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0));
+    return v;
+}
+
+/*
+ * The cipher context. The counter modes keep ctx->iv byte-reversed,
+ * so that incrementing it is arithmetic on the low-order lanes.
+ */
+typedef struct aes_ni_context aes_ni_context;
+struct aes_ni_context {
+    __m128i keysched_e[MAXROUNDKEYS], keysched_d[MAXROUNDKEYS], iv;
+
+    void *pointer_to_free;
+    ssh_cipher ciph;
+};
+
+static inline unsigned aes_ni_rounds(aes_ni_context *ctx)
+{
+    return ctx->ciph.vt->real_keybits / 32 + 6;
+}
+
+/* Stitched AES-GCM with CLMUL, in aesgcm-ni.c */
+size_t aes_ni_gcm_stitched(ssh_cipher *ciph, struct ghash_clmul *gh,
+                           void *blk, size_t len, bool encrypt);
+
+/* Counter-mode kernels using VAES, in aes-vaes.c. Each processes as
+ * many whole batches of AES_VAES_BATCH blocks as fit in nblocks, and
+ * returns the number it did. */
+#define AES_VAES_BATCH 16
+bool aes_vaes_cpu_available(void);
+size_t aes_vaes_sdctr(aes_ni_context *ctx, uint8_t *blk, size_t nblocks);
+size_t aes_vaes_gcm(aes_ni_context *ctx, uint8_t *blk, size_t nblocks);
+
+/* Stitched AES-GCM with VAES and VPCLMULQDQ, which hands anything too
+ * short for its own batch size on to aes_ni_gcm_stitched. */
+size_t aes_vaes_gcm_stitched(ssh_cipher *ciph, struct ghash_clmul *gh,
+                             void *blk, size_t len, bool encrypt);
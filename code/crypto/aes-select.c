@@ -33,6 +33,12 @@ static ssh_cipher *aes_select(const ssh_cipheralg *alg)
 #define IF_NI(...)
 #endif
 
+#if HAVE_VAES
+#define IF_VAES(...) __VA_ARGS__
+#else
+#define IF_VAES(...)
+#endif
+
 #if HAVE_NEON_CRYPTO
 #define IF_NEON(...) __VA_ARGS__
 #else
@@ -42,6 +48,7 @@ static ssh_cipher *aes_select(const ssh_cipheralg *alg)
 #define AES_SELECTOR_VTABLE(mode_c, id, mode_display, bits, ...)        \
     static const ssh_cipheralg *                                        \
     ssh_aes ## bits ## _ ## mode_c ## _impls[] = {                      \
+        IF_VAES(&ssh_aes ## bits ## _ ## mode_c ## _vaes,)              \
         IF_NI(&ssh_aes ## bits ## _ ## mode_c ## _ni,)                  \
         IF_NEON(&ssh_aes ## bits ## _ ## mode_c ## _neon,)              \
         &ssh_aes ## bits ## _ ## mode_c ## _sw,                         \
@@ -62,15 +69,20 @@ static ssh_cipher *aes_select(const ssh_cipheralg *alg)
 AES_SELECTOR_VTABLE(cbc, "aes128-cbc", "CBC", 128, .flags = SSH_CIPHER_IS_CBC);
 AES_SELECTOR_VTABLE(cbc, "aes192-cbc", "CBC", 192, .flags = SSH_CIPHER_IS_CBC);
 AES_SELECTOR_VTABLE(cbc, "aes256-cbc", "CBC", 256, .flags = SSH_CIPHER_IS_CBC);
-AES_SELECTOR_VTABLE(sdctr, "aes128-ctr", "SDCTR", 128, );
-AES_SELECTOR_VTABLE(sdctr, "aes192-ctr", "SDCTR", 192, );
-AES_SELECTOR_VTABLE(sdctr, "aes256-ctr", "SDCTR", 256, );
+AES_SELECTOR_VTABLE(sdctr, "aes128-ctr", "SDCTR", 128,
+                    .flags = SSH_CIPHER_IV_COUNTS_BLOCKS);
+AES_SELECTOR_VTABLE(sdctr, "aes192-ctr", "SDCTR", 192,
+                    .flags = SSH_CIPHER_IV_COUNTS_BLOCKS);
+AES_SELECTOR_VTABLE(sdctr, "aes256-ctr", "SDCTR", 256,
+                    .flags = SSH_CIPHER_IV_COUNTS_BLOCKS);
 AES_SELECTOR_VTABLE(gcm, "aes128-gcm@openssh.com", "GCM", 128,
                     .required_mac = &ssh2_aesgcm_mac,
-                    .flags = SSH_CIPHER_SEPARATE_LENGTH);
+                    .flags = (SSH_CIPHER_SEPARATE_LENGTH |
+                              SSH_CIPHER_IV_COUNTS_MESSAGES));
 AES_SELECTOR_VTABLE(gcm, "aes256-gcm@openssh.com", "GCM", 256,
                     .required_mac = &ssh2_aesgcm_mac,
-                    .flags = SSH_CIPHER_SEPARATE_LENGTH);
+                    .flags = (SSH_CIPHER_SEPARATE_LENGTH |
+                              SSH_CIPHER_IV_COUNTS_MESSAGES));
 
 /* 192-bit AES-GCM is included only so that testcrypt can run standard
  * test vectors against it. OpenSSH doesn't define a protocol id for
@@ -78,7 +90,8 @@ AES_SELECTOR_VTABLE(gcm, "aes256-gcm@openssh.com", "GCM", 256,
  * leaving it out of aesgcm_list[] below. */
 AES_SELECTOR_VTABLE(gcm, NULL, "GCM", 192,
                     .required_mac = &ssh2_aesgcm_mac,
-                    .flags = SSH_CIPHER_SEPARATE_LENGTH);
+                    .flags = (SSH_CIPHER_SEPARATE_LENGTH |
+                              SSH_CIPHER_IV_COUNTS_MESSAGES));
 
 static const ssh_cipheralg ssh_rijndael_lysator = {
     /* Same as aes256_cbc, but with a different protocol ID */
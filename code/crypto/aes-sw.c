@@ -418,15 +418,16 @@ static inline void dumpslices_BignumInt(
 
 #define SINGLE_BITSLICE_SHIFTROWS(output, input, uintN_t) do            \
     {                                                                   \
-        uintN_t mask, mask2, mask3, diff, x = (input);                  \
+        BignumInt mask, mask2, mask3;                                   \
+        uintN_t diff, x = (input);                                      \
         /* Rotate rows 2 and 3 by 16 bits */                            \
-        mask = 0x00CC * (((uintN_t)~(uintN_t)0) / 0xFFFF);              \
+        mask = 0x00CC * (~(BignumInt)0 / 0xFFFF);                       \
         diff = ((x >> 8) ^ x) & mask;                                   \
         x ^= diff ^ (diff << 8);                                        \
         /* Rotate rows 1 and 3 by 8 bits */                             \
-        mask  = 0x0AAA * (((uintN_t)~(uintN_t)0) / 0xFFFF);             \
-        mask2 = 0xA000 * (((uintN_t)~(uintN_t)0) / 0xFFFF);             \
-        mask3 = 0x5555 * (((uintN_t)~(uintN_t)0) / 0xFFFF);             \
+        mask  = 0x0AAA * (~(BignumInt)0 / 0xFFFF);                      \
+        mask2 = 0xA000 * (~(BignumInt)0 / 0xFFFF);                      \
+        mask3 = 0x5555 * (~(BignumInt)0 / 0xFFFF);                      \
         x = ((x >> 4) & mask) | ((x << 12) & mask2) | (x & mask3);      \
         /* Write output */                                              \
         (output) = x;                                                   \
@@ -434,15 +435,16 @@ static inline void dumpslices_BignumInt(
 
 #define SINGLE_BITSLICE_INVSHIFTROWS(output, input, uintN_t) do         \
     {                                                                   \
-        uintN_t mask, mask2, mask3, diff, x = (input);                  \
+        BignumInt mask, mask2, mask3;                                   \
+        uintN_t diff, x = (input);                                      \
         /* Rotate rows 2 and 3 by 16 bits */                            \
-        mask = 0x00CC * (((uintN_t)~(uintN_t)0) / 0xFFFF);              \
+        mask = 0x00CC * (~(BignumInt)0 / 0xFFFF);                       \
         diff = ((x >> 8) ^ x) & mask;                                   \
         x ^= diff ^ (diff << 8);                                        \
         /* Rotate rows 1 and 3 by 8 bits, the opposite way to ShiftRows */ \
-        mask  = 0x000A * (((uintN_t)~(uintN_t)0) / 0xFFFF);             \
-        mask2 = 0xAAA0 * (((uintN_t)~(uintN_t)0) / 0xFFFF);             \
-        mask3 = 0x5555 * (((uintN_t)~(uintN_t)0) / 0xFFFF);             \
+        mask  = 0x000A * (~(BignumInt)0 / 0xFFFF);                      \
+        mask2 = 0xAAA0 * (~(BignumInt)0 / 0xFFFF);                      \
+        mask3 = 0x5555 * (~(BignumInt)0 / 0xFFFF);                      \
         x = ((x >> 12) & mask) | ((x << 4) & mask2) | (x & mask3);      \
         /* Write output */                                              \
         (output) = x;                                                   \
@@ -476,9 +478,10 @@ static inline void dumpslices_BignumInt(
  * ITERATE to affect all the data at once. */
 #define BITSLICED_MUL_BY_Y3(output, input, uintN_t) do          \
     {                                                           \
-        uintN_t mask, mask2, x;                                 \
-        mask  = 0x8 * (((uintN_t)~(uintN_t)0) / 0xF);           \
-        mask2 = 0x7 * (((uintN_t)~(uintN_t)0) / 0xF);           \
+        BignumInt mask, mask2;                                  \
+        uintN_t x;                                              \
+        mask  = 0x8 * (~(BignumInt)0 / 0xF);                    \
+        mask2 = 0x7 * (~(BignumInt)0 / 0xF);                    \
         x = input;                                              \
         output = ((x << 3) & mask) ^ ((x >> 1) & mask2);        \
     } while (0)
@@ -486,9 +489,10 @@ static inline void dumpslices_BignumInt(
 /* Multiply every column by Y^2. */
 #define BITSLICED_MUL_BY_Y2(output, input, uintN_t) do          \
     {                                                           \
-        uintN_t mask, mask2, x;                                 \
-        mask  = 0xC * (((uintN_t)~(uintN_t)0) / 0xF);           \
-        mask2 = 0x3 * (((uintN_t)~(uintN_t)0) / 0xF);           \
+        BignumInt mask, mask2;                                  \
+        uintN_t x;                                              \
+        mask  = 0xC * (~(BignumInt)0 / 0xF);                    \
+        mask2 = 0x3 * (~(BignumInt)0 / 0xF);                    \
         x = input;                                              \
         output = ((x << 2) & mask) ^ ((x >> 2) & mask2);        \
     } while (0)
@@ -799,6 +803,86 @@ DECRYPT_FN(serial, uint16_t, 1)
 ENCRYPT_FN(parallel, BignumInt, SLICE_PARALLELISM)
 DECRYPT_FN(parallel, BignumInt, SLICE_PARALLELISM)
 
+/*
+ * CBC decryption is the one mode in which we're always given a whole
+ * packet's worth of independent cipher blocks at once, so there it's
+ * worth going wider than a single BignumInt. With GCC-style vector
+ * extensions, a slice word can be a vector of several BignumInts,
+ * and the compiler will turn each operation on it into whatever SIMD
+ * instructions the target has (or, failing that, into several scalar
+ * ones, which is no worse than doing the batches one by one).
+ *
+ * Everything the round functions do to a slice word is either a
+ * bitwise operation or a shift whose result is masked back into the
+ * same 16-bit group, so it's unaffected by the lane boundaries. Only
+ * the conversion into and out of bitsliced form needs to know about
+ * them, and that's done one BignumInt lane at a time.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+
+#define WIDE_SLICE_BYTES 32
+#define WIDE_SLICE_LANES (WIDE_SLICE_BYTES / BIGNUM_INT_BYTES)
+#define WIDE_PARALLELISM (WIDE_SLICE_LANES * SLICE_PARALLELISM)
+typedef BignumInt aes_wide_slice
+    __attribute__((vector_size(WIDE_SLICE_BYTES)));
+
+DECRYPT_ROUND_FN(wide, aes_wide_slice, BITSLICED_INVMIXCOLUMNS)
+DECRYPT_ROUND_FN(wide_first, aes_wide_slice, NO_MIXCOLUMNS)
+
+static void aes_sliced_d_wide(
+    uint8_t *output, const uint8_t *input, const aes_sliced_key *sk)
+{
+    aes_wide_slice state[8], keys[MAXROUNDKEYS * 8];
+    BignumInt lane[8];
+
+    for (unsigned l = 0; l < WIDE_SLICE_LANES; l++) {
+        TO_BITSLICES(lane, input, BignumInt, =, 0);
+        for (unsigned i = 1; i < SLICE_PARALLELISM; i++)
+            TO_BITSLICES(lane, input + 16*i, BignumInt, |=, i*16);
+        for (unsigned b = 0; b < 8; b++)
+            state[b][l] = lane[b];
+        input += 16 * SLICE_PARALLELISM;
+    }
+
+    /* The round keys are the same in every lane, so we expand them
+     * from the BignumInt ones here, rather than keep a second copy of
+     * the whole schedule in the key structure. (That way we also
+     * needn't worry about whether the heap will give us memory
+     * aligned suitably for the vector type.) */
+    for (unsigned i = 0; i < 8 * (sk->rounds + 1); i++)
+        for (unsigned l = 0; l < WIDE_SLICE_LANES; l++)
+            keys[i][l] = sk->roundkeys_parallel[i];
+
+    const aes_wide_slice *rk = keys + 8*sk->rounds;
+    aes_sliced_round_d_wide_first(state, state, rk);
+    for (unsigned i = 0; i < sk->rounds; i++) {
+        rk -= 8;
+        if (i+1 < sk->rounds)
+            aes_sliced_round_d_wide(state, state, rk);
+        else
+            BITSLICED_ADD(state, state, rk);
+    }
+
+    for (unsigned l = 0; l < WIDE_SLICE_LANES; l++) {
+        for (unsigned b = 0; b < 8; b++)
+            lane[b] = state[b][l];
+        for (unsigned i = 0; i < SLICE_PARALLELISM; i++)
+            FROM_BITSLICES(output + 16*i, lane, i*16);
+        output += 16 * SLICE_PARALLELISM;
+    }
+
+    smemclr(state, sizeof(state));
+    smemclr(keys, sizeof(keys));
+    smemclr(lane, sizeof(lane));
+}
+
+#else
+
+#define WIDE_PARALLELISM SLICE_PARALLELISM
+#define aes_sliced_d_wide aes_sliced_d_parallel
+
+#endif
+
 /* -----
  * The SSH interface and the cipher modes.
  */
@@ -971,7 +1055,7 @@ static inline void aes_cbc_sw_decrypt(
 
     size_t blocks_remaining = blklen / 16;
 
-    uint8_t data[SLICE_PARALLELISM * 16];
+    uint8_t data[WIDE_PARALLELISM * 16];
     /* Zeroing the data array is probably overcautious, but it avoids
      * technically undefined behaviour from leaving it uninitialised
      * if our very first iteration doesn't include enough cipher
@@ -982,14 +1066,20 @@ static inline void aes_cbc_sw_decrypt(
         /* Number of blocks we'll handle in this iteration. If we're
          * dealing with fewer than the maximum, it doesn't matter -
          * it's harmless to run the full parallel cipher function
-         * anyway. */
-        size_t blocks = (blocks_remaining < SLICE_PARALLELISM ?
-                         blocks_remaining : SLICE_PARALLELISM);
+         * anyway. But if there are few enough that the ordinary
+         * BignumInt version can handle them all, use that rather
+         * than the wide one, because SSH-2 decrypts the first block
+         * of every packet on its own. */
+        size_t blocks = (blocks_remaining < WIDE_PARALLELISM ?
+                         blocks_remaining : WIDE_PARALLELISM);
 
         /* Parallel-decrypt the input, in a separate array so we still
          * have the cipher stream available for XORing. */
         memcpy(data, blk, 16 * blocks);
-        aes_sliced_d_parallel(data, data, &ctx->sk);
+        if (blocks <= SLICE_PARALLELISM)
+            aes_sliced_d_parallel(data, data, &ctx->sk);
+        else
+            aes_sliced_d_wide(data, data, &ctx->sk);
 
         /* Write the output and update the IV */
         for (size_t i = 0; i < blocks; i++) {
@@ -1129,5 +1219,5 @@ SW_ENC_DEC(128)
 SW_ENC_DEC(192)
 SW_ENC_DEC(256)
 
-AES_EXTRA(_sw);
+AES_EXTRA(_sw, );
 AES_ALL_VTABLES(_sw, "unaccelerated");
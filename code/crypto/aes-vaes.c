@@ -0,0 +1,278 @@
+/*
+ * AES counter modes using the AVX-512 vector AES instructions (VAES),
+ * which do an AES round on four independent blocks in one 512-bit
+ * register, plus a stitched AES-GCM that also uses VPCLMULQDQ to do
+ * four GHASH multiplications at once.
+ *
+ * These process AES_VAES_BATCH blocks at a time, in four registers,
+ * and leave anything shorter than that to the AES-NI code in
+ * aes-ni.c, which shares the context structure.
+ */
+
+#include <immintrin.h>
+
+#if defined(__clang__) || defined(__GNUC__)
+#include <cpuid.h>
+#define GET_CPU_ID_0(out)                               \
+    __cpuid(0, (out)[0], (out)[1], (out)[2], (out)[3])
+#define GET_CPU_ID_1(out)                               \
+    __cpuid(1, (out)[0], (out)[1], (out)[2], (out)[3])
+#define GET_CPU_ID_7(out)                                       \
+    __cpuid_count(7, 0, (out)[0], (out)[1], (out)[2], (out)[3])
+static inline unsigned long long get_xcr0(void)
+{
+    unsigned lo, hi;
+    __asm__ volatile("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+    return ((unsigned long long)hi << 32) | lo;
+}
+#else
+#define GET_CPU_ID_0(out) __cpuid(out, 0)
+#define GET_CPU_ID_1(out) __cpuid(out, 1)
+#define GET_CPU_ID_7(out) __cpuidex(out, 7, 0)
+#define get_xcr0() _xgetbv(0)
+#endif
+
+#include "ssh.h"
+#include "aes.h"
+#include "aes-ni.h"
+#include "aesgcm-clmul.h"
+
+#define VAES_REGS (AES_VAES_BATCH / 4)
+
+bool aes_vaes_cpu_available(void)
+{
+    unsigned int CPUInfo[4];
+
+    GET_CPU_ID_0(CPUInfo);
+    if (CPUInfo[0] < 7)
+        return false;
+
+    /* The OS must be saving the AVX-512 register state (XCR0 bits 1,
+     * 2 and 5-7), which we can only ask it via XGETBV if OSXSAVE is
+     * set */
+    GET_CPU_ID_1(CPUInfo);
+    if (!(CPUInfo[2] & (1 << 27)))
+        return false;
+    if ((get_xcr0() & 0xE6) != 0xE6)
+        return false;
+
+    /* AVX512F and AVX512BW in EBX; VAES and VPCLMULQDQ in ECX */
+    GET_CPU_ID_7(CPUInfo);
+    return ((CPUInfo[1] & (1 << 16)) && (CPUInfo[1] & (1 << 30)) &&
+            (CPUInfo[2] & (1 << 9)) && (CPUInfo[2] & (1 << 10)));
+}
+
+/* Reverse the bytes of each 128-bit lane */
+static inline __m512i vaes_byteswap(__m512i v)
+{
+    const __m512i reverse = _mm512_broadcast_i32x4(_mm_setr_epi8(
+        15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0));
+    return _mm512_shuffle_epi8(v, reverse);
+}
+
+/*
+ * Add the 64-bit values in the low half of each lane of 'addend' to
+ * the 128-bit counters in the lanes of v, carrying into the high
+ * halves as necessary, as SDCTR requires.
+ */
+static inline __m512i vaes_sdctr_add(__m512i v, __m512i addend)
+{
+    __m512i sum = _mm512_add_epi64(v, addend);
+    __mmask8 carry = _mm512_cmplt_epu64_mask(sum, addend) & 0x55;
+    return _mm512_mask_add_epi64(sum, (__mmask8)(carry << 1), sum,
+                                 _mm512_set1_epi64(1));
+}
+
+/* GCM increments only the low 32 bits of its counter, modulo 2^32 */
+static inline __m512i vaes_gcm_add(__m512i v, __m512i addend)
+{
+    return _mm512_add_epi32(v, addend);
+}
+
+/*
+ * Set up the VAES_REGS registers of counters for the next batch, and
+ * advance ctx->iv past them. The counters in ctx->iv are byte-reversed
+ * (see aes-ni.h), so the arithmetic is done in that form and the
+ * result reversed afterwards.
+ */
+static inline void vaes_counters(aes_ni_context *ctx, __m512i *ctr,
+                                 bool sdctr)
+{
+    const __m512i lane_offsets = _mm512_setr_epi64(0,0, 1,0, 2,0, 3,0);
+    const __m512i four = _mm512_setr_epi64(4,0, 4,0, 4,0, 4,0);
+    __m512i v = _mm512_broadcast_i32x4(ctx->iv);
+
+    v = sdctr ? vaes_sdctr_add(v, lane_offsets) :
+        vaes_gcm_add(v, lane_offsets);
+    for (size_t j = 0; j < VAES_REGS; j++) {
+        ctr[j] = vaes_byteswap(v);
+        v = sdctr ? vaes_sdctr_add(v, four) : vaes_gcm_add(v, four);
+    }
+    ctx->iv = _mm512_castsi512_si128(v);
+}
+
+static inline void vaes_load_keys(aes_ni_context *ctx, __m512i *keys,
+                                  unsigned rounds)
+{
+    for (size_t r = 0; r <= rounds; r++)
+        keys[r] = _mm512_broadcast_i32x4(ctx->keysched_e[r]);
+}
+
+static inline size_t aes_vaes_ctr(aes_ni_context *ctx, uint8_t *blk,
+                                  size_t nblocks, bool sdctr)
+{
+    unsigned rounds = aes_ni_rounds(ctx);
+    __m512i keys[MAXROUNDKEYS];
+    size_t done;
+
+    vaes_load_keys(ctx, keys, rounds);
+
+    for (done = 0; nblocks - done >= AES_VAES_BATCH;
+         done += AES_VAES_BATCH) {
+        __m512i v[VAES_REGS];
+        uint8_t *p = blk + 16 * done;
+
+        vaes_counters(ctx, v, sdctr);
+        for (size_t j = 0; j < VAES_REGS; j++)
+            v[j] = _mm512_xor_si512(v[j], keys[0]);
+        for (size_t r = 1; r < rounds; r++)
+            for (size_t j = 0; j < VAES_REGS; j++)
+                v[j] = _mm512_aesenc_epi128(v[j], keys[r]);
+        for (size_t j = 0; j < VAES_REGS; j++) {
+            v[j] = _mm512_aesenclast_epi128(v[j], keys[rounds]);
+            _mm512_storeu_si512(p + 64 * j, _mm512_xor_si512(
+                                    _mm512_loadu_si512(p + 64 * j), v[j]));
+        }
+    }
+
+    smemclr(keys, sizeof(keys));
+    return done;
+}
+
+size_t aes_vaes_sdctr(aes_ni_context *ctx, uint8_t *blk, size_t nblocks)
+{
+    return aes_vaes_ctr(ctx, blk, nblocks, true);
+}
+
+size_t aes_vaes_gcm(aes_ni_context *ctx, uint8_t *blk, size_t nblocks)
+{
+    return aes_vaes_ctr(ctx, blk, nblocks, false);
+}
+
+/*
+ * Stitched AES-GCM, on the same plan as aesgcm-ni.c but four times as
+ * wide. Each register of ciphertext is multiplied lane by lane by the
+ * corresponding four powers of the hash key, and the four lanes of
+ * the unreduced products are only summed and reduced at the end of
+ * the group.
+ */
+static inline __m128i vaes_fold_lanes(__m512i v)
+{
+    __m256i h = _mm256_xor_si256(_mm512_castsi512_si256(v),
+                                 _mm512_extracti64x4_epi64(v, 1));
+    return _mm_xor_si128(_mm256_castsi256_si128(h),
+                         _mm256_extracti128_si256(h, 1));
+}
+
+#define VGHASH_STEP(j) do {                                             \
+        lo = _mm512_xor_si512(                                          \
+            lo, _mm512_clmulepi64_epi128(c[j], pow[j], 0x00));          \
+        hi = _mm512_xor_si512(                                          \
+            hi, _mm512_clmulepi64_epi128(c[j], pow[j], 0x11));          \
+        md = _mm512_xor_si512(                                          \
+            md, _mm512_clmulepi64_epi128(c[j], pow[j], 0x01));          \
+        md = _mm512_xor_si512(                                          \
+            md, _mm512_clmulepi64_epi128(c[j], pow[j], 0x10));          \
+    } while (0)
+
+static inline __m128i vghash_reduce(__m512i lo, __m512i md, __m512i hi)
+{
+    return ghash_clmul_reduce(vaes_fold_lanes(lo), vaes_fold_lanes(md),
+                              vaes_fold_lanes(hi));
+}
+
+static size_t aes_vaes_gcm_stitched_inner(
+    aes_ni_context *ctx, ghash_clmul *gh, uint8_t *blk, size_t len,
+    bool encrypt)
+{
+    unsigned rounds = aes_ni_rounds(ctx);
+    __m512i keys[MAXROUNDKEYS], pow[VAES_REGS], c[VAES_REGS];
+    __m128i acc = gh->acc;
+    bool pending = false;
+    size_t done;
+
+    vaes_load_keys(ctx, keys, rounds);
+
+    /* Block i of the group is multiplied by key^(AES_VAES_BATCH-i) */
+    {
+        __m128i desc[AES_VAES_BATCH];
+        for (size_t i = 0; i < AES_VAES_BATCH; i++)
+            desc[i] = gh->pow[AES_VAES_BATCH - 1 - i];
+        for (size_t j = 0; j < VAES_REGS; j++)
+            pow[j] = _mm512_loadu_si512(desc + 4 * j);
+    }
+
+    for (done = 0; len - done >= 16 * AES_VAES_BATCH;
+         done += 16 * AES_VAES_BATCH) {
+        uint8_t *p = blk + done;
+        __m512i v[VAES_REGS];
+        __m512i lo = _mm512_setzero_si512(), md = lo, hi = lo;
+
+        if (!encrypt) {
+            for (size_t j = 0; j < VAES_REGS; j++)
+                c[j] = vaes_byteswap(_mm512_loadu_si512(p + 64 * j));
+            pending = true;
+        }
+        if (pending)
+            c[0] = _mm512_xor_si512(c[0], _mm512_inserti32x4(
+                                        _mm512_setzero_si512(), acc, 0));
+
+        vaes_counters(ctx, v, false);
+        for (size_t j = 0; j < VAES_REGS; j++)
+            v[j] = _mm512_xor_si512(v[j], keys[0]);
+        for (size_t r = 1; r < rounds; r++) {
+            for (size_t j = 0; j < VAES_REGS; j++)
+                v[j] = _mm512_aesenc_epi128(v[j], keys[r]);
+            if (pending && r <= VAES_REGS)
+                VGHASH_STEP(r - 1);
+        }
+        for (size_t j = 0; j < VAES_REGS; j++)
+            v[j] = _mm512_aesenclast_epi128(v[j], keys[rounds]);
+
+        if (pending)
+            acc = vghash_reduce(lo, md, hi);
+
+        for (size_t j = 0; j < VAES_REGS; j++) {
+            __m512i out = _mm512_xor_si512(
+                _mm512_loadu_si512(p + 64 * j), v[j]);
+            _mm512_storeu_si512(p + 64 * j, out);
+            if (encrypt)
+                c[j] = vaes_byteswap(out);
+        }
+        pending = encrypt;
+    }
+
+    if (pending) {
+        __m512i lo = _mm512_setzero_si512(), md = lo, hi = lo;
+        c[0] = _mm512_xor_si512(c[0], _mm512_inserti32x4(
+                                    _mm512_setzero_si512(), acc, 0));
+        for (size_t j = 0; j < VAES_REGS; j++)
+            VGHASH_STEP(j);
+        acc = vghash_reduce(lo, md, hi);
+    }
+
+    gh->acc = acc;
+    smemclr(keys, sizeof(keys));
+    return done;
+}
+
+size_t aes_vaes_gcm_stitched(ssh_cipher *ciph, struct ghash_clmul *gh,
+                             void *vblk, size_t len, bool encrypt)
+{
+    aes_ni_context *ctx = container_of(ciph, aes_ni_context, ciph);
+    uint8_t *blk = (uint8_t *)vblk;
+
+    size_t done = aes_vaes_gcm_stitched_inner(ctx, gh, blk, len, encrypt);
+    return done + aes_ni_gcm_stitched(ciph, gh, blk + done, len - done,
+                                      encrypt);
+}
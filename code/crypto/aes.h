@@ -2,12 +2,18 @@
  * Definitions likely to be helpful to multiple AES implementations.
  */
 
+#ifndef PUTTY_CRYPTO_AES_H
+#define PUTTY_CRYPTO_AES_H
+
 /*
  * The 'extra' structure used by AES implementations is used to
  * include information about how to check if a given implementation is
  * available at run time, and whether we've already checked.
  */
 struct aes_extra_mutable;
+struct ghash_clmul;
+typedef size_t (*aes_gcm_stitched_fn)(ssh_cipher *, struct ghash_clmul *,
+                                      void *blk, size_t len, bool encrypt);
 struct aes_extra {
     /* Function to check availability. Might be expensive, so we don't
      * want to call it more than once. */
@@ -20,6 +26,13 @@ struct aes_extra {
      * in ECB mode without touching the IV. Used by AES-GCM MAC
      * setup. */
     void (*encrypt_ecb_block)(ssh_cipher *, void *);
+
+    /* Optional API function for GCM mode, used by the CLMUL AES-GCM
+     * MAC: encrypt or decrypt in GCM mode, folding the ciphertext into
+     * the MAC's GHASH state in the same pass. Processes as many whole
+     * multiples of the implementation's batch size as fit in len, and
+     * returns the number of bytes it dealt with. */
+    aes_gcm_stitched_fn gcm_stitched;
 };
 struct aes_extra_mutable {
     bool checked_availability;
@@ -46,6 +59,13 @@ static inline void aes_encrypt_ecb_block(ssh_cipher *ciph, void *blk)
     extra->encrypt_ecb_block(ciph, blk);
 }
 
+/* Return the stitched GCM kernel for a cipher, or NULL if it has none. */
+static inline aes_gcm_stitched_fn aes_gcm_stitched_kernel(ssh_cipher *ciph)
+{
+    const struct aes_extra *extra = ciph->vt->extra;
+    return extra->gcm_stitched;
+}
+
 /*
  * Macros to define vtables for AES variants. There are a lot of
  * these, because of the cross product between cipher modes, key
@@ -53,18 +73,21 @@ static inline void aes_encrypt_ecb_block(ssh_cipher *ciph, void *blk)
  * some effort here to reduce the boilerplate in the sub-files.
  */
 
-#define AES_EXTRA_BITS(impl_c, bits)                                    \
+#define AES_EXTRA_BITS(impl_c, bits, ...)                               \
     static struct aes_extra_mutable aes ## impl_c ## _extra_mut;        \
     static const struct aes_extra aes ## bits ## impl_c ## _extra = {   \
         .check_available = aes ## impl_c ## _available,                 \
         .mut = &aes ## impl_c ## _extra_mut,                            \
         .encrypt_ecb_block = &aes ## bits ## impl_c ## _encrypt_ecb_block, \
+        __VA_ARGS__                                                     \
     }
 
-#define AES_EXTRA(impl_c)                       \
-    AES_EXTRA_BITS(impl_c, 128);                \
-    AES_EXTRA_BITS(impl_c, 192);                \
-    AES_EXTRA_BITS(impl_c, 256)
+/* Any further arguments are extra fields for all three structures,
+ * e.g. '.gcm_stitched = foo' */
+#define AES_EXTRA(impl_c, ...)                  \
+    AES_EXTRA_BITS(impl_c, 128, __VA_ARGS__);   \
+    AES_EXTRA_BITS(impl_c, 192, __VA_ARGS__);   \
+    AES_EXTRA_BITS(impl_c, 256, __VA_ARGS__)
 
 #define AES_CBC_VTABLE(impl_c, impl_display, bits)                      \
     const ssh_cipheralg ssh_aes ## bits ## _cbc ## impl_c = {           \
@@ -97,7 +120,7 @@ static inline void aes_encrypt_ecb_block(ssh_cipher *ciph, void *blk)
         .blksize = 16,                                                  \
         .real_keybits = bits,                                           \
         .padded_keybytes = bits/8,                                      \
-        .flags = 0,                                                     \
+        .flags = SSH_CIPHER_IV_COUNTS_BLOCKS,                           \
         .text_name = "AES-" #bits " SDCTR (" impl_display ")",          \
         .extra = &aes ## bits ## impl_c ## _extra,                      \
     }
@@ -120,7 +143,8 @@ static inline void aes_encrypt_ecb_block(ssh_cipher *ciph, void *blk)
         .blksize = 16,                                                  \
         .real_keybits = bits,                                           \
         .padded_keybytes = bits/8,                                      \
-        .flags = SSH_CIPHER_SEPARATE_LENGTH,                            \
+        .flags = (SSH_CIPHER_SEPARATE_LENGTH |                          \
+                  SSH_CIPHER_IV_COUNTS_MESSAGES),                       \
         .text_name = "AES-" #bits " GCM (" impl_display ")",            \
         .required_mac = &ssh2_aesgcm_mac,                               \
         .extra = &aes ## bits ## impl_c ## _extra,                      \
@@ -158,3 +182,5 @@ extern const uint8_t aes_key_setup_round_constants[10];
  * The largest number of round keys ever needed.
  */
 #define MAXROUNDKEYS 15
+
+#endif /* PUTTY_CRYPTO_AES_H */
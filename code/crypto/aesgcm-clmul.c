@@ -19,11 +19,14 @@
 #endif
 
 #include "ssh.h"
+#include "aes.h"
 #include "aesgcm.h"
+#include "aesgcm-clmul.h"
 
 typedef struct aesgcm_clmul {
     AESGCM_COMMON_FIELDS;
-    __m128i var, acc, mask;
+    ghash_clmul gh;
+    __m128i mask;
     void *ptr_to_free;
 } aesgcm_clmul;
 
@@ -63,33 +66,22 @@ static void aesgcm_clmul_free(aesgcm_clmul *ctx)
     sfree(ptf);
 }
 
-/* Helper function to reverse the 16 bytes in a 128-bit vector */
-static inline __m128i mm_byteswap(__m128i vec)
-{
-    const __m128i reverse = _mm_set_epi64x(
-        0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
-    return _mm_shuffle_epi8(vec, reverse);
-}
-
-/* Helper function to swap the two 64-bit words in a 128-bit vector */
-static inline __m128i mm_wordswap(__m128i vec)
-{
-    return _mm_shuffle_epi32(vec, 0x4E);
-}
-
 /* Load and store a 128-bit vector in big-endian fashion */
 static inline __m128i mm_load_be(const void *p)
 {
-    return mm_byteswap(_mm_loadu_si128(p));
+    return ghash_clmul_byteswap(_mm_loadu_si128(p));
 }
 static inline void mm_store_be(void *p, __m128i vec)
 {
-    _mm_storeu_si128(p, mm_byteswap(vec));
+    _mm_storeu_si128(p, ghash_clmul_byteswap(vec));
 }
 
 /*
  * Key setup is just like in aesgcm-ref-poly.c. There's no point using
  * vector registers to accelerate this, because it happens rarely.
+ *
+ * We also precompute the first few powers of the key, for the
+ * stitched kernels that fold in several blocks at once.
  */
 static void aesgcm_clmul_setkey_impl(aesgcm_clmul *ctx,
                                      const unsigned char *var)
@@ -102,79 +94,114 @@ static void aesgcm_clmul_setkey_impl(aesgcm_clmul *ctx,
     lo = (lo << 1) ^ bit;
     hi ^= 0xC200000000000000 & -bit;
 
-    ctx->var = _mm_set_epi64x(hi, lo);
+    ctx->gh.pow[0] = _mm_set_epi64x(hi, lo);
+    for (size_t i = 1; i < GHASH_CLMUL_POWERS; i++)
+        ctx->gh.pow[i] = ghash_clmul_mul(ctx->gh.pow[i-1], ctx->gh.pow[0]);
 }
 
 static inline void aesgcm_clmul_setup(aesgcm_clmul *ctx,
                                       const unsigned char *mask)
 {
     ctx->mask = mm_load_be(mask);
-    ctx->acc = _mm_set_epi64x(0, 0);
+    ctx->gh.acc = _mm_set_epi64x(0, 0);
 }
 
 /*
  * Folding a coefficient into the accumulator is done by essentially
- * the algorithm in aesgcm-ref-poly.c. I don't speak these intrinsics
- * all that well, so in the parts where I needed to XOR half of one
- * vector into half of another, I did a lot of faffing about with
- * masks like 0xFFFFFFFFFFFFFFFF0000000000000000. Very likely this can
- * be streamlined by a better x86-speaker than me. Patches welcome.
+ * the algorithm in aesgcm-ref-poly.c; the x86-specific details are in
+ * aesgcm-clmul.h, where the stitched kernels can share them.
  */
 static inline void aesgcm_clmul_coeff(aesgcm_clmul *ctx,
                                       const unsigned char *coeff)
 {
-    ctx->acc = _mm_xor_si128(ctx->acc, mm_load_be(coeff));
-
-    /* Compute ah^al and bh^bl by word-swapping each of a and b and
-     * XORing with the original. That does more work than necessary -
-     * you end up with each of the desired values repeated twice -
-     * but I don't know of a neater way. */
-    __m128i aswap = mm_wordswap(ctx->acc);
-    __m128i vswap = mm_wordswap(ctx->var);
-    aswap = _mm_xor_si128(ctx->acc, aswap);
-    vswap = _mm_xor_si128(ctx->var, vswap);
-
-    /* Do the three multiplications required by Karatsuba */
-    __m128i md = _mm_clmulepi64_si128(aswap, vswap, 0x00);
-    __m128i lo = _mm_clmulepi64_si128(ctx->acc, ctx->var, 0x00);
-    __m128i hi = _mm_clmulepi64_si128(ctx->acc, ctx->var, 0x11);
-    /* Combine lo and hi into md */
-    md = _mm_xor_si128(md, lo);
-    md = _mm_xor_si128(md, hi);
-
-    /* Now we must XOR the high half of md into the low half of hi,
-     * and the low half of md into the high half of hi. Simplest thing
-     * is to swap the words of md (so that each one lines up with the
-     * register it's going to end up in), and then mask one off in
-     * each case. */
-    md = mm_wordswap(md);
-    lo = _mm_xor_si128(lo, _mm_and_si128(md, _mm_set_epi64x(~0ULL, 0ULL)));
-    hi = _mm_xor_si128(hi, _mm_and_si128(md, _mm_set_epi64x(0ULL, ~0ULL)));
-
-    /* The reduction stage is transformed similarly from the version
-     * in aesgcm-ref-poly.c. */
-    __m128i r1 = _mm_clmulepi64_si128(_mm_set_epi64x(0, 0xC200000000000000),
-                                     lo, 0x00);
-    r1 = mm_wordswap(r1);
-    r1 = _mm_xor_si128(r1, lo);
-    hi = _mm_xor_si128(hi, _mm_and_si128(r1, _mm_set_epi64x(~0ULL, 0ULL)));
-
-    __m128i r2 = _mm_clmulepi64_si128(_mm_set_epi64x(0, 0xC200000000000000),
-                                     r1, 0x10);
-    hi = _mm_xor_si128(hi, r2);
-    hi = _mm_xor_si128(hi, _mm_and_si128(r1, _mm_set_epi64x(0ULL, ~0ULL)));
-
-    ctx->acc = hi;
+    ctx->gh.acc = ghash_clmul_mul(
+        _mm_xor_si128(ctx->gh.acc, mm_load_be(coeff)), ctx->gh.pow[0]);
 }
 
 static inline void aesgcm_clmul_output(aesgcm_clmul *ctx,
                                        unsigned char *output)
 {
-    mm_store_be(output, _mm_xor_si128(ctx->acc, ctx->mask));
-    smemclr(&ctx->acc, 16);
+    mm_store_be(output, _mm_xor_si128(ctx->gh.acc, ctx->mask));
+    smemclr(&ctx->gh.acc, 16);
     smemclr(&ctx->mask, 16);
 }
 
+/*
+ * If the AES cipher this MAC is paired with can run a stitched
+ * AES-GCM kernel against our GHASH state, then we can offer the
+ * combined encrypt-and-MAC operations, which do the bulk of the
+ * packet in one pass through the data instead of two.
+ *
+ * This only works in the SSH configuration of the MAC, with a 4-byte
+ * sequence number to skip and then 4 bytes of associated data (the
+ * packet length field). After those, the polynomial accumulator is
+ * on a block boundary, so that the kernel can take over directly.
+ */
+static aes_gcm_stitched_fn aesgcm_clmul_stitched(aesgcm_clmul *ctx)
+{
+    if (ctx->skiplen != 4 || ctx->aadlen != 4)
+        return NULL;
+    return aes_gcm_stitched_kernel(ctx->cipher);
+}
+
+static void aesgcm_clmul_aead_encrypt(ssh2_mac *mac, void *vblk, int len,
+                                      unsigned long seq)
+{
+    aesgcm_clmul *ctx = container_of(mac, aesgcm_clmul, mac);
+    unsigned char *blk = (unsigned char *)vblk;
+    aes_gcm_stitched_fn stitched = aesgcm_clmul_stitched(ctx);
+
+    if (!stitched) {
+        ssh_cipher_encrypt(ctx->cipher, blk + 4, len - 4);
+        ssh2_mac_generate(mac, blk, len, seq);
+        return;
+    }
+
+    ssh2_mac_start(mac);
+    put_uint32(mac, seq);
+    put_data(mac, blk, 4);
+
+    size_t done = stitched(ctx->cipher, &ctx->gh, blk + 4, len - 4, true);
+    ctx->ciphertextlen += done;
+
+    ssh_cipher_encrypt(ctx->cipher, blk + 4 + done, len - 4 - done);
+    put_data(mac, blk + 4 + done, len - 4 - done);
+    ssh2_mac_genresult(mac, blk + len);
+}
+
+static bool aesgcm_clmul_aead_decrypt(ssh2_mac *mac, void *vblk, int len,
+                                      unsigned long seq)
+{
+    aesgcm_clmul *ctx = container_of(mac, aesgcm_clmul, mac);
+    unsigned char *blk = (unsigned char *)vblk;
+    aes_gcm_stitched_fn stitched = aesgcm_clmul_stitched(ctx);
+
+    if (!stitched) {
+        if (!ssh2_mac_verify(mac, blk, len, seq))
+            return false;
+        ssh_cipher_decrypt(ctx->cipher, blk + 4, len - 4);
+        return true;
+    }
+
+    /*
+     * Here the decryption happens before we know whether the MAC is
+     * right. That's harmless: a caller seeing a MAC failure must
+     * discard the whole packet anyway, and the cipher and MAC state
+     * are both reset by next_message before the next one.
+     */
+    ssh2_mac_start(mac);
+    put_uint32(mac, seq);
+    put_data(mac, blk, 4);
+
+    size_t done = stitched(ctx->cipher, &ctx->gh, blk + 4, len - 4, false);
+    ctx->ciphertextlen += done;
+
+    put_data(mac, blk + 4 + done, len - 4 - done);
+    ssh_cipher_decrypt(ctx->cipher, blk + 4 + done, len - 4 - done);
+    return ssh2_mac_verresult(mac, blk + len);
+}
+
+#define AESGCM_AEAD
 #define AESGCM_FLAVOUR clmul
 #define AESGCM_NAME "CLMUL accelerated"
 #include "aesgcm-footer.h"
@@ -0,0 +1,86 @@
+/*
+ * GHASH state and arithmetic shared between the CLMUL implementation
+ * of the AES-GCM MAC (aesgcm-clmul.c) and the 'stitched' AES-GCM
+ * kernels that do the same arithmetic interleaved with the AES rounds
+ * (aesgcm-ni.c and aes-vaes.c).
+ *
+ * Field elements are held in the representation aesgcm-clmul.c uses:
+ * each 16-byte block byte-reversed into an __m128i, and the hash key
+ * premultiplied by x so that the product of two elements comes out
+ * of the reduction step already in the right form. Because the
+ * multiplication is bilinear, that also means a power of the key can
+ * be computed by just multiplying the previous power by the key.
+ *
+ * Keeping several powers of the key lets a stitched kernel fold in a
+ * whole group of n coefficients at once, as
+ *
+ *   (acc + c_0) H^n + c_1 H^(n-1) + ... + c_(n-1) H
+ *
+ * which needs only one reduction at the end, and whose n
+ * multiplications are independent and can overlap with each other
+ * and with the AES instructions.
+ */
+
+#include <wmmintrin.h>
+#include <tmmintrin.h>
+
+#define GHASH_CLMUL_POWERS 16
+
+typedef struct ghash_clmul {
+    /* pow[i] is the hash key raised to the power i+1 */
+    __m128i pow[GHASH_CLMUL_POWERS];
+    __m128i acc;
+} ghash_clmul;
+
+/* Reverse the 16 bytes of a vector, converting between the order of
+ * a data block and the representation described above */
+static inline __m128i ghash_clmul_byteswap(__m128i vec)
+{
+    const __m128i reverse = _mm_set_epi64x(
+        0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    return _mm_shuffle_epi8(vec, reverse);
+}
+
+/*
+ * Accumulate the unreduced 256-bit product a*b into three partial
+ * sums: 'lo' and 'hi' for the products of the matching halves, and
+ * 'md' for the two cross terms, which straddle the two. (Karatsuba
+ * would save one multiplication here, but costs enough extra XORs
+ * and shuffles that when lots of products are being summed, it's not
+ * a win.)
+ */
+static inline void ghash_clmul_mul_acc(__m128i a, __m128i b, __m128i *lo,
+                                       __m128i *md, __m128i *hi)
+{
+    *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+    *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+    *md = _mm_xor_si128(*md, _mm_clmulepi64_si128(a, b, 0x01));
+    *md = _mm_xor_si128(*md, _mm_clmulepi64_si128(a, b, 0x10));
+}
+
+/*
+ * Combine the partial sums from ghash_clmul_mul_acc and reduce the
+ * result to a field element. The reduction is the one described in
+ * aesgcm-ref-poly.c, using the constant 0xC2...0 twice.
+ */
+static inline __m128i ghash_clmul_reduce(__m128i lo, __m128i md, __m128i hi)
+{
+    const __m128i poly = _mm_set_epi64x(0, 0xC200000000000000);
+
+    lo = _mm_xor_si128(lo, _mm_slli_si128(md, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(md, 8));
+
+    __m128i r1 = _mm_clmulepi64_si128(poly, lo, 0x00);
+    r1 = _mm_shuffle_epi32(r1, 0x4E);
+    r1 = _mm_xor_si128(r1, lo);
+    __m128i r2 = _mm_clmulepi64_si128(poly, r1, 0x10);
+
+    return _mm_xor_si128(hi, _mm_xor_si128(r1, r2));
+}
+
+static inline __m128i ghash_clmul_mul(__m128i a, __m128i b)
+{
+    __m128i lo = _mm_setzero_si128(), md = lo, hi = lo;
+    ghash_clmul_mul_acc(a, b, &lo, &md, &hi);
+    return ghash_clmul_reduce(lo, md, hi);
+}
@@ -89,6 +89,16 @@
  *    // Zero out the state structure to avoid information leaks if the
  *    // memory is reused, and then free it.
  *    static void aesgcm_foo_free(aesgcm_foo *ctx);
+ *
+ *  - if the implementation can combine the cipher and MAC operations
+ *    on a whole packet, #define AESGCM_AEAD and define these, with
+ *    the semantics of ssh2_mac_encrypt_and_generate and
+ *    ssh2_mac_verify_and_decrypt in ssh.h:
+ *
+ *    static void aesgcm_foo_aead_encrypt(ssh2_mac *mac, void *blk,
+ *                                        int len, unsigned long seq);
+ *    static bool aesgcm_foo_aead_decrypt(ssh2_mac *mac, void *blk,
+ *                                        int len, unsigned long seq);
  */
 
 #ifndef AESGCM_FLAVOUR
@@ -360,6 +370,10 @@ const ssh2_macalg CAT(ssh2_aesgcm_mac_, AESGCM_FLAVOUR) = {
     .genresult = PREFIX(mac_genresult),
     .next_message = PREFIX(mac_next_message),
     .text_name = PREFIX(mac_text_name),
+#ifdef AESGCM_AEAD
+    .aead_encrypt = PREFIX(aead_encrypt),
+    .aead_decrypt = PREFIX(aead_decrypt),
+#endif
     .name = "",
     .etm_name = "", /* Not selectable independently */
     .len = 16,
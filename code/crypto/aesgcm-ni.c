@@ -0,0 +1,114 @@
+/*
+ * Stitched AES-GCM using AES-NI and CLMUL together.
+ *
+ * Encrypting a packet in GCM and then running GHASH over the result
+ * goes through the data twice, and in each pass one of the two
+ * execution units involved sits idle. Here we process
+ * AES_NI_BATCH blocks at a time, interleaving the AESENC rounds for
+ * one group of counter blocks with the carry-less multiplications
+ * that fold a group of ciphertext blocks into the hash, so that both
+ * run at once.
+ *
+ * When decrypting, the ciphertext is available up front, so each
+ * group hashes the same blocks it's decrypting. When encrypting, a
+ * group's ciphertext doesn't exist until its AES rounds are done, so
+ * each group instead hashes the previous one's output, and the last
+ * group is hashed on its own at the end.
+ */
+
+#include "ssh.h"
+#include "aes.h"
+#include "aes-ni.h"
+#include "aesgcm-clmul.h"
+
+/*
+ * Fold AES_NI_BATCH blocks of ciphertext into the hash accumulator,
+ * one block per round of the AES loop from 1 upwards. c[] holds the
+ * blocks in GHASH representation, with the old accumulator already
+ * XORed into c[0].
+ */
+#define GHASH_STEP(r)                                                   \
+    ghash_clmul_mul_acc(c[(r)-1], gh->pow[AES_NI_BATCH-(r)], &lo, &md, &hi)
+
+static inline __m128i ghash_group(ghash_clmul *gh, __m128i *c)
+{
+    __m128i lo = _mm_setzero_si128(), md = lo, hi = lo;
+    for (size_t r = 1; r <= AES_NI_BATCH; r++)
+        GHASH_STEP(r);
+    return ghash_clmul_reduce(lo, md, hi);
+}
+
+static inline size_t aes_ni_gcm_stitched_inner(
+    aes_ni_context *ctx, ghash_clmul *gh, uint8_t *blk, size_t len,
+    bool encrypt, const unsigned rounds)
+{
+    const __m128i *ks = ctx->keysched_e;
+    __m128i c[AES_NI_BATCH];
+    bool pending = false;
+    size_t done;
+
+    for (done = 0; len - done >= 16 * AES_NI_BATCH;
+         done += 16 * AES_NI_BATCH) {
+        __m128i *p = (__m128i *)(blk + done);
+        __m128i v[AES_NI_BATCH];
+        __m128i lo = _mm_setzero_si128(), md = lo, hi = lo;
+
+        if (!encrypt) {
+            for (size_t i = 0; i < AES_NI_BATCH; i++)
+                c[i] = ghash_clmul_byteswap(_mm_loadu_si128(p + i));
+            pending = true;
+        }
+        if (pending)
+            c[0] = _mm_xor_si128(c[0], gh->acc);
+
+        for (size_t i = 0; i < AES_NI_BATCH; i++) {
+            v[i] = _mm_xor_si128(aes_ni_sdctr_reverse(ctx->iv), ks[0]);
+            ctx->iv = aes_ni_gcm_increment(ctx->iv);
+        }
+
+        /* Every key length has at least AES_NI_BATCH middle rounds */
+        for (size_t r = 1; r < rounds; r++) {
+            for (size_t i = 0; i < AES_NI_BATCH; i++)
+                v[i] = _mm_aesenc_si128(v[i], ks[r]);
+            if (pending && r <= AES_NI_BATCH)
+                GHASH_STEP(r);
+        }
+        for (size_t i = 0; i < AES_NI_BATCH; i++)
+            v[i] = _mm_aesenclast_si128(v[i], ks[rounds]);
+
+        if (pending)
+            gh->acc = ghash_clmul_reduce(lo, md, hi);
+
+        for (size_t i = 0; i < AES_NI_BATCH; i++) {
+            __m128i out = _mm_xor_si128(_mm_loadu_si128(p + i), v[i]);
+            _mm_storeu_si128(p + i, out);
+            if (encrypt)
+                c[i] = ghash_clmul_byteswap(out);
+        }
+        pending = encrypt;
+    }
+
+    if (pending) {
+        c[0] = _mm_xor_si128(c[0], gh->acc);
+        gh->acc = ghash_group(gh, c);
+    }
+
+    return done;
+}
+
+size_t aes_ni_gcm_stitched(ssh_cipher *ciph, struct ghash_clmul *gh,
+                           void *blk, size_t len, bool encrypt)
+{
+    aes_ni_context *ctx = container_of(ciph, aes_ni_context, ciph);
+
+    switch (aes_ni_rounds(ctx)) {
+      case 10:
+        return aes_ni_gcm_stitched_inner(ctx, gh, blk, len, encrypt, 10);
+      case 12:
+        return aes_ni_gcm_stitched_inner(ctx, gh, blk, len, encrypt, 12);
+      case 14:
+        return aes_ni_gcm_stitched_inner(ctx, gh, blk, len, encrypt, 14);
+      default:
+        unreachable("bad AES round count");
+    }
+}
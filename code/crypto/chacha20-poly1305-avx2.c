@@ -0,0 +1,519 @@
+/*
+ * Implementation of the bulk parts of ChaCha20-Poly1305 using x86
+ * AVX2 instructions.
+ *
+ * ChaCha20 is done eight blocks at a time, 'vertically': each of the
+ * 16 state words lives in its own 256-bit register, with one lane per
+ * block, so the rounds are exactly the scalar ones applied to eight
+ * counter values at once. At the end the 16x8 words are transposed
+ * back into eight consecutive blocks of keystream. Leftovers are done
+ * four at a time in the same way with 128-bit registers.
+ *
+ * Poly1305 uses the well-known radix-2^26 representation, in which
+ * 130-bit numbers are five limbs each small enough that the 32x32 ->
+ * 64-bit multiplier can form all the partial products of a
+ * multiplication mod 2^130-5 without overflow. Four independent
+ * Horner evaluations run in the four 64-bit lanes, each stepping
+ * through every fourth message block and multiplying by r^4; at the
+ * end, lane i is multiplied by r^(4-i) and the lanes summed, which
+ * gives the same polynomial as the sequential evaluation.
+ */
+
+#include <immintrin.h>
+
+#if defined(__clang__) || defined(__GNUC__)
+#include <cpuid.h>
+#define GET_CPU_ID_0(out)                               \
+    __cpuid(0, (out)[0], (out)[1], (out)[2], (out)[3])
+#define GET_CPU_ID_1(out)                               \
+    __cpuid(1, (out)[0], (out)[1], (out)[2], (out)[3])
+#define GET_CPU_ID_7(out)                                       \
+    __cpuid_count(7, 0, (out)[0], (out)[1], (out)[2], (out)[3])
+static inline unsigned long long get_xcr0(void)
+{
+    unsigned lo, hi;
+    __asm__ volatile("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+    return ((unsigned long long)hi << 32) | lo;
+}
+#else
+#define GET_CPU_ID_0(out) __cpuid(out, 0)
+#define GET_CPU_ID_1(out) __cpuid(out, 1)
+#define GET_CPU_ID_7(out) __cpuidex(out, 7, 0)
+#define get_xcr0() _xgetbv(0)
+#endif
+
+#include "ssh.h"
+#include "chacha20-poly1305.h"
+
+static bool ccp_avx2_available(void)
+{
+    /*
+     * AVX2 needs both the CPU to support it and the OS to have
+     * enabled saving of the YMM registers (XCR0 bits 1 and 2), which
+     * we can only check once we know XGETBV exists (OSXSAVE).
+     */
+    unsigned int CPUInfo[4];
+    GET_CPU_ID_0(CPUInfo);
+    if (CPUInfo[0] < 7)
+        return false;
+
+    GET_CPU_ID_1(CPUInfo);
+    if (!(CPUInfo[2] & (1 << 27)))     /* OSXSAVE */
+        return false;
+    if ((get_xcr0() & 6) != 6)
+        return false;
+
+    GET_CPU_ID_7(CPUInfo);
+    return CPUInfo[1] & (1 << 5);       /* AVX2 */
+}
+
+/* ----------------------------------------------------------------------
+ * ChaCha20.
+ */
+
+/*
+ * Rotations by 16 and 8 bits are byte permutations, so pshufb does
+ * them in one instruction; the others need two shifts and an OR.
+ */
+#define ROT16_SHUF() _mm_set_epi8(13, 12, 15, 14, 9, 8, 11, 10,  \
+                                  5, 4, 7, 6, 1, 0, 3, 2)
+#define ROT8_SHUF() _mm_set_epi8(14, 13, 12, 15, 10, 9, 8, 11,   \
+                                 6, 5, 4, 7, 2, 1, 0, 3)
+
+#define QROUND(x, a, b, c, d, add, xor, rot16, rot12, rot8, rot7)   \
+    do {                                                            \
+        x[a] = add(x[a], x[b]); x[d] = xor(x[d], x[a]);             \
+        x[d] = rot16(x[d]);                                         \
+        x[c] = add(x[c], x[d]); x[b] = xor(x[b], x[c]);             \
+        x[b] = rot12(x[b]);                                         \
+        x[a] = add(x[a], x[b]); x[d] = xor(x[d], x[a]);             \
+        x[d] = rot8(x[d]);                                          \
+        x[c] = add(x[c], x[d]); x[b] = xor(x[b], x[c]);             \
+        x[b] = rot7(x[b]);                                          \
+    } while (0)
+
+#define DOUBLEROUND(x, add, xor, r16, r12, r8, r7)                  \
+    do {                                                            \
+        QROUND(x, 0, 4,  8, 12, add, xor, r16, r12, r8, r7);        \
+        QROUND(x, 1, 5,  9, 13, add, xor, r16, r12, r8, r7);        \
+        QROUND(x, 2, 6, 10, 14, add, xor, r16, r12, r8, r7);        \
+        QROUND(x, 3, 7, 11, 15, add, xor, r16, r12, r8, r7);        \
+        QROUND(x, 0, 5, 10, 15, add, xor, r16, r12, r8, r7);        \
+        QROUND(x, 1, 6, 11, 12, add, xor, r16, r12, r8, r7);        \
+        QROUND(x, 2, 7,  8, 13, add, xor, r16, r12, r8, r7);        \
+        QROUND(x, 3, 4,  9, 14, add, xor, r16, r12, r8, r7);        \
+    } while (0)
+
+/* 256-bit versions of the primitive operations */
+#define ADD8(a, b) _mm256_add_epi32(a, b)
+#define XOR8(a, b) _mm256_xor_si256(a, b)
+#define ROTL8(v, n) _mm256_or_si256(_mm256_slli_epi32(v, n),        \
+                                    _mm256_srli_epi32(v, 32 - (n)))
+#define ROT16_8(v) _mm256_shuffle_epi8(v, rot16)
+#define ROT12_8(v) ROTL8(v, 12)
+#define ROT8_8(v) _mm256_shuffle_epi8(v, rot8)
+#define ROT7_8(v) ROTL8(v, 7)
+
+/* 128-bit versions */
+#define ADD4(a, b) _mm_add_epi32(a, b)
+#define XOR4(a, b) _mm_xor_si128(a, b)
+#define ROTL4(v, n) _mm_or_si128(_mm_slli_epi32(v, n),              \
+                                 _mm_srli_epi32(v, 32 - (n)))
+#define ROT16_4(v) _mm_shuffle_epi8(v, rot16)
+#define ROT12_4(v) ROTL4(v, 12)
+#define ROT8_4(v) _mm_shuffle_epi8(v, rot8)
+#define ROT7_4(v) ROTL4(v, 7)
+
+/*
+ * Transpose eight registers of eight 32-bit words, so that on output
+ * v[j] contains word j of each input register.
+ */
+static inline void transpose8(__m256i *v)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(v[0], v[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(v[0], v[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(v[2], v[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(v[2], v[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(v[4], v[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(v[4], v[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(v[6], v[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(v[6], v[7]);
+
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    v[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    v[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    v[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    v[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    v[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    v[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    v[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    v[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/* The same, for four registers of four words */
+static inline void transpose4(__m128i *v)
+{
+    __m128i t0 = _mm_unpacklo_epi32(v[0], v[1]);
+    __m128i t1 = _mm_unpackhi_epi32(v[0], v[1]);
+    __m128i t2 = _mm_unpacklo_epi32(v[2], v[3]);
+    __m128i t3 = _mm_unpackhi_epi32(v[2], v[3]);
+
+    v[0] = _mm_unpacklo_epi64(t0, t2);
+    v[1] = _mm_unpackhi_epi64(t0, t2);
+    v[2] = _mm_unpacklo_epi64(t1, t3);
+    v[3] = _mm_unpackhi_epi64(t1, t3);
+}
+
+/* XOR eight blocks of keystream, with counters starting at ctr, into data */
+static inline void chacha20_avx2_8blocks(
+    const uint32_t *state, uint64_t ctr, unsigned char *data)
+{
+    const __m256i rot16 = _mm256_broadcastsi128_si256(ROT16_SHUF());
+    const __m256i rot8 = _mm256_broadcastsi128_si256(ROT8_SHUF());
+    __m256i x[16], in[16];
+
+    for (int i = 0; i < 16; i++)
+        in[i] = _mm256_set1_epi32(state[i]);
+    in[12] = _mm256_set_epi32(
+        (uint32_t)(ctr + 7), (uint32_t)(ctr + 6),
+        (uint32_t)(ctr + 5), (uint32_t)(ctr + 4),
+        (uint32_t)(ctr + 3), (uint32_t)(ctr + 2),
+        (uint32_t)(ctr + 1), (uint32_t)(ctr + 0));
+    in[13] = _mm256_set_epi32(
+        (uint32_t)((ctr + 7) >> 32), (uint32_t)((ctr + 6) >> 32),
+        (uint32_t)((ctr + 5) >> 32), (uint32_t)((ctr + 4) >> 32),
+        (uint32_t)((ctr + 3) >> 32), (uint32_t)((ctr + 2) >> 32),
+        (uint32_t)((ctr + 1) >> 32), (uint32_t)((ctr + 0) >> 32));
+
+    for (int i = 0; i < 16; i++)
+        x[i] = in[i];
+    for (int i = 0; i < 20; i += 2)
+        DOUBLEROUND(x, ADD8, XOR8, ROT16_8, ROT12_8, ROT8_8, ROT7_8);
+    for (int i = 0; i < 16; i++)
+        x[i] = _mm256_add_epi32(x[i], in[i]);
+
+    /* Now x[0..7] transpose to the first halves of the eight blocks,
+     * and x[8..15] to the second halves */
+    transpose8(x);
+    transpose8(x + 8);
+
+    for (int b = 0; b < 8; b++) {
+        __m256i *p = (__m256i *)(data + 64 * b);
+        _mm256_storeu_si256(p, _mm256_xor_si256(
+                                _mm256_loadu_si256(p), x[b]));
+        _mm256_storeu_si256(p + 1, _mm256_xor_si256(
+                                _mm256_loadu_si256(p + 1), x[b + 8]));
+    }
+}
+
+/* Generate four blocks of keystream, with counters starting at ctr */
+static inline void chacha20_avx2_4blocks(
+    const uint32_t *state, uint64_t ctr, unsigned char *out)
+{
+    const __m128i rot16 = ROT16_SHUF();
+    const __m128i rot8 = ROT8_SHUF();
+    __m128i x[16], in[16];
+
+    for (int i = 0; i < 16; i++)
+        in[i] = _mm_set1_epi32(state[i]);
+    in[12] = _mm_set_epi32(
+        (uint32_t)(ctr + 3), (uint32_t)(ctr + 2),
+        (uint32_t)(ctr + 1), (uint32_t)(ctr + 0));
+    in[13] = _mm_set_epi32(
+        (uint32_t)((ctr + 3) >> 32), (uint32_t)((ctr + 2) >> 32),
+        (uint32_t)((ctr + 1) >> 32), (uint32_t)((ctr + 0) >> 32));
+
+    for (int i = 0; i < 16; i++)
+        x[i] = in[i];
+    for (int i = 0; i < 20; i += 2)
+        DOUBLEROUND(x, ADD4, XOR4, ROT16_4, ROT12_4, ROT8_4, ROT7_4);
+    for (int i = 0; i < 16; i++)
+        x[i] = _mm_add_epi32(x[i], in[i]);
+
+    /* Each group of four words transposes to one quarter of each of
+     * the four blocks */
+    for (int q = 0; q < 4; q++) {
+        transpose4(x + 4 * q);
+        for (int b = 0; b < 4; b++)
+            _mm_storeu_si128((__m128i *)(out + 64 * b + 16 * q),
+                             x[4 * q + b]);
+    }
+}
+
+static void chacha20_avx2_xor_blocks(uint32_t *state, unsigned char *data,
+                                     size_t nblocks)
+{
+    uint64_t ctr = state[12] | ((uint64_t)state[13] << 32);
+
+    for (; nblocks >= 8; nblocks -= 8, data += 512, ctr += 8)
+        chacha20_avx2_8blocks(state, ctr, data);
+
+    while (nblocks > 0) {
+        unsigned char ks[256];
+        size_t n = nblocks < 4 ? nblocks : 4;
+
+        chacha20_avx2_4blocks(state, ctr, ks);
+        for (size_t i = 0; i < 64 * n; i++)
+            data[i] ^= ks[i];
+        smemclr(ks, sizeof(ks));
+
+        nblocks -= n;
+        data += 64 * n;
+        ctr += n;
+    }
+
+    state[12] = (uint32_t)ctr;
+    state[13] = (uint32_t)(ctr >> 32);
+}
+
+/* ----------------------------------------------------------------------
+ * Poly1305.
+ */
+
+#define MASK26 0x3ffffff
+
+typedef struct r26 {
+    uint64_t v[5];
+} r26;
+
+/* Convert a little-endian number of up to 17 bytes into limbs */
+static inline void r26_import(r26 *x, const unsigned char *p, unsigned top)
+{
+    uint64_t lo = GET_64BIT_LSB_FIRST(p), hi = GET_64BIT_LSB_FIRST(p + 8);
+    x->v[0] = lo & MASK26;
+    x->v[1] = (lo >> 26) & MASK26;
+    x->v[2] = ((lo >> 52) | (hi << 12)) & MASK26;
+    x->v[3] = (hi >> 14) & MASK26;
+    x->v[4] = (hi >> 40) | ((uint64_t)top << 24);
+}
+
+/*
+ * Propagate carries so that every limb is back below 2^26, except
+ * that the top one may exceed it slightly. Carries off the top wrap
+ * round to the bottom multiplied by 5, since 2^130 = 5 mod p.
+ */
+static inline void r26_carry(r26 *x)
+{
+    uint64_t c;
+    c = x->v[0] >> 26; x->v[0] &= MASK26; x->v[1] += c;
+    c = x->v[1] >> 26; x->v[1] &= MASK26; x->v[2] += c;
+    c = x->v[2] >> 26; x->v[2] &= MASK26; x->v[3] += c;
+    c = x->v[3] >> 26; x->v[3] &= MASK26; x->v[4] += c;
+    c = x->v[4] >> 26; x->v[4] &= MASK26; x->v[0] += c * 5;
+    c = x->v[0] >> 26; x->v[0] &= MASK26; x->v[1] += c;
+    c = x->v[1] >> 26; x->v[1] &= MASK26; x->v[2] += c;
+    c = x->v[2] >> 26; x->v[2] &= MASK26; x->v[3] += c;
+    c = x->v[3] >> 26; x->v[3] &= MASK26; x->v[4] += c;
+}
+
+/* Convert back to 17 little-endian bytes, after r26_carry */
+static inline void r26_export(const r26 *x, unsigned char *p)
+{
+    PUT_64BIT_LSB_FIRST(p, x->v[0] | (x->v[1] << 26) | (x->v[2] << 52));
+    PUT_64BIT_LSB_FIRST(p + 8, (x->v[2] >> 12) | (x->v[3] << 14) |
+                        (x->v[4] << 40));
+    p[16] = x->v[4] >> 24;
+}
+
+/* out = a * b mod p (partially reduced). out may alias a or b. */
+static inline void r26_mul(r26 *out, const r26 *a, const r26 *b)
+{
+    uint64_t a0 = a->v[0], a1 = a->v[1], a2 = a->v[2];
+    uint64_t a3 = a->v[3], a4 = a->v[4];
+    uint64_t b0 = b->v[0], b1 = b->v[1], b2 = b->v[2];
+    uint64_t b3 = b->v[3], b4 = b->v[4];
+    uint64_t s1 = b1 * 5, s2 = b2 * 5, s3 = b3 * 5, s4 = b4 * 5;
+
+    out->v[0] = a0*b0 + a1*s4 + a2*s3 + a3*s2 + a4*s1;
+    out->v[1] = a0*b1 + a1*b0 + a2*s4 + a3*s3 + a4*s2;
+    out->v[2] = a0*b2 + a1*b1 + a2*b0 + a3*s4 + a4*s3;
+    out->v[3] = a0*b3 + a1*b2 + a2*b1 + a3*b0 + a4*s4;
+    out->v[4] = a0*b4 + a1*b3 + a2*b2 + a3*b1 + a4*b0;
+    r26_carry(out);
+}
+
+/* Vector of five limbs, for four lanes in parallel */
+typedef struct v26 {
+    __m256i v[5];
+} v26;
+
+/* Make a vector whose four lanes hold the limbs of a, b, c, d */
+static inline void v26_set(v26 *out, const r26 *a, const r26 *b,
+                           const r26 *c, const r26 *d)
+{
+    for (int i = 0; i < 5; i++)
+        out->v[i] = _mm256_set_epi64x(d->v[i], c->v[i], b->v[i], a->v[i]);
+}
+
+/* Load four consecutive message blocks, one per lane, adding 2^128 */
+static inline void v26_load(v26 *out, const unsigned char *data)
+{
+    const __m256i mask = _mm256_set1_epi64x(MASK26);
+    __m256i a = _mm256_loadu_si256((const __m256i *)data);
+    __m256i b = _mm256_loadu_si256((const __m256i *)(data + 32));
+
+    /* Separate the low and high 64-bit halves of the four blocks */
+    __m256i lo = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xD8);
+    __m256i hi = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xD8);
+
+    out->v[0] = _mm256_and_si256(lo, mask);
+    out->v[1] = _mm256_and_si256(_mm256_srli_epi64(lo, 26), mask);
+    out->v[2] = _mm256_and_si256(_mm256_or_si256(
+                                     _mm256_srli_epi64(lo, 52),
+                                     _mm256_slli_epi64(hi, 12)), mask);
+    out->v[3] = _mm256_and_si256(_mm256_srli_epi64(hi, 14), mask);
+    out->v[4] = _mm256_or_si256(_mm256_srli_epi64(hi, 40),
+                                _mm256_set1_epi64x(1 << 24));
+}
+
+static inline void v26_add(v26 *out, const v26 *a, const v26 *b)
+{
+    for (int i = 0; i < 5; i++)
+        out->v[i] = _mm256_add_epi64(a->v[i], b->v[i]);
+}
+
+/* Multiply lanewise by r, with s = 5*r precomputed, and carry */
+static inline void v26_mul(v26 *out, const v26 *a, const v26 *r,
+                           const v26 *s)
+{
+    const __m256i mask = _mm256_set1_epi64x(MASK26);
+    __m256i d[5], c;
+
+#define M(x, y) _mm256_mul_epu32(x, y)
+#define A(x, y) _mm256_add_epi64(x, y)
+    d[0] = A(A(A(A(M(a->v[0], r->v[0]), M(a->v[1], s->v[4])),
+                 M(a->v[2], s->v[3])), M(a->v[3], s->v[2])),
+             M(a->v[4], s->v[1]));
+    d[1] = A(A(A(A(M(a->v[0], r->v[1]), M(a->v[1], r->v[0])),
+                 M(a->v[2], s->v[4])), M(a->v[3], s->v[3])),
+             M(a->v[4], s->v[2]));
+    d[2] = A(A(A(A(M(a->v[0], r->v[2]), M(a->v[1], r->v[1])),
+                 M(a->v[2], r->v[0])), M(a->v[3], s->v[4])),
+             M(a->v[4], s->v[3]));
+    d[3] = A(A(A(A(M(a->v[0], r->v[3]), M(a->v[1], r->v[2])),
+                 M(a->v[2], r->v[1])), M(a->v[3], r->v[0])),
+             M(a->v[4], s->v[4]));
+    d[4] = A(A(A(A(M(a->v[0], r->v[4]), M(a->v[1], r->v[3])),
+                 M(a->v[2], r->v[2])), M(a->v[3], r->v[1])),
+             M(a->v[4], r->v[0]));
+
+    /* One pass of carrying is enough to get every limb back under
+     * 2^26 plus a little, which is all the next multiplication needs */
+    c = _mm256_srli_epi64(d[0], 26); d[0] = _mm256_and_si256(d[0], mask);
+    d[1] = A(d[1], c);
+    c = _mm256_srli_epi64(d[1], 26); d[1] = _mm256_and_si256(d[1], mask);
+    d[2] = A(d[2], c);
+    c = _mm256_srli_epi64(d[2], 26); d[2] = _mm256_and_si256(d[2], mask);
+    d[3] = A(d[3], c);
+    c = _mm256_srli_epi64(d[3], 26); d[3] = _mm256_and_si256(d[3], mask);
+    d[4] = A(d[4], c);
+    c = _mm256_srli_epi64(d[4], 26); d[4] = _mm256_and_si256(d[4], mask);
+    d[0] = A(d[0], A(c, _mm256_slli_epi64(c, 2)));
+    c = _mm256_srli_epi64(d[0], 26); d[0] = _mm256_and_si256(d[0], mask);
+    d[1] = A(d[1], c);
+#undef M
+#undef A
+
+    for (int i = 0; i < 5; i++)
+        out->v[i] = d[i];
+}
+
+static inline void v26_times5(v26 *out, const v26 *a)
+{
+    for (int i = 0; i < 5; i++)
+        out->v[i] = _mm256_add_epi64(a->v[i], _mm256_slli_epi64(a->v[i], 2));
+}
+
+/* Add the four lanes together into a scalar */
+static inline void v26_sum(r26 *out, const v26 *a)
+{
+    for (int i = 0; i < 5; i++) {
+        __m128i t = _mm_add_epi64(_mm256_castsi256_si128(a->v[i]),
+                                  _mm256_extracti128_si256(a->v[i], 1));
+        t = _mm_add_epi64(t, _mm_unpackhi_epi64(t, t));
+        out->v[i] = _mm_cvtsi128_si64(t);
+    }
+}
+
+static void poly1305_avx2_blocks(unsigned char *hbytes,
+                                 const unsigned char *rbytes,
+                                 const unsigned char *data, size_t nblocks)
+{
+    r26 h, r, m;
+
+    r26_import(&h, hbytes, hbytes[16]);
+    r26_import(&r, rbytes, 0);
+
+    if (nblocks >= 4) {
+        r26 r2, r3, r4;
+        v26 H, M, R4, S4, Rfin, Sfin;
+
+        r26_mul(&r2, &r, &r);
+        r26_mul(&r3, &r2, &r);
+        r26_mul(&r4, &r2, &r2);
+        v26_set(&R4, &r4, &r4, &r4, &r4);
+        v26_times5(&S4, &R4);
+        v26_set(&Rfin, &r4, &r3, &r2, &r);
+        v26_times5(&Sfin, &Rfin);
+
+        /* Start with the current accumulator in lane 0 */
+        r26_carry(&h);
+        memset(&m, 0, sizeof(m));
+        v26_set(&H, &h, &m, &m, &m);
+        v26_load(&M, data);
+        v26_add(&H, &H, &M);
+        data += 64;
+        nblocks -= 4;
+
+        for (; nblocks >= 4; nblocks -= 4, data += 64) {
+            v26_mul(&H, &H, &R4, &S4);
+            v26_load(&M, data);
+            v26_add(&H, &H, &M);
+        }
+
+        v26_mul(&H, &H, &Rfin, &Sfin);
+        v26_sum(&h, &H);
+        r26_carry(&h);
+
+        smemclr(&r2, sizeof(r2));
+        smemclr(&r3, sizeof(r3));
+        smemclr(&r4, sizeof(r4));
+        smemclr(&H, sizeof(H));
+        smemclr(&M, sizeof(M));
+        smemclr(&R4, sizeof(R4));
+        smemclr(&S4, sizeof(S4));
+        smemclr(&Rfin, sizeof(Rfin));
+        smemclr(&Sfin, sizeof(Sfin));
+    }
+
+    /* Any remaining blocks one at a time */
+    for (; nblocks > 0; nblocks--, data += 16) {
+        r26_import(&m, data, 1);
+        for (int i = 0; i < 5; i++)
+            h.v[i] += m.v[i];
+        r26_mul(&h, &h, &r);
+    }
+
+    r26_carry(&h);
+    r26_export(&h, hbytes);
+
+    smemclr(&h, sizeof(h));
+    smemclr(&r, sizeof(r));
+    smemclr(&m, sizeof(m));
+}
+
+static struct ccp_extra_mutable ccp_avx2_extra_mut;
+const struct ccp_extra ccp_avx2_extra = {
+    .check_available = ccp_avx2_available,
+    .mut = &ccp_avx2_extra_mut,
+    .chacha20_xor_blocks = chacha20_avx2_xor_blocks,
+    .poly1305_blocks = poly1305_avx2_blocks,
+};
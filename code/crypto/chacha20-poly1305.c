@@ -31,6 +31,7 @@
 
 #include "ssh.h"
 #include "mpint_i.h"
+#include "chacha20-poly1305.h"
 
 #ifndef INLINE
 #define INLINE
@@ -50,15 +51,18 @@ struct chacha20 {
     unsigned char current[64];
     /* The index of the above currently used to allow a true streaming cipher */
     int currentIndex;
+    /* Bulk function for whole blocks, from the implementation's ccp_extra */
+    void (*xor_blocks)(uint32_t *state, unsigned char *data, size_t nblocks);
 };
 
-static INLINE void chacha20_round(struct chacha20 *ctx)
+/* Generate the single block of keystream for the given input state */
+static INLINE void chacha20_block(const uint32_t *state, unsigned char *out)
 {
     int i;
     uint32_t copy[16];
 
     /* Take a copy */
-    memcpy(copy, ctx->state, sizeof(copy));
+    memcpy(copy, state, sizeof(copy));
 
     /* A circular rotation for a 32bit number */
 #define rotl(x, shift) x = ((x << shift) | (x >> (32 - shift)))
@@ -97,28 +101,50 @@ static INLINE void chacha20_round(struct chacha20 *ctx)
 
     /* Add the initial state */
     for (i = 0; i < 16; ++i) {
-        copy[i] += ctx->state[i];
+        copy[i] += state[i];
     }
 
-    /* Update the content of the xor buffer */
+    /* Write out the block */
     for (i = 0; i < 16; ++i) {
-        ctx->current[i * 4 + 0] = copy[i] >> 0;
-        ctx->current[i * 4 + 1] = copy[i] >> 8;
-        ctx->current[i * 4 + 2] = copy[i] >> 16;
-        ctx->current[i * 4 + 3] = copy[i] >> 24;
+        PUT_32BIT_LSB_FIRST(out + i * 4, copy[i]);
     }
-    /* State full, reset pointer to beginning */
-    ctx->currentIndex = 0;
     smemclr(copy, sizeof(copy));
+}
 
+static INLINE void chacha20_next_counter(uint32_t *state)
+{
     /* Increment round counter */
-    ++ctx->state[12];
+    ++state[12];
     /* Check for overflow, not done in one line so the 32 bits are chopped by the type */
-    if (!(uint32_t)(ctx->state[12])) {
-        ++ctx->state[13];
+    if (!(uint32_t)(state[12])) {
+        ++state[13];
     }
 }
 
+static INLINE void chacha20_round(struct chacha20 *ctx)
+{
+    /* Update the content of the xor buffer */
+    chacha20_block(ctx->state, ctx->current);
+    /* State full, reset pointer to beginning */
+    ctx->currentIndex = 0;
+    chacha20_next_counter(ctx->state);
+}
+
+/* The portable bulk function: just one block at a time */
+static void chacha20_sw_xor_blocks(uint32_t *state, unsigned char *data,
+                                   size_t nblocks)
+{
+    unsigned char ks[64];
+
+    for (; nblocks > 0; nblocks--, data += 64) {
+        chacha20_block(state, ks);
+        for (int i = 0; i < 64; i++)
+            data[i] ^= ks[i];
+        chacha20_next_counter(state);
+    }
+    smemclr(ks, sizeof(ks));
+}
+
 /* Initialise context with 256bit key */
 static void chacha20_key(struct chacha20 *ctx, const unsigned char *key)
 {
@@ -157,14 +183,25 @@ static void chacha20_iv(struct chacha20 *ctx, const unsigned char *iv)
 
 static void chacha20_encrypt(struct chacha20 *ctx, unsigned char *blk, int len)
 {
-    while (len) {
-        /* If we don't have any state left, then cycle to the next */
-        if (ctx->currentIndex >= 64) {
-            chacha20_round(ctx);
-        }
+    /* Use up whatever is left of the current block */
+    while (ctx->currentIndex < 64 && len) {
+        *blk++ ^= ctx->current[ctx->currentIndex++];
+        --len;
+    }
+
+    /* Whole blocks go straight to the bulk function, which can do
+     * several at once */
+    if (len >= 64) {
+        size_t nblocks = len / 64;
+        ctx->xor_blocks(ctx->state, blk, nblocks);
+        blk += nblocks * 64;
+        len -= nblocks * 64;
+    }
 
-        /* Do the xor while there's some state left and some plaintext left */
-        while (ctx->currentIndex < 64 && len) {
+    /* And any tail comes out of a fresh block, keeping the rest */
+    if (len) {
+        chacha20_round(ctx);
+        while (len) {
             *blk++ ^= ctx->current[ctx->currentIndex++];
             --len;
         }
@@ -763,8 +800,21 @@ struct poly1305 {
     /* Buffer in case we get less that a multiple of 16 bytes */
     unsigned char buffer[16];
     int bufferIndex;
+
+    /* The clamped key again, as bytes, and a bulk function to pass
+     * it to (if the implementation has one) */
+    unsigned char rbytes[16];
+    void (*blocks)(unsigned char *h, const unsigned char *r,
+                   const unsigned char *data, size_t nblocks);
 };
 
+/*
+ * Minimum number of whole blocks worth handing to ctx->blocks, which
+ * has to convert the accumulator to and from its own representation
+ * and precompute powers of r on every call.
+ */
+#define POLY1305_BULK_MIN 8
+
 static void poly1305_init(struct poly1305 *ctx)
 {
     memset(ctx->nonce, 0, 16);
@@ -790,6 +840,7 @@ static void poly1305_key(struct poly1305 *ctx, ptrlen key)
     key_copy[8] &= 0xfc;
     key_copy[12] &= 0xfc;
     bigval_import_le(&ctx->r, key_copy, 16);
+    memcpy(ctx->rbytes, key_copy, 16);
     smemclr(key_copy, sizeof(key_copy));
 
     /* Use second 128 bits as the nonce */
@@ -824,6 +875,20 @@ static void poly1305_feed(struct poly1305 *ctx,
         }
     }
 
+    /* Hand runs of whole chunks to the bulk function, if we have one */
+    if (ctx->blocks && len >= 16 * POLY1305_BULK_MIN) {
+        unsigned char h[17];
+        size_t nblocks = len / 16;
+
+        bigval_export_le(&ctx->h, h, 17);
+        ctx->blocks(h, ctx->rbytes, buf, nblocks);
+        bigval_import_le(&ctx->h, h, 17);
+        smemclr(h, sizeof(h));
+
+        buf += nblocks * 16;
+        len -= nblocks * 16;
+    }
+
     /* Process 16 byte whole chunks */
     while (len >= 16) {
         poly1305_feed_chunk(ctx, buf, 16);
@@ -975,9 +1040,16 @@ const ssh2_macalg ssh2_poly1305 = {
 
 static ssh_cipher *ccp_new(const ssh_cipheralg *alg)
 {
+    const struct ccp_extra *extra = (const struct ccp_extra *)alg->extra;
+    if (!check_ccp_availability(extra))
+        return NULL;
+
     struct ccp_context *ctx = snew(struct ccp_context);
     BinarySink_INIT(ctx, poly_BinarySink_write);
     poly1305_init(&ctx->mac);
+    ctx->mac.blocks = extra->poly1305_blocks;
+    ctx->a_cipher.xor_blocks = extra->chacha20_xor_blocks;
+    ctx->b_cipher.xor_blocks = extra->chacha20_xor_blocks;
     ctx->ciph.vt = alg;
     ctx->ciph_allocated = true;
     ctx->mac_allocated = false;
@@ -1053,22 +1125,84 @@ static void ccp_decrypt_length(ssh_cipher *cipher, void *blk, int len,
     chacha20_decrypt(&ctx->a_cipher, blk, len);
 }
 
+static bool ccp_sw_available(void)
+{
+    return true;
+}
+
+static struct ccp_extra_mutable ccp_sw_extra_mut;
+static const struct ccp_extra ccp_sw_extra = {
+    .check_available = ccp_sw_available,
+    .mut = &ccp_sw_extra_mut,
+    .chacha20_xor_blocks = chacha20_sw_xor_blocks,
+    .poly1305_blocks = NULL,
+};
+
+#define CCP_VTABLE(impl_c, impl_display)                                \
+    const ssh_cipheralg ssh2_chacha20_poly1305_ ## impl_c = {           \
+        .new = ccp_new,                                                 \
+        .free = ccp_free,                                               \
+        .setiv = ccp_iv,                                                \
+        .setkey = ccp_key,                                              \
+        .encrypt = ccp_encrypt,                                         \
+        .decrypt = ccp_decrypt,                                         \
+        .encrypt_length = ccp_encrypt_length,                           \
+        .decrypt_length = ccp_decrypt_length,                           \
+        .next_message = nullcipher_next_message,                        \
+        .ssh2_id = "chacha20-poly1305@openssh.com",                     \
+        .blksize = 1,                                                   \
+        .real_keybits = 512,                                            \
+        .padded_keybytes = 64,                                          \
+        .flags = (SSH_CIPHER_SEPARATE_LENGTH |                          \
+                  SSH_CIPHER_IV_IS_SEQUENCE),                           \
+        .text_name = "ChaCha20 (" impl_display ")",                     \
+        .required_mac = &ssh2_poly1305,                                 \
+        .extra = &ccp_ ## impl_c ## _extra,                             \
+    }
+
+CCP_VTABLE(sw, "unaccelerated");
+#if HAVE_AVX2
+CCP_VTABLE(avx2, "AVX2 accelerated");
+#endif
+#if HAVE_NEON_CHACHA
+CCP_VTABLE(neon, "NEON accelerated");
+#endif
+
+static ssh_cipher *ccp_select(const ssh_cipheralg *alg)
+{
+    static const ssh_cipheralg *const real_algs[] = {
+#if HAVE_AVX2
+        &ssh2_chacha20_poly1305_avx2,
+#endif
+#if HAVE_NEON_CHACHA
+        &ssh2_chacha20_poly1305_neon,
+#endif
+        &ssh2_chacha20_poly1305_sw,
+        NULL,
+    };
+
+    for (size_t i = 0; real_algs[i]; i++) {
+        const ssh_cipheralg *alg = real_algs[i];
+        const struct ccp_extra *alg_extra =
+            (const struct ccp_extra *)alg->extra;
+        if (check_ccp_availability(alg_extra))
+            return ssh_cipher_new(alg);
+    }
+
+    /* We should never reach the NULL at the end of the list, because
+     * the last non-NULL entry should be the portable implementation,
+     * which is always available. */
+    unreachable("ccp_select ran off the end of its list");
+}
+
 const ssh_cipheralg ssh2_chacha20_poly1305 = {
-    .new = ccp_new,
-    .free = ccp_free,
-    .setiv = ccp_iv,
-    .setkey = ccp_key,
-    .encrypt = ccp_encrypt,
-    .decrypt = ccp_decrypt,
-    .encrypt_length = ccp_encrypt_length,
-    .decrypt_length = ccp_decrypt_length,
-    .next_message = nullcipher_next_message,
+    .new = ccp_select,
     .ssh2_id = "chacha20-poly1305@openssh.com",
     .blksize = 1,
     .real_keybits = 512,
     .padded_keybytes = 64,
-    .flags = SSH_CIPHER_SEPARATE_LENGTH,
-    .text_name = "ChaCha20",
+    .flags = SSH_CIPHER_SEPARATE_LENGTH | SSH_CIPHER_IV_IS_SEQUENCE,
+    .text_name = "ChaCha20 (dummy selector vtable)",
     .required_mac = &ssh2_poly1305,
 };
 
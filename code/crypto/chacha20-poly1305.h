@@ -0,0 +1,64 @@
+/*
+ * Definitions shared between the portable ChaCha20-Poly1305 code in
+ * chacha20-poly1305.c and its hardware-accelerated back ends.
+ *
+ * The SSH-facing parts of the cipher (key schedule, the strange
+ * sequence-number IV, the interlock between the cipher and the MAC,
+ * and all the buffering of partial blocks) are the same for every
+ * implementation, so they all live in chacha20-poly1305.c. What a
+ * back end provides is just the two bulk inner loops, via the 'extra'
+ * structure hung off each ssh_cipheralg.
+ */
+
+struct ccp_extra_mutable;
+struct ccp_extra {
+    /* Function to check availability. Might be expensive, so we don't
+     * want to call it more than once. */
+    bool (*check_available)(void);
+
+    /* Point to a writable substructure. */
+    struct ccp_extra_mutable *mut;
+
+    /*
+     * XOR 'nblocks' consecutive 64-byte blocks of ChaCha20 keystream
+     * into 'data'. 'state' is the 16-word ChaCha20 input block; the
+     * keystream starts at the 64-bit block counter in state[12]
+     * (low) and state[13] (high), and the counter is advanced past
+     * all the blocks used.
+     */
+    void (*chacha20_xor_blocks)(uint32_t *state, unsigned char *data,
+                                size_t nblocks);
+
+    /*
+     * Absorb 'nblocks' whole 16-byte blocks of message into a
+     * Poly1305 accumulator, i.e. for each block m, set h = (h + m +
+     * 2^128) * r mod p.
+     *
+     * 'h' is 17 bytes, little-endian, holding a value less than 2^131
+     * (so not necessarily fully reduced mod p); it's updated in place
+     * and must be left in the same form. 'r' is the 16-byte clamped
+     * key, also little-endian.
+     *
+     * May be NULL, in which case the portable bignum code in
+     * chacha20-poly1305.c is used.
+     */
+    void (*poly1305_blocks)(unsigned char *h, const unsigned char *r,
+                            const unsigned char *data, size_t nblocks);
+};
+struct ccp_extra_mutable {
+    bool checked_availability;
+    bool is_available;
+};
+static inline bool check_ccp_availability(const struct ccp_extra *extra)
+{
+    if (!extra->mut->checked_availability) {
+        extra->mut->is_available = extra->check_available();
+        extra->mut->checked_availability = true;
+    }
+
+    return extra->mut->is_available;
+}
+
+/* The extra structures exported by each accelerated back end. */
+extern const struct ccp_extra ccp_avx2_extra;
+extern const struct ccp_extra ccp_neon_extra;
@@ -0,0 +1,133 @@
+/*
+ * Implementation of CRC-32 using the x86 CLMUL extension, by the
+ * 'folding' technique described in Intel's white paper "Fast CRC
+ * Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+ *
+ * The idea is that the CRC state, regarded as a polynomial, can be
+ * advanced past 128 bits of input at once by multiplying by a
+ * constant (x^k mod P for suitable k). We keep four 128-bit
+ * accumulators going in parallel, each folded forward 512 bits at a
+ * time by a carry-less multiplication with the next 64 bytes of
+ * input XORed in; then fold the four into one, fold in any remaining
+ * whole 16-byte blocks, and finally reduce the 128-bit result to 32
+ * bits with a Barrett reduction.
+ *
+ * Everything here is in the bit-reversed representation used in
+ * crc32.c, which is why the constants below are 33-bit values
+ * (reflected and shifted left by one, so that the products land in
+ * the right place).
+ *
+ * Any tail of the input that isn't a whole 16-byte block, and any
+ * input too short to be worth setting up for, is handed to the
+ * software implementation.
+ */
+
+#include <wmmintrin.h>
+#include <emmintrin.h>
+
+#if defined(__clang__) || defined(__GNUC__)
+#include <cpuid.h>
+#define GET_CPU_ID(out) __cpuid(1, (out)[0], (out)[1], (out)[2], (out)[3])
+#else
+#define GET_CPU_ID(out) __cpuid(out, 1)
+#endif
+
+#include "ssh.h"
+
+static bool crc32_clmul_available(void)
+{
+    /*
+     * Determine if CLMUL is available on this CPU.
+     */
+    unsigned int CPUInfo[4];
+    GET_CPU_ID(CPUInfo);
+    return (CPUInfo[2] & (1 << 1));
+}
+
+/*
+ * Fold the accumulator x forward over 128 bits, using the pair of
+ * constants in k, and XOR in the next block of input.
+ */
+static inline __m128i crc32_clmul_fold(__m128i x, __m128i k, __m128i next)
+{
+    __m128i lo = _mm_clmulepi64_si128(x, k, 0x00);
+    __m128i hi = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(lo, hi), next);
+}
+
+static uint32_t crc32_clmul_update(uint32_t crc, ptrlen data)
+{
+    const uint8_t *p = (const uint8_t *)data.ptr;
+    size_t len = data.len;
+
+    if (len >= 64) {
+        const __m128i *q = (const __m128i *)p;
+        size_t nblocks = len / 16;
+
+        /* x^(512+64) and x^512 mod P, for folding by 4 blocks */
+        const __m128i k_fold4 = _mm_set_epi64x(0x1c6e41596, 0x154442bd4);
+        /* x^(128+64) and x^128 mod P, for folding by 1 block */
+        const __m128i k_fold1 = _mm_set_epi64x(0x0ccaa009e, 0x1751997d0);
+        /* x^64 mod P, for reducing 64 bits to 32 */
+        const __m128i k_64 = _mm_set_epi64x(0, 0x163cd6124);
+        /* Barrett reduction constants: x^64 / P, and P itself */
+        const __m128i k_barrett = _mm_set_epi64x(0x1f7011641, 0x1db710641);
+        const __m128i mask32 = _mm_set_epi32(0, 0, 0, 0xFFFFFFFF);
+
+        __m128i x0 = _mm_loadu_si128(q + 0);
+        __m128i x1 = _mm_loadu_si128(q + 1);
+        __m128i x2 = _mm_loadu_si128(q + 2);
+        __m128i x3 = _mm_loadu_si128(q + 3);
+        __m128i t;
+
+        x0 = _mm_xor_si128(x0, _mm_cvtsi32_si128(crc));
+        q += 4;
+        nblocks -= 4;
+
+        while (nblocks >= 4) {
+            x0 = crc32_clmul_fold(x0, k_fold4, _mm_loadu_si128(q + 0));
+            x1 = crc32_clmul_fold(x1, k_fold4, _mm_loadu_si128(q + 1));
+            x2 = crc32_clmul_fold(x2, k_fold4, _mm_loadu_si128(q + 2));
+            x3 = crc32_clmul_fold(x3, k_fold4, _mm_loadu_si128(q + 3));
+            q += 4;
+            nblocks -= 4;
+        }
+
+        x0 = crc32_clmul_fold(x0, k_fold1, x1);
+        x0 = crc32_clmul_fold(x0, k_fold1, x2);
+        x0 = crc32_clmul_fold(x0, k_fold1, x3);
+
+        while (nblocks > 0) {
+            x0 = crc32_clmul_fold(x0, k_fold1, _mm_loadu_si128(q));
+            q++;
+            nblocks--;
+        }
+
+        /* Reduce 128 bits to 64 */
+        t = _mm_clmulepi64_si128(x0, k_fold1, 0x10);
+        x0 = _mm_xor_si128(_mm_srli_si128(x0, 8), t);
+
+        /* Reduce 64 bits to 32, leaving the result in bits 32..63 */
+        t = _mm_srli_si128(x0, 4);
+        x0 = _mm_clmulepi64_si128(_mm_and_si128(x0, mask32), k_64, 0x00);
+        x0 = _mm_xor_si128(x0, t);
+
+        /* Barrett reduction */
+        t = x0;
+        x0 = _mm_clmulepi64_si128(_mm_and_si128(x0, mask32), k_barrett, 0x10);
+        x0 = _mm_clmulepi64_si128(_mm_and_si128(x0, mask32), k_barrett, 0x00);
+        x0 = _mm_xor_si128(x0, t);
+        crc = _mm_cvtsi128_si32(_mm_srli_si128(x0, 4));
+
+        p = (const uint8_t *)q;
+        len %= 16;
+    }
+
+    return crc32_sw.update(crc, make_ptrlen(p, len));
+}
+
+const crc32_impl crc32_clmul = {
+    .name = "crc32_clmul",
+    .check_available = crc32_clmul_available,
+    .update = crc32_clmul_update,
+};
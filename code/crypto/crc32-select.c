@@ -0,0 +1,56 @@
+/*
+ * Top-level function to select a CRC-32 implementation.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "putty.h"
+#include "ssh.h"
+
+static const crc32_impl *const crc32_impls[] = {
+#if HAVE_CLMUL
+    &crc32_clmul,
+#endif
+#if HAVE_NEON_CRC32
+    &crc32_neon,
+#endif
+    &crc32_sw,
+    NULL,
+};
+
+const crc32_impl *crc32_find_impl(ptrlen name)
+{
+    for (size_t i = 0; crc32_impls[i]; i++)
+        if (ptrlen_eq_string(name, crc32_impls[i]->name))
+            return crc32_impls[i];
+    return NULL;
+}
+
+static uint32_t crc32_select_update(uint32_t crc, ptrlen data);
+static uint32_t (*crc32_update_fn)(uint32_t, ptrlen) = crc32_select_update;
+
+/*
+ * On the first call, find the best available implementation, and
+ * arrange for every later call to go straight to it.
+ */
+static uint32_t crc32_select_update(uint32_t crc, ptrlen data)
+{
+    for (size_t i = 0; crc32_impls[i]; i++) {
+        const crc32_impl *impl = crc32_impls[i];
+        if (impl->check_available()) {
+            crc32_update_fn = impl->update;
+            return impl->update(crc, data);
+        }
+    }
+
+    /* We should never reach the NULL at the end of the list, because
+     * the last non-NULL entry should be the software implementation,
+     * which is always available. */
+    unreachable("crc32_select ran off the end of its list");
+}
+
+uint32_t crc32_update(uint32_t crc, ptrlen data)
+{
+    return crc32_update_fn(crc, data);
+}
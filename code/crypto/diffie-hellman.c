@@ -8,71 +8,88 @@
 #include "misc.h"
 #include "mpint.h"
 
+/*
+ * The fixed parameters of a group, together with the things we
+ * precompute from them to do arithmetic in it. The standard groups
+ * are set up once, the first time they're used, and then shared by
+ * every key exchange in the process; a group sent by the server in
+ * GEX belongs to the one dh_ctx using it.
+ */
+typedef struct dh_group {
+    mp_int *p, *q, *g;
+    MontyContext *mc;
+    mp_int *g_monty;                   /* g in Montgomery representation */
+} dh_group;
+
 struct dh_ctx {
-    mp_int *x, *e, *p, *q, *g;
+    mp_int *x, *e;
+    dh_group *group;
+    bool group_owned;
 };
 
 struct dh_extra {
     bool gex;
-    void (*construct)(dh_ctx *ctx);
+    void (*construct)(dh_group *group);
+    dh_group *cache;
 };
 
-static void dh_group1_construct(dh_ctx *ctx)
+static void dh_group1_construct(dh_group *group)
 {
     /* Command to recompute, from the expression in RFC 2412 section E.2:
 spigot -B16 '2^1024 - 2^960 - 1 + 2^64 * ( floor(2^894 pi) + 129093 )'
      */
-    ctx->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE65381FFFFFFFFFFFFFFFF);
-    ctx->g = mp_from_integer(2);
+    group->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE65381FFFFFFFFFFFFFFFF);
+    group->g = mp_from_integer(2);
 }
 
-static void dh_group14_construct(dh_ctx *ctx)
+static void dh_group14_construct(dh_group *group)
 {
     /* Command to recompute, from the expression in RFC 3526 section 3:
 spigot -B16 '2^2048 - 2^1984 - 1 + 2^64 * ( floor(2^1918 pi) + 124476 )'
      */
-    ctx->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AACAA68FFFFFFFFFFFFFFFF);
-    ctx->g = mp_from_integer(2);
+    group->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AACAA68FFFFFFFFFFFFFFFF);
+    group->g = mp_from_integer(2);
 }
 
-static void dh_group15_construct(dh_ctx *ctx)
+static void dh_group15_construct(dh_group *group)
 {
     /* Command to recompute, from the expression in RFC 3526 section 4:
 spigot -B16 '2^3072 - 2^3008 - 1 + 2^64 * ( floor(2^2942 pi) + 1690314 )'
      */
-    ctx->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DB5BFCE0FD108E4B82D120A93AD2CAFFFFFFFFFFFFFFFF);
-    ctx->g = mp_from_integer(2);
+    group->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DB5BFCE0FD108E4B82D120A93AD2CAFFFFFFFFFFFFFFFF);
+    group->g = mp_from_integer(2);
 }
 
-static void dh_group16_construct(dh_ctx *ctx)
+static void dh_group16_construct(dh_group *group)
 {
     /* Command to recompute, from the expression in RFC 3526 section 5:
 spigot -B16 '2^4096 - 2^4032 - 1 + 2^64 * ( floor(2^3966 pi) + 240904 )'
      */
-    ctx->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DB5BFCE0FD108E4B82D120A92108011A723C12A787E6D788719A10BDBA5B2699C327186AF4E23C1A946834B6150BDA2583E9CA2AD44CE8DBBBC2DB04DE8EF92E8EFC141FBECAA6287C59474E6BC05D99B2964FA090C3A2233BA186515BE7ED1F612970CEE2D7AFB81BDD762170481CD0069127D5B05AA993B4EA988D8FDDC186FFB7DC90A6C08F4DF435C934063199FFFFFFFFFFFFFFFF);
-    ctx->g = mp_from_integer(2);
+    group->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DB5BFCE0FD108E4B82D120A92108011A723C12A787E6D788719A10BDBA5B2699C327186AF4E23C1A946834B6150BDA2583E9CA2AD44CE8DBBBC2DB04DE8EF92E8EFC141FBECAA6287C59474E6BC05D99B2964FA090C3A2233BA186515BE7ED1F612970CEE2D7AFB81BDD762170481CD0069127D5B05AA993B4EA988D8FDDC186FFB7DC90A6C08F4DF435C934063199FFFFFFFFFFFFFFFF);
+    group->g = mp_from_integer(2);
 }
 
-static void dh_group17_construct(dh_ctx *ctx)
+static void dh_group17_construct(dh_group *group)
 {
     /* Command to recompute, from the expression in RFC 3526 section 6:
 spigot -B16 '2^6144 - 2^6080 - 1 + 2^64 * ( floor(2^6014 pi) + 929484 )'
      */
-    ctx->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DB5BFCE0FD108E4B82D120A92108011A723C12A787E6D788719A10BDBA5B2699C327186AF4E23C1A946834B6150BDA2583E9CA2AD44CE8DBBBC2DB04DE8EF92E8EFC141FBECAA6287C59474E6BC05D99B2964FA090C3A2233BA186515BE7ED1F612970CEE2D7AFB81BDD762170481CD0069127D5B05AA993B4EA988D8FDDC186FFB7DC90A6C08F4DF435C93402849236C3FAB4D27C7026C1D4DCB2602646DEC9751E763DBA37BDF8FF9406AD9E530EE5DB382F413001AEB06A53ED9027D831179727B0865A8918DA3EDBEBCF9B14ED44CE6CBACED4BB1BDB7F1447E6CC254B332051512BD7AF426FB8F401378CD2BF5983CA01C64B92ECF032EA15D1721D03F482D7CE6E74FEF6D55E702F46980C82B5A84031900B1C9E59E7C97FBEC7E8F323A97A7E36CC88BE0F1D45B7FF585AC54BD407B22B4154AACC8F6D7EBF48E1D814CC5ED20F8037E0A79715EEF29BE32806A1D58BB7C5DA76F550AA3D8A1FBFF0EB19CCB1A313D55CDA56C9EC2EF29632387FE8D76E3C0468043E8F663F4860EE12BF2D5B0B7474D6E694F91E6DCC4024FFFFFFFFFFFFFFFF);
-    ctx->g = mp_from_integer(2);
+    group->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DB5BFCE0FD108E4B82D120A92108011A723C12A787E6D788719A10BDBA5B2699C327186AF4E23C1A946834B6150BDA2583E9CA2AD44CE8DBBBC2DB04DE8EF92E8EFC141FBECAA6287C59474E6BC05D99B2964FA090C3A2233BA186515BE7ED1F612970CEE2D7AFB81BDD762170481CD0069127D5B05AA993B4EA988D8FDDC186FFB7DC90A6C08F4DF435C93402849236C3FAB4D27C7026C1D4DCB2602646DEC9751E763DBA37BDF8FF9406AD9E530EE5DB382F413001AEB06A53ED9027D831179727B0865A8918DA3EDBEBCF9B14ED44CE6CBACED4BB1BDB7F1447E6CC254B332051512BD7AF426FB8F401378CD2BF5983CA01C64B92ECF032EA15D1721D03F482D7CE6E74FEF6D55E702F46980C82B5A84031900B1C9E59E7C97FBEC7E8F323A97A7E36CC88BE0F1D45B7FF585AC54BD407B22B4154AACC8F6D7EBF48E1D814CC5ED20F8037E0A79715EEF29BE32806A1D58BB7C5DA76F550AA3D8A1FBFF0EB19CCB1A313D55CDA56C9EC2EF29632387FE8D76E3C0468043E8F663F4860EE12BF2D5B0B7474D6E694F91E6DCC4024FFFFFFFFFFFFFFFF);
+    group->g = mp_from_integer(2);
 }
 
-static void dh_group18_construct(dh_ctx *ctx)
+static void dh_group18_construct(dh_group *group)
 {
     /* Command to recompute, from the expression in RFC 3526 section 7:
 spigot -B16 '2^8192 - 2^8128 - 1 + 2^64 * ( floor(2^8062 pi) + 4743158 )'
      */
-    ctx->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DB5BFCE0FD108E4B82D120A92108011A723C12A787E6D788719A10BDBA5B2699C327186AF4E23C1A946834B6150BDA2583E9CA2AD44CE8DBBBC2DB04DE8EF92E8EFC141FBECAA6287C59474E6BC05D99B2964FA090C3A2233BA186515BE7ED1F612970CEE2D7AFB81BDD762170481CD0069127D5B05AA993B4EA988D8FDDC186FFB7DC90A6C08F4DF435C93402849236C3FAB4D27C7026C1D4DCB2602646DEC9751E763DBA37BDF8FF9406AD9E530EE5DB382F413001AEB06A53ED9027D831179727B0865A8918DA3EDBEBCF9B14ED44CE6CBACED4BB1BDB7F1447E6CC254B332051512BD7AF426FB8F401378CD2BF5983CA01C64B92ECF032EA15D1721D03F482D7CE6E74FEF6D55E702F46980C82B5A84031900B1C9E59E7C97FBEC7E8F323A97A7E36CC88BE0F1D45B7FF585AC54BD407B22B4154AACC8F6D7EBF48E1D814CC5ED20F8037E0A79715EEF29BE32806A1D58BB7C5DA76F550AA3D8A1FBFF0EB19CCB1A313D55CDA56C9EC2EF29632387FE8D76E3C0468043E8F663F4860EE12BF2D5B0B7474D6E694F91E6DBE115974A3926F12FEE5E438777CB6A932DF8CD8BEC4D073B931BA3BC832B68D9DD300741FA7BF8AFC47ED2576F6936BA424663AAB639C5AE4F5683423B4742BF1C978238F16CBE39D652DE3FDB8BEFC848AD922222E04A4037C0713EB57A81A23F0C73473FC646CEA306B4BCBC8862F8385DDFA9D4B7FA2C087E879683303ED5BDD3A062B3CF5B3A278A66D2A13F83F44F82DDF310EE074AB6A364597E899A0255DC164F31CC50846851DF9AB48195DED7EA1B1D510BD7EE74D73FAF36BC31ECFA268359046F4EB879F924009438B481C6CD7889A002ED5EE382BC9190DA6FC026E479558E4475677E9AA9E3050E2765694DFC81F56E880B96E7160C980DD98EDD3DFFFFFFFFFFFFFFFFF);
-    ctx->g = mp_from_integer(2);
+    group->p = MP_LITERAL(0xFFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD129024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE45B3DC2007CB8A163BF0598DA48361C55D39A69163FA8FD24CF5F83655D23DCA3AD961C62F356208552BB9ED529077096966D670C354E4ABC9804F1746C08CA18217C32905E462E36CE3BE39E772C180E86039B2783A2EC07A28FB5C55DF06F4C52C9DE2BCBF6955817183995497CEA956AE515D2261898FA051015728E5A8AAAC42DAD33170D04507A33A85521ABDF1CBA64ECFB850458DBEF0A8AEA71575D060C7DB3970F85A6E1E4C7ABF5AE8CDB0933D71E8C94E04A25619DCEE3D2261AD2EE6BF12FFA06D98A0864D87602733EC86A64521F2B18177B200CBBE117577A615D6C770988C0BAD946E208E24FA074E5AB3143DB5BFCE0FD108E4B82D120A92108011A723C12A787E6D788719A10BDBA5B2699C327186AF4E23C1A946834B6150BDA2583E9CA2AD44CE8DBBBC2DB04DE8EF92E8EFC141FBECAA6287C59474E6BC05D99B2964FA090C3A2233BA186515BE7ED1F612970CEE2D7AFB81BDD762170481CD0069127D5B05AA993B4EA988D8FDDC186FFB7DC90A6C08F4DF435C93402849236C3FAB4D27C7026C1D4DCB2602646DEC9751E763DBA37BDF8FF9406AD9E530EE5DB382F413001AEB06A53ED9027D831179727B0865A8918DA3EDBEBCF9B14ED44CE6CBACED4BB1BDB7F1447E6CC254B332051512BD7AF426FB8F401378CD2BF5983CA01C64B92ECF032EA15D1721D03F482D7CE6E74FEF6D55E702F46980C82B5A84031900B1C9E59E7C97FBEC7E8F323A97A7E36CC88BE0F1D45B7FF585AC54BD407B22B4154AACC8F6D7EBF48E1D814CC5ED20F8037E0A79715EEF29BE32806A1D58BB7C5DA76F550AA3D8A1FBFF0EB19CCB1A313D55CDA56C9EC2EF29632387FE8D76E3C0468043E8F663F4860EE12BF2D5B0B7474D6E694F91E6DBE115974A3926F12FEE5E438777CB6A932DF8CD8BEC4D073B931BA3BC832B68D9DD300741FA7BF8AFC47ED2576F6936BA424663AAB639C5AE4F5683423B4742BF1C978238F16CBE39D652DE3FDB8BEFC848AD922222E04A4037C0713EB57A81A23F0C73473FC646CEA306B4BCBC8862F8385DDFA9D4B7FA2C087E879683303ED5BDD3A062B3CF5B3A278A66D2A13F83F44F82DDF310EE074AB6A364597E899A0255DC164F31CC50846851DF9AB48195DED7EA1B1D510BD7EE74D73FAF36BC31ECFA268359046F4EB879F924009438B481C6CD7889A002ED5EE382BC9190DA6FC026E479558E4475677E9AA9E3050E2765694DFC81F56E880B96E7160C980DD98EDD3DFFFFFFFFFFFFFFFFF);
+    group->g = mp_from_integer(2);
 }
 
+static dh_group group1_cache;
 static const struct dh_extra extra_group1 = {
-    false, dh_group1_construct,
+    false, dh_group1_construct, &group1_cache,
 };
 
 const ssh_kex ssh_diffiehellman_group1_sha1 = {
@@ -89,8 +106,9 @@ static const ssh_kex *const group1_list[] = {
 
 const ssh_kexes ssh_diffiehellman_group1 = { lenof(group1_list), group1_list };
 
+static dh_group group18_cache;
 static const struct dh_extra extra_group18 = {
-    false, dh_group18_construct,
+    false, dh_group18_construct, &group18_cache,
 };
 
 const ssh_kex ssh_diffiehellman_group18_sha512 = {
@@ -109,8 +127,9 @@ const ssh_kexes ssh_diffiehellman_group18 = {
     lenof(group18_list), group18_list
 };
 
+static dh_group group17_cache;
 static const struct dh_extra extra_group17 = {
-    false, dh_group17_construct,
+    false, dh_group17_construct, &group17_cache,
 };
 
 const ssh_kex ssh_diffiehellman_group17_sha512 = {
@@ -129,8 +148,9 @@ const ssh_kexes ssh_diffiehellman_group17 = {
     lenof(group17_list), group17_list
 };
 
+static dh_group group16_cache;
 static const struct dh_extra extra_group16 = {
-    false, dh_group16_construct,
+    false, dh_group16_construct, &group16_cache,
 };
 
 const ssh_kex ssh_diffiehellman_group16_sha512 = {
@@ -149,8 +169,9 @@ const ssh_kexes ssh_diffiehellman_group16 = {
     lenof(group16_list), group16_list
 };
 
+static dh_group group15_cache;
 static const struct dh_extra extra_group15 = {
-    false, dh_group15_construct,
+    false, dh_group15_construct, &group15_cache,
 };
 
 const ssh_kex ssh_diffiehellman_group15_sha512 = {
@@ -169,8 +190,9 @@ const ssh_kexes ssh_diffiehellman_group15 = {
     lenof(group15_list), group15_list
 };
 
+static dh_group group14_cache;
 static const struct dh_extra extra_group14 = {
-    false, dh_group14_construct,
+    false, dh_group14_construct, &group14_cache,
 };
 
 const ssh_kex ssh_diffiehellman_group14_sha256 = {
@@ -310,12 +332,23 @@ const ssh_kexes ssh_gssk5_sha1_kex = {
 };
 
 /*
- * Common DH initialisation.
+ * Fill in the derived parts of a group, given p and g.
  */
-static void dh_init(dh_ctx *ctx)
+static void dh_group_init(dh_group *group)
 {
-    ctx->q = mp_rshift_fixed(ctx->p, 1);
-    ctx->x = ctx->e = NULL;
+    group->q = mp_rshift_fixed(group->p, 1);
+    group->mc = monty_new(group->p);
+    group->g_monty = monty_import(group->mc, group->g);
+}
+
+static void dh_group_free(dh_group *group)
+{
+    mp_free(group->p);
+    mp_free(group->q);
+    mp_free(group->g);
+    mp_free(group->g_monty);
+    monty_free(group->mc);
+    sfree(group);
 }
 
 bool dh_is_gex(const ssh_kex *kex)
@@ -331,9 +364,14 @@ dh_ctx *dh_setup_group(const ssh_kex *kex)
 {
     const struct dh_extra *extra = (const struct dh_extra *)kex->extra;
     assert(!extra->gex);
+    if (!extra->cache->p) {
+        extra->construct(extra->cache);
+        dh_group_init(extra->cache);
+    }
     dh_ctx *ctx = snew(dh_ctx);
-    extra->construct(ctx);
-    dh_init(ctx);
+    ctx->x = ctx->e = NULL;
+    ctx->group = extra->cache;
+    ctx->group_owned = false;
     return ctx;
 }
 
@@ -343,9 +381,12 @@ dh_ctx *dh_setup_group(const ssh_kex *kex)
 dh_ctx *dh_setup_gex(mp_int *pval, mp_int *gval)
 {
     dh_ctx *ctx = snew(dh_ctx);
-    ctx->p = mp_copy(pval);
-    ctx->g = mp_copy(gval);
-    dh_init(ctx);
+    ctx->x = ctx->e = NULL;
+    ctx->group = snew(dh_group);
+    ctx->group->p = mp_copy(pval);
+    ctx->group->g = mp_copy(gval);
+    dh_group_init(ctx->group);
+    ctx->group_owned = true;
     return ctx;
 }
 
@@ -354,7 +395,7 @@ dh_ctx *dh_setup_gex(mp_int *pval, mp_int *gval)
  */
 int dh_modulus_bit_size(const dh_ctx *ctx)
 {
-    return mp_get_nbits(ctx->p);
+    return mp_get_nbits(ctx->group->p);
 }
 
 /*
@@ -366,21 +407,25 @@ void dh_cleanup(dh_ctx *ctx)
         mp_free(ctx->x);
     if (ctx->e)
         mp_free(ctx->e);
-    if (ctx->p)
-        mp_free(ctx->p);
-    if (ctx->g)
-        mp_free(ctx->g);
-    if (ctx->q)
-        mp_free(ctx->q);
+    if (ctx->group_owned)
+        dh_group_free(ctx->group);
     sfree(ctx);
 }
 
 /*
  * DH stage 1: invent a number x between 1 and q, and compute e =
  * g^x mod p. Return e.
+ *
+ * If this has already been done for this context (because it was
+ * set up in advance of a key exchange), just return the same e.
  */
 mp_int *dh_create_e(dh_ctx *ctx)
 {
+    dh_group *group = ctx->group;
+
+    if (ctx->e)
+        return ctx->e;
+
     /*
      * Lower limit is just 2.
      */
@@ -389,7 +434,7 @@ mp_int *dh_create_e(dh_ctx *ctx)
     /*
      * Upper limit.
      */
-    mp_int *hi = mp_copy(ctx->q);
+    mp_int *hi = mp_copy(group->q);
     mp_sub_integer_into(hi, hi, 1);
 
     /*
@@ -402,7 +447,9 @@ mp_int *dh_create_e(dh_ctx *ctx)
     /*
      * Now compute e = g^x mod p.
      */
-    ctx->e = mp_modpow(ctx->g, ctx->x, ctx->p);
+    mp_int *m_e = monty_pow(group->mc, group->g_monty, ctx->x);
+    ctx->e = monty_export(group->mc, m_e);
+    mp_free(m_e);
 
     return ctx->e;
 }
@@ -420,7 +467,7 @@ const char *dh_validate_f(dh_ctx *ctx, mp_int *f)
     if (!mp_hs_integer(f, 2)) {
         return "f value received is too small";
     } else {
-        mp_int *pm1 = mp_copy(ctx->p);
+        mp_int *pm1 = mp_copy(ctx->group->p);
         mp_sub_integer_into(pm1, pm1, 1);
         unsigned cmp = mp_cmp_hs(f, pm1);
         mp_free(pm1);
@@ -435,5 +482,11 @@ const char *dh_validate_f(dh_ctx *ctx, mp_int *f)
  */
 mp_int *dh_find_K(dh_ctx *ctx, mp_int *f)
 {
-    return mp_modpow(f, ctx->x, ctx->p);
+    MontyContext *mc = ctx->group->mc;
+    mp_int *m_f = monty_import(mc, f);
+    mp_int *m_K = monty_pow(mc, m_f, ctx->x);
+    mp_int *K = monty_export(mc, m_K);
+    mp_free(m_f);
+    mp_free(m_K);
+    return K;
 }
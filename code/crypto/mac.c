@@ -41,3 +41,29 @@ bool ssh2_mac_verify(
     ssh2_mac_prepare(mac, blk, len, seq);
     return ssh2_mac_verresult(mac, (const unsigned char *)blk + len);
 }
+
+void ssh2_mac_encrypt_and_generate(ssh2_mac *mac, ssh_cipher *cipher,
+                                   void *blk, int len, unsigned long seq)
+{
+    if (cipher && mac->vt->aead_encrypt) {
+        mac->vt->aead_encrypt(mac, blk, len, seq);
+        return;
+    }
+
+    if (cipher)
+        ssh_cipher_encrypt(cipher, (unsigned char *)blk + 4, len - 4);
+    ssh2_mac_generate(mac, blk, len, seq);
+}
+
+bool ssh2_mac_verify_and_decrypt(ssh2_mac *mac, ssh_cipher *cipher,
+                                 void *blk, int len, unsigned long seq)
+{
+    if (cipher && mac->vt->aead_decrypt)
+        return mac->vt->aead_decrypt(mac, blk, len, seq);
+
+    if (!ssh2_mac_verify(mac, blk, len, seq))
+        return false;
+    if (cipher)
+        ssh_cipher_decrypt(cipher, (unsigned char *)blk + 4, len - 4);
+    return true;
+}
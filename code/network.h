@@ -32,9 +32,26 @@ struct SocketVtable {
     size_t (*write_oob) (Socket *s, const void *data, size_t len);
     void (*write_eof) (Socket *s);
     void (*set_frozen) (Socket *s, bool is_frozen);
+    /* optional: may be NULL if the socket can't batch up writes */
+    void (*set_corked) (Socket *s, bool is_corked);
     /* ignored by tcp, but vital for ssl */
     const char *(*socket_error) (Socket *s);
     SocketPeerInfo *(*peer_info) (Socket *s);
+    /* optional: may be NULL if the socket doesn't keep statistics */
+    bool (*get_io_stats) (Socket *s, SocketIOStats *stats);
+};
+
+/*
+ * Counters kept by socket implementations that support them, to show
+ * how many system calls it's taking to move a given amount of data.
+ */
+struct SocketIOStats {
+    uint64_t read_calls;     /* number of read/recv syscalls made */
+    uint64_t read_events;    /* number of readability events handled */
+    uint64_t bytes_read;
+    uint64_t write_calls;    /* number of write/send syscalls made */
+    uint64_t bytes_written;
+    size_t read_size;        /* current adaptive read buffer size */
 };
 
 typedef union { void *p; int i; } accept_ctx_t;
@@ -291,6 +308,21 @@ static inline const char *sk_socket_error(Socket *s)
 static inline void sk_set_frozen(Socket *s, bool is_frozen)
 { s->vt->set_frozen(s, is_frozen); }
 
+/*
+ * Set the `corked' flag on a socket. While a socket is corked, data
+ * passed to sk_write may be held back in its buffer rather than sent
+ * immediately, so that a caller about to make a run of small writes
+ * can have them go out in as few system calls as possible. Uncorking
+ * the socket sends whatever was held back. The socket won't hold back
+ * more than a modest amount, so the value returned from sk_write can
+ * still be used to decide when to throttle.
+ *
+ * Not every socket type supports this, in which case it does
+ * nothing.
+ */
+static inline void sk_set_corked(Socket *s, bool is_corked)
+{ if (s->vt->set_corked) s->vt->set_corked(s, is_corked); }
+
 /*
  * Return a structure giving some information about the other end of
  * the socket. May be NULL, if nothing is available at all. If it is
@@ -300,6 +332,13 @@ static inline void sk_set_frozen(Socket *s, bool is_frozen)
 static inline SocketPeerInfo *sk_peer_info(Socket *s)
 { return s->vt->peer_info(s); }
 
+/*
+ * Fill in a SocketIOStats for the socket, returning false (and
+ * leaving the structure untouched) if it doesn't keep any.
+ */
+static inline bool sk_get_io_stats(Socket *s, SocketIOStats *stats)
+{ return s->vt->get_io_stats && s->vt->get_io_stats(s, stats); }
+
 /*
  * The structure returned from sk_peer_info, and a function to free
  * one (in utils).
@@ -1121,6 +1121,7 @@ int scp_get_sink_action(struct scp_sink_action *act)
         char *fname;
         bool must_free_fname;
         struct fxp_attrs attrs;
+        const struct fxp_attrs *dirattrs = NULL;
         struct sftp_packet *pktin;
         struct sftp_request *req;
         bool ret;
@@ -1155,6 +1156,7 @@ int scp_get_sink_action(struct scp_sink_action *act)
                 head->namepos++;       /* skip . and .. */
             if (head->namepos < head->namelen) {
                 head->matched_something = true;
+                dirattrs = &head->names[head->namepos].attrs;
                 fname = dupcat(head->dirpath, "/",
                                head->names[head->namepos++].filename);
                 must_free_fname = true;
@@ -1189,10 +1191,25 @@ int scp_get_sink_action(struct scp_sink_action *act)
         /*
          * Now we have a filename. Stat it, and see if it's a file
          * or a directory.
+         *
+         * If it came out of a directory listing, then FXP_READDIR
+         * may already have told us everything we need, in which case
+         * we can save a round trip per file. But we can't use those
+         * attributes if they describe a symlink (or anything else we
+         * don't understand), because we want what it points to.
          */
-        req = fxp_stat_send(fname);
-        pktin = sftp_wait_for_reply(req);
-        ret = fxp_stat_recv(pktin, req, &attrs);
+        if (dirattrs &&
+            (dirattrs->flags & SSH_FILEXFER_ATTR_PERMISSIONS) &&
+            ((dirattrs->permissions & 0170000) == 0040000 ||
+             ((dirattrs->permissions & 0170000) == 0100000 &&
+              (dirattrs->flags & SSH_FILEXFER_ATTR_SIZE)))) {
+            attrs = *dirattrs;
+            ret = true;
+        } else {
+            req = fxp_stat_send(fname);
+            pktin = sftp_wait_for_reply(req);
+            ret = fxp_stat_recv(pktin, req, &attrs);
+        }
 
         if (!ret || !(attrs.flags & SSH_FILEXFER_ATTR_PERMISSIONS)) {
             with_stripctrl(san, fname)
@@ -1595,10 +1612,11 @@ static void source(const char *src)
     long permissions;
     const char *last;
     RFile *f;
-    int attr;
-    uint64_t i;
+    int attr, blocklen;
+    uint64_t i, nreads;
     uint64_t stat_bytes;
     time_t stat_starttime, stat_lasttime;
+    char *buf;
 
     attr = file_type(src);
     if (attr == FILE_TYPE_NONEXISTENT ||
@@ -1664,31 +1682,55 @@ static void source(const char *src)
     stat_starttime = time(NULL);
     stat_lasttime = 0;
 
-#define PSCP_SEND_BLOCK 4096
-    for (i = 0; i < size; i += PSCP_SEND_BLOCK) {
-        char transbuf[PSCP_SEND_BLOCK];
-        int j, k = PSCP_SEND_BLOCK;
-
-        if (i + k > size)
-            k = size - i;
-        if ((j = read_from_file(f, transbuf, k)) != k) {
+    /*
+     * Read the file in large blocks, to keep the number of system
+     * calls down, but hand it to the sending code in smaller pieces,
+     * so that the statistics are kept up to date on a slow link.
+     * (In SFTP mode, xfer_upload_data will coalesce those into write
+     * requests as large as the protocol allows.)
+     */
+#define PSCP_SEND_BLOCK 65536
+    buf = snewn(UPLOAD_BLOCK_SIZE, char);
+    nreads = 0;
+    for (i = 0; i < size; i += blocklen) {
+        int j, k;
+
+        blocklen = UPLOAD_BLOCK_SIZE;
+        if (i + blocklen > size)
+            blocklen = size - i;
+        if ((j = read_block_from_file(f, buf, blocklen, &nreads)) !=
+            blocklen) {
             bump("%s: Read error", src);
         }
-        if (scp_send_filedata(transbuf, k))
-            bump("%s: Network error occurred", src);
-
-        if (statistics) {
-            stat_bytes += k;
-            if (time(NULL) != stat_lasttime || i + k == size) {
-                stat_lasttime = time(NULL);
-                print_stats(last, size, stat_bytes,
-                            stat_starttime, stat_lasttime);
+
+        for (j = 0; j < blocklen; j += k) {
+            k = PSCP_SEND_BLOCK;
+            if (j + k > blocklen)
+                k = blocklen - j;
+            if (scp_send_filedata(buf + j, k))
+                bump("%s: Network error occurred", src);
+
+            if (statistics) {
+                stat_bytes += k;
+                if (time(NULL) != stat_lasttime || i + j + k == size) {
+                    stat_lasttime = time(NULL);
+                    print_stats(last, size, stat_bytes,
+                                stat_starttime, stat_lasttime);
+                }
             }
         }
-
     }
+    sfree(buf);
     close_rfile(f);
 
+    if (verbose && size > 0) {
+        double gb = size / 1073741824.0;
+        uint64_t nreqs = using_sftp ? xfer_requests(scp_sftp_xfer) : 0;
+        tell_user(stderr, "Sent %"PRIu64" bytes in %"PRIu64" reads and "
+                  "%"PRIu64" write requests (%.0f and %.0f per GB)",
+                  size, nreads, nreqs, nreads / gb, nreqs / gb);
+    }
+
     (void) scp_send_finish();
 }
 
@@ -2207,6 +2249,10 @@ static void usage(void)
     printf("            force use of particular SSH protocol variant\n");
     printf("  -4 -6     force use of IPv4 or IPv6\n");
     printf("  -C        enable compression\n");
+    printf("  -compress-thread\n");
+    printf("            compress on a separate thread (SSH-2 only)\n");
+    printf("  -cipher-threads n\n");
+    printf("            encrypt on up to n worker threads (SSH-2 only)\n");
     printf("  -i key    private key file for user authentication\n");
     printf("  -noagent  disable use of Pageant\n");
     printf("  -agent    enable use of Pageant\n");
@@ -34,6 +34,7 @@ static LogContext *psftp_logctx = NULL;
 static Backend *backend;
 static Conf *conf;
 static bool sent_eof = false;
+static bool verbose = false;
 
 /* ------------------------------------------------------------
  * Seat vtable.
@@ -87,13 +88,33 @@ static StripCtrlChars *string_scc;
 /* ----------------------------------------------------------------------
  * Manage sending requests and waiting for replies.
  */
+
+/*
+ * While a recursive download is in progress, the directory walker
+ * has requests outstanding alongside everything else we send, so
+ * every packet we receive has to be offered to it first.
+ */
+static struct fxp_walk *current_walk;
+
+static struct sftp_packet *sftp_recv_reply(void)
+{
+    struct sftp_packet *pktin;
+
+    while (true) {
+        pktin = sftp_recv();
+        if (!pktin || !current_walk ||
+            walk_gotpkt(current_walk, pktin) == INT_MIN)
+            return pktin;
+    }
+}
+
 struct sftp_packet *sftp_wait_for_reply(struct sftp_request *req)
 {
     struct sftp_packet *pktin;
     struct sftp_request *rreq;
 
     sftp_register(req);
-    pktin = sftp_recv();
+    pktin = sftp_recv_reply();
     if (pktin == NULL) {
         seat_connection_fatal(
             psftp_seat, "did not receive SFTP response packet from server");
@@ -231,190 +252,672 @@ static void not_connected(void)
 }
 
 /* ----------------------------------------------------------------------
- * The meat of the `get' and `put' commands.
+ * Delta transfers, for 'reget -d' and 'reput -d'. The server hashes
+ * its copy of the file in blocks, and we transfer only the blocks
+ * whose hashes don't match our copy.
+ *
+ * If the server supports our block-sums extension, a download can
+ * find each remote block anywhere in the local file, rsync-style,
+ * by rolling a weak checksum along it; the new file is then built
+ * in a temporary file from local and downloaded blocks. With only
+ * check-file, or in an upload (which we have to apply in place, so
+ * can't move data about within the remote file), blocks are only
+ * compared with the block at the same offset.
  */
-bool sftp_get_file(char *fname, char *outfname, bool recurse, bool restart)
+static bool delta_mode;
+
+#define DELTA_MIN_BLOCK 2048
+#define DELTA_MAX_BLOCK 32768          /* so that one FXP_READ fetches one */
+#define DELTA_BLOCKS_PER_REQUEST 1024
+#define DELTA_MAX_REQUESTS 16
+#define DELTA_NO_MATCH UINT64_MAX
+
+static unsigned delta_block_size(uint64_t size)
 {
-    struct fxp_handle *fh;
-    struct sftp_packet *pktin;
-    struct sftp_request *req;
-    struct fxp_xfer *xfer;
-    uint64_t offset;
-    WFile *file;
-    bool toret, shown_err = false;
-    struct fxp_attrs attrs;
+    /* Roughly the square root of the file size, as rsync does */
+    unsigned blocksize = DELTA_MIN_BLOCK;
+    while (blocksize < DELTA_MAX_BLOCK && (uint64_t)blocksize * blocksize < size)
+        blocksize *= 2;
+    return blocksize;
+}
 
-    /*
-     * In recursive mode, see if we're dealing with a directory.
-     * (If we're not in recursive mode, we need not even check: the
-     * subsequent FXP_OPEN will return a usable error message.)
-     */
-    if (recurse) {
-        bool result;
+struct delta_sums {
+    uint64_t size;                     /* of the remote file */
+    unsigned blocksize;
+    size_t nblocks;
+    bool hashed;                       /* false if the server can't hash */
+    bool rolling;                      /* block-sums, not check-file */
+    const ssh_hashalg *alg;            /* for check-file */
+    size_t sumlen;                     /* bytes per block in sums */
+    strbuf *sums;
+    uint64_t bytes;                    /* received, for statistics */
+};
 
-        req = fxp_stat_send(fname);
-        pktin = sftp_wait_for_reply(req);
-        result = fxp_stat_recv(pktin, req, &attrs);
+static inline unsigned delta_block_len(struct delta_sums *ds, size_t j)
+{
+    uint64_t left = ds->size - (uint64_t)j * ds->blocksize;
+    return left < ds->blocksize ? left : ds->blocksize;
+}
 
-        if (result &&
-            (attrs.flags & SSH_FILEXFER_ATTR_PERMISSIONS) &&
-            (attrs.permissions & 0040000)) {
+static struct sftp_packet *delta_recv(struct sftp_request **rreq)
+{
+    struct sftp_packet *pktin = sftp_recv_reply();
 
-            struct fxp_handle *dirhandle;
-            size_t nnames, namesize;
-            struct fxp_name **ournames;
-            struct fxp_names *names;
-            int i;
+    if (!pktin) {
+        seat_connection_fatal(
+            psftp_seat, "did not receive SFTP response packet from server");
+    }
+    *rreq = sftp_find_request(pktin);
+    if (!*rreq) {
+        seat_connection_fatal(
+            psftp_seat,
+            "unable to understand SFTP response packet from server: %s",
+            fxp_error());
+    }
+    return pktin;
+}
 
-            /*
-             * First, attempt to create the destination directory,
-             * unless it already exists.
-             */
-            if (file_type(outfname) != FILE_TYPE_DIRECTORY &&
-                !create_directory(outfname)) {
-                with_stripctrl(san, outfname)
-                    printf("%s: Cannot create directory\n", san);
-                return false;
-            }
+struct delta_sums_req {
+    size_t first, n;                   /* blocks covered */
+    strbuf *out;
+};
 
-            /*
-             * Now get the list of filenames in the remote
-             * directory.
-             */
-            req = fxp_opendir_send(fname);
-            pktin = sftp_wait_for_reply(req);
-            dirhandle = fxp_opendir_recv(pktin, req);
+/*
+ * Ask the server for the hashes of every block of an open file,
+ * several requests at a time. Returns false on error; if the server
+ * can't hash files at all, succeeds with ds->hashed false.
+ */
+static bool delta_get_sums(struct fxp_handle *fh, uint64_t size,
+                           unsigned blocksize, struct delta_sums *ds)
+{
+    size_t nreqs, sent = 0, outstanding = 0;
+    bool err = false;
+    char *alg = NULL;
+
+    memset(ds, 0, sizeof(*ds));
+    ds->size = size;
+    ds->blocksize = blocksize;
+    ds->nblocks = (size + blocksize - 1) / blocksize;
+    ds->sums = strbuf_new();
+
+    if (fxp_extension(SFTP_EXT_BLOCK_SUMS)) {
+        ds->rolling = true;
+        ds->sumlen = SFTP_BLOCK_SUM_LEN;
+    } else if (fxp_extension(SFTP_EXT_CHECK_FILE) ||
+               fxp_extension(SFTP_EXT_CHECK_FILE_HANDLE)) {
+        ds->rolling = false;
+    } else {
+        printf("server cannot hash files: transferring whole file\n");
+        return true;
+    }
 
-            if (!dirhandle) {
-                with_stripctrl(san, fname)
-                    printf("%s: unable to open directory: %s\n",
-                           san, fxp_error());
-                return false;
+    ds->hashed = true;
+    nreqs = (ds->nblocks + DELTA_BLOCKS_PER_REQUEST - 1) /
+        DELTA_BLOCKS_PER_REQUEST;
+    struct delta_sums_req *reqs = snewn(nreqs, struct delta_sums_req);
+
+    while (sent < nreqs || outstanding > 0) {
+        while (!err && sent < nreqs && outstanding < DELTA_MAX_REQUESTS) {
+            struct delta_sums_req *dr = &reqs[sent++];
+            struct sftp_request *req;
+            uint64_t offset;
+
+            dr->first = (sent - 1) * DELTA_BLOCKS_PER_REQUEST;
+            dr->n = ds->nblocks - dr->first;
+            if (dr->n > DELTA_BLOCKS_PER_REQUEST)
+                dr->n = DELTA_BLOCKS_PER_REQUEST;
+            dr->out = strbuf_new();
+            offset = (uint64_t)dr->first * blocksize;
+            if (ds->rolling)
+                req = fxp_block_sums_send(fh, offset,
+                                          (uint64_t)dr->n * blocksize,
+                                          blocksize);
+            else
+                req = fxp_check_file_send(fh, SFTP_CHECK_FILE_ALGS, offset,
+                                          (uint64_t)dr->n * blocksize,
+                                          blocksize);
+            sftp_register(req);
+            fxp_set_userdata(req, dr);
+            outstanding++;
+        }
+        if (err && outstanding == 0)
+            break;
+
+        struct sftp_request *rreq;
+        struct sftp_packet *pktin = delta_recv(&rreq);
+        struct delta_sums_req *dr = fxp_get_userdata(rreq);
+        bool ok;
+        outstanding--;
+
+        if (ds->rolling) {
+            ok = fxp_block_sums_recv(pktin, rreq, dr->out);
+        } else {
+            char *thisalg = NULL;
+            ok = fxp_check_file_recv(pktin, rreq, &thisalg, dr->out);
+            if (ok && !alg) {
+                alg = thisalg;
+                ds->alg = sftp_check_file_hashalg(ptrlen_from_asciz(alg));
+                if (ds->alg)
+                    ds->sumlen = ds->alg->hlen;
+            } else {
+                if (ok && strcmp(alg, thisalg))
+                    ds->alg = NULL;
+                sfree(thisalg);
             }
-            nnames = namesize = 0;
-            ournames = NULL;
-            while (1) {
-                int i;
+        }
+        if (!ok) {
+            if (!err)
+                printf("hashing remote file: %s\n", fxp_error());
+            err = true;
+        } else if (!ds->alg && !ds->rolling) {
+            if (!err)
+                printf("hashing remote file: unexpected algorithm '%s'\n",
+                       alg);
+            err = true;
+        } else if (dr->out->len != dr->n * ds->sumlen) {
+            if (!err)
+                printf("hashing remote file: wrong number of hashes\n");
+            err = true;
+        }
+    }
 
-                req = fxp_readdir_send(dirhandle);
-                pktin = sftp_wait_for_reply(req);
-                names = fxp_readdir_recv(pktin, req);
+    /* Assemble the results in order */
+    for (size_t i = 0; i < sent; i++) {
+        if (!err) {
+            put_datapl(ds->sums, ptrlen_from_strbuf(reqs[i].out));
+            ds->bytes += reqs[i].out->len;
+        }
+        strbuf_free(reqs[i].out);
+    }
+    sfree(reqs);
+    sfree(alg);
+    return !err;
+}
 
-                if (names == NULL) {
-                    if (fxp_error_type() == SSH_FX_EOF)
-                        break;
-                    with_stripctrl(san, fname)
-                        printf("%s: reading directory: %s\n",
-                               san, fxp_error());
+/*
+ * Read sequentially through a local file, keeping enough of it
+ * buffered to look at any range starting at or after the last one.
+ */
+struct delta_reader {
+    RFile *file;
+    unsigned char *buf;
+    size_t bufsize, start, end;        /* valid data in buf[start,end) */
+    uint64_t base;                     /* file offset of buf[0] */
+    bool eof, err;
+};
 
-                    req = fxp_close_send(dirhandle);
-                    pktin = sftp_wait_for_reply(req);
-                    fxp_close_recv(pktin, req);
+static void delta_reader_init(struct delta_reader *dr, RFile *file,
+                              unsigned blocksize)
+{
+    dr->file = file;
+    dr->bufsize = UPLOAD_BLOCK_SIZE + 2 * blocksize;
+    dr->buf = snewn(dr->bufsize, unsigned char);
+    dr->start = dr->end = 0;
+    dr->base = 0;
+    dr->eof = dr->err = false;
+}
+
+/*
+ * Return a pointer to the data at 'offset', and set *len to how much
+ * of the requested 'want' is available there (less only at EOF).
+ */
+static const unsigned char *delta_reader_get(
+    struct delta_reader *dr, uint64_t offset, unsigned want, unsigned *len)
+{
+    assert(offset >= dr->base + dr->start);
+
+    while (offset + want > dr->base + dr->end && !dr->eof) {
+        size_t keep = offset - dr->base;
+        if (keep > dr->end)
+            keep = dr->end;
+        memmove(dr->buf, dr->buf + keep, dr->end - keep);
+        dr->base += keep;
+        dr->end -= keep;
+        dr->start = 0;
+
+        int ret = read_from_file(dr->file, dr->buf + dr->end,
+                                 dr->bufsize - dr->end);
+        if (ret < 0)
+            dr->err = true;
+        if (ret <= 0)
+            dr->eof = true;
+        else
+            dr->end += ret;
+    }
+
+    if (offset >= dr->base + dr->end) {
+        *len = 0;
+        return NULL;
+    }
+    dr->start = offset - dr->base;
+    *len = dr->end - dr->start < want ? dr->end - dr->start : want;
+    return dr->buf + dr->start;
+}
+
+static void delta_reader_free(struct delta_reader *dr)
+{
+    sfree(dr->buf);
+}
+
+/*
+ * Compare a local block with block j of the remote file.
+ */
+static bool delta_block_matches(struct delta_sums *ds, size_t j,
+                                const unsigned char *data, unsigned len)
+{
+    const unsigned char *sum = ds->sums->u + j * ds->sumlen;
+    unsigned char hash[MAX_HASH_LEN];
+
+    if (!ds->hashed || j >= ds->nblocks || len != delta_block_len(ds, j))
+        return false;
+    if (ds->rolling) {
+        if (GET_32BIT_MSB_FIRST(sum) != sftp_rollsum(data, len))
+            return false;
+        sftp_block_strong_sum(make_ptrlen(data, len), hash);
+        return !memcmp(hash, sum + 4, SFTP_BLOCK_STRONG_LEN);
+    } else {
+        hash_simple(ds->alg, make_ptrlen(data, len), hash);
+        return !memcmp(hash, sum, ds->sumlen);
+    }
+}
+
+static inline size_t delta_bucket(uint32_t weak, unsigned bits)
+{
+    return (uint32_t)(weak * 0x9E3779B1U) >> (32 - bits);
+}
 
-                    sfree(ournames);
-                    return false;
+/*
+ * Find the offset in the local file of each block of the remote file
+ * that we already have, filling in match[] (DELTA_NO_MATCH for
+ * blocks we'll have to download).
+ */
+static bool delta_find_matches(struct delta_sums *ds, RFile *file,
+                               uint64_t *match)
+{
+    struct delta_reader dr[1];
+    unsigned blocksize = ds->blocksize, len;
+    const unsigned char *data;
+    size_t nfull = ds->size / blocksize;
+    bool ok;
+
+    for (size_t j = 0; j < ds->nblocks; j++)
+        match[j] = DELTA_NO_MATCH;
+    if (!ds->hashed)
+        return true;
+
+    delta_reader_init(dr, file, blocksize);
+
+    if (!ds->rolling) {
+        for (size_t j = 0; j < ds->nblocks; j++) {
+            uint64_t offset = (uint64_t)j * blocksize;
+            data = delta_reader_get(dr, offset, blocksize, &len);
+            if (!len)
+                break;
+            if (delta_block_matches(ds, j, data, len))
+                match[j] = offset;
+        }
+    } else if (nfull > 0) {
+        /*
+         * Index the full-sized blocks by weak checksum. (A final
+         * short block is always downloaded.)
+         */
+        size_t tablesize = 1, *head, *next;
+        unsigned bits = 0;
+        while (tablesize < 2 * nfull) {
+            tablesize <<= 1;
+            bits++;
+        }
+        head = snewn(tablesize, size_t);
+        next = snewn(nfull, size_t);
+        for (size_t i = 0; i < tablesize; i++)
+            head[i] = SIZE_MAX;
+        for (size_t j = nfull; j-- > 0 ;) {
+            uint32_t weak = GET_32BIT_MSB_FIRST(ds->sums->u + j * ds->sumlen);
+            size_t b = delta_bucket(weak, bits);
+            next[j] = head[b];
+            head[b] = j;
+        }
+
+        /*
+         * Roll along the local file. Wherever the weak checksum of
+         * the window matches a block we still need, check the strong
+         * one; after a match, skip over the matched data.
+         */
+        uint64_t offset = 0;
+        bool fresh = true;
+        uint32_t weak = 0;
+        while (true) {
+            data = delta_reader_get(dr, offset, blocksize + 1, &len);
+            if (len < blocksize)
+                break;
+            if (fresh)
+                weak = sftp_rollsum(data, blocksize);
+            fresh = false;
+
+            bool matched = false, havestrong = false;
+            unsigned char strong[SFTP_BLOCK_STRONG_LEN];
+            for (size_t j = head[delta_bucket(weak, bits)]; j != SIZE_MAX;
+                 j = next[j]) {
+                const unsigned char *sum = ds->sums->u + j * ds->sumlen;
+                if (match[j] != DELTA_NO_MATCH ||
+                    GET_32BIT_MSB_FIRST(sum) != weak)
+                    continue;
+                if (!havestrong) {
+                    sftp_block_strong_sum(make_ptrlen(data, blocksize),
+                                          strong);
+                    havestrong = true;
                 }
-                if (names->nnames == 0) {
-                    fxp_free_names(names);
-                    break;
+                if (!memcmp(strong, sum + 4, SFTP_BLOCK_STRONG_LEN)) {
+                    match[j] = offset;
+                    matched = true;
                 }
-                sgrowarrayn(ournames, namesize, nnames, names->nnames);
-                for (i = 0; i < names->nnames; i++)
-                    if (strcmp(names->names[i].filename, ".") &&
-                        strcmp(names->names[i].filename, "..")) {
-                        if (!vet_filename(names->names[i].filename)) {
-                            with_stripctrl(san, names->names[i].filename)
-                                printf("ignoring potentially dangerous server-"
-                                       "supplied filename '%s'\n", san);
-                        } else {
-                            ournames[nnames++] =
-                                fxp_dup_name(&names->names[i]);
-                        }
-                    }
-                fxp_free_names(names);
             }
-            req = fxp_close_send(dirhandle);
-            pktin = sftp_wait_for_reply(req);
-            fxp_close_recv(pktin, req);
 
-            /*
-             * Sort the names into a clear order. This ought to
-             * make things more predictable when we're doing a
-             * reget of the same directory, just in case two
-             * readdirs on the same remote directory return a
-             * different order.
-             */
-            if (nnames > 0)
-                qsort(ournames, nnames, sizeof(*ournames), sftp_name_compare);
+            if (matched) {
+                offset += blocksize;
+                fresh = true;
+            } else if (len > blocksize) {
+                weak = sftp_rollsum_roll(weak, data[0], data[blocksize],
+                                         blocksize);
+                offset++;
+            } else {
+                break;
+            }
+        }
 
-            /*
-             * If we're in restart mode, find the last filename on
-             * this list that already exists. We may have to do a
-             * reget on _that_ file, but shouldn't have to do
-             * anything on the previous files.
-             *
-             * If none of them exists, of course, we start at 0.
-             */
-            i = 0;
-            if (restart) {
-                while (i < nnames) {
-                    char *nextoutfname;
-                    bool nonexistent;
-                    nextoutfname = dir_file_cat(outfname,
-                                                ournames[i]->filename);
-                    nonexistent = (file_type(nextoutfname) ==
-                                   FILE_TYPE_NONEXISTENT);
-                    sfree(nextoutfname);
-                    if (nonexistent)
-                        break;
-                    i++;
-                }
-                if (i > 0)
-                    i--;
+        sfree(head);
+        sfree(next);
+    }
+
+    ok = !dr->err;
+    delta_reader_free(dr);
+    if (!ok)
+        printf("error while reading local file\n");
+    return ok;
+}
+
+static void delta_report(const char *cmd, const char *fname,
+                         uint64_t size, uint64_t sent, uint64_t sumbytes)
+{
+    with_stripctrl(san, fname)
+        printf("%s: %s: %"PRIu64" of %"PRIu64" bytes transferred, "
+               "%"PRIu64" bytes of hashes, %"PRIu64" bytes saved\n",
+               cmd, san, sent, size, sumbytes,
+               size > sent + sumbytes ? size - (sent + sumbytes) : 0);
+}
+
+struct delta_match {
+    uint64_t offset;                   /* in the local file */
+    size_t block;                      /* in the remote file */
+};
+
+static int delta_match_cmp(const void *av, const void *bv)
+{
+    const struct delta_match *a = (const struct delta_match *)av;
+    const struct delta_match *b = (const struct delta_match *)bv;
+    return a->offset < b->offset ? -1 : a->offset > b->offset ? +1 : 0;
+}
+
+/*
+ * Bring the local file 'outfname' up to date with the remote file
+ * open as 'fh', by building the new version in a temporary file and
+ * renaming it into place.
+ */
+static bool sftp_get_delta(char *fname, char *outfname,
+                           struct fxp_handle *fh, uint64_t size, long perms)
+{
+    struct delta_sums ds;
+    struct delta_match *matches = NULL;
+    uint64_t *match = NULL, sent = 0;
+    size_t nmatches = 0;
+    RFile *file = NULL;
+    WFile *out = NULL;
+    char *tmpname = dupcat(outfname, ".reget");
+    bool err = false;
+
+    if (!delta_get_sums(fh, size, delta_block_size(size), &ds)) {
+        err = true;
+        goto cleanup;
+    }
+
+    if (!(file = open_existing_file(outfname, NULL, NULL, NULL, NULL))) {
+        with_stripctrl(san, outfname)
+            printf("local: unable to open %s\n", san);
+        err = true;
+        goto cleanup;
+    }
+    match = snewn(ds.nblocks, uint64_t);
+    if (!delta_find_matches(&ds, file, match)) {
+        err = true;
+        goto cleanup;
+    }
+    close_rfile(file);
+    file = NULL;
+
+    if (!(out = open_new_file(tmpname, perms))) {
+        with_stripctrl(san, tmpname)
+            printf("local: unable to open %s\n", san);
+        err = true;
+        goto cleanup;
+    }
+
+    /*
+     * Copy the blocks we already have, reading the local file in
+     * order once more.
+     */
+    matches = snewn(ds.nblocks, struct delta_match);
+    for (size_t j = 0; j < ds.nblocks; j++) {
+        if (match[j] != DELTA_NO_MATCH) {
+            matches[nmatches].offset = match[j];
+            matches[nmatches].block = j;
+            nmatches++;
+        }
+    }
+    if (nmatches) {
+        struct delta_reader dr[1];
+
+        qsort(matches, nmatches, sizeof(*matches), delta_match_cmp);
+        if (!(file = open_existing_file(outfname, NULL, NULL, NULL, NULL))) {
+            with_stripctrl(san, outfname)
+                printf("local: unable to open %s\n", san);
+            err = true;
+            goto cleanup;
+        }
+        delta_reader_init(dr, file, ds.blocksize);
+        for (size_t i = 0; i < nmatches && !err; i++) {
+            unsigned want = delta_block_len(&ds, matches[i].block), len;
+            const unsigned char *data = delta_reader_get(
+                dr, matches[i].offset, want, &len);
+            if (len != want ||
+                seek_file(out, (uint64_t)matches[i].block * ds.blocksize,
+                          FROM_START) != 0 ||
+                write_to_file(out, (void *)data, len) != len) {
+                printf("error while copying local file\n");
+                err = true;
             }
+        }
+        delta_reader_free(dr);
+        close_rfile(file);
+        file = NULL;
+        if (err)
+            goto cleanup;
+    }
 
-            /*
-             * Now we're ready to recurse. Starting at ournames[i]
-             * and continuing on to the end of the list, we
-             * construct a new source and target file name, and
-             * call sftp_get_file again.
-             */
-            for (; i < nnames; i++) {
-                char *nextfname, *nextoutfname;
-                bool retd;
-
-                nextfname = dupcat(fname, "/", ournames[i]->filename);
-                nextoutfname = dir_file_cat(outfname, ournames[i]->filename);
-                retd = sftp_get_file(
-                    nextfname, nextoutfname, recurse, restart);
-                restart = false;       /* after first partial file, do full */
-                sfree(nextoutfname);
-                sfree(nextfname);
-                if (!retd) {
-                    for (i = 0; i < nnames; i++) {
-                        fxp_free_name(ournames[i]);
-                    }
-                    sfree(ournames);
-                    return false;
-                }
+    /*
+     * Download the rest, one block per FXP_READ.
+     */
+    {
+        size_t j = 0, outstanding = 0;
+        char *buf = snewn(ds.blocksize, char);
+
+        while (true) {
+            while (!err && outstanding < DELTA_MAX_REQUESTS) {
+                while (j < ds.nblocks && match[j] != DELTA_NO_MATCH)
+                    j++;
+                if (j >= ds.nblocks)
+                    break;
+                struct sftp_request *req = fxp_read_send(
+                    fh, (uint64_t)j * ds.blocksize, delta_block_len(&ds, j));
+                sftp_register(req);
+                fxp_set_userdata(req, &match[j]);
+                outstanding++;
+                j++;
             }
+            if (outstanding == 0)
+                break;
 
-            /*
-             * Done this recursion level. Free everything.
-             */
-            for (i = 0; i < nnames; i++) {
-                fxp_free_name(ournames[i]);
+            struct sftp_request *rreq;
+            struct sftp_packet *pktin = delta_recv(&rreq);
+            size_t block = (uint64_t *)fxp_get_userdata(rreq) - match;
+            unsigned want = delta_block_len(&ds, block);
+            int len = fxp_read_recv(pktin, rreq, buf, want);
+            outstanding--;
+
+            if (err)
+                continue;
+            if (len < 0) {
+                printf("error while reading: %s\n", fxp_error());
+                err = true;
+            } else if (len != want) {
+                printf("error while reading: remote file has changed\n");
+                err = true;
+            } else if (seek_file(out, (uint64_t)block * ds.blocksize,
+                                 FROM_START) != 0 ||
+                       write_to_file(out, buf, len) != len) {
+                printf("error while writing local file\n");
+                err = true;
+            } else {
+                sent += len;
             }
-            sfree(ournames);
+        }
+        sfree(buf);
+    }
+    if (err)
+        goto cleanup;
+
+    close_wfile(out);
+    out = NULL;
+    if (rename(tmpname, outfname) != 0 &&
+        (remove(outfname) != 0 || rename(tmpname, outfname) != 0)) {
+        with_stripctrl(san, outfname)
+            printf("local: unable to replace %s\n", san);
+        err = true;
+        goto cleanup;
+    }
+    delta_report("reget", fname, size, sent, ds.bytes);
+
+  cleanup:
+    if (file)
+        close_rfile(file);
+    if (out)
+        close_wfile(out);
+    if (err)
+        remove(tmpname);
+    sfree(tmpname);
+    sfree(match);
+    sfree(matches);
+    strbuf_free(ds.sums);
+    return !err;
+}
 
-            return true;
+/*
+ * Bring the remote file open as 'fh', currently 'rsize' bytes long,
+ * up to date with the local file 'fname' (open as 'file', and
+ * 'lsize' bytes long), writing only the blocks that differ.
+ */
+static bool sftp_put_delta(char *fname, char *outfname, RFile *file,
+                           uint64_t lsize, struct fxp_handle *fh,
+                           uint64_t rsize)
+{
+    struct delta_sums ds;
+    struct delta_reader dr[1];
+    uint64_t offset = 0, sent = 0;
+    size_t outstanding = 0;
+    bool err = false;
+
+    if (!delta_get_sums(fh, rsize,
+                        delta_block_size(lsize > rsize ? lsize : rsize),
+                        &ds)) {
+        strbuf_free(ds.sums);
+        return false;
+    }
+
+    delta_reader_init(dr, file, ds.blocksize);
+    while (true) {
+        while (!err && outstanding < DELTA_MAX_REQUESTS) {
+            unsigned len;
+            const unsigned char *data = delta_reader_get(
+                dr, offset, ds.blocksize, &len);
+            if (!len)
+                break;
+            if (!delta_block_matches(&ds, offset / ds.blocksize, data, len)) {
+                struct sftp_request *req = fxp_write_send(
+                    fh, (void *)data, offset, len);
+                sftp_register(req);
+                outstanding++;
+                sent += len;
+            }
+            offset += len;
+        }
+        if (dr->err && !err) {
+            printf("error while reading local file\n");
+            err = true;
+        }
+        if (outstanding == 0)
+            break;
+
+        struct sftp_request *rreq;
+        struct sftp_packet *pktin = delta_recv(&rreq);
+        outstanding--;
+        if (!fxp_write_recv(pktin, rreq) && !err) {
+            printf("error while writing: %s\n", fxp_error());
+            err = true;
         }
     }
+    delta_reader_free(dr);
+
+    if (!err && lsize < rsize) {
+        struct fxp_attrs attrs;
+        struct sftp_request *req;
+        struct sftp_packet *pktin;
+
+        attrs.flags = SSH_FILEXFER_ATTR_SIZE;
+        attrs.size = lsize;
+        req = fxp_fsetstat_send(fh, attrs);
+        pktin = sftp_wait_for_reply(req);
+        if (!fxp_fsetstat_recv(pktin, req)) {
+            printf("truncate %s: %s\n", outfname, fxp_error());
+            err = true;
+        }
+    }
+
+    if (!err)
+        delta_report("reput", fname, lsize, sent, ds.bytes);
+    strbuf_free(ds.sums);
+    return !err;
+}
+
+/* ----------------------------------------------------------------------
+ * The meat of the `get' and `put' commands.
+ */
+static bool sftp_get_tree(char *fname, char *outfname, bool restart);
+
+/*
+ * Download a single file, whose attributes we already know (or have
+ * failed to find out, in which case attrs->flags is zero).
+ */
+static bool sftp_get_one_file(char *fname, char *outfname, bool restart,
+                              const struct fxp_attrs *attrsp)
+{
+    struct fxp_handle *fh;
+    struct sftp_packet *pktin;
+    struct sftp_request *req;
+    struct fxp_xfer *xfer;
+    uint64_t offset;
+    WFile *file;
+    bool toret, shown_err = false;
+    struct fxp_attrs attrs = *attrsp;
 
-    req = fxp_stat_send(fname);
-    pktin = sftp_wait_for_reply(req);
-    if (!fxp_stat_recv(pktin, req, &attrs))
-        attrs.flags = 0;
 
     req = fxp_open_send(fname, SSH_FXF_READ, NULL);
     pktin = sftp_wait_for_reply(req);
@@ -426,6 +929,25 @@ bool sftp_get_file(char *fname, char *outfname, bool recurse, bool restart)
         return false;
     }
 
+    if (restart && delta_mode) {
+        if (attrs.flags & SSH_FILEXFER_ATTR_SIZE) {
+            with_stripctrl(san, fname) {
+                with_stripctrl(sano, outfname)
+                    printf("remote:%s => local:%s (delta)\n", san, sano);
+            }
+            toret = sftp_get_delta(fname, outfname, fh, attrs.size,
+                                   GET_PERMISSIONS(attrs, -1));
+
+            req = fxp_close_send(fh);
+            pktin = sftp_wait_for_reply(req);
+            fxp_close_recv(pktin, req);
+
+            return toret;
+        }
+        printf("reget: remote file size unknown: downloading all of it\n");
+        restart = false;
+    }
+
     if (restart) {
         file = open_existing_wfile(outfname, NULL);
     } else {
@@ -461,80 +983,282 @@ bool sftp_get_file(char *fname, char *outfname, bool recurse, bool restart)
         offset = 0;
     }
 
-    with_stripctrl(san, fname) {
-        with_stripctrl(sano, outfname)
-            printf("remote:%s => local:%s\n", san, sano);
-    }
+    with_stripctrl(san, fname) {
+        with_stripctrl(sano, outfname)
+            printf("remote:%s => local:%s\n", san, sano);
+    }
+
+    /*
+     * FIXME: we can use FXP_FSTAT here to get the file size, and
+     * thus put up a progress bar.
+     */
+    toret = true;
+    xfer = xfer_download_init(fh, offset);
+    while (!xfer_done(xfer)) {
+        void *vbuf;
+        int retd, len;
+        int wpos, wlen;
+
+        xfer_download_queue(xfer);
+        pktin = sftp_recv_reply();
+        retd = xfer_download_gotpkt(xfer, pktin);
+        if (retd <= 0) {
+            if (!shown_err) {
+                printf("error while reading: %s\n", fxp_error());
+                shown_err = true;
+            }
+            if (retd == INT_MIN)        /* pktin not even freed */
+                sfree(pktin);
+            toret = false;
+        }
+
+        while (xfer_download_data(xfer, &vbuf, &len)) {
+            unsigned char *buf = (unsigned char *)vbuf;
+
+            wpos = 0;
+            while (wpos < len) {
+                wlen = write_to_file(file, buf + wpos, len - wpos);
+                if (wlen <= 0) {
+                    printf("error while writing local file\n");
+                    toret = false;
+                    xfer_set_error(xfer);
+                    break;
+                }
+                wpos += wlen;
+            }
+            if (wpos < len) {          /* we had an error */
+                toret = false;
+                xfer_set_error(xfer);
+            }
+
+            sfree(vbuf);
+        }
+    }
+
+    xfer_cleanup(xfer);
+
+    close_wfile(file);
+
+    req = fxp_close_send(fh);
+    pktin = sftp_wait_for_reply(req);
+    fxp_close_recv(pktin, req);
+
+    return toret;
+}
+
+bool sftp_get_file(char *fname, char *outfname, bool recurse, bool restart)
+{
+    struct sftp_packet *pktin;
+    struct sftp_request *req;
+    struct fxp_attrs attrs;
+    bool result;
+
+    req = fxp_stat_send(fname);
+    pktin = sftp_wait_for_reply(req);
+    result = fxp_stat_recv(pktin, req, &attrs);
+    if (!result)
+        attrs.flags = 0;
+
+    /*
+     * In recursive mode, see if we're dealing with a directory.
+     * (If we're not in recursive mode, we need not even check: the
+     * subsequent FXP_OPEN will return a usable error message.)
+     */
+    if (recurse && result &&
+        (attrs.flags & SSH_FILEXFER_ATTR_PERMISSIONS) &&
+        (attrs.permissions & 0040000))
+        return sftp_get_tree(fname, outfname, restart);
+
+    return sftp_get_one_file(fname, outfname, restart, &attrs);
+}
+
+/*
+ * Recursive download. The directory walker lists the remote tree a
+ * level at a time, with several directories on the go at once, and
+ * we download the files in each directory as soon as its listing is
+ * complete, while the walker carries on with the rest of the tree in
+ * the background.
+ */
+#define GET_TREE_MAX_DIRS 16
+
+struct get_tree_ctx {
+    char *outfname;
+    bool restart;
+};
+
+static void get_tree_ctx_free(void *vctx)
+{
+    struct get_tree_ctx *ctx = (struct get_tree_ctx *)vctx;
+    sfree(ctx->outfname);
+    sfree(ctx);
+}
+
+static void get_tree_add_dir(const char *fname, const char *outfname,
+                             bool restart)
+{
+    struct get_tree_ctx *ctx = snew(struct get_tree_ctx);
+    ctx->outfname = dupstr(outfname);
+    ctx->restart = restart;
+    walk_add_dir(current_walk, fname, ctx);
+    walk_queue(current_walk);
+}
+
+static bool get_tree_is_dir(struct fxp_name *name)
+{
+    return (name->attrs.flags & SSH_FILEXFER_ATTR_PERMISSIONS) &&
+        (name->attrs.permissions & 0040000);
+}
+
+static bool sftp_get_tree_dir(struct fxp_walk_dir *d)
+{
+    struct get_tree_ctx *ctx = (struct get_tree_ctx *)d->ctx;
+    bool restart = ctx->restart, found = false;
+    size_t i, first;
+
+    if (d->error) {
+        with_stripctrl(san, d->path)
+            printf("%s: reading directory: %s\n", san, d->error);
+        return false;
+    }
+
+    /*
+     * If we're in restart mode, find the last file on this list that
+     * already exists. We may have to do a reget on _that_ file, but
+     * shouldn't have to do anything on the previous files, because
+     * we download the files in each directory in order.
+     *
+     * Subdirectories are different: we create them locally as soon
+     * as we see them, and fill them in later, so we must restart
+     * inside every one of them.
+     */
+    first = 0;
+    if (restart && !delta_mode) {
+        for (i = 0; i < d->nnames; i++) {
+            char *nextoutfname;
+            if (get_tree_is_dir(d->names[i]))
+                continue;
+            nextoutfname = dir_file_cat(ctx->outfname, d->names[i]->filename);
+            if (file_type(nextoutfname) != FILE_TYPE_NONEXISTENT) {
+                first = i;
+                found = true;
+            }
+            sfree(nextoutfname);
+        }
+    }
+
+    for (i = 0; i < d->nnames; i++) {
+        struct fxp_name *name = d->names[i];
+        char *nextfname, *nextoutfname;
+        bool retd = true;
+
+        if (i < first && !get_tree_is_dir(name))
+            continue;
+
+        if (!vet_filename(name->filename)) {
+            with_stripctrl(san, name->filename)
+                printf("ignoring potentially dangerous server-"
+                       "supplied filename '%s'\n", san);
+            continue;
+        }
+
+        nextfname = dupcat(d->path, "/", name->filename);
+        nextoutfname = dir_file_cat(ctx->outfname, name->filename);
+        if (get_tree_is_dir(name)) {
+            /*
+             * Create the local directory now, and leave the walker to
+             * list the remote one.
+             */
+            if (file_type(nextoutfname) != FILE_TYPE_DIRECTORY &&
+                !create_directory(nextoutfname)) {
+                with_stripctrl(san, nextoutfname)
+                    printf("%s: Cannot create directory\n", san);
+                retd = false;
+            } else {
+                get_tree_add_dir(nextfname, nextoutfname, restart);
+            }
+        } else {
+            /*
+             * After the first partial file, do full downloads. But
+             * in delta mode, update every file we already have.
+             */
+            bool restart_this = found && i == first;
+            if (restart && delta_mode)
+                restart_this = (file_type(nextoutfname) !=
+                                FILE_TYPE_NONEXISTENT);
+            retd = sftp_get_one_file(nextfname, nextoutfname,
+                                     restart_this, &name->attrs);
+        }
+        sfree(nextoutfname);
+        sfree(nextfname);
+        if (!retd)
+            return false;
+    }
+
+    return true;
+}
+
+static bool sftp_get_tree(char *fname, char *outfname, bool restart)
+{
+    struct fxp_walk_dir *d;
+    bool toret = true;
 
     /*
-     * FIXME: we can use FXP_FSTAT here to get the file size, and
-     * thus put up a progress bar.
+     * First, attempt to create the destination directory, unless it
+     * already exists.
      */
-    toret = true;
-    xfer = xfer_download_init(fh, offset);
-    while (!xfer_done(xfer)) {
-        void *vbuf;
-        int retd, len;
-        int wpos, wlen;
-
-        xfer_download_queue(xfer);
-        pktin = sftp_recv();
-        retd = xfer_download_gotpkt(xfer, pktin);
-        if (retd <= 0) {
-            if (!shown_err) {
-                printf("error while reading: %s\n", fxp_error());
-                shown_err = true;
-            }
-            if (retd == INT_MIN)        /* pktin not even freed */
-                sfree(pktin);
-            toret = false;
-        }
+    if (file_type(outfname) != FILE_TYPE_DIRECTORY &&
+        !create_directory(outfname)) {
+        with_stripctrl(san, outfname)
+            printf("%s: Cannot create directory\n", san);
+        return false;
+    }
 
-        while (xfer_download_data(xfer, &vbuf, &len)) {
-            unsigned char *buf = (unsigned char *)vbuf;
+    assert(!current_walk);
+    current_walk = walk_init(GET_TREE_MAX_DIRS, get_tree_ctx_free);
+    get_tree_add_dir(fname, outfname, restart);
 
-            wpos = 0;
-            while (wpos < len) {
-                wlen = write_to_file(file, buf + wpos, len - wpos);
-                if (wlen <= 0) {
-                    printf("error while writing local file\n");
-                    toret = false;
-                    xfer_set_error(xfer);
-                    break;
-                }
-                wpos += wlen;
+    while (toret && !walk_done(current_walk)) {
+        while ((d = walk_next_dir(current_walk)) == NULL) {
+            struct sftp_packet *pktin = sftp_recv();
+            if (!pktin) {
+                seat_connection_fatal(
+                    psftp_seat,
+                    "did not receive SFTP response packet from server");
             }
-            if (wpos < len) {          /* we had an error */
-                toret = false;
-                xfer_set_error(xfer);
+            if (walk_gotpkt(current_walk, pktin) == INT_MIN) {
+                seat_connection_fatal(
+                    psftp_seat,
+                    "unable to understand SFTP response packet from server");
             }
-
-            sfree(vbuf);
         }
-    }
-
-    xfer_cleanup(xfer);
-
-    close_wfile(file);
 
-    req = fxp_close_send(fh);
-    pktin = sftp_wait_for_reply(req);
-    fxp_close_recv(pktin, req);
+        toret = sftp_get_tree_dir(d);
+        get_tree_ctx_free(d->ctx);
+        walk_free_dir(d);
+    }
 
+    if (!walk_cleanup(current_walk)) {
+        seat_connection_fatal(
+            psftp_seat,
+            "unable to understand SFTP response packet from server");
+    }
+    current_walk = NULL;
     return toret;
 }
 
+
 bool sftp_put_file(char *fname, char *outfname, bool recurse, bool restart)
 {
     struct fxp_handle *fh;
     struct fxp_xfer *xfer;
     struct sftp_packet *pktin;
     struct sftp_request *req;
-    uint64_t offset;
+    uint64_t offset, nreads, nbytes, size;
     RFile *file;
     bool err = false, eof;
     struct fxp_attrs attrs;
     long permissions;
+    char *buffer;
 
     /*
      * In recursive mode, see if we're dealing with a directory.
@@ -605,7 +1329,7 @@ bool sftp_put_file(char *fname, char *outfname, bool recurse, bool restart)
          * If none of them exists, of course, we start at 0.
          */
         i = 0;
-        if (restart) {
+        if (restart && !delta_mode) {
             while (i < nnames) {
                 char *nextoutfname;
                 nextoutfname = dupcat(outfname, "/", ournames[i]);
@@ -633,8 +1357,20 @@ bool sftp_put_file(char *fname, char *outfname, bool recurse, bool restart)
 
             nextfname = dir_file_cat(fname, ournames[i]);
             nextoutfname = dupcat(outfname, "/", ournames[i]);
-            retd = sftp_put_file(nextfname, nextoutfname, recurse, restart);
-            restart = false;           /* after first partial file, do full */
+            if (restart && delta_mode) {
+                /* Update every file that's already there */
+                bool exists = true;
+                if (file_type(nextfname) != FILE_TYPE_DIRECTORY) {
+                    req = fxp_stat_send(nextoutfname);
+                    pktin = sftp_wait_for_reply(req);
+                    exists = fxp_stat_recv(pktin, req, &attrs);
+                }
+                retd = sftp_put_file(nextfname, nextoutfname, recurse, exists);
+            } else {
+                retd = sftp_put_file(nextfname, nextoutfname, recurse,
+                                     restart);
+                restart = false;       /* after first partial file, do full */
+            }
             sfree(nextoutfname);
             sfree(nextfname);
             if (!retd) {
@@ -657,7 +1393,7 @@ bool sftp_put_file(char *fname, char *outfname, bool recurse, bool restart)
         return true;
     }
 
-    file = open_existing_file(fname, NULL, NULL, NULL, &permissions);
+    file = open_existing_file(fname, &size, NULL, NULL, &permissions);
     if (!file) {
         printf("local: unable to open %s\n", fname);
         return false;
@@ -665,7 +1401,9 @@ bool sftp_put_file(char *fname, char *outfname, bool recurse, bool restart)
     attrs.flags = 0;
     PUT_PERMISSIONS(attrs, permissions);
     if (restart) {
-        req = fxp_open_send(outfname, SSH_FXF_WRITE, &attrs);
+        /* A delta upload needs the server to read the file too */
+        req = fxp_open_send(outfname, SSH_FXF_WRITE |
+                            (delta_mode ? SSH_FXF_READ : 0), &attrs);
     } else {
         req = fxp_open_send(outfname,
                             SSH_FXF_WRITE | SSH_FXF_CREAT | SSH_FXF_TRUNC,
@@ -699,6 +1437,13 @@ bool sftp_put_file(char *fname, char *outfname, bool recurse, bool restart)
             goto cleanup;
         }
         offset = attrs.size;
+
+        if (delta_mode) {
+            printf("local:%s => remote:%s (delta)\n", fname, outfname);
+            err = !sftp_put_delta(fname, outfname, file, size, fh, offset);
+            goto cleanup;
+        }
+
         printf("reput: restarting at file position %"PRIu64"\n", offset);
 
         if (seek_file((WFile *)file, offset, FROM_START) != 0)
@@ -715,19 +1460,22 @@ bool sftp_put_file(char *fname, char *outfname, bool recurse, bool restart)
      */
     xfer = xfer_upload_init(fh, offset);
     eof = false;
+    buffer = snewn(UPLOAD_BLOCK_SIZE, char);
+    nreads = nbytes = 0;
     while ((!err && !eof) || !xfer_done(xfer)) {
-        char buffer[4096];
         int len, ret;
 
         while (xfer_upload_ready(xfer) && !err && !eof) {
-            len = read_from_file(file, buffer, sizeof(buffer));
-            if (len == -1) {
+            len = read_block_from_file(file, buffer, UPLOAD_BLOCK_SIZE,
+                                       &nreads);
+            if (len < 0) {
                 printf("error while reading local file\n");
                 err = true;
             } else if (len == 0) {
                 eof = true;
             } else {
                 xfer_upload_data(xfer, buffer, len);
+                nbytes += len;
             }
         }
 
@@ -752,10 +1500,29 @@ bool sftp_put_file(char *fname, char *outfname, bool recurse, bool restart)
                     err = true;
                 }
             }
+        } else if (!err && !eof) {
+            /* No replies to wait for, but xfer_upload_ready still
+             * says no, e.g. because a key exchange is holding up
+             * outgoing data. Wait for the network to move instead
+             * of spinning. */
+            if (backend_exitcode(backend) >= 0 ||
+                ssh_sftp_loop_iteration() < 0) {
+                printf("error while writing: connection lost\n");
+                err = true;
+            }
         }
     }
 
+    if (verbose && nbytes > 0) {
+        double gb = nbytes / 1073741824.0;
+        printf("%s: %"PRIu64" bytes in %"PRIu64" reads and %"PRIu64
+               " write requests (%.0f and %.0f per GB)\n", fname, nbytes,
+               nreads, xfer_requests(xfer), nreads / gb,
+               xfer_requests(xfer) / gb);
+    }
+
     xfer_cleanup(xfer);
+    sfree(buffer);
 
   cleanup:
     req = fxp_close_send(fh);
@@ -1217,7 +1984,7 @@ int sftp_general_get(struct sftp_command *cmd, bool restart, bool multiple)
 {
     char *fname, *unwcfname, *origfname, *origwfname, *outfname;
     int i, toret;
-    bool recurse = false;
+    bool recurse = false, delta = false;
 
     if (!backend) {
         not_connected();
@@ -1232,6 +1999,8 @@ int sftp_general_get(struct sftp_command *cmd, bool restart, bool multiple)
             break;
         } else if (!strcmp(cmd->words[i], "-r")) {
             recurse = true;
+        } else if (restart && !strcmp(cmd->words[i], "-d")) {
+            delta = true;
         } else {
             printf("%s: unrecognised option '%s'\n", cmd->words[0], cmd->words[i]);
             return 0;
@@ -1278,7 +2047,9 @@ int sftp_general_get(struct sftp_command *cmd, bool restart, bool multiple)
             else
                 outfname = stripslashes(origwfname, false);
 
+            delta_mode = delta;
             toret = sftp_get_file(fname, outfname, recurse, restart);
+            delta_mode = false;
 
             sfree(fname);
 
@@ -1326,7 +2097,7 @@ int sftp_general_put(struct sftp_command *cmd, bool restart, bool multiple)
     char *fname, *wfname, *origoutfname, *outfname;
     int i;
     int toret;
-    bool recurse = false;
+    bool recurse = false, delta = false;
 
     if (!backend) {
         not_connected();
@@ -1341,6 +2112,8 @@ int sftp_general_put(struct sftp_command *cmd, bool restart, bool multiple)
             break;
         } else if (!strcmp(cmd->words[i], "-r")) {
             recurse = true;
+        } else if (restart && !strcmp(cmd->words[i], "-d")) {
+            delta = true;
         } else {
             printf("%s: unrecognised option '%s'\n", cmd->words[0], cmd->words[i]);
             return 0;
@@ -1379,7 +2152,9 @@ int sftp_general_put(struct sftp_command *cmd, bool restart, bool multiple)
                 origoutfname = stripslashes(wfname, true);
 
             outfname = canonify(origoutfname);
+            delta_mode = delta;
             toret = sftp_put_file(wfname, outfname, recurse, restart);
+            delta_mode = false;
             sfree(outfname);
 
             if (wcm) {
@@ -1644,6 +2419,348 @@ int sftp_cmd_mv(struct sftp_command *cmd)
     return ret;
 }
 
+/*
+ * Copy files on the server, with the copy-data extension, so that
+ * the data never has to come to us and go back again.
+ */
+struct sftp_context_cp {
+    char *dstfname;
+    bool dest_is_dir;
+};
+
+static void sftp_close_handle(struct fxp_handle *fh)
+{
+    struct sftp_packet *pktin;
+    struct sftp_request *req;
+
+    req = fxp_close_send(fh);
+    pktin = sftp_wait_for_reply(req);
+    fxp_close_recv(pktin, req);
+}
+
+static bool sftp_action_cp(void *vctx, char *srcfname)
+{
+    struct sftp_context_cp *ctx = (struct sftp_context_cp *)vctx;
+    struct sftp_packet *pktin;
+    struct sftp_request *req;
+    struct fxp_handle *src, *dst;
+    struct fxp_attrs attrs, dstattrs;
+    char *finalfname, *newcanon = NULL;
+    bool result;
+
+    if (ctx->dest_is_dir) {
+        char *p;
+        char *newname;
+
+        p = srcfname + strlen(srcfname);
+        while (p > srcfname && p[-1] != '/') p--;
+        newname = dupcat(ctx->dstfname, "/", p);
+        newcanon = canonify(newname);
+        sfree(newname);
+
+        finalfname = newcanon;
+    } else {
+        finalfname = ctx->dstfname;
+    }
+
+    if (!strcmp(srcfname, finalfname)) {
+        /* Opening the destination would truncate the source */
+        printf("cp %s: source and destination are the same file\n",
+               srcfname);
+        sfree(newcanon);
+        return false;
+    }
+
+    req = fxp_stat_send(srcfname);
+    pktin = sftp_wait_for_reply(req);
+    if (!fxp_stat_recv(pktin, req, &attrs)) {
+        printf("cp %s: %s\n", srcfname, fxp_error());
+        sfree(newcanon);
+        return false;
+    }
+    if (GET_PERMISSIONS(attrs, 0) & PERMS_DIRECTORY) {
+        printf("cp %s: is a directory\n", srcfname);
+        sfree(newcanon);
+        return false;
+    }
+
+    req = fxp_open_send(srcfname, SSH_FXF_READ, NULL);
+    pktin = sftp_wait_for_reply(req);
+    src = fxp_open_recv(pktin, req);
+    if (!src) {
+        printf("%s: open for read: %s\n", srcfname, fxp_error());
+        sfree(newcanon);
+        return false;
+    }
+
+    dstattrs.flags = 0;
+    PUT_PERMISSIONS(dstattrs, (long)GET_PERMISSIONS(attrs, -1));
+    req = fxp_open_send(finalfname,
+                        SSH_FXF_WRITE | SSH_FXF_CREAT | SSH_FXF_TRUNC,
+                        &dstattrs);
+    pktin = sftp_wait_for_reply(req);
+    dst = fxp_open_recv(pktin, req);
+    if (!dst) {
+        with_stripctrl(san, finalfname)
+            printf("%s: open for write: %s\n", san, fxp_error());
+        sftp_close_handle(src);
+        sfree(newcanon);
+        return false;
+    }
+
+    req = fxp_copy_data_send(src, 0, 0, dst, 0);
+    pktin = sftp_wait_for_reply(req);
+    result = fxp_copy_data_recv(pktin, req);
+
+    if (!result) {
+        with_stripctrl(san, finalfname)
+            printf("cp %s %s: %s\n", srcfname, san, fxp_error());
+    } else {
+        with_stripctrl(san, finalfname)
+            printf("%s -> %s\n", srcfname, san);
+    }
+
+    sftp_close_handle(dst);
+    sftp_close_handle(src);
+    sfree(newcanon);
+    return result;
+}
+
+int sftp_cmd_cp(struct sftp_command *cmd)
+{
+    struct sftp_context_cp ctx[1];
+    int i, ret;
+
+    if (!backend) {
+        not_connected();
+        return 0;
+    }
+
+    if (cmd->nwords < 3) {
+        printf("cp: expects two filenames\n");
+        return 0;
+    }
+
+    if (!fxp_extension(SFTP_EXT_COPY_DATA)) {
+        printf("cp: server does not support copying files\n");
+        return 0;
+    }
+
+    ctx->dstfname = canonify(cmd->words[cmd->nwords-1]);
+
+    /* As with mv, several sources need a directory to go in */
+    ctx->dest_is_dir = check_is_dir(ctx->dstfname);
+    if ((cmd->nwords > 3 || is_wildcard(cmd->words[1])) && !ctx->dest_is_dir) {
+        printf("cp: multiple or wildcard arguments require the destination"
+               " to be a directory\n");
+        sfree(ctx->dstfname);
+        return 0;
+    }
+
+    ret = 1;
+    for (i = 1; i < cmd->nwords-1; i++)
+        ret &= wildcard_iterate(cmd->words[i], sftp_action_cp, ctx);
+
+    sfree(ctx->dstfname);
+    return ret;
+}
+
+/*
+ * Check that a local file is the same as a remote one. The server
+ * hashes the remote file in large blocks, with check-file-name, and
+ * we hash each block of the local file as its hashes come back, so
+ * that we can say where the first difference is.
+ */
+#define VERIFY_BLOCK_SIZE UPLOAD_BLOCK_SIZE
+#define VERIFY_BLOCKS_PER_REQUEST 64
+#define VERIFY_MAX_REQUESTS 4
+
+struct verify_req {
+    uint64_t offset;
+    size_t nblocks;
+    bool done;
+    strbuf *out;
+};
+
+static bool sftp_verify_file(char *fname, char *outfname)
+{
+    struct sftp_packet *pktin;
+    struct sftp_request *req, *rreq;
+    struct fxp_attrs attrs;
+    struct verify_req *reqs;
+    const ssh_hashalg *alg = NULL;
+    char *algname = NULL;
+    unsigned char hash[MAX_HASH_LEN];
+    uint64_t size, length, nblocks, nreads = 0;
+    uint64_t diff = UINT64_MAX;        /* offset of first differing block */
+    size_t nreqs, sent = 0, compared = 0, outstanding = 0;
+    bool err = false;
+    RFile *file;
+    char *buf;
+
+    file = open_existing_file(fname, &size, NULL, NULL, NULL);
+    if (!file) {
+        printf("local: unable to open %s\n", fname);
+        return false;
+    }
+
+    req = fxp_stat_send(outfname);
+    pktin = sftp_wait_for_reply(req);
+    if (!fxp_stat_recv(pktin, req, &attrs)) {
+        printf("%s: %s\n", outfname, fxp_error());
+        close_rfile(file);
+        return false;
+    }
+    if (!(attrs.flags & SSH_FILEXFER_ATTR_SIZE)) {
+        printf("read size of %s: size was not given\n", outfname);
+        close_rfile(file);
+        return false;
+    }
+
+    /* Compare as much as both files have, even if their sizes differ */
+    length = size < attrs.size ? size : attrs.size;
+    nblocks = (length + VERIFY_BLOCK_SIZE - 1) / VERIFY_BLOCK_SIZE;
+    nreqs = (nblocks + VERIFY_BLOCKS_PER_REQUEST - 1) /
+        VERIFY_BLOCKS_PER_REQUEST;
+    reqs = snewn(nreqs, struct verify_req);
+    buf = snewn(VERIFY_BLOCK_SIZE, char);
+
+    while (outstanding > 0 ||
+           (!err && diff == UINT64_MAX && compared < nreqs)) {
+        while (!err && diff == UINT64_MAX && sent < nreqs &&
+               outstanding < VERIFY_MAX_REQUESTS) {
+            struct verify_req *vr = &reqs[sent++];
+            uint64_t first = (uint64_t)(sent - 1) * VERIFY_BLOCKS_PER_REQUEST;
+            uint64_t len;
+
+            vr->offset = first * VERIFY_BLOCK_SIZE;
+            vr->nblocks = nblocks - first;
+            if (vr->nblocks > VERIFY_BLOCKS_PER_REQUEST)
+                vr->nblocks = VERIFY_BLOCKS_PER_REQUEST;
+            vr->done = false;
+            vr->out = strbuf_new();
+            len = (uint64_t)vr->nblocks * VERIFY_BLOCK_SIZE;
+            if (len > length - vr->offset)
+                len = length - vr->offset;
+            req = fxp_check_file_name_send(outfname, SFTP_CHECK_FILE_ALGS,
+                                           vr->offset, len,
+                                           VERIFY_BLOCK_SIZE);
+            sftp_register(req);
+            fxp_set_userdata(req, vr);
+            outstanding++;
+        }
+        if (!outstanding)
+            break;
+
+        pktin = delta_recv(&rreq);
+        struct verify_req *vr = fxp_get_userdata(rreq);
+        char *thisalg = NULL;
+        bool ok = fxp_check_file_recv(pktin, rreq, &thisalg, vr->out);
+        outstanding--;
+        vr->done = true;
+
+        if (ok && !algname) {
+            algname = thisalg;
+            alg = sftp_check_file_hashalg(ptrlen_from_asciz(algname));
+        } else {
+            if (ok && strcmp(algname, thisalg))
+                alg = NULL;
+            sfree(thisalg);
+        }
+        if (!ok) {
+            if (!err)
+                printf("hashing remote file: %s\n", fxp_error());
+            err = true;
+        } else if (!alg) {
+            if (!err)
+                printf("hashing remote file: unexpected algorithm '%s'\n",
+                       algname);
+            err = true;
+        } else if (vr->out->len != vr->nblocks * alg->hlen) {
+            if (!err)
+                printf("hashing remote file: wrong number of hashes\n");
+            err = true;
+        }
+
+        /* Compare every block we now have the remote hashes of, in order */
+        while (!err && diff == UINT64_MAX &&
+               compared < sent && reqs[compared].done) {
+            struct verify_req *cr = &reqs[compared++];
+            for (size_t j = 0; j < cr->nblocks; j++) {
+                uint64_t offset = cr->offset + (uint64_t)j * VERIFY_BLOCK_SIZE;
+                int want = length - offset < VERIFY_BLOCK_SIZE ?
+                    length - offset : VERIFY_BLOCK_SIZE;
+                int got = read_block_from_file(file, buf, want, &nreads);
+                if (got != want) {
+                    printf("local: error reading %s\n", fname);
+                    err = true;
+                    break;
+                }
+                hash_simple(alg, make_ptrlen(buf, got), hash);
+                if (memcmp(hash, cr->out->u + j * alg->hlen, alg->hlen)) {
+                    diff = offset;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!err) {
+        if (diff != UINT64_MAX) {
+            printf("local:%s and remote:%s differ in bytes %"PRIu64
+                   " to %"PRIu64"\n", fname, outfname, diff,
+                   diff + (length - diff < VERIFY_BLOCK_SIZE ?
+                           length - diff : VERIFY_BLOCK_SIZE) - 1);
+        } else if (size != attrs.size) {
+            printf("local:%s (%"PRIu64" bytes) and remote:%s (%"PRIu64
+                   " bytes) differ in size\n", fname, size, outfname,
+                   attrs.size);
+        } else {
+            printf("local:%s and remote:%s match (%s)\n", fname, outfname,
+                   algname ? algname : "empty");
+        }
+    }
+
+    for (size_t i = 0; i < sent; i++)
+        strbuf_free(reqs[i].out);
+    sfree(reqs);
+    sfree(buf);
+    sfree(algname);
+    close_rfile(file);
+    return !err && diff == UINT64_MAX && size == attrs.size;
+}
+
+int sftp_cmd_verify(struct sftp_command *cmd)
+{
+    char *fname, *outfname;
+    int i = 1, toret;
+
+    if (!backend) {
+        not_connected();
+        return 0;
+    }
+
+    if (i < cmd->nwords && !strcmp(cmd->words[i], "--"))
+        i++;
+
+    if (i >= cmd->nwords) {
+        printf("verify: expects a filename\n");
+        return 0;
+    }
+
+    if (!fxp_extension(SFTP_EXT_CHECK_FILE)) {
+        printf("verify: server cannot hash files\n");
+        return 0;
+    }
+
+    fname = cmd->words[i++];
+    outfname = canonify(i < cmd->nwords ? cmd->words[i] :
+                        stripslashes(fname, true));
+    toret = sftp_verify_file(fname, outfname);
+    sfree(outfname);
+    return toret;
+}
+
 struct sftp_context_chmod {
     unsigned attrs_clr, attrs_xor;
 };
@@ -1973,6 +3090,17 @@ static struct sftp_cmd_lookup {
             "  session, to the same server or to a different one.\n",
             sftp_cmd_close
     },
+    {
+        "cp", true, "copy file(s) on the remote server",
+            " <source> [ <source>... ] <destination>\n"
+            "  Copies <source>(s) on the server to <destination>, also on\n"
+            "  the server, without the data passing through PSFTP.\n"
+            "  If <destination> specifies an existing directory, then <source>\n"
+            "  may be a wildcard, and multiple <source>s may be given; all\n"
+            "  source files are copied into <destination>.\n"
+            "  The server must support the \"copy-data\" extension.\n",
+            sftp_cmd_cp
+    },
     {
         "del", true, "delete files on the remote server",
             " <filename-or-wildcard> [ <filename-or-wildcard>... ]\n"
@@ -2094,11 +3222,13 @@ static struct sftp_cmd_lookup {
     },
     {
         "reget", true, "continue downloading files",
-            " [ -r ] [ -- ] <filename> [ <local-filename> ]\n"
+            " [ -r ] [ -d ] [ -- ] <filename> [ <local-filename> ]\n"
             "  Works exactly like the \"get\" command, but the local file\n"
             "  must already exist. The download will begin at the end of the\n"
             "  file. This is for resuming a download that was interrupted.\n"
-            "  If -r specified, resume interrupted \"get -r\".\n",
+            "  If -r specified, resume interrupted \"get -r\".\n"
+            "  If -d specified, instead bring an old local copy of the file\n"
+            "  up to date, downloading only the parts that have changed.\n",
             sftp_cmd_reget
     },
     {
@@ -2111,11 +3241,13 @@ static struct sftp_cmd_lookup {
     },
     {
         "reput", true, "continue uploading files",
-            " [ -r ] [ -- ] <filename> [ <remote-filename> ]\n"
+            " [ -r ] [ -d ] [ -- ] <filename> [ <remote-filename> ]\n"
             "  Works exactly like the \"put\" command, but the remote file\n"
             "  must already exist. The upload will begin at the end of the\n"
             "  file. This is for resuming an upload that was interrupted.\n"
-            "  If -r specified, resume interrupted \"put -r\".\n",
+            "  If -r specified, resume interrupted \"put -r\".\n"
+            "  If -d specified, instead bring an old remote copy of the file\n"
+            "  up to date, uploading only the parts that have changed.\n",
             sftp_cmd_reput
     },
     {
@@ -2129,6 +3261,17 @@ static struct sftp_cmd_lookup {
             "  The directory will not be removed unless it is empty.\n"
             "  Wildcards may be used to specify multiple directories.\n",
             sftp_cmd_rmdir
+    },
+    {
+        "verify", true, "check a local file against a remote one",
+            " [ -- ] <filename> [ <remote-filename> ]\n"
+            "  Checks that a local file has the same contents as the file\n"
+            "  on the server with the same name, or with a different one\n"
+            "  if you supply the argument <remote-filename>. The server\n"
+            "  hashes its copy, so the file is not downloaded; if the files\n"
+            "  differ, the first range of bytes that does is reported.\n"
+            "  The server must support the \"check-file\" extension.\n",
+            sftp_cmd_verify
     }
 };
 
@@ -2450,8 +3593,6 @@ int do_sftp(int mode, int modeflags, char *batchfile)
  * Dirty bits: integration with PuTTY.
  */
 
-static bool verbose = false;
-
 void ldisc_echoedit_update(Ldisc *ldisc) { }
 void ldisc_check_sendok(Ldisc *ldisc) { }
 
@@ -2546,6 +3687,10 @@ static void usage(void)
     printf("            force use of particular SSH protocol variant\n");
     printf("  -4 -6     force use of IPv4 or IPv6\n");
     printf("  -C        enable compression\n");
+    printf("  -compress-thread\n");
+    printf("            compress on a separate thread (SSH-2 only)\n");
+    printf("  -cipher-threads n\n");
+    printf("            encrypt on up to n worker threads (SSH-2 only)\n");
     printf("  -i key    private key file for user authentication\n");
     printf("  -noagent  disable use of Pageant\n");
     printf("  -agent    enable use of Pageant\n");
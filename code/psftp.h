@@ -97,6 +97,16 @@ RFile *open_existing_file(const char *name, uint64_t *size,
 WFile *open_existing_wfile(const char *name, uint64_t *size);
 /* Returns <0 on error, 0 on eof, or number of bytes read, as usual */
 int read_from_file(RFile *f, void *buffer, int length);
+/*
+ * Uploads read the local file UPLOAD_BLOCK_SIZE bytes at a time, with
+ * read_block_from_file, which keeps calling read_from_file until it
+ * has filled the buffer or reached EOF. It returns the number of
+ * bytes read, or <0 on error, and adds the number of read_from_file
+ * calls it made to *nreads.
+ */
+#define UPLOAD_BLOCK_SIZE (1024 * 1024)
+int read_block_from_file(RFile *f, void *buffer, int length,
+                         uint64_t *nreads);
 /* Closes and frees the RFile */
 void close_rfile(RFile *f);
 WFile *open_new_file(const char *name, long perms);
@@ -202,12 +212,6 @@ char *stripslashes(const char *str, bool local);
  * In psftpcommon.c
  */
 
-/*
- * qsort comparison routine for fxp_name structures. Sorts by real
- * file name.
- */
-int sftp_name_compare(const void *av, const void *bv);
-
 /*
  * Shared code for outputting a directory listing in response to a
  * stream of name structures from FXP_READDIR operations. Used by
@@ -13,17 +13,6 @@
 
 #define MAX_NAMES_MEMORY ((size_t)8 << 20)
 
-/*
- * qsort comparison routine for fxp_name structures. Sorts by real
- * file name.
- */
-int sftp_name_compare(const void *av, const void *bv)
-{
-    const struct fxp_name *const *a = (const struct fxp_name *const *) av;
-    const struct fxp_name *const *b = (const struct fxp_name *const *) bv;
-    return strcmp((*a)->filename, (*b)->filename);
-}
-
 struct list_directory_from_sftp_ctx {
     size_t nnames, namesize, total_memory;
     struct fxp_name **names;
@@ -100,3 +89,24 @@ void list_directory_from_sftp_finish(struct list_directory_from_sftp_ctx *ctx)
             list_directory_from_sftp_print(ctx->names[i]);
     }
 }
+
+/*
+ * Read a block of a local file to upload, coping with short reads.
+ */
+int read_block_from_file(RFile *f, void *buffer, int length,
+                         uint64_t *nreads)
+{
+    char *p = (char *)buffer;
+    int done = 0;
+
+    while (done < length) {
+        int ret = read_from_file(f, p + done, length - done);
+        (*nreads)++;
+        if (ret < 0)
+            return ret;
+        if (ret == 0)
+            break;
+        done += ret;
+    }
+    return done;
+}
@@ -50,6 +50,7 @@ struct psocks_state {
     unsigned log_flags;
     RecordDestination rec_dest;
     char *rec_cmd;
+    bool splice;
     strbuf *subcmd;
 
     ConnectionLayer cl;
@@ -63,6 +64,7 @@ struct psocks_connection {
     SockAddr *addr;
     Socket *socket;
     bool connecting, eof_pfmgr_to_socket, eof_socket_to_pfmgr;
+    bool spliced;
     uint64_t index;
     PsocksDataSink *rec_sink;
 
@@ -247,6 +249,46 @@ static void psocks_conn_free(psocks_connection *conn)
     sfree(conn);
 }
 
+static void psocks_splice_done(void *vctx, const char *err)
+{
+    psocks_connection *conn = (psocks_connection *)vctx;
+
+    if (err && (conn->ps->log_flags & LOG_CONNSTATUS))
+        psocks_conn_log(conn, "splice relay failed: %s", err);
+
+    conn->eof_pfmgr_to_socket = conn->eof_socket_to_pfmgr = true;
+    psocks_conn_free(conn);
+}
+
+/*
+ * If we've been asked to, and the connection is in a fit state,
+ * hand both its sockets over to the platform's zero-copy relay, after
+ * which neither the portfwd Channel nor our own Plug will see any
+ * more data. We never do this if the data is being logged or
+ * recorded, because then we have to see it.
+ */
+static void psocks_try_splice(void *vctx)
+{
+    psocks_connection *conn = (psocks_connection *)vctx;
+    psocks_state *ps = conn->ps;
+
+    if (!ps->splice || conn->spliced || conn->connecting || !conn->socket ||
+        conn->eof_pfmgr_to_socket || conn->eof_socket_to_pfmgr ||
+        conn->rec_sink || (ps->log_flags & LOG_DIALOGUE))
+        return;
+
+    Socket *local = portfwd_raw_socket(conn->chan);
+    if (!local)
+        return;
+
+    if (ps->platform->splice_relay(local, conn->socket,
+                                   psocks_splice_done, conn)) {
+        conn->spliced = true;
+        if (ps->log_flags & LOG_CONNSTATUS)
+            psocks_conn_log(conn, "relaying with splice");
+    }
+}
+
 static void psocks_connection_establish(void *vctx)
 {
     psocks_connection *conn = (psocks_connection *)vctx;
@@ -346,6 +388,8 @@ static void psocks_plug_log(Plug *plug, PlugLogType type, SockAddr *addr,
         if (conn->connecting) {
             chan_open_confirmation(conn->chan);
             conn->connecting = false;
+            if (conn->ps->splice)
+                queue_toplevel_callback(psocks_try_splice, conn);
         }
         break;
       case PLUGLOG_PROXY_MSG:
@@ -390,6 +434,11 @@ static void psocks_plug_sent(Plug *plug, size_t bufsize)
 {
     psocks_connection *conn = container_of(plug, psocks_connection, plug);
     sk_set_frozen(conn->socket, bufsize > BUFLIMIT);
+
+    /* If we couldn't splice before because of buffered outgoing
+     * data, we might be able to now. */
+    if (bufsize == 0 && conn->ps->splice && !conn->spliced)
+        queue_toplevel_callback(psocks_try_splice, conn);
 }
 
 psocks_state *psocks_new(const PsocksPlatform *platform)
@@ -438,6 +487,13 @@ void psocks_cmdline(psocks_state *ps, int argc, char **argv)
 		ps->log_flags |= LOG_DIALOGUE;
             } else if (!strcmp(p, "-f")) {
 		ps->rec_dest = REC_FILE;
+            } else if (!strcmp(p, "--splice")) {
+                if (!ps->platform->splice_relay) {
+		    fprintf(stderr, "psocks: '--splice' is not supported on "
+                            "this platform\n");
+		    exit(1);
+                }
+		ps->splice = true;
             } else if (!strcmp(p, "-p")) {
                 if (!ps->platform->open_pipes) {
 		    fprintf(stderr, "psocks: '-p' is not supported on this "
@@ -465,7 +521,10 @@ void psocks_cmdline(psocks_state *ps, int argc, char **argv)
                 printf("usage: psocks [ -d ] [ -f");
                 if (ps->platform->open_pipes)
                     printf(" | -p pipe-cmd");
-                printf(" ] [ -g ] port-number");
+                printf(" ] [ -g ]");
+                if (ps->platform->splice_relay)
+                    printf(" [ --splice ]");
+                printf(" port-number");
                 printf("\n");
                 printf("where: -d           log all connection contents to"
                        " standard output\n");
@@ -476,6 +535,11 @@ void psocks_cmdline(psocks_state *ps, int argc, char **argv)
                            " to 'pipe-cmd [in|out] N'\n");
                 printf("       -g           accept connections from anywhere,"
                        " not just localhost\n");
+                if (ps->platform->splice_relay)
+                    printf("       --splice     relay connection data directly"
+                           " in the kernel\n"
+                           "                    (ignored for connections"
+                           " being logged or recorded)\n");
                 if (ps->platform->start_subcommand)
                     printf("       --exec subcmd [args...]   run command, and "
                            "terminate when it exits\n");
@@ -15,11 +15,28 @@ static inline void pds_free(PsocksDataSink *pds)
 
 PsocksDataSink *pds_stdio(FILE *fp[2]);
 
+/*
+ * Callback from a platform splice relay when the relayed connection
+ * has finished, either by EOF in both directions or with an error
+ * (in which case 'err' is non-NULL). By then the relay has closed
+ * both file descriptors.
+ */
+typedef void (*psocks_splice_done_fn_t)(void *ctx, const char *err);
+
 struct PsocksPlatform {
     PsocksDataSink *(*open_pipes)(
         const char *cmd, const char *const *direction_args,
         const char *index_arg, char **err);
     void (*start_subcommand)(strbuf *args);
+    /*
+     * Take over two connected sockets and relay data between them
+     * directly, bypassing the Socket and Channel layers. Returns
+     * false (leaving the sockets untouched) if that isn't possible
+     * right now. The Sockets themselves must still be closed by the
+     * caller, after 'done' has been called.
+     */
+    bool (*splice_relay)(Socket *s1, Socket *s2,
+                         psocks_splice_done_fn_t done, void *ctx);
 };
 
 psocks_state *psocks_new(const PsocksPlatform *);
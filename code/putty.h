@@ -321,6 +321,7 @@ typedef enum {
      */
     SS_REKEY,  /* trigger an immediate repeat key exchange */
     SS_XCERT,  /* cross-certify another host key ('arg' indicates which) */
+    SS_STATS,  /* write performance counters to the Event Log as JSON */
 
     /*
      * Send a POSIX-style signal. (Useful in SSH and also pterm.)
@@ -1821,6 +1822,8 @@ NORETURN void cleanup_exit(int);
     X(STR, NONE, remote_cmd2) /* fallback if remote_cmd fails; never loaded or saved */ \
     X(BOOL, NONE, nopty) \
     X(BOOL, NONE, compression) \
+    X(BOOL, NONE, compress_in_thread) \
+    X(INT, NONE, cipher_threads) /* 0 = encrypt in the main thread */ \
     X(INT, INT, ssh_kexlist) \
     X(INT, INT, ssh_hklist) \
     X(BOOL, NONE, ssh_prefer_known_hostkeys) \
@@ -1928,6 +1931,7 @@ NORETURN void cleanup_exit(int);
     X(STR, NONE, wintitle) /* initial window title */ \
     /* Terminal options */ \
     X(INT, NONE, savelines) \
+    X(INT, NONE, savelines_in_memory) /* 0 = keep all scrollback in memory */ \
     X(BOOL, NONE, dec_om) \
     X(BOOL, NONE, wrap_mode) \
     X(BOOL, NONE, lfhascr) \
@@ -2206,6 +2210,25 @@ void term_lost_clipboard_ownership(Terminal *, int clipboard);
 void term_update(Terminal *);
 void term_invalidate(Terminal *);
 void term_blink(Terminal *, bool set_cursor);
+/* Counters of the work done by repainting the window. Of the rows of
+ * the window considered by each paint, a row is 'examined' if it
+ * might have changed, so that the terminal had to compare it with
+ * what was last drawn there; and 'redrawn' if anything on it was then
+ * actually drawn.
+ *
+ * Of the lines that needed bidi processing, 'bidi_skipped' counts
+ * those found to contain nothing the bidi algorithm or Arabic shaping
+ * could change; 'bidi_row_hits' those that matched what was last
+ * processed on the same row; 'bidi_lru_hits' those found in the cache
+ * of recently seen lines; and 'bidi_runs' those the algorithm actually
+ * had to be run on.
+ *
+ * 'fuzzterm -stats' reports these for whatever it's fed. */
+typedef struct TermPaintStats {
+    unsigned long paints, lines_considered, lines_examined, lines_redrawn;
+    unsigned long bidi_skipped, bidi_row_hits, bidi_lru_hits, bidi_runs;
+} TermPaintStats;
+void term_get_paint_stats(Terminal *, TermPaintStats *);
 void term_do_paste(Terminal *, const wchar_t *, int);
 void term_nopaste(Terminal *);
 void term_copyall(Terminal *, const int *, int);
@@ -2752,6 +2775,25 @@ char *get_random_data(int bytes, const char *device); /* used in cmdgen.c */
 char filename_char_sanitise(char c);   /* rewrite special pathname chars */
 bool open_for_write_would_lose_data(const Filename *fn);
 
+/*
+ * A SpillFile is an anonymous temporary file, used by the terminal
+ * to keep old scrollback lines out of memory. It goes away when it's
+ * freed, or when the process exits.
+ *
+ * The file is divided into segments of the size given to
+ * spillfile_new, which must be a multiple of SPILLFILE_GRANULARITY.
+ * spillfile_map returns a pointer to a writable mapping of segment
+ * number 'seg', extending the file if necessary, or NULL on failure;
+ * spillfile_unmap releases a pointer returned from spillfile_map.
+ * The contents of a segment survive being unmapped and mapped again.
+ */
+typedef struct SpillFile SpillFile;
+#define SPILLFILE_GRANULARITY 0x10000
+SpillFile *spillfile_new(size_t segsize);   /* NULL on failure */
+void spillfile_free(SpillFile *sf);
+void *spillfile_map(SpillFile *sf, size_t seg);
+void spillfile_unmap(SpillFile *sf, void *p);
+
 /*
  * Exports and imports from timing.c.
  *
@@ -2849,6 +2891,13 @@ bool run_timers(unsigned long now, unsigned long *next);
 void timer_change_notify(unsigned long next);
 unsigned long timing_last_clock(void);
 
+/*
+ * A cheap monotonic clock with a fine resolution, in nanoseconds from
+ * an arbitrary origin, for timing short operations in performance
+ * counters. Provided by the platform.
+ */
+uint64_t perf_clock_ns(void);
+
 /*
  * Exports from callback.c.
  *
@@ -2900,6 +2949,60 @@ typedef void (*toplevel_callback_notify_fn_t)(void *ctx);
 void request_callback_notifications(toplevel_callback_notify_fn_t notify,
                                     void *ctx);
 
+/*
+ * All the above may only be called from the main thread. Another
+ * thread can use queue_toplevel_callback_from_thread, which passes
+ * the callback to the main thread through a lock-free queue and
+ * wakes up its event loop. The callback then joins the ordinary
+ * queue, behind those already there, and callbacks from any one
+ * thread stay in the order that thread queued them.
+ *
+ * The waking up is done by the platform. Before any thread calls
+ * queue_toplevel_callback_from_thread, the main thread must call
+ * thread_wakeup_setup, which registers a function to be called (from
+ * the queueing thread) when the queue becomes non-empty, and arranges
+ * for the event loop to call collect_toplevel_callbacks_from_threads
+ * when woken.
+ *
+ * delete_callbacks_for_context also deletes callbacks still on their
+ * way from other threads, but can't stop a thread queueing more
+ * afterwards, so a context must outlive the threads that queue
+ * callbacks for it.
+ */
+void queue_toplevel_callback_from_thread(toplevel_callback_fn_t fn,
+                                         void *ctx);
+void collect_toplevel_callbacks_from_threads(void);
+typedef void (*thread_wakeup_fn_t)(void);
+void request_thread_wakeups(thread_wakeup_fn_t wakeup);
+void thread_wakeup_setup(void);        /* provided by the platform */
+
+/*
+ * Facility provided by the platform to run jobs on a worker thread.
+ *
+ * A job is an arbitrary pointer. The worker thread passes each
+ * submitted job to 'fn', one at a time and in the order they were
+ * submitted. Finished jobs wait on an output queue, again in order,
+ * until the main thread takes them off it with worker_thread_collect
+ * (which returns NULL if there aren't any). When the output queue
+ * becomes non-empty, the worker queues 'notify' as a top-level
+ * callback to tell the main thread.
+ *
+ * worker_thread_wait blocks the main thread until every job
+ * submitted so far has finished. Before worker_thread_free, the
+ * caller must wait and then collect everything.
+ */
+typedef struct WorkerThread WorkerThread;
+typedef void (*worker_job_fn_t)(void *job);
+WorkerThread *worker_thread_new(worker_job_fn_t fn,
+                                toplevel_callback_fn_t notify,
+                                void *notify_ctx);
+void worker_thread_submit(WorkerThread *wt, void *job);
+void *worker_thread_collect(WorkerThread *wt);
+void worker_thread_wait(WorkerThread *wt);
+void worker_thread_free(WorkerThread *wt);
+/* The number of CPUs there are to run worker threads on (at least 1) */
+unsigned worker_thread_cpus(void);
+
 /*
  * Facility provided by the platform to spawn a parallel subprocess
  * and present its stdio via a Socket.
@@ -397,6 +397,7 @@ bool portfwdmgr_unlisten(PortFwdManager *mgr, const char *host, int port);
 Channel *portfwd_raw_new(ConnectionLayer *cl, Plug **plug, bool start_ready);
 void portfwd_raw_free(Channel *pfchan);
 void portfwd_raw_setup(Channel *pfchan, Socket *s, SshChannel *sc);
+Socket *portfwd_raw_socket(Channel *pfchan);
 
 Socket *platform_make_agent_socket(Plug *plug, const char *dirprefix,
                                    char **error, char **name);
@@ -410,6 +411,7 @@ void ssh_ldisc_update(Ssh *ssh);
 void ssh_check_sendok(Ssh *ssh);
 void ssh_got_fallback_cmd(Ssh *ssh);
 bool ssh_is_bare(Ssh *ssh);
+bool ssh_get_io_stats(Ssh *ssh, SocketIOStats *stats);
 
 /* Communications back to ssh.c from the BPP */
 void ssh_conn_processed_data(Ssh *ssh);
@@ -618,6 +620,21 @@ uint32_t crc32_rfc1662(ptrlen data);
 uint32_t crc32_ssh1(ptrlen data);
 uint32_t crc32_update(uint32_t crc_input, ptrlen data);
 
+/*
+ * The individual implementations of crc32_update, one of which is
+ * selected at run time by crc32_update itself. Exposed so that
+ * testcrypt and the benchmark can exercise them all separately.
+ */
+typedef struct crc32_impl {
+    const char *name;
+    bool (*check_available)(void);
+    uint32_t (*update)(uint32_t crc_input, ptrlen data);
+} crc32_impl;
+extern const crc32_impl crc32_sw;
+extern const crc32_impl crc32_clmul;
+extern const crc32_impl crc32_neon;
+const crc32_impl *crc32_find_impl(ptrlen name);
+
 /* SSH CRC compensation attack detector */
 struct crcda_ctx;
 struct crcda_ctx *crcda_make_context(void);
@@ -684,6 +701,25 @@ struct ssh_cipheralg {
     unsigned int flags;
 #define SSH_CIPHER_IS_CBC       1
 #define SSH_CIPHER_SEPARATE_LENGTH      2
+    /*
+     * The remaining flags say how to recreate the cipher's state at
+     * the start of any packet from the IV it was originally set up
+     * with, so that packets can be encrypted and decrypted out of
+     * order by separate instances:
+     *
+     * IV_COUNTS_BLOCKS: the IV is a big-endian counter, incremented
+     * once per cipher block.
+     *
+     * IV_COUNTS_MESSAGES: bytes 4-11 of the IV are a big-endian
+     * counter incremented by next_message. After setiv, the cipher's
+     * required MAC must also be given a next_message call.
+     *
+     * IV_IS_SEQUENCE: the state is set up afresh for each packet, by
+     * the length operations or the MAC, from the sequence number.
+     */
+#define SSH_CIPHER_IV_COUNTS_BLOCKS     4
+#define SSH_CIPHER_IV_COUNTS_MESSAGES   8
+#define SSH_CIPHER_IV_IS_SEQUENCE       16
     const char *text_name;
     /* If set, this takes priority over other MAC. */
     const ssh2_macalg *required_mac;
@@ -736,6 +772,13 @@ struct ssh2_macalg {
     void (*genresult)(ssh2_mac *, unsigned char *);
     void (*next_message)(ssh2_mac *);
     const char *(*text_name)(ssh2_mac *);
+
+    /* Optional combined operations for a MAC that can do its work in
+     * the same pass over the data as its paired cipher. See
+     * ssh2_mac_encrypt_and_generate below. */
+    void (*aead_encrypt)(ssh2_mac *, void *blk, int len, unsigned long seq);
+    bool (*aead_decrypt)(ssh2_mac *, void *blk, int len, unsigned long seq);
+
     const char *name, *etm_name;
     int len, keylen;
 
@@ -768,6 +811,17 @@ bool ssh2_mac_verresult(ssh2_mac *, const void *);
 void ssh2_mac_generate(ssh2_mac *, void *, int, unsigned long seq);
 bool ssh2_mac_verify(ssh2_mac *, const void *, int, unsigned long seq);
 
+/* Encrypt-then-MAC a packet of 'len' bytes in place: everything after
+ * the 4-byte length field is encrypted with 'cipher' (which may be
+ * NULL), and then the MAC of the whole thing is appended. And the
+ * reverse: verify the MAC, and only if it's correct, decrypt. A MAC
+ * whose vtable provides aead_encrypt and aead_decrypt, and which was
+ * created with the same cipher, may do both in one pass. */
+void ssh2_mac_encrypt_and_generate(ssh2_mac *, ssh_cipher *cipher,
+                                   void *, int, unsigned long seq);
+bool ssh2_mac_verify_and_decrypt(ssh2_mac *, ssh_cipher *cipher,
+                                 void *, int, unsigned long seq);
+
 void nullmac_next_message(ssh2_mac *m);
 
 /* Use a MAC in its raw form, outside SSH-2 context, to MAC a given
@@ -1102,38 +1156,47 @@ extern const ssh_cipheralg ssh_des;
 extern const ssh_cipheralg ssh_des_sshcom_ssh2;
 extern const ssh_cipheralg ssh_aes256_sdctr;
 extern const ssh_cipheralg ssh_aes256_sdctr_ni;
+extern const ssh_cipheralg ssh_aes256_sdctr_vaes;
 extern const ssh_cipheralg ssh_aes256_sdctr_neon;
 extern const ssh_cipheralg ssh_aes256_sdctr_sw;
 extern const ssh_cipheralg ssh_aes256_gcm;
 extern const ssh_cipheralg ssh_aes256_gcm_ni;
+extern const ssh_cipheralg ssh_aes256_gcm_vaes;
 extern const ssh_cipheralg ssh_aes256_gcm_neon;
 extern const ssh_cipheralg ssh_aes256_gcm_sw;
 extern const ssh_cipheralg ssh_aes256_cbc;
 extern const ssh_cipheralg ssh_aes256_cbc_ni;
+extern const ssh_cipheralg ssh_aes256_cbc_vaes;
 extern const ssh_cipheralg ssh_aes256_cbc_neon;
 extern const ssh_cipheralg ssh_aes256_cbc_sw;
 extern const ssh_cipheralg ssh_aes192_sdctr;
 extern const ssh_cipheralg ssh_aes192_sdctr_ni;
+extern const ssh_cipheralg ssh_aes192_sdctr_vaes;
 extern const ssh_cipheralg ssh_aes192_sdctr_neon;
 extern const ssh_cipheralg ssh_aes192_sdctr_sw;
 extern const ssh_cipheralg ssh_aes192_gcm;
 extern const ssh_cipheralg ssh_aes192_gcm_ni;
+extern const ssh_cipheralg ssh_aes192_gcm_vaes;
 extern const ssh_cipheralg ssh_aes192_gcm_neon;
 extern const ssh_cipheralg ssh_aes192_gcm_sw;
 extern const ssh_cipheralg ssh_aes192_cbc;
 extern const ssh_cipheralg ssh_aes192_cbc_ni;
+extern const ssh_cipheralg ssh_aes192_cbc_vaes;
 extern const ssh_cipheralg ssh_aes192_cbc_neon;
 extern const ssh_cipheralg ssh_aes192_cbc_sw;
 extern const ssh_cipheralg ssh_aes128_sdctr;
 extern const ssh_cipheralg ssh_aes128_sdctr_ni;
+extern const ssh_cipheralg ssh_aes128_sdctr_vaes;
 extern const ssh_cipheralg ssh_aes128_sdctr_neon;
 extern const ssh_cipheralg ssh_aes128_sdctr_sw;
 extern const ssh_cipheralg ssh_aes128_gcm;
 extern const ssh_cipheralg ssh_aes128_gcm_ni;
+extern const ssh_cipheralg ssh_aes128_gcm_vaes;
 extern const ssh_cipheralg ssh_aes128_gcm_neon;
 extern const ssh_cipheralg ssh_aes128_gcm_sw;
 extern const ssh_cipheralg ssh_aes128_cbc;
 extern const ssh_cipheralg ssh_aes128_cbc_ni;
+extern const ssh_cipheralg ssh_aes128_cbc_vaes;
 extern const ssh_cipheralg ssh_aes128_cbc_neon;
 extern const ssh_cipheralg ssh_aes128_cbc_sw;
 extern const ssh_cipheralg ssh_blowfish_ssh2_ctr;
@@ -1141,6 +1204,9 @@ extern const ssh_cipheralg ssh_blowfish_ssh2;
 extern const ssh_cipheralg ssh_arcfour256_ssh2;
 extern const ssh_cipheralg ssh_arcfour128_ssh2;
 extern const ssh_cipheralg ssh2_chacha20_poly1305;
+extern const ssh_cipheralg ssh2_chacha20_poly1305_avx2;
+extern const ssh_cipheralg ssh2_chacha20_poly1305_neon;
+extern const ssh_cipheralg ssh2_chacha20_poly1305_sw;
 extern const ssh2_ciphers ssh2_3des;
 extern const ssh2_ciphers ssh2_des;
 extern const ssh2_ciphers ssh2_aes;
@@ -1250,6 +1316,7 @@ bool platform_pmull_neon_available(void);
 bool platform_sha256_neon_available(void);
 bool platform_sha1_neon_available(void);
 bool platform_sha512_neon_available(void);
+bool platform_crc32_neon_available(void);
 
 /*
  * PuTTY version number formatted as an SSH version string.
@@ -100,6 +100,8 @@ static void ssh2_bare_bpp_handle_input(BinaryPacketProtocol *bpp)
          * Read the remainder of the packet.
          */
         BPP_READ(s->data, s->packetlen);
+        s->bpp.perf.in.packets++;
+        s->bpp.perf.in.bytes += 4 + s->packetlen;
 
         /*
          * The data we just read is precisely the initial type byte
@@ -189,6 +191,8 @@ static void ssh2_bare_bpp_format_packet(struct ssh2_bare_bpp_state *s,
 
     PUT_32BIT_MSB_FIRST(pkt->data, pkt->length - 4);
     bufchain_add(s->bpp.out_raw, pkt->data, pkt->length);
+    s->bpp.perf.out.packets++;
+    s->bpp.perf.out.bytes += pkt->length;
 }
 
 static void ssh2_bare_bpp_handle_output(BinaryPacketProtocol *bpp)
@@ -7,6 +7,22 @@
 
 typedef struct BinaryPacketProtocolVtable BinaryPacketProtocolVtable;
 
+/*
+ * Running performance counters for one direction of a BPP. 'bytes'
+ * counts whole binary packets as they appear on the wire, and
+ * 'crypt_ns' accumulates the time (by perf_clock_ns) spent in the
+ * cipher and MAC for those packets, except on worker threads (see
+ * ssh2_bpp_parallel_crypto), whose time overlaps the main thread's.
+ * These are reported by SS_STATS.
+ */
+typedef struct BppPerfDirection {
+    uint64_t packets, bytes;
+    uint64_t crypt_ns;
+} BppPerfDirection;
+typedef struct BppPerfStats {
+    BppPerfDirection in, out;
+} BppPerfStats;
+
 struct BinaryPacketProtocolVtable {
     void (*free)(BinaryPacketProtocol *);
     void (*handle_input)(BinaryPacketProtocol *);
@@ -46,6 +62,9 @@ struct BinaryPacketProtocol {
      * error at all, or because some other error message has already
      * been emitted). */
     bool expect_close;
+
+    /* Performance counters, maintained by the BPP implementation. */
+    BppPerfStats perf;
 };
 
 static inline void ssh_bpp_handle_input(BinaryPacketProtocol *bpp)
@@ -147,6 +166,23 @@ void ssh2_bpp_new_incoming_crypto(
     const ssh_compression_alg *compression, bool delayed_compression,
     bool reset_sequence_number);
 
+/*
+ * Ask an SSH-2 BPP to run compression and decompression on worker
+ * threads, instead of inline in the event loop, whenever they're
+ * enabled. Packets still reach the wire (and the incoming packet
+ * queue) in the same order, with the same sequence numbers.
+ */
+void ssh2_bpp_compress_in_thread(BinaryPacketProtocol *bpp);
+
+/*
+ * Ask an SSH-2 BPP to encrypt and decrypt packets on up to 'nthreads'
+ * worker threads at once, with the ciphers that allow it (AES-CTR,
+ * AES-GCM and ChaCha20-Poly1305). Packets still reach the wire, and
+ * the incoming packet queue, in sequence order. Incoming packets are
+ * only decrypted in parallel if they aren't compressed.
+ */
+void ssh2_bpp_parallel_crypto(BinaryPacketProtocol *bpp, unsigned nthreads);
+
 /*
  * A query method specific to the interface between ssh2transport and
  * ssh2bpp. If true, it indicates that we're potentially in the
@@ -9,12 +9,28 @@
 #include "bpp.h"
 #include "sshcr.h"
 
+typedef struct ssh2_bpp_crypt_job ssh2_bpp_crypt_job;
+
 struct ssh2_bpp_direction {
     unsigned long sequence;
     ssh_cipher *cipher;
     ssh2_mac *mac;
     bool etm_mode;
     const ssh_compression_alg *pending_compression;
+
+    /*
+     * State for parallel encryption or decryption, used if
+     * par_ciphers is non-NULL. See the comment above
+     * ssh2_bpp_par_position.
+     */
+    ssh_cipher **par_ciphers;          /* one per crypt worker */
+    ssh2_mac **par_macs;
+    unsigned char par_iv[16];          /* the IV the cipher was set up with */
+    uint64_t par_blocks, par_messages; /* position of the next packet */
+    unsigned par_next;                 /* crypt worker for the next packet */
+    ssh2_bpp_crypt_job *par_head, *par_tail; /* in sequence order */
+    unsigned par_queued;
+    bool par_barrier;                  /* incoming: don't read any further */
 };
 
 struct ssh2_bpp_state {
@@ -41,9 +57,81 @@ struct ssh2_bpp_state {
     unsigned nnewkeys;
     int prev_type;
 
+    /*
+     * Worker threads for compression and decompression, if
+     * ssh2_bpp_compress_in_thread has asked for them. Each is created
+     * the first time it's needed. While comp_inflight is nonzero, the
+     * compression worker has sole use of out_comp; likewise the
+     * decompression worker and in_decomp while decomp_inflight is set.
+     */
+    bool compress_in_thread;
+    WorkerThread *comp_worker, *decomp_worker;
+    unsigned comp_inflight;
+    bool decomp_inflight;
+    struct ssh2_bpp_decomp_job *decomp_done;
+
+    /*
+     * Worker threads for encryption and decryption, if
+     * ssh2_bpp_parallel_crypto has asked for them, shared between the
+     * two directions. They're all created the first time a cipher
+     * that can use them is set up.
+     */
+    unsigned n_crypt_workers;
+    WorkerThread **crypt_workers;
+
     BinaryPacketProtocol bpp;
 };
 
+/*
+ * A packet handed to the compression worker, and the compressed
+ * payload it comes back with.
+ */
+typedef struct ssh2_bpp_comp_job {
+    ssh_compressor *comp;
+    PktOut *pkt;
+    int minlen;
+    unsigned char *payload;
+    int payloadlen;
+} ssh2_bpp_comp_job;
+
+/*
+ * Likewise for a received packet payload and the decompression
+ * worker. 'ok' is the return value of ssh_decompressor_decompress.
+ */
+typedef struct ssh2_bpp_decomp_job {
+    ssh_decompressor *decomp;
+    unsigned char *data;
+    int len;
+    bool ok;
+    unsigned char *payload;
+    int payloadlen;
+} ssh2_bpp_decomp_job;
+
+/*
+ * A packet to be encrypted and MACed, or verified and decrypted, by
+ * a cipher and MAC instance of its own. 'data' and 'len' cover
+ * everything the MAC covers. An incoming packet in the standard (not
+ * ETM) layout has already had its first 'skip' bytes decrypted, to
+ * find out its length.
+ */
+struct ssh2_bpp_crypt_job {
+    ssh_cipher *cipher;
+    ssh2_mac *mac;
+    const unsigned char *iv;
+    uint64_t blocks, messages;
+    unsigned long sequence;
+    bool outgoing, etm_mode;
+    unsigned char *data;
+    int len, skip;
+    PktOut *pkt;                       /* outgoing */
+    PktIn *pktin;                      /* incoming */
+    const char *error;                 /* incoming packet was unusable */
+    bool ok;                           /* MAC verified */
+    bool done;                         /* back from the worker */
+    bool barrier;                      /* incoming: might be NEWKEYS */
+    ssh2_bpp_crypt_job *next;
+};
+
 static void ssh2_bpp_free(BinaryPacketProtocol *bpp);
 static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp);
 static void ssh2_bpp_handle_output(BinaryPacketProtocol *bpp);
@@ -71,8 +159,12 @@ BinaryPacketProtocol *ssh2_bpp_new(
     return &s->bpp;
 }
 
+static void ssh2_bpp_par_free(struct ssh2_bpp_state *s,
+                              struct ssh2_bpp_direction *dir);
+
 static void ssh2_bpp_free_outgoing_crypto(struct ssh2_bpp_state *s)
 {
+    ssh2_bpp_par_free(s, &s->out);
     if (s->out.mac)
         ssh2_mac_free(s->out.mac);
     if (s->out.cipher)
@@ -83,6 +175,7 @@ static void ssh2_bpp_free_outgoing_crypto(struct ssh2_bpp_state *s)
 
 static void ssh2_bpp_free_incoming_crypto(struct ssh2_bpp_state *s)
 {
+    ssh2_bpp_par_free(s, &s->in);
     /* As above, take care to free in.mac before in.cipher */
     if (s->in.mac)
         ssh2_mac_free(s->in.mac);
@@ -92,9 +185,51 @@ static void ssh2_bpp_free_incoming_crypto(struct ssh2_bpp_state *s)
         ssh_decompressor_free(s->in_decomp);
 }
 
+static void ssh2_bpp_comp_drain(struct ssh2_bpp_state *s);
+static void ssh2_bpp_free_decomp_job(ssh2_bpp_decomp_job *job);
+static void ssh2_bpp_par_wait(struct ssh2_bpp_state *s);
+static void ssh2_bpp_par_drain_out(struct ssh2_bpp_state *s);
+static void ssh2_bpp_par_setup(
+    struct ssh2_bpp_state *s, struct ssh2_bpp_direction *dir,
+    const void *ckey, const void *iv, const void *mac_key);
+
 static void ssh2_bpp_free(BinaryPacketProtocol *bpp)
 {
     struct ssh2_bpp_state *s = container_of(bpp, struct ssh2_bpp_state, bpp);
+
+    /*
+     * Get the workers to finish what they're doing first, since it
+     * may involve the compressors or s->pktin. Finished packets going
+     * out are simply discarded.
+     */
+    if (s->comp_worker) {
+        ssh2_bpp_comp_job *job;
+        worker_thread_wait(s->comp_worker);
+        while ((job = worker_thread_collect(s->comp_worker)) != NULL) {
+            sfree(job->payload);
+            ssh_free_pktout(job->pkt);
+            sfree(job);
+        }
+        worker_thread_free(s->comp_worker);
+    }
+    if (s->decomp_worker) {
+        ssh2_bpp_decomp_job *job;
+        worker_thread_wait(s->decomp_worker);
+        while ((job = worker_thread_collect(s->decomp_worker)) != NULL)
+            ssh2_bpp_free_decomp_job(job);
+        worker_thread_free(s->decomp_worker);
+    }
+    if (s->decomp_done)
+        ssh2_bpp_free_decomp_job(s->decomp_done);
+    if (s->crypt_workers) {
+        ssh2_bpp_par_wait(s);
+        ssh2_bpp_par_free(s, &s->out);
+        ssh2_bpp_par_free(s, &s->in);
+        for (unsigned i = 0; i < s->n_crypt_workers; i++)
+            worker_thread_free(s->crypt_workers[i]);
+        sfree(s->crypt_workers);
+    }
+
     sfree(s->buf);
     ssh2_bpp_free_outgoing_crypto(s);
     ssh2_bpp_free_incoming_crypto(s);
@@ -113,6 +248,13 @@ void ssh2_bpp_new_outgoing_crypto(
     assert(bpp->vt == &ssh2_bpp_vtable);
     s = container_of(bpp, struct ssh2_bpp_state, bpp);
 
+    /*
+     * ssh2_bpp_handle_output should already have sent every packet
+     * due to go out under the old keys, but make sure.
+     */
+    ssh2_bpp_comp_drain(s);
+    ssh2_bpp_par_drain_out(s);
+
     ssh2_bpp_free_outgoing_crypto(s);
 
     if (cipher) {
@@ -154,6 +296,8 @@ void ssh2_bpp_new_outgoing_crypto(
     if (reset_sequence_number)
         s->out.sequence = 0;
 
+    ssh2_bpp_par_setup(s, &s->out, ckey, iv, mac_key);
+
     if (delayed_compression && !s->seen_userauth_success) {
         s->out.pending_compression = compression;
         s->out_comp = NULL;
@@ -185,6 +329,11 @@ void ssh2_bpp_new_incoming_crypto(
     assert(bpp->vt == &ssh2_bpp_vtable);
     s = container_of(bpp, struct ssh2_bpp_state, bpp);
 
+    /* The input coroutine never has a packet out for decompression,
+     * or any packet being decrypted, while it's waiting for new keys */
+    assert(!s->decomp_inflight);
+    assert(!s->in.par_head);
+
     ssh2_bpp_free_incoming_crypto(s);
 
     if (cipher) {
@@ -232,6 +381,14 @@ void ssh2_bpp_new_incoming_crypto(
                          ssh_decompressor_alg(s->in_decomp)->text_name);
     }
 
+    /*
+     * Decrypting ahead means knowing the type of each packet before
+     * it's been decompressed (see ssh2_bpp_par_read), so we can only
+     * do it without compression.
+     */
+    if (!s->in_decomp && !s->in.pending_compression)
+        ssh2_bpp_par_setup(s, &s->in, ckey, iv, mac_key);
+
     /* Clear the pending_newkeys flag, so that handle_input below will
      * start consuming the input data again. */
     s->pending_newkeys = false;
@@ -271,6 +428,471 @@ static void ssh2_bpp_enable_pending_compression(struct ssh2_bpp_state *s)
     }
 }
 
+/*
+ * Accumulate the time spent in the cipher and MAC into the BPP's
+ * performance counters. The start time is never kept across a
+ * coroutine suspension, so we only ever time actual computation.
+ * perf_clock_ns is cheap enough to call twice per packet, which
+ * clock() isn't on every platform.
+ */
+static inline void ssh2_bpp_crypt_time(BppPerfDirection *dir, uint64_t start)
+{
+    dir->crypt_ns += perf_clock_ns() - start;
+}
+
+void ssh2_bpp_compress_in_thread(BinaryPacketProtocol *bpp)
+{
+    struct ssh2_bpp_state *s;
+    assert(bpp->vt == &ssh2_bpp_vtable);
+    s = container_of(bpp, struct ssh2_bpp_state, bpp);
+
+    s->compress_in_thread = true;
+}
+
+static void ssh2_bpp_worker_notify(void *ctx);
+static void ssh2_bpp_crypt_job_run(void *vjob);
+
+static void ssh2_bpp_decomp_job_run(void *vjob)
+{
+    ssh2_bpp_decomp_job *job = (ssh2_bpp_decomp_job *)vjob;
+    job->ok = ssh_decompressor_decompress(
+        job->decomp, job->data, job->len, &job->payload, &job->payloadlen);
+}
+
+static void ssh2_bpp_free_decomp_job(ssh2_bpp_decomp_job *job)
+{
+    sfree(job->payload);               /* NULL if decompression failed */
+    sfree(job);
+}
+
+void ssh2_bpp_parallel_crypto(BinaryPacketProtocol *bpp, unsigned nthreads)
+{
+    struct ssh2_bpp_state *s;
+    assert(bpp->vt == &ssh2_bpp_vtable);
+    s = container_of(bpp, struct ssh2_bpp_state, bpp);
+
+    s->n_crypt_workers = nthreads;
+}
+
+/*
+ * Parallel encryption and decryption.
+ *
+ * Some ciphers can say how to recreate their state at the start of
+ * any packet from the IV they were set up with (see the
+ * SSH_CIPHER_IV_* flags). For those, each crypt worker gets its own
+ * cipher and MAC instances, keyed like the main ones. The main thread
+ * assigns each packet a sequence number and a position in the cipher
+ * stream, in order, and the worker moves its instances to that
+ * position before doing the packet. Finished packets wait on a queue
+ * for their direction until everything before them has finished
+ * too, so they reach out_raw (or the input coroutine) in sequence
+ * order.
+ *
+ * Small packets aren't worth the trip to a worker and back, so the
+ * main instances do them straight away, positioned the same way.
+ * They still wait their turn on the queue.
+ */
+#define SSH2_BPP_PAR_MIN_LEN 1024
+/* Incoming packets queued per worker, before we stop reading ahead */
+#define SSH2_BPP_PAR_QUEUE_LEN 8
+
+static void ssh2_bpp_par_position(ssh_cipher *cipher, ssh2_mac *mac,
+                                  const unsigned char *iv0,
+                                  uint64_t blocks, uint64_t messages)
+{
+    const ssh_cipheralg *alg = ssh_cipher_alg(cipher);
+    unsigned char iv[16];
+
+    if (alg->flags & SSH_CIPHER_IV_COUNTS_BLOCKS) {
+        /* Add 'blocks' to the whole IV, as a big-endian number */
+        uint64_t carry = blocks;
+        for (int i = alg->blksize; i-- > 0 ;) {
+            unsigned sum = iv0[i] + (unsigned)(carry & 0xFF);
+            iv[i] = sum;
+            carry = (carry >> 8) + (sum >> 8);
+        }
+        ssh_cipher_setiv(cipher, iv);
+    } else if (alg->flags & SSH_CIPHER_IV_COUNTS_MESSAGES) {
+        memcpy(iv, iv0, alg->blksize);
+        PUT_64BIT_MSB_FIRST(iv + 4, GET_64BIT_MSB_FIRST(iv0 + 4) + messages);
+        ssh_cipher_setiv(cipher, iv);
+        ssh2_mac_next_message(mac);
+    }
+    /* and SSH_CIPHER_IV_IS_SEQUENCE needs nothing doing here */
+
+    smemclr(iv, sizeof(iv));
+}
+
+static void ssh2_bpp_par_setup(
+    struct ssh2_bpp_state *s, struct ssh2_bpp_direction *dir,
+    const void *ckey, const void *iv, const void *mac_key)
+{
+    BinaryPacketProtocol *bpp = &s->bpp; /* for bpp_logevent */
+
+    if (!s->n_crypt_workers || !dir->cipher || !dir->mac)
+        return;
+
+    const ssh_cipheralg *alg = ssh_cipher_alg(dir->cipher);
+    const ssh2_macalg *macalg = ssh2_mac_alg(dir->mac);
+    if (!(alg->flags & (SSH_CIPHER_IV_COUNTS_BLOCKS |
+                        SSH_CIPHER_IV_COUNTS_MESSAGES |
+                        SSH_CIPHER_IV_IS_SEQUENCE)))
+        return;
+    assert(alg->blksize <= (int)sizeof(dir->par_iv));
+
+    if (!s->crypt_workers) {
+        s->crypt_workers = snewn(s->n_crypt_workers, WorkerThread *);
+        for (unsigned i = 0; i < s->n_crypt_workers; i++)
+            s->crypt_workers[i] = worker_thread_new(
+                ssh2_bpp_crypt_job_run, ssh2_bpp_worker_notify, s);
+    }
+
+    dir->par_ciphers = snewn(s->n_crypt_workers, ssh_cipher *);
+    dir->par_macs = snewn(s->n_crypt_workers, ssh2_mac *);
+    for (unsigned i = 0; i < s->n_crypt_workers; i++) {
+        /* Same order of setup as for the main instances */
+        dir->par_ciphers[i] = ssh_cipher_new(alg);
+        ssh_cipher_setkey(dir->par_ciphers[i], ckey);
+        ssh_cipher_setiv(dir->par_ciphers[i], iv);
+        dir->par_macs[i] = ssh2_mac_new(macalg, dir->par_ciphers[i]);
+        ssh2_mac_setkey(dir->par_macs[i],
+                        make_ptrlen(mac_key, macalg->keylen));
+    }
+    memcpy(dir->par_iv, iv, alg->blksize);
+    dir->par_blocks = dir->par_messages = 0;
+    dir->par_next = 0;
+    dir->par_barrier = false;
+
+    bpp_logevent("Using %u threads for %s %s", s->n_crypt_workers,
+                 dir == &s->out ? "outbound" : "inbound",
+                 dir == &s->out ? "encryption" : "decryption");
+}
+
+static void ssh2_bpp_par_free(struct ssh2_bpp_state *s,
+                              struct ssh2_bpp_direction *dir)
+{
+    ssh2_bpp_crypt_job *job;
+
+    /* Everything left on the queue must already be back from the
+     * workers, so it's only the bpp being freed that leaves any */
+    while ((job = dir->par_head) != NULL) {
+        assert(job->done);
+        dir->par_head = job->next;
+        if (job->pkt)
+            ssh_free_pktout(job->pkt);
+        sfree(job->pktin);
+        sfree(job);
+    }
+    dir->par_tail = NULL;
+    dir->par_queued = 0;
+
+    if (!dir->par_ciphers)
+        return;
+
+    /* MACs before ciphers, as in ssh2_bpp_free_outgoing_crypto */
+    for (unsigned i = 0; i < s->n_crypt_workers; i++) {
+        ssh2_mac_free(dir->par_macs[i]);
+        ssh_cipher_free(dir->par_ciphers[i]);
+    }
+    sfree(dir->par_macs);
+    sfree(dir->par_ciphers);
+    dir->par_macs = NULL;
+    dir->par_ciphers = NULL;
+    smemclr(dir->par_iv, sizeof(dir->par_iv));
+}
+
+static void ssh2_bpp_mac_and_encrypt(
+    ssh_cipher *cipher, ssh2_mac *mac, bool etm_mode,
+    unsigned char *data, int len, unsigned long sequence)
+{
+    if (mac && etm_mode) {
+        /*
+         * OpenSSH-defined encrypt-then-MAC protocol.
+         */
+        ssh2_mac_encrypt_and_generate(mac, cipher, data, len, sequence);
+    } else {
+        /*
+         * SSH-2 standard protocol.
+         */
+        if (mac)
+            ssh2_mac_generate(mac, data, len, sequence);
+        if (cipher)
+            ssh_cipher_encrypt(cipher, data, len);
+    }
+}
+
+static void ssh2_bpp_crypt_job_run(void *vjob)
+{
+    ssh2_bpp_crypt_job *job = (ssh2_bpp_crypt_job *)vjob;
+
+    ssh2_bpp_par_position(job->cipher, job->mac, job->iv,
+                          job->blocks, job->messages);
+
+    if (job->outgoing) {
+        if (ssh_cipher_alg(job->cipher)->flags & SSH_CIPHER_SEPARATE_LENGTH)
+            ssh_cipher_encrypt_length(job->cipher, job->data, 4,
+                                      job->sequence);
+        ssh2_bpp_mac_and_encrypt(job->cipher, job->mac, job->etm_mode,
+                                 job->data, job->len, job->sequence);
+        job->ok = true;
+    } else if (job->etm_mode) {
+        job->ok = ssh2_mac_verify_and_decrypt(
+            job->mac, job->cipher, job->data, job->len, job->sequence);
+    } else {
+        ssh_cipher_decrypt(job->cipher, job->data + job->skip,
+                           job->len - job->skip);
+        job->ok = ssh2_mac_verify(job->mac, job->data, job->len,
+                                  job->sequence);
+    }
+}
+
+/*
+ * Make a job for the next packet in a direction, and move the
+ * direction's position past it.
+ */
+static ssh2_bpp_crypt_job *ssh2_bpp_par_new_job(
+    struct ssh2_bpp_direction *dir, unsigned char *data, int len)
+{
+    ssh2_bpp_crypt_job *job = snew(ssh2_bpp_crypt_job);
+    memset(job, 0, sizeof(*job));
+    job->outgoing = false;
+    job->etm_mode = dir->etm_mode;
+    job->iv = dir->par_iv;
+    job->blocks = dir->par_blocks;
+    job->messages = dir->par_messages;
+    job->sequence = dir->sequence;
+    job->data = data;
+    job->len = len;
+
+    /* The cipher covers what the MAC does, except an ETM length field */
+    dir->par_blocks += (len - (dir->etm_mode ? 4 : 0)) /
+        ssh_cipher_alg(dir->cipher)->blksize;
+    dir->par_messages++;
+    return job;
+}
+
+/*
+ * Put a job on its direction's queue, and either do it now or give
+ * it to the next worker.
+ */
+static void ssh2_bpp_par_submit(struct ssh2_bpp_state *s,
+                                struct ssh2_bpp_direction *dir,
+                                ssh2_bpp_crypt_job *job)
+{
+    job->next = NULL;
+    if (dir->par_tail)
+        dir->par_tail->next = job;
+    else
+        dir->par_head = job;
+    dir->par_tail = job;
+    dir->par_queued++;
+
+    if (job->error) {
+        job->done = true;
+    } else if (job->len < SSH2_BPP_PAR_MIN_LEN) {
+        job->cipher = dir->cipher;
+        job->mac = dir->mac;
+        uint64_t crypt_start = perf_clock_ns();
+        ssh2_bpp_crypt_job_run(job);
+        ssh2_bpp_crypt_time(job->outgoing ? &s->bpp.perf.out :
+                            &s->bpp.perf.in, crypt_start);
+        job->done = true;
+    } else {
+        unsigned i = dir->par_next;
+        dir->par_next = (i + 1) % s->n_crypt_workers;
+        job->cipher = dir->par_ciphers[i];
+        job->mac = dir->par_macs[i];
+        worker_thread_submit(s->crypt_workers[i], job);
+    }
+}
+
+static ssh2_bpp_crypt_job *ssh2_bpp_par_pop(struct ssh2_bpp_direction *dir)
+{
+    ssh2_bpp_crypt_job *job = dir->par_head;
+    if (!job || !job->done)
+        return NULL;
+
+    dir->par_head = job->next;
+    if (!dir->par_head)
+        dir->par_tail = NULL;
+    dir->par_queued--;
+    return job;
+}
+
+/*
+ * Mark whatever the workers have finished as done.
+ */
+static void ssh2_bpp_par_collect(struct ssh2_bpp_state *s)
+{
+    for (unsigned i = 0; i < s->n_crypt_workers; i++) {
+        ssh2_bpp_crypt_job *job;
+        while ((job = worker_thread_collect(s->crypt_workers[i])) != NULL)
+            job->done = true;
+    }
+}
+
+static void ssh2_bpp_par_wait(struct ssh2_bpp_state *s)
+{
+    for (unsigned i = 0; i < s->n_crypt_workers; i++)
+        worker_thread_wait(s->crypt_workers[i]);
+    ssh2_bpp_par_collect(s);
+}
+
+/*
+ * Send every outgoing packet that's ready, in order. Returns true if
+ * there were any.
+ */
+static bool ssh2_bpp_par_flush_out(struct ssh2_bpp_state *s)
+{
+    ssh2_bpp_crypt_job *job;
+    bool sent = false;
+
+    while ((job = ssh2_bpp_par_pop(&s->out)) != NULL) {
+        bufchain_add(s->bpp.out_raw, job->pkt->data, job->pkt->length);
+        ssh_free_pktout(job->pkt);
+        sfree(job);
+        sent = true;
+    }
+    return sent;
+}
+
+/*
+ * Wait for every outgoing packet to be finished and sent.
+ */
+static void ssh2_bpp_par_drain_out(struct ssh2_bpp_state *s)
+{
+    if (!s->out.par_head)
+        return;
+
+    ssh2_bpp_par_wait(s);
+    ssh2_bpp_par_flush_out(s);
+    assert(!s->out.par_head);
+
+    /* Waiting may have finished incoming packets as well */
+    if (s->in.par_head && s->in.par_head->done)
+        queue_idempotent_callback(&s->bpp.ic_in_raw);
+}
+
+/*
+ * Take as many whole packets as we can off in_raw, and start
+ * decrypting them, without waiting for each one to finish before
+ * looking at the next.
+ *
+ * We find where each packet ends in the same way as the serial code
+ * in ssh2_bpp_handle_input. But we also need to know that the keys
+ * won't change in the meantime, so we stop after anything that looks
+ * like NEWKEYS. In ETM mode, that means decrypting the start of each
+ * packet on the main thread before its MAC has been checked; but the
+ * result is only used to decide whether to read any further, and
+ * nothing in the packet is acted on until the MAC has been verified.
+ */
+static void ssh2_bpp_par_read(struct ssh2_bpp_state *s)
+{
+    struct ssh2_bpp_direction *dir = &s->in;
+    const ssh_cipheralg *alg = ssh_cipher_alg(dir->cipher);
+    unsigned cipherblk = alg->blksize < 8 ? 8 : alg->blksize;
+    int maclen = ssh2_mac_alg(dir->mac)->len;
+    bool consumed = false;
+
+    while (!dir->par_barrier &&
+           dir->par_queued < SSH2_BPP_PAR_QUEUE_LEN * s->n_crypt_workers) {
+        size_t avail = bufchain_size(s->bpp.in_raw);
+        unsigned char first[16];
+        const char *error = NULL;
+        long len;
+        int skip;
+
+        if (dir->etm_mode) {
+            if (avail < 4)
+                break;
+            bufchain_fetch(s->bpp.in_raw, first, 4);
+            if (alg->flags & SSH_CIPHER_SEPARATE_LENGTH)
+                ssh_cipher_decrypt_length(dir->cipher, first, 4,
+                                          dir->sequence);
+            len = toint(GET_32BIT_MSB_FIRST(first));
+            if (len < 0 || len > (long)OUR_V2_PACKETLIMIT ||
+                len % cipherblk != 0)
+                error = "Incoming packet length field was garbled";
+            skip = 0;
+        } else {
+            /* Only counter mode gets here, so this is one block */
+            assert(cipherblk <= sizeof(first));
+            if (avail < cipherblk)
+                break;
+            bufchain_fetch(s->bpp.in_raw, first, cipherblk);
+            ssh2_bpp_par_position(dir->cipher, dir->mac, dir->par_iv,
+                                  dir->par_blocks, dir->par_messages);
+            ssh_cipher_decrypt(dir->cipher, first, cipherblk);
+            len = toint(GET_32BIT_MSB_FIRST(first));
+            if (len < 0 || len > (long)OUR_V2_PACKETLIMIT ||
+                (len + 4) % cipherblk != 0)
+                error = "Incoming packet was garbled on decryption";
+            skip = cipherblk;
+        }
+
+        if (error) {
+            ssh2_bpp_crypt_job *job = snew(ssh2_bpp_crypt_job);
+            memset(job, 0, sizeof(*job));
+            job->error = error;
+            ssh2_bpp_par_submit(s, dir, job);
+            dir->par_barrier = true;
+            break;
+        }
+
+        size_t total = len + 4 + maclen;
+        if (avail < total)
+            break;
+
+        PktIn *pktin = snew_plus(PktIn, total);
+        pktin->qnode.prev = pktin->qnode.next = NULL;
+        pktin->type = 0;
+        pktin->qnode.on_free_queue = false;
+        unsigned char *data = snew_plus_get_aux(pktin);
+        bufchain_fetch_consume(s->bpp.in_raw, data, total);
+        memcpy(data, first, skip);
+        consumed = true;
+
+        int type;
+        if (dir->etm_mode) {
+            unsigned char peek[16];
+            int peeklen = len < 16 ? len : 16;
+            memcpy(peek, data + 4, peeklen);
+            ssh2_bpp_par_position(dir->cipher, dir->mac, dir->par_iv,
+                                  dir->par_blocks, dir->par_messages);
+            ssh_cipher_decrypt(dir->cipher, peek, peeklen);
+            type = peeklen >= 2 ? peek[1] : -1;
+            smemclr(peek, sizeof(peek));
+        } else {
+            type = first[5];
+        }
+        smemclr(first, sizeof(first));
+
+        ssh2_bpp_crypt_job *job = ssh2_bpp_par_new_job(dir, data, len + 4);
+        job->pktin = pktin;
+        pktin->sequence = dir->sequence++;
+        job->skip = skip;
+        job->blocks += skip / alg->blksize;
+        if (type == SSH2_MSG_NEWKEYS)
+            job->barrier = dir->par_barrier = true;
+        ssh2_bpp_par_submit(s, dir, job);
+    }
+
+    if (consumed)
+        ssh_check_frozen(s->bpp.ssh);
+}
+
+/*
+ * Wait condition for the input coroutine: true when the oldest
+ * packet on the queue is ready, or there isn't one and never will be.
+ */
+static bool ssh2_bpp_par_input_ready(struct ssh2_bpp_state *s)
+{
+    ssh2_bpp_par_read(s);
+    if (s->in.par_head)
+        return s->in.par_head->done;
+    return s->bpp.input_eof;
+}
+
 #define BPP_READ(ptr, len) do                                           \
     {                                                                   \
         bool success;                                                   \
@@ -301,9 +923,41 @@ static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp)
             s->cipherblk = 8;
         s->maclen = s->in.mac ? ssh2_mac_alg(s->in.mac)->len : 0;
 
-        if (s->in.cipher &&
-            (ssh_cipher_alg(s->in.cipher)->flags & SSH_CIPHER_IS_CBC) &&
-            s->in.mac && !s->in.etm_mode) {
+        if (s->in.par_ciphers) {
+            /*
+             * Parallel decryption: ssh2_bpp_par_read has done the
+             * work of the other branches below, and we just wait for
+             * the next packet to come back verified.
+             */
+            ssh2_bpp_crypt_job *job;
+
+            crMaybeWaitUntilV(ssh2_bpp_par_input_ready(s));
+            if ((job = ssh2_bpp_par_pop(&s->in)) == NULL)
+                goto eof;
+
+            if (job->barrier)
+                s->in.par_barrier = false;
+
+            if (job->error) {
+                ssh_sw_abort(s->bpp.ssh, "%s", job->error);
+                sfree(job);
+                crStopV;
+            }
+            s->pktin = job->pktin;
+            if (!job->ok) {
+                ssh_sw_abort(s->bpp.ssh, "Incorrect MAC received on packet");
+                sfree(job);
+                crStopV;
+            }
+
+            s->len = job->len - 4;
+            s->packetlen = job->len;
+            s->maxlen = s->packetlen + s->maclen;
+            s->data = snew_plus_get_aux(s->pktin);
+            sfree(job);
+        } else if (s->in.cipher && (ssh_cipher_alg(s->in.cipher)->flags &
+                                    SSH_CIPHER_IS_CBC) &&
+                   s->in.mac && !s->in.etm_mode) {
             /*
              * When dealing with a CBC-mode cipher, we want to avoid the
              * possibility of an attacker's tweaking the ciphertext stream
@@ -342,6 +996,7 @@ static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp)
                 /* Read another cipher-block's worth, and tack it on to
                  * the end. */
                 BPP_READ(s->buf + (s->packetlen + s->maclen), s->cipherblk);
+                uint64_t crypt_start = perf_clock_ns();
                 /* Decrypt one more block (a little further back in
                  * the stream). */
                 ssh_cipher_decrypt(s->in.cipher,
@@ -353,7 +1008,10 @@ static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp)
                 s->packetlen += s->cipherblk;
 
                 /* See if that gives us a valid packet. */
-                if (ssh2_mac_verresult(s->in.mac, s->buf + s->packetlen) &&
+                bool mac_ok = ssh2_mac_verresult(
+                    s->in.mac, s->buf + s->packetlen);
+                ssh2_bpp_crypt_time(&s->bpp.perf.in, crypt_start);
+                if (mac_ok &&
                     ((s->len = toint(GET_32BIT_MSB_FIRST(s->buf))) ==
                      s->packetlen-4))
                     break;
@@ -431,18 +1089,17 @@ static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp)
             BPP_READ(s->data + 4, s->packetlen + s->maclen - 4);
 
             /*
-             * Check the MAC.
+             * Check the MAC, and decrypt everything between the
+             * length field and the MAC.
              */
-            if (s->in.mac && !ssh2_mac_verify(
-                    s->in.mac, s->data, s->len + 4, s->in.sequence)) {
+            uint64_t crypt_start = perf_clock_ns();
+            if (!ssh2_mac_verify_and_decrypt(
+                    s->in.mac, s->in.cipher, s->data, s->len + 4,
+                    s->in.sequence)) {
                 ssh_sw_abort(s->bpp.ssh, "Incorrect MAC received on packet");
                 crStopV;
             }
-
-            /* Decrypt everything between the length field and the MAC. */
-            if (s->in.cipher)
-                ssh_cipher_decrypt(
-                    s->in.cipher, s->data + 4, s->packetlen - 4);
+            ssh2_bpp_crypt_time(&s->bpp.perf.in, crypt_start);
         } else {
             if (s->bufsize < s->cipherblk) {
                 s->bufsize = s->cipherblk;
@@ -455,8 +1112,11 @@ static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp)
              */
             BPP_READ(s->buf, s->cipherblk);
 
-            if (s->in.cipher)
+            if (s->in.cipher) {
+                uint64_t crypt_start = perf_clock_ns();
                 ssh_cipher_decrypt(s->in.cipher, s->buf, s->cipherblk);
+                ssh2_bpp_crypt_time(&s->bpp.perf.in, crypt_start);
+            }
 
             /*
              * Now get the length figure.
@@ -497,6 +1157,7 @@ static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp)
                      s->packetlen + s->maclen - s->cipherblk);
 
             /* Decrypt everything _except_ the MAC. */
+            uint64_t crypt_start = perf_clock_ns();
             if (s->in.cipher)
                 ssh_cipher_decrypt(
                     s->in.cipher,
@@ -510,6 +1171,7 @@ static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp)
                 ssh_sw_abort(s->bpp.ssh, "Incorrect MAC received on packet");
                 crStopV;
             }
+            ssh2_bpp_crypt_time(&s->bpp.perf.in, crypt_start);
         }
         /* Get and sanity-check the amount of random padding. */
         s->pad = s->data[4];
@@ -526,12 +1188,17 @@ static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp)
         s->length = s->payload + 5;
 
         dts_consume(&s->stats->in, s->packetlen);
+        s->bpp.perf.in.packets++;
+        s->bpp.perf.in.bytes += s->packetlen + s->maclen;
 
-        s->pktin->sequence = s->in.sequence++;
-        if (s->in.cipher)
-            ssh_cipher_next_message(s->in.cipher);
-        if (s->in.mac)
-            ssh2_mac_next_message(s->in.mac);
+        if (!s->in.par_ciphers) {
+            /* (ssh2_bpp_par_read has already done all this) */
+            s->pktin->sequence = s->in.sequence++;
+            if (s->in.cipher)
+                ssh_cipher_next_message(s->in.cipher);
+            if (s->in.mac)
+                ssh2_mac_next_message(s->in.mac);
+        }
 
         s->length = s->packetlen - s->pad;
         assert(s->length >= 0);
@@ -539,12 +1206,46 @@ static void ssh2_bpp_handle_input(BinaryPacketProtocol *bpp)
         /*
          * Decompress packet payload.
          */
+        if (s->in_decomp && s->compress_in_thread) {
+            /*
+             * Hand the payload to the decompression worker, and wait
+             * for it to come back. We can't go on to decrypt the next
+             * packet meanwhile, because if this one turns out to be
+             * NEWKEYS then the next one needs different keys; but the
+             * event loop is free to get on with other things.
+             */
+            if (!s->decomp_worker)
+                s->decomp_worker = worker_thread_new(
+                    ssh2_bpp_decomp_job_run, ssh2_bpp_worker_notify, s);
+
+            ssh2_bpp_decomp_job *job = snew(ssh2_bpp_decomp_job);
+            job->decomp = s->in_decomp;
+            job->data = s->data + 5;
+            job->len = s->length - 5;
+            job->payload = NULL;
+            s->decomp_inflight = true;
+            worker_thread_submit(s->decomp_worker, job);
+        }
+        crMaybeWaitUntilV(!s->decomp_inflight);
         {
             unsigned char *newpayload;
             int newlen;
-            if (s->in_decomp && ssh_decompressor_decompress(
+            bool decompressed;
+
+            if (s->decomp_done) {
+                ssh2_bpp_decomp_job *job = s->decomp_done;
+                s->decomp_done = NULL;
+                decompressed = job->ok;
+                newpayload = job->payload;
+                newlen = job->payloadlen;
+                sfree(job);
+            } else {
+                decompressed = s->in_decomp && ssh_decompressor_decompress(
                     s->in_decomp, s->data + 5, s->length - 5,
-                    &newpayload, &newlen)) {
+                    &newpayload, &newlen);
+            }
+
+            if (decompressed) {
                 if (s->maxlen < newlen + 5) {
                     PktIn *old_pktin = s->pktin;
 
@@ -743,11 +1444,11 @@ static PktOut *ssh2_bpp_new_pktout(int pkt_type)
     return pkt;
 }
 
-static void ssh2_bpp_format_packet_inner(struct ssh2_bpp_state *s, PktOut *pkt)
+static void ssh2_bpp_log_outgoing(struct ssh2_bpp_state *s, PktOut *pkt)
 {
-    int origlen, cipherblk, maclen, padding, unencrypted_prefix, i;
-
     if (s->bpp.logctx) {
+        /* Packets still with the compression worker will go first */
+        unsigned long sequence = s->out.sequence + s->comp_inflight;
         ptrlen pktdata = make_ptrlen(pkt->data + pkt->prefix,
                                      pkt->length - pkt->prefix);
         logblank_t blanks[MAX_BLANKS];
@@ -756,37 +1457,37 @@ static void ssh2_bpp_format_packet_inner(struct ssh2_bpp_state *s, PktOut *pkt)
         log_packet(s->bpp.logctx, PKT_OUTGOING, pkt->type,
                    ssh2_pkt_type(s->bpp.pls->kctx, s->bpp.pls->actx,
                                  pkt->type),
-                   pktdata.ptr, pktdata.len, nblanks, blanks, &s->out.sequence,
+                   pktdata.ptr, pktdata.len, nblanks, blanks, &sequence,
                    pkt->downstream_id, pkt->additional_log_text);
     }
+}
 
-    cipherblk = s->out.cipher ? ssh_cipher_alg(s->out.cipher)->blksize : 8;
-    cipherblk = cipherblk < 8 ? 8 : cipherblk;  /* or 8 if blksize < 8 */
-
-    if (s->out_comp) {
-        unsigned char *newpayload;
-        int minlen, newlen;
-
+static int ssh2_bpp_comp_minlen(struct ssh2_bpp_state *s, PktOut *pkt)
+{
+    int minlen = pkt->minlen;
+    if (minlen) {
         /*
-         * Compress packet payload.
+         * Work out how much compressed data we need (at least) to
+         * make the overall packet length come to pkt->minlen.
          */
-        minlen = pkt->minlen;
-        if (minlen) {
-            /*
-             * Work out how much compressed data we need (at least) to
-             * make the overall packet length come to pkt->minlen.
-             */
-            if (s->out.mac)
-                minlen -= ssh2_mac_alg(s->out.mac)->len;
-            minlen -= 8;              /* length field + min padding */
-        }
-
-        ssh_compressor_compress(s->out_comp, pkt->data + 5, pkt->length - 5,
-                                &newpayload, &newlen, minlen);
-        pkt->length = 5;
-        put_data(pkt, newpayload, newlen);
-        sfree(newpayload);
+        if (s->out.mac)
+            minlen -= ssh2_mac_alg(s->out.mac)->len;
+        minlen -= 8;                  /* length field + min padding */
     }
+    return minlen;
+}
+
+/*
+ * Pad, MAC and encrypt a packet whose payload is final, assigning it
+ * the next outgoing sequence number, and send it. Takes ownership of
+ * the packet.
+ */
+static void ssh2_bpp_send_packet(struct ssh2_bpp_state *s, PktOut *pkt)
+{
+    int origlen, cipherblk, maclen, padding, unencrypted_prefix, i;
+
+    cipherblk = s->out.cipher ? ssh_cipher_alg(s->out.cipher)->blksize : 8;
+    cipherblk = cipherblk < 8 ? 8 : cipherblk;  /* or 8 if blksize < 8 */
 
     /*
      * Add padding. At least four bytes, and must also bring total
@@ -808,8 +1509,10 @@ static void ssh2_bpp_format_packet_inner(struct ssh2_bpp_state *s, PktOut *pkt)
     pkt->data[4] = padding;
     PUT_32BIT_MSB_FIRST(pkt->data, origlen + padding - 4);
 
-    /* Encrypt length if the scheme requires it */
-    if (s->out.cipher &&
+    /* Encrypt length if the scheme requires it (and, in parallel mode,
+     * leave it to ssh2_bpp_crypt_job_run, along with everything else
+     * that depends on the cipher's position) */
+    if (s->out.cipher && !s->out.par_ciphers &&
         (ssh_cipher_alg(s->out.cipher)->flags & SSH_CIPHER_SEPARATE_LENGTH)) {
         ssh_cipher_encrypt_length(s->out.cipher, pkt->data, 4,
                                   s->out.sequence);
@@ -817,35 +1520,61 @@ static void ssh2_bpp_format_packet_inner(struct ssh2_bpp_state *s, PktOut *pkt)
 
     put_padding(pkt, maclen, 0);
 
-    if (s->out.mac && s->out.etm_mode) {
-        /*
-         * OpenSSH-defined encrypt-then-MAC protocol.
-         */
-        if (s->out.cipher)
-            ssh_cipher_encrypt(s->out.cipher,
-                               pkt->data + 4, origlen + padding - 4);
-        ssh2_mac_generate(s->out.mac, pkt->data, origlen + padding,
-                          s->out.sequence);
+    if (s->out.par_ciphers) {
+        ssh2_bpp_crypt_job *job = ssh2_bpp_par_new_job(
+            &s->out, pkt->data, origlen + padding);
+        job->outgoing = true;
+        job->pkt = pkt;
+        ssh2_bpp_par_submit(s, &s->out, job);
+        ssh2_bpp_par_flush_out(s);
+        s->out.sequence++;
     } else {
-        /*
-         * SSH-2 standard protocol.
-         */
-        if (s->out.mac)
-            ssh2_mac_generate(s->out.mac, pkt->data, origlen + padding,
-                              s->out.sequence);
+        uint64_t crypt_start = perf_clock_ns();
+        ssh2_bpp_mac_and_encrypt(s->out.cipher, s->out.mac, s->out.etm_mode,
+                                 pkt->data, origlen + padding,
+                                 s->out.sequence);
+        ssh2_bpp_crypt_time(&s->bpp.perf.out, crypt_start);
+
+        s->out.sequence++;       /* whether or not we MACed */
         if (s->out.cipher)
-            ssh_cipher_encrypt(s->out.cipher, pkt->data, origlen + padding);
-    }
+            ssh_cipher_next_message(s->out.cipher);
+        if (s->out.mac)
+            ssh2_mac_next_message(s->out.mac);
 
-    s->out.sequence++;       /* whether or not we MACed */
-    if (s->out.cipher)
-        ssh_cipher_next_message(s->out.cipher);
-    if (s->out.mac)
-        ssh2_mac_next_message(s->out.mac);
+        bufchain_add(s->bpp.out_raw, pkt->data, pkt->length);
+        ssh_free_pktout(pkt);
+    }
 
     dts_consume(&s->stats->out, origlen + padding);
+    s->bpp.perf.out.packets++;
+    s->bpp.perf.out.bytes += origlen + padding + maclen;
 }
 
+static void ssh2_bpp_format_packet_inner(struct ssh2_bpp_state *s, PktOut *pkt)
+{
+    ssh2_bpp_log_outgoing(s, pkt);
+
+    if (s->out_comp) {
+        unsigned char *newpayload;
+        int newlen;
+
+        /*
+         * Compress packet payload.
+         */
+        ssh_compressor_compress(s->out_comp, pkt->data + 5, pkt->length - 5,
+                                &newpayload, &newlen,
+                                ssh2_bpp_comp_minlen(s, pkt));
+        pkt->length = 5;
+        put_data(pkt, newpayload, newlen);
+        sfree(newpayload);
+    }
+
+    ssh2_bpp_send_packet(s, pkt);
+}
+
+/*
+ * Format and send a packet, taking ownership of it.
+ */
 static void ssh2_bpp_format_packet(struct ssh2_bpp_state *s, PktOut *pkt)
 {
     if (pkt->minlen > 0 && !s->out_comp) {
@@ -906,13 +1635,114 @@ static void ssh2_bpp_format_packet(struct ssh2_bpp_state *s, PktOut *pkt)
                 put_byte(ignore_pkt, 0);  /* make space for random padding */
             random_read(ignore_pkt->data + origlen, length);
             ssh2_bpp_format_packet_inner(s, ignore_pkt);
-            bufchain_add(s->bpp.out_raw, ignore_pkt->data, ignore_pkt->length);
-            ssh_free_pktout(ignore_pkt);
         }
     }
 
     ssh2_bpp_format_packet_inner(s, pkt);
-    bufchain_add(s->bpp.out_raw, pkt->data, pkt->length);
+}
+
+/*
+ * The pipeline through the compression worker. Packets are logged
+ * and compressed in the order they're submitted, and come back in
+ * the same order to be encrypted, so sequence numbers are assigned
+ * just as if we'd compressed them inline.
+ *
+ * Like out_raw, the pipeline doesn't count towards the backlog that
+ * throttles the channels, and isn't limited in length other than by
+ * their windows. (Holding packets back on out_pq instead would count
+ * against everything, so a bulk transfer would stop us reading
+ * interactive input.)
+ */
+static void ssh2_bpp_comp_job_run(void *vjob)
+{
+    ssh2_bpp_comp_job *job = (ssh2_bpp_comp_job *)vjob;
+    PktOut *pkt = job->pkt;
+    ssh_compressor_compress(job->comp, pkt->data + 5, pkt->length - 5,
+                            &job->payload, &job->payloadlen, job->minlen);
+}
+
+static void ssh2_bpp_comp_submit(struct ssh2_bpp_state *s, PktOut *pkt)
+{
+    if (!s->comp_worker)
+        s->comp_worker = worker_thread_new(
+            ssh2_bpp_comp_job_run, ssh2_bpp_worker_notify, s);
+
+    ssh2_bpp_log_outgoing(s, pkt);
+
+    ssh2_bpp_comp_job *job = snew(ssh2_bpp_comp_job);
+    job->comp = s->out_comp;
+    job->pkt = pkt;
+    job->minlen = ssh2_bpp_comp_minlen(s, pkt);
+    job->payload = NULL;
+    worker_thread_submit(s->comp_worker, job);
+    s->comp_inflight++;
+}
+
+static void ssh2_bpp_comp_finish(struct ssh2_bpp_state *s,
+                                 ssh2_bpp_comp_job *job)
+{
+    PktOut *pkt = job->pkt;
+
+    pkt->length = 5;
+    put_data(pkt, job->payload, job->payloadlen);
+    sfree(job->payload);
+    sfree(job);
+
+    ssh2_bpp_send_packet(s, pkt);
+    s->comp_inflight--;
+}
+
+/*
+ * Wait for the compression worker to finish everything we've given
+ * it, and send the results, so that the next packet can be formatted
+ * inline.
+ */
+static void ssh2_bpp_comp_drain(struct ssh2_bpp_state *s)
+{
+    ssh2_bpp_comp_job *job;
+
+    if (!s->comp_inflight)
+        return;
+
+    worker_thread_wait(s->comp_worker);
+    while ((job = worker_thread_collect(s->comp_worker)) != NULL)
+        ssh2_bpp_comp_finish(s, job);
+    assert(!s->comp_inflight);
+}
+
+static void ssh2_bpp_worker_notify(void *ctx)
+{
+    struct ssh2_bpp_state *s = (struct ssh2_bpp_state *)ctx;
+    bool sent = false;
+
+    if (s->comp_worker) {
+        ssh2_bpp_comp_job *job;
+
+        while ((job = worker_thread_collect(s->comp_worker)) != NULL) {
+            ssh2_bpp_comp_finish(s, job);
+            sent = true;
+        }
+    }
+
+    if (s->crypt_workers) {
+        ssh2_bpp_par_collect(s);
+        if (ssh2_bpp_par_flush_out(s))
+            sent = true;
+        if (s->in.par_head && s->in.par_head->done)
+            queue_idempotent_callback(&s->bpp.ic_in_raw);
+    }
+
+    if (s->decomp_worker && s->decomp_inflight) {
+        ssh2_bpp_decomp_job *job = worker_thread_collect(s->decomp_worker);
+        if (job) {
+            s->decomp_done = job;
+            s->decomp_inflight = false;
+            queue_idempotent_callback(&s->bpp.ic_in_raw);
+        }
+    }
+
+    if (sent)
+        ssh_sendbuffer_changed(s->bpp.ssh);
 }
 
 static void ssh2_bpp_handle_output(BinaryPacketProtocol *bpp)
@@ -920,15 +1750,23 @@ static void ssh2_bpp_handle_output(BinaryPacketProtocol *bpp)
     struct ssh2_bpp_state *s = container_of(bpp, struct ssh2_bpp_state, bpp);
     PktOut *pkt;
     int n_userauth;
+    bool sync = false;
 
     /*
-     * Count the userauth packets in the queue.
+     * Count the userauth packets in the queue. Also look for packets
+     * after which our caller expects everything to have been
+     * formatted by the time we return, because the keys are about to
+     * change or the connection is about to close.
      */
     n_userauth = 0;
     for (pkt = pq_first(&s->bpp.out_pq); pkt != NULL;
-         pkt = pq_next(&s->bpp.out_pq, pkt))
+         pkt = pq_next(&s->bpp.out_pq, pkt)) {
         if (userauth_range(pkt->type))
             n_userauth++;
+        if (pkt->type == SSH2_MSG_NEWKEYS ||
+            pkt->type == SSH2_MSG_DISCONNECT)
+            sync = true;
+    }
 
     if (s->pending_compression && !n_userauth) {
         /*
@@ -945,6 +1783,18 @@ static void ssh2_bpp_handle_output(BinaryPacketProtocol *bpp)
         return;
     }
 
+    /*
+     * Decide whether to send this batch of packets through the
+     * compression worker. We don't in the CBC case, because the
+     * workaround below needs to know exactly what has been sent; and
+     * if not, anything already in the pipeline has to go out before
+     * we format anything else.
+     */
+    bool threaded = (s->compress_in_thread && s->out_comp &&
+                     !s->cbc_ignore_workaround && !sync);
+    if (!threaded)
+        ssh2_bpp_comp_drain(s);
+
     if (s->cbc_ignore_workaround) {
         /*
          * When using a CBC-mode cipher in SSH-2, it's necessary to
@@ -976,8 +1826,12 @@ static void ssh2_bpp_handle_output(BinaryPacketProtocol *bpp)
         if (userauth_range(type))
             n_userauth--;
 
-        ssh2_bpp_format_packet(s, pkt);
-        ssh_free_pktout(pkt);
+        if (threaded) {
+            /* The packet now belongs to the pipeline */
+            ssh2_bpp_comp_submit(s, pkt);
+        } else {
+            ssh2_bpp_format_packet(s, pkt);
+        }
 
         if (n_userauth == 0 && s->out.pending_compression && !s->is_server) {
             /*
@@ -994,5 +1848,8 @@ static void ssh2_bpp_handle_output(BinaryPacketProtocol *bpp)
         }
     }
 
+    if (sync)
+        ssh2_bpp_par_drain_out(s);
+
     ssh_sendbuffer_changed(bpp->ssh);
 }
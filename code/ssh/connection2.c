@@ -543,6 +543,8 @@ static bool ssh2_connection_filter_queue(struct ssh2_connection_state *s)
                     int bufsize;
                     c->locwindow -= data.len;
                     c->remlocwin -= data.len;
+                    c->perf.packets_in++;
+                    c->perf.bytes_in += data.len;
                     if (ext_type != 0 && ext_type != SSH2_EXTENDED_DATA_STDERR)
                         data.len = 0; /* ignore unknown extended data */
                     bufsize = chan_send(
@@ -565,10 +567,12 @@ static bool ssh2_connection_filter_queue(struct ssh2_connection_state *s)
                      * its window, and we didn't want it to do that,
                      * think about using a larger window.
                      */
-                    if (c->remlocwin <= 0 &&
-                        c->throttle_state == UNTHROTTLED &&
-                        c->locmaxwin < 0x40000000)
-                        c->locmaxwin += OUR_V2_WINSIZE;
+                    if (c->remlocwin <= 0) {
+                        c->perf.window_stalls++;
+                        if (c->throttle_state == UNTHROTTLED &&
+                            c->locmaxwin < 0x40000000)
+                            c->locmaxwin += OUR_V2_WINSIZE;
+                    }
 
                     /*
                      * If we are not buffering too much data, enlarge
@@ -861,6 +865,17 @@ static bool ssh2_connection_filter_queue(struct ssh2_connection_state *s)
     }
 }
 
+static void ssh2_channel_set_throttle_state(struct ssh2_channel *c,
+                                            int newstate)
+{
+    /* Keep the perf counter of time spent throttled up to date. */
+    if (c->throttle_state == UNTHROTTLED && newstate != UNTHROTTLED)
+        c->perf.throttled_since = GETTICKCOUNT();
+    else if (c->throttle_state != UNTHROTTLED && newstate == UNTHROTTLED)
+        c->perf.throttled_ms += GETTICKCOUNT() - c->perf.throttled_since;
+    c->throttle_state = newstate;
+}
+
 static void ssh2_handle_winadj_response(struct ssh2_channel *c,
                                         PktIn *pktin, void *ctx)
 {
@@ -882,7 +897,7 @@ static void ssh2_handle_winadj_response(struct ssh2_channel *c,
      * complete.
      */
     if (c->throttle_state == UNTHROTTLING)
-        c->throttle_state = UNTHROTTLED;
+        ssh2_channel_set_throttle_state(c, UNTHROTTLED);
 }
 
 static void ssh2_set_window(struct ssh2_channel *c, int newwin)
@@ -945,11 +960,11 @@ static void ssh2_set_window(struct ssh2_channel *c, int newwin)
             pq_push(s->ppl.out_pq, pktout);
 
             if (c->throttle_state != UNTHROTTLED)
-                c->throttle_state = UNTHROTTLING;
+                ssh2_channel_set_throttle_state(c, UNTHROTTLING);
         } else {
             /* Pretend the WINDOW_ADJUST was acked immediately. */
             c->remlocwin = newwin;
-            c->throttle_state = THROTTLED;
+            ssh2_channel_set_throttle_state(c, THROTTLED);
         }
         pktout = ssh_bpp_new_pktout(s->ppl.bpp, SSH2_MSG_CHANNEL_WINDOW_ADJUST);
         put_uint32(pktout, c->remoteid);
@@ -1140,6 +1155,8 @@ static size_t ssh2_try_send(struct ssh2_channel *c)
             pq_push(s->ppl.out_pq, pktout);
             bufchain_consume(buf, data.len);
             c->remwindow -= data.len;
+            c->perf.packets_out++;
+            c->perf.bytes_out += data.len;
         }
     }
 
@@ -1149,6 +1166,18 @@ static size_t ssh2_try_send(struct ssh2_channel *c)
      */
     bufsize = bufchain_size(&c->outbuffer) + bufchain_size(&c->errbuffer);
 
+    /*
+     * Count each separate occasion on which we were left holding data
+     * because the remote window ran out.
+     */
+    if (bufsize && !c->halfopen && c->remwindow == 0) {
+        if (!c->perf.stalled_on_remwindow)
+            c->perf.remwindow_exhausted++;
+        c->perf.stalled_on_remwindow = true;
+    } else {
+        c->perf.stalled_on_remwindow = false;
+    }
+
     /*
      * And if there's no data pending but we need to send an EOF, send
      * it.
@@ -1291,6 +1320,7 @@ void ssh2_channel_init(struct ssh2_channel *c)
         s->ssh_is_simple ? OUR_V2_BIGWIN : OUR_V2_WINSIZE;
     c->chanreq_head = NULL;
     c->throttle_state = UNTHROTTLED;
+    memset(&c->perf, 0, sizeof(c->perf));
     bufchain_init(&c->outbuffer);
     bufchain_init(&c->errbuffer);
     c->sc.vt = &ssh2channel_vtable;
@@ -1613,6 +1643,54 @@ static bool ssh2_connection_get_specials(
     return toret;
 }
 
+/*
+ * Write the per-channel performance counters to the Event Log as a
+ * single JSON object, along with their totals over all channels.
+ */
+static void ssh2_connection_log_stats(struct ssh2_connection_state *s)
+{
+    PacketProtocolLayer *ppl = &s->ppl; /* for ppl_logevent */
+    struct ssh2_channel *c;
+    uint64_t total_in = 0, total_out = 0;
+    size_t total_buffered = 0;
+    unsigned long now = GETTICKCOUNT();
+    const char *sep = "";
+    strbuf *sb = strbuf_new();
+
+    put_fmt(sb, "{\"layer\":\"connection\",\"channels\":[");
+    for (int i = 0; (c = index234(s->channels, i)) != NULL; i++) {
+        size_t buffered = (bufchain_size(&c->outbuffer) +
+                           bufchain_size(&c->errbuffer));
+        unsigned long throttled_ms = c->perf.throttled_ms;
+        if (c->throttle_state != UNTHROTTLED)
+            throttled_ms += now - c->perf.throttled_since;
+
+        put_fmt(sb, "%s{\"localid\":%u,\"remoteid\":%u,\"shared\":%s"
+                ",\"packets_in\":%lu,\"bytes_in\":%"PRIu64
+                ",\"packets_out\":%lu,\"bytes_out\":%"PRIu64, sep,
+                c->localid, c->remoteid, c->sharectx ? "true" : "false",
+                c->perf.packets_in, c->perf.bytes_in,
+                c->perf.packets_out, c->perf.bytes_out);
+        put_fmt(sb, ",\"buffered\":%"SIZEu",\"remwindow\":%u"
+                ",\"locwindow\":%d,\"throttled_ms\":%lu"
+                ",\"window_stalls\":%lu,\"remwindow_exhausted\":%lu}",
+                buffered, c->remwindow, c->locwindow, throttled_ms,
+                c->perf.window_stalls, c->perf.remwindow_exhausted);
+
+        total_in += c->perf.bytes_in;
+        total_out += c->perf.bytes_out;
+        total_buffered += buffered;
+        sep = ",";
+    }
+    put_fmt(sb, "],\"bytes_in\":%"PRIu64",\"bytes_out\":%"PRIu64
+            ",\"buffered\":%"SIZEu",\"throttled\":%s}",
+            total_in, total_out, total_buffered,
+            s->all_channels_throttled ? "true" : "false");
+
+    ppl_logevent("Performance statistics: %s", sb->s);
+    strbuf_free(sb);
+}
+
 static void ssh2_connection_special_cmd(PacketProtocolLayer *ppl,
                                         SessionSpecialCode code, int arg)
 {
@@ -1626,6 +1704,8 @@ static void ssh2_connection_special_cmd(PacketProtocolLayer *ppl,
             put_stringz(pktout, "");
             pq_push(s->ppl.out_pq, pktout);
         }
+    } else if (code == SS_STATS) {
+        ssh2_connection_log_stats(s);
     } else if (s->mainchan) {
         mainchan_special_cmd(s->mainchan, code, arg);
     }
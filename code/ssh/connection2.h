@@ -120,6 +120,21 @@ struct ssh2_channel {
 
     enum { THROTTLED, UNTHROTTLING, UNTHROTTLED } throttle_state;
 
+    /*
+     * Performance counters for this channel, reported by SS_STATS.
+     * 'throttled_since' is the GETTICKCOUNT value at which
+     * throttle_state last left UNTHROTTLED, and 'throttled_ms' the
+     * total time spent away from UNTHROTTLED before that.
+     */
+    struct {
+        uint64_t bytes_in, bytes_out;
+        unsigned long packets_in, packets_out;
+        unsigned long throttled_since, throttled_ms;
+        unsigned long window_stalls;
+        unsigned long remwindow_exhausted;
+        bool stalled_on_remwindow;
+    } perf;
+
     ssh_sharing_connstate *sharectx; /* sharing context, if this is a
                                       * downstream channel */
     Channel *chan;      /* handle the client side of this channel, if not */
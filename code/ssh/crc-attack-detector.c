@@ -31,10 +31,8 @@
 
 /* Hashing constants */
 #define HASH_MINSIZE    (8 * 1024)
-#define HASH_ENTRYSIZE  (sizeof(uint16_t))
+#define HASH_ENTRYSIZE  (sizeof(struct crcda_entry))
 #define HASH_FACTOR(x)  ((x)*3/2)
-#define HASH_UNUSEDCHAR (0xff)
-#define HASH_UNUSED     (0xffff)
 #define HASH_IV         (0xfffe)
 
 #define HASH_MINBLOCKS  (7*SSH_BLOCKSIZE)
@@ -47,9 +45,30 @@
 static const uint8_t ONE[4] = { 1, 0, 0, 0 };
 static const uint8_t ZERO[4] = { 0, 0, 0, 0 };
 
+/*
+ * PuTTY's version of the hash table differs from the original in two
+ * ways, both to cut down on memory traffic for each packet.
+ *
+ * Each entry stores the hash key (the first word of the block)
+ * alongside the block index, so that a probe which hits an entry for
+ * a different block can usually reject it without having to go back
+ * to the packet data to compare.
+ *
+ * And instead of wiping the whole table before every packet, each
+ * entry records the 'generation' (i.e. packet) it was written in,
+ * and entries from any other generation count as empty. The table
+ * only needs wiping when the generation counter wraps.
+ */
+struct crcda_entry {
+    uint32_t key;
+    uint16_t index;                    /* block index, or HASH_IV */
+    uint16_t gen;                      /* 0 is never a live generation */
+};
+
 struct crcda_ctx {
-    uint16_t *h;
+    struct crcda_entry *h;
     uint32_t n;
+    uint16_t gen;
 };
 
 struct crcda_ctx *crcda_make_context(void)
@@ -57,6 +76,7 @@ struct crcda_ctx *crcda_make_context(void)
     struct crcda_ctx *ret = snew(struct crcda_ctx);
     ret->h = NULL;
     ret->n = HASH_MINSIZE / HASH_ENTRYSIZE;
+    ret->gen = 0;
     return ret;
 }
 
@@ -104,23 +124,24 @@ bool detect_attack(struct crcda_ctx *ctx,
                    const unsigned char *IV)
 {
     register uint32_t i, j;
-    uint32_t l;
+    uint32_t l, mask;
+    uint16_t gen;
     register const uint8_t *c;
     const uint8_t *d;
 
     assert(!(len > (SSH_MAXBLOCKS * SSH_BLOCKSIZE) ||
              len % SSH_BLOCKSIZE != 0));
-    for (l = ctx->n; l < HASH_FACTOR(len / SSH_BLOCKSIZE); l = l << 2)
+    for (l = HASH_MINSIZE / HASH_ENTRYSIZE;
+         l < HASH_FACTOR(len / SSH_BLOCKSIZE); l = l << 2)
         ;
 
-    if (ctx->h == NULL) {
+    if (ctx->h == NULL || l > ctx->n) {
+        /* Allocate fresh; nothing in the old table needs keeping. */
+        sfree(ctx->h);
         ctx->n = l;
-        ctx->h = snewn(ctx->n, uint16_t);
-    } else {
-        if (l > ctx->n) {
-            ctx->n = l;
-            ctx->h = sresize(ctx->h, ctx->n, uint16_t);
-        }
+        ctx->h = snewn(ctx->n, struct crcda_entry);
+        memset(ctx->h, 0, ctx->n * HASH_ENTRYSIZE);
+        ctx->gen = 0;
     }
 
     if (len <= HASH_MINBLOCKS) {
@@ -142,15 +163,36 @@ bool detect_attack(struct crcda_ctx *ctx,
         }
         return false;                  /* ok */
     }
-    memset(ctx->h, HASH_UNUSEDCHAR, ctx->n * HASH_ENTRYSIZE);
 
-    if (IV)
-        ctx->h[HASH(IV) & (ctx->n - 1)] = HASH_IV;
+    /*
+     * Start a new generation, which implicitly empties the table. We
+     * also only use as much of the table as this packet needs, so
+     * that a small packet after a large one doesn't have its entries
+     * spread thinly over a table much larger than the cache.
+     */
+    if (++ctx->gen == 0) {
+        memset(ctx->h, 0, ctx->n * HASH_ENTRYSIZE);
+        ctx->gen = 1;
+    }
+    gen = ctx->gen;
+    mask = l - 1;
+
+    if (IV) {
+        i = HASH(IV) & mask;
+        ctx->h[i].key = HASH(IV);
+        ctx->h[i].index = HASH_IV;
+        ctx->h[i].gen = gen;
+    }
 
     for (c = buf, j = 0; c < (buf + len); c += SSH_BLOCKSIZE, j++) {
-        for (i = HASH(c) & (ctx->n - 1); ctx->h[i] != HASH_UNUSED;
-             i = (i + 1) & (ctx->n - 1)) {
-            if (ctx->h[i] == HASH_IV) {
+        uint32_t key = HASH(c);
+        struct crcda_entry *e;
+
+        for (i = key & mask; (e = &ctx->h[i])->gen == gen;
+             i = (i + 1) & mask) {
+            if (e->key != key)
+                continue;              /* can't be the same block */
+            if (e->index == HASH_IV) {
                 assert(IV); /* or we wouldn't have stored HASH_IV above */
                 if (!CMP(c, IV)) {
                     if (check_crc(c, buf, len, IV))
@@ -158,14 +200,16 @@ bool detect_attack(struct crcda_ctx *ctx,
                     else
                         break;
                 }
-            } else if (!CMP(c, buf + ctx->h[i] * SSH_BLOCKSIZE)) {
+            } else if (!CMP(c, buf + e->index * SSH_BLOCKSIZE)) {
                 if (check_crc(c, buf, len, IV))
                     return true;          /* attack detected */
                 else
                     break;
             }
         }
-        ctx->h[i] = j;
+        e->key = key;
+        e->index = j;
+        e->gen = gen;
     }
     return false;                          /* ok */
 }
@@ -103,7 +103,7 @@ void ssh2kex_coroutine(struct ssh2_transport_state *s, bool *aborted)
                          ssh_hash_alg(s->exhash)->text_name);
         } else {
             s->ppl.bpp->pls->kctx = SSH2_PKTCTX_DHGROUP;
-            s->dh_ctx = dh_setup_group(s->kex_alg);
+            s->dh_ctx = ssh2_transport_dh_setup_group(s);
             s->kex_init_value = SSH2_MSG_KEXDH_INIT;
             s->kex_reply_value = SSH2_MSG_KEXDH_REPLY;
 
@@ -192,7 +192,7 @@ void ssh2kex_coroutine(struct ssh2_transport_state *s, bool *aborted)
 
         s->ppl.bpp->pls->kctx = SSH2_PKTCTX_ECDHKEX;
 
-        s->ecdh_key = ecdh_key_new(s->kex_alg, false);
+        s->ecdh_key = ssh2_transport_ecdh_key_new(s, false);
 
         pktout = ssh_bpp_new_pktout(s->ppl.bpp, SSH2_MSG_KEX_ECDH_INIT);
         {
@@ -280,7 +280,7 @@ void ssh2kex_coroutine(struct ssh2_transport_state *s, bool *aborted)
         assert(!s->dh_ctx);
 
         if (s->kex_alg->main_type == KEXTYPE_GSS_ECDH) {
-            s->ecdh_key = ecdh_key_new(s->kex_alg, false);
+            s->ecdh_key = ssh2_transport_ecdh_key_new(s, false);
 
             char *desc = ecdh_keyalg_description(s->kex_alg);
             ppl_logevent("Doing GSSAPI (with Kerberos V5) %s with hash %s",
@@ -323,7 +323,7 @@ void ssh2kex_coroutine(struct ssh2_transport_state *s, bool *aborted)
             }
             s->dh_ctx = dh_setup_gex(s->p, s->g);
         } else {
-            s->dh_ctx = dh_setup_group(s->kex_alg);
+            s->dh_ctx = ssh2_transport_dh_setup_group(s);
             ppl_logevent("Using GSSAPI (with Kerberos V5) Diffie-Hellman with"
                          " standard group \"%s\" and hash %s",
                          s->kex_alg->groupname,
@@ -115,7 +115,7 @@ void ssh2kex_coroutine(struct ssh2_transport_state *s, bool *aborted)
             pq_push(s->ppl.out_pq, pktout);
         } else {
             s->ppl.bpp->pls->kctx = SSH2_PKTCTX_DHGROUP;
-            s->dh_ctx = dh_setup_group(s->kex_alg);
+            s->dh_ctx = ssh2_transport_dh_setup_group(s);
             s->kex_init_value = SSH2_MSG_KEXDH_INIT;
             s->kex_reply_value = SSH2_MSG_KEXDH_REPLY;
             ppl_logevent("Using Diffie-Hellman with standard group \"%s\"",
@@ -196,7 +196,7 @@ void ssh2kex_coroutine(struct ssh2_transport_state *s, bool *aborted)
                      ssh_hash_alg(s->exhash)->text_name);
         sfree(desc);
 
-        s->ecdh_key = ecdh_key_new(s->kex_alg, true);
+        s->ecdh_key = ssh2_transport_ecdh_key_new(s, true);
         if (!s->ecdh_key) {
             ssh_sw_abort(s->ppl.ssh, "Unable to generate key for ECDH");
             *aborted = true;
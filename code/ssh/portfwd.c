@@ -513,6 +513,22 @@ void portfwd_raw_setup(Channel *pfchan, Socket *s, SshChannel *sc)
     pf->c = sc;
 }
 
+/*
+ * Return the local Socket underlying a raw port forwarding, provided
+ * it has finished any SOCKS negotiation and isn't holding back any
+ * data of its own; otherwise NULL.
+ */
+Socket *portfwd_raw_socket(Channel *pfchan)
+{
+    struct PortForwarding *pf;
+    assert(pfchan->vt == &PortForwarding_channelvt);
+    pf = container_of(pfchan, struct PortForwarding, chan);
+
+    if (!pf->ready || pf->socksbuf || pf->socks_state != SOCKS_NONE)
+        return NULL;
+    return pf->s;
+}
+
 /*
  * called when someone connects to the local port
  */
@@ -334,6 +334,13 @@ static void scp_reply_attrs(
     reply->attrs = attrs;
 }
 
+static void scp_reply_extended(SftpReplyBuilder *srb, ptrlen data)
+{
+    /* SCP never sends an extended request, so needs no data from one */
+    ScpReplyReceiver *reply = container_of(srb, ScpReplyReceiver, srb);
+    reply->err = false;
+}
+
 static const SftpReplyBuilderVtable ScpReplyReceiver_vt = {
     .reply_ok = scp_reply_ok,
     .reply_error = scp_reply_error,
@@ -343,6 +350,7 @@ static const SftpReplyBuilderVtable ScpReplyReceiver_vt = {
     .reply_handle = scp_reply_handle,
     .reply_data = scp_reply_data,
     .reply_attrs = scp_reply_attrs,
+    .reply_extended = scp_reply_extended,
 };
 
 static void scp_reply_setup(ScpReplyReceiver *reply)
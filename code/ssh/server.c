@@ -199,6 +199,12 @@ void ssh_sendbuffer_changed(Ssh *ssh)
 {
 }
 
+bool ssh_get_io_stats(Ssh *ssh, SocketIOStats *stats)
+{
+    server *srv = container_of(ssh, server, ssh);
+    return srv->socket && sk_get_io_stats(srv->socket, stats);
+}
+
 void ssh_throttle_conn(Ssh *ssh, int adjust)
 {
     server *srv = container_of(ssh, server, ssh);
@@ -391,6 +397,8 @@ static void server_bpp_output_raw_data_callback(void *vctx)
     if (!srv->socket)
         return;
 
+    sk_set_corked(srv->socket, true);  /* see ssh.c */
+
     while (bufchain_size(&srv->out_raw) > 0) {
         size_t backlog;
 
@@ -404,6 +412,7 @@ static void server_bpp_output_raw_data_callback(void *vctx)
         bufchain_consume(&srv->out_raw, data.len);
 
         if (backlog > SSH_MAX_BACKLOG) {
+            sk_set_corked(srv->socket, false);
 #ifdef FIXME
             ssh_throttle_all(ssh, 1, backlog);
 #endif
@@ -411,6 +420,8 @@ static void server_bpp_output_raw_data_callback(void *vctx)
         }
     }
 
+    sk_set_corked(srv->socket, false);
+
     if (srv->pending_close) {
         sk_close(srv->socket);
         srv->socket = NULL;
@@ -532,6 +543,14 @@ static void server_got_ssh_version(struct ssh_version_receiver *rcv,
         PacketProtocolLayer *userauth_layer, *transport_child_layer;
 
         srv->bpp = ssh2_bpp_new(srv->logctx, &srv->stats, true);
+        if (conf_get_bool(srv->conf, CONF_compress_in_thread))
+            ssh2_bpp_compress_in_thread(srv->bpp);
+        /* More cipher workers than CPUs would only add overhead */
+        int cipher_threads = conf_get_int(srv->conf, CONF_cipher_threads);
+        if (cipher_threads > 0)
+            ssh2_bpp_parallel_crypto(
+                srv->bpp, min((unsigned)cipher_threads,
+                              worker_thread_cpus()));
         server_connect_bpp(srv);
 
         connection_layer = ssh2_connection_new(
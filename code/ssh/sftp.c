@@ -16,6 +16,7 @@ static const char *fxp_error_message;
 static int fxp_errtype;
 
 static void fxp_internal_error(const char *msg);
+static void fxp_free_extensions(void);
 
 /* ----------------------------------------------------------------------
  * Client-specific parts of the send- and receive-packet system.
@@ -154,6 +155,7 @@ void sftp_cleanup_request(void)
         freetree234(sftp_requests);
         sftp_requests = NULL;
     }
+    fxp_free_extensions();
 }
 
 void sftp_register(struct sftp_request *req)
@@ -188,6 +190,31 @@ struct sftp_request *sftp_find_request(struct sftp_packet *pktin)
     return req;
 }
 
+/*
+ * Find the user data of the registered request a packet is a reply
+ * to, without consuming anything from the packet, so that a caller
+ * can decide whose packet it is before handing it on.
+ */
+void *sftp_peek_userdata(struct sftp_packet *pktin)
+{
+    BinarySource src[1];
+    struct sftp_request *req;
+    unsigned id;
+
+    BinarySource_BARE_INIT(
+        src, (const char *)BinarySource_UPCAST(pktin)->data +
+        BinarySource_UPCAST(pktin)->pos,
+        BinarySource_UPCAST(pktin)->len - BinarySource_UPCAST(pktin)->pos);
+    id = get_uint32(src);
+    if (get_err(src) || !sftp_requests)
+        return NULL;
+
+    req = find234(sftp_requests, &id, sftp_reqfind);
+    if (!req || !req->registered)
+        return NULL;
+    return req->userdata;
+}
+
 /* ----------------------------------------------------------------------
  * SFTP primitives.
  */
@@ -254,6 +281,120 @@ int fxp_error_type(void)
     return fxp_errtype;
 }
 
+/*
+ * The extensions the server told us about in FXP_VERSION.
+ */
+struct fxp_extension {
+    char *name, *data;
+};
+
+static tree234 *fxp_extensions;
+
+/*
+ * The most data we put in one FXP_WRITE or ask for in one FXP_READ.
+ * The SFTP drafts require servers to accept packets of up to 34000
+ * bytes, so 32768 bytes of data is the most that is always safe; but
+ * if the server tells us its limits, we can use those, up to a size
+ * that comfortably fits in the largest packet we'll receive.
+ */
+#define FXP_DEFAULT_DATA 32768
+#define FXP_MAX_DATA (256 * 1024)
+static int fxp_max_read = FXP_DEFAULT_DATA;
+static int fxp_max_write = FXP_DEFAULT_DATA;
+
+static int fxp_extension_cmp(void *av, void *bv)
+{
+    struct fxp_extension *a = (struct fxp_extension *)av;
+    struct fxp_extension *b = (struct fxp_extension *)bv;
+    return strcmp(a->name, b->name);
+}
+
+static int fxp_extension_find(void *av, void *bv)
+{
+    const char *a = (const char *)av;
+    struct fxp_extension *b = (struct fxp_extension *)bv;
+    return strcmp(a, b->name);
+}
+
+static void fxp_free_extensions(void)
+{
+    struct fxp_extension *ext;
+
+    if (!fxp_extensions)
+        return;
+    while ((ext = delpos234(fxp_extensions, 0)) != NULL) {
+        sfree(ext->name);
+        sfree(ext->data);
+        sfree(ext);
+    }
+    freetree234(fxp_extensions);
+    fxp_extensions = NULL;
+}
+
+const char *fxp_extension(const char *name)
+{
+    struct fxp_extension *ext;
+
+    if (!fxp_extensions)
+        return NULL;
+    ext = find234(fxp_extensions, (void *)name, fxp_extension_find);
+    return ext ? ext->data : NULL;
+}
+
+static int fxp_limit(uint64_t limit)
+{
+    if (limit == 0 || limit > FXP_MAX_DATA)
+        return FXP_MAX_DATA;           /* 0 means no limit */
+    if (limit < FXP_DEFAULT_DATA)
+        return FXP_DEFAULT_DATA;       /* we're entitled to this much */
+    return limit;
+}
+
+/*
+ * Ask the server for its limits@openssh.com limits, during startup
+ * when nothing else can be outstanding. Returns false if we lost the
+ * connection, or if the reply wasn't to our request, in which case
+ * the server and we no longer agree on what's going on.
+ */
+static bool fxp_get_limits(void)
+{
+    struct sftp_request *req = sftp_alloc_request();
+    struct sftp_packet *pktout, *pktin;
+
+    pktout = sftp_pkt_init(SSH_FXP_EXTENDED);
+    put_uint32(pktout, req->id);
+    put_stringz(pktout, SFTP_EXT_LIMITS);
+    sftp_send(pktout);
+    sftp_register(req);
+
+    pktin = sftp_recv();
+    if (!pktin) {
+        fxp_internal_error("could not connect");
+        return false;
+    }
+    if (sftp_find_request(pktin) != req) {
+        /* Ours is the only request outstanding, so
+         * sftp_find_request found nothing, and has set fxp_error */
+        del234(sftp_requests, req);
+        sfree(req);
+        sftp_pkt_free(pktin);
+        return false;
+    }
+    sfree(req);
+
+    if (pktin->type == SSH_FXP_EXTENDED_REPLY) {
+        get_uint64(pktin);             /* max packet length */
+        uint64_t max_read = get_uint64(pktin);
+        uint64_t max_write = get_uint64(pktin);
+        if (!get_err(pktin)) {
+            fxp_max_read = fxp_limit(max_read);
+            fxp_max_write = fxp_limit(max_write);
+        }
+    }
+    sftp_pkt_free(pktin);
+    return true;
+}
+
 /*
  * Perform exchange of init/version packets. Return 0 on failure.
  */
@@ -287,14 +428,33 @@ bool fxp_init(void)
         sftp_pkt_free(pktin);
         return false;
     }
+
     /*
-     * In principle, this packet might also contain extension-
-     * string pairs. We should work through them and look for any
-     * we recognise. In practice we don't currently do so because
-     * we know we don't recognise _any_.
+     * The rest of the packet is extension-name/data pairs. Keep
+     * them all, so that other code can ask about the ones it cares
+     * about.
      */
+    fxp_free_extensions();
+    fxp_extensions = newtree234(fxp_extension_cmp);
+    while (get_avail(pktin)) {
+        ptrlen name = get_string(pktin), data = get_string(pktin);
+        if (get_err(pktin))
+            break;
+        struct fxp_extension *ext = snew(struct fxp_extension);
+        ext->name = mkstr(name);
+        ext->data = mkstr(data);
+        if (add234(fxp_extensions, ext) != ext) {
+            sfree(ext->name);
+            sfree(ext->data);
+            sfree(ext);
+        }
+    }
     sftp_pkt_free(pktin);
 
+    fxp_max_read = fxp_max_write = FXP_DEFAULT_DATA;
+    if (fxp_extension(SFTP_EXT_LIMITS) && !fxp_get_limits())
+        return false;
+
     return true;
 }
 
@@ -822,6 +982,141 @@ bool fxp_write_recv(struct sftp_packet *pktin, struct sftp_request *req)
     return fxp_errtype == SSH_FX_OK;
 }
 
+/*
+ * Hash ranges of a file on the server.
+ */
+struct sftp_request *fxp_check_file_send(
+    struct fxp_handle *handle, const char *algs, uint64_t offset,
+    uint64_t length, unsigned blocksize)
+{
+    struct sftp_request *req = sftp_alloc_request();
+    struct sftp_packet *pktout;
+
+    pktout = sftp_pkt_init(SSH_FXP_EXTENDED);
+    put_uint32(pktout, req->id);
+    put_stringz(pktout, SFTP_EXT_CHECK_FILE_HANDLE);
+    put_string(pktout, handle->hstring, handle->hlen);
+    put_stringz(pktout, algs);
+    put_uint64(pktout, offset);
+    put_uint64(pktout, length);
+    put_uint32(pktout, blocksize);
+    sftp_send(pktout);
+
+    return req;
+}
+
+bool fxp_check_file_recv(struct sftp_packet *pktin, struct sftp_request *req,
+                         char **alg, strbuf *out)
+{
+    sfree(req);
+    if (pktin->type == SSH_FXP_EXTENDED_REPLY) {
+        ptrlen algname = get_string(pktin);
+        if (get_err(pktin)) {
+            fxp_internal_error("malformed FXP_EXTENDED_REPLY packet");
+            sftp_pkt_free(pktin);
+            return false;
+        }
+        *alg = mkstr(algname);
+        put_datapl(out, get_data(pktin, get_avail(pktin)));
+        sftp_pkt_free(pktin);
+        return true;
+    } else {
+        fxp_got_status(pktin);
+        sftp_pkt_free(pktin);
+        return false;
+    }
+}
+
+struct sftp_request *fxp_block_sums_send(
+    struct fxp_handle *handle, uint64_t offset, uint64_t length,
+    unsigned blocksize)
+{
+    struct sftp_request *req = sftp_alloc_request();
+    struct sftp_packet *pktout;
+
+    pktout = sftp_pkt_init(SSH_FXP_EXTENDED);
+    put_uint32(pktout, req->id);
+    put_stringz(pktout, SFTP_EXT_BLOCK_SUMS);
+    put_string(pktout, handle->hstring, handle->hlen);
+    put_uint64(pktout, offset);
+    put_uint64(pktout, length);
+    put_uint32(pktout, blocksize);
+    sftp_send(pktout);
+
+    return req;
+}
+
+bool fxp_block_sums_recv(struct sftp_packet *pktin, struct sftp_request *req,
+                         strbuf *out)
+{
+    sfree(req);
+    if (pktin->type == SSH_FXP_EXTENDED_REPLY) {
+        if (get_avail(pktin) % SFTP_BLOCK_SUM_LEN) {
+            fxp_internal_error("malformed FXP_EXTENDED_REPLY packet");
+            sftp_pkt_free(pktin);
+            return false;
+        }
+        put_datapl(out, get_data(pktin, get_avail(pktin)));
+        sftp_pkt_free(pktin);
+        return true;
+    } else {
+        fxp_got_status(pktin);
+        sftp_pkt_free(pktin);
+        return false;
+    }
+}
+
+struct sftp_request *fxp_check_file_name_send(
+    const char *fname, const char *algs, uint64_t offset,
+    uint64_t length, unsigned blocksize)
+{
+    struct sftp_request *req = sftp_alloc_request();
+    struct sftp_packet *pktout;
+
+    pktout = sftp_pkt_init(SSH_FXP_EXTENDED);
+    put_uint32(pktout, req->id);
+    put_stringz(pktout, SFTP_EXT_CHECK_FILE_NAME);
+    put_stringz(pktout, fname);
+    put_stringz(pktout, algs);
+    put_uint64(pktout, offset);
+    put_uint64(pktout, length);
+    put_uint32(pktout, blocksize);
+    sftp_send(pktout);
+
+    return req;
+}
+
+/*
+ * Copy data between two files on the server.
+ */
+struct sftp_request *fxp_copy_data_send(
+    struct fxp_handle *src, uint64_t srcoffset, uint64_t length,
+    struct fxp_handle *dst, uint64_t dstoffset)
+{
+    struct sftp_request *req = sftp_alloc_request();
+    struct sftp_packet *pktout;
+
+    pktout = sftp_pkt_init(SSH_FXP_EXTENDED);
+    put_uint32(pktout, req->id);
+    put_stringz(pktout, SFTP_EXT_COPY_DATA);
+    put_string(pktout, src->hstring, src->hlen);
+    put_uint64(pktout, srcoffset);
+    put_uint64(pktout, length);
+    put_string(pktout, dst->hstring, dst->hlen);
+    put_uint64(pktout, dstoffset);
+    sftp_send(pktout);
+
+    return req;
+}
+
+bool fxp_copy_data_recv(struct sftp_packet *pktin, struct sftp_request *req)
+{
+    sfree(req);
+    fxp_got_status(pktin);
+    sftp_pkt_free(pktin);
+    return fxp_errtype == SSH_FX_OK;
+}
+
 /*
  * Free up an fxp_names structure.
  */
@@ -860,6 +1155,17 @@ void fxp_free_name(struct fxp_name *name)
     sfree(name);
 }
 
+/*
+ * qsort comparison routine for fxp_name structures. Sorts by real
+ * file name.
+ */
+int sftp_name_compare(const void *av, const void *bv)
+{
+    const struct fxp_name *const *a = (const struct fxp_name *const *) av;
+    const struct fxp_name *const *b = (const struct fxp_name *const *) bv;
+    return strcmp((*a)->filename, (*b)->filename);
+}
+
 /*
  * Store user data in an sftp_request structure.
  */
@@ -891,6 +1197,7 @@ struct fxp_xfer {
     bool eof, err;
     struct fxp_handle *fh;
     struct req *head, *tail;
+    uint64_t nrequests;
 };
 
 static struct fxp_xfer *xfer_init(struct fxp_handle *fh, uint64_t offset)
@@ -905,6 +1212,7 @@ static struct fxp_xfer *xfer_init(struct fxp_handle *fh, uint64_t offset)
     xfer->err = false;
     xfer->filesize = UINT64_MAX;
     xfer->furthestdata = 0;
+    xfer->nrequests = 0;
 
     return xfer;
 }
@@ -941,13 +1249,14 @@ void xfer_download_queue(struct fxp_xfer *xfer)
         xfer->tail = rr;
         rr->next = NULL;
 
-        rr->len = 32768;
+        rr->len = fxp_max_read;
         rr->buffer = snewn(rr->len, char);
         sftp_register(req = fxp_read_send(xfer->fh, rr->offset, rr->len));
         fxp_set_userdata(req, rr);
 
         xfer->offset += rr->len;
         xfer->req_totalsize += rr->len;
+        xfer->nrequests++;
 
 #ifdef DEBUG_DOWNLOAD
         printf("queueing read request %p at %"PRIu64"\n", rr, rr->offset);
@@ -1046,6 +1355,11 @@ int xfer_download_gotpkt(struct fxp_xfer *xfer, struct sftp_packet *pktin)
     return 1;
 }
 
+uint64_t xfer_requests(struct fxp_xfer *xfer)
+{
+    return xfer->nrequests;
+}
+
 void xfer_set_error(struct fxp_xfer *xfer)
 {
     xfer->err = true;
@@ -1114,36 +1428,47 @@ bool xfer_upload_ready(struct fxp_xfer *xfer)
     return sftp_sendbuffer() == 0;
 }
 
+/*
+ * Queue write requests for a buffer of data, which may be any size:
+ * it's split into as few requests as possible.
+ */
 void xfer_upload_data(struct fxp_xfer *xfer, char *buffer, int len)
 {
-    struct req *rr;
-    struct sftp_request *req;
+    while (len > 0) {
+        struct req *rr;
+        struct sftp_request *req;
+        int thislen = len < fxp_max_write ? len : fxp_max_write;
 
-    rr = snew(struct req);
-    rr->offset = xfer->offset;
-    rr->complete = 0;
-    if (xfer->tail) {
-        xfer->tail->next = rr;
-        rr->prev = xfer->tail;
-    } else {
-        xfer->head = rr;
-        rr->prev = NULL;
-    }
-    xfer->tail = rr;
-    rr->next = NULL;
+        rr = snew(struct req);
+        rr->offset = xfer->offset;
+        rr->complete = 0;
+        if (xfer->tail) {
+            xfer->tail->next = rr;
+            rr->prev = xfer->tail;
+        } else {
+            xfer->head = rr;
+            rr->prev = NULL;
+        }
+        xfer->tail = rr;
+        rr->next = NULL;
 
-    rr->len = len;
-    rr->buffer = NULL;
-    sftp_register(req = fxp_write_send(xfer->fh, buffer, rr->offset, len));
-    fxp_set_userdata(req, rr);
+        rr->len = thislen;
+        rr->buffer = NULL;
+        sftp_register(req = fxp_write_send(xfer->fh, buffer,
+                                           rr->offset, thislen));
+        fxp_set_userdata(req, rr);
 
-    xfer->offset += rr->len;
-    xfer->req_totalsize += rr->len;
+        xfer->offset += rr->len;
+        xfer->req_totalsize += rr->len;
+        xfer->nrequests++;
+        buffer += thislen;
+        len -= thislen;
 
 #ifdef DEBUG_UPLOAD
-    printf("queueing write request %p at %"PRIu64" [len %d]\n",
-           rr, rr->offset, len);
+        printf("queueing write request %p at %"PRIu64" [len %d]\n",
+               rr, rr->offset, thislen);
 #endif
+    }
 }
 
 /*
@@ -1202,3 +1527,344 @@ void xfer_cleanup(struct fxp_xfer *xfer)
     }
     sfree(xfer);
 }
+
+/* ----------------------------------------------------------------------
+ * A pipelined, breadth-first walker over a remote directory tree.
+ */
+
+enum { WALK_OPENDIR, WALK_READDIR, WALK_CLOSE, WALK_STAT };
+
+struct walk_dir {
+    struct fxp_walk_dir pub;
+    size_t namesize;
+    struct fxp_handle *handle;
+    bool closing;                      /* CLOSE sent, which freed handle */
+    bool read_finished;                /* READDIR has said EOF, or failed */
+    int nstats;                        /* STATs outstanding */
+    size_t nextstat;                   /* next name to consider STATting */
+    struct walk_dir *next;
+};
+
+struct walk_req {
+    struct sftp_request *req;
+    int type;
+    struct walk_dir *dir;
+    size_t index;                      /* which name, for WALK_STAT */
+};
+
+struct fxp_walk {
+    int maxdirs, nopen;
+    int nstats;
+    bool aborting;
+    void (*free_ctx)(void *ctx);
+    /* Directories waiting to be opened, in FIFO order */
+    struct walk_dir *pending_head, *pending_tail;
+    /* Directories being read, and ones completely read */
+    struct walk_dir *active;
+    struct walk_dir *done_head, *done_tail;
+    /* Our outstanding requests, so we can recognise their replies */
+    tree234 *reqs;
+};
+
+#define WALK_MAX_STATS 64
+
+static int walk_reqcmp(void *av, void *bv)
+{
+    uintptr_t a = (uintptr_t)av, b = (uintptr_t)bv;
+    return a < b ? -1 : a > b ? +1 : 0;
+}
+
+struct fxp_walk *walk_init(int maxdirs, void (*free_ctx)(void *ctx))
+{
+    struct fxp_walk *w = snew(struct fxp_walk);
+
+    memset(w, 0, sizeof(*w));
+    w->maxdirs = maxdirs;
+    w->free_ctx = free_ctx;
+    w->reqs = newtree234(walk_reqcmp);
+    return w;
+}
+
+void walk_add_dir(struct fxp_walk *w, const char *path, void *ctx)
+{
+    struct walk_dir *d = snew(struct walk_dir);
+
+    memset(d, 0, sizeof(*d));
+    d->pub.path = dupstr(path);
+    d->pub.ctx = ctx;
+    if (w->pending_tail)
+        w->pending_tail->next = d;
+    else
+        w->pending_head = d;
+    w->pending_tail = d;
+}
+
+static void walk_send(struct fxp_walk *w, struct sftp_request *req,
+                      int type, struct walk_dir *d, size_t index)
+{
+    struct walk_req *wr = snew(struct walk_req);
+    wr->req = req;
+    wr->type = type;
+    wr->dir = d;
+    wr->index = index;
+    sftp_register(req);
+    fxp_set_userdata(req, wr);
+    add234(w->reqs, wr);
+}
+
+static inline bool walk_name_needs_stat(struct fxp_name *name)
+{
+    /*
+     * We report what each name refers to, following symlinks, as
+     * FXP_STAT would. FXP_READDIR's attributes will do if they say
+     * it's anything other than a symlink.
+     */
+    return !(name->attrs.flags & SSH_FILEXFER_ATTR_PERMISSIONS) ||
+        (name->attrs.permissions & 0170000) == 0120000;
+}
+
+/*
+ * Send whatever requests a directory needs next, as far as the
+ * limits allow.
+ */
+static void walk_queue_dir(struct fxp_walk *w, struct walk_dir *d)
+{
+    while (!w->aborting && w->nstats < WALK_MAX_STATS &&
+           d->nextstat < d->pub.nnames) {
+        size_t i = d->nextstat++;
+        struct fxp_name *name = d->pub.names[i];
+        if (walk_name_needs_stat(name)) {
+            char *path = dupcat(d->pub.path, "/", name->filename);
+            walk_send(w, fxp_stat_send(path), WALK_STAT, d, i);
+            sfree(path);
+            d->nstats++;
+            w->nstats++;
+        }
+    }
+}
+
+/*
+ * Move a directory which has been completely dealt with from the
+ * active list to the done list.
+ */
+static void walk_finish_dir(struct fxp_walk *w, struct walk_dir *d)
+{
+    struct walk_dir **pp;
+
+    for (pp = &w->active; *pp != d; pp = &(*pp)->next)
+        assert(*pp);
+    *pp = d->next;
+    d->next = NULL;
+
+    if (d->pub.nnames > 0)
+        qsort(d->pub.names, d->pub.nnames, sizeof(*d->pub.names),
+              sftp_name_compare);
+
+    if (w->done_tail)
+        w->done_tail->next = d;
+    else
+        w->done_head = d;
+    w->done_tail = d;
+}
+
+static void walk_check_finished(struct fxp_walk *w, struct walk_dir *d)
+{
+    if (!d->handle && d->read_finished && d->nstats == 0 &&
+        (w->aborting || d->nextstat == d->pub.nnames))
+        walk_finish_dir(w, d);
+}
+
+void walk_queue(struct fxp_walk *w)
+{
+    struct walk_dir *d, *next;
+
+    for (d = w->active; d; d = next) {
+        next = d->next;
+        walk_queue_dir(w, d);
+        walk_check_finished(w, d);
+    }
+
+    while (!w->aborting && w->pending_head && w->nopen < w->maxdirs) {
+        d = w->pending_head;
+        w->pending_head = d->next;
+        if (!w->pending_head)
+            w->pending_tail = NULL;
+        d->next = w->active;
+        w->active = d;
+
+        walk_send(w, fxp_opendir_send(d->pub.path), WALK_OPENDIR, d, 0);
+        w->nopen++;
+    }
+}
+
+/*
+ * Returns INT_MIN, without freeing pktin, if the packet isn't a
+ * reply to one of our requests.
+ */
+int walk_gotpkt(struct fxp_walk *w, struct sftp_packet *pktin)
+{
+    struct sftp_request *rreq;
+    struct walk_req *wr;
+    struct walk_dir *d;
+    struct fxp_names *names;
+    struct fxp_attrs attrs;
+
+    wr = sftp_peek_userdata(pktin);
+    if (!wr || !find234(w->reqs, wr, NULL))
+        return INT_MIN;
+    del234(w->reqs, wr);
+    rreq = sftp_find_request(pktin);
+    d = wr->dir;
+
+    switch (wr->type) {
+      case WALK_OPENDIR:
+        d->handle = fxp_opendir_recv(pktin, rreq);
+        if (!d->handle) {
+            d->pub.error = dupstr(fxp_error());
+            d->read_finished = true;
+            w->nopen--;
+            break;
+        }
+        if (w->aborting) {
+            walk_send(w, fxp_close_send(d->handle), WALK_CLOSE, d, 0);
+            d->closing = true;
+        } else
+            walk_send(w, fxp_readdir_send(d->handle), WALK_READDIR, d, 0);
+        break;
+
+      case WALK_READDIR:
+        names = fxp_readdir_recv(pktin, rreq);
+        if (names && names->nnames > 0 && !w->aborting) {
+            sgrowarrayn(d->pub.names, d->namesize, d->pub.nnames,
+                        names->nnames);
+            for (int i = 0; i < names->nnames; i++)
+                if (strcmp(names->names[i].filename, ".") &&
+                    strcmp(names->names[i].filename, ".."))
+                    d->pub.names[d->pub.nnames++] =
+                        fxp_dup_name(&names->names[i]);
+            fxp_free_names(names);
+            walk_send(w, fxp_readdir_send(d->handle), WALK_READDIR, d, 0);
+            walk_queue_dir(w, d);
+            break;
+        }
+        if (names)
+            fxp_free_names(names);
+        else if (fxp_error_type() != SSH_FX_EOF)
+            d->pub.error = dupstr(fxp_error());
+        d->read_finished = true;
+        walk_send(w, fxp_close_send(d->handle), WALK_CLOSE, d, 0);
+        d->closing = true;
+        break;
+
+      case WALK_CLOSE:
+        fxp_close_recv(pktin, rreq);
+        d->handle = NULL;
+        d->read_finished = true;
+        w->nopen--;
+        break;
+
+      case WALK_STAT:
+        if (fxp_stat_recv(pktin, rreq, &attrs))
+            d->pub.names[wr->index]->attrs = attrs;
+        d->nstats--;
+        w->nstats--;
+        break;
+    }
+
+    sfree(wr);
+    walk_check_finished(w, d);
+    walk_queue(w);
+    return 1;
+}
+
+struct fxp_walk_dir *walk_next_dir(struct fxp_walk *w)
+{
+    struct walk_dir *d = w->done_head;
+
+    if (!d)
+        return NULL;
+    w->done_head = d->next;
+    if (!w->done_head)
+        w->done_tail = NULL;
+    return &d->pub;
+}
+
+bool walk_done(struct fxp_walk *w)
+{
+    return !w->pending_head && !w->active && !w->done_head;
+}
+
+void walk_free_dir(struct fxp_walk_dir *pub)
+{
+    struct walk_dir *d = container_of(pub, struct walk_dir, pub);
+
+    for (size_t i = 0; i < d->pub.nnames; i++)
+        fxp_free_name(d->pub.names[i]);
+    sfree(d->pub.names);
+    sfree(d->pub.path);
+    sfree(d->pub.error);
+    sfree(d);
+}
+
+bool walk_cleanup(struct fxp_walk *w)
+{
+    struct fxp_walk_dir *pub;
+    bool ok = true;
+
+    /*
+     * Stop sending anything new, and wait for the replies to what
+     * we've already sent, so that they don't confuse whoever talks
+     * to the server next. Then throw away everything we've got.
+     */
+    w->aborting = true;
+    while (w->active) {
+        struct sftp_packet *pktin = sftp_recv();
+        if (!pktin || walk_gotpkt(w, pktin) == INT_MIN) {
+            if (pktin)
+                sftp_pkt_free(pktin);
+            ok = false;
+            break;
+        }
+    }
+
+    /*
+     * If we gave up waiting, some directories are still active, and
+     * some of our requests will never be answered. Free their
+     * records, and make sure a late reply can't lead back to them.
+     */
+    {
+        struct walk_req *wr;
+        while ((wr = delpos234(w->reqs, 0)) != NULL) {
+            fxp_set_userdata(wr->req, NULL);
+            sfree(wr);
+        }
+    }
+    while (w->active) {
+        struct walk_dir *d = w->active;
+        w->active = d->next;
+        if (d->handle && !d->closing) {
+            sfree(d->handle->hstring);
+            sfree(d->handle);
+        }
+        d->next = w->done_head;
+        w->done_head = d;
+        if (!w->done_tail)
+            w->done_tail = d;
+    }
+
+    while (w->pending_head) {
+        struct walk_dir *d = w->pending_head;
+        w->pending_head = d->next;
+        d->next = w->done_head;
+        w->done_head = d;
+    }
+    while ((pub = walk_next_dir(w)) != NULL) {
+        if (w->free_ctx)
+            w->free_ctx(pub->ctx);
+        walk_free_dir(pub);
+    }
+
+    freetree234(w->reqs);
+    sfree(w);
+    return ok;
+}
@@ -55,6 +55,52 @@
 
 #define SFTP_PROTO_VERSION 3
 
+/*
+ * Extensions we know about, sent as SSH_FXP_EXTENDED requests.
+ *
+ * check-file-handle (advertised as "check-file") is from
+ * draft-ietf-secsh-filexfer-extensions: the server hashes a range of
+ * an open file, in fixed-size blocks, with an algorithm chosen from a
+ * list the client supplies.
+ *
+ * check-file-name is the same, but names the file instead of taking
+ * a handle to it.
+ *
+ * copy-data, from the same draft, copies a range of one open file
+ * into another without the data passing through the client.
+ *
+ * limits@openssh.com returns the largest packet, read and write the
+ * server will accept, and how many handles it can have open (0 if
+ * unlimited).
+ *
+ * block-sums is our own. The server returns, for each block, an
+ * rsync-style rolling checksum followed by a truncated SHA-256, so
+ * that a client can find a remote block wherever it occurs in a
+ * local file, not just at the same offset.
+ */
+#define SFTP_EXT_CHECK_FILE "check-file"
+#define SFTP_EXT_CHECK_FILE_HANDLE "check-file-handle"
+#define SFTP_EXT_CHECK_FILE_NAME "check-file-name"
+#define SFTP_EXT_COPY_DATA "copy-data"
+#define SFTP_EXT_LIMITS "limits@openssh.com"
+#define SFTP_EXT_BLOCK_SUMS "block-sums@putty.projects.tartarus.org"
+#define SFTP_CHECK_FILE_ALGS "sha256,sha1,md5"
+#define SFTP_BLOCK_STRONG_LEN 16
+#define SFTP_BLOCK_SUM_LEN (4 + SFTP_BLOCK_STRONG_LEN)
+#define SFTP_MAX_HASH_BLOCKS 16384     /* per request, by either method */
+
+uint32_t sftp_rollsum(const void *data, size_t len);
+static inline uint32_t sftp_rollsum_roll(
+    uint32_t sum, unsigned char out, unsigned char in, size_t len)
+{
+    uint16_t a = sum, b = sum >> 16;
+    a += in - out;
+    b += a - len * out;
+    return a | ((uint32_t)b << 16);
+}
+void sftp_block_strong_sum(ptrlen data, unsigned char *out);
+const ssh_hashalg *sftp_check_file_hashalg(ptrlen name);
+
 #define PERMS_DIRECTORY   040000
 
 /*
@@ -168,6 +214,12 @@ int fxp_error_type(void);
  */
 bool fxp_init(void);
 
+/*
+ * Find out whether the server advertised an extension in its
+ * FXP_VERSION. Returns the data it sent with the name, or NULL.
+ */
+const char *fxp_extension(const char *name);
+
 /*
  * Canonify a pathname. Concatenate the two given path elements
  * with a separating slash, unless the second is NULL.
@@ -258,6 +310,36 @@ struct sftp_request *fxp_write_send(struct fxp_handle *handle,
                                     void *buffer, uint64_t offset, int len);
 bool fxp_write_recv(struct sftp_packet *pktin, struct sftp_request *req);
 
+/*
+ * Hash a range of a file on the server, with the check-file-handle
+ * extension (in which case *alg is set to the name of the algorithm
+ * the server chose) or the block-sums extension. Either way, the
+ * hashes of each block are appended to 'out'. A check-file-name
+ * request is also answered by fxp_check_file_recv.
+ */
+struct sftp_request *fxp_check_file_send(
+    struct fxp_handle *handle, const char *algs, uint64_t offset,
+    uint64_t length, unsigned blocksize);
+bool fxp_check_file_recv(struct sftp_packet *pktin, struct sftp_request *req,
+                         char **alg, strbuf *out);
+struct sftp_request *fxp_block_sums_send(
+    struct fxp_handle *handle, uint64_t offset, uint64_t length,
+    unsigned blocksize);
+bool fxp_block_sums_recv(struct sftp_packet *pktin, struct sftp_request *req,
+                         strbuf *out);
+struct sftp_request *fxp_check_file_name_send(
+    const char *fname, const char *algs, uint64_t offset,
+    uint64_t length, unsigned blocksize);
+
+/*
+ * Copy 'length' bytes (0 meaning all of it) from one open file on the
+ * server to another, with the copy-data extension.
+ */
+struct sftp_request *fxp_copy_data_send(
+    struct fxp_handle *src, uint64_t srcoffset, uint64_t length,
+    struct fxp_handle *dst, uint64_t dstoffset);
+bool fxp_copy_data_recv(struct sftp_packet *pktin, struct sftp_request *req);
+
 /*
  * Read from a directory.
  */
@@ -276,6 +358,12 @@ void fxp_free_names(struct fxp_names *names);
 struct fxp_name *fxp_dup_name(struct fxp_name *name);
 void fxp_free_name(struct fxp_name *name);
 
+/*
+ * qsort comparison routine for fxp_name structures. Sorts by real
+ * file name.
+ */
+int sftp_name_compare(const void *av, const void *bv);
+
 /*
  * Store user data in an sftp_request structure.
  */
@@ -289,6 +377,7 @@ void fxp_set_userdata(struct sftp_request *req, void *data);
  */
 void sftp_register(struct sftp_request *req);
 struct sftp_request *sftp_find_request(struct sftp_packet *pktin);
+void *sftp_peek_userdata(struct sftp_packet *pktin);
 struct sftp_packet *sftp_recv(void);
 
 /*
@@ -310,8 +399,49 @@ int xfer_upload_gotpkt(struct fxp_xfer *xfer, struct sftp_packet *pktin);
 
 bool xfer_done(struct fxp_xfer *xfer);
 void xfer_set_error(struct fxp_xfer *xfer);
+/* Number of read or write requests the transfer has sent so far */
+uint64_t xfer_requests(struct fxp_xfer *xfer);
 void xfer_cleanup(struct fxp_xfer *xfer);
 
+/*
+ * A breadth-first walker over remote directory trees, which keeps
+ * several directories open at once and pipelines its READDIR and
+ * STAT requests.
+ *
+ * Add one or more starting directories with walk_add_dir, and call
+ * walk_queue to send requests. Offer every incoming packet to
+ * walk_gotpkt, which returns INT_MIN (leaving the packet alone) if
+ * it wasn't a reply to the walker. walk_next_dir returns each
+ * directory once its listing is complete, with the names sorted and
+ * '.' and '..' removed, and with the attributes of every name
+ * describing what it refers to after following symlinks (if the
+ * server could tell us). Subdirectories found in it may be passed
+ * back to walk_add_dir. The caller frees each returned directory
+ * with walk_free_dir.
+ *
+ * walk_cleanup may be called at any point; it waits for replies
+ * still outstanding, then discards any directories not yet
+ * returned, passing their context pointers to free_ctx. It returns
+ * false if it failed to collect all the outstanding replies.
+ */
+struct fxp_walk;
+struct fxp_walk_dir {
+    char *path;
+    void *ctx;
+    struct fxp_name **names;
+    size_t nnames;
+    char *error;                       /* non-NULL if listing failed */
+};
+
+struct fxp_walk *walk_init(int maxdirs, void (*free_ctx)(void *ctx));
+void walk_add_dir(struct fxp_walk *w, const char *path, void *ctx);
+void walk_queue(struct fxp_walk *w);
+int walk_gotpkt(struct fxp_walk *w, struct sftp_packet *pktin);
+struct fxp_walk_dir *walk_next_dir(struct fxp_walk *w);
+bool walk_done(struct fxp_walk *w);
+void walk_free_dir(struct fxp_walk_dir *d);
+bool walk_cleanup(struct fxp_walk *w);
+
 /*
  * Vtable for the platform-specific filesystem implementation that
  * answers requests in an SFTP server.
@@ -387,6 +517,12 @@ struct SftpServerVtable {
      * then fxp_reply_full_name that many times */
     void (*readdir)(SftpServer *srv, SftpReplyBuilder *reply, ptrlen handle,
                     int max_entries, bool omit_longname);
+
+    /* Should call fxp_reply_error or fxp_reply_ok. A length of 0
+     * means copy until end of file. */
+    void (*copy_data)(SftpServer *srv, SftpReplyBuilder *reply,
+                      ptrlen srchandle, uint64_t srcoffset, uint64_t length,
+                      ptrlen dsthandle, uint64_t dstoffset);
 };
 
 static inline SftpServer *sftpsrv_new(const SftpServerVtable *vt)
@@ -441,6 +577,11 @@ static inline void sftpsrv_readdir(
     SftpServer *srv, SftpReplyBuilder *reply, ptrlen handle,
     int max_entries, bool omit_longname)
 { srv->vt->readdir(srv, reply, handle, max_entries, omit_longname); }
+static inline void sftpsrv_copy_data(
+    SftpServer *srv, SftpReplyBuilder *reply, ptrlen srchandle,
+    uint64_t srcoffset, uint64_t length, ptrlen dsthandle, uint64_t dstoffset)
+{ srv->vt->copy_data(srv, reply, srchandle, srcoffset, length,
+                     dsthandle, dstoffset); }
 
 typedef struct SftpReplyBuilderVtable SftpReplyBuilderVtable;
 struct SftpReplyBuilder {
@@ -457,6 +598,7 @@ struct SftpReplyBuilderVtable {
     void (*reply_handle)(SftpReplyBuilder *reply, ptrlen handle);
     void (*reply_data)(SftpReplyBuilder *reply, ptrlen data);
     void (*reply_attrs)(SftpReplyBuilder *reply, struct fxp_attrs attrs);
+    void (*reply_extended)(SftpReplyBuilder *reply, ptrlen data);
 };
 
 static inline void fxp_reply_ok(SftpReplyBuilder *reply)
@@ -479,6 +621,8 @@ static inline void fxp_reply_data(SftpReplyBuilder *reply, ptrlen data)
 static inline void fxp_reply_attrs(
     SftpReplyBuilder *reply, struct fxp_attrs attrs)
 { reply->vt->reply_attrs(reply, attrs); }
+static inline void fxp_reply_extended(SftpReplyBuilder *reply, ptrlen data)
+{ reply->vt->reply_extended(reply, data); }
 
 /*
  * The usual implementation of an SftpReplyBuilder, containing a
@@ -501,6 +645,13 @@ struct DefaultSftpReplyBuilder {
 struct sftp_packet *sftp_handle_request(
     SftpServer *srv, struct sftp_packet *request);
 
+/*
+ * Set how many worker threads the check-file and block-sums
+ * extensions may spread their hashing over. With 0 (the default),
+ * everything is hashed on the calling thread.
+ */
+void sftp_server_set_hash_threads(unsigned n);
+
 /* ----------------------------------------------------------------------
  * Not exactly SFTP-related, but here's a system that implements an
  * old-fashioned SCP server module, given an SftpServer vtable to use
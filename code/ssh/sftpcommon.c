@@ -9,6 +9,7 @@
 #include <limits.h>
 
 #include "misc.h"
+#include "ssh.h"
 #include "sftp.h"
 
 static void sftp_pkt_BinarySink_write(
@@ -137,3 +138,47 @@ bool sftp_recv_finish(struct sftp_packet *pkt)
     pkt->type = get_byte(pkt);
     return !get_err(pkt);
 }
+
+/*
+ * The weak checksum for the block-sums extension, as used by rsync:
+ * the low half is the sum of the bytes, and the high half the sum of
+ * the running sums, both mod 2^16. sftp_rollsum_roll moves the
+ * window along by one byte.
+ */
+uint32_t sftp_rollsum(const void *vdata, size_t len)
+{
+    const unsigned char *data = (const unsigned char *)vdata;
+    uint16_t a = 0, b = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        a += data[i];
+        b += a;
+    }
+    return a | ((uint32_t)b << 16);
+}
+
+void sftp_block_strong_sum(ptrlen data, unsigned char *out)
+{
+    unsigned char hash[32];
+
+    hash_simple(&ssh_sha256, data, hash);
+    memcpy(out, hash, SFTP_BLOCK_STRONG_LEN);
+}
+
+/*
+ * Map a check-file hash algorithm name to one of ours.
+ */
+const ssh_hashalg *sftp_check_file_hashalg(ptrlen name)
+{
+    if (ptrlen_eq_string(name, "md5"))
+        return &ssh_md5;
+    if (ptrlen_eq_string(name, "sha1"))
+        return &ssh_sha1;
+    if (ptrlen_eq_string(name, "sha256"))
+        return &ssh_sha256;
+    if (ptrlen_eq_string(name, "sha384"))
+        return &ssh_sha384;
+    if (ptrlen_eq_string(name, "sha512"))
+        return &ssh_sha512;
+    return NULL;
+}
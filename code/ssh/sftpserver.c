@@ -10,6 +10,420 @@
 #include "ssh.h"
 #include "sftp.h"
 
+/*
+ * The hashing extensions are implemented here, on top of the
+ * server's ordinary open, read and close methods, using a reply
+ * builder which keeps the data, handle or error for us instead of
+ * making a packet out of it.
+ */
+typedef struct CaptureReplyBuilder {
+    strbuf *data;                      /* or the handle, from open */
+    unsigned code;                     /* SSH_FX_OK unless we got an error */
+    char *msg;
+    SftpReplyBuilder rb;
+} CaptureReplyBuilder;
+
+static void capture_reply_ok(SftpReplyBuilder *reply)
+{
+    /* code is already SSH_FX_OK */
+}
+
+static void capture_reply_data(SftpReplyBuilder *reply, ptrlen data)
+{
+    CaptureReplyBuilder *c = container_of(reply, CaptureReplyBuilder, rb);
+    put_datapl(c->data, data);
+}
+
+static void capture_reply_handle(SftpReplyBuilder *reply, ptrlen handle)
+{
+    CaptureReplyBuilder *c = container_of(reply, CaptureReplyBuilder, rb);
+    put_datapl(c->data, handle);
+}
+
+static void capture_reply_error(
+    SftpReplyBuilder *reply, unsigned code, const char *msg)
+{
+    CaptureReplyBuilder *c = container_of(reply, CaptureReplyBuilder, rb);
+    c->code = code;
+    c->msg = dupstr(msg);
+}
+
+static void capture_reply_unexpected(SftpReplyBuilder *reply)
+{
+    unreachable("unexpected reply type from open, read or close");
+}
+static void capture_reply_simple_name(SftpReplyBuilder *reply, ptrlen name)
+{ capture_reply_unexpected(reply); }
+static void capture_reply_name_count(SftpReplyBuilder *reply, unsigned count)
+{ capture_reply_unexpected(reply); }
+static void capture_reply_full_name(SftpReplyBuilder *reply, ptrlen name,
+                                    ptrlen longname, struct fxp_attrs attrs)
+{ capture_reply_unexpected(reply); }
+static void capture_reply_attrs(
+    SftpReplyBuilder *reply, struct fxp_attrs attrs)
+{ capture_reply_unexpected(reply); }
+static void capture_reply_extended(SftpReplyBuilder *reply, ptrlen data)
+{ capture_reply_unexpected(reply); }
+
+static const SftpReplyBuilderVtable CaptureReplyBuilder_vt = {
+    .reply_ok = capture_reply_ok,
+    .reply_error = capture_reply_error,
+    .reply_simple_name = capture_reply_simple_name,
+    .reply_name_count = capture_reply_name_count,
+    .reply_full_name = capture_reply_full_name,
+    .reply_handle = capture_reply_handle,
+    .reply_data = capture_reply_data,
+    .reply_attrs = capture_reply_attrs,
+    .reply_extended = capture_reply_extended,
+};
+
+static void capture_init(CaptureReplyBuilder *c, strbuf *data)
+{
+    c->rb.vt = &CaptureReplyBuilder_vt;
+    c->data = data;
+    c->code = SSH_FX_OK;
+    c->msg = NULL;
+}
+
+/*
+ * Read up to 'length' bytes at 'offset' into 'buf' (after clearing
+ * it), stopping short only at end of file. On failure, sends the
+ * error to 'reply' and returns false.
+ */
+static bool sftp_read_range(SftpServer *srv, SftpReplyBuilder *reply,
+                            ptrlen handle, uint64_t offset, unsigned length,
+                            strbuf *buf)
+{
+    CaptureReplyBuilder c;
+
+    strbuf_clear(buf);
+
+    while (buf->len < length) {
+        size_t oldlen = buf->len;
+        unsigned chunk = length - buf->len;
+        if (chunk > 32768)
+            chunk = 32768;
+
+        capture_init(&c, buf);
+        sftpsrv_read(srv, &c.rb, handle, offset + buf->len, chunk);
+        if (c.code == SSH_FX_EOF) {
+            sfree(c.msg);
+            break;
+        }
+        if (c.code != SSH_FX_OK) {
+            fxp_reply_error(reply, c.code, c.msg);
+            sfree(c.msg);
+            return false;
+        }
+        if (buf->len == oldlen)
+            break;
+    }
+    return true;
+}
+
+/* How much of a block we should read, given 'length' (0 = to EOF) */
+static unsigned sftp_block_length(uint64_t done, uint64_t length,
+                                  unsigned blocksize)
+{
+    if (length && length - done < blocksize)
+        return length - done;
+    return blocksize;
+}
+
+/*
+ * Hashing can be spread over a pool of worker threads, shared by
+ * every SftpServer in the process and started the first time it's
+ * needed. The main thread reads a batch of blocks for each worker;
+ * then, while the workers hash those, it reads the next lot. So the
+ * hashing costs little more than the reading, as long as there are
+ * enough CPUs.
+ */
+#define SFTP_HASH_BATCH 1048576        /* bytes per job, roughly */
+
+static unsigned sftp_hash_nthreads;
+static WorkerThread **sftp_hash_workers;
+static unsigned sftp_hash_nworkers;
+static int sftp_hash_notify_ctx;
+
+void sftp_server_set_hash_threads(unsigned n)
+{
+    sftp_hash_nthreads = n;
+}
+
+typedef struct SftpHashJob {
+    /*
+     * The hash object is made on the main thread, because choosing
+     * an implementation of some algorithms caches the result of a
+     * CPU feature check, which the worker threads shouldn't race to
+     * do. (For block_sums, sftp_block_strong_sum makes its own SHA-256
+     * objects, but only after this one has done the check.)
+     */
+    ssh_hash *h;
+    bool whole;                        /* hash all the data as one */
+    bool block_sums;                   /* weak and strong sums per block */
+    unsigned blocksize;
+    strbuf *data, *out;
+} SftpHashJob;
+
+static void sftp_hash_job_run(void *vjob)
+{
+    SftpHashJob *job = (SftpHashJob *)vjob;
+    const ssh_hashalg *alg = ssh_hash_alg(job->h);
+    unsigned char hash[MAX_HASH_LEN];
+
+    strbuf_clear(job->out);
+
+    if (job->whole) {
+        put_datapl(job->h, ptrlen_from_strbuf(job->data));
+        return;
+    }
+
+    for (size_t pos = 0; pos < job->data->len; pos += job->blocksize) {
+        size_t len = job->data->len - pos;
+        if (len > job->blocksize)
+            len = job->blocksize;
+        ptrlen block = make_ptrlen(job->data->u + pos, len);
+
+        if (job->block_sums) {
+            /* Exactly what the client computes to compare with */
+            put_uint32(job->out, sftp_rollsum(block.ptr, block.len));
+            sftp_block_strong_sum(block, hash);
+            put_data(job->out, hash, SFTP_BLOCK_STRONG_LEN);
+        } else {
+            ssh_hash_reset(job->h);
+            put_datapl(job->h, block);
+            ssh_hash_digest(job->h, hash);
+            put_data(job->out, hash, alg->hlen);
+        }
+    }
+    smemclr(hash, sizeof(hash));
+}
+
+static void sftp_hash_notify(void *ctx)
+{
+    /* We wait for the workers instead of being told about them */
+}
+
+static unsigned sftp_hash_start_workers(void)
+{
+    if (!sftp_hash_workers && sftp_hash_nthreads) {
+        sftp_hash_nworkers = sftp_hash_nthreads;
+        sftp_hash_workers = snewn(sftp_hash_nworkers, WorkerThread *);
+        for (unsigned i = 0; i < sftp_hash_nworkers; i++)
+            sftp_hash_workers[i] = worker_thread_new(
+                sftp_hash_job_run, sftp_hash_notify, &sftp_hash_notify_ctx);
+    }
+    return sftp_hash_nworkers;
+}
+
+/*
+ * Hash a range of a file, as described by 'proto', appending the
+ * results to 'out' in order. If proto->whole is set, the data is
+ * all fed to proto->h, one chunk at a time; as that has to happen in
+ * order, only one worker is used, but the reading still overlaps
+ * with the hashing. On failure, sends the error to 'reply' and
+ * returns false.
+ */
+static bool sftp_hash_range(
+    SftpServer *srv, SftpReplyBuilder *reply, ptrlen handle,
+    uint64_t offset, uint64_t length, const SftpHashJob *proto,
+    strbuf *out)
+{
+    unsigned nworkers = sftp_hash_start_workers();
+    unsigned njobs = (nworkers && !proto->whole) ? nworkers : 1;
+    unsigned batch;
+    SftpHashJob *jobs, *cur, *next, *tmp;
+    unsigned ncur = 0, nnext;
+    uint64_t done = 0;
+    size_t nblocks = 0;
+    bool eof = false, ok = true;
+
+    if (proto->whole)
+        batch = SFTP_HASH_BATCH;
+    else if (proto->blocksize >= SFTP_HASH_BATCH)
+        batch = proto->blocksize;
+    else
+        batch = (SFTP_HASH_BATCH / proto->blocksize) * proto->blocksize;
+
+    jobs = snewn(2 * njobs, SftpHashJob);
+    for (unsigned i = 0; i < 2 * njobs; i++) {
+        jobs[i] = *proto;
+        if (!proto->whole)
+            jobs[i].h = ssh_hash_new(ssh_hash_alg(proto->h));
+        jobs[i].data = strbuf_new_nm();
+        jobs[i].out = strbuf_new();
+    }
+    cur = jobs;
+    next = jobs + njobs;
+
+    while (true) {
+        /* Read the next set of jobs while the current one is hashed */
+        for (nnext = 0; ok && !eof && nnext < njobs; nnext++) {
+            SftpHashJob *job = &next[nnext];
+            if (!sftp_read_range(srv, reply, handle, offset + done,
+                                 sftp_block_length(done, length, batch),
+                                 job->data)) {
+                ok = false;
+                break;
+            }
+            if (!job->data->len) {
+                eof = true;
+                break;
+            }
+            done += job->data->len;
+            if (!proto->whole) {
+                nblocks += (job->data->len + proto->blocksize - 1) /
+                    proto->blocksize;
+                if (nblocks > SFTP_MAX_HASH_BLOCKS) {
+                    fxp_reply_error(reply, SSH_FX_FAILURE,
+                                    "Too many blocks to hash in one request");
+                    ok = false;
+                    break;
+                }
+            }
+        }
+
+        for (unsigned i = 0; i < ncur; i++) {
+            if (nworkers) {
+                worker_thread_wait(sftp_hash_workers[i]);
+                SftpHashJob *job = worker_thread_collect(sftp_hash_workers[i]);
+                assert(job == &cur[i]);
+            }
+            put_datapl(out, ptrlen_from_strbuf(cur[i].out));
+        }
+
+        if (!ok || !nnext)
+            break;
+
+        for (unsigned i = 0; i < nnext; i++) {
+            if (nworkers)
+                worker_thread_submit(sftp_hash_workers[i], &next[i]);
+            else
+                sftp_hash_job_run(&next[i]);
+        }
+        tmp = cur;
+        cur = next;
+        next = tmp;
+        ncur = nnext;
+    }
+
+    for (unsigned i = 0; i < 2 * njobs; i++) {
+        if (!proto->whole)
+            ssh_hash_free(jobs[i].h);
+        strbuf_free(jobs[i].data);
+        strbuf_free(jobs[i].out);
+    }
+    sfree(jobs);
+    return ok;
+}
+
+static void sftp_check_file(
+    SftpServer *srv, SftpReplyBuilder *reply, ptrlen handle, ptrlen algs,
+    uint64_t offset, uint64_t length, unsigned blocksize)
+{
+    const ssh_hashalg *alg = NULL;
+    ptrlen algname;
+    SftpHashJob proto;
+    strbuf *out;
+
+    /* Use the first algorithm in the client's list that we know */
+    while (algs.len) {
+        algname = ptrlen_get_word(&algs, ",");
+        if ((alg = sftp_check_file_hashalg(algname)) != NULL)
+            break;
+    }
+    if (!alg) {
+        fxp_reply_error(reply, SSH_FX_OP_UNSUPPORTED,
+                        "No supported hash algorithm");
+        return;
+    }
+    if (blocksize != 0 && (blocksize < 256 || blocksize > 0x100000)) {
+        /* The draft's minimum, and our own maximum so that one block
+         * fits comfortably in a read buffer */
+        fxp_reply_error(reply, SSH_FX_BAD_MESSAGE,
+                        "Block size must be between 256 and 1Mb");
+        return;
+    }
+
+    out = strbuf_new();
+    put_stringpl(out, algname);
+
+    memset(&proto, 0, sizeof(proto));
+    proto.h = ssh_hash_new(alg);
+    proto.whole = (blocksize == 0);    /* one hash over the whole range */
+    proto.blocksize = blocksize;
+    if (sftp_hash_range(srv, reply, handle, offset, length, &proto, out)) {
+        if (proto.whole)
+            ssh_hash_digest(proto.h, strbuf_append(out, alg->hlen));
+        fxp_reply_extended(reply, ptrlen_from_strbuf(out));
+    }
+
+    ssh_hash_free(proto.h);
+    strbuf_free(out);
+}
+
+/*
+ * check-file-name: open the file ourselves, and then do the same as
+ * for check-file-handle.
+ */
+static void sftp_check_file_name(
+    SftpServer *srv, SftpReplyBuilder *reply, ptrlen path, ptrlen algs,
+    uint64_t offset, uint64_t length, unsigned blocksize)
+{
+    CaptureReplyBuilder c;
+    strbuf *handle = strbuf_new();
+
+    capture_init(&c, handle);
+    sftpsrv_open(srv, &c.rb, path, SSH_FXF_READ, no_attrs);
+    if (c.code != SSH_FX_OK) {
+        fxp_reply_error(reply, c.code, c.msg);
+        sfree(c.msg);
+        strbuf_free(handle);
+        return;
+    }
+
+    sftp_check_file(srv, reply, ptrlen_from_strbuf(handle), algs,
+                    offset, length, blocksize);
+
+    capture_init(&c, NULL);
+    sftpsrv_close(srv, &c.rb, ptrlen_from_strbuf(handle));
+    sfree(c.msg);
+    strbuf_free(handle);
+}
+
+static void sftp_block_sums(
+    SftpServer *srv, SftpReplyBuilder *reply, ptrlen handle,
+    uint64_t offset, uint64_t length, unsigned blocksize)
+{
+    SftpHashJob proto;
+    strbuf *out;
+
+    if (blocksize == 0 || blocksize > 0x100000) {
+        fxp_reply_error(reply, SSH_FX_BAD_MESSAGE, "Unsupported block size");
+        return;
+    }
+
+    out = strbuf_new();
+
+    memset(&proto, 0, sizeof(proto));
+    proto.h = ssh_hash_new(&ssh_sha256);
+    proto.block_sums = true;
+    proto.blocksize = blocksize;
+    if (sftp_hash_range(srv, reply, handle, offset, length, &proto, out))
+        fxp_reply_extended(reply, ptrlen_from_strbuf(out));
+
+    ssh_hash_free(proto.h);
+    strbuf_free(out);
+}
+
+/*
+ * What we tell clients in reply to limits@openssh.com. These are the
+ * same as OpenSSH's: the limit on data allows for the rest of a READ
+ * or WRITE packet.
+ */
+#define SFTP_SERVER_MAX_PACKET (256 * 1024)
+#define SFTP_SERVER_MAX_DATA (SFTP_SERVER_MAX_PACKET - 1024)
+
 struct sftp_packet *sftp_handle_request(
     SftpServer *srv, struct sftp_packet *req)
 {
@@ -35,6 +449,14 @@ struct sftp_packet *sftp_handle_request(
          * input packet.
          */
         put_uint32(reply, SFTP_PROTO_VERSION);
+        put_stringz(reply, SFTP_EXT_CHECK_FILE);
+        put_stringz(reply, "md5,sha1,sha256,sha384,sha512");
+        put_stringz(reply, SFTP_EXT_COPY_DATA);
+        put_stringz(reply, "1");
+        put_stringz(reply, SFTP_EXT_LIMITS);
+        put_stringz(reply, "1");
+        put_stringz(reply, SFTP_EXT_BLOCK_SUMS);
+        put_stringz(reply, "1");
         return reply;
     }
 
@@ -165,6 +587,8 @@ struct sftp_packet *sftp_handle_request(
         length = get_uint32(req);
         if (get_err(req))
             goto decode_error;
+        if (length > SFTP_SERVER_MAX_DATA)
+            length = SFTP_SERVER_MAX_DATA; /* as we said in our limits */
         sftpsrv_read(srv, rb, handle, offset, length);
         break;
 
@@ -184,6 +608,78 @@ struct sftp_packet *sftp_handle_request(
         sftpsrv_write(srv, rb, handle, offset, data);
         break;
 
+      case SSH_FXP_EXTENDED: {
+        ptrlen name = get_string(req);
+        if (get_err(req))
+            goto decode_error;
+
+        if (ptrlen_eq_string(name, SFTP_EXT_CHECK_FILE_HANDLE)) {
+            ptrlen algs;
+            uint64_t length;
+            unsigned blocksize;
+
+            handle = get_string(req);
+            algs = get_string(req);
+            offset = get_uint64(req);
+            length = get_uint64(req);
+            blocksize = get_uint32(req);
+            if (get_err(req))
+                goto decode_error;
+            sftp_check_file(srv, rb, handle, algs, offset, length,
+                            blocksize);
+        } else if (ptrlen_eq_string(name, SFTP_EXT_CHECK_FILE_NAME)) {
+            ptrlen algs;
+            uint64_t length;
+            unsigned blocksize;
+
+            path = get_string(req);
+            algs = get_string(req);
+            offset = get_uint64(req);
+            length = get_uint64(req);
+            blocksize = get_uint32(req);
+            if (get_err(req))
+                goto decode_error;
+            sftp_check_file_name(srv, rb, path, algs, offset, length,
+                                 blocksize);
+        } else if (ptrlen_eq_string(name, SFTP_EXT_COPY_DATA)) {
+            ptrlen dsthandle;
+            uint64_t length, dstoffset;
+
+            handle = get_string(req);
+            offset = get_uint64(req);
+            length = get_uint64(req);
+            dsthandle = get_string(req);
+            dstoffset = get_uint64(req);
+            if (get_err(req))
+                goto decode_error;
+            sftpsrv_copy_data(srv, rb, handle, offset, length,
+                              dsthandle, dstoffset);
+        } else if (ptrlen_eq_string(name, SFTP_EXT_LIMITS)) {
+            strbuf *limits = strbuf_new();
+            put_uint64(limits, SFTP_SERVER_MAX_PACKET);
+            put_uint64(limits, SFTP_SERVER_MAX_DATA);  /* read */
+            put_uint64(limits, SFTP_SERVER_MAX_DATA);  /* write */
+            put_uint64(limits, 0);     /* open handles: no fixed limit */
+            fxp_reply_extended(rb, ptrlen_from_strbuf(limits));
+            strbuf_free(limits);
+        } else if (ptrlen_eq_string(name, SFTP_EXT_BLOCK_SUMS)) {
+            uint64_t length;
+            unsigned blocksize;
+
+            handle = get_string(req);
+            offset = get_uint64(req);
+            length = get_uint64(req);
+            blocksize = get_uint32(req);
+            if (get_err(req))
+                goto decode_error;
+            sftp_block_sums(srv, rb, handle, offset, length, blocksize);
+        } else {
+            fxp_reply_error(rb, SSH_FX_OP_UNSUPPORTED,
+                            "Unrecognised extension");
+        }
+        break;
+      }
+
       default:
         if (get_err(req))
             goto decode_error;
@@ -267,6 +763,14 @@ static void default_reply_attrs(
     put_fxp_attrs(d->pkt, attrs);
 }
 
+static void default_reply_extended(SftpReplyBuilder *reply, ptrlen data)
+{
+    DefaultSftpReplyBuilder *d =
+        container_of(reply, DefaultSftpReplyBuilder, rb);
+    d->pkt->type = SSH_FXP_EXTENDED_REPLY;
+    put_datapl(d->pkt, data);
+}
+
 const SftpReplyBuilderVtable DefaultSftpReplyBuilder_vt = {
     .reply_ok = default_reply_ok,
     .reply_error = default_reply_error,
@@ -276,4 +780,5 @@ const SftpReplyBuilderVtable DefaultSftpReplyBuilder_vt = {
     .reply_handle = default_reply_handle,
     .reply_data = default_reply_data,
     .reply_attrs = default_reply_attrs,
+    .reply_extended = default_reply_extended,
 };
@@ -213,6 +213,14 @@ static void ssh_got_ssh_version(struct ssh_version_receiver *rcv,
                 (conf_get_bool(ssh->conf, CONF_ssh_simple) && !ssh->connshare);
 
             ssh->bpp = ssh2_bpp_new(ssh->logctx, &ssh->stats, false);
+            if (conf_get_bool(ssh->conf, CONF_compress_in_thread))
+                ssh2_bpp_compress_in_thread(ssh->bpp);
+            /* More cipher workers than CPUs would only add overhead */
+            int cipher_threads = conf_get_int(ssh->conf, CONF_cipher_threads);
+            if (cipher_threads > 0)
+                ssh2_bpp_parallel_crypto(
+                    ssh->bpp, min((unsigned)cipher_threads,
+                                  worker_thread_cpus()));
             ssh_connect_bpp(ssh);
 
 #ifndef NO_GSSAPI
@@ -386,6 +394,13 @@ static void ssh_bpp_output_raw_data_callback(void *vctx)
     if (!ssh->s)
         return;
 
+    /*
+     * Cork the socket while we hand it the contents of out_raw, so
+     * that a queue of small packets goes out in as few system calls
+     * as possible.
+     */
+    sk_set_corked(ssh->s, true);
+
     while (bufchain_size(&ssh->out_raw) > 0) {
         size_t backlog;
 
@@ -399,11 +414,14 @@ static void ssh_bpp_output_raw_data_callback(void *vctx)
         bufchain_consume(&ssh->out_raw, data.len);
 
         if (backlog > SSH_MAX_BACKLOG) {
+            sk_set_corked(ssh->s, false);
             ssh_throttle_all(ssh, true, backlog);
             return;
         }
     }
 
+    sk_set_corked(ssh->s, false);
+
     ssh_check_frozen(ssh);
 
     if (ssh->pending_close) {
@@ -947,6 +965,11 @@ bool ssh_is_bare(Ssh *ssh)
     return ssh->backend.vt->protocol == PROT_SSHCONN;
 }
 
+bool ssh_get_io_stats(Ssh *ssh, SocketIOStats *stats)
+{
+    return ssh->s && sk_get_io_stats(ssh->s, stats);
+}
+
 /* Dummy connlayer must provide ssh_sharing_no_more_downstreams,
  * because it might be called early due to plink -shareexists */
 static void dummy_sharing_no_more_downstreams(ConnectionLayer *cl) {}
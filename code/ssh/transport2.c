@@ -115,6 +115,10 @@ static void ssh2_transport_gss_update(struct ssh2_transport_state *s,
 
 static bool ssh2_transport_timer_update(struct ssh2_transport_state *s,
                                         unsigned long rekey_time);
+static void ssh2_transport_schedule_precompute(
+    struct ssh2_transport_state *s);
+static void ssh2_transport_discard_precomputed(
+    struct ssh2_transport_state *s);
 static SeatPromptResult ssh2_transport_confirm_weak_crypto_primitive(
     struct ssh2_transport_state *s, const char *type, const char *name,
     const void *alg, WeakCryptoReason wcr);
@@ -257,6 +261,7 @@ static void ssh2_transport_free(PacketProtocolLayer *ppl)
     }
     if (s->ecdh_key)
         ecdh_key_free(s->ecdh_key);
+    ssh2_transport_discard_precomputed(s);
     if (s->exhash)
         ssh_hash_free(s->exhash);
     strbuf_free(s->outgoing_kexinit);
@@ -1965,6 +1970,7 @@ static void ssh2_transport_process_queue(PacketProtocolLayer *ppl)
     s->kex_in_progress = false;
     s->last_rekey = GETTICKCOUNT();
     (void) ssh2_transport_timer_update(s, 0);
+    ssh2_transport_schedule_precompute(s);
 
     /*
      * Now we're encrypting. Get the next-layer protocol started if it
@@ -2222,6 +2228,104 @@ static bool ssh2_transport_timer_update(struct ssh2_transport_state *s,
     return false;
 }
 
+/*
+ * Shortly before a timed rekey is due, make the ephemeral key material
+ * for it, so that the rekey itself only has to wait for the network.
+ * For NTRU Prime and the larger DH groups, generating it is most of
+ * the CPU cost of key exchange. We guess that the rekey will use the
+ * same kex method as last time; if it doesn't, or if something else
+ * starts a rekey first, we just make a fresh key as usual.
+ */
+#define KEX_PRECOMPUTE_LEAD (60 * TICKSPERSEC)
+
+static void ssh2_transport_discard_precomputed(
+    struct ssh2_transport_state *s)
+{
+    if (s->precomputed_ecdh_key) {
+        ecdh_key_free(s->precomputed_ecdh_key);
+        s->precomputed_ecdh_key = NULL;
+    }
+    if (s->precomputed_dh_ctx) {
+        dh_cleanup(s->precomputed_dh_ctx);
+        s->precomputed_dh_ctx = NULL;
+    }
+    s->precomputed_kex = NULL;
+}
+
+static void ssh2_transport_precompute_timer(void *ctx, unsigned long now)
+{
+    struct ssh2_transport_state *s = (struct ssh2_transport_state *)ctx;
+    const ssh_kex *kex = s->kex_alg;
+
+    if (s->kex_in_progress || now != s->next_precompute)
+        return;
+    if (s->precomputed_kex == kex)
+        return;                        /* already done */
+
+    ssh2_transport_discard_precomputed(s);
+
+    if (kex->main_type == KEXTYPE_ECDH ||
+        kex->main_type == KEXTYPE_GSS_ECDH) {
+        s->precomputed_ecdh_key = ecdh_key_new(kex, s->ssc != NULL);
+        if (!s->precomputed_ecdh_key)
+            return;
+    } else if ((kex->main_type == KEXTYPE_DH ||
+                kex->main_type == KEXTYPE_GSS) && !dh_is_gex(kex)) {
+        /* A server-supplied group can't be known in advance, but a
+         * standard one can */
+        s->precomputed_dh_ctx = dh_setup_group(kex);
+        dh_create_e(s->precomputed_dh_ctx);
+    } else {
+        return;                        /* nothing we can do early */
+    }
+    s->precomputed_kex = kex;
+}
+
+static void ssh2_transport_schedule_precompute(
+    struct ssh2_transport_state *s)
+{
+    unsigned long mins, ticks;
+
+    mins = sanitise_rekey_time(conf_get_int(s->conf, CONF_ssh_rekey_time), 60);
+    ticks = mins * 60 * TICKSPERSEC;
+    if (mins == 0 || ticks <= KEX_PRECOMPUTE_LEAD)
+        return;
+
+    s->next_precompute = schedule_timer(
+        ticks - KEX_PRECOMPUTE_LEAD, ssh2_transport_precompute_timer, s);
+}
+
+ecdh_key *ssh2_transport_ecdh_key_new(struct ssh2_transport_state *s,
+                                      bool is_server)
+{
+    PacketProtocolLayer *ppl = &s->ppl; /* for ppl_logevent */
+
+    if (s->precomputed_ecdh_key && s->precomputed_kex == s->kex_alg) {
+        ecdh_key *key = s->precomputed_ecdh_key;
+        s->precomputed_ecdh_key = NULL;
+        s->precomputed_kex = NULL;
+        ppl_logevent("Using key exchange material generated in advance");
+        return key;
+    }
+    ssh2_transport_discard_precomputed(s);
+    return ecdh_key_new(s->kex_alg, is_server);
+}
+
+dh_ctx *ssh2_transport_dh_setup_group(struct ssh2_transport_state *s)
+{
+    PacketProtocolLayer *ppl = &s->ppl; /* for ppl_logevent */
+
+    if (s->precomputed_dh_ctx && s->precomputed_kex == s->kex_alg) {
+        dh_ctx *ctx = s->precomputed_dh_ctx;
+        s->precomputed_dh_ctx = NULL;
+        s->precomputed_kex = NULL;
+        ppl_logevent("Using key exchange material generated in advance");
+        return ctx;
+    }
+    ssh2_transport_discard_precomputed(s);
+    return dh_setup_group(s->kex_alg);
+}
+
 void ssh2_transport_dialog_callback(void *vctx, SeatPromptResult spr)
 {
     struct ssh2_transport_state *s = (struct ssh2_transport_state *)vctx;
@@ -2390,6 +2494,11 @@ static bool ssh2_transport_get_specials(
         toret = true;
     }
 
+    if (need_separator)
+        add_special(ctx, NULL, SS_SEP, 0);
+    add_special(ctx, "Dump performance statistics", SS_STATS, 0);
+    need_separator = toret = true;
+
     /*
      * Don't bother offering rekey-based specials if we've decided the
      * remote won't cope with it, since we wouldn't bother sending it
@@ -2422,6 +2531,52 @@ static bool ssh2_transport_get_specials(
     return toret;
 }
 
+static void ssh2_transport_put_stats_direction(
+    strbuf *sb, const char *name, const BppPerfDirection *perf,
+    const transport_direction *dir)
+{
+    put_fmt(sb, "\"%s\":{\"packets\":%"PRIu64",\"bytes\":%"PRIu64
+            ",\"crypt_usec\":%"PRIu64, name, perf->packets, perf->bytes,
+            perf->crypt_ns / 1000);
+    put_fmt(sb, ",\"cipher\":\"%s\",\"mac\":\"%s\"}",
+            dir->cipher ? dir->cipher->ssh2_id : "none",
+            !dir->mac ? "none" :
+            dir->etm_mode ? dir->mac->etm_name : dir->mac->name);
+}
+
+/*
+ * Write the connection-wide performance counters to the Event Log as
+ * a single JSON object.
+ */
+static void ssh2_transport_log_stats(struct ssh2_transport_state *s)
+{
+    PacketProtocolLayer *ppl = &s->ppl; /* for ppl_logevent */
+    BinaryPacketProtocol *bpp = s->ppl.bpp;
+    SocketIOStats ios;
+    strbuf *sb = strbuf_new();
+
+    put_fmt(sb, "{\"layer\":\"transport\",");
+    ssh2_transport_put_stats_direction(sb, "in", &bpp->perf.in, &s->in);
+    put_byte(sb, ',');
+    ssh2_transport_put_stats_direction(sb, "out", &bpp->perf.out, &s->out);
+    put_fmt(sb, ",\"queued_data_size\":%"SIZEu
+            ",\"out_raw_size\":%"SIZEu,
+            ssh2_transport_queued_data_size(&s->ppl),
+            bufchain_size(bpp->out_raw));
+    if (ssh_get_io_stats(s->ppl.ssh, &ios)) {
+        put_fmt(sb, ",\"socket\":{\"read_calls\":%"PRIu64
+                ",\"read_events\":%"PRIu64",\"bytes_read\":%"PRIu64
+                ",\"write_calls\":%"PRIu64",\"bytes_written\":%"PRIu64
+                ",\"read_size\":%"SIZEu"}",
+                ios.read_calls, ios.read_events, ios.bytes_read,
+                ios.write_calls, ios.bytes_written, ios.read_size);
+    }
+    put_byte(sb, '}');
+
+    ppl_logevent("Performance statistics: %s", sb->s);
+    strbuf_free(sb);
+}
+
 static void ssh2_transport_special_cmd(PacketProtocolLayer *ppl,
                                        SessionSpecialCode code, int arg)
 {
@@ -2441,6 +2596,11 @@ static void ssh2_transport_special_cmd(PacketProtocolLayer *ppl,
             s->rekey_class = RK_NORMAL;
             queue_idempotent_callback(&s->ppl.ic_process_queue);
         }
+    } else if (code == SS_STATS) {
+        /* Log our own counters, and then let the connection layer
+         * log its per-channel ones. */
+        ssh2_transport_log_stats(s);
+        ssh_ppl_special_cmd(s->higher_layer, code, arg);
     } else {
         /* Send everything else to the next layer up. This includes
          * SS_PING/SS_NOP, which we _could_ handle here - but it's
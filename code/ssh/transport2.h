@@ -200,6 +200,16 @@ struct ssh2_transport_state {
     RSAKey *rsa_kex_key;             /* for RSA kex */
     bool rsa_kex_key_needs_freeing;
     ecdh_key *ecdh_key;                     /* for ECDH kex */
+
+    /*
+     * Ephemeral key material made in advance of the next rekey, on
+     * the assumption that it will use the same kex method as the last
+     * one (which is the only one it's valid for).
+     */
+    const ssh_kex *precomputed_kex;
+    ecdh_key *precomputed_ecdh_key;
+    dh_ctx *precomputed_dh_ctx;
+    unsigned long next_precompute;
     unsigned char exchange_hash[MAX_HASH_LEN];
     bool can_gssapi_keyex;
     bool need_gss_transient_hostkey;
@@ -258,6 +268,13 @@ void ssh2_transport_dialog_callback(void *, SeatPromptResult);
 /* Provided by transport for use in kex */
 void ssh2transport_finalise_exhash(struct ssh2_transport_state *s);
 
+/* Provided by transport for use in kex: wrappers on ecdh_key_new and
+ * dh_setup_group for s->kex_alg, which return the precomputed key
+ * material if there is any */
+ecdh_key *ssh2_transport_ecdh_key_new(struct ssh2_transport_state *s,
+                                      bool is_server);
+dh_ctx *ssh2_transport_dh_setup_group(struct ssh2_transport_state *s);
+
 /* Provided by kex for use in transport. Must set the 'aborted' flag
  * if it throws a connection-terminating error, so that the caller
  * won't have to check that by looking inside its state parameter
@@ -127,6 +127,17 @@
 #include "misc.h"
 #include "bidi.h"
 
+/*
+ * The Unicode data tables in this file (for bidi types, mirrored
+ * glyphs and paired brackets) are sorted lists that used to be
+ * binary-searched for every character. They're now the master copy
+ * from which mkunitab.pl generates the constant-time lookup tables in
+ * bidi_tables.h at build time. The functions that searched them are
+ * still compiled into the test program, to check the two against
+ * each other.
+ */
+#include "bidi_tables.h"
+
 typedef struct {
     char type;
     wchar_t form_b;
@@ -340,7 +351,8 @@ perl -ne '@_=split ";"; $num = hex $_[0]; $type = $_[4];' \
     UnicodeData.txt
 
  */
-unsigned char bidi_getType(int ch)
+#ifdef TEST
+static unsigned char ref_bidi_getType(int ch)
 {
     static const struct {
         int first, last, type;
@@ -1668,6 +1680,14 @@ unsigned char bidi_getType(int ch)
      */
     return ON;
 }
+#endif /* TEST */
+
+unsigned char bidi_getType(int ch)
+{
+    if ((unsigned)ch >= 0x110000)
+        return ON;
+    return bidi_type_lookup(ch);
+}
 
 /*
  * Return the mirrored version of a glyph.
@@ -1701,7 +1721,8 @@ perl -e '
  * operator, or integral sign. No API currently exists here to
  * communicate the need for that reflected display back to the client.
  */
-static unsigned mirror_glyph(unsigned int ch)
+#ifdef TEST
+static unsigned ref_mirror_glyph(unsigned int ch)
 {
     static const struct {
         unsigned src, dst;
@@ -2153,12 +2174,20 @@ static unsigned mirror_glyph(unsigned int ch)
 
     return ch;
 }
+#endif /* TEST */
+
+static unsigned mirror_glyph(unsigned int ch)
+{
+    if (ch >= 0x110000)
+        return ch;
+    return ch + bidi_mirror_lookup(ch);
+}
 
 /*
  * Identify the bracket characters treated specially by bidi rule
  * BD19, and return their paired character(s).
  *
- * The data table in this function is constructed from the Unicode
+ * The data table below is constructed from the Unicode
  * Character Database version 14.0.0, downloadable from unicode.org at
  * the URL
  *
@@ -2198,142 +2227,143 @@ typedef struct BracketTypeData {
     unsigned partner, equiv_partner;
     BracketType type;
 } BracketTypeData;
-static BracketTypeData bracket_type(unsigned int ch)
-{
-    static const struct {
-        unsigned src;
-        BracketTypeData payload;
-    } bracket_pairs[] = {
-        {0x0028, {0x0029, 0x0000, BT_OPEN}},
-        {0x0029, {0x0028, 0x0000, BT_CLOSE}},
-        {0x005b, {0x005d, 0x0000, BT_OPEN}},
-        {0x005d, {0x005b, 0x0000, BT_CLOSE}},
-        {0x007b, {0x007d, 0x0000, BT_OPEN}},
-        {0x007d, {0x007b, 0x0000, BT_CLOSE}},
-        {0x0f3a, {0x0f3b, 0x0000, BT_OPEN}},
-        {0x0f3b, {0x0f3a, 0x0000, BT_CLOSE}},
-        {0x0f3c, {0x0f3d, 0x0000, BT_OPEN}},
-        {0x0f3d, {0x0f3c, 0x0000, BT_CLOSE}},
-        {0x169b, {0x169c, 0x0000, BT_OPEN}},
-        {0x169c, {0x169b, 0x0000, BT_CLOSE}},
-        {0x2045, {0x2046, 0x0000, BT_OPEN}},
-        {0x2046, {0x2045, 0x0000, BT_CLOSE}},
-        {0x207d, {0x207e, 0x0000, BT_OPEN}},
-        {0x207e, {0x207d, 0x0000, BT_CLOSE}},
-        {0x208d, {0x208e, 0x0000, BT_OPEN}},
-        {0x208e, {0x208d, 0x0000, BT_CLOSE}},
-        {0x2308, {0x2309, 0x0000, BT_OPEN}},
-        {0x2309, {0x2308, 0x0000, BT_CLOSE}},
-        {0x230a, {0x230b, 0x0000, BT_OPEN}},
-        {0x230b, {0x230a, 0x0000, BT_CLOSE}},
-        {0x2329, {0x232a, 0x3009, BT_OPEN}},
-        {0x232a, {0x2329, 0x3008, BT_CLOSE}},
-        {0x2768, {0x2769, 0x0000, BT_OPEN}},
-        {0x2769, {0x2768, 0x0000, BT_CLOSE}},
-        {0x276a, {0x276b, 0x0000, BT_OPEN}},
-        {0x276b, {0x276a, 0x0000, BT_CLOSE}},
-        {0x276c, {0x276d, 0x0000, BT_OPEN}},
-        {0x276d, {0x276c, 0x0000, BT_CLOSE}},
-        {0x276e, {0x276f, 0x0000, BT_OPEN}},
-        {0x276f, {0x276e, 0x0000, BT_CLOSE}},
-        {0x2770, {0x2771, 0x0000, BT_OPEN}},
-        {0x2771, {0x2770, 0x0000, BT_CLOSE}},
-        {0x2772, {0x2773, 0x0000, BT_OPEN}},
-        {0x2773, {0x2772, 0x0000, BT_CLOSE}},
-        {0x2774, {0x2775, 0x0000, BT_OPEN}},
-        {0x2775, {0x2774, 0x0000, BT_CLOSE}},
-        {0x27c5, {0x27c6, 0x0000, BT_OPEN}},
-        {0x27c6, {0x27c5, 0x0000, BT_CLOSE}},
-        {0x27e6, {0x27e7, 0x0000, BT_OPEN}},
-        {0x27e7, {0x27e6, 0x0000, BT_CLOSE}},
-        {0x27e8, {0x27e9, 0x0000, BT_OPEN}},
-        {0x27e9, {0x27e8, 0x0000, BT_CLOSE}},
-        {0x27ea, {0x27eb, 0x0000, BT_OPEN}},
-        {0x27eb, {0x27ea, 0x0000, BT_CLOSE}},
-        {0x27ec, {0x27ed, 0x0000, BT_OPEN}},
-        {0x27ed, {0x27ec, 0x0000, BT_CLOSE}},
-        {0x27ee, {0x27ef, 0x0000, BT_OPEN}},
-        {0x27ef, {0x27ee, 0x0000, BT_CLOSE}},
-        {0x2983, {0x2984, 0x0000, BT_OPEN}},
-        {0x2984, {0x2983, 0x0000, BT_CLOSE}},
-        {0x2985, {0x2986, 0x0000, BT_OPEN}},
-        {0x2986, {0x2985, 0x0000, BT_CLOSE}},
-        {0x2987, {0x2988, 0x0000, BT_OPEN}},
-        {0x2988, {0x2987, 0x0000, BT_CLOSE}},
-        {0x2989, {0x298a, 0x0000, BT_OPEN}},
-        {0x298a, {0x2989, 0x0000, BT_CLOSE}},
-        {0x298b, {0x298c, 0x0000, BT_OPEN}},
-        {0x298c, {0x298b, 0x0000, BT_CLOSE}},
-        {0x298d, {0x2990, 0x0000, BT_OPEN}},
-        {0x298e, {0x298f, 0x0000, BT_CLOSE}},
-        {0x298f, {0x298e, 0x0000, BT_OPEN}},
-        {0x2990, {0x298d, 0x0000, BT_CLOSE}},
-        {0x2991, {0x2992, 0x0000, BT_OPEN}},
-        {0x2992, {0x2991, 0x0000, BT_CLOSE}},
-        {0x2993, {0x2994, 0x0000, BT_OPEN}},
-        {0x2994, {0x2993, 0x0000, BT_CLOSE}},
-        {0x2995, {0x2996, 0x0000, BT_OPEN}},
-        {0x2996, {0x2995, 0x0000, BT_CLOSE}},
-        {0x2997, {0x2998, 0x0000, BT_OPEN}},
-        {0x2998, {0x2997, 0x0000, BT_CLOSE}},
-        {0x29d8, {0x29d9, 0x0000, BT_OPEN}},
-        {0x29d9, {0x29d8, 0x0000, BT_CLOSE}},
-        {0x29da, {0x29db, 0x0000, BT_OPEN}},
-        {0x29db, {0x29da, 0x0000, BT_CLOSE}},
-        {0x29fc, {0x29fd, 0x0000, BT_OPEN}},
-        {0x29fd, {0x29fc, 0x0000, BT_CLOSE}},
-        {0x2e22, {0x2e23, 0x0000, BT_OPEN}},
-        {0x2e23, {0x2e22, 0x0000, BT_CLOSE}},
-        {0x2e24, {0x2e25, 0x0000, BT_OPEN}},
-        {0x2e25, {0x2e24, 0x0000, BT_CLOSE}},
-        {0x2e26, {0x2e27, 0x0000, BT_OPEN}},
-        {0x2e27, {0x2e26, 0x0000, BT_CLOSE}},
-        {0x2e28, {0x2e29, 0x0000, BT_OPEN}},
-        {0x2e29, {0x2e28, 0x0000, BT_CLOSE}},
-        {0x2e55, {0x2e56, 0x0000, BT_OPEN}},
-        {0x2e56, {0x2e55, 0x0000, BT_CLOSE}},
-        {0x2e57, {0x2e58, 0x0000, BT_OPEN}},
-        {0x2e58, {0x2e57, 0x0000, BT_CLOSE}},
-        {0x2e59, {0x2e5a, 0x0000, BT_OPEN}},
-        {0x2e5a, {0x2e59, 0x0000, BT_CLOSE}},
-        {0x2e5b, {0x2e5c, 0x0000, BT_OPEN}},
-        {0x2e5c, {0x2e5b, 0x0000, BT_CLOSE}},
-        {0x3008, {0x3009, 0x232a, BT_OPEN}},
-        {0x3009, {0x3008, 0x2329, BT_CLOSE}},
-        {0x300a, {0x300b, 0x0000, BT_OPEN}},
-        {0x300b, {0x300a, 0x0000, BT_CLOSE}},
-        {0x300c, {0x300d, 0x0000, BT_OPEN}},
-        {0x300d, {0x300c, 0x0000, BT_CLOSE}},
-        {0x300e, {0x300f, 0x0000, BT_OPEN}},
-        {0x300f, {0x300e, 0x0000, BT_CLOSE}},
-        {0x3010, {0x3011, 0x0000, BT_OPEN}},
-        {0x3011, {0x3010, 0x0000, BT_CLOSE}},
-        {0x3014, {0x3015, 0x0000, BT_OPEN}},
-        {0x3015, {0x3014, 0x0000, BT_CLOSE}},
-        {0x3016, {0x3017, 0x0000, BT_OPEN}},
-        {0x3017, {0x3016, 0x0000, BT_CLOSE}},
-        {0x3018, {0x3019, 0x0000, BT_OPEN}},
-        {0x3019, {0x3018, 0x0000, BT_CLOSE}},
-        {0x301a, {0x301b, 0x0000, BT_OPEN}},
-        {0x301b, {0x301a, 0x0000, BT_CLOSE}},
-        {0xfe59, {0xfe5a, 0x0000, BT_OPEN}},
-        {0xfe5a, {0xfe59, 0x0000, BT_CLOSE}},
-        {0xfe5b, {0xfe5c, 0x0000, BT_OPEN}},
-        {0xfe5c, {0xfe5b, 0x0000, BT_CLOSE}},
-        {0xfe5d, {0xfe5e, 0x0000, BT_OPEN}},
-        {0xfe5e, {0xfe5d, 0x0000, BT_CLOSE}},
-        {0xff08, {0xff09, 0x0000, BT_OPEN}},
-        {0xff09, {0xff08, 0x0000, BT_CLOSE}},
-        {0xff3b, {0xff3d, 0x0000, BT_OPEN}},
-        {0xff3d, {0xff3b, 0x0000, BT_CLOSE}},
-        {0xff5b, {0xff5d, 0x0000, BT_OPEN}},
-        {0xff5d, {0xff5b, 0x0000, BT_CLOSE}},
-        {0xff5f, {0xff60, 0x0000, BT_OPEN}},
-        {0xff60, {0xff5f, 0x0000, BT_CLOSE}},
-        {0xff62, {0xff63, 0x0000, BT_OPEN}},
-        {0xff63, {0xff62, 0x0000, BT_CLOSE}},
-    };
+static const struct {
+    unsigned src;
+    BracketTypeData payload;
+} bracket_pairs[] = {
+    {0x0028, {0x0029, 0x0000, BT_OPEN}},
+    {0x0029, {0x0028, 0x0000, BT_CLOSE}},
+    {0x005b, {0x005d, 0x0000, BT_OPEN}},
+    {0x005d, {0x005b, 0x0000, BT_CLOSE}},
+    {0x007b, {0x007d, 0x0000, BT_OPEN}},
+    {0x007d, {0x007b, 0x0000, BT_CLOSE}},
+    {0x0f3a, {0x0f3b, 0x0000, BT_OPEN}},
+    {0x0f3b, {0x0f3a, 0x0000, BT_CLOSE}},
+    {0x0f3c, {0x0f3d, 0x0000, BT_OPEN}},
+    {0x0f3d, {0x0f3c, 0x0000, BT_CLOSE}},
+    {0x169b, {0x169c, 0x0000, BT_OPEN}},
+    {0x169c, {0x169b, 0x0000, BT_CLOSE}},
+    {0x2045, {0x2046, 0x0000, BT_OPEN}},
+    {0x2046, {0x2045, 0x0000, BT_CLOSE}},
+    {0x207d, {0x207e, 0x0000, BT_OPEN}},
+    {0x207e, {0x207d, 0x0000, BT_CLOSE}},
+    {0x208d, {0x208e, 0x0000, BT_OPEN}},
+    {0x208e, {0x208d, 0x0000, BT_CLOSE}},
+    {0x2308, {0x2309, 0x0000, BT_OPEN}},
+    {0x2309, {0x2308, 0x0000, BT_CLOSE}},
+    {0x230a, {0x230b, 0x0000, BT_OPEN}},
+    {0x230b, {0x230a, 0x0000, BT_CLOSE}},
+    {0x2329, {0x232a, 0x3009, BT_OPEN}},
+    {0x232a, {0x2329, 0x3008, BT_CLOSE}},
+    {0x2768, {0x2769, 0x0000, BT_OPEN}},
+    {0x2769, {0x2768, 0x0000, BT_CLOSE}},
+    {0x276a, {0x276b, 0x0000, BT_OPEN}},
+    {0x276b, {0x276a, 0x0000, BT_CLOSE}},
+    {0x276c, {0x276d, 0x0000, BT_OPEN}},
+    {0x276d, {0x276c, 0x0000, BT_CLOSE}},
+    {0x276e, {0x276f, 0x0000, BT_OPEN}},
+    {0x276f, {0x276e, 0x0000, BT_CLOSE}},
+    {0x2770, {0x2771, 0x0000, BT_OPEN}},
+    {0x2771, {0x2770, 0x0000, BT_CLOSE}},
+    {0x2772, {0x2773, 0x0000, BT_OPEN}},
+    {0x2773, {0x2772, 0x0000, BT_CLOSE}},
+    {0x2774, {0x2775, 0x0000, BT_OPEN}},
+    {0x2775, {0x2774, 0x0000, BT_CLOSE}},
+    {0x27c5, {0x27c6, 0x0000, BT_OPEN}},
+    {0x27c6, {0x27c5, 0x0000, BT_CLOSE}},
+    {0x27e6, {0x27e7, 0x0000, BT_OPEN}},
+    {0x27e7, {0x27e6, 0x0000, BT_CLOSE}},
+    {0x27e8, {0x27e9, 0x0000, BT_OPEN}},
+    {0x27e9, {0x27e8, 0x0000, BT_CLOSE}},
+    {0x27ea, {0x27eb, 0x0000, BT_OPEN}},
+    {0x27eb, {0x27ea, 0x0000, BT_CLOSE}},
+    {0x27ec, {0x27ed, 0x0000, BT_OPEN}},
+    {0x27ed, {0x27ec, 0x0000, BT_CLOSE}},
+    {0x27ee, {0x27ef, 0x0000, BT_OPEN}},
+    {0x27ef, {0x27ee, 0x0000, BT_CLOSE}},
+    {0x2983, {0x2984, 0x0000, BT_OPEN}},
+    {0x2984, {0x2983, 0x0000, BT_CLOSE}},
+    {0x2985, {0x2986, 0x0000, BT_OPEN}},
+    {0x2986, {0x2985, 0x0000, BT_CLOSE}},
+    {0x2987, {0x2988, 0x0000, BT_OPEN}},
+    {0x2988, {0x2987, 0x0000, BT_CLOSE}},
+    {0x2989, {0x298a, 0x0000, BT_OPEN}},
+    {0x298a, {0x2989, 0x0000, BT_CLOSE}},
+    {0x298b, {0x298c, 0x0000, BT_OPEN}},
+    {0x298c, {0x298b, 0x0000, BT_CLOSE}},
+    {0x298d, {0x2990, 0x0000, BT_OPEN}},
+    {0x298e, {0x298f, 0x0000, BT_CLOSE}},
+    {0x298f, {0x298e, 0x0000, BT_OPEN}},
+    {0x2990, {0x298d, 0x0000, BT_CLOSE}},
+    {0x2991, {0x2992, 0x0000, BT_OPEN}},
+    {0x2992, {0x2991, 0x0000, BT_CLOSE}},
+    {0x2993, {0x2994, 0x0000, BT_OPEN}},
+    {0x2994, {0x2993, 0x0000, BT_CLOSE}},
+    {0x2995, {0x2996, 0x0000, BT_OPEN}},
+    {0x2996, {0x2995, 0x0000, BT_CLOSE}},
+    {0x2997, {0x2998, 0x0000, BT_OPEN}},
+    {0x2998, {0x2997, 0x0000, BT_CLOSE}},
+    {0x29d8, {0x29d9, 0x0000, BT_OPEN}},
+    {0x29d9, {0x29d8, 0x0000, BT_CLOSE}},
+    {0x29da, {0x29db, 0x0000, BT_OPEN}},
+    {0x29db, {0x29da, 0x0000, BT_CLOSE}},
+    {0x29fc, {0x29fd, 0x0000, BT_OPEN}},
+    {0x29fd, {0x29fc, 0x0000, BT_CLOSE}},
+    {0x2e22, {0x2e23, 0x0000, BT_OPEN}},
+    {0x2e23, {0x2e22, 0x0000, BT_CLOSE}},
+    {0x2e24, {0x2e25, 0x0000, BT_OPEN}},
+    {0x2e25, {0x2e24, 0x0000, BT_CLOSE}},
+    {0x2e26, {0x2e27, 0x0000, BT_OPEN}},
+    {0x2e27, {0x2e26, 0x0000, BT_CLOSE}},
+    {0x2e28, {0x2e29, 0x0000, BT_OPEN}},
+    {0x2e29, {0x2e28, 0x0000, BT_CLOSE}},
+    {0x2e55, {0x2e56, 0x0000, BT_OPEN}},
+    {0x2e56, {0x2e55, 0x0000, BT_CLOSE}},
+    {0x2e57, {0x2e58, 0x0000, BT_OPEN}},
+    {0x2e58, {0x2e57, 0x0000, BT_CLOSE}},
+    {0x2e59, {0x2e5a, 0x0000, BT_OPEN}},
+    {0x2e5a, {0x2e59, 0x0000, BT_CLOSE}},
+    {0x2e5b, {0x2e5c, 0x0000, BT_OPEN}},
+    {0x2e5c, {0x2e5b, 0x0000, BT_CLOSE}},
+    {0x3008, {0x3009, 0x232a, BT_OPEN}},
+    {0x3009, {0x3008, 0x2329, BT_CLOSE}},
+    {0x300a, {0x300b, 0x0000, BT_OPEN}},
+    {0x300b, {0x300a, 0x0000, BT_CLOSE}},
+    {0x300c, {0x300d, 0x0000, BT_OPEN}},
+    {0x300d, {0x300c, 0x0000, BT_CLOSE}},
+    {0x300e, {0x300f, 0x0000, BT_OPEN}},
+    {0x300f, {0x300e, 0x0000, BT_CLOSE}},
+    {0x3010, {0x3011, 0x0000, BT_OPEN}},
+    {0x3011, {0x3010, 0x0000, BT_CLOSE}},
+    {0x3014, {0x3015, 0x0000, BT_OPEN}},
+    {0x3015, {0x3014, 0x0000, BT_CLOSE}},
+    {0x3016, {0x3017, 0x0000, BT_OPEN}},
+    {0x3017, {0x3016, 0x0000, BT_CLOSE}},
+    {0x3018, {0x3019, 0x0000, BT_OPEN}},
+    {0x3019, {0x3018, 0x0000, BT_CLOSE}},
+    {0x301a, {0x301b, 0x0000, BT_OPEN}},
+    {0x301b, {0x301a, 0x0000, BT_CLOSE}},
+    {0xfe59, {0xfe5a, 0x0000, BT_OPEN}},
+    {0xfe5a, {0xfe59, 0x0000, BT_CLOSE}},
+    {0xfe5b, {0xfe5c, 0x0000, BT_OPEN}},
+    {0xfe5c, {0xfe5b, 0x0000, BT_CLOSE}},
+    {0xfe5d, {0xfe5e, 0x0000, BT_OPEN}},
+    {0xfe5e, {0xfe5d, 0x0000, BT_CLOSE}},
+    {0xff08, {0xff09, 0x0000, BT_OPEN}},
+    {0xff09, {0xff08, 0x0000, BT_CLOSE}},
+    {0xff3b, {0xff3d, 0x0000, BT_OPEN}},
+    {0xff3d, {0xff3b, 0x0000, BT_CLOSE}},
+    {0xff5b, {0xff5d, 0x0000, BT_OPEN}},
+    {0xff5d, {0xff5b, 0x0000, BT_CLOSE}},
+    {0xff5f, {0xff60, 0x0000, BT_OPEN}},
+    {0xff60, {0xff5f, 0x0000, BT_CLOSE}},
+    {0xff62, {0xff63, 0x0000, BT_OPEN}},
+    {0xff63, {0xff62, 0x0000, BT_CLOSE}},
+};
 
+#ifdef TEST
+static BracketTypeData ref_bracket_type(unsigned int ch)
+{
     int i, j, k;
 
     i = -1;
@@ -2353,6 +2383,18 @@ static BracketTypeData bracket_type(unsigned int ch)
     static const BracketTypeData null = { 0, 0, BT_NONE };
     return null;
 }
+#endif /* TEST */
+
+static BracketTypeData bracket_type(unsigned int ch)
+{
+    unsigned index = (ch < 0x110000 ? bidi_bracket_lookup(ch) : 0);
+
+    if (index)
+        return bracket_pairs[index - 1].payload;
+
+    static const BracketTypeData null = { 0, 0, BT_NONE };
+    return null;
+}
 
 /*
  * Function exported to front ends to allow them to identify
@@ -3607,3 +3649,100 @@ void do_bidi(BidiContext *ctx, bidi_char *text, size_t textlen)
     do_bidi_new(ctx, text, textlen);
 #endif
 }
+
+#ifdef TEST
+
+/*
+ * Check the lookup tables against the original binary searches, for
+ * every character in the Unicode code space and a few beyond it, and
+ * then time the two over some typical ranges of text.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+void out_of_memory(void) { fprintf(stderr, "out of memory\n"); abort(); }
+
+static volatile unsigned sink;
+
+static unsigned type_fn(unsigned c) { return bidi_getType(c); }
+static unsigned ref_type_fn(unsigned c) { return ref_bidi_getType(c); }
+static unsigned mirror_fn(unsigned c) { return mirror_glyph(c); }
+static unsigned ref_mirror_fn(unsigned c) { return ref_mirror_glyph(c); }
+static unsigned bracket_fn(unsigned c) { return bracket_type(c).partner; }
+static unsigned ref_bracket_fn(unsigned c)
+{ return ref_bracket_type(c).partner; }
+
+static double time_range(unsigned (*fn)(unsigned), unsigned lo, unsigned hi)
+{
+    /* call through a volatile pointer, so that the compiler can't
+     * inline one function under test and not the other */
+    unsigned (*volatile vfn)(unsigned) = fn;
+    unsigned reps = 1 + (1 << 24) / (hi - lo), total = 0;
+    clock_t start = clock();
+
+    for (unsigned r = 0; r < reps; r++)
+        for (unsigned c = lo; c < hi; c++)
+            total += vfn(c);
+    sink = total;
+    return (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 /
+        ((double)reps * (hi - lo));
+}
+
+int main(void)
+{
+    static const struct {
+        const char *name;
+        unsigned lo, hi;
+    } ranges[] = {
+        {"ASCII", 0x20, 0x7F},
+        {"Latin/Greek/Cyrillic", 0xA0, 0x500},
+        {"Arabic/Hebrew", 0x590, 0x800},
+        {"CJK ideographs", 0x4E00, 0xA000},
+        {"whole code space", 0, 0x110000},
+    };
+    unsigned nfail = 0;
+
+    for (unsigned c = 0; c < 0x110100; c++) {
+        BracketTypeData bt = bracket_type(c), rbt = ref_bracket_type(c);
+
+        if (bidi_getType(c) != ref_bidi_getType(c)) {
+            printf("U+%04X: bidi_getType gives %d, expected %d\n",
+                   c, bidi_getType(c), ref_bidi_getType(c));
+            nfail++;
+        }
+        if (mirror_glyph(c) != ref_mirror_glyph(c)) {
+            printf("U+%04X: mirror_glyph gives U+%04X, expected U+%04X\n",
+                   c, mirror_glyph(c), ref_mirror_glyph(c));
+            nfail++;
+        }
+        if (bt.partner != rbt.partner ||
+            bt.equiv_partner != rbt.equiv_partner || bt.type != rbt.type) {
+            printf("U+%04X: bracket_type disagrees\n", c);
+            nfail++;
+        }
+    }
+    if (bidi_getType(-1) != ref_bidi_getType(-1)) {
+        printf("bidi_getType(-1) disagrees\n");
+        nfail++;
+    }
+    printf("equivalence: %u failures\n", nfail);
+
+    printf("%-22s %10s %10s %10s %10s %10s %10s\n", "ns/char",
+           "type ref", "type", "mirror ref", "mirror",
+           "brack ref", "bracket");
+    for (size_t i = 0; i < lenof(ranges); i++) {
+        unsigned lo = ranges[i].lo, hi = ranges[i].hi;
+        printf("%-22s %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+               ranges[i].name,
+               time_range(ref_type_fn, lo, hi), time_range(type_fn, lo, hi),
+               time_range(ref_mirror_fn, lo, hi),
+               time_range(mirror_fn, lo, hi),
+               time_range(ref_bracket_fn, lo, hi),
+               time_range(bracket_fn, lo, hi));
+    }
+
+    return nfail != 0;
+}
+
+#endif /* TEST */
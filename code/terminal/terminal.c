@@ -13,6 +13,12 @@
 #include "putty.h"
 #include "terminal.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TERM_RUN_SSE2
+#endif
+
 #define VT52_PLUS
 
 #define CL_ANSIMIN      0x0001         /* Codes in all ANSI like terminals. */
@@ -101,6 +107,8 @@ static void parse_optionalrgb(optionalrgb *out, unsigned *values);
 static void term_added_data(Terminal *term, bool);
 static void term_update_raw_mouse_mode(Terminal *term);
 static void term_out_cb(void *);
+static int bidi_lru_cmp(void *, void *);
+static void bidi_lru_clear(Terminal *term);
 
 static termline *newtermline(Terminal *term, int cols, bool bce)
 {
@@ -116,10 +124,20 @@ static termline *newtermline(Terminal *term, int cols, bool bce)
     line->trusted = false;
     line->temporary = false;
     line->cc_free = 0;
+    line->gen = ++term->line_gen;
 
     return line;
 }
 
+/*
+ * Give a line a new generation number, to record that its contents
+ * are about to change, so that do_paint will look at it again.
+ */
+static inline void line_modified(Terminal *term, termline *line)
+{
+    line->gen = ++term->line_gen;
+}
+
 static void freetermline(termline *line)
 {
     if (line) {
@@ -957,6 +975,7 @@ static termline *decompressline_no_free(compressed_scrollback_line *line)
     ldata->cols = ldata->size = ncols;
     ldata->temporary = true;
     ldata->cc_free = 0;
+    ldata->gen = 0;
 
     /*
      * We must set all the cc pointers in ldata->chars to 0 right
@@ -1058,6 +1077,337 @@ static inline void free_compressed_line(compressed_scrollback_line *line)
 
 #endif /* NO_SCROLLBACK_COMPRESSION */
 
+/*
+ * The scrollback as a whole is a list of compressed lines, oldest
+ * first. Normally they're all kept in the tree234 term->scrollback.
+ * But if sb_memlines is nonzero, only that many of the most recent
+ * lines are kept there, and older ones are moved out to a temporary
+ * file, so that the memory used by a long scrollback is bounded.
+ *
+ * The file is divided into segments, each of which holds a run of
+ * whole lines, stored in the same form as in memory. A segment is
+ * reused once every line in it has been deleted. Lines are read by
+ * mapping the segment containing them into memory, and we keep only
+ * a few segments mapped at once, evicting the least recently used.
+ *
+ * The functions sb_count, sb_index, sb_add, sb_delete_oldest,
+ * sb_remove_newest and sb_clear operate on the whole scrollback, and
+ * are the only things that should touch term->scrollback directly.
+ */
+#define SPILL_SEGMENT_SIZE 0x100000
+#define SPILL_MAPPED_SEGMENTS 4
+#define SPILL_ALIGN sizeof(size_t)
+
+typedef struct spilled_line {
+    size_t seg, offset;
+} spilled_line;
+
+struct scrollback_spill {
+    SpillFile *sf;
+
+    /* Spilled lines, oldest first, are lines[start .. start+nlines-1] */
+    spilled_line *lines;
+    size_t start, nlines, linesize;
+
+    /* Number of live lines in each segment, and a list of free ones */
+    size_t *seglive;
+    size_t nsegs, segsize;
+    size_t *freesegs;
+    size_t nfreesegs, freesegsize;
+
+    /* Where the next line will be written */
+    size_t wseg, woffset;
+
+    struct {
+        void *p;
+        size_t seg;
+        unsigned long lastuse;
+    } maps[SPILL_MAPPED_SEGMENTS];
+    unsigned long usecount;
+};
+
+#ifndef NO_SCROLLBACK_COMPRESSION
+
+static inline size_t spill_record_size(compressed_scrollback_line *cline)
+{
+    size_t size = sizeof(compressed_scrollback_line) + cline->len;
+    return (size + SPILL_ALIGN - 1) & ~(SPILL_ALIGN - 1);
+}
+
+static struct scrollback_spill *spill_new(void)
+{
+    SpillFile *sf = spillfile_new(SPILL_SEGMENT_SIZE);
+    if (!sf)
+        return NULL;
+
+    struct scrollback_spill *spill = snew(struct scrollback_spill);
+    memset(spill, 0, sizeof(*spill));
+    spill->sf = sf;
+    spill->wseg = SIZE_MAX;
+    return spill;
+}
+
+static void spill_free(struct scrollback_spill *spill)
+{
+    for (size_t i = 0; i < SPILL_MAPPED_SEGMENTS; i++)
+        if (spill->maps[i].p)
+            spillfile_unmap(spill->sf, spill->maps[i].p);
+    spillfile_free(spill->sf);
+    sfree(spill->lines);
+    sfree(spill->seglive);
+    sfree(spill->freesegs);
+    sfree(spill);
+}
+
+/*
+ * Return a pointer to the mapped contents of a segment, mapping it if
+ * it isn't already, or NULL on failure.
+ */
+static unsigned char *spill_segment(struct scrollback_spill *spill,
+                                    size_t seg)
+{
+    size_t i, victim = 0;
+
+    for (i = 0; i < SPILL_MAPPED_SEGMENTS; i++) {
+        if (spill->maps[i].p && spill->maps[i].seg == seg) {
+            spill->maps[i].lastuse = ++spill->usecount;
+            return spill->maps[i].p;
+        }
+        if (!spill->maps[i].p ||
+            (spill->maps[victim].p &&
+             spill->maps[i].lastuse < spill->maps[victim].lastuse))
+            victim = i;
+    }
+
+    if (spill->maps[victim].p) {
+        spillfile_unmap(spill->sf, spill->maps[victim].p);
+        spill->maps[victim].p = NULL;
+    }
+    spill->maps[victim].p = spillfile_map(spill->sf, seg);
+    spill->maps[victim].seg = seg;
+    spill->maps[victim].lastuse = ++spill->usecount;
+    return spill->maps[victim].p;
+}
+
+/*
+ * Note that a line has been deleted from a segment, and recycle the
+ * segment if that was the last one in it.
+ */
+static void spill_release(struct scrollback_spill *spill, size_t seg)
+{
+    assert(spill->seglive[seg] > 0);
+    if (--spill->seglive[seg] > 0)
+        return;
+
+    if (seg == spill->wseg) {
+        spill->woffset = 0;
+    } else {
+        sgrowarray(spill->freesegs, spill->freesegsize, spill->nfreesegs);
+        spill->freesegs[spill->nfreesegs++] = seg;
+    }
+}
+
+/*
+ * Append a line to the spill file. Returns false, having changed
+ * nothing, if that's not possible.
+ */
+static bool spill_add(struct scrollback_spill *spill,
+                      compressed_scrollback_line *cline)
+{
+    size_t size = spill_record_size(cline);
+    unsigned char *p;
+
+    if (size > SPILL_SEGMENT_SIZE)
+        return false;
+
+    if (spill->wseg == SIZE_MAX ||
+        spill->woffset + size > SPILL_SEGMENT_SIZE) {
+        /* Move on to a fresh segment */
+        size_t seg;
+        if (spill->nfreesegs) {
+            seg = spill->freesegs[--spill->nfreesegs];
+        } else {
+            sgrowarray(spill->seglive, spill->segsize, spill->nsegs);
+            seg = spill->nsegs++;
+            spill->seglive[seg] = 0;
+        }
+        if (!spill_segment(spill, seg)) {
+            if (seg == spill->nsegs - 1)
+                spill->nsegs--;
+            else
+                spill->freesegs[spill->nfreesegs++] = seg;
+            return false;
+        }
+        if (spill->wseg != SIZE_MAX && spill->seglive[spill->wseg] == 0) {
+            sgrowarray(spill->freesegs, spill->freesegsize,
+                       spill->nfreesegs);
+            spill->freesegs[spill->nfreesegs++] = spill->wseg;
+        }
+        spill->wseg = seg;
+        spill->woffset = 0;
+    }
+
+    if (!(p = spill_segment(spill, spill->wseg)))
+        return false;
+    memcpy(p + spill->woffset, cline,
+           sizeof(compressed_scrollback_line) + cline->len);
+
+    if (spill->start > 0 && spill->start >= spill->nlines &&
+        spill->start + spill->nlines >= spill->linesize) {
+        /* Reclaim the space at the start of the index, once it's at
+         * least as big as the part in use */
+        memmove(spill->lines, spill->lines + spill->start,
+                spill->nlines * sizeof(*spill->lines));
+        spill->start = 0;
+    }
+    sgrowarray(spill->lines, spill->linesize, spill->start + spill->nlines);
+    spill->lines[spill->start + spill->nlines].seg = spill->wseg;
+    spill->lines[spill->start + spill->nlines].offset = spill->woffset;
+    spill->nlines++;
+
+    spill->seglive[spill->wseg]++;
+    spill->woffset += size;
+    return true;
+}
+
+/*
+ * A blank line, returned if a spilled line can't be read back.
+ */
+static const struct {
+    compressed_scrollback_line hdr;
+    unsigned char data[2];      /* zero columns, zero lattr */
+} spill_unavailable_line = { { 2 }, { 0, 0 } };
+
+static compressed_scrollback_line *spill_index(
+    struct scrollback_spill *spill, size_t i)
+{
+    spilled_line *l = &spill->lines[spill->start + i];
+    unsigned char *p = spill_segment(spill, l->seg);
+    if (!p)
+        return (compressed_scrollback_line *)&spill_unavailable_line;
+    return (compressed_scrollback_line *)(p + l->offset);
+}
+
+static void spill_delete_oldest(struct scrollback_spill *spill)
+{
+    assert(spill->nlines > 0);
+    spill_release(spill, spill->lines[spill->start].seg);
+    spill->start++;
+    spill->nlines--;
+}
+
+static compressed_scrollback_line *spill_remove_newest(
+    struct scrollback_spill *spill)
+{
+    compressed_scrollback_line *cline, *copy;
+    spilled_line l;
+    size_t size;
+
+    assert(spill->nlines > 0);
+    l = spill->lines[spill->start + spill->nlines - 1];
+    cline = spill_index(spill, spill->nlines - 1);
+    size = sizeof(compressed_scrollback_line) + cline->len;
+    copy = (compressed_scrollback_line *)snewn(size, unsigned char);
+    memcpy(copy, cline, size);
+
+    spill->nlines--;
+    if (l.seg == spill->wseg &&
+        l.offset + spill_record_size(copy) == spill->woffset)
+        spill->woffset = l.offset;
+    spill_release(spill, l.seg);
+    return copy;
+}
+
+#endif /* NO_SCROLLBACK_COMPRESSION */
+
+static inline size_t sb_spilled(Terminal *term)
+{
+    return term->sbspill ? term->sbspill->nlines : 0;
+}
+
+static int sb_count(Terminal *term)
+{
+    return sb_spilled(term) + count234(term->scrollback);
+}
+
+/*
+ * Return a scrollback line, by index from the oldest. The returned
+ * pointer is only valid until the next call to any sb_ function.
+ */
+static compressed_scrollback_line *sb_index(Terminal *term, int i)
+{
+    size_t nspilled = sb_spilled(term);
+#ifndef NO_SCROLLBACK_COMPRESSION
+    if (i >= 0 && i < nspilled)
+        return spill_index(term->sbspill, i);
+#endif
+    return index234(term->scrollback, i - nspilled);
+}
+
+/*
+ * Add a line to the scrollback as the newest one, and move older
+ * lines out to the spill file if there are now too many in memory.
+ */
+static void sb_add(Terminal *term, compressed_scrollback_line *cline)
+{
+    addpos234(term->scrollback, cline, count234(term->scrollback));
+
+#ifndef NO_SCROLLBACK_COMPRESSION
+    while (term->sb_memlines > 0 &&
+           count234(term->scrollback) > term->sb_memlines) {
+        if (!term->sbspill) {
+            if (term->sbspill_failed ||
+                !(term->sbspill = spill_new())) {
+                term->sbspill_failed = true;
+                return;
+            }
+        }
+        if (!spill_add(term->sbspill, index234(term->scrollback, 0)))
+            return;                    /* just keep it in memory */
+        free_compressed_line(delpos234(term->scrollback, 0));
+    }
+#endif
+}
+
+static void sb_delete_oldest(Terminal *term)
+{
+#ifndef NO_SCROLLBACK_COMPRESSION
+    if (sb_spilled(term)) {
+        spill_delete_oldest(term->sbspill);
+        return;
+    }
+#endif
+    free_compressed_line(delpos234(term->scrollback, 0));
+}
+
+/*
+ * Remove the newest line from the scrollback, and return it for the
+ * caller to free.
+ */
+static compressed_scrollback_line *sb_remove_newest(Terminal *term)
+{
+    int n = count234(term->scrollback);
+#ifndef NO_SCROLLBACK_COMPRESSION
+    if (n == 0 && sb_spilled(term))
+        return spill_remove_newest(term->sbspill);
+#endif
+    return delpos234(term->scrollback, n - 1);
+}
+
+static void sb_clear(Terminal *term)
+{
+    compressed_scrollback_line *cline;
+
+    while ((cline = delpos234(term->scrollback, 0)) != NULL)
+        free_compressed_line(cline);
+#ifndef NO_SCROLLBACK_COMPRESSION
+    if (term->sbspill) {
+        spill_free(term->sbspill);
+        term->sbspill = NULL;
+    }
+#endif
+}
+
 /*
  * Resize a line to make it `cols' columns wide.
  */
@@ -1068,6 +1418,7 @@ static void resizeline(Terminal *term, termline *line, int cols)
     if (line->cols != cols) {
 
         oldcols = line->cols;
+        line_modified(term, line);
 
         /*
          * This line is the wrong length, which probably means it
@@ -1140,7 +1491,7 @@ static void resizeline(Terminal *term, termline *line, int cols)
  */
 static int sblines(Terminal *term)
 {
-    int sblines = count234(term->scrollback);
+    int sblines = sb_count(term);
     if (term->erase_to_scrollback &&
         term->alt_which && term->alt_screen) {
         sblines += term->alt_sblines;
@@ -1193,7 +1544,7 @@ static termline *lineptr(Terminal *term, int y, int lineno, int screen)
         }
         if (y < -altlines) {
             whichtree = term->scrollback;
-            treeindex = y + altlines + count234(term->scrollback);
+            treeindex = y + altlines + sb_count(term);
         } else {
             whichtree = term->alt_screen;
             treeindex = y + term->alt_sblines;
@@ -1201,7 +1552,7 @@ static termline *lineptr(Terminal *term, int y, int lineno, int screen)
         }
     }
     if (whichtree == term->scrollback) {
-        compressed_scrollback_line *cline = index234(whichtree, treeindex);
+        compressed_scrollback_line *cline = sb_index(term, treeindex);
         if (!cline)
             null_line_error(term, y, lineno, whichtree, treeindex, "cline");
         line = decompressline_no_free(cline);
@@ -1234,6 +1585,13 @@ static termline *lineptr(Terminal *term, int y, int lineno, int screen)
     if (term->cols > line->cols)
         resizeline(term, line, term->cols);
 
+    /*
+     * Callers only ask for a line of the screen using scrlineptr()
+     * when they're going to modify it.
+     */
+    if (screen)
+        line_modified(term, line);
+
     return line;
 }
 
@@ -1640,6 +1998,7 @@ static void term_copy_stuff_from_conf(Terminal *term)
     term->rect_select = conf_get_bool(term->conf, CONF_rect_select);
     term->remote_qtitle_action = conf_get_int(term->conf, CONF_remote_qtitle_action);
     term->rxvt_homeend = conf_get_bool(term->conf, CONF_rxvt_homeend);
+    term->sb_memlines = conf_get_int(term->conf, CONF_savelines_in_memory);
     term->scroll_on_disp = conf_get_bool(term->conf, CONF_scroll_on_disp);
     term->scroll_on_key = conf_get_bool(term->conf, CONF_scroll_on_key);
     term->xterm_mouse_forbidden = conf_get_bool(term->conf, CONF_no_mouse_rep);
@@ -1730,6 +2089,7 @@ void term_reconfig(Terminal *term, Conf *conf)
             term->post_bidi_cache[i].width = -1;
             term->post_bidi_cache[i].chars = NULL;
         }
+        bidi_lru_clear(term);
     }
 
     {
@@ -1808,7 +2168,6 @@ void term_reconfig(Terminal *term, Conf *conf)
  */
 void term_clrsb(Terminal *term)
 {
-    unsigned char *line;
     int i;
 
     /*
@@ -1820,9 +2179,7 @@ void term_clrsb(Terminal *term)
     /*
      * Clear the actual scrollback.
      */
-    while ((line = delpos234(term->scrollback, 0)) != NULL) {
-        sfree(line);            /* this is compressed data, not a termline */
-    }
+    sb_clear(term);
 
     /*
      * When clearing the scrollback, we also truncate any termlines on
@@ -2047,11 +2404,16 @@ Terminal *term_init(Conf *myconf, struct unicode_data *ucsdata, TermWin *win)
     term_copy_stuff_from_conf(term);
 
     term->screen = term->alt_screen = term->scrollback = NULL;
+    term->sbspill = NULL;
+    term->sbspill_failed = false;
     term->tempsblines = 0;
     term->alt_sblines = 0;
     term->disptop = 0;
     term->disptext = NULL;
     term->dispcursx = term->dispcursy = -1;
+    term->line_gen = 0;
+    memset(&term->painted_state, 0, sizeof(term->painted_state));
+    memset(&term->paint_stats, 0, sizeof(term->paint_stats));
     term->tabs = NULL;
     deselect(term);
     term->rows = term->cols = -1;
@@ -2074,6 +2436,9 @@ Terminal *term_init(Conf *myconf, struct unicode_data *ucsdata, TermWin *win)
 
     term->bidi_cache_size = 0;
     term->pre_bidi_cache = term->post_bidi_cache = NULL;
+    term->bidi_lru = newtree234(bidi_lru_cmp);
+    term->bidi_lru_head = term->bidi_lru_tail = NULL;
+    term->bidi_lru_count = 0;
 
     /* FULL-TERMCHAR */
     term->basic_erase_char.chr = CSET_ASCII | ' ';
@@ -2127,13 +2492,11 @@ Terminal *term_init(Conf *myconf, struct unicode_data *ucsdata, TermWin *win)
 
 void term_free(Terminal *term)
 {
-    compressed_scrollback_line *cline;
     termline *line;
     struct beeptime *beep;
     int i;
 
-    while ((cline = delpos234(term->scrollback, 0)) != NULL)
-        free_compressed_line(cline);
+    sb_clear(term);
     freetree234(term->scrollback);
     while ((line = delpos234(term->screen, 0)) != NULL)
         freetermline(line);
@@ -2169,6 +2532,8 @@ void term_free(Terminal *term)
     }
     sfree(term->pre_bidi_cache);
     sfree(term->post_bidi_cache);
+    bidi_lru_clear(term);
+    freetree234(term->bidi_lru);
 
     sfree(term->tabs);
 
@@ -2248,7 +2613,7 @@ void term_size(Terminal *term, int newrows, int newcols, int newsavelines)
      *    amount of scrollback we actually have, we must throw some
      *    away.
      */
-    sblen = count234(term->scrollback);
+    sblen = sb_count(term);
     /* Do this loop to expand the screen if newrows > rows */
     assert(term->rows == count234(term->screen));
     while (term->rows < newrows) {
@@ -2256,8 +2621,10 @@ void term_size(Terminal *term, int newrows, int newcols, int newsavelines)
             compressed_scrollback_line *cline;
             /* Insert a line from the scrollback at the top of the screen. */
             assert(sblen >= term->tempsblines);
-            cline = delpos234(term->scrollback, --sblen);
+            cline = sb_remove_newest(term);
+            sblen--;
             line = decompressline_and_free(cline);
+            line_modified(term, line);
             line->temporary = false;   /* reconstituted line is now real */
             term->tempsblines -= 1;
             addpos234(term->screen, line, 0);
@@ -2281,7 +2648,8 @@ void term_size(Terminal *term, int newrows, int newcols, int newsavelines)
         } else {
             /* push top row to scrollback */
             line = delpos234(term->screen, 0);
-            addpos234(term->scrollback, compressline_and_free(line), sblen++);
+            sb_add(term, compressline_and_free(line));
+            sblen++;
             term->tempsblines += 1;
             term->curs.y -= 1;
             term->savecurs.y -= 1;
@@ -2295,14 +2663,13 @@ void term_size(Terminal *term, int newrows, int newcols, int newsavelines)
 
     /* Delete any excess lines from the scrollback. */
     while (sblen > newsavelines) {
-        line = delpos234(term->scrollback, 0);
-        sfree(line);
+        sb_delete_oldest(term);
         sblen--;
     }
     if (sblen < term->tempsblines)
         term->tempsblines = sblen;
-    assert(count234(term->scrollback) <= newsavelines);
-    assert(count234(term->scrollback) >= term->tempsblines);
+    assert(sb_count(term) <= newsavelines);
+    assert(sb_count(term) >= term->tempsblines);
     term->disptop = 0;
 
     /* Make a new displayed text buffer. */
@@ -2582,6 +2949,7 @@ static void check_selection(Terminal *term, pos from, pos to)
 
 static void clear_line(Terminal *term, termline *line)
 {
+    line_modified(term, line);
     resizeline(term, line, term->cols);
     for (int i = 0; i < term->cols; i++)
         copy_termchar(line, i, &term->erase_char);
@@ -2652,22 +3020,18 @@ static void scroll(Terminal *term, int topline, int botline,
             cc_check(line);
 #endif
             if (sb && term->savelines > 0) {
-                int sblen = count234(term->scrollback);
+                int sblen = sb_count(term);
                 /*
                  * We must add this line to the scrollback. We'll
                  * remove a line from the top of the scrollback if
                  * the scrollback is full.
                  */
-                if (sblen == term->savelines) {
-                    compressed_scrollback_line *cline;
-
-                    sblen--;
-                    cline = delpos234(term->scrollback, 0);
-                    free_compressed_line(cline);
-                } else
+                if (sblen == term->savelines)
+                    sb_delete_oldest(term);
+                else
                     term->tempsblines += 1;
 
-                addpos234(term->scrollback, compressline_no_free(line), sblen);
+                sb_add(term, compressline_no_free(line));
 
                 /* now `line' itself can be reused as the bottom line */
 
@@ -3721,6 +4085,148 @@ unsigned long term_translate(
     return c;
 }
 
+/*
+ * Return the length of the run of printable ASCII characters (0x20
+ * to 0x7E) at the start of a buffer.
+ */
+static size_t printable_ascii_run(const unsigned char *p, size_t len)
+{
+    size_t i = 0;
+
+#ifdef TERM_RUN_SSE2
+    const __m128i below = _mm_set1_epi8(0x1F), above = _mm_set1_epi8(0x7F);
+
+    for (; len - i >= 16; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        /* Signed comparisons, so bytes >= 0x80 fail the first one */
+        __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(v, below),
+                                   _mm_cmplt_epi8(v, above));
+        if (_mm_movemask_epi8(ok) != 0xFFFF)
+            break;
+    }
+#endif
+
+    for (; i < len && p[i] >= 0x20 && p[i] < 0x7F; i++);
+    return i;
+}
+
+/*
+ * Bulk counterpart of term_translate, for decoding runs of ordinary
+ * text. Starting from the ground state, it decodes characters into
+ * 'out' for as long as each one is a graphic character that
+ * term_translate would have returned as it is. It stops before
+ * anything that needs the full treatment from term_out: control
+ * characters (which could change the character set or start an
+ * escape sequence), and in UTF-8 mode, anything malformed,
+ * incomplete, or decoding to a character that term_translate treats
+ * specially. Returns the number of input bytes consumed.
+ */
+static size_t term_translate_run(
+    Terminal *term, const unsigned char *p, size_t len,
+    unsigned long *out, size_t outlen, size_t *nout)
+{
+    const unsigned char *ctrl = term->ucsdata->unitab_ctrl;
+    size_t i = 0, n = 0;
+
+    if (in_utf(term)) {
+        unsigned long cset = (term->utf8linedraw &&
+                              term->cset_attr[term->cset] == CSET_LINEDRW ?
+                              CSET_LINEDRW : CSET_ASCII);
+
+        while (i < len && n < outlen) {
+            unsigned long t = p[i];
+
+            if (t < 0x80) {
+                size_t run = printable_ascii_run(
+                    p + i, len - i < outlen - n ? len - i : outlen - n);
+                size_t j;
+                for (j = 0; j < run && ctrl[p[i+j]] == 0xFF; j++)
+                    out[n + j] = p[i+j] | cset;
+                i += j;
+                n += j;
+                if (j < run || !run)
+                    break;
+                continue;
+            } else if (t >= 0xC2 && t < 0xE0) {
+                if (len - i < 2 || (p[i+1] & 0xC0) != 0x80)
+                    break;
+                t = ((t & 0x1F) << 6) | (p[i+1] & 0x3F);
+                if (t < 0xA0)
+                    break;
+                i += 2;
+            } else if (t >= 0xE0 && t < 0xF0) {
+                if (len - i < 3 || (p[i+1] & 0xC0) != 0x80 ||
+                    (p[i+2] & 0xC0) != 0x80)
+                    break;
+                t = (((t & 0x0F) << 12) | ((p[i+1] & 0x3F) << 6) |
+                     (p[i+2] & 0x3F));
+                if (t < 0x800 || t == 0x2028 || t == 0x2029 ||
+                    (t >= 0xD800 && t < 0xE000) ||
+                    t == 0xFEFF || t == 0xFFFE || t == 0xFFFF)
+                    break;
+                i += 3;
+            } else if (t >= 0xF0 && t < 0xF5) {
+                if (len - i < 4 || (p[i+1] & 0xC0) != 0x80 ||
+                    (p[i+2] & 0xC0) != 0x80 || (p[i+3] & 0xC0) != 0x80)
+                    break;
+                t = (((t & 0x07) << 18) | ((p[i+1] & 0x3F) << 12) |
+                     ((p[i+2] & 0x3F) << 6) | (p[i+3] & 0x3F));
+                if (t < 0x10000 || t > 0x10FFFF ||
+                    (t >= 0xE0000 && t <= 0xE007F))
+                    break;
+                i += 4;
+            } else {
+                break;
+            }
+            out[n++] = t;
+        }
+    } else if (!term->sco_acs) {
+        /*
+         * In a single-byte character set, the input isn't translated
+         * to Unicode until it's displayed, so all we have to do here
+         * is tag each byte with its character set.
+         */
+        unsigned long cset = term->cset_attr[term->cset];
+
+        if (cset == CSET_ASCII || cset == CSET_LINEDRW) {
+            for (; i < len && n < outlen && ctrl[p[i]] == 0xFF; i++)
+                out[n++] = p[i] | cset;
+        } else if (cset == CSET_GBCHR) {
+            for (; i < len && n < outlen && ctrl[p[i]] == 0xFF; i++)
+                out[n++] = (p[i] == '#' ? '}' | CSET_LINEDRW :
+                            p[i] | CSET_ASCII);
+        }
+    }
+
+    *nout = n;
+    return i;
+}
+
+/*
+ * Fast path for term_out: decode a run of ordinary text from the
+ * input with term_translate_run, and display it. Returns the number
+ * of bytes consumed, which is zero if there was nothing it could
+ * handle.
+ */
+static size_t term_out_run(Terminal *term, const unsigned char *p,
+                           size_t len)
+{
+    unsigned long buf[256];
+    size_t used, n, i;
+
+    used = term_translate_run(term, p, len, buf, lenof(buf), &n);
+    for (i = 0; i < n; i++) {
+        term_display_graphic_char(term, buf[i]);
+        term->last_graphic_char = buf[i];
+        if (term->selstate != NO_SELECTION) {
+            pos cursplus = term->curs;
+            incpos(cursplus);
+            check_selection(term, term->curs, cursplus);
+        }
+    }
+    return used;
+}
+
 /*
  * Remove everything currently in `inbuf' and stick it up on the
  * in-memory display. There's a big state machine in here to
@@ -3795,6 +4301,23 @@ static void term_out(Terminal *term, bool called_from_term_data)
                 assert(chars != NULL);
                 assert(nchars_used < nchars_got);
             }
+
+            /*
+             * Runs of ordinary text, which is most of what a terminal
+             * receives, can be decoded in bulk and displayed without
+             * going all the way round this loop for every byte.
+             */
+            if (term->termstate == TOPLEVEL && term->utf8.state == 0 &&
+                !term->printing &&
+                !(term->logtype == LGTYP_DEBUG && term->logctx)) {
+                size_t used = term_out_run(term, chars + nchars_used,
+                                           nchars_got - nchars_used);
+                if (used) {
+                    nchars_used += used;
+                    continue;
+                }
+            }
+
             c = chars[nchars_used++];
 
             /*
@@ -5785,6 +6308,11 @@ static void parse_optionalrgb(optionalrgb *out, unsigned *values)
  * To prevent having to run the reasonably tricky bidi algorithm
  * too many times, we maintain a cache of the last lineful of data
  * fed to the algorithm on each line of the display.
+ *
+ * Behind that is a second cache (see struct bidi_lru_entry) of the
+ * results for the most recently seen lines in any row, so that lines
+ * which move to a different row, as they do whenever the screen
+ * scrolls, don't have to go through the algorithm again either.
  */
 static bool term_bidi_cache_hit(Terminal *term, int line,
                                 termchar *lbefore, int width, bool trusted)
@@ -5813,11 +6341,16 @@ static bool term_bidi_cache_hit(Terminal *term, int line,
     return true;                       /* it didn't match. */
 }
 
-static void term_bidi_cache_store(Terminal *term, int line, termchar *lbefore,
-                                  termchar *lafter, bidi_char *wcTo,
-                                  int width, int size, bool trusted)
+/*
+ * Set up the per-row cache entry for a line, storing the contents of
+ * the line before bidi processing, and allocating space for the
+ * results.
+ */
+static void term_bidi_cache_alloc(Terminal *term, int line, termchar *lbefore,
+                                  int width, int size, int postsize,
+                                  bool trusted)
 {
-    size_t i, j;
+    size_t j;
 
     if (!term->pre_bidi_cache || term->bidi_cache_size <= line) {
         j = term->bidi_cache_size;
@@ -5850,11 +6383,20 @@ static void term_bidi_cache_store(Terminal *term, int line, termchar *lbefore,
     term->pre_bidi_cache[line].chars = snewn(size, termchar);
     term->post_bidi_cache[line].width = width;
     term->post_bidi_cache[line].trusted = trusted;
-    term->post_bidi_cache[line].chars = snewn(size, termchar);
+    term->post_bidi_cache[line].chars = snewn(postsize, termchar);
     term->post_bidi_cache[line].forward = snewn(width, int);
     term->post_bidi_cache[line].backward = snewn(width, int);
 
     memcpy(term->pre_bidi_cache[line].chars, lbefore, size * TSIZE);
+}
+
+static void term_bidi_cache_store(Terminal *term, int line, termchar *lbefore,
+                                  termchar *lafter, bidi_char *wcTo,
+                                  int width, int size, bool trusted)
+{
+    size_t i, j;
+
+    term_bidi_cache_alloc(term, line, lbefore, width, size, size, trusted);
     memcpy(term->post_bidi_cache[line].chars, lafter, size * TSIZE);
     memset(term->post_bidi_cache[line].forward, 0, width * sizeof(int));
     memset(term->post_bidi_cache[line].backward, 0, width * sizeof(int));
@@ -5873,6 +6415,217 @@ static void term_bidi_cache_store(Terminal *term, int line, termchar *lbefore,
     }
 }
 
+#define BIDI_LRU_SIZE 256
+
+static int bidi_lru_cmp(void *av, void *bv)
+{
+    struct bidi_lru_entry *a = (struct bidi_lru_entry *)av;
+    struct bidi_lru_entry *b = (struct bidi_lru_entry *)bv;
+
+    if (a->hash != b->hash)
+        return a->hash < b->hash ? -1 : +1;
+    if (a->width != b->width)
+        return a->width < b->width ? -1 : +1;
+    if (a->trusted != b->trusted)
+        return a->trusted < b->trusted ? -1 : +1;
+    return 0;
+}
+
+/*
+ * Hash the first 'width' characters of a line, taking account of
+ * exactly the same fields that termchars_equal compares.
+ */
+static inline unsigned bidi_hash_word(unsigned h, unsigned long x)
+{
+    /* FNV-1a, a 32-bit word at a time */
+    h = (h ^ (unsigned)(x & 0xFFFFFFFFUL)) * 16777619U;
+    return (h ^ (unsigned)((x >> 16) >> 16)) * 16777619U;
+}
+
+static unsigned bidi_line_hash(termchar *chars, int width)
+{
+    unsigned h = 2166136261U;
+
+    for (int i = 0; i < width; i++) {
+        termchar *c = chars + i;
+        /* FULL-TERMCHAR */
+        h = bidi_hash_word(h, c->chr);
+        h = bidi_hash_word(h, c->attr &~ DATTR_MASK);
+        h = bidi_hash_word(h, (c->truecolour.fg.enabled << 24) |
+                           (c->truecolour.fg.r << 16) |
+                           (c->truecolour.fg.g << 8) | c->truecolour.fg.b);
+        h = bidi_hash_word(h, (c->truecolour.bg.enabled << 24) |
+                           (c->truecolour.bg.r << 16) |
+                           (c->truecolour.bg.g << 8) | c->truecolour.bg.b);
+        while (c->cc_next) {
+            c += c->cc_next;
+            h = bidi_hash_word(h, c->chr);
+        }
+    }
+
+    return h;
+}
+
+static void bidi_lru_unlink(Terminal *term, struct bidi_lru_entry *e)
+{
+    if (e->prev)
+        e->prev->next = e->next;
+    else
+        term->bidi_lru_head = e->next;
+    if (e->next)
+        e->next->prev = e->prev;
+    else
+        term->bidi_lru_tail = e->prev;
+}
+
+static void bidi_lru_link_head(Terminal *term, struct bidi_lru_entry *e)
+{
+    e->prev = NULL;
+    e->next = term->bidi_lru_head;
+    if (e->next)
+        e->next->prev = e;
+    else
+        term->bidi_lru_tail = e;
+    term->bidi_lru_head = e;
+}
+
+static void bidi_lru_free(Terminal *term, struct bidi_lru_entry *e)
+{
+    del234(term->bidi_lru, e);
+    bidi_lru_unlink(term, e);
+    term->bidi_lru_count--;
+    sfree(e->before);
+    sfree(e->after);
+    sfree(e->forward);
+    sfree(e->backward);
+    sfree(e);
+}
+
+static void bidi_lru_clear(Terminal *term)
+{
+    while (term->bidi_lru_head)
+        bidi_lru_free(term, term->bidi_lru_head);
+}
+
+/*
+ * Look up a line in the cache of recently seen lines, and if it's
+ * there, copy its bidi results into the per-row cache for this row.
+ */
+static bool term_bidi_lru_fetch(Terminal *term, int line, termline *ldata)
+{
+    struct bidi_lru_entry key, *e;
+    int width = term->cols;
+
+    key.hash = bidi_line_hash(ldata->chars, width);
+    key.width = width;
+    key.trusted = ldata->trusted;
+    e = find234(term->bidi_lru, &key, NULL);
+    if (!e)
+        return false;
+    for (int i = 0; i < width; i++)
+        if (!termchars_equal(e->before + i, ldata->chars + i))
+            return false;              /* hash collision */
+
+    term_bidi_cache_alloc(term, line, ldata->chars, width, ldata->size,
+                          e->size, ldata->trusted);
+    memcpy(term->post_bidi_cache[line].chars, e->after, e->size * TSIZE);
+    memcpy(term->post_bidi_cache[line].forward, e->forward,
+           width * sizeof(int));
+    memcpy(term->post_bidi_cache[line].backward, e->backward,
+           width * sizeof(int));
+
+    bidi_lru_unlink(term, e);
+    bidi_lru_link_head(term, e);
+    return true;
+}
+
+/*
+ * Add the results just stored in the per-row cache for a line to the
+ * cache of recently seen lines, throwing out the least recently used
+ * entry if that's now too big.
+ */
+static void term_bidi_lru_store(Terminal *term, int line, termline *ldata)
+{
+    struct bidi_cache_entry *pre = &term->pre_bidi_cache[line];
+    struct bidi_cache_entry *post = &term->post_bidi_cache[line];
+    struct bidi_lru_entry *e = snew(struct bidi_lru_entry), *old;
+    int width = term->cols;
+
+    e->hash = bidi_line_hash(ldata->chars, width);
+    e->width = width;
+    e->size = ldata->size;
+    e->trusted = ldata->trusted;
+    e->before = snewn(e->size, termchar);
+    memcpy(e->before, pre->chars, e->size * TSIZE);
+    e->after = snewn(e->size, termchar);
+    memcpy(e->after, post->chars, e->size * TSIZE);
+    e->forward = snewn(width, int);
+    memcpy(e->forward, post->forward, width * sizeof(int));
+    e->backward = snewn(width, int);
+    memcpy(e->backward, post->backward, width * sizeof(int));
+
+    /* A line with the same hash (necessarily a collision, or we'd
+     * have found it in term_bidi_lru_fetch) is replaced */
+    if ((old = find234(term->bidi_lru, e, NULL)) != NULL)
+        bidi_lru_free(term, old);
+    add234(term->bidi_lru, e);
+    bidi_lru_link_head(term, e);
+    if (++term->bidi_lru_count > BIDI_LRU_SIZE)
+        bidi_lru_free(term, term->bidi_lru_tail);
+}
+
+/*
+ * Translate a character from a termline into the Unicode character
+ * that the bidi algorithm should see.
+ */
+static unsigned long term_bidi_char(Terminal *term, unsigned long uc)
+{
+    switch (uc & CSET_MASK) {
+      case CSET_LINEDRW:
+        if (!term->rawcnp) {
+            uc = term->ucsdata->unitab_xterm[uc & 0xFF];
+            break;
+        }
+      case CSET_ASCII:
+        uc = term->ucsdata->unitab_line[uc & 0xFF];
+        break;
+      case CSET_SCOACS:
+        uc = term->ucsdata->unitab_scoacs[uc&0xFF];
+        break;
+    }
+    switch (uc & CSET_MASK) {
+      case CSET_ACP:
+        uc = term->ucsdata->unitab_font[uc & 0xFF];
+        break;
+      case CSET_OEMCP:
+        uc = term->ucsdata->unitab_oemcp[uc & 0xFF];
+        break;
+    }
+    return uc;
+}
+
+/*
+ * Quickly check whether a line needs any bidi processing at all. If
+ * nothing on it is bidi-active (which by the definition of is_rtl()
+ * also rules out anything Arabic shaping would change), then the bidi
+ * algorithm would leave it exactly as it is, so there's no need to
+ * run it. Lines with a trust sigil always need rearranging, though.
+ */
+static bool term_bidi_line_active(Terminal *term, termline *ldata)
+{
+    if (ldata->trusted && term->cols > TRUST_SIGIL_WIDTH)
+        return true;
+
+    for (int i = 0; i < term->cols; i++) {
+        unsigned long uc = term_bidi_char(term, ldata->chars[i].chr);
+        /* nothing before the Hebrew block is bidi-active */
+        if (uc >= 0x590 && is_rtl(uc))
+            return true;
+    }
+
+    return false;
+}
+
 /*
  * Prepare the bidi information for a screen line. Returns the
  * transformed list of termchars, or NULL if no transformation at
@@ -5891,8 +6644,19 @@ static termchar *term_bidi_line(Terminal *term, struct termline *ldata,
     if (!term->no_bidi || !term->no_arabicshaping ||
         (ldata->trusted && term->cols > TRUST_SIGIL_WIDTH)) {
 
-        if (!term_bidi_cache_hit(term, scr_y, ldata->chars, term->cols,
-                                 ldata->trusted)) {
+        if (!term_bidi_line_active(term, ldata)) {
+            term->paint_stats.bidi_skipped++;
+            return NULL;
+        }
+
+        if (term_bidi_cache_hit(term, scr_y, ldata->chars, term->cols,
+                                ldata->trusted)) {
+            term->paint_stats.bidi_row_hits++;
+            lchars = term->post_bidi_cache[scr_y].chars;
+        } else if (term_bidi_lru_fetch(term, scr_y, ldata)) {
+            term->paint_stats.bidi_lru_hits++;
+            lchars = term->post_bidi_cache[scr_y].chars;
+        } else {
 
             if (term->wcFromTo_size < term->cols) {
                 term->wcFromTo_size = term->cols;
@@ -5904,29 +6668,7 @@ static termchar *term_bidi_line(Terminal *term, struct termline *ldata,
 
             for(it=0; it<term->cols ; it++)
             {
-                unsigned long uc = (ldata->chars[it].chr);
-
-                switch (uc & CSET_MASK) {
-                  case CSET_LINEDRW:
-                    if (!term->rawcnp) {
-                        uc = term->ucsdata->unitab_xterm[uc & 0xFF];
-                        break;
-                    }
-                  case CSET_ASCII:
-                    uc = term->ucsdata->unitab_line[uc & 0xFF];
-                    break;
-                  case CSET_SCOACS:
-                    uc = term->ucsdata->unitab_scoacs[uc&0xFF];
-                    break;
-                }
-                switch (uc & CSET_MASK) {
-                  case CSET_ACP:
-                    uc = term->ucsdata->unitab_font[uc & 0xFF];
-                    break;
-                  case CSET_OEMCP:
-                    uc = term->ucsdata->unitab_oemcp[uc & 0xFF];
-                    break;
-                }
+                unsigned long uc = term_bidi_char(term, ldata->chars[it].chr);
 
                 term->wcFrom[it].origwc = term->wcFrom[it].wc =
                     (unsigned int)uc;
@@ -6001,10 +6743,10 @@ static termchar *term_bidi_line(Terminal *term, struct termline *ldata,
             term_bidi_cache_store(term, scr_y, ldata->chars,
                                   term->ltemp, term->wcTo,
                                   term->cols, ldata->size, ldata->trusted);
+            term_bidi_lru_store(term, scr_y, ldata);
+            term->paint_stats.bidi_runs++;
 
             lchars = term->ltemp;
-        } else {
-            lchars = term->post_bidi_cache[scr_y].chars;
         }
     } else {
         lchars = NULL;
@@ -6039,8 +6781,10 @@ static void do_paint_draw(Terminal *term, termline *ldata, int x, int y,
  */
 static void do_paint(Terminal *term)
 {
-    int i, j, our_curs_y, our_curs_x;
+    int i, j, our_curs_y, our_curs_x, old_curs_y;
     int rv, cursor;
+    struct term_paint_state state;
+    bool paint_all;
     pos scrpos;
     wchar_t *ch;
     size_t chlen;
@@ -6121,8 +6865,36 @@ static void do_paint(Terminal *term)
 
         term->curstype = 0;
     }
+    old_curs_y = term->dispcursy;
     term->dispcursx = term->dispcursy = -1;
 
+    /*
+     * Rows of the window showing a line we've already painted there,
+     * unmodified since, can be skipped entirely - unless the cursor
+     * is or was on them, or something that affects the appearance of
+     * every line has changed since the last paint.
+     */
+    memset(&state, 0, sizeof(state));
+    state.rv = rv;
+    state.ansi_colour = term->ansi_colour;
+    state.xterm_256_colour = term->xterm_256_colour;
+    state.true_colour = term->true_colour;
+    state.blink_is_real = term->blink_is_real;
+    state.blink_hidden = term->has_focus && term->tblinker;
+    if (term->selstate == DRAGGING || term->selstate == SELECTED) {
+        state.selstate = term->selstate;
+        state.seltype = term->seltype;
+        state.selstart = term->selstart;
+        state.selend = term->selend;
+    }
+    state.ucsdata = term->ucsdata;
+    state.no_bidi = term->no_bidi;
+    state.no_arabicshaping = term->no_arabicshaping;
+    paint_all = memcmp(&state, &term->painted_state, sizeof(state)) != 0;
+    term->painted_state = state;
+
+    term->paint_stats.paints++;
+
     /* The normal screen data */
     for (i = 0; i < term->rows; i++) {
         termline *ldata;
@@ -6134,12 +6906,21 @@ static void do_paint(Terminal *term)
         bool last_run_dirty = false;
         int laststart;
         bool dirtyrect;
+        bool redrawn = false;
         int *backward;
         truecolour tc;
 
         scrpos.y = i + term->disptop;
         ldata = lineptr(scrpos.y);
 
+        term->paint_stats.lines_considered++;
+        if (!paint_all && i != our_curs_y && i != old_curs_y &&
+            ldata->gen != 0 && ldata->gen == term->disptext[i]->gen) {
+            unlineptr(ldata);
+            continue;
+        }
+        term->paint_stats.lines_examined++;
+
         /* Do Arabic shaping and bidi. */
         lchars = term_bidi_line(term, ldata, i);
         if (lchars) {
@@ -6348,8 +7129,10 @@ static void do_paint(Terminal *term)
             }
 
             if (break_run) {
-                if ((dirty_run || last_run_dirty) && ccount > 0)
+                if ((dirty_run || last_run_dirty) && ccount > 0) {
                     do_paint_draw(term, ldata, start, i, ch, ccount, attr, tc);
+                    redrawn = true;
+                }
                 start = j;
                 ccount = 0;
                 attr = tattr;
@@ -6437,9 +7220,14 @@ static void do_paint(Terminal *term)
                 }
             }
         }
-        if (dirty_run && ccount > 0)
+        if (dirty_run && ccount > 0) {
             do_paint_draw(term, ldata, start, i, ch, ccount, attr, tc);
+            redrawn = true;
+        }
+        if (redrawn)
+            term->paint_stats.lines_redrawn++;
 
+        term->disptext[i]->gen = ldata->gen;
         unlineptr(ldata);
     }
 
@@ -6447,6 +7235,11 @@ static void do_paint(Terminal *term)
     sfree(ch);
 }
 
+void term_get_paint_stats(Terminal *term, TermPaintStats *stats)
+{
+    *stats = term->paint_stats;
+}
+
 /*
  * Invalidate the whole screen so it will be repainted in full.
  */
@@ -6454,9 +7247,11 @@ void term_invalidate(Terminal *term)
 {
     int i, j;
 
-    for (i = 0; i < term->rows; i++)
+    for (i = 0; i < term->rows; i++) {
         for (j = 0; j < term->cols; j++)
             term->disptext[i]->chars[j].attr |= ATTR_INVALID;
+        term->disptext[i]->gen = 0;
+    }
 
     term_schedule_update(term);
 }
@@ -6480,6 +7275,7 @@ void term_paint(Terminal *term,
         else
             for (j = left / 2; j <= right / 2 + 1 && j < term->cols; j++)
                 term->disptext[i]->chars[j].attr |= ATTR_INVALID;
+        term->disptext[i]->gen = 0;
     }
 
     if (immediately) {
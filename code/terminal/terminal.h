@@ -59,6 +59,19 @@ struct termline {
     int cc_free;                       /* offset to first cc in free list */
     struct termchar *chars;
     bool trusted;
+
+    /*
+     * Generation number, changed to a fresh value (from
+     * term->line_gen) whenever anything modifies the line, so that
+     * two lines with the same nonzero generation are known to have
+     * the same contents. Zero means unknown, e.g. for a line
+     * decompressed from the scrollback.
+     *
+     * In the lines of term->disptext, this is instead the generation
+     * of the line we last painted on that row of the window, or zero
+     * if the row needs repainting regardless.
+     */
+    unsigned long gen;
 };
 
 struct bidi_cache_entry {
@@ -68,6 +81,23 @@ struct bidi_cache_entry {
     int *forward, *backward;           /* the permutations of line positions */
 };
 
+/*
+ * An entry in the content-addressed bidi cache, which remembers the
+ * results of the bidi algorithm for recently seen lines regardless of
+ * which row of the screen they were on. Entries are indexed in a
+ * tree234 by a hash of the line contents, and also kept on a list in
+ * order of last use, so that the least recently used can be thrown
+ * out when the cache is full.
+ */
+struct bidi_lru_entry {
+    unsigned hash;
+    int width, size;
+    bool trusted;
+    struct termchar *before, *after;
+    int *forward, *backward;
+    struct bidi_lru_entry *prev, *next;
+};
+
 struct term_utf8_decode {
     int state;                         /* Is there a pending UTF-8 character */
     int chr;                           /* and what is it so far? */
@@ -79,6 +109,9 @@ struct terminal_tag {
     int compatibility_level;
 
     tree234 *scrollback;               /* lines scrolled off top of screen */
+    struct scrollback_spill *sbspill;  /* older scrollback, on disk */
+    bool sbspill_failed;               /* couldn't make a spill file */
+    int sb_memlines;                   /* max scrollback lines in memory */
     tree234 *screen;                   /* lines on primary screen */
     tree234 *alt_screen;               /* lines on alternate screen */
     int disptop;                       /* distance scrolled back (0 or -ve) */
@@ -89,6 +122,23 @@ struct terminal_tag {
     termline **disptext;               /* buffer of text on real screen */
     int dispcursx, dispcursy;          /* location of cursor on real screen */
     int curstype;                      /* type of cursor on real screen */
+    unsigned long line_gen;            /* last termline generation issued */
+
+    /*
+     * Everything other than the lines themselves that affects what
+     * do_paint draws, as it was at the last paint. If any of it
+     * changes, every row of the window has to be examined again.
+     */
+    struct term_paint_state {
+        int rv;
+        bool ansi_colour, xterm_256_colour, true_colour;
+        bool blink_is_real, blink_hidden;
+        int selstate, seltype;
+        pos selstart, selend;
+        const struct unicode_data *ucsdata;
+        bool no_bidi, no_arabicshaping;
+    } painted_state;
+    TermPaintStats paint_stats;
 
 #define VBELL_TIMEOUT (TICKSPERSEC/10) /* visual bell lasts 1/10 sec */
 
@@ -288,6 +338,9 @@ struct terminal_tag {
     int wcFromTo_size;
     struct bidi_cache_entry *pre_bidi_cache, *post_bidi_cache;
     size_t bidi_cache_size;
+    tree234 *bidi_lru;
+    struct bidi_lru_entry *bidi_lru_head, *bidi_lru_tail;
+    int bidi_lru_count;
 
     /*
      * Current trust state, used to annotate every line of the
@@ -0,0 +1,496 @@
+/*
+ * bppbench: throughput benchmark for the SSH-2 binary packet
+ * protocol, and in particular for how ssh2_bpp_parallel_crypto
+ * scales with the number of worker threads.
+ *
+ * Usage: bppbench [options] [pattern...]
+ *
+ * Each pattern is a wildcard (as in utils/wildcard.c) matched against
+ * the configuration names listed by -l. With no patterns, everything
+ * is run.
+ *
+ * Two real SSH-2 BPPs are connected back to back in one process,
+ * keyed alike, with stubs standing in for the rest of the SSH
+ * connection. For each configuration and each thread count, the
+ * sender formats, MACs and encrypts a stream of SSH_MSG_CHANNEL_DATA
+ * packets into a buffer; then the receiver decrypts and verifies all
+ * of them. The two halves are timed separately, by the wall clock,
+ * since with worker threads the CPU time of the process is no guide.
+ * A thread count of 0 means the ordinary single-threaded code.
+ *
+ * Before measuring a configuration, the program checks that each
+ * thread count interoperates with the single-threaded code in both
+ * directions, and with itself. The check streams use packets of
+ * mixed sizes, some small enough to be encrypted inline and some
+ * large enough to go to the workers, and the receiver verifies the
+ * contents of every packet as well as its length.
+ *
+ * Output is one line per measurement, with tab-separated fields:
+ *
+ *   config  direction  threads  size  packets  seconds  MB/s  speedup
+ *
+ * where 'size' is the payload size of each packet, MB/s counts
+ * payload bytes, and 'speedup' is relative to the single-threaded
+ * measurement of the same configuration and direction. Anything else
+ * the program says starts with '#', as in cryptbench.
+ *
+ * Options:
+ *
+ *   -t n[,n...]    thread counts (default 0,1,2,4,... up to the
+ *                  number of CPUs, and that number itself; larger
+ *                  counts are run as given, unlike CipherThreads)
+ *   -s bytes       payload size of each packet (default 32768)
+ *   -n MB          payload data per measurement (default 64)
+ *   -l             list the configurations instead of running them
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "putty.h"
+#include "ssh.h"
+#include "storage.h"
+#include "ssh/bpp.h"
+
+static NORETURN PRINTF_LIKE(1, 2) void fatal_error(const char *p, ...)
+{
+    va_list ap;
+    fprintf(stderr, "bppbench: ");
+    va_start(ap, p);
+    vfprintf(stderr, p, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    exit(1);
+}
+
+const char *const appname = "bppbench";
+
+void out_of_memory(void) { fatal_error("out of memory"); }
+void timer_change_notify(unsigned long next) { }
+void noise_ultralight(NoiseSourceId id, unsigned long data) { }
+
+/*
+ * Packet padding is the only thing the BPP wants randomness for, and
+ * its contents don't matter here.
+ */
+void random_read(void *buf, size_t size)
+{
+    memset(buf, 0x5A, size);
+}
+
+/*
+ * Stand-ins for the parts of ssh.c that a BPP calls back into.
+ */
+struct Ssh {
+    const char *name;
+};
+
+void ssh_sendbuffer_changed(Ssh *ssh) { }
+void ssh_check_frozen(Ssh *ssh) { }
+void ssh_conn_processed_data(Ssh *ssh) { }
+
+/* ssh/common.c refers to this, in code the benchmark never reaches */
+int check_stored_host_key(const char *hostname, int port,
+                          const char *keytype, const char *key)
+{ return 1; }
+
+static NORETURN void ssh_stub_error(Ssh *ssh, const char *fmt, va_list ap)
+{
+    char *msg = dupvprintf(fmt, ap);
+    fatal_error("%s: %s", ssh->name, msg);
+}
+
+#define SSH_ERROR_STUB(fn)                              \
+    void fn(Ssh *ssh, const char *fmt, ...)             \
+    {                                                   \
+        va_list ap;                                     \
+        va_start(ap, fmt);                              \
+        ssh_stub_error(ssh, fmt, ap);                   \
+    }
+SSH_ERROR_STUB(ssh_remote_error)
+SSH_ERROR_STUB(ssh_remote_eof)
+SSH_ERROR_STUB(ssh_proto_error)
+SSH_ERROR_STUB(ssh_sw_abort)
+SSH_ERROR_STUB(ssh_sw_abort_deferred)
+SSH_ERROR_STUB(ssh_user_close)
+#undef SSH_ERROR_STUB
+
+static ssh_compressor *bench_comp_new(void) { return NULL; }
+static ssh_decompressor *bench_decomp_new(void) { return NULL; }
+static const ssh_compression_alg bench_comp_none = {
+    .name = "none",
+    .compress_new = bench_comp_new,
+    .decompress_new = bench_decomp_new,
+};
+
+typedef struct BenchConfig {
+    const char *name;
+    const ssh_cipheralg *cipher;
+    const ssh2_macalg *mac;            /* NULL if the cipher requires one */
+    bool etm;
+} BenchConfig;
+
+static const BenchConfig configs[] = {
+    { "aes256-ctr+hmac-sha2-256", &ssh_aes256_sdctr, &ssh_hmac_sha256,
+      false },
+    { "aes256-ctr+hmac-sha2-256-etm", &ssh_aes256_sdctr, &ssh_hmac_sha256,
+      true },
+    { "aes256-gcm", &ssh_aes256_gcm, NULL, true },
+    { "chacha20-poly1305", &ssh2_chacha20_poly1305, NULL, true },
+};
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t payload_size = 32768, total_mb = 64;
+
+#define CHECK_PACKETS 1000
+
+/*
+ * The size and contents of packet i in a check stream. The sizes
+ * cycle through tiny packets, ones either side of the 1KB threshold
+ * for inline encryption, and large ones, with the exact size varying
+ * from one cycle to the next.
+ */
+static size_t check_packet_size(size_t i)
+{
+    size_t r = (i * 2654435761U) >> 7;
+    switch (i % 4) {
+      case 0: return r % 64;
+      case 1: return r % 1024;
+      case 2: return 960 + r % 128;
+      default: return 1024 + r % (32768 - 1024 + 1);
+    }
+}
+
+static unsigned char check_packet_byte(size_t i, size_t j)
+{
+    return (unsigned char)(i * 131 + j * 7 + (j >> 8));
+}
+
+typedef struct BenchKeys {
+    unsigned char ckey[64], iv[16], mackey[64];
+} BenchKeys;
+
+static BinaryPacketProtocol *bench_bpp_new(
+    Ssh *ssh, struct DataTransferStats *stats, bool is_server,
+    bufchain *in_raw, bufchain *out_raw, unsigned nthreads)
+{
+    BinaryPacketProtocol *bpp = ssh2_bpp_new(NULL, stats, is_server);
+    bpp->ssh = ssh;
+    bpp->in_raw = in_raw;
+    bpp->out_raw = out_raw;
+    bpp->remote_bugs = 0;
+    if (nthreads)
+        ssh2_bpp_parallel_crypto(bpp, nthreads);
+    return bpp;
+}
+
+/*
+ * Format and encrypt npackets packets into 'wire', followed by a
+ * NEWKEYS to tell the receiver where the stream ends. If 'check' is
+ * set, the packets are those of a check stream; otherwise they all
+ * carry payload_size bytes of filler. Returns the elapsed time.
+ */
+static double send_packets(const BenchConfig *bc, const BenchKeys *keys,
+                           unsigned nthreads, size_t npackets, bool check,
+                           bufchain *wire)
+{
+    Ssh ssh = { .name = "sender" };
+    struct DataTransferStats stats;
+    bufchain in_raw;
+    const ssh2_macalg *mac = bc->mac ? bc->mac : bc->cipher->required_mac;
+
+    memset(&stats, 0, sizeof(stats));
+    bufchain_init(&in_raw);
+
+    BinaryPacketProtocol *bpp = bench_bpp_new(
+        &ssh, &stats, false, &in_raw, wire, nthreads);
+    ssh2_bpp_new_outgoing_crypto(bpp, bc->cipher, keys->ckey, keys->iv,
+                                 mac, bc->etm, keys->mackey,
+                                 &bench_comp_none, false, true);
+    while (run_toplevel_callbacks());
+
+    size_t maxsize = check ? 32768 : payload_size;
+    unsigned char *payload = snewn(maxsize, unsigned char);
+    memset(payload, 'x', maxsize);
+
+    double start = now_sec();
+    for (size_t i = 0; i < npackets; i++) {
+        size_t size = payload_size;
+        if (check) {
+            size = check_packet_size(i);
+            for (size_t j = 0; j < size; j++)
+                payload[j] = check_packet_byte(i, j);
+        }
+
+        PktOut *pkt = ssh_bpp_new_pktout(bpp, SSH2_MSG_CHANNEL_DATA);
+        put_uint32(pkt, 0);
+        put_string(pkt, payload, size);
+        pq_push(&bpp->out_pq, pkt);
+
+        /* Let the BPP take packets in batches, much as it would from
+         * the connection layer */
+        if (i % 16 == 15)
+            while (run_toplevel_callbacks());
+    }
+    /* A NEWKEYS makes the BPP finish everything before returning */
+    pq_push(&bpp->out_pq, ssh_bpp_new_pktout(bpp, SSH2_MSG_NEWKEYS));
+    while (run_toplevel_callbacks());
+    double elapsed = now_sec() - start;
+
+    sfree(payload);
+    ssh_bpp_free(bpp);
+    bufchain_clear(&in_raw);
+    return elapsed;
+}
+
+typedef struct Receiver {
+    BinaryPacketProtocol *bpp;
+    IdempotentCallback ic;
+    size_t received;
+    bool check;
+    bool finished;
+} Receiver;
+
+static void receiver_process_queue(void *ctx)
+{
+    Receiver *rx = (Receiver *)ctx;
+    PktIn *pktin;
+
+    while ((pktin = pq_pop(&rx->bpp->in_pq)) != NULL) {
+        if (pktin->type == SSH2_MSG_NEWKEYS) {
+            rx->finished = true;
+        } else if (pktin->type == SSH2_MSG_CHANNEL_DATA) {
+            get_uint32(pktin);
+            ptrlen data = get_string(pktin);
+            size_t i = rx->received;
+            bool ok = !get_err(pktin);
+            if (ok && rx->check) {
+                const unsigned char *p = data.ptr;
+                ok = data.len == check_packet_size(i);
+                for (size_t j = 0; ok && j < data.len; j++)
+                    ok = p[j] == check_packet_byte(i, j);
+            } else if (ok) {
+                ok = data.len == payload_size;
+            }
+            if (!ok)
+                fatal_error("packet %"SIZEu" came out wrong", i);
+            rx->received++;
+        } else {
+            fatal_error("unexpected packet type %d", pktin->type);
+        }
+    }
+}
+
+static bool continue_until_finished(void *ctx, bool fd, bool cb)
+{
+    Receiver *rx = (Receiver *)ctx;
+    return !rx->finished;
+}
+
+/*
+ * Decrypt and verify everything in 'wire'. Returns the elapsed time.
+ */
+static double receive_packets(const BenchConfig *bc, const BenchKeys *keys,
+                              unsigned nthreads, size_t npackets, bool check,
+                              bufchain *wire)
+{
+    Ssh ssh = { .name = "receiver" };
+    struct DataTransferStats stats;
+    bufchain out_raw;
+    Receiver rx;
+    const ssh2_macalg *mac = bc->mac ? bc->mac : bc->cipher->required_mac;
+
+    memset(&stats, 0, sizeof(stats));
+    bufchain_init(&out_raw);
+
+    rx.bpp = bench_bpp_new(&ssh, &stats, true, wire, &out_raw, nthreads);
+    rx.ic.fn = receiver_process_queue;
+    rx.ic.ctx = &rx;
+    rx.ic.queued = false;
+    rx.bpp->in_pq.pqb.ic = &rx.ic;
+    rx.received = 0;
+    rx.check = check;
+    rx.finished = false;
+
+    double start = now_sec();
+    ssh2_bpp_new_incoming_crypto(rx.bpp, bc->cipher, keys->ckey, keys->iv,
+                                 mac, bc->etm, keys->mackey,
+                                 &bench_comp_none, false, true);
+    cli_main_loop(cliloop_no_pw_setup, cliloop_no_pw_check,
+                  continue_until_finished, &rx);
+    double elapsed = now_sec() - start;
+
+    if (rx.received != npackets)
+        fatal_error("received %"SIZEu" packets out of %"SIZEu,
+                    rx.received, npackets);
+    if (bufchain_size(wire))
+        fatal_error("%"SIZEu" bytes left over", bufchain_size(wire));
+
+    ssh_bpp_free(rx.bpp);
+    delete_callbacks_for_context(&rx);
+    bufchain_clear(&out_raw);
+    return elapsed;
+}
+
+static void report(const BenchConfig *bc, const char *direction,
+                   unsigned nthreads, size_t npackets, double elapsed,
+                   double serial)
+{
+    double mb = (double)npackets * payload_size / 1048576.0;
+    printf("%s\t%s\t%u\t%"SIZEu"\t%"SIZEu"\t%.3f\t%.1f\t%.2f\n",
+           bc->name, direction, nthreads, payload_size, npackets,
+           elapsed, mb / elapsed, serial / elapsed);
+    fflush(stdout);
+}
+
+/*
+ * Send a check stream with one thread count and receive it with
+ * another. Any mismatch is a fatal error.
+ */
+static void check_pair(const BenchConfig *bc, const BenchKeys *keys,
+                       unsigned sendthreads, unsigned recvthreads,
+                       bufchain *wire)
+{
+    send_packets(bc, keys, sendthreads, CHECK_PACKETS, true, wire);
+    receive_packets(bc, keys, recvthreads, CHECK_PACKETS, true, wire);
+    printf("# %s: checked %u -> %u threads\n",
+           bc->name, sendthreads, recvthreads);
+    fflush(stdout);
+}
+
+static void run_config(const BenchConfig *bc, const unsigned *threads,
+                       size_t nthreadcounts)
+{
+    BenchKeys keys;
+    size_t npackets = total_mb * 1048576 / payload_size;
+    double serial_out = 0, serial_in = 0;
+    bufchain wire;
+
+    if (!npackets)
+        npackets = 1;
+    for (size_t i = 0; i < sizeof(keys); i++)
+        ((unsigned char *)&keys)[i] = (unsigned char)(i * 37 + 11);
+    bufchain_init(&wire);
+
+    for (size_t i = 0; i < nthreadcounts; i++) {
+        check_pair(bc, &keys, threads[i], threads[i], &wire);
+        if (threads[i]) {
+            check_pair(bc, &keys, threads[i], 0, &wire);
+            check_pair(bc, &keys, 0, threads[i], &wire);
+        }
+    }
+
+    for (size_t i = 0; i < nthreadcounts; i++) {
+        double out = send_packets(bc, &keys, threads[i], npackets, false,
+                                  &wire);
+        double in = receive_packets(bc, &keys, threads[i], npackets, false,
+                                    &wire);
+
+        /* The first measurement stands in for the serial one if
+         * there isn't one */
+        if (i == 0 || threads[i] == 0) {
+            serial_out = out;
+            serial_in = in;
+        }
+        report(bc, "out", threads[i], npackets, out, serial_out);
+        report(bc, "in", threads[i], npackets, in, serial_in);
+    }
+
+    bufchain_clear(&wire);
+}
+
+static bool matches(const BenchConfig *bc, char **patterns, int npatterns)
+{
+    if (!npatterns)
+        return true;
+    for (int i = 0; i < npatterns; i++)
+        if (wc_match(patterns[i], bc->name))
+            return true;
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned *threads = NULL;
+    size_t nthreadcounts = 0, threadsize = 0;
+    char **patterns = snewn(argc, char *);
+    int npatterns = 0;
+    bool list = false;
+
+    while (--argc > 0) {
+        char *p = *++argv;
+        if (!strcmp(p, "-t") && argc > 1) {
+            char *q = *++argv;
+            argc--;
+            while (*q) {
+                sgrowarray(threads, threadsize, nthreadcounts);
+                threads[nthreadcounts++] = strtoul(q, &q, 10);
+                if (*q == ',')
+                    q++;
+                else if (*q)
+                    fatal_error("bad thread count list '%s'", *argv);
+            }
+        } else if (!strcmp(p, "-s") && argc > 1) {
+            payload_size = strtoul(*++argv, NULL, 10);
+            argc--;
+        } else if (!strcmp(p, "-n") && argc > 1) {
+            total_mb = strtoul(*++argv, NULL, 10);
+            argc--;
+        } else if (!strcmp(p, "-l")) {
+            list = true;
+        } else if (p[0] == '-') {
+            fprintf(stderr, "usage: bppbench [-t n[,n...]] [-s bytes] "
+                    "[-n MB] [-l] [pattern...]\n");
+            return 1;
+        } else {
+            patterns[npatterns++] = p;
+        }
+    }
+
+    if (list) {
+        for (size_t i = 0; i < lenof(configs); i++)
+            printf("%s\n", configs[i].name);
+        return 0;
+    }
+
+    if (payload_size < 1 || payload_size > 32768)
+        fatal_error("payload size must be between 1 and 32768");
+
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpus < 1)
+        ncpus = 1;
+    if (!nthreadcounts) {
+        sgrowarray(threads, threadsize, nthreadcounts);
+        threads[nthreadcounts++] = 0;
+        for (unsigned n = 1; n < (unsigned long)ncpus; n *= 2) {
+            sgrowarray(threads, threadsize, nthreadcounts);
+            threads[nthreadcounts++] = n;
+        }
+        sgrowarray(threads, threadsize, nthreadcounts);
+        threads[nthreadcounts++] = ncpus;
+    }
+
+    uxsel_init();
+
+    printf("# %ld CPUs online; %"SIZEu"-byte payloads, %"SIZEu" MB per "
+           "measurement\n", ncpus, payload_size, total_mb);
+    printf("# config\tdirection\tthreads\tsize\tpackets\tseconds\tMB/s\t"
+           "speedup\n");
+
+    for (size_t i = 0; i < lenof(configs); i++)
+        if (matches(&configs[i], patterns, npatterns))
+            run_config(&configs[i], threads, nthreadcounts);
+
+    sfree(threads);
+    sfree(patterns);
+    return 0;
+}
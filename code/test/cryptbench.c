@@ -0,0 +1,670 @@
+/*
+ * cryptbench: throughput benchmark for PuTTY's cryptographic
+ * primitives.
+ *
+ * Usage: cryptbench [options] [pattern...]
+ *
+ * Each pattern is a wildcard (as in utils/wildcard.c) matched against
+ * the benchmark names, or the name of a whole category ('cipher',
+ * 'aead', 'mac', 'hash', 'kex', 'sign', 'crc32', 'crcda'). With no
+ * patterns, everything is run.
+ *
+ * The algorithm names are the ones testcrypt uses, because the list
+ * of them comes from the same header. So every specific
+ * implementation of an algorithm is benchmarked separately: for
+ * example, 'aes256_ctr_sw' and 'aes256_ctr_ni' force the software and
+ * AES-NI implementations, while plain 'aes256_ctr' measures whichever
+ * of them PuTTY would select on this machine. Implementations the CPU
+ * can't run are reported as unavailable rather than skipped silently.
+ *
+ * Output is one line per measurement, with tab-separated fields:
+ *
+ *   category  name  operation  size  iterations  seconds  MB/s  ops/s
+ *
+ * followed by cycles/byte if the -g option gave the clock speed.
+ * 'size' is the number of bytes processed per operation, and is 0 for
+ * operations (key exchange and signatures) where that isn't
+ * meaningful, whose MB/s field is then '-'. Anything else the program
+ * says, including the header line, starts with '#', so the results
+ * can be fed directly to a script.
+ *
+ * Options:
+ *
+ *   -t seconds     CPU time to spend on each measurement (default 0.1)
+ *   -s n[,n...]    data sizes for the bulk algorithms
+ *   -g GHz         CPU clock speed, to report cycles/byte
+ *   -l             list the benchmarks instead of running them
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "defs.h"
+#include "putty.h"
+#include "ssh.h"
+#include "sshkeygen.h"
+#include "mpint.h"
+#include "proxy/cproxy.h"
+
+static NORETURN PRINTF_LIKE(1, 2) void fatal_error(const char *p, ...)
+{
+    va_list ap;
+    fprintf(stderr, "cryptbench: ");
+    va_start(ap, p);
+    vfprintf(stderr, p, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    exit(1);
+}
+
+void out_of_memory(void) { fatal_error("out of memory"); }
+void old_keyfile_warning(void) { }
+
+/*
+ * Randomness, for key generation and ephemeral keys, comes from a
+ * PRNG with a fixed seed, so that every run does the same work.
+ */
+static prng *bench_prng;
+void random_read(void *buf, size_t size)
+{
+    prng_read(bench_prng, buf, size);
+}
+
+uint64_t prng_reseed_time_ms(void)
+{
+    static uint64_t previous_time = 0;
+    return previous_time += 200;
+}
+
+/* ----------------------------------------------------------------------
+ * Options, selection of benchmarks, and output.
+ */
+
+static double duration = 0.1;
+static double clock_ghz = 0.0;
+static bool list_only = false;
+static char **patterns;
+static size_t npatterns;
+
+static size_t *sizes;
+static size_t nsizes;
+static const size_t default_sizes[] = { 16, 256, 1024, 16384 };
+
+/* The CRC attack detector's largest allowed packet is 32768 8-byte
+ * blocks, and it's designed for large packets, so it gets its own
+ * size range */
+static const size_t crcda_sizes[] = { 1024, 16384, 262144 };
+
+#define MAX_SIZE 262144
+
+static bool selected(const char *category, const char *name)
+{
+    if (npatterns == 0)
+        return true;
+    for (size_t i = 0; i < npatterns; i++)
+        if (!strcmp(patterns[i], category) || wc_match(patterns[i], name) > 0)
+            return true;
+    return false;
+}
+
+/*
+ * Decide whether to run a benchmark, and if we're only listing them,
+ * list it instead.
+ */
+static bool want(const char *category, const char *name)
+{
+    if (!selected(category, name))
+        return false;
+    if (list_only) {
+        printf("%s\t%s\n", category, name);
+        return false;
+    }
+    return true;
+}
+
+static void unavailable(const char *category, const char *name)
+{
+    printf("# %s %s: not available on this CPU\n", category, name);
+}
+
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+typedef void (*bench_fn)(void *ctx, size_t size);
+
+/*
+ * Run fn repeatedly for (about) the configured duration, and report
+ * the result. Calls are made in batches, growing until each one is
+ * long enough that reading the clock in between doesn't distort the
+ * measurement of very quick operations.
+ */
+static void measure(const char *category, const char *name, const char *op,
+                    size_t size, bench_fn fn, void *ctx)
+{
+    uint64_t iterations = 0, batch = 1;
+    double secs;
+
+    /* Warm up caches and predictors. If that call alone took the
+     * whole time, as the larger Diffie-Hellman groups can, it will do
+     * as the measurement. */
+    clock_t start = clock();
+    fn(ctx, size);
+    if ((secs = seconds_since(start)) >= duration) {
+        iterations = 1;
+        goto done;
+    }
+
+    start = clock();
+    while (true) {
+        for (uint64_t i = 0; i < batch; i++)
+            fn(ctx, size);
+        iterations += batch;
+        if ((secs = seconds_since(start)) >= duration)
+            break;
+        if (secs < duration / 64)
+            batch *= 2;
+    }
+
+  done:
+    printf("%s\t%s\t%s\t%"SIZEu"\t%"PRIu64"\t%.4f\t", category, name, op,
+           size, iterations, secs);
+    if (size)
+        printf("%.2f", iterations * size / secs / 1e6);
+    else
+        printf("-");
+    printf("\t%.1f", iterations / secs);
+    if (clock_ghz > 0 && size)
+        printf("\t%.2f", clock_ghz * 1e9 * secs / (iterations * size));
+    printf("\n");
+    fflush(stdout);
+}
+
+/*
+ * Fill a buffer with arbitrary non-repeating data. (For the attack
+ * detector this matters: repeated blocks would send it down its slow
+ * path, which isn't what an honest packet does.)
+ */
+static void fill_buffer(unsigned char *buf, size_t len)
+{
+    uint64_t state = 0x0123456789ABCDEF;
+    for (size_t i = 0; i < len; i++) {
+        state = state * 6364136223846793005 + 1442695040888963407;
+        buf[i] = state >> 56;
+    }
+}
+
+/* Shared data buffer, with room on the end for a MAC */
+static unsigned char *buf;
+static unsigned char keydata[256];
+
+/* ----------------------------------------------------------------------
+ * Bulk algorithms: hashes, MACs, ciphers, and CRCs.
+ */
+
+static void bench_hash_op(void *vctx, size_t size)
+{
+    ssh_hash *h = (ssh_hash *)vctx;
+    unsigned char out[MAX_HASH_LEN];
+    ssh_hash_reset(h);
+    put_data(h, buf, size);
+    ssh_hash_digest(h, out);
+}
+
+static void bench_hash(const char *name, const ssh_hashalg *alg)
+{
+    if (!want("hash", name))
+        return;
+
+    ssh_hash *h = ssh_hash_new(alg);
+    if (!h) {
+        unavailable("hash", name);
+        return;
+    }
+    for (size_t i = 0; i < nsizes; i++)
+        measure("hash", name, "hash", sizes[i], bench_hash_op, h);
+    ssh_hash_free(h);
+}
+
+struct mac_ctx {
+    ssh2_mac *mac;
+    ssh_cipher *cipher;
+    unsigned long seq;
+};
+
+static void bench_mac_op(void *vctx, size_t size)
+{
+    struct mac_ctx *ctx = (struct mac_ctx *)vctx;
+    ssh2_mac_generate(ctx->mac, buf, size, ctx->seq++);
+    ssh2_mac_next_message(ctx->mac);
+}
+
+static void bench_mac(const char *name, const ssh2_macalg *alg)
+{
+    struct mac_ctx ctx[1];
+
+    if (!want("mac", name))
+        return;
+
+    /*
+     * A MAC without a key of its own is one of the two that are
+     * built into an AEAD cipher, and gets its key from there.
+     */
+    ctx->cipher = NULL;
+    if (alg->keylen == 0) {
+        ctx->cipher = ssh_cipher_new(alg == &ssh2_poly1305 ?
+                                     &ssh2_chacha20_poly1305 :
+                                     &ssh_aes256_gcm);
+        ssh_cipher_setkey(ctx->cipher, keydata);
+        ssh_cipher_setiv(ctx->cipher, keydata);
+    }
+
+    ctx->mac = ssh2_mac_new(alg, ctx->cipher);
+    if (!ctx->mac) {
+        unavailable("mac", name);
+    } else {
+        ssh2_mac_setkey(ctx->mac, make_ptrlen(keydata, alg->keylen));
+        ctx->seq = 0;
+        for (size_t i = 0; i < nsizes; i++)
+            measure("mac", name, "generate", sizes[i], bench_mac_op, ctx);
+        ssh2_mac_free(ctx->mac);
+    }
+
+    if (ctx->cipher)
+        ssh_cipher_free(ctx->cipher);
+}
+
+static void bench_encrypt_op(void *vctx, size_t size)
+{
+    ssh_cipher_encrypt((ssh_cipher *)vctx, buf, size);
+}
+
+static void bench_decrypt_op(void *vctx, size_t size)
+{
+    ssh_cipher_decrypt((ssh_cipher *)vctx, buf, size);
+}
+
+/*
+ * An AEAD cipher and its MAC, sealing a packet with a 4-byte length
+ * field and 'size' bytes of payload, in the same sequence of calls
+ * that ssh2_bpp_format_packet makes.
+ */
+static void bench_aead_op(void *vctx, size_t size)
+{
+    struct mac_ctx *ctx = (struct mac_ctx *)vctx;
+    if (ssh_cipher_alg(ctx->cipher)->flags & SSH_CIPHER_SEPARATE_LENGTH)
+        ssh_cipher_encrypt_length(ctx->cipher, buf, 4, ctx->seq);
+    ssh2_mac_encrypt_and_generate(ctx->mac, ctx->cipher, buf, 4 + size,
+                                  ctx->seq);
+    ctx->seq++;
+    ssh_cipher_next_message(ctx->cipher);
+    ssh2_mac_next_message(ctx->mac);
+}
+
+static void bench_cipher(const char *name, const ssh_cipheralg *alg)
+{
+    bool want_cipher = want("cipher", name);
+    bool want_aead = alg->required_mac && want("aead", name);
+
+    if (!want_cipher && !want_aead)
+        return;
+
+    ssh_cipher *c = ssh_cipher_new(alg);
+    if (!c) {
+        unavailable(want_cipher ? "cipher" : "aead", name);
+        return;
+    }
+    ssh_cipher_setkey(c, keydata);
+    ssh_cipher_setiv(c, keydata);
+
+    for (size_t i = 0; want_cipher && i < nsizes; i++) {
+        if (sizes[i] % alg->blksize) {
+            printf("# cipher %s: size %"SIZEu" is not a whole number of "
+                   "%d-byte blocks\n", name, sizes[i], alg->blksize);
+            continue;
+        }
+        measure("cipher", name, "encrypt", sizes[i], bench_encrypt_op, c);
+        measure("cipher", name, "decrypt", sizes[i], bench_decrypt_op, c);
+    }
+
+    if (want_aead) {
+        struct mac_ctx ctx[1];
+        ctx->cipher = c;
+        ctx->mac = ssh2_mac_new(alg->required_mac, c);
+        ctx->seq = 0;
+        ssh2_mac_setkey(ctx->mac, make_ptrlen(keydata,
+                                               alg->required_mac->keylen));
+        for (size_t i = 0; i < nsizes; i++)
+            if (sizes[i] % alg->blksize == 0)
+                measure("aead", name, "seal", sizes[i], bench_aead_op, ctx);
+        ssh2_mac_free(ctx->mac);
+    }
+
+    ssh_cipher_free(c);
+}
+
+static void bench_crc32_op(void *vctx, size_t size)
+{
+    const crc32_impl *impl = (const crc32_impl *)vctx;
+    static uint32_t crc;
+    /* Keep the result, so the compiler can't optimise the work away */
+    crc = impl->update(crc, make_ptrlen(buf, size));
+}
+
+static void bench_crc32(const crc32_impl *impl)
+{
+    if (!want("crc32", impl->name))
+        return;
+    if (!impl->check_available()) {
+        unavailable("crc32", impl->name);
+        return;
+    }
+    for (size_t i = 0; i < nsizes; i++)
+        measure("crc32", impl->name, "update", sizes[i], bench_crc32_op,
+                (void *)impl);
+}
+
+static void bench_crcda_op(void *vctx, size_t size)
+{
+    if (detect_attack((struct crcda_ctx *)vctx, buf, size, NULL))
+        fatal_error("crcda: unexpected attack detection");
+}
+
+static void bench_crcda(void)
+{
+    if (!want("crcda", "crcda"))
+        return;
+    struct crcda_ctx *ctx = crcda_make_context();
+    for (size_t i = 0; i < lenof(crcda_sizes); i++)
+        measure("crcda", "crcda", "detect", crcda_sizes[i],
+                bench_crcda_op, ctx);
+    crcda_free_context(ctx);
+}
+
+/* ----------------------------------------------------------------------
+ * Public-key algorithms: key exchange and signatures. Each key
+ * exchange operation is a complete exchange, doing the work of both
+ * the client and the server.
+ */
+
+static void bench_dh_op(void *vctx, size_t size)
+{
+    const ssh_kex *kex = (const ssh_kex *)vctx;
+    dh_ctx *client = dh_setup_group(kex), *server = dh_setup_group(kex);
+    /* e and f belong to the contexts, and are freed with them */
+    mp_int *e = dh_create_e(client), *f = dh_create_e(server);
+    mp_int *K1 = dh_find_K(client, f), *K2 = dh_find_K(server, e);
+    mp_free(K1);
+    mp_free(K2);
+    dh_cleanup(client);
+    dh_cleanup(server);
+}
+
+static void bench_ecdh_op(void *vctx, size_t size)
+{
+    const ssh_kex *kex = (const ssh_kex *)vctx;
+    ecdh_key *client = ecdh_key_new(kex, false);
+    ecdh_key *server = ecdh_key_new(kex, true);
+    strbuf *cpub = strbuf_new(), *spub = strbuf_new();
+    strbuf *ck = strbuf_new(), *sk = strbuf_new();
+
+    ecdh_key_getpublic(client, BinarySink_UPCAST(cpub));
+    if (!ecdh_key_getkey(server, ptrlen_from_strbuf(cpub),
+                         BinarySink_UPCAST(sk)))
+        fatal_error("%s: server rejected client's public key", kex->name);
+    ecdh_key_getpublic(server, BinarySink_UPCAST(spub));
+    if (!ecdh_key_getkey(client, ptrlen_from_strbuf(spub),
+                         BinarySink_UPCAST(ck)))
+        fatal_error("%s: client rejected server's public key", kex->name);
+
+    strbuf_free(cpub);
+    strbuf_free(spub);
+    strbuf_free(ck);
+    strbuf_free(sk);
+    ecdh_key_free(client);
+    ecdh_key_free(server);
+}
+
+static void bench_kex(const char *name, const ssh_kex *kex)
+{
+    if (!want("kex", name))
+        return;
+    measure("kex", name, "exchange", 0,
+            kex->main_type == KEXTYPE_DH ? bench_dh_op : bench_ecdh_op,
+            (void *)kex);
+}
+
+static ProgressReceiver null_progress = { .vt = &null_progress_vt };
+
+static ssh_key *generate_key(const ssh_keyalg *alg)
+{
+    static const int ec_bits[] = { 256, 384, 521 };
+    static const int ed_bits[] = { 255, 448 };
+    const struct ec_curve *curve;
+    const ssh_keyalg *ecalg;
+
+    if (alg == &ssh_rsa) {
+        PrimeGenerationContext *pgc = primegen_new_context(
+            &primegen_probabilistic);
+        RSAKey *rsa = snew(RSAKey);
+        rsa_generate(rsa, 2048, false, pgc, &null_progress);
+        rsa->comment = NULL;
+        primegen_free_context(pgc);
+        return &rsa->sshk;
+    }
+
+    if (alg == &ssh_dsa) {
+        PrimeGenerationContext *pgc = primegen_new_context(
+            &primegen_probabilistic);
+        struct dsa_key *dsa = snew(struct dsa_key);
+        dsa_generate(dsa, 1024, pgc, &null_progress);
+        primegen_free_context(pgc);
+        return &dsa->sshk;
+    }
+
+    for (size_t i = 0; i < lenof(ec_bits); i++) {
+        if (ec_nist_alg_and_curve_by_bits(ec_bits[i], &curve, &ecalg) &&
+            ecalg == alg) {
+            struct ecdsa_key *ek = snew(struct ecdsa_key);
+            ecdsa_generate(ek, ec_bits[i]);
+            return &ek->sshk;
+        }
+    }
+
+    for (size_t i = 0; i < lenof(ed_bits); i++) {
+        if (ec_ed_alg_and_curve_by_bits(ed_bits[i], &curve, &ecalg) &&
+            ecalg == alg) {
+            struct eddsa_key *ek = snew(struct eddsa_key);
+            eddsa_generate(ek, ed_bits[i]);
+            return &ek->sshk;
+        }
+    }
+
+    return NULL;
+}
+
+struct sign_ctx {
+    ssh_key *key;
+    strbuf *sig;
+};
+
+/* The data signed in SSH-2 user authentication is a few hundred
+ * bytes, and the signature schemes all hash it first anyway */
+#define SIGN_DATA_LEN 256
+
+static void bench_sign_op(void *vctx, size_t size)
+{
+    struct sign_ctx *ctx = (struct sign_ctx *)vctx;
+    strbuf_clear(ctx->sig);
+    ssh_key_sign(ctx->key, make_ptrlen(buf, SIGN_DATA_LEN), 0,
+                 BinarySink_UPCAST(ctx->sig));
+}
+
+static void bench_verify_op(void *vctx, size_t size)
+{
+    struct sign_ctx *ctx = (struct sign_ctx *)vctx;
+    if (!ssh_key_verify(ctx->key, ptrlen_from_strbuf(ctx->sig),
+                        make_ptrlen(buf, SIGN_DATA_LEN)))
+        fatal_error("%s: signature failed to verify", ctx->key->vt->ssh_id);
+}
+
+static void bench_keyalg(const char *name, const ssh_keyalg *alg)
+{
+    struct sign_ctx ctx[1];
+
+    /* Certified keys do their signing with the underlying key type */
+    if (alg->is_certificate || !want("sign", name))
+        return;
+
+    ctx->key = generate_key(alg);
+    if (!ctx->key)
+        fatal_error("don't know how to generate a key of type '%s'", name);
+    ctx->sig = strbuf_new();
+
+    measure("sign", name, "sign", 0, bench_sign_op, ctx);
+    measure("sign", name, "verify", 0, bench_verify_op, ctx);
+
+    strbuf_free(ctx->sig);
+    ssh_key_free(ctx->key);
+}
+
+/* ----------------------------------------------------------------------
+ * Main program. The lists of algorithms come from testcrypt's table
+ * of names, which already knows which implementations were compiled
+ * in.
+ */
+
+typedef const ssh_hashalg *TD_hashalg;
+typedef const ssh2_macalg *TD_macalg;
+typedef const ssh_keyalg *TD_keyalg;
+typedef const ssh_cipheralg *TD_cipheralg;
+typedef const ssh_kex *TD_dh_group;
+typedef const ssh_kex *TD_ecdh_alg;
+typedef RsaSsh1Order TD_rsaorder;
+typedef const PrimeGenerationPolicy *TD_primegenpolicy;
+typedef Argon2Flavour TD_argon2flavour;
+typedef FingerprintType TD_fptype;
+typedef HttpDigestHash TD_httpdigesthash;
+
+#define BENCH_hashalg bench_hash
+#define BENCH_macalg bench_mac
+#define BENCH_keyalg bench_keyalg
+#define BENCH_cipheralg bench_cipher
+#define BENCH_dh_group bench_kex
+#define BENCH_ecdh_alg bench_kex
+/* Enumerations of things other than algorithms, to ignore */
+#define BENCH_rsaorder(name, value) ((void)(value))
+#define BENCH_primegenpolicy(name, value) ((void)(value))
+#define BENCH_argon2flavour(name, value) ((void)(value))
+#define BENCH_fptype(name, value) ((void)(value))
+#define BENCH_httpdigesthash(name, value) ((void)(value))
+
+static void run_benchmarks(void)
+{
+#define BEGIN_ENUM_TYPE(name)                                           \
+    {                                                                   \
+        static const struct {                                           \
+            const char *key;                                            \
+            TD_##name value;                                            \
+        } mapping[] = {
+#define ENUM_VALUE(name, value) {name, value},
+#define END_ENUM_TYPE(name)                                             \
+        };                                                              \
+        for (size_t i = 0; i < lenof(mapping); i++)                     \
+            BENCH_##name(mapping[i].key, mapping[i].value);             \
+    }
+#include "testcrypt-enum.h"
+#undef BEGIN_ENUM_TYPE
+#undef ENUM_VALUE
+#undef END_ENUM_TYPE
+
+    /* Hybrid post-quantum key exchange isn't in testcrypt's list,
+     * which only has the kex methods tested through it directly */
+    for (size_t i = 0; i < ssh_ntru_hybrid_kex.nkexes; i++)
+        bench_kex(ssh_ntru_hybrid_kex.list[i]->name,
+                  ssh_ntru_hybrid_kex.list[i]);
+
+    bench_crc32(&crc32_sw);
+#if HAVE_CLMUL
+    bench_crc32(&crc32_clmul);
+#endif
+#if HAVE_NEON_CRC32
+    bench_crc32(&crc32_neon);
+#endif
+    bench_crcda();
+}
+
+static void parse_sizes(const char *arg)
+{
+    nsizes = 0;
+    sizes = snewn(strlen(arg) + 1, size_t);
+    while (*arg) {
+        char *end;
+        unsigned long size = strtoul(arg, &end, 10);
+        if (end == arg || (*end && *end != ',') ||
+            size == 0 || size > MAX_SIZE)
+            fatal_error("bad size list (sizes must be between 1 and %d)",
+                        MAX_SIZE);
+        sizes[nsizes++] = size;
+        arg = *end ? end + 1 : end;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    patterns = snewn(argc, char *);
+
+    for (int i = 1; i < argc; i++) {
+        const char *p = argv[i];
+        if (p[0] == '-' && p[1]) {
+            if (!strcmp(p, "-l")) {
+                list_only = true;
+            } else if (!strcmp(p, "-t") || !strcmp(p, "-s") ||
+                       !strcmp(p, "-g")) {
+                if (++i >= argc)
+                    fatal_error("option '%s' expects an argument", p);
+                if (p[1] == 't' && (duration = atof(argv[i])) <= 0)
+                    fatal_error("bad duration '%s'", argv[i]);
+                if (p[1] == 'g' && (clock_ghz = atof(argv[i])) <= 0)
+                    fatal_error("bad clock speed '%s'", argv[i]);
+                if (p[1] == 's')
+                    parse_sizes(argv[i]);
+            } else {
+                fatal_error("unrecognised option '%s'", p);
+            }
+        } else {
+            patterns[npatterns++] = argv[i];
+        }
+    }
+
+    if (!sizes) {
+        sizes = snewn(lenof(default_sizes), size_t);
+        memcpy(sizes, default_sizes, sizeof(default_sizes));
+        nsizes = lenof(default_sizes);
+    }
+
+    bench_prng = prng_new(&ssh_sha256);
+    prng_seed_begin(bench_prng);
+    put_datapl(bench_prng, PTRLEN_LITERAL("cryptbench"));
+    prng_seed_finish(bench_prng);
+
+    /* Room for the largest size, plus a length field and a MAC */
+    buf = snewn(MAX_SIZE + 256, unsigned char);
+    fill_buffer(buf, MAX_SIZE + 256);
+    fill_buffer(keydata, sizeof(keydata));
+
+    if (!list_only)
+        printf("# category\tname\toperation\tsize\titerations\tseconds"
+               "\tMB/s\tops/s%s\n", clock_ghz > 0 ? "\tcycles/byte" : "");
+
+    run_benchmarks();
+
+    prng_free(bench_prng);
+    sfree(buf);
+    sfree(sizes);
+    sfree(patterns);
+    return 0;
+}
@@ -1608,6 +1608,72 @@ class crypt(MyTestBase):
             for d in decryptions:
                 self.assertEqualBin(d, decryptions[0])
 
+    def testAESCounterBatches(self):
+        # Some AES implementations generate many counter blocks at
+        # once, in batches of various sizes. Check that long runs of
+        # keystream agree with the one-block-at-a-time software
+        # version, however they're chunked, including across the
+        # places where SDCTR's counter carries between words.
+        test_key = b"foobarbazquxquuxFooBarBazQuxQuux"
+        data = b"".join(ssh_uint32(i) for i in range(4 * 75))
+
+        def keystream(keylen, alg, iv, chunklen):
+            c = ssh_cipher_new(alg)
+            if c is None: return None # skip test if HW AES not available
+            ssh_cipher_setkey(c, test_key[:keylen//8])
+            ssh_cipher_setiv(c, iv)
+            return b"".join(ssh_cipher_encrypt(c, data[pos:pos+chunklen])
+                            for pos in range(0, len(data), chunklen))
+
+        sdctr_ivs = [0, (1 << 64) - 5, (1 << 128) - 5, (1 << 96) - 20]
+        for keylen in [128, 192, 256]:
+            for mode, ivs in [
+                    ("ctr", [unhex("{:032x}".format(iv)) for iv in sdctr_ivs]),
+                    ("gcm", [b"0123456789ab" + b"fake"])]:
+                for iv in ivs:
+                    alg = "aes{:d}_{}".format(keylen, mode)
+                    ref = keystream(keylen, alg + "_sw", iv, len(data))
+                    for suffix in get_aes_impls():
+                        for chunklen in [16, 16*7, 16*9, 16*17, len(data)]:
+                            with self.subTest(alg=alg, suffix=suffix,
+                                              iv=iv.hex(), chunklen=chunklen):
+                                out = keystream(
+                                    keylen, "{}_{}".format(alg, suffix),
+                                    iv, chunklen)
+                                if out is not None:
+                                    self.assertEqualBin(out, ref)
+
+    def testAESCBCBatches(self):
+        # CBC decryption is done many blocks at once, in batches of
+        # various sizes. Check that decrypting a long run of blocks in
+        # one go, or in chunks that don't line up with any batch
+        # size, agrees with the software implementation decrypting
+        # one block at a time.
+        test_key = b"foobarbazquxquuxFooBarBazQuxQuux"
+        test_iv = b"FOOBARBAZQUXQUUX"
+        data = b"".join(ssh_uint32(i * 0x9E3779B9 & 0xFFFFFFFF)
+                        for i in range(4 * 75))
+
+        def decrypt(keylen, alg, chunklen):
+            c = ssh_cipher_new(alg)
+            if c is None: return None # skip test if HW AES not available
+            ssh_cipher_setkey(c, test_key[:keylen//8])
+            ssh_cipher_setiv(c, test_iv)
+            return b"".join(ssh_cipher_decrypt(c, data[pos:pos+chunklen])
+                            for pos in range(0, len(data), chunklen))
+
+        for keylen in [128, 192, 256]:
+            alg = "aes{:d}_cbc".format(keylen)
+            ref = decrypt(keylen, alg + "_sw", 16)
+            for suffix in get_aes_impls():
+                for chunklen in [16, 16*7, 16*9, 16*17, 16*33, len(data)]:
+                    with self.subTest(alg=alg, suffix=suffix,
+                                      chunklen=chunklen):
+                        out = decrypt(keylen, "{}_{}".format(alg, suffix),
+                                      chunklen)
+                        if out is not None:
+                            self.assertEqualBin(out, ref)
+
     def testCRC32(self):
         # Check the effect of every possible single-byte input to
         # crc32_update. In the traditional implementation with a
@@ -1638,6 +1704,32 @@ class crypt(MyTestBase):
                 # we're at it!
                 self.assertEqual(shift8(i ^ prior), exp)
 
+    def testCRC32Implementations(self):
+        # Check every compiled-in implementation of crc32_update
+        # against Python's own CRC-32. binascii.crc32 complements the
+        # state on the way in and out, so undo that to get the raw
+        # update function.
+        def ref(prior, data):
+            return 0xFFFFFFFF ^ binascii.crc32(data, 0xFFFFFFFF ^ prior)
+
+        # Lengths either side of the points where the accelerated
+        # versions change strategy (alignment, 16-byte blocks, the
+        # 64-byte minimum for folding), and a few longer ones.
+        lengths = list(range(0, 160)) + [255, 256, 257, 1000, 4096, 65537]
+        data = bytes((i * 167 + 13) & 0xFF for i in range(65537 + 7))
+
+        for impl in get_implementations("crc32"):
+            if impl == "crc32" or not crc32_impl_available(impl):
+                continue
+            with self.subTest(impl=impl):
+                for length in lengths:
+                    for offset in [0, 1, 7]:
+                        block = data[offset:offset+length]
+                        for prior in [0, 0xFFFFFFFF, 0x45CC1F6A]:
+                            self.assertEqual(
+                                crc32_impl_update(impl, prior, block),
+                                ref(prior, block))
+
     def testCRCDA(self):
         def pattern(badblk, otherblks, pat):
             # Arrange copies of the bad block in a pattern
@@ -1853,16 +1945,65 @@ class crypt(MyTestBase):
                       '3b8693642db36f87')
         mac = unhex('09757178642dfc9f2c38ac5999e0fcfd')
         seqno = 3
-        c = ssh_cipher_new('chacha20_poly1305')
-        m = ssh2_mac_new('poly1305', c)
-        c.setkey(key)
-        self.assertEqualBin(c.encrypt_length(len_p, seqno), len_c)
-        self.assertEqualBin(c.encrypt(msg_p), msg_c)
-        m.start()
-        m.update(ssh_uint32(seqno) + len_c + msg_c)
-        self.assertEqualBin(m.genresult(), mac)
-        self.assertEqualBin(c.decrypt_length(len_c, seqno), len_p)
-        self.assertEqualBin(c.decrypt(msg_c), msg_p)
+        for impl in get_implementations('chacha20_poly1305'):
+            c = ssh_cipher_new(impl)
+            if c is None:
+                continue # hardware-accelerated version not available
+            m = ssh2_mac_new('poly1305', c)
+            c.setkey(key)
+            self.assertEqualBin(c.encrypt_length(len_p, seqno), len_c)
+            self.assertEqualBin(c.encrypt(msg_p), msg_c)
+            m.start()
+            m.update(ssh_uint32(seqno) + len_c + msg_c)
+            self.assertEqualBin(m.genresult(), mac)
+            self.assertEqualBin(c.decrypt_length(len_c, seqno), len_p)
+            self.assertEqualBin(c.decrypt(msg_c), msg_p)
+
+    def testChaCha20Poly1305Implementations(self):
+        # Check every compiled-in implementation against the portable
+        # one, over message lengths either side of the points where
+        # the accelerated versions change strategy (4 and 8 ChaCha20
+        # blocks, 4 Poly1305 blocks, and the minimum run the bulk
+        # Poly1305 function is used for), and with the data arriving
+        # in pieces of various sizes so that the buffering of partial
+        # blocks gets exercised too.
+        key = bytes((i * 29 + 7) & 0xFF for i in range(64))
+        data = bytes((i * 167 + 13) & 0xFF for i in range(2100))
+        lengths = [0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 129, 255, 256,
+                   257, 511, 512, 513, 575, 576, 1000, 2048, 2100]
+        splits = [None, 7, 100]
+
+        def run(impl, seqno, msg, split):
+            c = ssh_cipher_new(impl)
+            m = ssh2_mac_new('poly1305', c)
+            c.setkey(key)
+            enc_len = c.encrypt_length(ssh_uint32(len(msg)), seqno)
+            if split is None:
+                enc = c.encrypt(msg)
+            else:
+                enc = b''.join(c.encrypt(msg[i:i+split])
+                               for i in range(0, len(msg), split))
+            m.start()
+            m.update(ssh_uint32(seqno) + enc_len)
+            if split is None:
+                m.update(enc)
+            else:
+                for i in range(0, len(enc), split):
+                    m.update(enc[i:i+split])
+            return enc_len, enc, m.genresult()
+
+        for impl in get_implementations("chacha20_poly1305"):
+            if ssh_cipher_new(impl) is None:
+                continue # hardware-accelerated version not available
+            with self.subTest(impl=impl):
+                for length in lengths:
+                    for split in splits:
+                        for seqno in [0, 0xFFFFFFFF]:
+                            msg = data[:length]
+                            self.assertEqual(
+                                run(impl, seqno, msg, split),
+                                run('chacha20_poly1305_sw', seqno,
+                                    msg, None))
 
     def testRSAKex(self):
         # Round-trip test of the RSA key exchange functions, plus a
@@ -3116,6 +3257,80 @@ Private-MAC: 5b1f6f4cc43eb0060d2c3e181bc0129343adba2b
                 # at the top
                 test(gcm, cbc, 0x27182818, 0xFFFFFFFFFFFFFFFF)
 
+    def testAESGCMStitched(self):
+        # Check the combined encrypt-and-MAC operations, which some
+        # combinations of AES and GHASH implementations do in a
+        # single pass, against doing the two steps separately with
+        # the software implementations. Packet lengths run up past
+        # the largest batch size any stitched kernel uses, so as to
+        # exercise both the batches and the leftovers after them.
+        key = b'SomeRandomKeyValSomeRandomKeyVal'
+        iv = b'SomeRandomIV'
+
+        def aesgcm(keylen, aes_impl, gcm_impl):
+            c = ssh_cipher_new('aes{:d}_gcm_{}'.format(keylen, aes_impl))
+            if c is None: return None, None
+            m = ssh2_mac_new('aesgcm_{}'.format(gcm_impl), c)
+            if m is None: return None, None
+            c.setkey(key[:keylen//8])
+            c.setiv(iv + b'\0'*4)
+            m.setkey(b'')
+            return c, m
+
+        def separately(keylen, packets):
+            c, m = aesgcm(keylen, 'sw', 'sw')
+            out = []
+            for seq, packet in packets:
+                ct = packet[:4] + c.encrypt(packet[4:])
+                m.start()
+                m.update(ssh_uint32(seq) + ct)
+                out.append(ct + m.genresult())
+                c.next_message()
+                m.next_message()
+            return out
+
+        lengths = [0, 1, 7, 8, 9, 16, 17, 24, 33, 70]
+        packets = [(seq, ssh_uint32(16 * n) + bytes(
+            (7 * i + n) & 0xFF for i in range(16 * n)))
+                   for seq, n in zip(itertools.count(0xFFFFFFFE), lengths)]
+        packets = [(seq & 0xFFFFFFFF, p) for seq, p in packets]
+
+        for keylen in [128, 256]:
+            expected = separately(keylen, packets)
+            for aes_impl in get_aes_impls():
+                for gcm_impl in get_aesgcm_impls():
+                    with self.subTest(keylen=keylen, aes_impl=aes_impl,
+                                      gcm_impl=gcm_impl):
+                        c, m = aesgcm(keylen, aes_impl, gcm_impl)
+                        if c is None: continue
+                        for (seq, packet), exp in zip(packets, expected):
+                            self.assertEqualBin(
+                                ssh2_mac_encrypt_and_generate(
+                                    m, c, packet, seq), exp)
+                            c.next_message()
+                            m.next_message()
+
+                        c, m = aesgcm(keylen, aes_impl, gcm_impl)
+                        for (seq, packet), exp in zip(packets, expected):
+                            self.assertEqualBin(
+                                ssh2_mac_verify_and_decrypt(m, c, exp, seq),
+                                packet)
+                            c.next_message()
+                            m.next_message()
+
+                        # A corrupted packet must fail, whether the
+                        # damage is in a stitched batch or after it
+                        seq, longest = packets[-1][0], expected[-1]
+                        for pos in [4, len(longest) - 17, len(longest) - 1]:
+                            c, m = aesgcm(keylen, aes_impl, gcm_impl)
+                            for _ in packets[:-1]:
+                                c.next_message()
+                                m.next_message()
+                            bad = bytearray(longest)
+                            bad[pos] ^= 1
+                            self.assertIsNone(ssh2_mac_verify_and_decrypt(
+                                m, c, bytes(bad), seq))
+
 class standard_test_vectors(MyTestBase):
     def testAES(self):
         def vector(cipher, key, plaintext, ciphertext):
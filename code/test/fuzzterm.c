@@ -16,6 +16,15 @@ int main(int argc, char **argv)
     Conf *conf;
     struct unicode_data ucsdata;
     TermWin termwin;
+    bool stats = false;
+
+    /*
+     * With -stats, paint after every block of input, as a real window
+     * would from time to time, and report the terminal's paint
+     * statistics on standard error at the end.
+     */
+    if (argc > 1 && !strcmp(argv[1], "-stats"))
+        stats = true;
 
     termwin.vt = &fuzz_termwin_vt;
 
@@ -35,8 +44,23 @@ int main(int argc, char **argv)
     while (!feof(stdin)) {
         len = fread(blk, 1, sizeof(blk), stdin);
         term_data(term, blk, len);
+        if (stats)
+            term_update(term);
     }
     term_update(term);
+
+    if (stats) {
+        TermPaintStats ps;
+        term_get_paint_stats(term, &ps);
+        fprintf(stderr, "paints: %lu\n", ps.paints);
+        fprintf(stderr, "lines considered: %lu\n", ps.lines_considered);
+        fprintf(stderr, "lines examined: %lu\n", ps.lines_examined);
+        fprintf(stderr, "lines redrawn: %lu\n", ps.lines_redrawn);
+        fprintf(stderr, "bidi lines skipped: %lu\n", ps.bidi_skipped);
+        fprintf(stderr, "bidi row cache hits: %lu\n", ps.bidi_row_hits);
+        fprintf(stderr, "bidi LRU cache hits: %lu\n", ps.bidi_lru_hits);
+        fprintf(stderr, "bidi algorithm runs: %lu\n", ps.bidi_runs);
+    }
     return 0;
 }
 
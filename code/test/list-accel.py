@@ -33,6 +33,8 @@ def list_hash_implementations(alg):
 
 list_cipher_implementations("aes256_cbc")
 list_mac_implementations("aesgcm")
+list_cipher_implementations("chacha20_poly1305")
 list_hash_implementations("sha1")
 list_hash_implementations("sha256")
 list_hash_implementations("sha512")
+list_implementations("crc32", crc32_impl_available)
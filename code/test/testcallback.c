@@ -0,0 +1,332 @@
+/*
+ * testcallback: stress test and latency benchmark for
+ * queue_toplevel_callback_from_thread.
+ *
+ * Usage: testcallback [-p producers] [-n callbacks] [-b]
+ *
+ * Without -b, runs the stress test: several producer threads each
+ * queue a long run of callbacks as fast as they can, while
+ * cli_main_loop runs them and the main thread queues callbacks of
+ * its own in between. Checks that every callback runs exactly once,
+ * that each producer's callbacks run in the order it queued them, and
+ * likewise the main thread's. Also checks that
+ * delete_callbacks_for_context catches callbacks still on their way
+ * from another thread.
+ *
+ * With -b, runs the benchmark instead. The latency measurement is a
+ * ping-pong between one producer and the main loop, reporting the
+ * time from queueing each callback to its running in the main thread;
+ * then the throughput measurement times the producers' bursts as in
+ * the stress test.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "putty.h"
+
+void out_of_memory(void)
+{
+    fprintf(stderr, "Out of memory!\n");
+    exit(1);
+}
+
+void timer_change_notify(unsigned long next)
+{
+}
+
+void noise_ultralight(NoiseSourceId id, unsigned long data)
+{
+}
+
+static NORETURN PRINTF_LIKE(1, 2) void fatal_error(const char *p, ...)
+{
+    va_list ap;
+    fprintf(stderr, "testcallback: ");
+    va_start(ap, p);
+    vfprintf(stderr, p, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    exit(1);
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int nproducers = 4, ncallbacks = 200000;
+
+typedef struct Item {
+    int producer;                      /* -1 for the main thread */
+    int seq;
+    double sent;
+} Item;
+
+typedef struct Producer {
+    int index;
+    Item *items;
+    pthread_t thread;
+} Producer;
+
+static Producer *producers;
+static int *next_seq;                  /* per producer */
+static int received, expected;
+static int main_next_seq, main_queued;
+static Item *main_items;
+
+/* ----------------------------------------------------------------------
+ * Stress test.
+ */
+
+static void check_item(void *vitem)
+{
+    Item *item = (Item *)vitem;
+    int *nextp = (item->producer < 0 ? &main_next_seq :
+                  &next_seq[item->producer]);
+
+    if (item->seq != *nextp)
+        fatal_error("producer %d: callback %d ran when %d was expected",
+                    item->producer, item->seq, *nextp);
+    (*nextp)++;
+    received++;
+
+    /*
+     * Every so often, queue a callback from the main thread too, so
+     * that they're mixed in with the ones arriving from the producers.
+     */
+    if (item->producer >= 0 && item->seq % 7 == 0 &&
+        main_queued < ncallbacks) {
+        Item *mitem = &main_items[main_queued];
+        mitem->producer = -1;
+        mitem->seq = main_queued++;
+        expected++;
+        queue_toplevel_callback(check_item, mitem);
+    }
+}
+
+static void *producer_thread(void *vp)
+{
+    Producer *p = (Producer *)vp;
+
+    for (int i = 0; i < ncallbacks; i++) {
+        Item *item = &p->items[i];
+        item->producer = p->index;
+        item->seq = i;
+        item->sent = now_sec();
+        queue_toplevel_callback_from_thread(check_item, item);
+    }
+    return NULL;
+}
+
+static bool continue_until_all_received(void *ctx, bool fd, bool cb)
+{
+    return received < expected;
+}
+
+static void start_producers(void)
+{
+    for (int i = 0; i < nproducers; i++) {
+        producers[i].index = i;
+        next_seq[i] = 0;
+        if (pthread_create(&producers[i].thread, NULL, producer_thread,
+                           &producers[i]))
+            fatal_error("pthread_create failed");
+    }
+}
+
+static void join_producers(void)
+{
+    for (int i = 0; i < nproducers; i++)
+        pthread_join(producers[i].thread, NULL);
+}
+
+static double run_producers(void)
+{
+    received = main_next_seq = main_queued = 0;
+    expected = nproducers * ncallbacks;
+
+    double start = now_sec();
+    start_producers();
+    cli_main_loop(cliloop_no_pw_setup, cliloop_no_pw_check,
+                  continue_until_all_received, NULL);
+    double elapsed = now_sec() - start;
+    join_producers();
+
+    for (int i = 0; i < nproducers; i++)
+        if (next_seq[i] != ncallbacks)
+            fatal_error("producer %d: only %d of %d callbacks ran",
+                        i, next_seq[i], ncallbacks);
+    if (main_next_seq != main_queued)
+        fatal_error("main thread: only %d of %d callbacks ran",
+                    main_next_seq, main_queued);
+    if (toplevel_callback_pending())
+        fatal_error("callbacks still pending after all were received");
+
+    return elapsed;
+}
+
+static void must_not_run(void *ctx)
+{
+    fatal_error("callback for a deleted context ran");
+}
+
+static void *delete_test_thread(void *ctx)
+{
+    for (int i = 0; i < 100; i++)
+        queue_toplevel_callback_from_thread(must_not_run, ctx);
+    return NULL;
+}
+
+static void delete_test(void)
+{
+    static int ctx;
+    pthread_t thread;
+
+    if (pthread_create(&thread, NULL, delete_test_thread, &ctx))
+        fatal_error("pthread_create failed");
+    pthread_join(thread, NULL);
+
+    /* The callbacks haven't been collected yet, but must still go */
+    delete_callbacks_for_context(&ctx);
+    if (toplevel_callback_pending())
+        fatal_error("callbacks pending after delete_callbacks_for_context");
+
+    /* And nothing should turn up later via the wakeup fd either */
+    received = 0;
+    expected = 1;
+    queue_toplevel_callback(check_item, &(Item){ .producer = -1 });
+    main_next_seq = 0;
+    cli_main_loop(cliloop_no_pw_setup, cliloop_no_pw_check,
+                  continue_until_all_received, NULL);
+}
+
+/* ----------------------------------------------------------------------
+ * Latency benchmark.
+ */
+
+static pthread_mutex_t pong_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pong_cond = PTHREAD_COND_INITIALIZER;
+static bool pong;
+static double *latencies;
+
+static void ping_received(void *vitem)
+{
+    Item *item = (Item *)vitem;
+    latencies[item->seq] = now_sec() - item->sent;
+    received++;
+
+    pthread_mutex_lock(&pong_mutex);
+    pong = true;
+    pthread_cond_signal(&pong_cond);
+    pthread_mutex_unlock(&pong_mutex);
+}
+
+static void *ping_thread(void *vp)
+{
+    Item *items = (Item *)vp;
+
+    for (int i = 0; i < expected; i++) {
+        items[i].seq = i;
+        items[i].sent = now_sec();
+        queue_toplevel_callback_from_thread(ping_received, &items[i]);
+
+        pthread_mutex_lock(&pong_mutex);
+        while (!pong)
+            pthread_cond_wait(&pong_cond, &pong_mutex);
+        pong = false;
+        pthread_mutex_unlock(&pong_mutex);
+    }
+    return NULL;
+}
+
+static int double_cmp(const void *av, const void *bv)
+{
+    double a = *(const double *)av, b = *(const double *)bv;
+    return a < b ? -1 : a > b ? +1 : 0;
+}
+
+static void latency_benchmark(int n)
+{
+    Item *items = snewn(n, Item);
+    pthread_t thread;
+
+    latencies = snewn(n, double);
+    received = 0;
+    expected = n;
+    pong = false;
+
+    if (pthread_create(&thread, NULL, ping_thread, items))
+        fatal_error("pthread_create failed");
+    cli_main_loop(cliloop_no_pw_setup, cliloop_no_pw_check,
+                  continue_until_all_received, NULL);
+    pthread_join(thread, NULL);
+
+    qsort(latencies, n, sizeof(double), double_cmp);
+    printf("latency over %d round trips (us): min %.1f  median %.1f  "
+           "99%% %.1f  max %.1f\n", n, latencies[0] * 1e6,
+           latencies[n / 2] * 1e6, latencies[n - 1 - n / 100] * 1e6,
+           latencies[n - 1] * 1e6);
+
+    sfree(latencies);
+    sfree(items);
+}
+
+int main(int argc, char **argv)
+{
+    bool benchmark = false;
+
+    while (--argc > 0) {
+        const char *p = *++argv;
+        if (!strcmp(p, "-b")) {
+            benchmark = true;
+        } else if (!strcmp(p, "-p") && argc > 1) {
+            nproducers = atoi(*++argv);
+            argc--;
+        } else if (!strcmp(p, "-n") && argc > 1) {
+            ncallbacks = atoi(*++argv);
+            argc--;
+        } else {
+            fprintf(stderr, "usage: testcallback [-p producers] "
+                    "[-n callbacks] [-b]\n");
+            return 1;
+        }
+    }
+    if (nproducers < 1 || ncallbacks < 1)
+        fatal_error("need at least one producer and one callback");
+
+    uxsel_init();
+    thread_wakeup_setup();
+
+    producers = snewn(nproducers, Producer);
+    next_seq = snewn(nproducers, int);
+    for (int i = 0; i < nproducers; i++)
+        producers[i].items = snewn(ncallbacks, Item);
+    main_items = snewn(ncallbacks, Item);
+
+    if (benchmark) {
+        latency_benchmark(10000);
+        double elapsed = run_producers();
+        printf("throughput with %d producers: %d callbacks in %.3fs "
+               "(%.0f ns each)\n", nproducers, received, elapsed,
+               elapsed * 1e9 / received);
+    } else {
+        for (int round = 0; round < 5; round++)
+            run_producers();
+        delete_test();
+        printf("testcallback: passed\n");
+    }
+
+    for (int i = 0; i < nproducers; i++)
+        sfree(producers[i].items);
+    sfree(producers);
+    sfree(next_seq);
+    sfree(main_items);
+    return 0;
+}
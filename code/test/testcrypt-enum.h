@@ -38,7 +38,6 @@ BEGIN_ENUM_TYPE(macalg)
     ENUM_VALUE("hmac_sha512", &ssh_hmac_sha512)
     ENUM_VALUE("poly1305", &ssh2_poly1305)
     ENUM_VALUE("aesgcm", &ssh2_aesgcm_mac)
-    ENUM_VALUE("aesgcm", &ssh2_aesgcm_mac)
     ENUM_VALUE("aesgcm_sw", &ssh2_aesgcm_mac_sw)
     ENUM_VALUE("aesgcm_ref_poly", &ssh2_aesgcm_mac_ref_poly)
 #if HAVE_CLMUL
@@ -99,6 +98,17 @@ BEGIN_ENUM_TYPE(cipheralg)
     ENUM_VALUE("aes128_gcm_ni", &ssh_aes128_gcm_ni)
     ENUM_VALUE("aes128_cbc_ni", &ssh_aes128_cbc_ni)
 #endif
+#if HAVE_VAES
+    ENUM_VALUE("aes256_ctr_vaes", &ssh_aes256_sdctr_vaes)
+    ENUM_VALUE("aes256_gcm_vaes", &ssh_aes256_gcm_vaes)
+    ENUM_VALUE("aes256_cbc_vaes", &ssh_aes256_cbc_vaes)
+    ENUM_VALUE("aes192_ctr_vaes", &ssh_aes192_sdctr_vaes)
+    ENUM_VALUE("aes192_gcm_vaes", &ssh_aes192_gcm_vaes)
+    ENUM_VALUE("aes192_cbc_vaes", &ssh_aes192_cbc_vaes)
+    ENUM_VALUE("aes128_ctr_vaes", &ssh_aes128_sdctr_vaes)
+    ENUM_VALUE("aes128_gcm_vaes", &ssh_aes128_gcm_vaes)
+    ENUM_VALUE("aes128_cbc_vaes", &ssh_aes128_cbc_vaes)
+#endif
 #if HAVE_NEON_CRYPTO
     ENUM_VALUE("aes256_ctr_neon", &ssh_aes256_sdctr_neon)
     ENUM_VALUE("aes256_gcm_neon", &ssh_aes256_gcm_neon)
@@ -116,6 +126,13 @@ BEGIN_ENUM_TYPE(cipheralg)
     ENUM_VALUE("arcfour256", &ssh_arcfour256_ssh2)
     ENUM_VALUE("arcfour128", &ssh_arcfour128_ssh2)
     ENUM_VALUE("chacha20_poly1305", &ssh2_chacha20_poly1305)
+    ENUM_VALUE("chacha20_poly1305_sw", &ssh2_chacha20_poly1305_sw)
+#if HAVE_AVX2
+    ENUM_VALUE("chacha20_poly1305_avx2", &ssh2_chacha20_poly1305_avx2)
+#endif
+#if HAVE_NEON_CHACHA
+    ENUM_VALUE("chacha20_poly1305_neon", &ssh2_chacha20_poly1305_neon)
+#endif
 END_ENUM_TYPE(cipheralg)
 
 BEGIN_ENUM_TYPE(dh_group)
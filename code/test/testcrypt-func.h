@@ -276,6 +276,10 @@ FUNC(void, ssh2_mac_update, ARG(val_mac, m), ARG(val_string_ptrlen, data))
 FUNC(void, ssh2_mac_next_message, ARG(val_mac, m))
 FUNC_WRAPPED(val_string, ssh2_mac_genresult, ARG(val_mac, m))
 FUNC(val_string_asciz_const, ssh2_mac_text_name, ARG(val_mac, m))
+FUNC_WRAPPED(val_string, ssh2_mac_encrypt_and_generate, ARG(val_mac, m),
+             ARG(val_cipher, c), ARG(val_string_ptrlen, blk), ARG(uint, seq))
+FUNC_WRAPPED(opt_val_string, ssh2_mac_verify_and_decrypt, ARG(val_mac, m),
+             ARG(val_cipher, c), ARG(val_string_ptrlen, blk), ARG(uint, seq))
 
 FUNC(void, aesgcm_set_prefix_lengths,
      ARG(val_mac, m), ARG(uint, skip), ARG(uint, aad))
@@ -560,6 +564,9 @@ FUNC_WRAPPED(val_string, aes256_decrypt_pubkey, ARG(val_string_ptrlen, key),
 FUNC(uint, crc32_rfc1662, ARG(val_string_ptrlen, data))
 FUNC(uint, crc32_ssh1, ARG(val_string_ptrlen, data))
 FUNC(uint, crc32_update, ARG(uint, crc_input), ARG(val_string_ptrlen, data))
+FUNC(boolean, crc32_impl_available, ARG(val_string_ptrlen, impl))
+FUNC(uint, crc32_impl_update, ARG(val_string_ptrlen, impl),
+     ARG(uint, crc_input), ARG(val_string_ptrlen, data))
 FUNC(boolean, crcda_detect, ARG(val_string_ptrlen, packet),
      ARG(val_string_ptrlen, iv))
 FUNC(val_string, get_implementations_commasep, ARG(val_string_ptrlen, alg))
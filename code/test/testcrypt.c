@@ -806,6 +806,36 @@ strbuf *ssh2_mac_genresult_wrapper(ssh2_mac *m)
     return sb;
 }
 
+strbuf *ssh2_mac_encrypt_and_generate_wrapper(
+    ssh2_mac *m, ssh_cipher *c, ptrlen input, unsigned long seq)
+{
+    if (input.len < 4 || (input.len - 4) % ssh_cipher_alg(c)->blksize)
+        fatal_error("ssh2_mac_encrypt_and_generate: needs 4 bytes plus a "
+                    "multiple of %d bytes", ssh_cipher_alg(c)->blksize);
+    strbuf *sb = strbuf_dup(input);
+    strbuf_append(sb, ssh2_mac_alg(m)->len);
+    ssh2_mac_encrypt_and_generate(m, c, sb->u, input.len, seq);
+    return sb;
+}
+
+strbuf *ssh2_mac_verify_and_decrypt_wrapper(
+    ssh2_mac *m, ssh_cipher *c, ptrlen input, unsigned long seq)
+{
+    size_t maclen = ssh2_mac_alg(m)->len;
+    if (input.len < 4 + maclen ||
+        (input.len - 4 - maclen) % ssh_cipher_alg(c)->blksize)
+        fatal_error("ssh2_mac_verify_and_decrypt: needs 4 bytes plus a "
+                    "multiple of %d bytes plus the MAC",
+                    ssh_cipher_alg(c)->blksize);
+    strbuf *sb = strbuf_dup(input);
+    if (!ssh2_mac_verify_and_decrypt(m, c, sb->u, input.len - maclen, seq)) {
+        strbuf_free(sb);
+        return NULL;
+    }
+    strbuf_shrink_to(sb, input.len - maclen);
+    return sb;
+}
+
 ssh_key *ssh_key_base_key_wrapper(ssh_key *key)
 {
     /* To avoid having to explain the borrowed reference to Python,
@@ -1152,17 +1182,45 @@ void prng_seed_update(prng *pr, ptrlen data)
     put_datapl(pr, data);
 }
 
+static const crc32_impl *crc32_impl_lookup(ptrlen name)
+{
+    const crc32_impl *impl = crc32_find_impl(name);
+    if (!impl)
+        fatal_error("crc32 implementation '%.*s': not found",
+                    PTRLEN_PRINTF(name));
+    return impl;
+}
+
+bool crc32_impl_available(ptrlen impl)
+{
+    return crc32_impl_lookup(impl)->check_available();
+}
+
+uint32_t crc32_impl_update(ptrlen impl, uint32_t crc_input, ptrlen data)
+{
+    const crc32_impl *ci = crc32_impl_lookup(impl);
+    if (!ci->check_available())
+        fatal_error("crc32 implementation '%.*s': not available",
+                    PTRLEN_PRINTF(impl));
+    return ci->update(crc_input, data);
+}
+
 bool crcda_detect(ptrlen packet, ptrlen iv)
 {
     if (iv.len != 0 && iv.len != 8)
         fatal_error("crcda_detect: iv must be empty or 8 bytes long");
     if (packet.len % 8 != 0)
         fatal_error("crcda_detect: packet must be a multiple of 8 bytes");
-    struct crcda_ctx *ctx = crcda_make_context();
-    bool toret = detect_attack(ctx, packet.ptr, packet.len,
-                               iv.len ? iv.ptr : NULL);
-    crcda_free_context(ctx);
-    return toret;
+    /*
+     * Reuse one context for every call, as a real SSH-1 connection
+     * would, so that the tests also exercise the detector's handling
+     * of a hash table left over from previous packets.
+     */
+    static struct crcda_ctx *ctx;
+    if (!ctx)
+        ctx = crcda_make_context();
+    return detect_attack(ctx, packet.ptr, packet.len,
+                         iv.len ? iv.ptr : NULL);
 }
 
 ssh_key *ppk_load_s_wrapper(BinarySource *src, char **comment,
@@ -1343,6 +1401,9 @@ strbuf *get_implementations_commasep(ptrlen alg)
 #if HAVE_AES_NI
         put_fmt(out, ",%.*s_ni", PTRLEN_PRINTF(alg));
 #endif
+#if HAVE_VAES
+        put_fmt(out, ",%.*s_vaes", PTRLEN_PRINTF(alg));
+#endif
 #if HAVE_NEON_CRYPTO
         put_fmt(out, ",%.*s_neon", PTRLEN_PRINTF(alg));
 #endif
@@ -1359,6 +1420,22 @@ strbuf *get_implementations_commasep(ptrlen alg)
         put_fmt(out, ",%.*s_sw", PTRLEN_PRINTF(alg));
 #if HAVE_NEON_SHA512
         put_fmt(out, ",%.*s_neon", PTRLEN_PRINTF(alg));
+#endif
+    } else if (ptrlen_eq_string(alg, "chacha20_poly1305")) {
+        put_fmt(out, ",chacha20_poly1305_sw");
+#if HAVE_AVX2
+        put_fmt(out, ",chacha20_poly1305_avx2");
+#endif
+#if HAVE_NEON_CHACHA
+        put_fmt(out, ",chacha20_poly1305_neon");
+#endif
+    } else if (ptrlen_eq_string(alg, "crc32")) {
+        put_fmt(out, ",crc32_sw");
+#if HAVE_CLMUL
+        put_fmt(out, ",crc32_clmul");
+#endif
+#if HAVE_NEON_CRC32
+        put_fmt(out, ",crc32_neon");
 #endif
     }
 
@@ -8,6 +8,18 @@
  * passed to schedule_timer(), so that if a context is freed all
  * the timers associated with it can be immediately annulled.
  *
+ * The timers are kept in a hierarchical timing wheel, so that a
+ * program with tens of thousands of connections, each with its own
+ * keepalive and rekey timers, can add and annul them in constant
+ * time. Each level of the wheel is an array of slots, each slot a
+ * list of timers: a slot at level 0 covers one tick, a slot at level
+ * 1 covers 256 ticks, and so on. A timer is filed at the lowest
+ * level whose slots can tell its expiry time apart from the present.
+ * Whenever the present reaches the start of the span covered by a
+ * slot at a higher level, the timers in that slot are refiled at
+ * lower levels ('cascaded'); the timers in a level-0 slot are run
+ * together when the present reaches it.
+ *
  *
  * The problem is that computer clocks aren't perfectly accurate.
  * The GETTICKCOUNT function returns a 32bit number that normally
@@ -31,89 +43,505 @@
 #include <stdio.h>
 
 #include "putty.h"
-#include "tree234.h"
+
+#ifdef TEST
+/* The test harness at the bottom of this file controls the clock. */
+#undef GETTICKCOUNT
+#define GETTICKCOUNT test_getticks
+static unsigned long test_getticks(void);
+#endif
+
+#define WHEEL_BITS 8
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 4                 /* enough for 32 bits of ticks */
+
+/*
+ * Timers are allocated this many at a time, and never returned to
+ * the system; freed ones go on a free list for reuse.
+ */
+#define TIMER_SLAB_SIZE 256
+
+/* A circular doubly linked list, headed by a dummy link. */
+struct timer_link {
+    struct timer_link *next, *prev;
+};
 
 struct timer {
     timer_fn_t fn;
     void *ctx;
     unsigned long now;
     unsigned long when_set;
+    uint32_t tick;                     /* when the wheel will run it */
+    struct timer_link wheel;           /* in a wheel slot, or run_list */
+    struct timer_link siblings;        /* in its context's list */
 };
 
-static tree234 *timers = NULL;
-static tree234 *timer_contexts = NULL;
+/*
+ * Every context pointer that has had a timer scheduled since it was
+ * last expired has one of these, in a hash table, listing its timers.
+ */
+struct timer_context {
+    void *ctx;
+    struct timer_link timers;
+    struct timer_context *hashnext;
+};
+
+static bool timers_initialised = false;
 static unsigned long now = 0L;
 
-static int compare_timers(void *av, void *bv)
+/*
+ * The wheel itself. All ticks before wheel_time have been dealt with:
+ * their level-0 slots have been run, and any slots at higher levels
+ * whose span starts at one of them have been cascaded. Each level
+ * also has a bitmap of slots that might be non-empty. (Bits are
+ * cleared lazily, when we find that a slot marked in use is empty.)
+ */
+static uint32_t wheel_time;
+static struct timer_link wheel[WHEEL_LEVELS][WHEEL_SIZE];
+static uint32_t wheel_used[WHEEL_LEVELS][WHEEL_SIZE / 32];
+
+/*
+ * Timers the wheel has passed, to be run by the next call to
+ * run_timers (unless the clock has gone back a little since, in
+ * which case they wait here until they're due).
+ */
+static struct timer_link run_list;
+
+static struct timer *free_timers = NULL;
+
+static struct timer_context **contexts = NULL;
+static size_t ncontexts = 0, contexts_size = 0;
+
+/*
+ * The time we last told the front end to call us back at, either via
+ * timer_change_notify or as the return value from run_timers. We
+ * need only notify it of a new timer due before then.
+ */
+static bool callback_pending = false;
+static unsigned long callback_time;
+
+/* The latest time we've seen GETTICKCOUNT return. */
+static unsigned long latest_now;
+
+static inline void link_init(struct timer_link *head)
 {
-    struct timer *a = (struct timer *)av;
-    struct timer *b = (struct timer *)bv;
-    long at = a->now - now;
-    long bt = b->now - now;
+    head->next = head->prev = head;
+}
 
-    if (at < bt)
-        return -1;
-    else if (at > bt)
-        return +1;
+static inline bool link_empty(struct timer_link *head)
+{
+    return head->next == head;
+}
 
-    /*
-     * Failing that, compare on the other two fields, just so that
-     * we don't get unwanted equality.
-     */
-#if defined(__LCC__) || defined(__clang__)
-    /* lcc won't let us compare function pointers. Legal, but annoying. */
-    {
-        int c = memcmp(&a->fn, &b->fn, sizeof(a->fn));
-        if (c)
-            return c;
+static inline void link_add(struct timer_link *head, struct timer_link *l)
+{
+    l->prev = head->prev;
+    l->next = head;
+    l->prev->next = l;
+    head->prev = l;
+}
+
+static inline void link_del(struct timer_link *l)
+{
+    l->prev->next = l->next;
+    l->next->prev = l->prev;
+    l->next = l->prev = l;
+}
+
+/* Move all the links from one list on to the end of another. */
+static inline void link_splice(struct timer_link *head,
+                               struct timer_link *from)
+{
+    if (link_empty(from))
+        return;
+    from->next->prev = head->prev;
+    head->prev->next = from->next;
+    from->prev->next = head;
+    head->prev = from->prev;
+    link_init(from);
+}
+
+static void init_timers(void)
+{
+    if (!timers_initialised) {
+        for (size_t level = 0; level < WHEEL_LEVELS; level++)
+            for (size_t i = 0; i < WHEEL_SIZE; i++)
+                link_init(&wheel[level][i]);
+        link_init(&run_list);
+        now = latest_now = GETTICKCOUNT();
+        wheel_time = (uint32_t)now + 1;
+        timers_initialised = true;
     }
-#else
-    if (a->fn < b->fn)
-        return -1;
-    else if (a->fn > b->fn)
-        return +1;
-#endif
+}
 
-    if (a->ctx < b->ctx)
-        return -1;
-    else if (a->ctx > b->ctx)
-        return +1;
+static struct timer *timer_alloc(void)
+{
+    struct timer *t;
+
+    if (!free_timers) {
+        struct timer *slab = snewn(TIMER_SLAB_SIZE, struct timer);
+        for (size_t i = 0; i < TIMER_SLAB_SIZE; i++) {
+            slab[i].wheel.next = free_timers ? &free_timers->wheel : NULL;
+            free_timers = &slab[i];
+        }
+    }
+
+    t = free_timers;
+    free_timers = (t->wheel.next ?
+                   container_of(t->wheel.next, struct timer, wheel) : NULL);
+    return t;
+}
+
+static void timer_free(struct timer *t)
+{
+    t->wheel.next = free_timers ? &free_timers->wheel : NULL;
+    free_timers = t;
+}
+
+static inline size_t context_hash(void *ctx, size_t size)
+{
+    uintptr_t h = (uintptr_t)ctx;
+    h ^= h >> 16;
+    h *= 0x9E3779B1U;
+    h ^= h >> 15;
+    return h & (size - 1);
+}
+
+static struct timer_context *find_context(void *ctx, bool create)
+{
+    struct timer_context *tc;
+
+    if (contexts_size) {
+        for (tc = contexts[context_hash(ctx, contexts_size)]; tc;
+             tc = tc->hashnext)
+            if (tc->ctx == ctx)
+                return tc;
+    }
+
+    if (!create)
+        return NULL;
+
+    if (ncontexts >= contexts_size) {
+        /* Double the size of the hash table (keeping it a power of 2). */
+        size_t newsize = contexts_size ? contexts_size * 2 : 64;
+        struct timer_context **newtable = snewn(newsize,
+                                                struct timer_context *);
+        for (size_t i = 0; i < newsize; i++)
+            newtable[i] = NULL;
+        for (size_t i = 0; i < contexts_size; i++) {
+            while ((tc = contexts[i]) != NULL) {
+                size_t h = context_hash(tc->ctx, newsize);
+                contexts[i] = tc->hashnext;
+                tc->hashnext = newtable[h];
+                newtable[h] = tc;
+            }
+        }
+        sfree(contexts);
+        contexts = newtable;
+        contexts_size = newsize;
+    }
+
+    tc = snew(struct timer_context);
+    tc->ctx = ctx;
+    link_init(&tc->timers);
+    size_t h = context_hash(ctx, contexts_size);
+    tc->hashnext = contexts[h];
+    contexts[h] = tc;
+    ncontexts++;
+    return tc;
+}
+
+/*
+ * Return the number of the first span at a given level of the wheel
+ * whose slot hasn't yet been cascaded (or run, at level 0). Spans
+ * are numbered modulo the number of them that fit in 32 bits.
+ */
+static inline uint32_t wheel_span_mask(unsigned level)
+{
+    return 0xFFFFFFFFU >> (WHEEL_BITS * level);
+}
+static inline uint32_t wheel_first_span(unsigned level)
+{
+    return (((wheel_time - 1) >> (WHEEL_BITS * level)) + 1) &
+        wheel_span_mask(level);
+}
+
+/*
+ * Whether a timer is due to run, by the rule described at the top of
+ * this file.
+ */
+static inline bool timer_due(struct timer *t)
+{
+    return now - (t->when_set - 10) > t->now - (t->when_set - 10);
+}
+
+static void wheel_file(struct timer *t)
+{
+    unsigned level;
+    uint32_t span;
 
     /*
-     * Failing _that_, the two entries genuinely are equal, and we
-     * never have a need to store them separately in the tree.
+     * If the clock has gone back a little, the wheel may already have
+     * passed this timer's tick; then it waits on run_list, in order of
+     * expiry time, and run_timers holds it back until it's due.
      */
-    return 0;
+    if (t->tick - wheel_time >= 0x80000000U) {
+        struct timer_link *l = run_list.prev;
+        while (l != &run_list &&
+               (long)(container_of(l, struct timer, wheel)->now - t->now) > 0)
+            l = l->prev;
+        link_add(l->next, &t->wheel);
+        return;
+    }
+
+    for (level = 0; level < WHEEL_LEVELS - 1; level++) {
+        span = t->tick >> (WHEEL_BITS * level);
+        if (((span - wheel_first_span(level)) & wheel_span_mask(level))
+            < WHEEL_SIZE)
+            break;
+    }
+    span = (t->tick >> (WHEEL_BITS * level)) & WHEEL_MASK;
+
+    link_add(&wheel[level][span], &t->wheel);
+    wheel_used[level][span / 32] |= 1U << (span % 32);
 }
 
-static int compare_timer_contexts(void *av, void *bv)
+static inline unsigned lowest_bit(uint32_t word)
 {
-    char *a = (char *)av;
-    char *b = (char *)bv;
-    if (a < b)
-        return -1;
-    else if (a > b)
-        return +1;
-    return 0;
+    unsigned n = 0;
+    if (!(word & 0xFFFF)) { n += 16; word >>= 16; }
+    if (!(word & 0xFF)) { n += 8; word >>= 8; }
+    if (!(word & 0xF)) { n += 4; word >>= 4; }
+    if (!(word & 0x3)) { n += 2; word >>= 2; }
+    if (!(word & 0x1)) { n += 1; }
+    return n;
 }
 
-static void init_timers(void)
+/*
+ * Find the first non-empty slot at a given level, counting round
+ * from slot 'start'. Returns its offset from 'start', or -1.
+ */
+static int wheel_next_slot(unsigned level, unsigned start)
 {
-    if (!timers) {
-        timers = newtree234(compare_timers);
-        timer_contexts = newtree234(compare_timer_contexts);
-        now = GETTICKCOUNT();
+    uint32_t *used = wheel_used[level];
+    unsigned i = start, end = start + WHEEL_SIZE;
+
+    while (i < end) {
+        unsigned slot = i & WHEEL_MASK;
+        uint32_t word = used[slot / 32] >> (slot % 32);
+        if (!word) {
+            i += 32 - slot % 32;
+            continue;
+        }
+        i += lowest_bit(word);
+        if (i >= end)
+            break;
+        slot = i & WHEEL_MASK;
+        if (!link_empty(&wheel[level][slot]))
+            return i - start;
+        used[slot / 32] &= ~(1U << (slot % 32));
+        i++;
+    }
+    return -1;
+}
+
+/*
+ * Find the next tick at which the wheel has something to do: run a
+ * level-0 slot, or cascade a slot at a higher level. Returns false if
+ * the wheel is empty, or else its offset from wheel_time.
+ */
+static bool wheel_next_event(uint32_t *offset_out)
+{
+    bool found = false;
+    uint32_t best = 0;
+
+    for (unsigned level = 0; level < WHEEL_LEVELS; level++) {
+        uint32_t first = wheel_first_span(level);
+        int offset = wheel_next_slot(level, first & WHEEL_MASK);
+        if (offset >= 0) {
+            uint32_t span = (first + offset) & wheel_span_mask(level);
+            uint32_t tick = span << (WHEEL_BITS * level);
+            if (!found || tick - wheel_time < best) {
+                best = tick - wheel_time;
+                found = true;
+            }
+        }
+    }
+
+    *offset_out = best;
+    return found;
+}
+
+/*
+ * Deal with the tick wheel_time, and move on to the next. Any slots
+ * whose span starts at this tick are cascaded, from the top level
+ * down, so that a timer cascaded from one level can be cascaded
+ * again from the next; then the timers in the level-0 slot are moved
+ * on to run_list.
+ */
+static void wheel_advance(void)
+{
+    struct timer_link cascade;
+
+    for (unsigned level = WHEEL_LEVELS - 1; level > 0; level--) {
+        if (wheel_time & ((1U << (WHEEL_BITS * level)) - 1))
+            continue;                  /* not the start of a span here */
+
+        unsigned slot = (wheel_time >> (WHEEL_BITS * level)) & WHEEL_MASK;
+        link_init(&cascade);
+        link_splice(&cascade, &wheel[level][slot]);
+        while (!link_empty(&cascade)) {
+            struct timer *t = container_of(cascade.next, struct timer, wheel);
+            link_del(&t->wheel);
+            wheel_file(t);
+        }
+    }
+
+    link_splice(&run_list, &wheel[0][wheel_time & WHEEL_MASK]);
+    wheel_time++;
+}
+
+/*
+ * Find the timer on the wheel that will run first.
+ */
+static struct timer *wheel_first_timer(void)
+{
+    struct timer *best = NULL;
+    uint32_t bestoff = 0;
+
+    for (unsigned level = 0; level < WHEEL_LEVELS; level++) {
+        uint32_t first = wheel_first_span(level);
+        int offset = wheel_next_slot(level, first & WHEEL_MASK);
+        if (offset < 0)
+            continue;
+
+        uint32_t span = (first + offset) & wheel_span_mask(level);
+        uint32_t start = span << (WHEEL_BITS * level);
+        if (best && (uint32_t)(start - wheel_time) >= bestoff)
+            continue;                  /* nothing in here can beat best */
+
+        /*
+         * All the timers in a level-0 slot are due at the same tick,
+         * but at higher levels we must search the slot.
+         */
+        struct timer_link *head = &wheel[level][span & WHEEL_MASK];
+        for (struct timer_link *l = head->next; l != head; l = l->next) {
+            struct timer *t = container_of(l, struct timer, wheel);
+            uint32_t off = t->tick - wheel_time;
+            if (!best || off < bestoff) {
+                best = t;
+                bestoff = off;
+            }
+            if (level == 0)
+                break;
+        }
+    }
+
+    return best;
+}
+
+/*
+ * Called when GETTICKCOUNT has gone backwards since a timer might
+ * have been set. We can no longer trust where the timers are filed,
+ * so take them all off the wheel, set aside to run any that are now
+ * due by the rule described at the top of this file, and file the
+ * rest afresh.
+ */
+static void wheel_rewind(void)
+{
+    struct timer_link all;
+    unsigned long newest = now;
+
+    link_init(&all);
+    for (unsigned level = 0; level < WHEEL_LEVELS; level++) {
+        for (unsigned slot = 0; slot < WHEEL_SIZE; slot++)
+            link_splice(&all, &wheel[level][slot]);
+        for (unsigned i = 0; i < WHEEL_SIZE / 32; i++)
+            wheel_used[level][i] = 0;
+    }
+
+    wheel_time = (uint32_t)now + 1;
+
+    while (!link_empty(&all)) {
+        struct timer *t = container_of(all.next, struct timer, wheel);
+        link_del(&t->wheel);
+        if (timer_due(t)) {
+            link_add(&run_list, &t->wheel);
+        } else {
+            t->tick = (uint32_t)t->now + 1;
+            wheel_file(t);
+            if ((long)(t->when_set - newest) > 0)
+                newest = t->when_set;
+        }
+    }
+
+    /* Rewind again if the clock goes back past any remaining timer. */
+    latest_now = newest;
+}
+
+/*
+ * Run the wheel forward by the given number of ticks, moving any
+ * timers due in that time on to run_list.
+ */
+static void wheel_forward(uint32_t ticks)
+{
+    uint32_t offset;
+
+    while (wheel_next_event(&offset) && offset < ticks) {
+        wheel_time += offset;
+        ticks -= offset + 1;
+        wheel_advance();
+    }
+    wheel_time += ticks;
+}
+
+/*
+ * Update 'now' from GETTICKCOUNT, and bring the wheel up to date with
+ * it, so that every timer due by now is on run_list.
+ */
+static void update_now(void)
+{
+    bool far_ahead = false;
+
+    now = GETTICKCOUNT();
+
+    if ((long)(now - latest_now) > 0) {
+        /* (On a 64-bit platform we can tell if a whole 2^32 went by.) */
+        far_ahead = (now - latest_now) >= 0x80000000UL;
+        latest_now = now;
+    } else if ((long)(now - (latest_now - 10)) < 0) {
+        /* The clock has gone backwards by more than the slack. */
+        wheel_rewind();
+        return;
+    }
+
+    /*
+     * The clock may be slightly behind the wheel, within the slack,
+     * in which case there's nothing to do. If it's ahead by more than
+     * the wheel can measure (we haven't been called for weeks), then
+     * every timer on the wheel is due, so run the wheel round once to
+     * collect them in order, and then skip to the present.
+     */
+    uint32_t ticks = (uint32_t)now - (wheel_time - 1);
+    if (far_ahead || (ticks >= 0x80000000U &&
+                      (uint32_t)(wheel_time - 1 - now) > 10)) {
+        wheel_forward(0x80000000U);
+        wheel_time = (uint32_t)now + 1;
+    } else if (ticks < 0x80000000U) {
+        wheel_forward(ticks);
     }
 }
 
 unsigned long schedule_timer(int ticks, timer_fn_t fn, void *ctx)
 {
     unsigned long when;
-    struct timer *t, *first;
+    struct timer_context *tc;
+    struct timer *t;
 
     init_timers();
 
-    now = GETTICKCOUNT();
+    update_now();
     when = ticks + now;
 
     /*
@@ -124,25 +552,36 @@ unsigned long schedule_timer(int ticks, timer_fn_t fn, void *ctx)
     if (when - now <= 0)
         when = now + 1;
 
-    t = snew(struct timer);
+    tc = find_context(ctx, true);
+    for (struct timer_link *l = tc->timers.next; l != &tc->timers;
+         l = l->next) {
+        t = container_of(l, struct timer, siblings);
+        if (t->fn == fn && t->now == when)
+            return when;               /* identical timer already exists */
+    }
+
+    t = timer_alloc();
     t->fn = fn;
     t->ctx = ctx;
     t->now = when;
     t->when_set = now;
+    link_add(&tc->timers, &t->siblings);
 
-    if (t != add234(timers, t)) {
-        sfree(t);                      /* identical timer already exists */
-    } else {
-        add234(timer_contexts, t->ctx);/* don't care if this fails */
-    }
+    /*
+     * A timer runs once the clock is strictly past its time, so it
+     * goes in the wheel at the tick after.
+     */
+    t->tick = (uint32_t)when + 1;
+    wheel_file(t);
 
-    first = (struct timer *)index234(timers, 0);
-    if (first == t) {
+    if (!callback_pending || (long)(when - callback_time) < 0) {
         /*
-         * This timer is the very first on the list, so we must
-         * notify the front end.
+         * This timer is due before the front end was otherwise
+         * going to call us, so we must notify it.
          */
-        timer_change_notify(first->now);
+        callback_pending = true;
+        callback_time = when;
+        timer_change_notify(when);
     }
 
     return when;
@@ -167,56 +606,713 @@ unsigned long timing_last_clock(void)
 bool run_timers(unsigned long anow, unsigned long *next)
 {
     struct timer *first;
+    struct timer_link held;
 
     init_timers();
 
-    now = GETTICKCOUNT();
+    update_now();
+
+    /*
+     * The front end will hear about the next timer from our return
+     * value, and anything scheduled by the timers we run will be due
+     * after now, so there's no need to send it timer_change_notify
+     * in the meantime.
+     */
+    callback_pending = true;
+    callback_time = now;
+
+    /*
+     * Run everything update_now found was due. If the timer functions
+     * schedule more timers, they will update 'now' again, and add to
+     * run_list any other timers that have become due meanwhile. Any
+     * timer that isn't due after all, because the clock has gone back
+     * a little since the wheel passed it, is held back.
+     */
+    link_init(&held);
+    while (!link_empty(&run_list)) {
+        struct timer *t = container_of(run_list.next, struct timer, wheel);
+        link_del(&t->wheel);
+        if (!timer_due(t)) {
+            link_add(&held, &t->wheel);
+            continue;
+        }
+        link_del(&t->siblings);
+        t->fn(t->ctx, t->now);
+        timer_free(t);
+    }
+    link_splice(&run_list, &held);
+
+    first = wheel_first_timer();
+    for (struct timer_link *l = run_list.next; l != &run_list; l = l->next) {
+        struct timer *t = container_of(l, struct timer, wheel);
+        if (!first || (long)(t->now - first->now) < 0)
+            first = t;
+    }
+    if (!first) {
+        callback_pending = false;
+        return false;                  /* no timers remaining */
+    }
+
+    /*
+     * This is the first timer that is in the future. Return when
+     * it's due.
+     */
+    *next = callback_time = first->now;
+    return true;
+}
+
+/*
+ * Call to expire all timers associated with a given context.
+ */
+void expire_timer_context(void *ctx)
+{
+    struct timer_context *tc, **prev;
+
+    init_timers();
+
+    /*
+     * If the context isn't known (presumably because no timers
+     * ever actually got scheduled for it) then that's fine and we
+     * simply don't need to do anything.
+     */
+    if (!contexts_size)
+        return;
+    for (prev = &contexts[context_hash(ctx, contexts_size)];
+         (tc = *prev) != NULL; prev = &tc->hashnext)
+        if (tc->ctx == ctx)
+            break;
+    if (!tc)
+        return;
+
+    while (!link_empty(&tc->timers)) {
+        struct timer *t = container_of(tc->timers.next, struct timer,
+                                       siblings);
+        link_del(&t->siblings);
+        link_del(&t->wheel);
+        timer_free(t);
+    }
+
+    *prev = tc->hashnext;
+    ncontexts--;
+    sfree(tc);
+}
+
+#ifdef TEST
+
+/*
+ * Test harness. This runs random sequences of operations on a
+ * simulated clock, and checks that the timing wheel runs the same
+ * timers at the same times as a reference implementation, which is
+ * the sorted tree of timers that this module used to use. With -b, it
+ * benchmarks the two against each other with large numbers of timers
+ * instead.
+ */
+
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+#include "tree234.h"
+
+static unsigned long test_clock;
+static unsigned long test_getticks(void)
+{
+    return test_clock;
+}
+
+static int n_errors = 0;
+
+static PRINTF_LIKE(1, 2) void error(const char *fmt, ...)
+{
+    va_list ap;
+    printf("ERROR: ");
+    va_start(ap, fmt);
+    vfprintf(stdout, fmt, ap);
+    va_end(ap);
+    printf("\n");
+    n_errors++;
+}
+
+void out_of_memory(void)
+{
+    fprintf(stderr, "out of memory!\n");
+    exit(2);
+}
+
+/*
+ * The front end's idea of when it has to call run_timers next, kept
+ * up to date from timer_change_notify and the return values from
+ * run_timers, so that we can check it's never told too late.
+ */
+static bool fe_pending;
+static unsigned long fe_time;
+
+void timer_change_notify(unsigned long next)
+{
+    fe_pending = true;
+    fe_time = next;
+}
+
+/* ----------------------------------------------------------------------
+ * The reference implementation.
+ */
+
+struct ref_timer {
+    timer_fn_t fn;
+    void *ctx;
+    unsigned long now;
+    unsigned long when_set;
+};
+
+static tree234 *ref_timers = NULL;
+static tree234 *ref_contexts = NULL;
+static unsigned long ref_now = 0L;
+
+static int ref_compare_timers(void *av, void *bv)
+{
+    struct ref_timer *a = (struct ref_timer *)av;
+    struct ref_timer *b = (struct ref_timer *)bv;
+    long at = a->now - ref_now;
+    long bt = b->now - ref_now;
+
+    if (at < bt)
+        return -1;
+    else if (at > bt)
+        return +1;
+
+    if (memcmp(&a->fn, &b->fn, sizeof(a->fn)))
+        return memcmp(&a->fn, &b->fn, sizeof(a->fn));
+
+    if (a->ctx < b->ctx)
+        return -1;
+    else if (a->ctx > b->ctx)
+        return +1;
+
+    return 0;
+}
+
+static int ref_compare_contexts(void *av, void *bv)
+{
+    char *a = (char *)av;
+    char *b = (char *)bv;
+    if (a < b)
+        return -1;
+    else if (a > b)
+        return +1;
+    return 0;
+}
+
+static void ref_init(void)
+{
+    if (!ref_timers) {
+        ref_timers = newtree234(ref_compare_timers);
+        ref_contexts = newtree234(ref_compare_contexts);
+        ref_now = GETTICKCOUNT();
+    }
+}
+
+static unsigned long ref_schedule_timer(int ticks, timer_fn_t fn, void *ctx)
+{
+    unsigned long when;
+    struct ref_timer *t;
+
+    ref_init();
+
+    ref_now = GETTICKCOUNT();
+    when = ticks + ref_now;
+    if (when - ref_now <= 0)
+        when = ref_now + 1;
+
+    t = snew(struct ref_timer);
+    t->fn = fn;
+    t->ctx = ctx;
+    t->now = when;
+    t->when_set = ref_now;
+
+    if (t != add234(ref_timers, t))
+        sfree(t);
+    else
+        add234(ref_contexts, t->ctx);
+
+    return when;
+}
+
+static bool ref_run_timers(unsigned long anow, unsigned long *next)
+{
+    struct ref_timer *first;
+
+    ref_init();
+
+    ref_now = GETTICKCOUNT();
 
     while (1) {
-        first = (struct timer *)index234(timers, 0);
+        first = (struct ref_timer *)index234(ref_timers, 0);
 
         if (!first)
-            return false;              /* no timers remaining */
+            return false;
 
-        if (find234(timer_contexts, first->ctx, NULL) == NULL) {
-            /*
-             * This timer belongs to a context that has been
-             * expired. Delete it without running.
-             */
-            delpos234(timers, 0);
+        if (find234(ref_contexts, first->ctx, NULL) == NULL) {
+            delpos234(ref_timers, 0);
             sfree(first);
-        } else if (now - (first->when_set - 10) >
+        } else if (ref_now - (first->when_set - 10) >
                    first->now - (first->when_set - 10)) {
-            /*
-             * This timer is active and has reached its running
-             * time. Run it.
-             */
-            delpos234(timers, 0);
+            delpos234(ref_timers, 0);
             first->fn(first->ctx, first->now);
             sfree(first);
         } else {
-            /*
-             * This is the first still-active timer that is in the
-             * future. Return how long it has yet to go.
-             */
             *next = first->now;
             return true;
         }
     }
 }
 
+static void ref_expire_timer_context(void *ctx)
+{
+    ref_init();
+    del234(ref_contexts, ctx);
+}
+
+typedef struct {
+    const char *name;
+    unsigned long (*schedule)(int ticks, timer_fn_t fn, void *ctx);
+    bool (*run)(unsigned long anow, unsigned long *next);
+    void (*expire)(void *ctx);
+} timingimpl;
+
+static const timingimpl impls[] = {
+    {"tree", ref_schedule_timer, ref_run_timers, ref_expire_timer_context},
+    {"wheel", schedule_timer, run_timers, expire_timer_context},
+};
+
+/* The implementation currently under test. */
+static const timingimpl *impl;
+
+/* ----------------------------------------------------------------------
+ * Random tests.
+ */
+
+static unsigned randomnumber(unsigned *seed)
+{
+    *seed *= 1103515245;
+    *seed += 12345;
+    return ((*seed) / 65536) % 32768;
+}
+
+static unsigned long randomlong(unsigned *seed, unsigned long limit)
+{
+    unsigned long r = randomnumber(seed);
+    r = (r << 15) | randomnumber(seed);
+    r = (r << 15) | randomnumber(seed);
+    return r % limit;
+}
+
+struct test_ctx {
+    int id;
+    bool expired;
+};
+
+struct test_event {
+    int run, id;
+    unsigned long when;
+};
+
+static struct test_event *events;
+static size_t nevents, eventsize;
+static int nruns;
+
 /*
- * Call to expire all timers associated with a given context.
+ * What a timer function does is decided by a hash of its context and
+ * time, so that it doesn't depend on the order in which timers due at
+ * the same moment are run.
  */
-void expire_timer_context(void *ctx)
+static unsigned test_hash(int id, unsigned long when)
 {
-    init_timers();
+    unsigned h = id * 0x9E3779B1U ^ (unsigned)when;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6DU;
+    h ^= h >> 12;
+    return h;
+}
+
+static void test_timer_fn(void *vctx, unsigned long now)
+{
+    struct test_ctx *ctx = (struct test_ctx *)vctx;
+    unsigned h = test_hash(ctx->id, now);
+
+    sgrowarray(events, eventsize, nevents);
+    events[nevents].run = nruns;
+    events[nevents].id = ctx->id;
+    events[nevents].when = now;
+    nevents++;
+
+    if (h % 4 == 0)
+        impl->schedule(1 + (h >> 8) % 5000, test_timer_fn, ctx);
+    else if (h % 16 == 1) {
+        impl->expire(ctx);
+        ctx->expired = true;
+    }
+}
+
+static int compare_events(const void *av, const void *bv)
+{
+    const struct test_event *a = av, *b = bv;
+    if (a->run != b->run)
+        return a->run < b->run ? -1 : +1;
+    if (a->when != b->when)
+        return a->when < b->when ? -1 : +1;
+    if (a->id != b->id)
+        return a->id < b->id ? -1 : +1;
+    return 0;
+}
+
+#define NCTX 200
+
+/*
+ * Check that the front end will be woken in time for every timer
+ * still to run.
+ */
+static void check_frontend(void)
+{
+    struct timer *t = wheel_first_timer();
+    for (struct timer_link *l = run_list.next; l != &run_list; l = l->next) {
+        struct timer *rt = container_of(l, struct timer, wheel);
+        if (!t || (long)(rt->now - t->now) < 0)
+            t = rt;
+    }
+    if (t && !fe_pending)
+        error("timer at %lu pending but front end not told", t->now);
+    else if (t && (long)(t->now - fe_time) < 0)
+        error("timer at %lu pending but front end told %lu", t->now, fe_time);
+}
+
+/*
+ * Run a random sequence of operations on the current implementation,
+ * logging what runs when. Returns the log, sorted.
+ */
+static struct test_event *randomtest(unsigned seed, int nsteps,
+                                     unsigned long startclock,
+                                     size_t *nevents_out,
+                                     unsigned long **results)
+{
+    struct test_ctx **ctxs = snewn(NCTX, struct test_ctx *);
+    struct test_ctx **all = NULL;
+    size_t nall = 0, allsize = 0;
+    int nextid = 0;
+    unsigned long maxclock;
+    unsigned long *res = snewn(2 * (nsteps + NCTX) + 1, unsigned long);
+
+    events = NULL;
+    nevents = eventsize = 0;
+    nruns = 0;
+    test_clock = maxclock = startclock;
+
+    for (int step = 0; step < nsteps + NCTX; step++) {
+        unsigned r = randomnumber(&seed) % 100;
+        int i = randomnumber(&seed) % NCTX;
+
+        /*
+         * The old implementation would resurrect the timers of a
+         * context that was expired and then reused, so we never
+         * reuse one, and start each slot with a fresh context.
+         */
+        if (step < NCTX)
+            i = step;
+        if (step < NCTX || ctxs[i]->expired) {
+            sgrowarray(all, allsize, nall);
+            all[nall] = ctxs[i] = snew(struct test_ctx);
+            all[nall]->id = nextid++;
+            all[nall++]->expired = false;
+        }
+
+        if (r < 45) {
+            unsigned kind = randomnumber(&seed) % 100;
+            unsigned long ticks = (kind < 70 ? 1 + randomlong(&seed, 300) :
+                                   kind < 90 ? 1 + randomlong(&seed, 100000) :
+                                   kind < 98 ? 1 + randomlong(&seed, 10000000) :
+                                   1 + randomlong(&seed, INT_MAX / 2));
+            impl->schedule(ticks, test_timer_fn, ctxs[i]);
+            if (kind % 10 == 0) /* schedule an identical one */
+                impl->schedule(ticks, test_timer_fn, ctxs[i]);
+        } else if (r < 50) {
+            impl->expire(ctxs[i]);
+            ctxs[i]->expired = true;
+        } else {
+            unsigned kind = randomnumber(&seed) % 1000;
+            if (kind < 600)
+                test_clock += randomlong(&seed, 50);
+            else if (kind < 900)
+                test_clock += randomlong(&seed, 5000);
+            else if (kind < 980)
+                test_clock += randomlong(&seed, 10000000);
+            else if (kind < 998)
+                test_clock -= randomlong(&seed, 10);
+            else if (sizeof(unsigned long) > 4)
+                test_clock += 0x80000000UL + randomlong(&seed, 100000);
+
+            /*
+             * Let the clock go backwards only within the slack, since
+             * beyond that the old implementation doesn't run all the
+             * timers that are due at once (see rewindtest).
+             */
+            if ((long)(test_clock - maxclock) > 0)
+                maxclock = test_clock;
+            else if ((long)(test_clock - (maxclock - 9)) < 0)
+                test_clock = maxclock - 9;
+
+            if (randomnumber(&seed) % 3) {
+                unsigned long next = 0;
+                bool ret = impl->run(test_clock, &next);
+                fe_pending = ret;
+                fe_time = next;
+                res[2 * nruns] = ret;
+                res[2 * nruns + 1] = ret ? next : 0;
+                nruns++;
+                if (ret && randomnumber(&seed) % 2 &&
+                    (long)(next + 1 - maxclock) > 0)
+                    maxclock = test_clock = next + 1;
+            }
+        }
+
+        if (impl->schedule == schedule_timer)
+            check_frontend();
+    }
 
     /*
-     * We don't bother to check the return value; if the context
-     * already wasn't in the tree (presumably because no timers
-     * ever actually got scheduled for it) then that's fine and we
-     * simply don't need to do anything.
+     * Expire everything, and run the timers once more so that the old
+     * implementation throws away its annulled ones, which might
+     * otherwise be resurrected if a later test got the same context
+     * pointers from malloc.
      */
-    del234(timer_contexts, ctx);
+    for (size_t i = 0; i < nall; i++)
+        impl->expire(all[i]);
+    {
+        unsigned long next;
+        if (impl->run(test_clock, &next))
+            error("timers left after expiring every context");
+    }
+    for (size_t i = 0; i < nall; i++)
+        sfree(all[i]);
+    sfree(all);
+    sfree(ctxs);
+
+    qsort(events, nevents, sizeof(*events), compare_events);
+    *nevents_out = nevents;
+    res[2 * nruns] = nruns;
+    *results = res;
+    return events;
 }
+
+static void comparetest(unsigned seed, int nsteps, unsigned long startclock)
+{
+    struct test_event *ev[lenof(impls)];
+    size_t nev[lenof(impls)];
+    unsigned long *res[lenof(impls)];
+    int runs[lenof(impls)];
+
+    for (size_t k = 0; k < lenof(impls); k++) {
+        impl = &impls[k];
+        ev[k] = randomtest(seed, nsteps, startclock, &nev[k], &res[k]);
+        runs[k] = nruns;
+    }
+
+    if (runs[0] != runs[1])
+        error("seed %u clock %lu: %d runs vs %d",
+              seed, startclock, runs[0], runs[1]);
+    for (int i = 0; i < runs[0] && i < runs[1]; i++) {
+        if (res[0][2 * i] != res[1][2 * i] ||
+            res[0][2 * i + 1] != res[1][2 * i + 1]) {
+            error("seed %u clock %lu run %d: %s returned %d,%lu, %s %d,%lu",
+                  seed, startclock, i,
+                  impls[0].name, (int)res[0][2 * i], res[0][2 * i + 1],
+                  impls[1].name, (int)res[1][2 * i], res[1][2 * i + 1]);
+            break;
+        }
+    }
+
+    if (nev[0] != nev[1])
+        error("seed %u clock %lu: %s ran %zu timers, %s %zu",
+              seed, startclock, impls[0].name, nev[0], impls[1].name, nev[1]);
+    for (size_t i = 0; i < nev[0] && i < nev[1]; i++) {
+        if (compare_events(&ev[0][i], &ev[1][i])) {
+            error("seed %u clock %lu event %zu: %s ran %d at %lu in "
+                  "run %d, %s ran %d at %lu in run %d", seed, startclock, i,
+                  impls[0].name, ev[0][i].id, ev[0][i].when, ev[0][i].run,
+                  impls[1].name, ev[1][i].id, ev[1][i].when, ev[1][i].run);
+            break;
+        }
+    }
+
+    for (size_t k = 0; k < lenof(impls); k++) {
+        sfree(ev[k]);
+        sfree(res[k]);
+    }
+}
+
+/*
+ * When the clock goes a long way backwards, every timer set before
+ * then should go off. (The reference implementation doesn't always
+ * manage this in a single call to run_timers, so we can't compare.)
+ */
+static int rewind_count;
+static void rewind_fn(void *ctx, unsigned long now)
+{
+    rewind_count++;
+}
+
+static void rewindtest(void)
+{
+    int ctxs[100];
+    unsigned long next;
+
+    test_clock = 5000000;
+    for (int i = 0; i < 100; i++)
+        schedule_timer(1000 * (i + 1), rewind_fn, &ctxs[i]);
+    test_clock += 50500;
+    rewind_count = 0;
+    run_timers(test_clock, &next);
+    if (rewind_count != 50)
+        error("rewind: %d timers ran before the jump, expected 50",
+              rewind_count);
+
+    test_clock -= 3600000;
+    schedule_timer(100, rewind_fn, &ctxs[0]);
+    rewind_count = 0;
+    run_timers(test_clock, &next);
+    if (rewind_count != 50)
+        error("rewind: %d timers ran after the jump, expected 50",
+              rewind_count);
+    if (!run_timers(test_clock, &next) || next != test_clock + 100)
+        error("rewind: new timer not pending");
+    test_clock += 101;
+    rewind_count = 0;
+    if (run_timers(test_clock, &next) || rewind_count != 1)
+        error("rewind: new timer did not run");
+
+    for (int i = 0; i < 100; i++)
+        expire_timer_context(&ctxs[i]);
+}
+
+/* ----------------------------------------------------------------------
+ * Benchmark: n connections, each keeping a timer going that it
+ * reschedules every time it goes off. Now and then, a connection
+ * closes and a new one takes its place.
+ */
+
+struct bench_conn {
+    int period;
+};
+
+static void bench_fn(void *ctx, unsigned long now)
+{
+    struct bench_conn *c = (struct bench_conn *)ctx;
+    impl->schedule(c->period, bench_fn, c);
+}
+
+static double elapsed(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+#define NPHASES 4
+
+static void benchmark(int n)
+{
+    static const char *const phases[NPHASES] = {
+        "schedule", "run", "churn", "expire",
+    };
+    double times[lenof(impls)][NPHASES];
+    struct bench_conn **conns = snewn(n, struct bench_conn *);
+
+    for (size_t k = 0; k < lenof(impls); k++) {
+        unsigned seed = 1;
+        unsigned long next, end;
+        clock_t start;
+        int p = 0;
+
+        impl = &impls[k];
+        test_clock = 1000000;
+        for (int i = 0; i < n; i++) {
+            conns[i] = snew(struct bench_conn);
+            conns[i]->period = 1000 + randomlong(&seed, 59000);
+        }
+
+        start = clock();
+        for (int i = 0; i < n; i++)
+            impl->schedule(conns[i]->period, bench_fn, conns[i]);
+        times[k][p++] = elapsed(start);
+
+        /* Ten minutes, jumping straight to each timer in turn. */
+        start = clock();
+        end = test_clock + 600000;
+        while (impl->run(test_clock, &next) && (long)(next - end) < 0)
+            test_clock = next + 1;
+        times[k][p++] = elapsed(start);
+
+        start = clock();
+        for (int i = 0; i < 2 * n; i++) {
+            int j = randomlong(&seed, n);
+            impl->expire(conns[j]);
+            sfree(conns[j]);
+            conns[j] = snew(struct bench_conn);
+            conns[j]->period = 1000 + randomlong(&seed, 59000);
+            impl->schedule(conns[j]->period, bench_fn, conns[j]);
+        }
+        times[k][p++] = elapsed(start);
+
+        start = clock();
+        for (int i = 0; i < n; i++)
+            impl->expire(conns[i]);
+        impl->run(test_clock, &next);
+        times[k][p++] = elapsed(start);
+
+        for (int i = 0; i < n; i++)
+            sfree(conns[i]);
+    }
+
+    printf("%d connections\n%-10s", n, "");
+    for (size_t k = 0; k < lenof(impls); k++)
+        printf(" %10s", impls[k].name);
+    printf("\n");
+    for (int p = 0; p < NPHASES; p++) {
+        printf("%-10s", phases[p]);
+        for (size_t k = 0; k < lenof(impls); k++)
+            printf(" %9.3fs", times[k][p]);
+        printf("\n");
+    }
+
+    sfree(conns);
+}
+
+int main(int argc, char **argv)
+{
+    bool bench = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-b")) {
+            bench = true;
+        } else {
+            fprintf(stderr, "unrecognised option '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (bench) {
+        benchmark(1000);
+        benchmark(10000);
+        benchmark(100000);
+        return (n_errors != 0);
+    }
+
+    for (unsigned seed = 0; seed < 20; seed++) {
+        comparetest(seed, 20000, 1000000);
+        /* and across the points where 32-bit and full-width ticks wrap */
+        comparetest(seed, 20000, 0xFFFFFFFFUL - 1000000);
+        comparetest(seed, 20000, (unsigned long)-1000000L);
+    }
+    rewindtest();
+
+    printf("%d errors found\n", n_errors);
+    return (n_errors != 0);
+}
+
+#endif /* TEST */
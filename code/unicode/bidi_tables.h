@@ -0,0 +1,2240 @@
+/*
+ * Unicode property lookup tables.
+ *
+ * Generated by mkunitab.pl from the tables in terminal/bidi.c.
+ * You should edit that file rather than editing this one.
+ */
+
+/* bidi_type: 430 blocks of 16, 89 index blocks of 32, 14752 bytes */
+#define BIDI_TYPE_SHIFT 4
+#define BIDI_TYPE_MSHIFT 5
+static const uint8_t bidi_type_top[2176] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
+    21, 22, 21, 23, 24, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 26, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 27, 28, 29, 30, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 31, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41,
+    42, 43, 44, 45, 46, 47, 48, 49, 50, 25, 51, 52, 21, 21, 21, 21, 53, 25, 25,
+    54, 21, 21, 21, 21, 21, 21, 21, 25, 55, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 25, 56, 21, 57, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 58, 25, 25, 59, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 60, 61, 62, 21, 21, 21, 21, 63, 21, 21, 21, 21, 21, 21, 21,
+    21, 64, 65, 66, 67, 68, 25, 69, 21, 70, 71, 72, 21, 73, 74, 21, 75, 76, 77,
+    78, 21, 21, 21, 79, 21, 21, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 80, 25, 25, 25, 25,
+    25, 25, 25, 81, 82, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 83, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 84, 21, 21, 21, 21, 21, 21, 25, 85,
+    21, 21, 25, 25, 25, 25, 25, 25, 25, 25, 25, 86, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 87, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21,
+    21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 21, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 88, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25, 25,
+    25, 25, 25, 25, 25, 25, 25, 88,
+};
+static const uint16_t bidi_type_mid[][1 << BIDI_TYPE_MSHIFT] = {
+    {
+        0, 1, 2, 3, 4, 5, 4, 6, 7, 8, 9, 10, 11, 12, 11, 12, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 13, 14, 14, 15, 16, 17, 17,
+        17, 17, 17, 17, 17, 18, 19, 11, 20, 11, 11, 11, 11, 21,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 22, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 4, 11, 23, 11, 11, 24, 25, 17, 26, 27, 28, 29, 30,
+    },
+    {
+        31, 32, 33, 33, 34, 17, 35, 36, 33, 33, 33, 33, 33, 37, 38, 39, 40, 41,
+        33, 17, 42, 33, 33, 33, 33, 33, 43, 44, 28, 28, 45, 46,
+    },
+    {
+        28, 47, 48, 49, 28, 50, 51, 33, 52, 53, 33, 33, 54, 17, 55, 17, 56, 11,
+        11, 57, 58, 59, 60, 11, 61, 62, 63, 64, 65, 66, 67, 68,
+    },
+    {
+        69, 62, 63, 70, 71, 72, 73, 74, 75, 20, 63, 76, 77, 78, 67, 79, 80, 62,
+        63, 81, 82, 83, 67, 84, 85, 86, 87, 88, 89, 90, 73, 91,
+    },
+    {
+        92, 93, 63, 94, 95, 96, 67, 97, 98, 93, 63, 99, 100, 101, 67, 102, 103,
+        93, 11, 104, 105, 106, 67, 11, 107, 108, 11, 109, 110, 111, 73, 112,
+    },
+    {
+        4, 11, 11, 113, 114, 115, 16, 16, 116, 11, 117, 118, 119, 120, 16, 16,
+        11, 121, 11, 122, 123, 11, 124, 125, 126, 127, 17, 128, 129, 5, 16, 16,
+    },
+    {
+        11, 11, 130, 131, 11, 132, 133, 134, 135, 136, 11, 11, 137, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 11, 11, 11, 138, 139, 11, 11, 138, 11, 11, 140, 141, 12, 11, 11,
+        11, 141, 11, 11, 11, 142, 11, 124, 11, 16, 11, 11, 11, 11, 11, 143,
+    },
+    {
+        4, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 144, 5, 11, 11, 11, 11, 11, 145, 11,
+        146, 11, 147, 11, 148, 149, 150, 11, 11, 11, 151, 152, 153, 154, 16,
+    },
+    {
+        155, 154, 11, 11, 11, 11, 11, 145, 156, 11, 157, 11, 11, 11, 11, 158,
+        11, 159, 160, 161, 73, 11, 162, 163, 11, 11, 115, 11, 154, 5, 16, 16,
+    },
+    {
+        11, 164, 11, 11, 11, 165, 166, 167, 154, 154, 162, 17, 168, 16, 16, 16,
+        169, 11, 11, 170, 171, 11, 172, 173, 174, 11, 175, 11, 11, 11, 176,
+        177,
+    },
+    {
+        11, 11, 178, 179, 180, 11, 11, 11, 145, 11, 11, 181, 84, 182, 183, 184,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 17, 17, 17, 17,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        143, 11, 11, 143, 185, 11, 162, 11, 11, 11, 186, 187, 188, 124, 187,
+    },
+    {
+        189, 16, 190, 191, 192, 193, 194, 195, 196, 124, 197, 197, 198, 17, 17,
+        199, 200, 201, 202, 120, 203, 16, 11, 11, 145, 16, 16, 16, 16, 16, 16,
+        16,
+    },
+    {
+        16, 204, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 73, 11, 11, 11, 5, 16, 205, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 206, 207, 11, 11, 11, 11, 154, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 208, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 209, 210, 11,
+        11, 137, 11, 11, 11, 211, 212, 11, 213, 214, 214, 214, 214, 17, 17,
+    },
+    {
+        215, 16, 216, 217, 4, 11, 11, 11, 11, 218, 4, 11, 11, 11, 11, 219, 220,
+        11, 11, 4, 11, 11, 11, 11, 159, 11, 11, 11, 16, 16, 16, 11,
+    },
+    {
+        11, 124, 11, 11, 11, 16, 11, 221, 11, 11, 11, 78, 115, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 222, 11, 11, 11, 11, 11, 162, 11, 159,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 124, 16, 16, 16, 16, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        124, 11, 115, 16, 11, 11, 223, 224, 11, 225, 11, 11, 11, 11, 11, 226,
+        16, 16, 227, 11, 11, 11, 11, 11, 123, 11, 11, 11, 5, 228, 16, 227,
+    },
+    {
+        229, 11, 230, 231, 11, 11, 11, 232, 11, 11, 11, 11, 233, 154, 17, 234,
+        11, 11, 235, 11, 236, 237, 11, 124, 56, 11, 11, 238, 239, 88, 240, 159,
+    },
+    {
+        11, 11, 241, 242, 243, 120, 11, 244, 11, 11, 11, 245, 246, 247, 248,
+        249, 250, 251, 214, 11, 11, 11, 154, 11, 11, 11, 11, 11, 11, 11, 252,
+        154,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 232, 11, 222, 11, 11, 115,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 162, 11, 11, 11, 11, 11, 11, 154, 16, 16, 213,
+        253, 254, 255, 256, 33, 33, 33, 33, 33, 33, 33, 257, 258, 33, 33,
+    },
+    {
+        33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33, 33,
+        33, 259, 16, 33, 33, 33, 33, 260, 33, 33, 261, 16, 16, 262,
+    },
+    {
+        17, 16, 17, 16, 16, 263, 264, 265, 33, 33, 33, 33, 33, 33, 33, 266,
+        267, 3, 4, 5, 4, 5, 73, 11, 11, 11, 11, 159, 268, 269, 270, 16,
+    },
+    {
+        271, 11, 12, 272, 162, 162, 16, 16, 11, 11, 11, 11, 11, 11, 11, 5, 273,
+        11, 11, 274, 16, 16, 16, 16, 275, 16, 16, 16, 16, 11, 11, 276,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 11, 124, 11, 11, 11, 78, 277, 278, 11,
+        11, 279, 11, 5, 11, 11, 280, 11, 239, 11, 11, 281, 158, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 162, 154, 11, 11, 281, 11, 115, 11,
+        11, 84, 11, 11, 11, 282, 219, 219, 283, 20, 284, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 213, 11, 158, 84, 16, 21, 11, 11, 285, 16, 16, 16, 16,
+    },
+    {
+        286, 28, 28, 287, 28, 288, 28, 28, 28, 49, 289, 16, 16, 16, 28, 290,
+        28, 291, 28, 292, 16, 16, 16, 16, 28, 28, 28, 293, 28, 294, 28, 28,
+    },
+    {
+        295, 296, 28, 297, 298, 298, 28, 28, 28, 28, 16, 16, 28, 28, 299, 300,
+        28, 28, 28, 301, 28, 302, 28, 303, 28, 304, 305, 16, 16, 16, 16, 16,
+    },
+    {
+        28, 28, 28, 28, 298, 16, 16, 16, 28, 28, 28, 306, 28, 28, 28, 307, 33,
+        33, 308, 309, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 310, 311, 28, 28, 312, 313, 16, 16, 16, 16, 28,
+        28, 314, 33, 43, 315, 16, 28, 316, 16, 16, 28, 291, 16, 28, 300,
+    },
+    {
+        317, 11, 11, 318, 319, 16, 73, 320, 174, 11, 11, 321, 322, 11, 145,
+        154, 56, 11, 323, 324, 84, 11, 11, 325, 174, 11, 11, 326, 327, 11, 4,
+        163,
+    },
+    {
+        11, 20, 223, 328, 16, 16, 16, 16, 329, 239, 154, 11, 11, 223, 330, 154,
+        331, 62, 63, 332, 333, 334, 335, 336, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 318, 337, 338, 14, 16, 11, 11, 11, 339, 340, 154, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 11, 11, 11, 341, 133, 342, 16, 16,
+    },
+    {
+        11, 11, 11, 343, 344, 154, 16, 16, 11, 11, 345, 346, 154, 16, 16, 16,
+        11, 142, 347, 11, 213, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 223, 348, 16, 16, 16, 16, 16, 16, 11, 11, 11, 11, 11, 349, 350,
+        351, 11, 352, 325, 154, 16, 16, 16, 16, 353, 11, 11, 354, 344, 16,
+    },
+    {
+        355, 11, 11, 356, 357, 358, 11, 11, 359, 360, 361, 11, 11, 11, 11, 145,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        63, 11, 11, 362, 158, 11, 124, 11, 11, 363, 364, 365, 16, 16, 16, 16,
+        366, 11, 11, 367, 368, 154, 369, 11, 159, 370, 154, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 11, 371, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 78, 11, 372, 198, 373,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 154, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 159, 163, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 232, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 11, 11, 11, 11, 11, 11, 361,
+    },
+    {
+        11, 11, 159, 145, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 213, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 145, 11, 159, 88, 11, 11, 11, 11, 159, 154, 11, 162, 374,
+        11, 11, 11, 375, 158, 376, 20, 377, 11, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 11, 11, 11, 11, 11, 5, 16, 16, 16, 16, 16, 16, 11, 11,
+        11, 11, 378, 11, 11, 11, 379, 56, 16, 16, 16, 16, 380, 14,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 84,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 158, 16, 16, 145,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 381,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        361, 16, 16, 361, 382, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 115, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 5, 124, 145, 383, 384, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 17, 17,
+        385, 17, 386, 11, 11, 11, 11, 11, 11, 11, 232, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 158, 11,
+        11, 23, 11, 11, 11, 387, 388, 389, 11, 390, 11, 11, 11, 145, 16,
+    },
+    {
+        16, 16, 16, 16, 391, 16, 16, 16, 16, 16, 16, 16, 16, 16, 11, 232, 16,
+        16, 16, 16, 16, 16, 11, 145, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 392, 11, 11, 11, 149, 393, 394, 395, 11, 11, 11,
+        396, 397, 11, 398, 399, 93, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 400, 11, 11, 219, 11, 11, 11,
+        392, 11, 11, 159, 11, 11, 11, 63, 11, 11, 11, 401, 402, 402, 402,
+    },
+    {
+        17, 17, 17, 403, 17, 17, 404, 240, 405, 406, 25, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 11,
+        159, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        407, 408, 409, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 11,
+        11, 124, 319, 88, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 11, 410, 16, 11, 11, 178, 24, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 411, 159,
+    },
+    {
+        28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 28, 412, 386, 16, 16, 28,
+        28, 28, 28, 413, 414, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 415, 33, 33, 33, 416, 16, 16, 16, 16, 415,
+        33, 33, 259, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        417, 33, 418, 419, 420, 421, 422, 423, 424, 425, 426, 425, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 427,
+        11, 159, 11, 11, 11, 154, 11, 11, 11, 124, 16, 16, 16, 73, 11,
+    },
+    {
+        361, 11, 11, 115, 145, 14, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 428,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 16, 16, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 145, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 162, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 14, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 78, 16,
+    },
+    {
+        11, 162, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+        16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 5, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16, 16,
+    },
+    {
+        429, 16, 8, 8, 8, 8, 8, 8, 16, 16, 16, 16, 16, 16, 16, 16, 17, 17, 17,
+        17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 16,
+    },
+    {
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+        11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 162,
+    },
+};
+static const uint8_t bidi_type_blocks[][1 << BIDI_TYPE_SHIFT] = {
+    {
+        BN, BN, BN, BN, BN, BN, BN, BN, BN, S, B, S, WS, B, BN, BN,
+    },
+    {
+        BN, BN, BN, BN, BN, BN, BN, BN, BN, BN, BN, BN, B, B, B, S,
+    },
+    {
+        WS, ON, ON, ET, ET, ET, ON, ON, ON, ON, ON, ES, CS, ES, CS, CS,
+    },
+    {
+        EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, CS, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, ON, ON, ON, ON, BN,
+    },
+    {
+        BN, BN, BN, BN, BN, B, BN, BN, BN, BN, BN, BN, BN, BN, BN, BN,
+    },
+    {
+        BN, BN, BN, BN, BN, BN, BN, BN, BN, BN, BN, BN, BN, BN, BN, BN,
+    },
+    {
+        CS, ON, ET, ET, ET, ET, ON, ON, ON, ON, L, ON, ON, BN, ON, ON,
+    },
+    {
+        ET, ET, EN, EN, ON, L, ON, ON, ON, EN, L, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, ON, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, ON, ON, L, L, L, L, L,
+    },
+    {
+        L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, L, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        NSM, NSM,
+    },
+    {
+        L, L, L, L, ON, ON, L, L, ON, ON, L, L, L, L, ON, L,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, L, ON, L, L, L, ON, L, ON, L, L,
+    },
+    {
+        L, L, ON, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, ON, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, ON, ON, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, ON, ON, ON, ON, ET,
+    },
+    {
+        ON, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        R, NSM,
+    },
+    {
+        R, NSM, NSM, R, NSM, NSM, R, NSM, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, R, R, R, R, R, R, R,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, R, R, ON, ON, ON, ON, R,
+    },
+    {
+        R, R, R, R, R, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        AN, AN, AN, AN, AN, AN, ON, ON, AL, ET, ET, AL, CS, AL, ON, ON,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, AL, AL, AL, AL,
+        AL,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, ET, AN, AN, AL, AL, AL,
+    },
+    {
+        NSM, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, NSM, NSM, NSM, NSM, NSM, NSM, NSM, AN, ON, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, AL, AL, NSM, NSM, ON, NSM, NSM, NSM, NSM, AL,
+        AL,
+    },
+    {
+        EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, ON, AL,
+    },
+    {
+        AL, NSM, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, ON, AL, AL,
+        AL,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        NSM,
+    },
+    {
+        NSM, AL, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, R, R, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, R, R, ON, ON, ON, ON, R, ON, ON, NSM, R, R,
+    },
+    {
+        R, R, R, R, R, R, NSM, NSM, NSM, NSM, R, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, R, NSM, NSM, NSM, R, NSM, NSM, NSM, NSM, NSM, ON,
+        ON,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, R, R, R, R, R, R, ON,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, NSM, NSM, NSM, ON, ON, R, ON,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, ON, ON, ON, ON, ON,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, ON,
+    },
+    {
+        AN, AN, ON, ON, ON, ON, ON, ON, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, NSM, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, AN, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, NSM, L, NSM, L, L, L,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, L, L, NSM, L, L,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, NSM, NSM, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, NSM, L, L, ON, L, L, L, L, L, L, L, L, ON, ON, L,
+    },
+    {
+        L, ON, ON, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, ON, L, L, L, L, L, L,
+    },
+    {
+        L, ON, L, ON, ON, ON, L, L, L, L, ON, ON, NSM, L, L, L,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, ON, ON, L, L, ON, ON, L, L, NSM, L, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, L, ON, ON, ON, ON, L, L, ON, L,
+    },
+    {
+        L, L, NSM, NSM, ON, ON, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, ET, ET, L, L, L, L, L, L, L, ET, L, L, NSM, ON,
+    },
+    {
+        ON, NSM, NSM, L, ON, L, L, L, L, L, L, ON, ON, ON, ON, L,
+    },
+    {
+        L, ON, L, L, ON, L, L, ON, L, L, ON, ON, NSM, ON, L, L,
+    },
+    {
+        L, NSM, NSM, ON, ON, ON, ON, NSM, NSM, ON, ON, NSM, NSM, NSM, ON, ON,
+    },
+    {
+        ON, NSM, ON, ON, ON, ON, ON, ON, ON, L, L, L, L, ON, L, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        NSM, NSM, L, L, L, NSM, L, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, NSM, NSM, L, ON, L, L, L, L, L, L, L, L, L, ON, L,
+    },
+    {
+        L, ON, L, L, ON, L, L, L, L, L, ON, ON, NSM, L, L, L,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, NSM, ON, NSM, NSM, L, ON, L, L, NSM, ON, ON,
+    },
+    {
+        L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, ET, ON, ON, ON, ON, ON, ON, ON, L, NSM, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        ON, NSM, L, L, ON, L, L, L, L, L, L, L, L, ON, ON, L,
+    },
+    {
+        L, ON, L, L, ON, L, L, L, L, L, ON, ON, NSM, L, L, NSM,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, ON, ON, L, L, ON, ON, L, L, NSM, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, NSM, NSM, L, ON, ON, ON, ON, L, L, ON, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, NSM, L, ON, L, L, L, L, L, L, ON, ON, ON, L, L,
+    },
+    {
+        L, ON, L, L, L, L, ON, ON, ON, L, L, ON, L, ON, L, L,
+    },
+    {
+        ON, ON, ON, L, L, ON, ON, ON, L, L, L, ON, ON, ON, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, ON, ON, ON, L, L,
+    },
+    {
+        NSM, L, L, ON, ON, ON, L, L, L, ON, L, L, L, NSM, ON, ON,
+    },
+    {
+        L, ON, ON, ON, ON, ON, ON, L, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, ON, ON, ON, ON, ON, ON, ET, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        NSM, L, L, L, NSM, L, L, L, L, L, L, L, L, ON, L, L,
+    },
+    {
+        L, ON, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, ON, NSM, L, NSM, NSM,
+    },
+    {
+        NSM, L, L, L, L, ON, NSM, NSM, NSM, ON, NSM, NSM, NSM, NSM, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, NSM, NSM, ON, L, L, L, ON, ON, L, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, L, ON, ON, ON, ON, ON, ON, ON, L,
+    },
+    {
+        L, NSM, L, L, L, L, L, L, L, L, L, L, L, ON, L, L,
+    },
+    {
+        L, L, L, L, ON, L, L, L, L, L, ON, ON, NSM, L, L, L,
+    },
+    {
+        L, L, L, L, L, ON, L, L, L, ON, L, L, NSM, NSM, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, L, L, ON, ON, ON, ON, ON, ON, L, L, ON,
+    },
+    {
+        ON, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        NSM, NSM, L, L, L, L, L, L, L, L, L, L, L, ON, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, NSM, NSM, L, L, L,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, ON, L, L, L, ON, L, L, L, NSM, L, L,
+    },
+    {
+        ON, ON, ON, ON, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        ON, NSM, L, L, ON, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, ON, ON, ON, L, L, L, L, L, L,
+    },
+    {
+        L, L, ON, L, L, L, L, L, L, L, L, L, ON, L, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, ON, ON, ON, NSM, ON, ON, ON, ON, L,
+    },
+    {
+        L, L, NSM, NSM, NSM, ON, NSM, ON, L, L, L, L, L, L, L, L,
+    },
+    {
+        ON, ON, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, NSM, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, ON, ON, ON, ET,
+    },
+    {
+        L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, ON, ON, ON, ON,
+    },
+    {
+        ON, L, L, ON, L, ON, L, L, L, L, L, ON, L, L, L, L,
+    },
+    {
+        L, L, L, L, ON, L, ON, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, NSM, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, ON, ON,
+    },
+    {
+        L, L, L, L, L, ON, L, ON, NSM, NSM, NSM, NSM, NSM, NSM, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, ON, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, NSM, NSM, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, NSM, L, NSM, L, NSM, ON, ON, ON, ON, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, ON, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, ON, ON, ON,
+    },
+    {
+        ON, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        NSM, L,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, L, NSM, NSM, L, L, L, L, L, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, NSM, NSM, NSM, NSM, NSM,
+        NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, L,
+        L,
+    },
+    {
+        L, L, L, L, L, L, NSM, L, L, L, L, L, L, ON, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, NSM, NSM, NSM,
+    },
+    {
+        NSM, L, NSM, NSM, NSM, NSM, NSM, NSM, L, NSM, NSM, L, L, NSM, NSM, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, NSM, NSM, L, L, L, L, NSM, NSM,
+    },
+    {
+        NSM, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, NSM, L, L, NSM, NSM, L, L, L, L, L, L, NSM, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, NSM, L, L,
+    },
+    {
+        L, L, L, L, L, L, ON, L, ON, ON, ON, ON, ON, L, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, ON, L, L, L, L, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, ON, L, ON, L, L, L, L, ON, ON,
+    },
+    {
+        L, ON, L, L, L, L, ON, ON, L, L, L, L, L, L, L, ON,
+    },
+    {
+        L, ON, L, L, L, L, ON, ON, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, ON, ON, NSM, NSM, NSM,
+    },
+    {
+        L, L, L, L, L, L, ON, ON, L, L, L, L, L, L, ON, ON,
+    },
+    {
+        WS, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, NSM, NSM, NSM, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, L,
+    },
+    {
+        L, L, NSM, NSM, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, NSM, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, ON, L, L,
+    },
+    {
+        L, ON, NSM, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, NSM, NSM, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L,
+    },
+    {
+        L, L, L, L, L, L, NSM, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, L, L, L, L, L, L, L, ET, L, NSM, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, NSM, NSM, NSM, BN, NSM,
+    },
+    {
+        L, L, L, L, L, NSM, NSM, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, NSM, L, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, L, L, ON,
+    },
+    {
+        NSM, NSM, NSM, L, L, L, L, NSM, NSM, L, L, L, ON, ON, ON, ON,
+    },
+    {
+        L, L, NSM, L, L, L, L, L, L, NSM, NSM, NSM, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, L, ON, ON,
+    },
+    {
+        L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, NSM, NSM, L, L, NSM, ON, ON, L, L,
+    },
+    {
+        L, L, L, L, L, L, NSM, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON,
+    },
+    {
+        NSM, L, NSM, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, L,
+    },
+    {
+        L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, ON, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        NSM, ON,
+    },
+    {
+        NSM, NSM, NSM, NSM, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, NSM, L, NSM, NSM, NSM, NSM, NSM, L, NSM, L, L, L,
+    },
+    {
+        L, L, NSM, L, L, L, L, L, L, L, L, L, L, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, L, L, L, L, L, L, L, L, L, L, L, ON,
+    },
+    {
+        NSM, NSM, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, NSM, NSM, NSM, NSM, L, L, NSM, NSM, L, NSM, NSM, NSM, L, L,
+    },
+    {
+        L, L, L, L, L, L, NSM, L, NSM, NSM, L, L, L, NSM, L, NSM,
+    },
+    {
+        NSM, NSM, L, L, ON, ON, ON, ON, ON, ON, ON, ON, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, L, L, NSM, NSM, ON, ON, ON, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, ON, ON, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, ON, ON, L, L, L,
+    },
+    {
+        NSM, NSM, NSM, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        NSM, NSM,
+    },
+    {
+        NSM, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, L, L, NSM, L, L,
+    },
+    {
+        L, L, L, L, NSM, L, L, L, NSM, NSM, L, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, ON, L, ON, L, ON, L, ON, L,
+    },
+    {
+        L, L, L, L, L, ON, L, L, L, L, L, L, L, ON, L, ON,
+    },
+    {
+        ON, ON, L, L, L, ON, L, L, L, L, L, L, L, ON, ON, ON,
+    },
+    {
+        L, L, L, L, ON, ON, L, L, L, L, L, L, ON, ON, ON, ON,
+    },
+    {
+        WS, WS, WS, WS, WS, WS, WS, WS, WS, WS, WS, BN, BN, BN, L, R,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, WS, B, LRE, RLE, PDF, LRO, RLO, CS,
+    },
+    {
+        ET, ET, ET, ET, ET, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, CS, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, WS,
+    },
+    {
+        BN, BN, BN, BN, BN, ON, LRI, RLI, FSI, PDI, BN, BN, BN, BN, BN, BN,
+    },
+    {
+        EN, L, ON, ON, EN, EN, EN, EN, EN, EN, ES, ES, ON, ON, ON, L,
+    },
+    {
+        EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, ES, ES, ON, ON, ON, ON,
+    },
+    {
+        ET, ET, ET, ET, ET, ET, ET, ET, ET, ET, ET, ET, ET, ET, ET, ET,
+    },
+    {
+        ET, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, L, ON, ON, ON, ON, L, ON, ON, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, ON, L, ON, ON, ON, L, L, L, L, L, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, L, ON, L, ON, L, ON, L, L, L, L, ET, L,
+    },
+    {
+        ON, ON, ON, ON, ON, L, L, L, L, L, ON, ON, ON, ON, L, L,
+    },
+    {
+        ON, ON, ES, ET, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, EN, EN, EN, EN, EN, EN, EN, EN,
+    },
+    {
+        EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, L, L, L, L,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, L, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, ON, ON, ON, ON, ON, ON, L, L, L, L, NSM,
+    },
+    {
+        NSM, NSM, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, L,
+    },
+    {
+        L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, NSM,
+    },
+    {
+        L, L, L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, ON, L, L, L, L, L, L, L, ON,
+    },
+    {
+        WS, ON, ON, ON, ON, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, L, L, L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, L, L,
+    },
+    {
+        ON, L, L, L, L, L, ON, ON, L, L, L, L, L, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, ON, ON, NSM, NSM, ON, ON, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, ON, L, L, L, L,
+    },
+    {
+        ON, ON, ON, ON, ON, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, ON, ON, ON, L,
+    },
+    {
+        L, L, L, L, L, L, L, ON, ON, ON, ON, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, L, L, NSM,
+    },
+    {
+        NSM, NSM, NSM, ON, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, L, NSM, NSM,
+    },
+    {
+        NSM, NSM, L, L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, ON, L, ON, L, L, L, L, L, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, NSM, L, L, L, NSM, L, L, L, L, NSM, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, NSM, NSM, L, ON, ON, ON, ON, NSM, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, ET, ET, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, NSM, NSM, ON, ON, ON, ON, ON, ON, ON, ON, L, L,
+    },
+    {
+        NSM, NSM, L, L, L, L, L, L, L, L, L, L, L, L, L, NSM,
+    },
+    {
+        L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, L,
+    },
+    {
+        L, L, L, NSM, L, L, NSM, NSM, NSM, NSM, L, L, NSM, NSM, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, L, ON, L,
+    },
+    {
+        L, L, L, L, L, NSM, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, L,
+    },
+    {
+        L, NSM, NSM, L, L, NSM, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, NSM, L, L, L, L, L, L, L, L, NSM, L, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, NSM, L, L, L,
+    },
+    {
+        NSM, L, NSM, NSM, NSM, L, L, NSM, NSM, L, L, L, L, L, NSM, NSM,
+    },
+    {
+        L, NSM, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, NSM, NSM, L, L,
+    },
+    {
+        L, L, L, L, L, L, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, L, L, L, L, L, L, ON, ON, L, L, L, L, L, L, ON,
+    },
+    {
+        ON, L, L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, NSM, L, L, NSM, L, L, L, L, NSM, ON, ON,
+    },
+    {
+        ON, ON, ON, L, L, L, L, L, ON, ON, ON, ON, ON, R, NSM, R,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, ES, R, R, R, R, R, R,
+    },
+    {
+        R, R, R, R, R, R, R, ON, R, R, R, R, R, ON, R, ON,
+    },
+    {
+        R, R, ON, R, R, ON, R, R, R, R, R, R, R, R, R, R,
+    },
+    {
+        AL, AL, AL, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, ON, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, ON, ON,
+    },
+    {
+        ON, ON, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, ON, ON, ON,
+    },
+    {
+        CS, ON, CS, ON, ON, CS, ON, ON, ON, ON, ON, ON, ON, ON, ON, ET,
+    },
+    {
+        ON, ON, ES, ES, ON, ON, ON, ON, ON, ET, ET, ON, ON, ON, ON, ON,
+    },
+    {
+        AL, AL, AL, AL, AL, ON, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, ON, ON, BN,
+    },
+    {
+        ON, ON, ON, ET, ET, ET, ON, ON, ON, ON, ON, ES, CS, ES, CS, CS,
+    },
+    {
+        ON, ON, L, L, L, L, L, L, ON, ON, L, L, L, L, L, L,
+    },
+    {
+        ON, ON, L, L, L, L, L, L, ON, ON, L, L, L, ON, ON, ON,
+    },
+    {
+        ET, ET, ON, ON, ON, ET, ET, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, ON, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, ON, L, L, ON, L,
+    },
+    {
+        L, ON, L, ON, ON, ON, ON, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, ON, ON, ON, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, L, L, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, NSM, ON, ON,
+    },
+    {
+        NSM, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN,
+    },
+    {
+        EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, ON, ON, ON, ON, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, L,
+    },
+    {
+        L, L, L, ON, L, L, ON, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, ON, L, L, L, L, L, L, L, ON, L, L, ON, ON, ON,
+    },
+    {
+        L, ON, L, L, L, L, L, L, L, L, L, ON, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, R, R, R, ON, ON, R, ON, R, R, R, R, R, R,
+    },
+    {
+        R, R, R, R, R, R, ON, R, R, ON, ON, ON, R, ON, ON, R,
+    },
+    {
+        R, R, R, R, R, R, ON, R, R, R, R, R, R, R, R, R,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, R, R, R, R, R, R, R, R, R,
+    },
+    {
+        R, R, R, ON, R, R, ON, ON, ON, ON, ON, R, R, R, R, R,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, R, R, R, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, R, ON, ON, ON, ON, ON, R,
+    },
+    {
+        R, R, R, R, R, R, R, R, ON, ON, ON, ON, R, R, R, R,
+    },
+    {
+        ON, ON, R, R, R, R, R, R, R, R, R, R, R, R, R, R,
+    },
+    {
+        R, NSM, NSM, NSM, ON, NSM, NSM, ON, ON, ON, ON, ON, NSM, NSM, NSM, NSM,
+    },
+    {
+        R, R, R, R, ON, R, R, R, ON, R, R, R, R, R, R, R,
+    },
+    {
+        R, R, R, R, R, R, ON, ON, NSM, NSM, NSM, ON, ON, ON, ON, NSM,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, R, R, NSM, NSM, ON, ON, ON, ON, R, R, R, R, R,
+    },
+    {
+        R, R, R, R, R, R, R, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, R, R, R, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, R, R, R, ON, ON, R, R, R, R, R, R, R, R,
+    },
+    {
+        R, R, R, ON, ON, ON, ON, ON, R, R, R, R, R, R, R, R,
+    },
+    {
+        R, R, ON, ON, ON, ON, ON, ON, ON, R, R, R, R, ON, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, ON, R, R, R, R, R, R, R,
+    },
+    {
+        R, R, R, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, ON, ON, ON, ON, ON, ON, ON, R, R, R, R, R, R,
+    },
+    {
+        AL, AL, AL, AL, NSM, NSM, NSM, NSM, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN,
+    },
+    {
+        AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, AN, ON,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, R, ON, NSM, NSM, R, ON, ON,
+    },
+    {
+        R, R, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, R, R, R, R, R, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        NSM, AL, AL, AL, AL, AL, AL, AL, AL, AL, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        R, R, NSM, NSM, NSM, NSM, R, R, R, R, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, NSM, L, L, L, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, L, L, L, L, L, ON, ON,
+    },
+    {
+        NSM, L, L, NSM, NSM, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, NSM,
+    },
+    {
+        L, L, L, NSM, NSM, NSM, NSM, L, L, NSM, NSM, L, L, L, L, L,
+    },
+    {
+        L, L, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, L, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM, L, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, ON, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, NSM, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, L, L, NSM,
+    },
+    {
+        NSM, NSM, L, L, NSM, L, NSM, NSM, L, L, L, L, L, L, NSM, ON,
+    },
+    {
+        L, L, L, L, L, L, L, ON, L, ON, L, L, L, L, ON, L,
+    },
+    {
+        L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, ON, ON, ON, ON,
+    },
+    {
+        NSM, NSM, L, L, ON, L, L, L, L, L, L, L, L, ON, ON, L,
+    },
+    {
+        L, ON, L, L, ON, L, L, L, L, L, ON, NSM, NSM, L, L, L,
+    },
+    {
+        NSM, L, L, L, L, ON, ON, L, L, ON, ON, L, L, L, ON, ON,
+    },
+    {
+        L, ON, ON, ON, ON, ON, ON, L, ON, ON, ON, ON, ON, L, L, L,
+    },
+    {
+        L, L, L, L, ON, ON, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, ON, ON,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, NSM, NSM, NSM, L, NSM, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, ON, L, NSM, L,
+    },
+    {
+        L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, L, NSM, L, L, L, L, NSM,
+    },
+    {
+        NSM, L, NSM, NSM, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, NSM, NSM, NSM, NSM, ON, ON, L, L, L, L, NSM, NSM, L, NSM,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, NSM, NSM, ON, ON,
+    },
+    {
+        L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, NSM, L, NSM,
+    },
+    {
+        NSM, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, NSM, L, NSM, L, L,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, L, NSM, L, L, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, NSM, NSM, NSM, NSM, L, NSM, NSM, NSM, NSM, NSM, ON, ON, ON, ON,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, NSM, NSM, L, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, L,
+    },
+    {
+        L, L, L, L, L, L, L, ON, ON, L, ON, ON, L, L, L, L,
+    },
+    {
+        L, L, L, L, ON, L, L, ON, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, ON, L, L, ON, ON, NSM, NSM, L, NSM, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, ON, ON, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, NSM, NSM, NSM, NSM, ON, ON, NSM, NSM, L, L, L, L,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, NSM, NSM, L, L, NSM, NSM, L, L, L, L, L,
+    },
+    {
+        L, L, L, NSM, NSM, NSM, NSM, NSM, NSM, L, L, NSM, NSM, NSM, NSM, L,
+    },
+    {
+        L, L, L, L, L, L, L, NSM, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, NSM, NSM, L, L, NSM, NSM, NSM, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, NSM, NSM, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, NSM, NSM, NSM, NSM, NSM, NSM, L,
+        L,
+    },
+    {
+        ON, ON, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, L, NSM, NSM, NSM, NSM, NSM,
+        NSM,
+    },
+    {
+        NSM, L, NSM, NSM, L, NSM, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, ON, L, L, ON, L, L, L, L, L,
+    },
+    {
+        L, NSM, NSM, NSM, NSM, NSM, NSM, ON, ON, ON, NSM, ON, NSM, NSM, ON,
+        NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, L, NSM, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, ON, L, L, ON, L, L, L, L, L, L,
+    },
+    {
+        NSM, NSM, ON, L, L, NSM, L, NSM, L, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, NSM, NSM, L, L, L, L, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON, ET, ET, ET,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, L,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, L, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, ON, ON, ON, ON, ON, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, ON, ON, ON, ON, NSM,
+    },
+    {
+        L, L, L, L, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, NSM,
+    },
+    {
+        L, L, ON, L, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, ON, L, L, L, L, L, L, L, ON, L, L, ON,
+    },
+    {
+        ON, ON, ON, ON, L, L, L, L, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, ON, L, NSM, NSM, L,
+    },
+    {
+        BN, BN, BN, BN, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM,
+        ON, ON,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, L, L, NSM, NSM, NSM, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, BN, BN, BN, BN, BN, BN, BN, BN, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, L, L, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, NSM, NSM, NSM, NSM, L, L,
+    },
+    {
+        ON, ON, NSM, NSM, NSM, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        L, L, L, L, L, ON, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        ON, ON, L, ON, ON, L, L, ON, ON, L, L, L, L, ON, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, L, ON, L, L, L,
+    },
+    {
+        L, L, L, L, ON, L, L, L, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, ON, L, L, L, L, ON, ON, L, L, L,
+    },
+    {
+        L, L, L, L, L, ON, L, L, L, L, L, L, L, ON, L, L,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, ON, L, L, L, L, ON,
+    },
+    {
+        L, L, L, L, L, ON, L, ON, ON, ON, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, L, L, L, ON, ON, L, L, L, L, L, L, L, L,
+    },
+    {
+        L, L, L, ON, L, L, L, L, L, L, L, L, ON, ON, EN, EN,
+    },
+    {
+        EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L, L, L, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, L, L,
+        L,
+    },
+    {
+        L, L, L, L, NSM, L, L, L, L, L, L, L, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, NSM, NSM, NSM, NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, NSM, NSM, NSM, NSM, NSM, NSM,
+        NSM, NSM,
+    },
+    {
+        NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, NSM, ON, ON, NSM, NSM, NSM,
+        NSM, NSM,
+    },
+    {
+        NSM, NSM, ON, NSM, NSM, ON, NSM, NSM, NSM, NSM, NSM, ON, ON, ON, ON,
+        ON,
+    },
+    {
+        L, L, L, L, L, L, L, L, L, L, L, L, L, L, NSM, ON,
+    },
+    {
+        L, L, L, L, L, L, L, ON, L, L, L, L, ON, L, L, ON,
+    },
+    {
+        R, R, R, R, R, ON, ON, R, R, R, R, R, R, R, R, R,
+    },
+    {
+        R, R, R, R, NSM, NSM, NSM, NSM, NSM, NSM, NSM, R, ON, ON, ON, ON,
+    },
+    {
+        R, R, R, R, R, R, R, R, R, R, ON, ON, ON, ON, R, R,
+    },
+    {
+        ON, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, AL, AL, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        AL, AL, AL, AL, ON, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        ON, AL, AL, ON, AL, ON, ON, AL, ON, AL, AL, AL, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, ON, AL, AL, AL, AL, ON, AL, ON, AL, ON, ON, ON, ON,
+    },
+    {
+        ON, ON, AL, ON, ON, ON, ON, AL, ON, AL, ON, AL, ON, AL, AL, AL,
+    },
+    {
+        ON, AL, AL, ON, AL, ON, ON, AL, ON, AL, ON, AL, ON, AL, ON, AL,
+    },
+    {
+        ON, AL, AL, ON, AL, ON, ON, AL, AL, AL, AL, ON, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, ON, AL, AL, AL, AL, ON, AL, AL, AL, AL, ON, AL, ON,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, ON, AL, AL, AL, AL, AL,
+    },
+    {
+        AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, AL, ON, ON, ON, ON,
+    },
+    {
+        ON, AL, AL, AL, ON, AL, AL, AL, AL, AL, ON, AL, AL, AL, AL, AL,
+    },
+    {
+        EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, ON, ON, ON, ON, ON,
+    },
+    {
+        EN, EN, EN, EN, EN, EN, EN, EN, EN, EN, ON, ON, ON, ON, ON, ON,
+    },
+    {
+        ON, BN, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON, ON,
+    },
+};
+static inline uint8_t bidi_type_lookup(unsigned c)
+{
+    unsigned mid = bidi_type_top[
+        c >> (BIDI_TYPE_SHIFT + BIDI_TYPE_MSHIFT)];
+    unsigned block = bidi_type_mid[mid][
+        (c >> BIDI_TYPE_SHIFT) & ((1 << BIDI_TYPE_MSHIFT) - 1)];
+    return bidi_type_blocks[block][
+        c & ((1 << BIDI_TYPE_SHIFT) - 1)];
+}
+
+/* bidi_mirror: 57 blocks of 16, 8 index blocks of 128, 3392 bytes */
+#define BIDI_MIRROR_SHIFT 4
+#define BIDI_MIRROR_MSHIFT 7
+static const uint8_t bidi_mirror_top[544] = {
+    0, 1, 2, 3, 4, 5, 6, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 7, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+};
+static const uint8_t bidi_mirror_mid[][1 << BIDI_MIRROR_MSHIFT] = {
+    {
+        0, 0, 1, 2, 0, 3, 0, 3, 0, 0, 4, 5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 8, 9, 0, 0, 10, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21,
+        22, 23, 24, 25, 26, 27, 0, 8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 28, 29, 0, 0, 0, 0, 30, 31, 32, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        33, 34, 35, 36, 37, 38, 1, 39, 0, 0, 40, 41, 0, 0, 42, 43, 44, 44, 45,
+        44, 44, 46, 47, 48, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 49, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 50, 14, 51, 0, 0, 52, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        28, 53, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 54, 42, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 0, 3, 0, 55,
+        56, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+};
+static const int16_t bidi_mirror_blocks[][1 << BIDI_MIRROR_SHIFT] = {
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, -2, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, -2, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -16, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 1, -1, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 3, 3, 3, -3, -3, -3, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 2016, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2527,
+    },
+    {
+        1923, 1914, 1918, 0, 2250, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 0, 0,
+    },
+    {
+        0, 0, 0, 138, 0, 7, 0, 0, 0, 0, 0, 0, -7, 0, 0, 0,
+    },
+    {
+        0, 0, 1, -1, 1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 1, -1,
+    },
+    {
+        1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1,
+    },
+    {
+        1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 1,
+    },
+    {
+        -1, 1, -1, 0, 0, 0, 0, 0, 1824, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 1, -1, 0, 0, 2104, 0, 2108, 2106, 0, 2106, 0, 0, 0, 0,
+    },
+    {
+        1, -1, 1, -1, 1, -1, 1, -1, 1316, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 1, -1, -138, 0, 0,
+    },
+    {
+        1, -1, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1,
+    },
+    {
+        1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 0, 0,
+    },
+    {
+        1, -1, 8, 8, 8, 0, 7, 7, 0, 0, -8, -8, -8, -7, -7, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 1, -1, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1,
+    },
+    {
+        1, -1, 1, -1, 1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 1, -1, 1, -1, 0, 1, -1, 0, 2, 0, -2, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 1, -1, 0, 0, 0, 0, 0, -1316, 1, -1, 0,
+    },
+    {
+        0, 0, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1,
+    },
+    {
+        0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 3, 1, -1,
+    },
+    {
+        -3, 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, -1914, 0, 0, 0, 0,
+    },
+    {
+        -1918, 0, 0, -1923, 1, -1, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, -1824, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        1, -1, 0, 0, 1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    },
+    {
+        -1, 1, -1, 0, 1, -1, 0, 0, 1, -1, 1, -1, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, -2016, 0, 0, 1, -1, 0, 0, 1, -1, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 1, -1, 0,
+    },
+    {
+        0, 0, 0, 0, 1, -1, 0, 0, 0, 0, 0, 0, 1, -1, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1,
+    },
+    {
+        -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 1,
+    },
+    {
+        -1, 1, -1, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1, 0, 1,
+    },
+    {
+        -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0, 0, 0, 0, -2104, 0,
+    },
+    {
+        0, 0, 0, -2106, -2108, -2106, 0, 0, 0, 0, 0, 0, 1, -1, -2250, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 1, -1, 1, -1, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -2527, 0,
+    },
+    {
+        0, 0, 1, -1, 1, -1, 0, 0, 0, 1, -1, 0, 1, -1, 0, 0,
+    },
+    {
+        1, -1, 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0,
+    },
+    {
+        1, -1, 0, 0, 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 1, -1, 1, -1, 1, -1, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, -2, 0, 1,
+    },
+    {
+        -1, 0, 1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+};
+static inline int16_t bidi_mirror_lookup(unsigned c)
+{
+    unsigned mid = bidi_mirror_top[
+        c >> (BIDI_MIRROR_SHIFT + BIDI_MIRROR_MSHIFT)];
+    unsigned block = bidi_mirror_mid[mid][
+        (c >> BIDI_MIRROR_SHIFT) & ((1 << BIDI_MIRROR_MSHIFT) - 1)];
+    return bidi_mirror_blocks[block][
+        c & ((1 << BIDI_MIRROR_SHIFT) - 1)];
+}
+
+/* bidi_bracket: 18 blocks of 64, 4 index blocks of 128, 1800 bytes */
+#define BIDI_BRACKET_SHIFT 6
+#define BIDI_BRACKET_MSHIFT 7
+static const uint8_t bidi_bracket_top[136] = {
+    0, 1, 2, 2, 2, 2, 2, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+};
+static const uint8_t bidi_bracket_mid[][1 << BIDI_BRACKET_MSHIFT] = {
+    {
+        0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 4, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2,
+    },
+    {
+        2, 5, 6, 2, 2, 2, 2, 2, 2, 2, 2, 2, 7, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 8, 2, 9, 2, 2, 2, 2, 2, 2, 10, 11, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 12, 13, 2, 2, 2, 2, 2, 2, 14, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    },
+    {
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2,
+    },
+    {
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+        2, 15, 2, 2, 16, 17, 2, 2,
+    },
+};
+static const uint8_t bidi_bracket_blocks[][1 << BIDI_BRACKET_SHIFT] = {
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 3, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 0, 6, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7, 8, 9, 10, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 11, 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 13, 14, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 15, 16, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 17, 18, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 19, 20, 21, 22, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 23, 24, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 26, 27, 28, 29, 30,
+        31, 32, 33, 34, 35, 36, 37, 38, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 39, 40, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 41, 42, 43, 44, 45, 46,
+        47, 48, 49, 50, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65,
+        66, 67, 68, 69, 70, 71, 72, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        73, 74, 75, 76, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 77, 78, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 79, 80, 81, 82, 83, 84, 85, 86, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 87, 88,
+        89, 90, 91, 92, 93, 94, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 95, 96, 97, 98, 99, 100, 101, 102, 103, 104, 0,
+        0, 105, 106, 107, 108, 109, 110, 111, 112, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 113, 114, 115, 116, 117, 118, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 119, 120, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 121, 0, 122, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 123, 0, 124, 0, 125, 126, 0, 127, 128, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+};
+static inline uint8_t bidi_bracket_lookup(unsigned c)
+{
+    unsigned mid = bidi_bracket_top[
+        c >> (BIDI_BRACKET_SHIFT + BIDI_BRACKET_MSHIFT)];
+    unsigned block = bidi_bracket_mid[mid][
+        (c >> BIDI_BRACKET_SHIFT) & ((1 << BIDI_BRACKET_MSHIFT) - 1)];
+    return bidi_bracket_blocks[block][
+        c & ((1 << BIDI_BRACKET_SHIFT) - 1)];
+}
+
@@ -0,0 +1,1635 @@
+/*
+ * Unicode property lookup tables.
+ *
+ * Generated by mkunitab.pl from the tables in utils/wcwidth.c.
+ * You should edit that file rather than editing this one.
+ */
+
+/* wcwidth_class: 284 blocks of 16, 73 index blocks of 32, 11392 bytes */
+#define WCWIDTH_CLASS_SHIFT 4
+#define WCWIDTH_CLASS_MSHIFT 5
+static const uint8_t wcwidth_class_top[2176] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 10, 15, 16, 17, 18, 10,
+    19, 20, 21, 22, 23, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 25, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 26, 27, 28, 29, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 30, 10, 10, 10, 10, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 32, 33, 10, 34, 35, 36, 10, 10, 10, 37, 38,
+    39, 40, 41, 42, 43, 44, 45, 46, 47, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    48, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 49, 10, 50, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 51, 24, 24, 52, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 53, 54, 55, 10, 10, 10, 10, 56, 10, 10, 10, 10, 10, 10, 10,
+    10, 57, 58, 59, 10, 10, 10, 60, 10, 10, 61, 62, 10, 10, 63, 10, 10, 10, 64,
+    65, 66, 67, 68, 69, 10, 10, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 70, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24,
+    24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 24, 70, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 71, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10,
+    10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 72, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31, 31,
+    31, 31, 31, 31, 31, 31, 31, 72,
+};
+static const uint16_t wcwidth_class_mid[][1 << WCWIDTH_CLASS_MSHIFT] = {
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 9,
+        0, 0, 0, 0, 0, 13, 14, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 7, 7, 0, 0, 0, 0, 0, 15, 16, 0, 0, 17, 17, 17, 17, 17,
+        17, 17, 0, 0, 18, 19, 18, 19, 0, 0, 0,
+    },
+    {
+        7, 20, 20, 20, 20, 7, 0, 0, 21, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 22, 23, 24, 25, 0, 0, 0,
+    },
+    {
+        26, 27, 0, 0, 28, 23, 0, 29, 0, 0, 0, 0, 0, 30, 31, 0, 32, 33, 0, 23,
+        34, 0, 0, 0, 0, 0, 35, 29, 0, 0, 28, 36,
+    },
+    {
+        0, 37, 38, 0, 0, 39, 0, 0, 0, 40, 0, 0, 41, 23, 23, 23, 42, 0, 0, 43,
+        44, 45, 46, 0, 33, 0, 0, 47, 48, 0, 46, 49,
+    },
+    {
+        50, 0, 0, 47, 51, 33, 0, 52, 50, 0, 0, 47, 53, 0, 46, 41, 33, 0, 0, 54,
+        48, 55, 46, 0, 56, 0, 0, 0, 57, 0, 0, 0,
+    },
+    {
+        58, 0, 0, 59, 60, 55, 46, 0, 33, 0, 0, 54, 61, 0, 46, 0, 62, 0, 0, 63,
+        48, 0, 46, 0, 33, 0, 0, 0, 64, 65, 0, 0,
+    },
+    {
+        0, 0, 0, 66, 67, 0, 0, 0, 0, 0, 0, 68, 69, 0, 0, 0, 0, 70, 0, 71, 0, 0,
+        0, 72, 73, 74, 23, 75, 76, 0, 0, 0,
+    },
+    {
+        0, 0, 77, 78, 0, 79, 29, 80, 81, 82, 0, 0, 0, 0, 0, 0, 83, 83, 83, 83,
+        83, 83, 23, 23, 23, 23, 23, 23, 23, 23, 23, 23,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 77, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 84, 0, 46, 0, 46, 0,
+        46, 0, 0, 0, 85, 86, 36, 0, 0,
+    },
+    {
+        28, 0, 0, 0, 0, 0, 0, 0, 55, 0, 87, 0, 0, 0, 0, 0, 0, 0, 88, 89, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 90, 0, 0, 0, 91, 92, 93, 0, 0, 0, 23, 94, 0, 0, 0, 95, 0, 0, 96, 56,
+        0, 28, 95, 62, 0, 97, 0, 0, 0, 98, 62,
+    },
+    {
+        0, 0, 99, 100, 0, 0, 0, 0, 0, 0, 0, 0, 0, 101, 102, 103, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 23, 23, 23, 23,
+    },
+    {
+        28, 104, 105, 106, 0, 0, 107, 108, 109, 0, 110, 0, 0, 23, 23, 29, 111,
+        112, 113, 0, 0, 114, 115, 116, 117, 116, 0, 118, 0, 119, 120, 0,
+    },
+    {
+        121, 122, 123, 124, 125, 126, 127, 0, 128, 129, 130, 131, 0, 0, 0, 0,
+        0, 132, 133, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 134, 135,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 20, 20, 20, 20, 20, 20, 20, 20, 136, 20, 20, 20, 20,
+        20, 115, 20, 20, 137, 20, 138, 19, 139, 140, 141, 142, 143,
+    },
+    {
+        144, 145, 0, 0, 146, 147, 148, 149, 0, 150, 151, 152, 153, 154, 155,
+        156, 157, 0, 158, 159, 160, 161, 0, 162, 0, 163, 0, 164, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 165, 0, 0, 0, 166,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 32, 62, 0, 0, 0, 0, 0, 0, 0,
+        32, 0, 0, 0, 0, 0, 0, 23, 23,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 83, 167, 83, 83, 83, 83, 83, 147, 83, 83, 83,
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 168, 0, 169,
+    },
+    {
+        83, 83, 170, 171, 172, 83, 83, 83, 83, 173, 83, 83, 83, 83, 83, 83,
+        174, 83, 83, 172, 83, 83, 83, 83, 171, 83, 83, 83, 83, 83, 147, 83,
+    },
+    {
+        83, 171, 83, 83, 175, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 0, 0, 0, 0,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 176, 83, 83, 83, 177, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 32, 178, 0, 179, 0, 0, 0, 0, 0, 62, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        180, 0, 181, 0, 0, 0, 0, 0, 0, 0, 0, 0, 182, 0, 23, 183, 0, 0, 184, 0,
+        185, 62, 83, 176, 42, 0, 0, 186, 0, 0, 187, 0,
+    },
+    {
+        0, 0, 188, 189, 190, 0, 0, 47, 0, 0, 0, 191, 33, 0, 192, 76, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 193, 0,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+        83, 83, 83, 83, 83, 83, 83, 83, 147, 0, 0, 0, 0, 0,
+    },
+    {
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+    },
+    {
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 83, 83,
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 0, 49,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        17, 194, 23, 83, 83, 195, 196, 0, 0, 0, 0, 0, 0, 0, 0, 32, 172, 83, 83,
+        83, 83, 83, 197, 0, 0, 0, 0, 0, 0, 0, 177, 198,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 82,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 29, 0, 0, 0, 0, 0, 0, 0, 0,
+        199, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        200, 0, 0, 201, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 55, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 202, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 63, 0, 0, 0, 0, 0, 0, 0, 0, 0, 35, 29, 0,
+        0, 203, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        33, 0, 0, 204, 205, 0, 0, 206, 62, 0, 0, 207, 208, 0, 0, 0, 42, 0, 209,
+        210, 0, 0, 0, 211, 62, 0, 0, 212, 213, 0, 0, 0,
+    },
+    {
+        0, 0, 32, 214, 0, 0, 0, 0, 0, 0, 0, 0, 0, 32, 215, 0, 62, 0, 0, 63, 29,
+        0, 216, 210, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 204, 65, 49, 0, 0, 0, 0, 0, 217, 218, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 219, 29, 192, 0, 0,
+    },
+    {
+        0, 0, 0, 220, 29, 0, 0, 0, 0, 0, 221, 222, 0, 0, 0, 0, 0, 77, 223, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 32, 224, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 225, 211,
+        0, 0, 0, 0, 0, 0, 0, 0, 226, 29, 0,
+    },
+    {
+        227, 0, 0, 228, 229, 230, 0, 0, 41, 231, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 232, 0, 0, 0, 0, 0, 233, 234, 235, 0, 0, 0, 0, 0, 0, 0, 236,
+        222, 0, 0, 0, 0, 237, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 238, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 239, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 210, 0, 0, 0, 205, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 32, 0, 0,
+        0, 32, 42, 0, 0, 0, 0, 240, 241,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 242,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 168, 0, 0, 243, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 244,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+        245, 0, 0, 245, 246, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 169, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 247, 95, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 23, 23, 248, 23, 205,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 249,
+        250, 251, 0, 252, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 84, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        23, 23, 23, 253, 23, 23, 75, 187, 254, 28, 22, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        255, 256, 257, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 205, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 49, 0, 0, 0, 99, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 205, 0, 0, 0, 0, 0, 0, 258, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        259, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 149, 0, 0, 0, 260, 20, 261, 20,
+        20, 20, 116, 20, 262, 263, 264, 0, 0, 0, 0, 0,
+    },
+    {
+        245, 83, 83, 169, 243, 241, 168, 0, 0, 0, 0, 0, 0, 0, 0, 0, 83, 83,
+        265, 266, 83, 83, 83, 267, 83, 147, 83, 83, 268, 147, 83, 269,
+    },
+    {
+        83, 83, 83, 171, 270, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 271, 83,
+        83, 83, 272, 273, 83, 242, 274, 0, 275, 259, 0, 0, 0, 0, 276,
+    },
+    {
+        83, 83, 83, 83, 83, 0, 0, 0, 83, 83, 83, 83, 277, 278, 165, 279, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 169, 197,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 280, 83, 83, 281, 266,
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 282, 177, 83, 176, 283, 168, 194, 242, 177, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83,
+        83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 83, 272,
+    },
+    {
+        33, 0, 23, 23, 23, 23, 23, 23, 0, 0, 0, 0, 0, 0, 0, 0, 17, 17, 17, 17,
+        17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 17, 0,
+    },
+    {
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20,
+        20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 20, 261,
+    },
+};
+static const uint8_t wcwidth_class_blocks[][1 << WCWIDTH_CLASS_SHIFT] = {
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0,
+        0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0, WCW_AMBIGUOUS, 0,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0,
+        WCW_AMBIGUOUS, 0,
+    },
+    {
+        0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS,
+        0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, WCW_AMBIGUOUS,
+        0, 0, 0, 0,
+    },
+    {
+        0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0,
+        WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0, 0,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0,
+        WCW_AMBIGUOUS, 0, 0,
+    },
+    {
+        0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0,
+    },
+    {
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0,
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS|WCW_COMBINING, WCW_AMBIGUOUS|WCW_COMBINING,
+        WCW_AMBIGUOUS|WCW_COMBINING, WCW_AMBIGUOUS|WCW_COMBINING,
+        WCW_AMBIGUOUS|WCW_COMBINING, WCW_AMBIGUOUS|WCW_COMBINING,
+        WCW_AMBIGUOUS|WCW_COMBINING, WCW_AMBIGUOUS|WCW_COMBINING,
+        WCW_AMBIGUOUS|WCW_COMBINING, WCW_AMBIGUOUS|WCW_COMBINING,
+        WCW_AMBIGUOUS|WCW_COMBINING, WCW_AMBIGUOUS|WCW_COMBINING,
+        WCW_AMBIGUOUS|WCW_COMBINING, WCW_AMBIGUOUS|WCW_COMBINING,
+        WCW_AMBIGUOUS|WCW_COMBINING, WCW_AMBIGUOUS|WCW_COMBINING,
+    },
+    {
+        0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, 0,
+        WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING,
+    },
+    {
+        0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+        WCW_COMBINING, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0,
+        0, 0, 0, 0, 0, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+        WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0,
+    },
+    {
+        WCW_COMBINING, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, WCW_COMBINING,
+        WCW_COMBINING, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+        0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0,
+    },
+    {
+        0, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_COMBINING, 0, WCW_COMBINING, 0, WCW_COMBINING, 0, 0,
+        0, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+        WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0,
+        0, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, WCW_COMBINING,
+        0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0,
+    },
+    {
+        WCW_COMBINING, 0, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        0, WCW_COMBINING, 0, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+        WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_COMBINING, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        0, 0, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0,
+    },
+    {
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0,
+        0, 0, 0, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS,
+    },
+    {
+        0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0, 0, WCW_AMBIGUOUS, 0, 0,
+        0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0,
+        WCW_AMBIGUOUS, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, WCW_AMBIGUOUS,
+    },
+    {
+        0, WCW_AMBIGUOUS, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, WCW_AMBIGUOUS, 0,
+        0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, 0, 0, 0,
+        0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0,
+        0, 0,
+    },
+    {
+        WCW_WIDE, 0, 0, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, 0,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, WCW_AMBIGUOUS, 0, 0,
+        0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, 0, 0, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0,
+        WCW_AMBIGUOUS, 0,
+    },
+    {
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE,
+    },
+    {
+        0, 0, 0, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS,
+    },
+    {
+        0, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE,
+        WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_WIDE, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_WIDE,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, WCW_AMBIGUOUS, 0, 0, 0, 0,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_WIDE, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_WIDE, WCW_WIDE, WCW_AMBIGUOUS,
+        WCW_WIDE, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_WIDE, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_WIDE, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_WIDE, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, 0, WCW_WIDE, 0,
+    },
+    {
+        0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, WCW_WIDE, 0, 0, 0, 0, 0, 0,
+        0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, 0, 0, 0, 0, WCW_WIDE, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_COMBINING|WCW_WIDE,
+        WCW_COMBINING|WCW_WIDE, WCW_COMBINING|WCW_WIDE, WCW_COMBINING|WCW_WIDE,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, 0,
+    },
+    {
+        0, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        0, 0, WCW_COMBINING|WCW_WIDE, WCW_COMBINING|WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        0, 0, WCW_COMBINING, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, WCW_COMBINING,
+        0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0,
+        WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, WCW_COMBINING,
+        WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, WCW_COMBINING, 0, 0, 0, 0,
+        WCW_COMBINING, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        0, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        0, WCW_AMBIGUOUS, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0,
+        0, 0, 0, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0,
+        0, WCW_COMBINING, WCW_COMBINING, 0, 0, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, 0, 0, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+        0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING, 0, 0, 0, 0,
+        WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        WCW_COMBINING, 0, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, WCW_COMBINING, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0,
+        WCW_COMBINING, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, WCW_COMBINING,
+    },
+    {
+        0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, 0, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, WCW_COMBINING, 0, WCW_COMBINING,
+        0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_COMBINING|WCW_WIDE, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, WCW_WIDE,
+        WCW_WIDE, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0, 0,
+        0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0,
+        0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        0, 0, 0, 0, WCW_COMBINING, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING,
+    },
+    {
+        WCW_COMBINING, WCW_COMBINING, 0, WCW_COMBINING, WCW_COMBINING, 0,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, WCW_COMBINING,
+        WCW_COMBINING, WCW_COMBINING, WCW_COMBINING, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0, 0, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, 0, 0,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_WIDE, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+    },
+    {
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS, WCW_AMBIGUOUS,
+        WCW_AMBIGUOUS, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, 0, 0, 0, WCW_WIDE, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0,
+        WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0,
+        0, 0, WCW_WIDE, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0,
+        0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+    },
+    {
+        0, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0,
+    },
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0,
+    },
+    {
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE,
+        WCW_WIDE, WCW_WIDE, WCW_WIDE, WCW_WIDE, 0, 0, 0, 0, 0,
+    },
+};
+static inline uint8_t wcwidth_class_lookup(unsigned c)
+{
+    unsigned mid = wcwidth_class_top[
+        c >> (WCWIDTH_CLASS_SHIFT + WCWIDTH_CLASS_MSHIFT)];
+    unsigned block = wcwidth_class_mid[mid][
+        (c >> WCWIDTH_CLASS_SHIFT) & ((1 << WCWIDTH_CLASS_MSHIFT) - 1)];
+    return wcwidth_class_blocks[block][
+        c & ((1 << WCWIDTH_CLASS_SHIFT) - 1)];
+}
+
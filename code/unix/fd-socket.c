@@ -4,15 +4,27 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 
 #include "tree234.h"
 #include "putty.h"
 #include "network.h"
 
+/*
+ * Maximum number of bufchain blocks to pass to one writev call.
+ */
+#define FDSOCKET_WRITE_IOV 64
+#if defined IOV_MAX && IOV_MAX < FDSOCKET_WRITE_IOV
+#undef FDSOCKET_WRITE_IOV
+#define FDSOCKET_WRITE_IOV IOV_MAX
+#endif
+
 typedef struct FdSocket {
     int outfd, infd, inerrfd;          /* >= 0 if socket is open */
     DeferredSocketOpener *opener;      /* non-NULL if not opened yet */
@@ -24,6 +36,10 @@ typedef struct FdSocket {
 
     int pending_error;
 
+    bool infd_nonblocking;             /* safe to drain infd to EAGAIN */
+    ReadSizer rsz;
+    SocketIOStats stats;
+
     SockAddr *addr;
     int port;
     Plug *plug;
@@ -175,9 +191,23 @@ static int fdsocket_try_send(FdSocket *fds)
     while (bufchain_size(&fds->pending_output_data) > 0) {
         ssize_t ret;
 
-        ptrlen data = bufchain_prefix(&fds->pending_output_data);
-        ret = write(fds->outfd, data.ptr, data.len);
+        /*
+         * Write as many blocks from the front of the bufchain as we
+         * can in a single writev, rather than one write per block.
+         */
+        ptrlen vec[FDSOCKET_WRITE_IOV];
+        struct iovec iov[FDSOCKET_WRITE_IOV];
+        size_t i, n = bufchain_prefixes(&fds->pending_output_data, vec,
+                                        FDSOCKET_WRITE_IOV);
+        for (i = 0; i < n; i++) {
+            iov[i].iov_base = (void *)vec[i].ptr;
+            iov[i].iov_len = vec[i].len;
+        }
+        ret = writev(fds->outfd, iov, n);
         noise_ultralight(NOISE_SOURCE_IOID, ret);
+        fds->stats.write_calls++;
+        if (ret > 0)
+            fds->stats.bytes_written += ret;
         if (ret < 0 && errno != EWOULDBLOCK) {
             if (!fds->pending_error) {
                 fds->pending_error = errno;
@@ -258,30 +288,80 @@ static const char *fdsocket_socket_error(Socket *s)
     return NULL;
 }
 
+static bool fdsocket_get_io_stats(Socket *s, SocketIOStats *stats)
+{
+    FdSocket *fds = container_of(s, FdSocket, sock);
+    *stats = fds->stats;
+    stats->read_size = fds->rsz.size;
+    return true;
+}
+
 static void fdsocket_select_result_input(int fd, int event)
 {
     FdSocket *fds;
-    char buf[20480];
-    int retd;
+    char *buf;
+    size_t bufsize, got = 0;
+    int err = 0;
+    bool eof = false;
 
     if (!(fds = find234(fdsocket_by_infd, &fd, fdsocket_infd_find)))
         return;
 
-    retd = read(fds->infd, buf, sizeof(buf));
-    if (retd > 0) {
-        plug_receive(fds->plug, 0, buf, retd);
-    } else {
+    /*
+     * If the input fd is nonblocking, read from it until it runs dry
+     * or fills our buffer, and pass everything to the plug at once.
+     * Otherwise we can only risk a single read() per event, since a
+     * second one might block.
+     */
+    bufsize = fds->rsz.size;
+    buf = read_buffer_claim(bufsize);
+    fds->stats.read_events++;
+    do {
+        ssize_t retd = read(fds->infd, buf + got, bufsize - got);
+        fds->stats.read_calls++;
+        if (retd < 0) {
+            if (errno != EWOULDBLOCK || got == 0)
+                err = errno;
+            break;
+        } else if (retd == 0) {
+            eof = true;
+            break;
+        }
+        got += retd;
+        fds->stats.bytes_read += retd;
+    } while (fds->infd_nonblocking && got < bufsize);
+    read_sizer_update(&fds->rsz, got);
+
+    if (got > 0) {
+        /*
+         * An error at the end of a batch is reported after the data,
+         * via the same callback used for write errors. It must be
+         * queued before plug_receive, which might close the socket.
+         * EOF needs no such care: the fd will still be readable, and
+         * report EOF again, next time round.
+         */
+        if (err && !fds->pending_error) {
+            fds->pending_error = err;
+            uxsel_del(fds->infd);
+            queue_toplevel_callback(fdsocket_error_callback, fds);
+        }
+        plug_receive(fds->plug, 0, buf, got);
+    } else if (err == EWOULDBLOCK) {
+        /* spurious wakeup; nothing to do */
+    } else if (err || eof) {
         del234(fdsocket_by_infd, fds);
         uxsel_del(fds->infd);
         close(fds->infd);
         fds->infd = -1;
 
-        if (retd < 0) {
-            plug_closing_errno(fds->plug, errno);
+        if (err) {
+            plug_closing_errno(fds->plug, err);
         } else {
             plug_closing_normal(fds->plug);
         }
     }
+
+    read_buffer_release(buf);
 }
 
 static void fdsocket_select_result_output(int fd, int event)
@@ -324,6 +404,7 @@ static const SocketVtable FdSocket_sockvt = {
     .set_frozen = fdsocket_set_frozen,
     .socket_error = fdsocket_socket_error,
     .peer_info = NULL,
+    .get_io_stats = fdsocket_get_io_stats,
 };
 
 static void fdsocket_connect_success_callback(void *ctx)
@@ -354,6 +435,8 @@ void setup_fd_socket(Socket *s, int infd, int outfd, int inerrfd)
     }
 
     if (fds->infd >= 0) {
+        int flags = fcntl(fds->infd, F_GETFL);
+        fds->infd_nonblocking = (flags >= 0 && (flags & O_NONBLOCK));
         if (!fdsocket_by_infd)
             fdsocket_by_infd = newtree234(fdsocket_infd_cmp);
         add234(fdsocket_by_infd, fds);
@@ -389,6 +472,9 @@ static FdSocket *make_fd_socket_internal(SockAddr *addr, int port, Plug *plug)
     fds->plug = plug;
     fds->outgoingeof = EOF_NO;
     fds->pending_error = 0;
+    fds->infd_nonblocking = false;
+    read_sizer_init(&fds->rsz);
+    memset(&fds->stats, 0, sizeof(fds->stats));
 
     fds->opener = NULL;
     fds->infd = fds->outfd = fds->inerrfd = -1;
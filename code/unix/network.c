@@ -9,7 +9,9 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/types.h>
+#include <limits.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/ioctl.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -32,6 +34,21 @@
 # define X11_UNIX_PATH "/tmp/.X11-unix/X"
 #endif
 
+/*
+ * Maximum number of bufchain blocks to pass to one sendmsg call.
+ */
+#define NET_SEND_IOV 64
+#if defined IOV_MAX && IOV_MAX < NET_SEND_IOV
+#undef NET_SEND_IOV
+#define NET_SEND_IOV IOV_MAX
+#endif
+
+/*
+ * While a socket is corked, writes to it are only buffered, until
+ * this much data has built up.
+ */
+#define NET_CORK_LIMIT 16384
+
 /*
  * Access to sockaddr types without breaking C strict aliasing rules.
  */
@@ -74,6 +91,7 @@ struct NetSocket {
     bool oobinline;
     enum { EOF_NO, EOF_PENDING, EOF_SENT } outgoingeof;
     bool incomingeof;
+    bool corked;                       /* hold back writes for batching */
     int pending_error;                 /* in case send() returns error */
     bool listener;
     bool nodelay, keepalive;           /* for connect()-type sockets */
@@ -89,6 +107,9 @@ struct NetSocket {
      */
     NetSocket *parent, *child;
 
+    ReadSizer rsz;                     /* how much to read per event */
+    SocketIOStats stats;
+
     Socket sock;
 };
 
@@ -488,7 +509,9 @@ static size_t sk_net_write(Socket *s, const void *data, size_t len);
 static size_t sk_net_write_oob(Socket *s, const void *data, size_t len);
 static void sk_net_write_eof(Socket *s);
 static void sk_net_set_frozen(Socket *s, bool is_frozen);
+static void sk_net_set_corked(Socket *s, bool is_corked);
 static SocketPeerInfo *sk_net_peer_info(Socket *s);
+static bool sk_net_get_io_stats(Socket *s, SocketIOStats *stats);
 static const char *sk_net_socket_error(Socket *s);
 
 static const SocketVtable NetSocket_sockvt = {
@@ -498,8 +521,10 @@ static const SocketVtable NetSocket_sockvt = {
     .write_oob = sk_net_write_oob,
     .write_eof = sk_net_write_eof,
     .set_frozen = sk_net_set_frozen,
+    .set_corked = sk_net_set_corked,
     .socket_error = sk_net_socket_error,
     .peer_info = sk_net_peer_info,
+    .get_io_stats = sk_net_get_io_stats,
 };
 
 static Socket *sk_net_accept(accept_ctx_t ctx, Plug *plug)
@@ -521,6 +546,9 @@ static Socket *sk_net_accept(accept_ctx_t ctx, Plug *plug)
     ret->localhost_only = false;    /* unused, but best init anyway */
     ret->pending_error = 0;
     ret->oobpending = false;
+    ret->corked = false;
+    read_sizer_init(&ret->rsz);
+    memset(&ret->stats, 0, sizeof(ret->stats));
     ret->outgoingeof = EOF_NO;
     ret->incomingeof = false;
     ret->listener = false;
@@ -769,6 +797,9 @@ Socket *sk_new(SockAddr *addr, int port, bool privport, bool oobinline,
     ret->pending_error = 0;
     ret->parent = ret->child = NULL;
     ret->oobpending = false;
+    ret->corked = false;
+    read_sizer_init(&ret->rsz);
+    memset(&ret->stats, 0, sizeof(ret->stats));
     ret->outgoingeof = EOF_NO;
     ret->incomingeof = false;
     ret->listener = false;
@@ -822,6 +853,9 @@ Socket *sk_newlistener(const char *srcaddr, int port, Plug *plug,
     ret->pending_error = 0;
     ret->parent = ret->child = NULL;
     ret->oobpending = false;
+    ret->corked = false;
+    read_sizer_init(&ret->rsz);
+    memset(&ret->stats, 0, sizeof(ret->stats));
     ret->outgoingeof = EOF_NO;
     ret->incomingeof = false;
     ret->listener = true;
@@ -1105,24 +1139,40 @@ static void socket_error_callback(void *vs)
 void try_send(NetSocket *s)
 {
     while (s->sending_oob || bufchain_size(&s->output_data) > 0) {
-        int nsent;
+        ssize_t nsent;
         int err;
-        const void *data;
         size_t len;
-        int urgentflag;
 
         if (s->sending_oob) {
-            urgentflag = MSG_OOB;
             len = s->sending_oob;
-            data = &s->oobdata;
+            nsent = send(s->s, &s->oobdata, len, MSG_OOB);
         } else {
-            urgentflag = 0;
-            ptrlen bufdata = bufchain_prefix(&s->output_data);
-            data = bufdata.ptr;
-            len = bufdata.len;
+            /*
+             * Gather as many blocks from the front of the output
+             * bufchain as we can into one sendmsg, so that a backlog
+             * of lots of small packets doesn't cost a system call
+             * apiece.
+             */
+            ptrlen vec[NET_SEND_IOV];
+            struct iovec iov[NET_SEND_IOV];
+            struct msghdr msg;
+            size_t i, n = bufchain_prefixes(&s->output_data, vec,
+                                            NET_SEND_IOV);
+
+            for (i = len = 0; i < n; i++) {
+                iov[i].iov_base = (void *)vec[i].ptr;
+                iov[i].iov_len = vec[i].len;
+                len += vec[i].len;
+            }
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = n;
+            nsent = sendmsg(s->s, &msg, 0);
         }
-        nsent = send(s->s, data, len, urgentflag);
         noise_ultralight(NOISE_SOURCE_IOLEN, nsent);
+        s->stats.write_calls++;
+        if (nsent > 0)
+            s->stats.bytes_written += nsent;
         if (nsent <= 0) {
             err = (nsent < 0 ? errno : 0);
             if (err == EWOULDBLOCK) {
@@ -1157,7 +1207,7 @@ void try_send(NetSocket *s)
             }
         } else {
             if (s->sending_oob) {
-                if (nsent < len) {
+                if ((size_t)nsent < len) {
                     memmove(s->oobdata, s->oobdata+nsent, len-nsent);
                     s->sending_oob = len - nsent;
                 } else {
@@ -1196,6 +1246,13 @@ static size_t sk_net_write(Socket *sock, const void *buf, size_t len)
      */
     bufchain_add(&s->output_data, buf, len);
 
+    /*
+     * If we're corked, leave the data where it is for the moment, so
+     * that it can go out in one batch with whatever comes next.
+     */
+    if (s->corked && bufchain_size(&s->output_data) < NET_CORK_LIMIT)
+        return bufchain_size(&s->output_data);
+
     /*
      * Now try sending from the start of the buffer list.
      */
@@ -1267,7 +1324,6 @@ static void sk_net_write_eof(Socket *sock)
 static void net_select_result(int fd, int event)
 {
     int ret;
-    char buf[20480];                   /* nice big buffer for plenty of speed */
     NetSocket *s;
     bool atmark = true;
 
@@ -1287,8 +1343,11 @@ static void net_select_result(int fd, int event)
              * data, which we will send to the back end with
              * type==2 (urgent data).
              */
+            char buf[256];             /* TCP urgent data is one byte */
+
             ret = recv(s->s, buf, sizeof(buf), MSG_OOB);
             noise_ultralight(NOISE_SOURCE_IOLEN, ret);
+            s->stats.read_calls++;
             if (ret == 0) {
                 plug_closing_error(s->plug, "Internal networking trouble");
             } else if (ret < 0) {
@@ -1370,30 +1429,75 @@ static void net_select_result(int fd, int event)
         } else
             atmark = true;
 
-        ret = recv(s->s, buf, s->oobpending ? 1 : sizeof(buf), 0);
-        noise_ultralight(NOISE_SOURCE_IOLEN, ret);
-        if (ret < 0) {
-            if (errno == EWOULDBLOCK) {
-                break;
-            }
-        }
-        if (ret < 0) {
-            plug_closing_errno(s->plug, errno);
-        } else if (0 == ret) {
-            s->incomingeof = true;     /* stop trying to read now */
-            uxsel_tell(s);
-            plug_closing_normal(s->plug);
-        } else {
+        {
             /*
-             * Receiving actual data on a socket means we can
-             * stop falling back through the candidate
-             * addresses to connect to.
+             * Drain the socket: keep reading until either the kernel
+             * has nothing more for us or we've filled this socket's
+             * current read allowance, and then hand the whole lot to
+             * the plug in one go. While we're reading up to an
+             * urgent mark, we still go one byte at a time.
              */
-            if (s->addr) {
-                sk_addr_free(s->addr);
-                s->addr = NULL;
+            size_t bufsize = s->oobpending ? 1 : s->rsz.size;
+            char *buf = read_buffer_claim(bufsize);
+            size_t got = 0;
+            int err = 0;
+            bool eof = false;
+
+            s->stats.read_events++;
+            while (got < bufsize) {
+                ret = recv(s->s, buf + got, bufsize - got, 0);
+                noise_ultralight(NOISE_SOURCE_IOLEN, ret);
+                s->stats.read_calls++;
+                if (ret < 0) {
+                    if (errno != EWOULDBLOCK)
+                        err = errno;
+                    break;
+                } else if (ret == 0) {
+                    eof = true;
+                    break;
+                }
+                got += ret;
+                s->stats.bytes_read += ret;
+            }
+            if (!s->oobpending)
+                read_sizer_update(&s->rsz, got);
+
+            if (got > 0) {
+                /*
+                 * Receiving actual data on a socket means we can
+                 * stop falling back through the candidate
+                 * addresses to connect to.
+                 */
+                if (s->addr) {
+                    sk_addr_free(s->addr);
+                    s->addr = NULL;
+                }
+
+                /*
+                 * If the batch ended in an error, report it after
+                 * the data, by the same deferred route that
+                 * try_send() uses. (An EOF needs no special
+                 * handling: the socket will still be readable next
+                 * time round, and the next recv will return 0
+                 * again.) This has to be set up _before_ calling
+                 * plug_receive, which might close the socket.
+                 */
+                if (err) {
+                    s->pending_error = err;
+                    uxsel_tell(s);
+                    queue_toplevel_callback(socket_error_callback, s);
+                }
+
+                plug_receive(s->plug, atmark ? 0 : 1, buf, got);
+            } else if (err) {
+                plug_closing_errno(s->plug, err);
+            } else if (eof) {
+                s->incomingeof = true; /* stop trying to read now */
+                uxsel_tell(s);
+                plug_closing_normal(s->plug);
             }
-            plug_receive(s->plug, atmark ? 0 : 1, buf, ret);
+
+            read_buffer_release(buf);
         }
         break;
       case SELECT_W:                   /* writable */
@@ -1494,6 +1598,28 @@ static void sk_net_set_frozen(Socket *sock, bool is_frozen)
     uxsel_tell(s);
 }
 
+static void sk_net_set_corked(Socket *sock, bool is_corked)
+{
+    NetSocket *s = container_of(sock, NetSocket, sock);
+    if (s->corked == is_corked)
+        return;
+    s->corked = is_corked;
+    if (!is_corked) {
+        /* Send everything that built up while we were corked. */
+        if (s->writable && s->outgoingeof != EOF_SENT)
+            try_send(s);
+        uxsel_tell(s);
+    }
+}
+
+static bool sk_net_get_io_stats(Socket *sock, SocketIOStats *stats)
+{
+    NetSocket *s = container_of(sock, NetSocket, sock);
+    *stats = s->stats;
+    stats->read_size = s->rsz.size;
+    return true;
+}
+
 static SocketPeerInfo *sk_net_peer_info(Socket *sock)
 {
     NetSocket *s = container_of(sock, NetSocket, sock);
@@ -1567,9 +1693,47 @@ int sk_net_get_fd(Socket *sock)
     return s->s;
 }
 
+/*
+ * Report whether a NetSocket is a connected data socket in a steady
+ * state: nothing waiting to be sent, no EOF seen or requested in
+ * either direction, and no error pending. Only such a socket can be
+ * handed over to sk_net_detach_fd.
+ */
+bool sk_net_is_idle(Socket *sock)
+{
+    if (sock->vt != &NetSocket_sockvt)
+        return false;
+    NetSocket *s = container_of(sock, NetSocket, sock);
+    return (s->s >= 0 && !s->listener && s->connected && !s->child &&
+            !s->pending_error && !s->incomingeof && !s->oobpending &&
+            s->outgoingeof == EOF_NO && !s->sending_oob &&
+            bufchain_size(&s->output_data) == 0);
+}
+
+/*
+ * Take the file descriptor away from an idle NetSocket, so that the
+ * caller can do its own I/O on it directly. The socket stops
+ * selecting on the fd and will never call its Plug again; the caller
+ * becomes responsible for closing the fd, and must still sk_close the
+ * Socket itself in the normal way.
+ */
+int sk_net_detach_fd(Socket *sock)
+{
+    assert(sk_net_is_idle(sock));
+    NetSocket *s = container_of(sock, NetSocket, sock);
+    int fd = s->s;
+
+    uxsel_del(fd);
+    del234(sktree, s);
+    s->s = -1;
+    return fd;
+}
+
 static void uxsel_tell(NetSocket *s)
 {
     int rwx = 0;
+    if (s->s < 0)
+        return;                        /* fd detached by sk_net_detach_fd */
     if (!s->pending_error) {
         if (s->listener) {
             rwx |= SELECT_R;           /* read == accept */
@@ -1693,6 +1857,9 @@ Socket *new_unix_listener(SockAddr *listenaddr, Plug *plug)
     ret->pending_error = 0;
     ret->parent = ret->child = NULL;
     ret->oobpending = false;
+    ret->corked = false;
+    read_sizer_init(&ret->rsz);
+    memset(&ret->stats, 0, sizeof(ret->stats));
     ret->outgoingeof = EOF_NO;
     ret->incomingeof = false;
     ret->listener = true;
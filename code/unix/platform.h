@@ -100,6 +100,17 @@ unsigned long getticks(void);
 #define TICKSPERSEC    1000            /* we choose to use milliseconds */
 #define CURSORBLINK     450            /* no standard way to set this */
 
+/*
+ * Atomic operations on pointers shared between threads, with full
+ * memory barriers. Both return the previous value of *pp.
+ * ATOMIC_PTR_CAS replaces it with newval only if it was oldval;
+ * ATOMIC_PTR_SWAP replaces it unconditionally.
+ */
+#define ATOMIC_PTR_CAS(pp, oldval, newval)              \
+    __sync_val_compare_and_swap(pp, oldval, newval)
+#define ATOMIC_PTR_SWAP(pp, newval)                     \
+    __atomic_exchange_n(pp, newval, __ATOMIC_SEQ_CST)
+
 #define WCHAR wchar_t
 #define BYTE unsigned char
 
@@ -345,6 +356,24 @@ void cloexec(int);
 void noncloexec(int);
 bool nonblock(int);
 bool no_nonblock(int);
+
+/*
+ * Adaptive read sizing and a shared scratch buffer for the code that
+ * reads from sockets, pipes and ptys (utils/read_buffer.c).
+ */
+#define READ_SIZER_MIN 20480
+#ifndef READ_SIZER_MAX
+#define READ_SIZER_MAX 1048576
+#endif
+#define READ_SIZER_SHRINK_AFTER 8
+typedef struct ReadSizer {
+    size_t size;        /* how much to try to read in the next event */
+    unsigned underused; /* consecutive events that used little of it */
+} ReadSizer;
+void read_sizer_init(ReadSizer *rs);
+void read_sizer_update(ReadSizer *rs, size_t got);
+char *read_buffer_claim(size_t size);
+void read_buffer_release(char *buf);
 char *make_dir_and_check_ours(const char *dirname);
 char *make_dir_path(const char *path, mode_t mode);
 
@@ -359,6 +388,8 @@ bool init_ucs(struct unicode_data *ucsdata, char *line_codepage,
  */
 void *sk_getxdmdata(Socket *sock, int *lenp);
 int sk_net_get_fd(Socket *sock);
+bool sk_net_is_idle(Socket *sock);
+int sk_net_detach_fd(Socket *sock);
 SockAddr *unix_sock_addr(const char *path);
 Socket *new_unix_listener(SockAddr *listenaddr, Plug *plug);
 
@@ -505,6 +505,12 @@ void sigwinch(int signum)
         /* not much we can do about it */;
 }
 
+static void sigusr1(int signum)
+{
+    if (write(signalpipe[1], "s", 1) <= 0)
+        /* not much we can do about it */;
+}
+
 /*
  * Short description of parameters.
  */
@@ -544,6 +550,10 @@ static void usage(void)
     printf("  -1 -2     force use of particular SSH protocol version\n");
     printf("  -4 -6     force use of IPv4 or IPv6\n");
     printf("  -C        enable compression\n");
+    printf("  -compress-thread\n");
+    printf("            compress on a separate thread (SSH-2 only)\n");
+    printf("  -cipher-threads n\n");
+    printf("            encrypt on up to n worker threads (SSH-2 only)\n");
     printf("  -i key    private key file for user authentication\n");
     printf("  -noagent  disable use of Pageant\n");
     printf("  -agent    enable use of Pageant\n");
@@ -626,13 +636,16 @@ static bool plink_pw_setup(void *vctx, pollwrapper *pw)
 static void plink_pw_check(void *vctx, pollwrapper *pw)
 {
     if (pollwrap_check_fd_rwx(pw, signalpipe[0], SELECT_R)) {
-        char c[1];
+        char c[1] = { 'x' };
         struct winsize size;
         if (read(signalpipe[0], c, 1) <= 0)
             /* ignore error */;
-        /* ignore its value; it'll be `x' */
-        if (ioctl(STDIN_FILENO, TIOCGWINSZ, (void *)&size) >= 0)
+        if (c[0] == 's') {
+            /* SIGUSR1: dump performance counters to the Event Log */
+            backend_special(backend, SS_STATS, 0);
+        } else if (ioctl(STDIN_FILENO, TIOCGWINSZ, (void *)&size) >= 0) {
             backend_size(backend, size.ws_col, size.ws_row);
+        }
     }
 
     if (pollwrap_check_fd_rwx(pw, STDIN_FILENO, SELECT_R)) {
@@ -859,7 +872,7 @@ int main(int argc, char **argv)
     putty_signal(SIGPIPE, SIG_IGN);
 
     /*
-     * Set up the pipe we'll use to tell us about SIGWINCH.
+     * Set up the pipe we'll use to tell us about SIGWINCH and SIGUSR1.
      */
     if (pipe(signalpipe) < 0) {
         perror("pipe");
@@ -871,6 +884,7 @@ int main(int argc, char **argv)
     cloexec(signalpipe[0]);
     cloexec(signalpipe[1]);
     putty_signal(SIGWINCH, sigwinch);
+    putty_signal(SIGUSR1, sigusr1);
 
     /*
      * Now that we've got the SIGWINCH handler installed, try to find
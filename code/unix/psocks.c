@@ -2,10 +2,13 @@
  * Main program for Unix psocks.
  */
 
+#define _GNU_SOURCE                    /* for splice() */
+
 #include <string.h>
 #include <errno.h>
 
 #include <sys/types.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
 #include <signal.h>
 #include <fcntl.h>
@@ -13,6 +16,7 @@
 
 #include "putty.h"
 #include "ssh.h"
+#include "tree234.h"
 #include "psocks.h"
 
 typedef struct PsocksDataSinkPopen {
@@ -127,9 +131,236 @@ static void start_subcommand(strbuf *args)
     }
 }
 
+#if HAVE_SPLICE
+
+/*
+ * Zero-copy relay between two sockets, using splice() through a pipe
+ * in each direction so that the data never has to be copied into
+ * user space.
+ *
+ * Direction i of a relay moves data from fd[i] to fd[1-i]. Each fd is
+ * therefore the source of one direction and the destination of the
+ * other, and we select on it for reading if its own direction has
+ * room in its pipe, and for writing if the other direction has data
+ * waiting in its pipe. Back-pressure falls out of that: a destination
+ * that won't accept data fills the pipe, and then we stop reading
+ * from the source.
+ */
+typedef struct SpliceDirection {
+    int pipe[2];
+    size_t inpipe;              /* bytes currently held in the pipe */
+    bool eof_read;              /* source has sent EOF */
+    bool eof_sent;              /* ... and we've passed it on */
+} SpliceDirection;
+
+typedef struct SpliceRelay {
+    int fd[2];
+    SpliceDirection dir[2];
+    size_t pipesize;
+    psocks_splice_done_fn_t done;
+    void *ctx;
+} SpliceRelay;
+
+/* Map from each relayed fd to its SpliceRelay, for uxsel callbacks. */
+typedef struct SpliceFd {
+    int fd;
+    SpliceRelay *relay;
+} SpliceFd;
+
+static tree234 *splice_fds;
+
+static int splice_fd_cmp(void *av, void *bv)
+{
+    SpliceFd *a = (SpliceFd *)av, *b = (SpliceFd *)bv;
+    return a->fd < b->fd ? -1 : a->fd > b->fd ? +1 : 0;
+}
+
+static int splice_fd_find(void *av, void *bv)
+{
+    int *a = (int *)av;
+    SpliceFd *b = (SpliceFd *)bv;
+    return *a < b->fd ? -1 : *a > b->fd ? +1 : 0;
+}
+
+static void splice_select_result(int fd, int event);
+
+static void splice_relay_free(SpliceRelay *sr)
+{
+    for (size_t i = 0; i < 2; i++) {
+        SpliceFd *sf = find234(splice_fds, &sr->fd[i], splice_fd_find);
+        del234(splice_fds, sf);
+        sfree(sf);
+        uxsel_del(sr->fd[i]);
+        close(sr->fd[i]);
+        close(sr->dir[i].pipe[0]);
+        close(sr->dir[i].pipe[1]);
+    }
+    sfree(sr);
+}
+
+static void splice_relay_finish(SpliceRelay *sr, const char *err)
+{
+    psocks_splice_done_fn_t done = sr->done;
+    void *ctx = sr->ctx;
+    splice_relay_free(sr);
+    done(ctx, err);
+}
+
+static void splice_relay_uxsel(SpliceRelay *sr)
+{
+    for (size_t i = 0; i < 2; i++) {
+        SpliceDirection *src = &sr->dir[i], *dst = &sr->dir[1-i];
+        int rwx = 0;
+        if (!src->eof_read && src->inpipe < sr->pipesize)
+            rwx |= SELECT_R;
+        if (dst->inpipe > 0)
+            rwx |= SELECT_W;
+        uxsel_set(sr->fd[i], rwx, splice_select_result);
+    }
+}
+
+/*
+ * Move as much data as we can in direction i, without blocking.
+ * Returns an error message, or NULL if all is well.
+ */
+static const char *splice_relay_pump(SpliceRelay *sr, size_t i)
+{
+    SpliceDirection *d = &sr->dir[i];
+    int src = sr->fd[i], dst = sr->fd[1-i];
+    bool progress = true;
+
+    while (progress) {
+        progress = false;
+
+        if (!d->eof_read && d->inpipe < sr->pipesize) {
+            ssize_t ret = splice(src, NULL, d->pipe[1], NULL,
+                                 sr->pipesize - d->inpipe,
+                                 SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (ret > 0) {
+                d->inpipe += ret;
+                progress = true;
+            } else if (ret == 0) {
+                d->eof_read = true;
+                progress = true;
+            } else if (errno != EAGAIN && errno != EINTR) {
+                return strerror(errno);
+            }
+        }
+
+        if (d->inpipe > 0) {
+            ssize_t ret = splice(d->pipe[0], NULL, dst, NULL, d->inpipe,
+                                 SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (ret > 0) {
+                d->inpipe -= ret;
+                progress = true;
+            } else if (ret < 0 && errno != EAGAIN && errno != EINTR) {
+                return strerror(errno);
+            }
+        }
+    }
+
+    if (d->eof_read && d->inpipe == 0 && !d->eof_sent) {
+        shutdown(dst, SHUT_WR);
+        d->eof_sent = true;
+    }
+
+    return NULL;
+}
+
+static void splice_select_result(int fd, int event)
+{
+    SpliceFd *sf = find234(splice_fds, &fd, splice_fd_find);
+    if (!sf)
+        return;
+    SpliceRelay *sr = sf->relay;
+
+    /*
+     * Whichever event this is, pumping both directions is the
+     * simplest way to respond to it: the readable fd is the source of
+     * one, and the writable fd the destination of the other.
+     */
+    for (size_t i = 0; i < 2; i++) {
+        const char *err = splice_relay_pump(sr, i);
+        if (err) {
+            splice_relay_finish(sr, err);
+            return;
+        }
+    }
+
+    if (sr->dir[0].eof_sent && sr->dir[1].eof_sent) {
+        splice_relay_finish(sr, NULL);
+        return;
+    }
+
+    splice_relay_uxsel(sr);
+}
+
+static bool splice_relay(Socket *s1, Socket *s2,
+                         psocks_splice_done_fn_t done, void *ctx)
+{
+    if (!sk_net_is_idle(s1) || !sk_net_is_idle(s2))
+        return false;
+
+    SpliceRelay *sr = snew(SpliceRelay);
+    for (size_t i = 0; i < 2; i++) {
+        if (pipe(sr->dir[i].pipe) < 0) {
+            if (i > 0) {
+                close(sr->dir[0].pipe[0]);
+                close(sr->dir[0].pipe[1]);
+            }
+            sfree(sr);
+            return false;
+        }
+        cloexec(sr->dir[i].pipe[0]);
+        cloexec(sr->dir[i].pipe[1]);
+        sr->dir[i].inpipe = 0;
+        sr->dir[i].eof_read = sr->dir[i].eof_sent = false;
+    }
+
+    /*
+     * We can only put as much into a pipe as its kernel buffer holds
+     * without a splice blocking, so find out how big that is.
+     */
+    sr->pipesize = 65536;
+#ifdef F_GETPIPE_SZ
+    {
+        int size = fcntl(sr->dir[0].pipe[1], F_GETPIPE_SZ);
+        if (size > 0)
+            sr->pipesize = size;
+        size = fcntl(sr->dir[1].pipe[1], F_GETPIPE_SZ);
+        if (size > 0 && size < sr->pipesize)
+            sr->pipesize = size;
+    }
+#endif
+
+    sr->fd[0] = sk_net_detach_fd(s1);
+    sr->fd[1] = sk_net_detach_fd(s2);
+    sr->done = done;
+    sr->ctx = ctx;
+
+    if (!splice_fds)
+        splice_fds = newtree234(splice_fd_cmp);
+    for (size_t i = 0; i < 2; i++) {
+        SpliceFd *sf = snew(SpliceFd);
+        sf->fd = sr->fd[i];
+        sf->relay = sr;
+        add234(splice_fds, sf);
+    }
+
+    splice_relay_uxsel(sr);
+    return true;
+}
+
+#endif /* HAVE_SPLICE */
+
 static const PsocksPlatform platform = {
     open_pipes,
     start_subcommand,
+#if HAVE_SPLICE
+    splice_relay,
+#else
+    NULL /* splice_relay */,
+#endif
 };
 
 static bool psocks_pw_setup(void *ctx, pollwrapper *pw)
@@ -165,6 +396,12 @@ int main(int argc, char **argv)
     psocks_state *ps = psocks_new(&platform);
     psocks_cmdline(ps, argc, argv);
 
+    /*
+     * Block SIGPIPE, so that we'll get EPIPE individually on
+     * particular network connections that go wrong.
+     */
+    putty_signal(SIGPIPE, SIG_IGN);
+
     sk_init();
     uxsel_init();
     psocks_start(ps);
@@ -40,6 +40,7 @@
 #include "mpint.h"
 #include "ssh.h"
 #include "ssh/server.h"
+#include "ssh/sftp.h"
 
 void modalfatalbox(const char *p, ...)
 {
@@ -165,6 +166,8 @@ static void show_help(FILE *fp)
           "         --sessiondir DIR     cwd for session subprocess (default $HOME)\n"
           "         --sshlog FILE        write ssh-connection packet log to FILE\n"
           "         --sshrawlog FILE     write packets and raw data log to FILE\n"
+          "         --sftp-hash-threads N  hash files for SFTP extensions on N threads\n"
+          "                              (default one per CPU; 0 = main thread only)\n"
           "also:    psusan --help        show this text\n"
           "         psusan --version     show version information\n", fp);
 }
@@ -354,6 +357,10 @@ int main(int argc, char **argv)
     ssc.session_starting_dir = getenv("HOME");
     ssc.bare_connection = true;
 
+    /* By default, hash files for the SFTP server on every CPU */
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int sftp_hash_threads = ncpus > 1 ? ncpus : 0;
+
     while (--argc > 0) {
         const char *arg = *++argv;
         const char *val;
@@ -385,6 +392,9 @@ int main(int argc, char **argv)
             listen_socket = val;
         } else if (!strcmp(arg, "--listen-once")) {
             listen_once = true;
+        } else if (longoptarg(arg, "--sftp-hash-threads", &val,
+                              &argc, &argv)) {
+            sftp_hash_threads = atoi(val);
         } else {
             fprintf(stderr, "%s: unrecognised option '%s'\n", appname, arg);
             exit(1);
@@ -393,6 +403,8 @@ int main(int argc, char **argv)
 
     sk_init();
     uxsel_init();
+    sftp_server_set_hash_threads(sftp_hash_threads > 0 ?
+                                 sftp_hash_threads : 0);
 
     struct server_config scfg;
     scfg.conf = conf;
@@ -74,6 +74,7 @@ struct Pty {
 
     Seat *seat;
     size_t output_backlog;
+    ReadSizer rsz;
     char name[FILENAME_MAX];
     pid_t child_pid;
     int term_width, term_height;
@@ -423,6 +424,7 @@ static Pty *new_pty_struct(void)
     pty->conf = NULL;
     pty->pending_eof = false;
     bufchain_init(&pty->output_data);
+    read_sizer_init(&pty->rsz);
     return pty;
 }
 
@@ -598,8 +600,9 @@ static void pty_uxsel_setup(Pty *pty);
 
 static void pty_real_select_result(Pty *pty, int fd, int event, int status)
 {
-    char buf[4096];
-    int ret;
+    char *buf;
+    size_t bufsize;
+    ssize_t ret;
     bool finished = false;
 
     if (event < 0) {
@@ -633,8 +636,25 @@ static void pty_real_select_result(Pty *pty, int fd, int event, int status)
     } else {
         if (event == SELECT_R) {
             bool is_stdout = (fd == pty->master_o);
+            size_t got = 0;
 
-            ret = read(fd, buf, sizeof(buf));
+            /*
+             * The pty master is nonblocking, so we can read it until
+             * it runs dry and hand the terminal one large batch,
+             * instead of a redraw-provoking call per 4K. The pipes
+             * used in pipe mode aren't, so we only risk one read.
+             */
+            bufsize = pty->rsz.size;
+            buf = read_buffer_claim(bufsize);
+            do {
+                ret = read(fd, buf + got, bufsize - got);
+                if (ret <= 0)
+                    break;
+                got += ret;
+            } while (fd == pty->master_fd && got < bufsize);
+            read_sizer_update(&pty->rsz, got);
+            if (got > 0)
+                ret = got;     /* defer any EOF or error to next time */
 
             /*
              * Treat EIO on a pty master as equivalent to EOF (because
@@ -683,6 +703,7 @@ static void pty_real_select_result(Pty *pty, int fd, int event, int status)
                     pty->seat, !is_stdout, buf, ret);
                 pty_uxsel_setup(pty);
             }
+            read_buffer_release(buf);
         } else if (event == SELECT_W) {
             /*
              * Attempt to send data down the pty.
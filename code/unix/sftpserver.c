@@ -3,6 +3,8 @@
  * really operating on the Unix filesystem).
  */
 
+#define _GNU_SOURCE                    /* for copy_file_range() */
+
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -24,6 +26,10 @@
 #include "ssh/sftp.h"
 #include "tree234.h"
 
+#if HAVE_SENDFILE
+#include <sys/sendfile.h>
+#endif
+
 typedef struct UnixSftpServer UnixSftpServer;
 
 struct UnixSftpServer {
@@ -579,6 +585,139 @@ static void uss_write(SftpServer *srv, SftpReplyBuilder *reply,
     }
 }
 
+/*
+ * For copy-data, we try the ways of getting the kernel to copy the
+ * data in order of how much they might save: copy_file_range (which
+ * a filesystem can do by sharing extents, or a network filesystem on
+ * its server), then sendfile, and if neither works for this pair of
+ * files, an ordinary read and write loop.
+ */
+#define USS_COPY_CHUNK (1 << 30)       /* most we ask for in one call */
+#define USS_COPY_BUFSIZE 65536
+
+struct uss_copy {
+    int infd, outfd;
+    off_t inpos, outpos;
+    bool try_copy_file_range, try_sendfile;
+    char *buf;
+};
+
+static inline bool uss_copy_unsupported(int err)
+{
+    return (err == EXDEV || err == EINVAL || err == ENOSYS ||
+            err == EOPNOTSUPP || err == EBADF);
+}
+
+/* Copy up to 'len' bytes. Returns how many, 0 at EOF, or -1 on error. */
+static ssize_t uss_copy_some(struct uss_copy *cp, size_t len)
+{
+    ssize_t ret;
+
+#if HAVE_COPY_FILE_RANGE
+    if (cp->try_copy_file_range) {
+        ret = copy_file_range(cp->infd, &cp->inpos, cp->outfd, &cp->outpos,
+                              len, 0);
+        if (ret >= 0 || !uss_copy_unsupported(errno))
+            return ret;
+        cp->try_copy_file_range = false;
+    }
+#endif
+
+#if HAVE_SENDFILE
+    if (cp->try_sendfile) {
+        /* sendfile writes at the output file's own position */
+        if (lseek(cp->outfd, cp->outpos, SEEK_SET) < 0)
+            return -1;
+        ret = sendfile(cp->outfd, cp->infd, &cp->inpos, len);
+        if (ret > 0)
+            cp->outpos += ret;
+        if (ret >= 0 || !uss_copy_unsupported(errno))
+            return ret;
+        cp->try_sendfile = false;
+    }
+#endif
+
+    if (!cp->buf)
+        cp->buf = snewn(USS_COPY_BUFSIZE, char);
+    if (len > USS_COPY_BUFSIZE)
+        len = USS_COPY_BUFSIZE;
+    ret = pread(cp->infd, cp->buf, len, cp->inpos);
+    if (ret <= 0)
+        return ret;
+    for (ssize_t done = 0, written; done < ret; done += written) {
+        written = pwrite(cp->outfd, cp->buf + done, ret - done,
+                         cp->outpos + done);
+        if (written < 0)
+            return -1;
+    }
+    cp->inpos += ret;
+    cp->outpos += ret;
+    return ret;
+}
+
+static void uss_copy_data(SftpServer *srv, SftpReplyBuilder *reply,
+                          ptrlen srchandle, uint64_t srcoffset,
+                          uint64_t length, ptrlen dsthandle,
+                          uint64_t dstoffset)
+{
+    UnixSftpServer *uss = container_of(srv, UnixSftpServer, srv);
+    struct uss_copy cp;
+    struct stat inst, outst;
+    uint64_t left = length ? length : UINT64_MAX;
+
+    if ((cp.infd = uss_lookup_fd(uss, reply, srchandle)) < 0 ||
+        (cp.outfd = uss_lookup_fd(uss, reply, dsthandle)) < 0)
+        return;
+
+    if (fstat(cp.infd, &inst) < 0 || fstat(cp.outfd, &outst) < 0) {
+        uss_error(uss, reply);
+        return;
+    }
+
+    if (inst.st_dev == outst.st_dev && inst.st_ino == outst.st_ino) {
+        /*
+         * Copying within one file. Don't let the ranges overlap, as
+         * the draft requires; and if we're copying to end of file,
+         * stop at where the end was when we started, or copying
+         * forwards would go on reading what it had just written.
+         */
+        uint64_t size = inst.st_size;
+        uint64_t n = size > srcoffset ? size - srcoffset : 0;
+        if (n > left)
+            n = left;
+        if (n && srcoffset < dstoffset + n && dstoffset < srcoffset + n) {
+            fxp_reply_error(reply, SSH_FX_FAILURE,
+                            "source and destination ranges overlap");
+            return;
+        }
+        left = n;
+    }
+
+    cp.inpos = srcoffset;
+    cp.outpos = dstoffset;
+    cp.try_copy_file_range = true;
+    cp.try_sendfile = true;
+    cp.buf = NULL;
+
+    while (left > 0) {
+        ssize_t ret = uss_copy_some(
+            &cp, left < USS_COPY_CHUNK ? left : USS_COPY_CHUNK);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            uss_error(uss, reply);
+            sfree(cp.buf);
+            return;
+        }
+        if (ret == 0)
+            break;                     /* end of file */
+        left -= ret;
+    }
+
+    sfree(cp.buf);
+    fxp_reply_ok(reply);
+}
+
 static void uss_readdir(SftpServer *srv, SftpReplyBuilder *reply,
                         ptrlen handle, int max_entries, bool omit_longname)
 {
@@ -700,4 +839,5 @@ const SftpServerVtable unix_live_sftpserver_vt = {
     .read = uss_read,
     .write = uss_write,
     .readdir = uss_readdir,
+    .copy_data = uss_copy_data,
 };
@@ -0,0 +1,84 @@
+/*
+ * Wake up the main thread's event loop from another thread, so that
+ * it collects callbacks queued by queue_toplevel_callback_from_thread.
+ *
+ * We do this with an fd registered with uxsel, so it works the same
+ * way whether the main loop is cli_main_loop or the GTK one. Where
+ * eventfd is available we use that; otherwise an ordinary self-pipe.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "putty.h"
+
+#if HAVE_EVENTFD
+#include <sys/eventfd.h>
+#endif
+
+static int wakeup_readfd = -1, wakeup_writefd = -1;
+
+static void thread_wakeup(void);
+
+static void thread_wakeup_select_result(int fd, int event)
+{
+    char buf[64];
+
+    /*
+     * Drain the fd before collecting the callbacks, not after, so that
+     * a wakeup arriving in between isn't lost. For an eventfd one read
+     * resets the counter; for a pipe we read until it's empty.
+     */
+    while (read(fd, buf, sizeof(buf)) > 0)
+        continue;
+
+    collect_toplevel_callbacks_from_threads();
+}
+
+void thread_wakeup_setup(void)
+{
+    if (wakeup_readfd >= 0)
+        return;                        /* already done */
+
+#if HAVE_EVENTFD
+    wakeup_readfd = wakeup_writefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_readfd < 0) {
+        perror("eventfd");
+        exit(1);
+    }
+#else
+    int fds[2];
+    if (pipe(fds) < 0) {
+        perror("pipe");
+        exit(1);
+    }
+    nonblock(fds[0]);
+    nonblock(fds[1]);
+    cloexec(fds[0]);
+    cloexec(fds[1]);
+    wakeup_readfd = fds[0];
+    wakeup_writefd = fds[1];
+#endif
+
+    uxsel_set(wakeup_readfd, SELECT_R, thread_wakeup_select_result);
+    request_thread_wakeups(thread_wakeup);
+}
+
+static void thread_wakeup(void)
+{
+#if HAVE_EVENTFD
+    uint64_t one = 1;
+#else
+    char one = 1;
+#endif
+
+    /*
+     * If the write fails with EAGAIN, the fd is already readable, and
+     * that's all we wanted, so the only error worth retrying is EINTR.
+     */
+    while (write(wakeup_writefd, &one, sizeof(one)) < 0 && errno == EINTR)
+        continue;
+}
@@ -42,6 +42,7 @@
 #include "mpint.h"
 #include "ssh.h"
 #include "ssh/server.h"
+#include "ssh/sftp.h"
 
 void modalfatalbox(const char *p, ...)
 {
@@ -375,6 +376,14 @@ static void show_help(FILE *fp)
           "s->c compression types\n"
           "         --ssh1-ciphers STR     override list of SSH-1 ciphers\n"
           "         --ssh1-no-compression  forbid compression in SSH-1\n"
+          "         --compress-in-thread   run SSH-2 compression on worker "
+          "threads\n"
+          "         --cipher-threads N   run SSH-2 encryption on up to N "
+          "worker threads\n"
+          "         --sftp-hash-threads N  hash files for SFTP extensions on "
+          "N threads\n"
+          "                              (default one per CPU; 0 = main "
+          "thread only)\n"
           "         --deny-auth METHOD   forbid a userauth method\n"
           "         --allow-auth METHOD  allow a userauth method\n"
           "                 (METHOD = none/password/publickey/kbdint/tis/"
@@ -650,6 +659,10 @@ int main(int argc, char **argv)
     struct cmdline_instance *ci = &instances[ninstances++];
     init_cmdline_instance(ci);
 
+    /* By default, hash files for the SFTP server on every CPU */
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int sftp_hash_threads = ncpus > 1 ? ncpus : 0;
+
     if (argc <= 1) {
         /*
          * We're going to terminate with an error message below,
@@ -897,6 +910,13 @@ int main(int argc, char **argv)
             ci->ssc.ssh1_cipher_mask = mask;
         } else if (longoptnoarg(arg, "--ssh1-no-compression")) {
             ci->ssc.ssh1_allow_compression = false;
+        } else if (longoptnoarg(arg, "--compress-in-thread")) {
+            conf_set_bool(ci->conf, CONF_compress_in_thread, true);
+        } else if (longoptarg(arg, "--cipher-threads", &val, &argc, &argv)) {
+            conf_set_int(ci->conf, CONF_cipher_threads, atoi(val));
+        } else if (longoptarg(arg, "--sftp-hash-threads", &val,
+                              &argc, &argv)) {
+            sftp_hash_threads = atoi(val);
         } else if (longoptnoarg(arg, "--exitsignum")) {
             ci->ssc.exit_signal_numeric = true;
         } else if (longoptarg(arg, "--sshlog", &val, &argc, &argv) ||
@@ -958,6 +978,8 @@ int main(int argc, char **argv)
 
     sk_init();
     uxsel_init();
+    sftp_server_set_hash_threads(sftp_hash_threads > 0 ?
+                                 sftp_hash_threads : 0);
 
     for (size_t i = 0; i < ninstances; i++)
         cmdline_instance_start(&instances[i]);
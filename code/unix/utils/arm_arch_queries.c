@@ -92,6 +92,22 @@ bool platform_sha512_neon_available(void)
 #endif
 }
 
+bool platform_crc32_neon_available(void)
+{
+#if defined HWCAP_CRC32
+    return getauxval(AT_HWCAP) & HWCAP_CRC32;
+#elif defined HWCAP2_CRC32
+    return getauxval(AT_HWCAP2) & HWCAP2_CRC32;
+#elif defined __APPLE__
+    SysctlResult res = test_sysctl_flag("hw.optional.armv8_crc32");
+    /* Every Apple Arm CPU has had these instructions, so treat
+     * 'missing' as enabled */
+    return res != SYSCTL_OFF;
+#else
+    return false;
+#endif
+}
+
 #else /* defined __arm__ || defined __aarch64__ */
 
 /*
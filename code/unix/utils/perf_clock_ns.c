@@ -0,0 +1,25 @@
+/*
+ * Implement perf_clock_ns() for Unix.
+ */
+
+#include <time.h>
+#include <sys/time.h>
+
+#include "putty.h"
+
+uint64_t perf_clock_ns(void)
+{
+#if HAVE_CLOCK_GETTIME && HAVE_CLOCK_MONOTONIC
+    {
+        /* On Linux this is answered in the vDSO, without a system call */
+        struct timespec ts;
+        if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+            return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+#endif
+    {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        return (uint64_t)tv.tv_sec * 1000000000 + (uint64_t)tv.tv_usec * 1000;
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * Adaptive receive buffers for the Unix fd-reading code (network.c,
+ * fd-socket.c, pty.c).
+ *
+ * Each reader keeps a ReadSizer which decides how much it's willing
+ * to read in one event. It starts small, doubles every time a whole
+ * event's worth of reading fills the buffer completely (suggesting
+ * the peer is sending faster than we are draining), and halves again
+ * after a run of events that used only a small fraction of it. The
+ * upper limit can be changed at build time by defining READ_SIZER_MAX.
+ *
+ * The buffers themselves are not per-reader: all the readers in the
+ * process share one scratch buffer, grown to the largest size anyone
+ * has asked for. That avoids keeping a megabyte of idle memory around
+ * per socket. A nested claim (which shouldn't normally happen, since
+ * these are all called from the event loop) gets a buffer of its own.
+ */
+
+#include <stdlib.h>
+
+#include "putty.h"
+
+static char *shared_buf;
+static size_t shared_size;
+static bool shared_claimed;
+
+char *read_buffer_claim(size_t size)
+{
+    if (shared_claimed)
+        return snewn(size, char);
+
+    if (shared_size < size) {
+        sfree(shared_buf);
+        shared_buf = snewn(size, char);
+        shared_size = size;
+    }
+    shared_claimed = true;
+    return shared_buf;
+}
+
+void read_buffer_release(char *buf)
+{
+    if (buf == shared_buf && shared_claimed) {
+        shared_claimed = false;
+    } else {
+        sfree(buf);
+    }
+}
+
+void read_sizer_init(ReadSizer *rs)
+{
+    rs->size = READ_SIZER_MIN;
+    rs->underused = 0;
+}
+
+void read_sizer_update(ReadSizer *rs, size_t got)
+{
+    if (got >= rs->size) {
+        rs->underused = 0;
+        if (rs->size < READ_SIZER_MAX)
+            rs->size = (rs->size * 2 < READ_SIZER_MAX ?
+                        rs->size * 2 : READ_SIZER_MAX);
+    } else if (got < rs->size / 4 && rs->size > READ_SIZER_MIN) {
+        if (++rs->underused >= READ_SIZER_SHRINK_AFTER) {
+            rs->underused = 0;
+            rs->size /= 2;
+            if (rs->size < READ_SIZER_MIN)
+                rs->size = READ_SIZER_MIN;
+        }
+    } else {
+        rs->underused = 0;
+    }
+}
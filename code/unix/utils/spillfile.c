@@ -0,0 +1,84 @@
+/*
+ * Unix implementation of SpillFile, using an unlinked temporary file
+ * and mmap.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "putty.h"
+
+struct SpillFile {
+    int fd;
+    size_t segsize;
+    size_t nsegs;                      /* segments the file has room for */
+};
+
+SpillFile *spillfile_new(size_t segsize)
+{
+    const char *tmpdir;
+    char *path;
+    int fd;
+
+    assert(segsize > 0 && segsize % SPILLFILE_GRANULARITY == 0);
+
+    tmpdir = getenv("TMPDIR");
+    if (!tmpdir || !*tmpdir)
+        tmpdir = "/tmp";
+    path = dupcat(tmpdir, "/putty-scrollback-XXXXXX");
+
+    {
+        int oldumask = umask(077);
+        fd = mkstemp(path);
+        umask(oldumask);
+    }
+    if (fd < 0) {
+        sfree(path);
+        return NULL;
+    }
+
+    /*
+     * Unlink the file straight away, so that nobody else can open it
+     * and it disappears by itself however we terminate.
+     */
+    unlink(path);
+    sfree(path);
+    cloexec(fd);
+
+    SpillFile *sf = snew(SpillFile);
+    sf->fd = fd;
+    sf->segsize = segsize;
+    sf->nsegs = 0;
+    return sf;
+}
+
+void spillfile_free(SpillFile *sf)
+{
+    close(sf->fd);
+    sfree(sf);
+}
+
+void *spillfile_map(SpillFile *sf, size_t seg)
+{
+    void *p;
+
+    if (seg >= sf->nsegs) {
+        /* Extend the file (sparsely) so that the segment exists */
+        if (ftruncate(sf->fd, (off_t)(seg + 1) * sf->segsize) < 0)
+            return NULL;
+        sf->nsegs = seg + 1;
+    }
+
+    p = mmap(NULL, sf->segsize, PROT_READ | PROT_WRITE, MAP_SHARED,
+             sf->fd, (off_t)seg * sf->segsize);
+    return p == MAP_FAILED ? NULL : p;
+}
+
+void spillfile_unmap(SpillFile *sf, void *p)
+{
+    munmap(p, sf->segsize);
+}
@@ -0,0 +1,96 @@
+/*
+ * Unix primitives for the worker threads in worker-thread.c: a
+ * pthread mutex with a condition variable per WorkerSyncCond, and
+ * pthreads themselves.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "putty.h"
+#include "worker-thread.h"
+
+struct WorkerSync {
+    pthread_mutex_t mutex;
+    pthread_cond_t conds[WSC_COUNT];
+};
+
+WorkerSync *worker_sync_new(void)
+{
+    WorkerSync *ws = snew(WorkerSync);
+    pthread_mutex_init(&ws->mutex, NULL);
+    for (size_t i = 0; i < WSC_COUNT; i++)
+        pthread_cond_init(&ws->conds[i], NULL);
+    return ws;
+}
+
+void worker_sync_free(WorkerSync *ws)
+{
+    for (size_t i = 0; i < WSC_COUNT; i++)
+        pthread_cond_destroy(&ws->conds[i]);
+    pthread_mutex_destroy(&ws->mutex);
+    sfree(ws);
+}
+
+void worker_sync_lock(WorkerSync *ws)
+{
+    pthread_mutex_lock(&ws->mutex);
+}
+
+void worker_sync_unlock(WorkerSync *ws)
+{
+    pthread_mutex_unlock(&ws->mutex);
+}
+
+void worker_sync_wait(WorkerSync *ws, WorkerSyncCond cond)
+{
+    pthread_cond_wait(&ws->conds[cond], &ws->mutex);
+}
+
+void worker_sync_signal(WorkerSync *ws, WorkerSyncCond cond)
+{
+    pthread_cond_signal(&ws->conds[cond]);
+}
+
+struct WorkerOSThread {
+    pthread_t thread;
+    void (*fn)(void *ctx);
+    void *ctx;
+};
+
+static void *worker_os_thread_main(void *vctx)
+{
+    WorkerOSThread *t = (WorkerOSThread *)vctx;
+    t->fn(t->ctx);
+    return NULL;
+}
+
+WorkerOSThread *worker_os_thread_start(void (*fn)(void *ctx), void *ctx)
+{
+    WorkerOSThread *t = snew(WorkerOSThread);
+    t->fn = fn;
+    t->ctx = ctx;
+
+    int err = pthread_create(&t->thread, NULL, worker_os_thread_main, t);
+    if (err) {
+        fprintf(stderr, "pthread_create: %s\n", strerror(err));
+        exit(1);
+    }
+
+    return t;
+}
+
+void worker_os_thread_join(WorkerOSThread *t)
+{
+    pthread_join(t->thread, NULL);
+    sfree(t);
+}
+
+unsigned worker_thread_cpus(void)
+{
+    long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return ncpus > 1 ? ncpus : 1;
+}
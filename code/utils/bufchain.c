@@ -7,6 +7,8 @@
  *  - return a (pointer,length) pair giving some initial data in
  *    the list, suitable for passing to a send or write system
  *    call
+ *  - return an array of such pairs covering several blocks at the
+ *    start of the list, suitable for a writev or sendmsg call
  *  - retrieve a larger amount of initial data from the list
  *  - return the current size of the buffer chain in bytes
  */
@@ -125,6 +127,17 @@ ptrlen bufchain_prefix(bufchain *ch)
     return make_ptrlen(ch->head->bufpos, ch->head->bufend - ch->head->bufpos);
 }
 
+size_t bufchain_prefixes(bufchain *ch, ptrlen *vec, size_t maxvec)
+{
+    struct bufchain_granule *b;
+    size_t n = 0;
+
+    for (b = ch->head; b && n < maxvec; b = b->next)
+        vec[n++] = make_ptrlen(b->bufpos, b->bufend - b->bufpos);
+
+    return n;
+}
+
 void bufchain_fetch(bufchain *ch, void *data, size_t len)
 {
     struct bufchain_granule *tmp;
@@ -61,13 +61,38 @@ struct value {
     } u;
 };
 
+/*
+ * Entries are never modified once they're in a Conf: setting a key
+ * replaces its entry with a new one. So copies of a Conf can share
+ * entries, each of which counts the Confs referring to it. That
+ * makes copying cheap, and keeps the promise that a pointer returned
+ * by (say) conf_get_str stays valid until that key is changed or
+ * that Conf freed, whatever happens to other copies of it.
+ *
+ * (The reference counts aren't atomic, so Confs sharing entries must
+ * only be used from one thread.)
+ */
 struct conf_entry {
     struct key key;
     struct value value;
+    int refcount;
 };
 
-struct conf_tag {
+/*
+ * Keys without a subkey are kept in an array indexed by the primary
+ * key, so that reading one is a single lookup. Keys with subkeys are
+ * kept in a tree234, sorted by primary and then secondary key, which
+ * is itself shared between copies of a Conf until one of them
+ * changes a subkeyed entry.
+ */
+struct conf_tree {
     tree234 *tree;
+    int refcount;
+};
+
+struct conf_tag {
+    struct conf_entry *flat[N_CONFIG_OPTIONS];
+    struct conf_tree *sub;
 };
 
 /*
@@ -135,23 +160,6 @@ static void free_key(struct key *key)
         sfree(key->secondary.s);
 }
 
-/*
- * Copy a 'struct key' into another one, copying its dynamic data
- * if necessary.
- */
-static void copy_key(struct key *to, struct key *from)
-{
-    to->primary = from->primary;
-    switch (subkeytypes[to->primary]) {
-      case TYPE_INT:
-        to->secondary.i = from->secondary.i;
-        break;
-      case TYPE_STR:
-        to->secondary.s = dupstr(from->secondary.s);
-        break;
-    }
-}
-
 /*
  * Free any dynamic data items pointed to by a 'struct value'. We
  * don't free the value itself, since it's probably part of a larger
@@ -167,31 +175,6 @@ static void free_value(struct value *val, int type)
         fontspec_free(val->u.fontval);
 }
 
-/*
- * Copy a 'struct value' into another one, copying its dynamic data
- * if necessary.
- */
-static void copy_value(struct value *to, struct value *from, int type)
-{
-    switch (type) {
-      case TYPE_BOOL:
-        to->u.boolval = from->u.boolval;
-        break;
-      case TYPE_INT:
-        to->u.intval = from->u.intval;
-        break;
-      case TYPE_STR:
-        to->u.stringval = dupstr(from->u.stringval);
-        break;
-      case TYPE_FILENAME:
-        to->u.fileval = filename_copy(from->u.fileval);
-        break;
-      case TYPE_FONT:
-        to->u.fontval = fontspec_copy(from->u.fontval);
-        break;
-    }
-}
-
 /*
  * Free an entire 'struct conf_entry' and its dynamic data.
  */
@@ -202,55 +185,143 @@ static void free_entry(struct conf_entry *entry)
     sfree(entry);
 }
 
+/*
+ * Allocate a new 'struct conf_entry', with one reference, to be
+ * filled in by the caller.
+ */
+static struct conf_entry *new_entry(int primary)
+{
+    struct conf_entry *entry = snew(struct conf_entry);
+    entry->key.primary = primary;
+    entry->refcount = 1;
+    return entry;
+}
+
+static struct conf_entry *entry_ref(struct conf_entry *entry)
+{
+    entry->refcount++;
+    return entry;
+}
+
+static void entry_unref(struct conf_entry *entry)
+{
+    if (--entry->refcount == 0)
+        free_entry(entry);
+}
+
+static struct conf_tree *conf_tree_new(void)
+{
+    struct conf_tree *ct = snew(struct conf_tree);
+    ct->tree = newtree234(conf_cmp);
+    ct->refcount = 1;
+    return ct;
+}
+
+static void conf_tree_unref(struct conf_tree *ct)
+{
+    struct conf_entry *entry;
+
+    if (--ct->refcount > 0)
+        return;
+
+    while ((entry = delpos234(ct->tree, 0)) != NULL)
+        entry_unref(entry);
+    freetree234(ct->tree);
+    sfree(ct);
+}
+
+/*
+ * Return the tree of subkeyed entries of a Conf, ready to be
+ * modified: if it's shared with other Confs, make this one a copy of
+ * its own (which shares the entries, but not the tree).
+ */
+static tree234 *conf_tree_writable(Conf *conf)
+{
+    if (conf->sub->refcount > 1) {
+        struct conf_tree *ct = conf_tree_new();
+        struct conf_entry *entry;
+        int i;
+
+        for (i = 0; (entry = index234(conf->sub->tree, i)) != NULL; i++)
+            add234(ct->tree, entry_ref(entry));
+        conf_tree_unref(conf->sub);
+        conf->sub = ct;
+    }
+    return conf->sub->tree;
+}
+
 Conf *conf_new(void)
 {
     Conf *conf = snew(struct conf_tag);
+    int i;
 
-    conf->tree = newtree234(conf_cmp);
+    for (i = 0; i < N_CONFIG_OPTIONS; i++)
+        conf->flat[i] = NULL;
+    conf->sub = conf_tree_new();
 
     return conf;
 }
 
-static void conf_clear(Conf *conf)
+static void conf_clear_flat(Conf *conf)
 {
-    struct conf_entry *entry;
+    int i;
 
-    while ((entry = delpos234(conf->tree, 0)) != NULL)
-        free_entry(entry);
+    for (i = 0; i < N_CONFIG_OPTIONS; i++) {
+        if (conf->flat[i]) {
+            entry_unref(conf->flat[i]);
+            conf->flat[i] = NULL;
+        }
+    }
 }
 
 void conf_free(Conf *conf)
 {
-    conf_clear(conf);
-    freetree234(conf->tree);
+    conf_clear_flat(conf);
+    conf_tree_unref(conf->sub);
     sfree(conf);
 }
 
+/*
+ * Put an entry into a Conf, replacing any existing entry with the
+ * same key. The Conf takes over the caller's reference.
+ */
 static void conf_insert(Conf *conf, struct conf_entry *entry)
 {
-    struct conf_entry *oldentry = add234(conf->tree, entry);
+    struct conf_entry *oldentry;
+
+    if (subkeytypes[entry->key.primary] == TYPE_NONE) {
+        oldentry = conf->flat[entry->key.primary];
+        conf->flat[entry->key.primary] = entry;
+        if (oldentry)
+            entry_unref(oldentry);
+        return;
+    }
+
+    tree234 *tree = conf_tree_writable(conf);
+    oldentry = add234(tree, entry);
     if (oldentry && oldentry != entry) {
-        del234(conf->tree, oldentry);
-        free_entry(oldentry);
-        oldentry = add234(conf->tree, entry);
+        del234(tree, oldentry);
+        entry_unref(oldentry);
+        oldentry = add234(tree, entry);
         assert(oldentry == entry);
     }
 }
 
 void conf_copy_into(Conf *newconf, Conf *oldconf)
 {
-    struct conf_entry *entry, *entry2;
     int i;
 
-    conf_clear(newconf);
+    if (newconf == oldconf)
+        return;
 
-    for (i = 0; (entry = index234(oldconf->tree, i)) != NULL; i++) {
-        entry2 = snew(struct conf_entry);
-        copy_key(&entry2->key, &entry->key);
-        copy_value(&entry2->value, &entry->value,
-                   valuetypes[entry->key.primary]);
-        add234(newconf->tree, entry2);
-    }
+    conf_clear_flat(newconf);
+    for (i = 0; i < N_CONFIG_OPTIONS; i++)
+        if (oldconf->flat[i])
+            newconf->flat[i] = entry_ref(oldconf->flat[i]);
+
+    oldconf->sub->refcount++;
+    conf_tree_unref(newconf->sub);
+    newconf->sub = oldconf->sub;
 }
 
 Conf *conf_copy(Conf *oldconf)
@@ -264,26 +335,22 @@ Conf *conf_copy(Conf *oldconf)
 
 bool conf_get_bool(Conf *conf, int primary)
 {
-    struct key key;
     struct conf_entry *entry;
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_BOOL);
-    key.primary = primary;
-    entry = find234(conf->tree, &key, NULL);
+    entry = conf->flat[primary];
     assert(entry);
     return entry->value.u.boolval;
 }
 
 int conf_get_int(Conf *conf, int primary)
 {
-    struct key key;
     struct conf_entry *entry;
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_INT);
-    key.primary = primary;
-    entry = find234(conf->tree, &key, NULL);
+    entry = conf->flat[primary];
     assert(entry);
     return entry->value.u.intval;
 }
@@ -297,20 +364,18 @@ int conf_get_int_int(Conf *conf, int primary, int secondary)
     assert(valuetypes[primary] == TYPE_INT);
     key.primary = primary;
     key.secondary.i = secondary;
-    entry = find234(conf->tree, &key, NULL);
+    entry = find234(conf->sub->tree, &key, NULL);
     assert(entry);
     return entry->value.u.intval;
 }
 
 char *conf_get_str(Conf *conf, int primary)
 {
-    struct key key;
     struct conf_entry *entry;
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_STR);
-    key.primary = primary;
-    entry = find234(conf->tree, &key, NULL);
+    entry = conf->flat[primary];
     assert(entry);
     return entry->value.u.stringval;
 }
@@ -324,7 +389,7 @@ char *conf_get_str_str_opt(Conf *conf, int primary, const char *secondary)
     assert(valuetypes[primary] == TYPE_STR);
     key.primary = primary;
     key.secondary.s = (char *)secondary;
-    entry = find234(conf->tree, &key, NULL);
+    entry = find234(conf->sub->tree, &key, NULL);
     return entry ? entry->value.u.stringval : NULL;
 }
 
@@ -346,10 +411,11 @@ char *conf_get_str_strs(Conf *conf, int primary,
     key.primary = primary;
     if (subkeyin) {
         key.secondary.s = subkeyin;
-        entry = findrel234(conf->tree, &key, NULL, REL234_GT);
+        entry = findrel234(conf->sub->tree, &key, NULL, REL234_GT);
     } else {
         key.secondary.s = "";
-        entry = findrel234(conf->tree, &key, conf_cmp_constkey, REL234_GE);
+        entry = findrel234(conf->sub->tree, &key, conf_cmp_constkey,
+                           REL234_GE);
     }
     if (!entry || entry->key.primary != primary)
         return NULL;
@@ -367,11 +433,11 @@ char *conf_get_str_nthstrkey(Conf *conf, int primary, int n)
     assert(valuetypes[primary] == TYPE_STR);
     key.primary = primary;
     key.secondary.s = "";
-    entry = findrelpos234(conf->tree, &key, conf_cmp_constkey,
+    entry = findrelpos234(conf->sub->tree, &key, conf_cmp_constkey,
                           REL234_GE, &index);
     if (!entry || entry->key.primary != primary)
         return NULL;
-    entry = index234(conf->tree, index + n);
+    entry = index234(conf->sub->tree, index + n);
     if (!entry || entry->key.primary != primary)
         return NULL;
     return entry->key.secondary.s;
@@ -379,48 +445,42 @@ char *conf_get_str_nthstrkey(Conf *conf, int primary, int n)
 
 Filename *conf_get_filename(Conf *conf, int primary)
 {
-    struct key key;
     struct conf_entry *entry;
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_FILENAME);
-    key.primary = primary;
-    entry = find234(conf->tree, &key, NULL);
+    entry = conf->flat[primary];
     assert(entry);
     return entry->value.u.fileval;
 }
 
 FontSpec *conf_get_fontspec(Conf *conf, int primary)
 {
-    struct key key;
     struct conf_entry *entry;
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_FONT);
-    key.primary = primary;
-    entry = find234(conf->tree, &key, NULL);
+    entry = conf->flat[primary];
     assert(entry);
     return entry->value.u.fontval;
 }
 
 void conf_set_bool(Conf *conf, int primary, bool value)
 {
-    struct conf_entry *entry = snew(struct conf_entry);
+    struct conf_entry *entry = new_entry(primary);
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_BOOL);
-    entry->key.primary = primary;
     entry->value.u.boolval = value;
     conf_insert(conf, entry);
 }
 
 void conf_set_int(Conf *conf, int primary, int value)
 {
-    struct conf_entry *entry = snew(struct conf_entry);
+    struct conf_entry *entry = new_entry(primary);
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_INT);
-    entry->key.primary = primary;
     entry->value.u.intval = value;
     conf_insert(conf, entry);
 }
@@ -428,11 +488,10 @@ void conf_set_int(Conf *conf, int primary, int value)
 void conf_set_int_int(Conf *conf, int primary,
                       int secondary, int value)
 {
-    struct conf_entry *entry = snew(struct conf_entry);
+    struct conf_entry *entry = new_entry(primary);
 
     assert(subkeytypes[primary] == TYPE_INT);
     assert(valuetypes[primary] == TYPE_INT);
-    entry->key.primary = primary;
     entry->key.secondary.i = secondary;
     entry->value.u.intval = value;
     conf_insert(conf, entry);
@@ -440,11 +499,10 @@ void conf_set_int_int(Conf *conf, int primary,
 
 void conf_set_str(Conf *conf, int primary, const char *value)
 {
-    struct conf_entry *entry = snew(struct conf_entry);
+    struct conf_entry *entry = new_entry(primary);
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_STR);
-    entry->key.primary = primary;
     entry->value.u.stringval = dupstr(value);
     conf_insert(conf, entry);
 }
@@ -452,11 +510,10 @@ void conf_set_str(Conf *conf, int primary, const char *value)
 void conf_set_str_str(Conf *conf, int primary, const char *secondary,
                       const char *value)
 {
-    struct conf_entry *entry = snew(struct conf_entry);
+    struct conf_entry *entry = new_entry(primary);
 
     assert(subkeytypes[primary] == TYPE_STR);
     assert(valuetypes[primary] == TYPE_STR);
-    entry->key.primary = primary;
     entry->key.secondary.s = dupstr(secondary);
     entry->value.u.stringval = dupstr(value);
     conf_insert(conf, entry);
@@ -471,67 +528,79 @@ void conf_del_str_str(Conf *conf, int primary, const char *secondary)
     assert(valuetypes[primary] == TYPE_STR);
     key.primary = primary;
     key.secondary.s = (char *)secondary;
-    entry = find234(conf->tree, &key, NULL);
+    entry = find234(conf->sub->tree, &key, NULL);
     if (entry) {
-        del234(conf->tree, entry);
-        free_entry(entry);
+        del234(conf_tree_writable(conf), entry);
+        entry_unref(entry);
     }
 }
 
 void conf_set_filename(Conf *conf, int primary, const Filename *value)
 {
-    struct conf_entry *entry = snew(struct conf_entry);
+    struct conf_entry *entry = new_entry(primary);
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_FILENAME);
-    entry->key.primary = primary;
     entry->value.u.fileval = filename_copy(value);
     conf_insert(conf, entry);
 }
 
 void conf_set_fontspec(Conf *conf, int primary, const FontSpec *value)
 {
-    struct conf_entry *entry = snew(struct conf_entry);
+    struct conf_entry *entry = new_entry(primary);
 
     assert(subkeytypes[primary] == TYPE_NONE);
     assert(valuetypes[primary] == TYPE_FONT);
-    entry->key.primary = primary;
     entry->value.u.fontval = fontspec_copy(value);
     conf_insert(conf, entry);
 }
 
-void conf_serialise(BinarySink *bs, Conf *conf)
+static void conf_serialise_entry(BinarySink *bs, struct conf_entry *entry)
 {
-    int i;
-    struct conf_entry *entry;
+    put_uint32(bs, entry->key.primary);
 
-    for (i = 0; (entry = index234(conf->tree, i)) != NULL; i++) {
-        put_uint32(bs, entry->key.primary);
+    switch (subkeytypes[entry->key.primary]) {
+      case TYPE_INT:
+        put_uint32(bs, entry->key.secondary.i);
+        break;
+      case TYPE_STR:
+        put_asciz(bs, entry->key.secondary.s);
+        break;
+    }
+    switch (valuetypes[entry->key.primary]) {
+      case TYPE_BOOL:
+        put_bool(bs, entry->value.u.boolval);
+        break;
+      case TYPE_INT:
+        put_uint32(bs, entry->value.u.intval);
+        break;
+      case TYPE_STR:
+        put_asciz(bs, entry->value.u.stringval);
+        break;
+      case TYPE_FILENAME:
+        filename_serialise(bs, entry->value.u.fileval);
+        break;
+      case TYPE_FONT:
+        fontspec_serialise(bs, entry->value.u.fontval);
+        break;
+    }
+}
 
-        switch (subkeytypes[entry->key.primary]) {
-          case TYPE_INT:
-            put_uint32(bs, entry->key.secondary.i);
-            break;
-          case TYPE_STR:
-            put_asciz(bs, entry->key.secondary.s);
-            break;
-        }
-        switch (valuetypes[entry->key.primary]) {
-          case TYPE_BOOL:
-            put_bool(bs, entry->value.u.boolval);
-            break;
-          case TYPE_INT:
-            put_uint32(bs, entry->value.u.intval);
-            break;
-          case TYPE_STR:
-            put_asciz(bs, entry->value.u.stringval);
-            break;
-          case TYPE_FILENAME:
-            filename_serialise(bs, entry->value.u.fileval);
-            break;
-          case TYPE_FONT:
-            fontspec_serialise(bs, entry->value.u.fontval);
-            break;
+void conf_serialise(BinarySink *bs, Conf *conf)
+{
+    int primary, i = 0;
+    struct conf_entry *entry = index234(conf->sub->tree, 0);
+
+    /* Write the entries in key order, merging the array and the tree */
+    for (primary = 0; primary < N_CONFIG_OPTIONS; primary++) {
+        if (subkeytypes[primary] == TYPE_NONE) {
+            if (conf->flat[primary])
+                conf_serialise_entry(bs, conf->flat[primary]);
+        } else {
+            while (entry && entry->key.primary == primary) {
+                conf_serialise_entry(bs, entry);
+                entry = index234(conf->sub->tree, ++i);
+            }
         }
     }
 
@@ -553,8 +622,7 @@ bool conf_deserialise(Conf *conf, BinarySource *src)
         if (primary >= N_CONFIG_OPTIONS)
             return false;
 
-        entry = snew(struct conf_entry);
-        entry->key.primary = primary;
+        entry = new_entry(primary);
 
         switch (subkeytypes[entry->key.primary]) {
           case TYPE_INT:
@@ -0,0 +1,226 @@
+#!/usr/bin/env perl
+
+# This script generates constant-time lookup tables for the Unicode
+# character properties used by the terminal, from the sorted tables
+# in the C source files that define them.
+#
+# Those source tables are the master copy of the data: they're kept
+# in the form the Unicode Character Database presents it, and the
+# code that searched them directly is still compiled into the test
+# programs, to check the generated tables against. This script reads
+# them straight out of the C.
+#
+# The build runs this script when Perl is available. Otherwise it uses
+# the copies of its output in the unicode directory, so after changing
+# the source tables, regenerate those too:
+#
+#   perl utils/mkunitab.pl --wcwidth -o unicode/wcwidth_tables.h utils/wcwidth.c
+#   perl utils/mkunitab.pl --bidi -o unicode/bidi_tables.h terminal/bidi.c
+#
+# Each property becomes a three-level table. The code space is divided
+# into blocks of 2^SHIFT characters, and blocks with identical
+# contents are stored only once. The resulting list of block numbers
+# is compressed the same way, in blocks of 2^MSHIFT, and a top-level
+# index maps each of those to one of the stored index blocks. The two
+# shifts are chosen to make the whole thing as small as possible.
+
+use warnings;
+use Getopt::Long;
+
+my $outfile = undef;
+my $usage = "usage: mkunitab.pl (--bidi | --wcwidth) -o OUTFILE INFILE\n";
+my ($bidi, $wcwidth);
+GetOptions("o|output=s" => \$outfile,
+           "bidi" => \$bidi,
+           "wcwidth" => \$wcwidth)
+    or die $usage;
+die $usage unless defined $outfile and @ARGV == 1 and
+    (defined $bidi) != (defined $wcwidth);
+my $infile = $ARGV[0];
+
+my $NCHARS = 0x110000;
+
+open my $in, "<", $infile or die "$infile: open: $!\n";
+my $source = do { local $/; <$in> };
+close $in;
+
+open my $out, ">", $outfile or die "$outfile: open: $!\n";
+select $out;
+
+print "/*\n";
+print " * Unicode property lookup tables.\n";
+print " *\n";
+print " * Generated by mkunitab.pl from the tables in $1.\n"
+    if $infile =~ m!([^/\\]+/[^/\\]+)$!;
+print " * You should edit that file rather than editing this one.\n";
+print " */\n";
+print "\n";
+
+if ($bidi) {
+    # Bidi character class. Characters missing from the source table
+    # are class ON.
+    my @vals = ("ON") x $NCHARS;
+    foreach my $row (&table("lookup")) {
+        $row =~ /^\s*(0x[0-9a-f]+),\s*(0x[0-9a-f]+),\s*(\w+)\s*$/i
+            or die "$infile: bad row in 'lookup': {$row}\n";
+        @vals[hex $1 .. hex $2] = ($3) x (hex($2) - hex($1) + 1);
+    }
+    &outtable("bidi_type", "uint8_t", \@vals);
+
+    # Mirrored glyphs, stored as the offset from the input character
+    # to its mirror image, so that characters with no mirror image
+    # have offset 0.
+    @vals = (0) x $NCHARS;
+    foreach my $row (&table("mirror_pairs")) {
+        $row =~ /^\s*(0x[0-9a-f]+),\s*(0x[0-9a-f]+)\s*$/i
+            or die "$infile: bad row in 'mirror_pairs': {$row}\n";
+        $vals[hex $1] = hex($2) - hex($1);
+    }
+    &outtable("bidi_mirror", "int16_t", \@vals);
+
+    # Paired brackets, stored as 1 + the index of the character's
+    # entry in bracket_pairs[], or 0 for characters not listed there.
+    @vals = (0) x $NCHARS;
+    my $index = 0;
+    foreach my $row (&table("bracket_pairs")) {
+        $row =~ /^\s*(0x[0-9a-f]+),\s*\{/i
+            or die "$infile: bad row in 'bracket_pairs': {$row}\n";
+        $vals[hex $1] = ++$index;
+    }
+    die "$infile: too many entries in 'bracket_pairs'\n" if $index > 255;
+    &outtable("bidi_bracket", "uint8_t", \@vals);
+} else {
+    # Character width classes, as a bit mask of the tables in
+    # wcwidth.c that the character appears in.
+    my @vals = (0) x $NCHARS;
+    my %bits = (combining => "WCW_COMBINING",
+                wide => "WCW_WIDE",
+                ambiguous => "WCW_AMBIGUOUS");
+    foreach my $name (sort keys %bits) {
+        foreach my $row (&table($name)) {
+            $row =~ /^\s*(0x[0-9a-f]+),\s*(0x[0-9a-f]+)\s*$/i
+                or die "$infile: bad row in '$name': {$row}\n";
+            for (my $c = hex $1; $c <= hex $2; $c++) {
+                $vals[$c] = $vals[$c] ? "$vals[$c]|$bits{$name}"
+                    : $bits{$name};
+            }
+        }
+    }
+    &outtable("wcwidth_class", "uint8_t", \@vals);
+}
+
+close $out;
+
+# Return the rows of the named static array in the source file, each
+# with its outer braces removed.
+sub table($) {
+    my ($name) = @_;
+    $source =~ /\b\Q$name\E\[\]\s*=\s*\{\n(.*?)\n\s*\};/s
+        or die "$infile: can't find table '$name'\n";
+    my $body = $1;
+    my @rows = ();
+    foreach my $line (split /\n/, $body) {
+        next unless $line =~ /^\s*\{(.*)\},\s*$/;
+        push @rows, $1;
+    }
+    die "$infile: table '$name' is empty\n" unless @rows;
+    return @rows;
+}
+
+sub outtable($$$) {
+    my ($name, $type, $vals) = @_;
+    my $NAME = uc $name;
+    my $vsize = ($type =~ /16/ ? 2 : 1);
+
+    # Try every sensible pair of block sizes, and keep the smallest
+    # result.
+    my ($best, $bestsize);
+    for (my $shift = 4; $shift <= 8; $shift++) {
+        my ($index, $blocks) = &dedup($vals, 1 << $shift);
+        my $indexsize = (@$blocks <= 256 ? 1 : 2);
+        for (my $mshift = 2; $shift + $mshift <= 14; $mshift++) {
+            my ($top, $mids) = &dedup($index, 1 << $mshift);
+            next if @$mids > 256;
+            my $size = (@$top + @$mids * (1 << $mshift) * $indexsize +
+                        @$blocks * (1 << $shift) * $vsize);
+            if (!defined $bestsize or $size < $bestsize) {
+                $bestsize = $size;
+                $best = [$shift, $mshift, $indexsize, $top, $mids, $blocks];
+            }
+        }
+    }
+    my ($shift, $mshift, $indexsize, $top, $mids, $blocks) = @$best;
+    my $midtype = ($indexsize == 1 ? "uint8_t" : "uint16_t");
+
+    printf "/* %s: %d blocks of %d, %d index blocks of %d, %d bytes */\n",
+        $name, scalar @$blocks, 1 << $shift, scalar @$mids, 1 << $mshift,
+        $bestsize;
+    print "#define ${NAME}_SHIFT $shift\n";
+    print "#define ${NAME}_MSHIFT $mshift\n";
+    printf "static const uint8_t %s_top[%d] = {\n", $name, scalar @$top;
+    &outlist($top);
+    print "};\n";
+    print "static const $midtype ${name}_mid[][1 << ${NAME}_MSHIFT] = {\n";
+    &outblocks($mids);
+    print "};\n";
+    print "static const $type ${name}_blocks[][1 << ${NAME}_SHIFT] = {\n";
+    &outblocks($blocks);
+    print "};\n";
+    print "static inline $type ${name}_lookup(unsigned c)\n";
+    print "{\n";
+    print "    unsigned mid = ${name}_top[\n";
+    print "        c >> (${NAME}_SHIFT + ${NAME}_MSHIFT)];\n";
+    print "    unsigned block = ${name}_mid[mid][\n";
+    print "        (c >> ${NAME}_SHIFT) & ((1 << ${NAME}_MSHIFT) - 1)];\n";
+    print "    return ${name}_blocks[block][\n";
+    print "        c & ((1 << ${NAME}_SHIFT) - 1)];\n";
+    print "}\n";
+    print "\n";
+}
+
+# Divide a list into blocks of the given size, and return a list of
+# the distinct blocks, and an index giving the block number for each
+# position in the original list.
+sub dedup($$) {
+    my ($list, $blocksize) = @_;
+    my (%blocknum, @blocks, @index);
+    for (my $start = 0; $start < @$list; $start += $blocksize) {
+        my $end = $start + $blocksize - 1;
+        $end = $#$list if $end > $#$list;
+        my @block = @$list[$start .. $end];
+        push @block, $block[-1] while @block < $blocksize;
+        my $key = join ",", @block;
+        if (!defined $blocknum{$key}) {
+            $blocknum{$key} = scalar @blocks;
+            push @blocks, \@block;
+        }
+        push @index, $blocknum{$key};
+    }
+    return (\@index, \@blocks);
+}
+
+sub outblocks($) {
+    my ($blocks) = @_;
+    foreach my $block (@$blocks) {
+        print "    {\n";
+        &outlist($block, "    ");
+        print "    },\n";
+    }
+}
+
+# Print a comma-separated list, filling lines up to 80 columns.
+sub outlist($;$) {
+    my ($list, $indent) = @_;
+    $indent = "    " . (defined $indent ? $indent : "");
+    my $line = $indent;
+    foreach my $item (@$list) {
+        if (length($line) + length($item) + 1 >= 80 and $line ne $indent) {
+            $line =~ s/ $//;
+            print "$line\n";
+            $line = $indent;
+        }
+        $line .= "$item, ";
+    }
+    $line =~ s/ $//;
+    print "$line\n" if $line ne $indent;
+}
@@ -1065,6 +1065,7 @@ void *del234(tree234 *t, void *e)
 
 #include <stdarg.h>
 #include <string.h>
+#include <time.h>
 
 int n_errors = 0;
 
@@ -1090,7 +1091,60 @@ cmpfn234 cmp;
 /* The tree representation of the same data. */
 tree234 *tree;
 
+/*
+ * Everything is tested against both this 2-3-4 tree and the B+-tree
+ * in tree234wide.c, which is linked into the test program with its
+ * entry points renamed to begin with 'wide_'.
+ */
+tree234 *wide_newtree234(cmpfn234 cmp);
+void wide_freetree234(tree234 *t);
+void *wide_add234(tree234 *t, void *e);
+void *wide_addpos234(tree234 *t, void *e, int index);
+void *wide_index234(tree234 *t, int index);
+void *wide_findrelpos234(tree234 *t, void *e, cmpfn234 cmp,
+                         int relation, int *index);
+void wide_search234_start(search234_state *state, tree234 *t);
+void wide_search234_step(search234_state *state, int direction);
+void *wide_del234(tree234 *t, void *e);
+void *wide_delpos234(tree234 *t, int index);
+int wide_count234(tree234 *t);
+int wide_chktree234(tree234 *t, cmpfn234 cmp, int *depth);
+
+typedef struct {
+    const char *name;
+    tree234 *(*newtree)(cmpfn234 cmp);
+    void (*freetree)(tree234 *t);
+    void *(*add)(tree234 *t, void *e);
+    void *(*addpos)(tree234 *t, void *e, int index);
+    void *(*index)(tree234 *t, int index);
+    void *(*findrelpos)(tree234 *t, void *e, cmpfn234 cmp,
+                        int relation, int *index);
+    void (*search_start)(search234_state *state, tree234 *t);
+    void (*search_step)(search234_state *state, int direction);
+    void *(*del)(tree234 *t, void *e);
+    void *(*delpos)(tree234 *t, int index);
+    int (*count)(tree234 *t);
+    /* check the tree structure, returning its element count */
+    int (*check)(tree234 *t, cmpfn234 cmp, int *depth);
+} treeimpl;
+
+int chktree(tree234 *t, cmpfn234 cmp, int *depth);
+
+const treeimpl impls[] = {
+    {"2-3-4", newtree234, freetree234, add234, addpos234, index234,
+     findrelpos234, search234_start, search234_step, del234, delpos234,
+     count234, chktree},
+    {"wide", wide_newtree234, wide_freetree234, wide_add234, wide_addpos234,
+     wide_index234, wide_findrelpos234, wide_search234_start,
+     wide_search234_step, wide_del234, wide_delpos234, wide_count234,
+     wide_chktree234},
+};
+
+/* The implementation currently under test. */
+const treeimpl *impl;
+
 typedef struct {
+    cmpfn234 cmp;
     int treedepth;
     int elemcount;
 } chkctx;
@@ -1165,12 +1219,12 @@ int chknode(chkctx *ctx, int level, node234 *node,
      * - both NULL at root node - and NULL is considered to be <
      * everything and > everything. IYSWIM.)
      */
-    if (cmp) {
+    if (ctx->cmp) {
         for (i = -1; i < nelems; i++) {
             void *lower = (i == -1 ? lowbound : node->elems[i]);
             void *higher =
                 (i + 1 == nelems ? highbound : node->elems[i + 1]);
-            if (lower && higher && cmp(lower, higher) >= 0) {
+            if (lower && higher && ctx->cmp(lower, higher) >= 0) {
                 error("node %p: kid comparison [%d=%s,%d=%s] failed",
                       node, i, (char *)lower, i + 1, (char *)higher);
             }
@@ -1208,45 +1262,54 @@ int chknode(chkctx *ctx, int level, node234 *node,
     return count;
 }
 
-void verify(void)
+int chktree(tree234 *t, cmpfn234 cmp, int *depth)
 {
     chkctx ctx[1];
-    int i;
-    void *p;
 
+    ctx->cmp = cmp;
     ctx->treedepth = -1;                /* depth unknown yet */
     ctx->elemcount = 0;                 /* no elements seen yet */
+    if (t->root) {
+        if (t->root->parent != NULL)
+            error("root->parent is %p should be null", t->root->parent);
+        chknode(ctx, 0, t->root, NULL, NULL);
+    }
+    *depth = ctx->treedepth;
+    return ctx->elemcount;
+}
+
+void verify(void)
+{
+    int i, elemcount, depth;
+    void *p;
+
     /*
      * Verify validity of tree properties.
      */
-    if (tree->root) {
-        if (tree->root->parent != NULL)
-            error("root->parent is %p should be null", tree->root->parent);
-        chknode(ctx, 0, tree->root, NULL, NULL);
-    }
+    elemcount = impl->check(tree, cmp, &depth);
     if (verbose)
-        printf("tree depth: %d\n", ctx->treedepth);
+        printf("tree depth: %d\n", depth);
     /*
      * Enumerate the tree and ensure it matches up to the array.
      */
-    for (i = 0; NULL != (p = index234(tree, i)); i++) {
+    for (i = 0; NULL != (p = impl->index(tree, i)); i++) {
         if (i >= arraylen)
             error("tree contains more than %d elements", arraylen);
         if (array[i] != p)
             error("enum at position %d: array says %s, tree says %s",
                   i, (char *)array[i], (char *)p);
     }
-    if (ctx->elemcount != i) {
+    if (elemcount != i) {
         error("tree really contains %d elements, enum gave %d",
-              ctx->elemcount, i);
+              elemcount, i);
     }
     if (i < arraylen) {
         error("enum gave only %d elements, array has %d", i, arraylen);
     }
-    i = count234(tree);
-    if (ctx->elemcount != i) {
+    i = impl->count(tree);
+    if (elemcount != i) {
         error("tree really contains %d elements, count234 gave %d",
-              ctx->elemcount, i);
+              elemcount, i);
     }
 }
 
@@ -1280,7 +1343,7 @@ void addtest(void *elem)
     int i;
     void *realret;
 
-    realret = add234(tree, elem);
+    realret = impl->add(tree, elem);
 
     i = 0;
     while (i < arraylen && cmp(elem, array[i]) > 0)
@@ -1298,7 +1361,7 @@ void addpostest(void *elem, int i)
 {
     void *realret;
 
-    realret = addpos234(tree, elem, i);
+    realret = impl->addpos(tree, elem, i);
 
     internal_addtest(elem, i, realret);
 }
@@ -1315,10 +1378,10 @@ void delpostest(int i)
     }
     arraylen--;                        /* delete elem from array */
 
-    if (tree->cmp)
-        ret = del234(tree, elem);
+    if (cmp)
+        ret = impl->del(tree, elem);
     else
-        ret = delpos234(tree, index);
+        ret = impl->delpos(tree, index);
 
     if (ret != elem) {
         error("del returned %p, expected %p", ret, elem);
@@ -1379,7 +1442,7 @@ char *strings[] = {
 
 #define NSTR lenof(strings)
 
-void findtest(void)
+void findtest(char **pool, int npool)
 {
     const static int rels[] = {
         REL234_EQ, REL234_GE, REL234_LE, REL234_LT, REL234_GT
@@ -1391,8 +1454,8 @@ void findtest(void)
     char *p, *ret, *realret, *realret2;
     int lo, hi, mid, c;
 
-    for (i = 0; i < NSTR; i++) {
-        p = strings[i];
+    for (i = 0; i < npool; i++) {
+        p = pool[i];
         for (j = 0; j < sizeof(rels) / sizeof(*rels); j++) {
             rel = rels[j];
 
@@ -1428,7 +1491,7 @@ void findtest(void)
                     ret = NULL;
             }
 
-            realret = findrelpos234(tree, p, NULL, rel, &index);
+            realret = impl->findrelpos(tree, p, NULL, rel, &index);
             if (realret != ret) {
                 error("find(\"%s\",%s) gave %s should be %s",
                       p, relnames[j], realret, ret);
@@ -1438,7 +1501,7 @@ void findtest(void)
                       p, relnames[j], index, mid);
             }
             if (realret && rel == REL234_EQ) {
-                realret2 = index234(tree, index);
+                realret2 = impl->index(tree, index);
                 if (realret2 != realret) {
                     error("find(\"%s\",%s) gave %s(%d) but %d -> %s",
                           p, relnames[j], realret, index, index, realret2);
@@ -1450,7 +1513,7 @@ void findtest(void)
         }
     }
 
-    realret = findrelpos234(tree, NULL, NULL, REL234_GT, &index);
+    realret = impl->findrelpos(tree, NULL, NULL, REL234_GT, &index);
     if (arraylen && (realret != array[0] || index != 0)) {
         error("find(NULL,GT) gave %s(%d) should be %s(0)",
               realret, index, (char *)array[0]);
@@ -1458,7 +1521,7 @@ void findtest(void)
         error("find(NULL,GT) gave %s(%d) should be NULL", realret, index);
     }
 
-    realret = findrelpos234(tree, NULL, NULL, REL234_LT, &index);
+    realret = impl->findrelpos(tree, NULL, NULL, REL234_LT, &index);
     if (arraylen
         && (realret != array[arraylen - 1] || index != arraylen - 1)) {
         error("find(NULL,LT) gave %s(%d) should be %s(0)", realret, index,
@@ -1506,13 +1569,13 @@ void searchtest_recurse(search234_state ss, int lo, int hi,
                    (char *)ss.element, ss.index);
 
         next = ss;
-        search234_step(&next, -1);
+        impl->search_step(&next, -1);
         *directionptr = '-';
         searchtest_recurse(next, lo, ss.index,
                            expected, directionbuf, directionptr+1);
 
         next = ss;
-        search234_step(&next, +1);
+        impl->search_step(&next, +1);
         *directionptr = '+';
         searchtest_recurse(next, ss.index+1, hi,
                            expected, directionbuf, directionptr+1);
@@ -1521,14 +1584,16 @@ void searchtest_recurse(search234_state ss, int lo, int hi,
 
 void searchtest(void)
 {
-    char *expected[NSTR], *p;
+    char **expected, *p;
     char directionbuf[NSTR * 10];
     int n;
     search234_state ss;
 
+    expected = snewn(impl->count(tree) + 1, char *);
+
     if (verbose)
         printf("beginning searchtest:");
-    for (n = 0; (p = index234(tree, n)) != NULL; n++) {
+    for (n = 0; (p = impl->index(tree, n)) != NULL; n++) {
         expected[n] = p;
         if (verbose)
             printf(" %d=%s", n, p);
@@ -1536,8 +1601,9 @@ void searchtest(void)
     if (verbose)
         printf(" count=%d\n", n);
 
-    search234_start(&ss, tree);
+    impl->search_start(&ss, tree);
     searchtest_recurse(ss, 0, n, expected, directionbuf, directionbuf);
+    sfree(expected);
 }
 
 void out_of_memory(void)
@@ -1546,91 +1612,268 @@ void out_of_memory(void)
     exit(2);
 }
 
-int main(int argc, char **argv)
-{
-    int in[NSTR];
-    int i, j, k;
-    unsigned seed = 0;
 
-    for (i = 1; i < argc; i++) {
-        char *arg = argv[i];
-        if (!strcmp(arg, "-v")) {
-            verbose++;
-        } else {
-            fprintf(stderr, "unrecognised option '%s'\n", arg);
-            return 1;
-        }
-    }
+/*
+ * Add and delete strings from a pool at random in a sorted tree,
+ * verifying the tree after every operation, and running the find and
+ * search tests every 'checkevery' operations.
+ */
+void sortedtest(char **pool, int npool, int ntrials, int checkevery,
+                unsigned *seed)
+{
+    bool *in = snewn(npool, bool);
+    int i, j;
 
-    for (i = 0; i < NSTR; i++)
-        in[i] = 0;
+    for (i = 0; i < npool; i++)
+        in[i] = false;
     array = NULL;
     arraylen = arraysize = 0;
-    tree = newtree234(mycmp);
+    tree = impl->newtree(mycmp);
     cmp = mycmp;
 
     verify();
     searchtest();
-    for (i = 0; i < 10000; i++) {
-        j = randomnumber(&seed);
-        j %= NSTR;
+    for (i = 0; i < ntrials; i++) {
+        j = randomnumber(seed);
+        j %= npool;
         if (verbose)
             printf("trial: %d\n", i);
         if (in[j]) {
             if (verbose)
-                printf("deleting %s (%d)\n", strings[j], j);
-            deltest(strings[j]);
-            in[j] = 0;
+                printf("deleting %s (%d)\n", pool[j], j);
+            deltest(pool[j]);
+            in[j] = false;
         } else {
             if (verbose)
-                printf("adding %s (%d)\n", strings[j], j);
-            addtest(strings[j]);
-            in[j] = 1;
+                printf("adding %s (%d)\n", pool[j], j);
+            addtest(pool[j]);
+            in[j] = true;
+        }
+        if (i % checkevery == 0) {
+            findtest(pool, npool);
+            searchtest();
         }
-        findtest();
-        searchtest();
     }
 
     while (arraylen > 0) {
-        j = randomnumber(&seed);
+        j = randomnumber(seed);
         j %= arraylen;
         deltest(array[j]);
     }
 
-    freetree234(tree);
+    impl->freetree(tree);
+    sfree(array);
+    sfree(in);
+}
 
-    /*
-     * Now try an unsorted tree. We don't really need to test
-     * delpos234 because we know del234 is based on it, so it's
-     * already been tested in the above sorted-tree code; but for
-     * completeness we'll use it to tear down our unsorted tree
-     * once we've built it.
-     */
-    tree = newtree234(NULL);
+/*
+ * Now try an unsorted tree. We don't really need to test delpos234
+ * because we know del234 is based on it, so it's already been tested
+ * in the above sorted-tree code; but for completeness we'll use it to
+ * tear down our unsorted tree once we've built it.
+ */
+void unsortedtest(int ntrials, unsigned *seed)
+{
+    int i, j, k;
+
+    array = NULL;
+    arraylen = arraysize = 0;
+    tree = impl->newtree(NULL);
     cmp = NULL;
     verify();
-    for (i = 0; i < 1000; i++) {
+    for (i = 0; i < ntrials; i++) {
         if (verbose)
             printf("trial: %d\n", i);
-        j = randomnumber(&seed);
+        j = randomnumber(seed);
         j %= NSTR;
-        k = randomnumber(&seed);
-        k %= count234(tree) + 1;
+        k = randomnumber(seed);
+        k %= impl->count(tree) + 1;
         if (verbose)
             printf("adding string %s at index %d\n", strings[j], k);
         addpostest(strings[j], k);
     }
-    while (count234(tree) > 0) {
+    while (impl->count(tree) > 0) {
         if (verbose)
-            printf("cleanup: tree size %d\n", count234(tree));
-        j = randomnumber(&seed);
-        j %= count234(tree);
+            printf("cleanup: tree size %d\n", impl->count(tree));
+        j = randomnumber(seed);
+        j %= impl->count(tree);
         if (verbose)
             printf("deleting string %s from index %d\n",
                    (const char *)array[j], j);
         delpostest(j);
     }
 
+    impl->freetree(tree);
+    sfree(array);
+}
+
+/*
+ * Benchmark: run the same sequence of operations on a tree of n
+ * integers in each implementation, and report how long each phase
+ * took.
+ */
+int intcmp(void *av, void *bv)
+{
+    int a = *(int *)av, b = *(int *)bv;
+    return a < b ? -1 : a > b ? +1 : 0;
+}
+
+double elapsed(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+#define NPHASES 7
+
+void benchmark(int n)
+{
+    static const char *const phases[NPHASES] = {
+        "add", "find", "findrel", "index", "del", "append", "delpos 0",
+    };
+    double times[lenof(impls)][NPHASES];
+    int *keys = snewn(n, int), *order = snewn(n, int);
+    unsigned seed = 0;
+    int i, k, p, probe, index;
+    void *ret;
+
+    /* Even keys, so that odd probes fall between them. */
+    for (i = 0; i < n; i++) {
+        keys[i] = 2 * i;
+        order[i] = i;
+    }
+    for (i = n - 1; i > 0; i--) {
+        int j = ((randomnumber(&seed) << 15) | randomnumber(&seed)) % (i + 1);
+        int tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    for (k = 0; k < lenof(impls); k++) {
+        const treeimpl *ti = &impls[k];
+        tree234 *t;
+        clock_t start;
+
+        p = 0;
+        t = ti->newtree(intcmp);
+
+        start = clock();
+        for (i = 0; i < n; i++)
+            ti->add(t, &keys[order[i]]);
+        times[k][p++] = elapsed(start);
+
+        start = clock();
+        for (i = 0; i < n; i++) {
+            ret = ti->findrelpos(t, &keys[order[i]], NULL, REL234_EQ, NULL);
+            if (ret != &keys[order[i]])
+                error("%s: find(%d) failed", ti->name, keys[order[i]]);
+        }
+        times[k][p++] = elapsed(start);
+
+        start = clock();
+        for (i = 0; i < n; i++) {
+            probe = 2 * order[i] + 1;
+            ret = ti->findrelpos(t, &probe, NULL, REL234_GT, &index);
+            if (order[i] + 1 < n ? ret != &keys[order[i] + 1] : ret != NULL)
+                error("%s: findrel(%d,GT) failed", ti->name, probe);
+        }
+        times[k][p++] = elapsed(start);
+
+        start = clock();
+        for (i = 0; i < n; i++) {
+            ret = ti->index(t, order[i]);
+            if (ret != &keys[order[i]])
+                error("%s: index(%d) failed", ti->name, order[i]);
+        }
+        times[k][p++] = elapsed(start);
+
+        start = clock();
+        for (i = 0; i < n; i++)
+            ti->del(t, &keys[order[i]]);
+        times[k][p++] = elapsed(start);
+
+        ti->freetree(t);
+        t = ti->newtree(NULL);
+
+        start = clock();
+        for (i = 0; i < n; i++)
+            ti->addpos(t, &keys[i], i);
+        times[k][p++] = elapsed(start);
+
+        start = clock();
+        for (i = 0; i < n; i++) {
+            ret = ti->delpos(t, 0);
+            if (ret != &keys[i])
+                error("%s: delpos(0) failed at %d", ti->name, i);
+        }
+        times[k][p++] = elapsed(start);
+
+        ti->freetree(t);
+    }
+
+    printf("%d elements\n%-10s", n, "");
+    for (k = 0; k < lenof(impls); k++)
+        printf(" %10s", impls[k].name);
+    printf("\n");
+    for (p = 0; p < NPHASES; p++) {
+        printf("%-10s", phases[p]);
+        for (k = 0; k < lenof(impls); k++)
+            printf(" %9.3fs", times[k][p]);
+        printf("\n");
+    }
+
+    sfree(keys);
+    sfree(order);
+}
+
+#define NPOOL 4000
+
+int main(int argc, char **argv)
+{
+    char *pool[NPOOL];
+    int i, bench = 0;
+    unsigned seed;
+
+    for (i = 1; i < argc; i++) {
+        char *arg = argv[i];
+        if (!strcmp(arg, "-v")) {
+            verbose++;
+        } else if (!strcmp(arg, "-b")) {
+            bench = 1000000;
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+                bench = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "unrecognised option '%s'\n", arg);
+            return 1;
+        }
+    }
+
+    if (bench) {
+        benchmark(bench);
+        return (n_errors != 0);
+    }
+
+    /*
+     * A bigger set of strings, so that the trees get a few levels
+     * deep even with wide nodes.
+     */
+    for (i = 0; i < NPOOL; i++) {
+        pool[i] = snewn(16, char);
+        sprintf(pool[i], "%d", i);
+    }
+
+    for (i = 0; i < lenof(impls); i++) {
+        impl = &impls[i];
+        if (verbose)
+            printf("testing %s tree\n", impl->name);
+        seed = 0;
+        sortedtest(strings, NSTR, 10000, 1, &seed);
+        unsortedtest(1000, &seed);
+        sortedtest(pool, NPOOL, 8000, 50, &seed);
+    }
+
+    for (i = 0; i < NPOOL; i++)
+        sfree(pool[i]);
+
     printf("%d errors found\n", n_errors);
     return (n_errors != 0);
 }
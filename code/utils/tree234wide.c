@@ -0,0 +1,801 @@
+/*
+ * tree234wide.c: an alternative implementation of the tree234 API,
+ * as a counted B+-tree with wide nodes.
+ *
+ * All the elements live in the leaves, up to NODE234_MAX of them in
+ * one array per leaf, so most of a lookup or an in-order walk touches
+ * a few adjacent cache lines instead of chasing a pointer for every
+ * element. A branch node keeps, for each of its children, the number
+ * of elements in that child's subtree and a copy of the last element
+ * in it, which serves as the separator when searching.
+ *
+ * Separators are pointers to elements still in the tree, and they're
+ * updated whenever the last element of a subtree changes, so the tree
+ * never retains a pointer to an element after it has been deleted
+ * (the caller is entitled to free it straight away).
+ *
+ * This file is built instead of tree234.c if the cmake option
+ * PUTTY_WIDE_TREE234 is set. The test harness in tree234.c links
+ * both, and checks and benchmarks them against each other.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "defs.h"
+
+#ifdef TEST
+/*
+ * In the test harness this file is linked alongside tree234.c, so
+ * rename all its entry points out of the way of the originals.
+ */
+#define newtree234 wide_newtree234
+#define freetree234 wide_freetree234
+#define add234 wide_add234
+#define addpos234 wide_addpos234
+#define index234 wide_index234
+#define find234 wide_find234
+#define findrel234 wide_findrel234
+#define findpos234 wide_findpos234
+#define findrelpos234 wide_findrelpos234
+#define search234_start wide_search234_start
+#define search234_step wide_search234_step
+#define del234 wide_del234
+#define delpos234 wide_delpos234
+#define count234 wide_count234
+#endif
+
+#include "tree234.h"
+#include "puttymem.h"
+
+/*
+ * Maximum number of entries (elements in a leaf, or children of a
+ * branch) in one node. Every node except the root has at least
+ * NODE234_MIN.
+ */
+#define NODE234_MAX 32
+#define NODE234_MIN (NODE234_MAX / 2)
+
+/*
+ * Bound on the number of branch levels, which is far more than a
+ * tree of INT_MAX elements can need with a minimum fanout of 16.
+ */
+#define TREE234_MAXDEPTH 16
+
+typedef struct node234 node234;
+typedef struct branch234 branch234;
+
+struct tree234_Tag {
+    node234 *root;
+    int count;
+    cmpfn234 cmp;
+};
+
+struct node234 {
+    int n;                             /* number of entries in use */
+    bool leaf;
+    /* In a leaf, the elements themselves. In a branch, elems[i] is
+     * the last element of the subtree under kids[i]. */
+    void *elems[NODE234_MAX];
+};
+
+struct branch234 {
+    node234 node;
+    node234 *kids[NODE234_MAX];
+    int counts[NODE234_MAX];
+};
+
+static inline branch234 *branch(node234 *n)
+{
+    assert(!n->leaf);
+    return container_of(n, branch234, node);
+}
+
+/*
+ * A record of the branches passed through on the way down to a leaf,
+ * and which child was taken at each.
+ */
+typedef struct path234 {
+    int depth;
+    branch234 *branches[TREE234_MAXDEPTH];
+    int kidindex[TREE234_MAXDEPTH];
+} path234;
+
+static inline void path_push(path234 *path, branch234 *b, int i)
+{
+    assert(path->depth < TREE234_MAXDEPTH);
+    path->branches[path->depth] = b;
+    path->kidindex[path->depth] = i;
+    path->depth++;
+}
+
+static node234 *newnode234(bool leaf)
+{
+    node234 *n;
+    if (leaf) {
+        n = snew(node234);
+    } else {
+        branch234 *b = snew(branch234);
+        n = &b->node;
+    }
+    n->n = 0;
+    n->leaf = leaf;
+    return n;
+}
+
+static void freenode234(node234 *n)
+{
+    if (n->leaf) {
+        sfree(n);
+    } else {
+        branch234 *b = branch(n);
+        sfree(b);
+    }
+}
+
+static void freesubtree234(node234 *n)
+{
+    if (!n->leaf) {
+        branch234 *b = branch(n);
+        for (int i = 0; i < n->n; i++)
+            freesubtree234(b->kids[i]);
+    }
+    freenode234(n);
+}
+
+static int countnode234(node234 *n)
+{
+    int count = 0;
+    if (n->leaf)
+        return n->n;
+    branch234 *b = branch(n);
+    for (int i = 0; i < n->n; i++)
+        count += b->counts[i];
+    return count;
+}
+
+static inline void *lastelem234(node234 *n)
+{
+    assert(n->n > 0);
+    return n->elems[n->n - 1];
+}
+
+/*
+ * Move the entries of a node from position pos onwards by delta
+ * places (either opening a gap or closing one up), and adjust its
+ * size to match.
+ */
+static void node_shift(node234 *n, int pos, int delta)
+{
+    int len = n->n - pos;
+    memmove(n->elems + pos + delta, n->elems + pos,
+            len * sizeof(*n->elems));
+    if (!n->leaf) {
+        branch234 *b = branch(n);
+        memmove(b->kids + pos + delta, b->kids + pos,
+                len * sizeof(*b->kids));
+        memmove(b->counts + pos + delta, b->counts + pos,
+                len * sizeof(*b->counts));
+    }
+    n->n += delta;
+}
+
+/*
+ * Copy len entries from one node to another of the same kind. The
+ * caller adjusts the sizes.
+ */
+static void node_copy(node234 *dst, int dpos, node234 *src, int spos,
+                      int len)
+{
+    assert(dst->leaf == src->leaf);
+    memcpy(dst->elems + dpos, src->elems + spos, len * sizeof(*dst->elems));
+    if (!dst->leaf) {
+        branch234 *db = branch(dst), *sb = branch(src);
+        memcpy(db->kids + dpos, sb->kids + spos, len * sizeof(*db->kids));
+        memcpy(db->counts + dpos, sb->counts + spos,
+               len * sizeof(*db->counts));
+    }
+}
+
+/*
+ * Insert an entry at position pos of a node: an element if it's a
+ * leaf, or a child with its element count if it's a branch. If the
+ * node is already full, it's split in half first, and the new
+ * right-hand half is returned for the caller to add to the parent.
+ */
+static node234 *node_insert(node234 *n, int pos, void *elem,
+                            node234 *kid, int count)
+{
+    node234 *right = NULL;
+
+    if (n->n == NODE234_MAX) {
+        int half = NODE234_MAX / 2;
+        right = newnode234(n->leaf);
+        node_copy(right, 0, n, half, NODE234_MAX - half);
+        right->n = NODE234_MAX - half;
+        n->n = half;
+        if (pos > half) {
+            n = right;
+            pos -= half;
+        }
+    }
+
+    node_shift(n, pos, +1);
+    n->elems[pos] = elem;
+    if (!n->leaf) {
+        branch234 *b = branch(n);
+        b->kids[pos] = kid;
+        b->counts[pos] = count;
+    }
+    return right;
+}
+
+/*
+ * Create a tree.
+ */
+tree234 *newtree234(cmpfn234 cmp)
+{
+    tree234 *ret = snew(tree234);
+    ret->root = NULL;
+    ret->count = 0;
+    ret->cmp = cmp;
+    return ret;
+}
+
+/*
+ * Free a tree (not including freeing the elements).
+ */
+void freetree234(tree234 *t)
+{
+    if (t->root)
+        freesubtree234(t->root);
+    sfree(t);
+}
+
+/*
+ * Count the elements in a tree.
+ */
+int count234(tree234 *t)
+{
+    return t->count;
+}
+
+/*
+ * Add an element e to a tree t, either in sorted position (if index
+ * is negative) or at the given index. Returns e on success, or if an
+ * existing element compares equal, returns that.
+ */
+static void *add234_internal(tree234 *t, void *e, int index)
+{
+    path234 path;
+    node234 *n, *right;
+    int pos, lo, hi, c;
+
+    if (!t->root)
+        t->root = newnode234(true);
+
+    path.depth = 0;
+    n = t->root;
+    while (!n->leaf) {
+        branch234 *b = branch(n);
+        int i;
+
+        if (index >= 0) {
+            for (i = 0; i < n->n - 1 && index > b->counts[i]; i++)
+                index -= b->counts[i];
+        } else {
+            /* Find the first child whose last element is >= e. */
+            lo = 0;
+            hi = n->n - 1;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                c = t->cmp(e, n->elems[mid]);
+                if (c == 0)
+                    return n->elems[mid];
+                if (c < 0)
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            i = lo;
+        }
+
+        path_push(&path, b, i);
+        n = b->kids[i];
+    }
+
+    if (index >= 0) {
+        pos = index;
+    } else {
+        lo = 0;
+        hi = n->n;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            c = t->cmp(e, n->elems[mid]);
+            if (c == 0)
+                return n->elems[mid];
+            if (c < 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        pos = lo;
+    }
+
+    right = node_insert(n, pos, e, NULL, 0);
+
+    /*
+     * Work back up the tree, updating the counts and separators, and
+     * adding the right half of any node that was split to its parent.
+     */
+    while (path.depth > 0) {
+        path.depth--;
+        branch234 *b = path.branches[path.depth];
+        int i = path.kidindex[path.depth];
+        node234 *kid = b->kids[i];
+
+        b->node.elems[i] = lastelem234(kid);
+        if (right) {
+            b->counts[i] = countnode234(kid);
+            right = node_insert(&b->node, i + 1, lastelem234(right),
+                                right, countnode234(right));
+        } else {
+            b->counts[i]++;
+        }
+    }
+
+    if (right) {
+        /* The root was split, so the tree grows a level. */
+        node234 *left = t->root;
+        branch234 *b = branch(newnode234(false));
+        b->node.n = 2;
+        b->kids[0] = left;
+        b->counts[0] = countnode234(left);
+        b->node.elems[0] = lastelem234(left);
+        b->kids[1] = right;
+        b->counts[1] = countnode234(right);
+        b->node.elems[1] = lastelem234(right);
+        t->root = &b->node;
+    }
+
+    t->count++;
+    return e;
+}
+
+void *add234(tree234 *t, void *e)
+{
+    if (!t->cmp)                       /* tree is unsorted */
+        return NULL;
+
+    return add234_internal(t, e, -1);
+}
+void *addpos234(tree234 *t, void *e, int index)
+{
+    if (index < 0 || index > t->count || /* index out of range */
+        t->cmp)                        /* tree is sorted */
+        return NULL;                   /* return failure */
+
+    return add234_internal(t, e, index);
+}
+
+/*
+ * Look up the element at a given numeric index in a tree. Returns
+ * NULL if the index is out of range.
+ */
+void *index234(tree234 *t, int index)
+{
+    node234 *n;
+
+    if (index < 0 || index >= t->count)
+        return NULL;                   /* out of range (or empty tree) */
+
+    n = t->root;
+    while (!n->leaf) {
+        branch234 *b = branch(n);
+        int i;
+        for (i = 0; index >= b->counts[i]; i++)
+            index -= b->counts[i];
+        n = b->kids[i];
+    }
+
+    return n->elems[index];
+}
+
+/*
+ * Compare a query element with an element of the tree, inventing a
+ * fixed result if the query is null, and pretending an equal element
+ * is slightly too big or small if the search relation doesn't permit
+ * equality.
+ */
+static inline int findcmp234(cmpfn234 cmp, void *e, void *elem,
+                             int reldir, bool equal_permitted)
+{
+    int c = (e ? cmp(e, elem) : -reldir);
+    return (c == 0 && !equal_permitted) ? reldir : c;
+}
+
+/*
+ * Find an element e in a sorted tree t. The semantics are exactly as
+ * in tree234.c, but rather than going through search234, we descend
+ * the tree directly, so that the index of each child we pass through
+ * only has to be worked out once.
+ */
+void *findrelpos234(tree234 *t, void *e, cmpfn234 cmp,
+                    int relation, int *index)
+{
+    int reldir = (relation == REL234_LT || relation == REL234_LE ? -1 :
+                  relation == REL234_GT || relation == REL234_GE ? +1 : 0);
+    bool equal_permitted = (relation != REL234_LT && relation != REL234_GT);
+    node234 *n;
+    int base, lo, hi, mid, c;
+    void *toret;
+
+    /* Only LT / GT relations are permitted with a null query element. */
+    assert(!(equal_permitted && !e));
+
+    if (cmp == NULL)
+        cmp = t->cmp;
+
+    if (!t->root)
+        return NULL;                   /* tree is empty */
+
+    base = 0;
+    n = t->root;
+    while (!n->leaf) {
+        branch234 *b = branch(n);
+        lo = 0;
+        hi = n->n - 1;
+        while (lo < hi) {
+            mid = (lo + hi) / 2;
+            c = findcmp234(cmp, e, n->elems[mid], reldir, equal_permitted);
+            if (c == 0) {
+                if (index) {
+                    for (int i = 0; i <= mid; i++)
+                        base += b->counts[i];
+                    *index = base - 1;
+                }
+                return n->elems[mid];
+            }
+            if (c < 0)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        for (int i = 0; i < lo; i++)
+            base += b->counts[i];
+        n = b->kids[lo];
+    }
+
+    lo = 0;
+    hi = n->n;
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        c = findcmp234(cmp, e, n->elems[mid], reldir, equal_permitted);
+        if (c == 0) {
+            if (index)
+                *index = base + mid;
+            return n->elems[mid];
+        }
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    /*
+     * Nothing compared equal, but base+lo is the index the query
+     * element would have if it were inserted. Return the element
+     * before or at that index, according to the search direction.
+     */
+    if (relation == REL234_EQ)
+        return NULL;
+
+    if (relation == REL234_LT || relation == REL234_LE)
+        lo--;
+
+    toret = index234(t, base + lo);
+    if (toret && index)
+        *index = base + lo;
+    return toret;
+}
+void *find234(tree234 *t, void *e, cmpfn234 cmp)
+{
+    return findrelpos234(t, e, cmp, REL234_EQ, NULL);
+}
+void *findrel234(tree234 *t, void *e, cmpfn234 cmp, int relation)
+{
+    return findrelpos234(t, e, cmp, relation, NULL);
+}
+void *findpos234(tree234 *t, void *e, cmpfn234 cmp, int *index)
+{
+    return findrelpos234(t, e, cmp, REL234_EQ, index);
+}
+
+/*
+ * The search234 state for this implementation:
+ *
+ *  - _node is the node we're currently in, and _base is the index of
+ *    the first element in its subtree.
+ *
+ *  - _lo and _hi bound the entries of that node still in the running:
+ *    elements of a leaf, or children of a branch.
+ *
+ *  - _last is the index of the lowest element the client has already
+ *    rejected as too big (or INT_MAX). We need it because rejecting
+ *    a branch's separator doesn't rule out the rest of that child's
+ *    subtree, but does rule out the separator itself, which is the
+ *    last element of some leaf further down.
+ *
+ * In a leaf, the element offered is the middle one of [_lo,_hi]. In a
+ * branch with _lo < _hi, it's the separator after the middle child,
+ * which may be _lo but is never _hi.
+ */
+static int search234_sepindex(search234_state *state, int i)
+{
+    branch234 *b = branch(state->_node);
+    int index = state->_base - 1;
+    for (int j = 0; j <= i; j++)
+        index += b->counts[j];
+    return index;
+}
+
+static void search234_settle(search234_state *state)
+{
+    node234 *node = state->_node;
+    int mid;
+
+    if (!node) {
+        state->element = NULL;
+        state->index = 0;
+        return;
+    }
+
+    while (!node->leaf && state->_lo == state->_hi) {
+        /*
+         * We've narrowed down to a single child, so descend to it.
+         */
+        branch234 *b = branch(node);
+        for (int i = 0; i < state->_lo; i++)
+            state->_base += b->counts[i];
+        state->_node = node = b->kids[state->_lo];
+        state->_lo = 0;
+        state->_hi = node->n - 1;
+        if (node->leaf && state->_hi >= state->_last - state->_base)
+            state->_hi = state->_last - state->_base - 1;
+    }
+
+    mid = (state->_lo + state->_hi) / 2;
+    if (node->leaf) {
+        if (state->_lo > state->_hi) {
+            state->element = NULL;
+            state->index = state->_base + state->_lo;
+        } else {
+            state->element = node->elems[mid];
+            state->index = state->_base + mid;
+        }
+    } else {
+        state->element = node->elems[mid];
+        state->index = search234_sepindex(state, mid);
+    }
+}
+
+void search234_start(search234_state *state, tree234 *t)
+{
+    state->_node = t->root;
+    state->_base = 0;
+    state->_last = INT_MAX;
+    state->_lo = 0;
+    state->_hi = t->root ? t->root->n - 1 : 0;
+    search234_settle(state);
+}
+void search234_step(search234_state *state, int direction)
+{
+    node234 *node = state->_node;
+    int mid;
+
+    if (!node) {
+        state->element = NULL;
+        state->index = 0;
+        return;
+    }
+
+    assert(direction);
+    mid = (state->_lo + state->_hi) / 2;
+    if (node->leaf) {
+        if (direction > 0)
+            state->_lo = mid + 1;
+        else
+            state->_hi = mid - 1;
+    } else {
+        if (direction > 0) {
+            state->_lo = mid + 1;
+        } else {
+            state->_hi = mid;
+            state->_last = search234_sepindex(state, mid);
+        }
+    }
+    search234_settle(state);
+}
+
+/*
+ * Top up the underfull child i of a branch, by taking entries from a
+ * neighbouring child, or merging the two if there aren't enough to go
+ * round.
+ */
+static void rebalance234(branch234 *b, int i)
+{
+    int li = (i + 1 < b->node.n ? i : i - 1);
+    node234 *l = b->kids[li], *r = b->kids[li + 1];
+
+    if (l->n + r->n <= NODE234_MAX) {
+        node_copy(l, l->n, r, 0, r->n);
+        l->n += r->n;
+        b->counts[li] += b->counts[li + 1];
+        b->node.elems[li] = lastelem234(l);
+        freenode234(r);
+        node_shift(&b->node, li + 2, -1);
+    } else {
+        int target = (l->n + r->n) / 2;
+        if (l->n < target) {
+            int k = target - l->n;
+            node_copy(l, l->n, r, 0, k);
+            l->n += k;
+            node_shift(r, k, -k);
+        } else {
+            int k = l->n - target;
+            node_shift(r, 0, +k);
+            node_copy(r, 0, l, l->n - k, k);
+            l->n -= k;
+        }
+        b->counts[li] = countnode234(l);
+        b->counts[li + 1] = countnode234(r);
+        b->node.elems[li] = lastelem234(l);
+        b->node.elems[li + 1] = lastelem234(r);
+    }
+}
+
+/*
+ * Delete an element from a tree, by index. Does not free the
+ * element, merely removes all links to it from the tree nodes.
+ */
+static void *delpos234_internal(tree234 *t, int index)
+{
+    path234 path;
+    node234 *n;
+    void *retval;
+
+    path.depth = 0;
+    n = t->root;
+    while (!n->leaf) {
+        branch234 *b = branch(n);
+        int i;
+        for (i = 0; index >= b->counts[i]; i++)
+            index -= b->counts[i];
+        path_push(&path, b, i);
+        n = b->kids[i];
+    }
+
+    retval = n->elems[index];
+    node_shift(n, index + 1, -1);
+
+    while (path.depth > 0) {
+        path.depth--;
+        branch234 *b = path.branches[path.depth];
+        int i = path.kidindex[path.depth];
+        node234 *kid = b->kids[i];
+
+        b->counts[i]--;
+        if (kid->n < NODE234_MIN)
+            rebalance234(b, i);
+        else
+            b->node.elems[i] = lastelem234(kid);
+    }
+
+    n = t->root;
+    if (n->leaf && n->n == 0) {
+        freenode234(n);
+        t->root = NULL;
+    } else if (!n->leaf && n->n == 1) {
+        /* The root is down to one child, so the tree shrinks a level. */
+        t->root = branch(n)->kids[0];
+        freenode234(n);
+    }
+
+    t->count--;
+    return retval;
+}
+void *delpos234(tree234 *t, int index)
+{
+    if (index < 0 || index >= t->count)
+        return NULL;
+    return delpos234_internal(t, index);
+}
+void *del234(tree234 *t, void *e)
+{
+    int index;
+    if (!findrelpos234(t, e, NULL, REL234_EQ, &index))
+        return NULL;                   /* it wasn't in there anyway */
+    return delpos234_internal(t, index);        /* it's there; delete it. */
+}
+
+#ifdef TEST
+
+/*
+ * Structure check for the test harness in tree234.c, which provides
+ * error(). Returns the number of elements found in the tree.
+ */
+PRINTF_LIKE(1, 2) void error(char *fmt, ...);
+
+typedef struct {
+    cmpfn234 cmp;
+    int treedepth;
+    void *prev;                        /* last element seen in order */
+} wide_chkctx;
+
+static int wide_chknode(wide_chkctx *ctx, int level, node234 *node,
+                        bool root, void **last)
+{
+    int i, count;
+
+    if (node->n < (root ? (node->leaf ? 1 : 2) : NODE234_MIN) ||
+        node->n > NODE234_MAX)
+        error("node %p: %d entries out of range", node, node->n);
+
+    if (node->leaf) {
+        if (ctx->treedepth < 0)
+            ctx->treedepth = level;
+        else if (ctx->treedepth != level)
+            error("node %p: leaf at depth %d, previously seen depth %d",
+                  node, level, ctx->treedepth);
+
+        for (i = 0; i < node->n; i++) {
+            if (!node->elems[i])
+                error("node %p: elems[%d] is NULL", node, i);
+            if (ctx->cmp && ctx->prev && ctx->cmp(ctx->prev,
+                                                  node->elems[i]) >= 0)
+                error("node %p: ordering failed at elems[%d]=%s",
+                      node, i, (char *)node->elems[i]);
+            ctx->prev = node->elems[i];
+        }
+        *last = node->n ? node->elems[node->n - 1] : NULL;
+        return node->n;
+    }
+
+    branch234 *b = branch(node);
+    count = 0;
+    *last = NULL;
+    for (i = 0; i < node->n; i++) {
+        int subcount = wide_chknode(ctx, level + 1, b->kids[i],
+                                    false, last);
+        if (b->counts[i] != subcount)
+            error("node %p kid %d: count says %d, subtree really has %d",
+                  node, i, b->counts[i], subcount);
+        if (node->elems[i] != *last)
+            error("node %p kid %d: separator %p is not last element %p",
+                  node, i, node->elems[i], *last);
+        count += subcount;
+    }
+    return count;
+}
+
+int wide_chktree234(tree234 *t, cmpfn234 cmp, int *depth)
+{
+    wide_chkctx ctx[1];
+    void *last;
+    int count = 0;
+
+    ctx->cmp = cmp;
+    ctx->treedepth = -1;
+    ctx->prev = NULL;
+    if (t->root)
+        count = wide_chknode(ctx, 0, t->root, true, &last);
+    if (t->count != count)
+        error("tree count says %d, tree really has %d", t->count, count);
+    *depth = ctx->treedepth;
+    return count;
+}
+
+#endif /* TEST */
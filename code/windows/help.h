@@ -103,9 +103,11 @@ typedef const char *HelpCtx;
 #define WINHELP_CTX_ssh_ttymodes "config-ttymodes"
 #define WINHELP_CTX_ssh_noshell "config-ssh-noshell"
 #define WINHELP_CTX_ssh_ciphers "config-ssh-encryption"
+#define WINHELP_CTX_ssh_cipher_threads "config-ssh-cipher-threads"
 #define WINHELP_CTX_ssh_protocol "config-ssh-prot"
 #define WINHELP_CTX_ssh_command "config-command"
 #define WINHELP_CTX_ssh_compress "config-ssh-comp"
+#define WINHELP_CTX_ssh_compress_thread "config-ssh-comp-thread"
 #define WINHELP_CTX_ssh_share "config-ssh-sharing"
 #define WINHELP_CTX_ssh_kexlist "config-ssh-kex-order"
 #define WINHELP_CTX_ssh_hklist "config-ssh-hostkey-order"
@@ -192,6 +192,17 @@ void centre_window(HWND hwnd);
 #define CURSORBLINK GetCaretBlinkTime()
 #define TICKSPERSEC 1000               /* GetTickCount returns milliseconds */
 
+/*
+ * Atomic operations on pointers shared between threads, with full
+ * memory barriers. Both return the previous value of *pp.
+ * ATOMIC_PTR_CAS replaces it with newval only if it was oldval;
+ * ATOMIC_PTR_SWAP replaces it unconditionally.
+ */
+#define ATOMIC_PTR_CAS(pp, oldval, newval)                              \
+    InterlockedCompareExchangePointer((PVOID volatile *)(pp), newval, oldval)
+#define ATOMIC_PTR_SWAP(pp, newval)                                     \
+    InterlockedExchangePointer((PVOID volatile *)(pp), newval)
+
 #define DEFAULT_CODEPAGE CP_ACP
 #define USES_VTLINE_HACK
 
@@ -160,6 +160,10 @@ static void usage(void)
     printf("  -1 -2     force use of particular SSH protocol version\n");
     printf("  -4 -6     force use of IPv4 or IPv6\n");
     printf("  -C        enable compression\n");
+    printf("  -compress-thread\n");
+    printf("            compress on a separate thread (SSH-2 only)\n");
+    printf("  -cipher-threads n\n");
+    printf("            encrypt on up to n worker threads (SSH-2 only)\n");
     printf("  -i key    private key file for user authentication\n");
     printf("  -noagent  disable use of Pageant\n");
     printf("  -agent    enable use of Pageant\n");
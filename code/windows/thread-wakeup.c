@@ -0,0 +1,38 @@
+/*
+ * Wake up the main thread's event loop from another thread, so that
+ * it collects callbacks queued by queue_toplevel_callback_from_thread.
+ *
+ * We use an auto-reset event object watched by handle-wait.c, which
+ * every Windows event loop (cliloop.c and the GUI message loops)
+ * already services.
+ */
+
+#include "putty.h"
+
+static HANDLE wakeup_event = NULL;
+
+static void thread_wakeup(void);
+
+static void thread_wakeup_callback(void *ctx)
+{
+    /* The event reset itself when the wait on it was satisfied */
+    collect_toplevel_callbacks_from_threads();
+}
+
+void thread_wakeup_setup(void)
+{
+    if (wakeup_event)
+        return;                        /* already done */
+
+    wakeup_event = CreateEvent(NULL, false, false, NULL);
+    if (!wakeup_event)
+        modalfatalbox("Unable to create event object: %s",
+                      win_strerror(GetLastError()));
+    add_handle_wait(wakeup_event, thread_wakeup_callback, NULL);
+    request_thread_wakeups(thread_wakeup);
+}
+
+static void thread_wakeup(void)
+{
+    SetEvent(wakeup_event);
+}
@@ -43,3 +43,8 @@ bool platform_sha512_neon_available(void)
      * SHA-512 architecture extension. */
     return false;
 }
+
+bool platform_crc32_neon_available(void)
+{
+    return IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE);
+}
@@ -0,0 +1,89 @@
+/*
+ * Windows implementation of SpillFile, using a delete-on-close
+ * temporary file and a file mapping.
+ */
+
+#include "putty.h"
+
+struct SpillFile {
+    HANDLE file;
+    HANDLE mapping;                    /* covers nsegs segments */
+    size_t segsize;
+    size_t nsegs;
+};
+
+SpillFile *spillfile_new(size_t segsize)
+{
+    HANDLE file = INVALID_HANDLE_VALUE;
+
+    assert(segsize > 0 && segsize % SPILLFILE_GRANULARITY == 0);
+
+    /* GetTempPath is documented as returning a size of up to
+     * MAX_PATH+1 which does not count the NUL */
+    char tempdir[MAX_PATH + 2];
+    if (GetTempPath(sizeof(tempdir), tempdir) == 0)
+        return NULL;
+
+    unsigned long pid = GetCurrentProcessId();
+
+    for (uint64_t counter = 0;; counter++) {
+        char *filename = dupprintf(
+            "%s\\putty_%lu_%"PRIu64".scrollback", tempdir, pid, counter);
+        file = CreateFile(
+            filename, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_NEW,
+            FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+        sfree(filename);
+
+        if (file != INVALID_HANDLE_VALUE)
+            break;                     /* success! */
+
+        if (GetLastError() != ERROR_FILE_EXISTS)
+            return NULL;               /* failed for some other reason! */
+    }
+
+    SpillFile *sf = snew(SpillFile);
+    sf->file = file;
+    sf->mapping = NULL;
+    sf->segsize = segsize;
+    sf->nsegs = 0;
+    return sf;
+}
+
+void spillfile_free(SpillFile *sf)
+{
+    if (sf->mapping)
+        CloseHandle(sf->mapping);
+    CloseHandle(sf->file);
+    sfree(sf);
+}
+
+void *spillfile_map(SpillFile *sf, size_t seg)
+{
+    uint64_t offset = (uint64_t)seg * sf->segsize;
+
+    if (seg >= sf->nsegs) {
+        /*
+         * A file mapping object can't be made bigger, so replace it
+         * with a bigger one, which extends the file. Views of the old
+         * one remain valid until they're unmapped.
+         */
+        uint64_t size = offset + sf->segsize;
+        HANDLE mapping = CreateFileMapping(
+            sf->file, NULL, PAGE_READWRITE,
+            (DWORD)(size >> 32), (DWORD)size, NULL);
+        if (!mapping)
+            return NULL;
+        if (sf->mapping)
+            CloseHandle(sf->mapping);
+        sf->mapping = mapping;
+        sf->nsegs = seg + 1;
+    }
+
+    return MapViewOfFile(sf->mapping, FILE_MAP_WRITE,
+                         (DWORD)(offset >> 32), (DWORD)offset, sf->segsize);
+}
+
+void spillfile_unmap(SpillFile *sf, void *p)
+{
+    UnmapViewOfFile(p);
+}
@@ -0,0 +1,103 @@
+/*
+ * Windows primitives for the worker threads in worker-thread.c.
+ *
+ * Each WorkerSyncCond is an auto-reset event. worker_sync_wait leaves
+ * the critical section before waiting on the event, so a signal sent
+ * in between leaves the event set and the wait returns at once; and
+ * a signal sent when nobody was waiting only causes a spurious wakeup
+ * later, which worker-thread.c allows for.
+ */
+
+#include "putty.h"
+#include "worker-thread.h"
+
+struct WorkerSync {
+    CRITICAL_SECTION critsec;
+    HANDLE events[WSC_COUNT];
+};
+
+WorkerSync *worker_sync_new(void)
+{
+    WorkerSync *ws = snew(WorkerSync);
+    InitializeCriticalSection(&ws->critsec);
+    for (size_t i = 0; i < WSC_COUNT; i++) {
+        ws->events[i] = CreateEvent(NULL, false, false, NULL);
+        if (!ws->events[i])
+            modalfatalbox("Unable to create event object: %s",
+                          win_strerror(GetLastError()));
+    }
+    return ws;
+}
+
+void worker_sync_free(WorkerSync *ws)
+{
+    for (size_t i = 0; i < WSC_COUNT; i++)
+        CloseHandle(ws->events[i]);
+    DeleteCriticalSection(&ws->critsec);
+    sfree(ws);
+}
+
+void worker_sync_lock(WorkerSync *ws)
+{
+    EnterCriticalSection(&ws->critsec);
+}
+
+void worker_sync_unlock(WorkerSync *ws)
+{
+    LeaveCriticalSection(&ws->critsec);
+}
+
+void worker_sync_wait(WorkerSync *ws, WorkerSyncCond cond)
+{
+    LeaveCriticalSection(&ws->critsec);
+    WaitForSingleObject(ws->events[cond], INFINITE);
+    EnterCriticalSection(&ws->critsec);
+}
+
+void worker_sync_signal(WorkerSync *ws, WorkerSyncCond cond)
+{
+    SetEvent(ws->events[cond]);
+}
+
+struct WorkerOSThread {
+    HANDLE thread;
+    void (*fn)(void *ctx);
+    void *ctx;
+};
+
+static DWORD WINAPI worker_os_thread_main(void *vctx)
+{
+    WorkerOSThread *t = (WorkerOSThread *)vctx;
+    t->fn(t->ctx);
+    return 0;
+}
+
+WorkerOSThread *worker_os_thread_start(void (*fn)(void *ctx), void *ctx)
+{
+    WorkerOSThread *t = snew(WorkerOSThread);
+    t->fn = fn;
+    t->ctx = ctx;
+
+    DWORD thread_id;
+    t->thread = CreateThread(NULL, 0, worker_os_thread_main, t, 0,
+                             &thread_id);
+    if (!t->thread)
+        modalfatalbox("Unable to create worker thread: %s",
+                      win_strerror(GetLastError()));
+
+    return t;
+}
+
+void worker_os_thread_join(WorkerOSThread *t)
+{
+    WaitForSingleObject(t->thread, INFINITE);
+    CloseHandle(t->thread);
+    sfree(t);
+}
+
+unsigned worker_thread_cpus(void)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 1 ? si.dwNumberOfProcessors : 1;
+}
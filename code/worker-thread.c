@@ -0,0 +1,161 @@
+/*
+ * Run jobs on a worker thread, passing each one back to the main
+ * thread when it's finished. See the comment in putty.h.
+ *
+ * Jobs move from the input queue, to the worker thread, to the
+ * output queue, all under one lock. The worker sleeps on one
+ * condition while the input queue is empty; the main thread sleeps
+ * on the other in worker_thread_wait. The lock, the conditions and
+ * the thread itself come from the platform, via worker-thread.h.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "putty.h"
+#include "worker-thread.h"
+
+typedef struct WorkerJob WorkerJob;
+struct WorkerJob {
+    void *job;
+    WorkerJob *next;
+};
+
+typedef struct WorkerJobQueue {
+    WorkerJob *head, *tail;
+} WorkerJobQueue;
+
+struct WorkerThread {
+    worker_job_fn_t fn;
+    toplevel_callback_fn_t notify;
+    void *notify_ctx;
+
+    WorkerOSThread *thread;
+    WorkerSync *sync;
+
+    /* Everything below is protected by the lock in 'sync' */
+    WorkerJobQueue in, out;
+    size_t unfinished;                 /* submitted but not yet on 'out' */
+    bool exiting;
+};
+
+static void jobqueue_push(WorkerJobQueue *q, WorkerJob *j)
+{
+    j->next = NULL;
+    if (q->tail)
+        q->tail->next = j;
+    else
+        q->head = j;
+    q->tail = j;
+}
+
+static WorkerJob *jobqueue_pop(WorkerJobQueue *q)
+{
+    WorkerJob *j = q->head;
+    if (j) {
+        q->head = j->next;
+        if (!q->head)
+            q->tail = NULL;
+    }
+    return j;
+}
+
+static void worker_thread_main(void *vctx)
+{
+    WorkerThread *wt = (WorkerThread *)vctx;
+
+    worker_sync_lock(wt->sync);
+    while (true) {
+        while (!wt->in.head && !wt->exiting)
+            worker_sync_wait(wt->sync, WSC_WORK);
+        if (!wt->in.head)
+            break;                     /* exiting, and nothing left to do */
+
+        WorkerJob *j = jobqueue_pop(&wt->in);
+        worker_sync_unlock(wt->sync);
+        wt->fn(j->job);
+        worker_sync_lock(wt->sync);
+
+        /*
+         * Only notify the main thread when the output queue becomes
+         * non-empty. It collects everything in one go, so further
+         * notifications until then would be redundant.
+         */
+        bool notify = !wt->out.head;
+        jobqueue_push(&wt->out, j);
+        if (--wt->unfinished == 0)
+            worker_sync_signal(wt->sync, WSC_IDLE);
+        if (notify)
+            queue_toplevel_callback_from_thread(wt->notify, wt->notify_ctx);
+    }
+    worker_sync_unlock(wt->sync);
+}
+
+WorkerThread *worker_thread_new(worker_job_fn_t fn,
+                                toplevel_callback_fn_t notify,
+                                void *notify_ctx)
+{
+    WorkerThread *wt = snew(WorkerThread);
+    memset(wt, 0, sizeof(*wt));
+    wt->fn = fn;
+    wt->notify = notify;
+    wt->notify_ctx = notify_ctx;
+
+    thread_wakeup_setup();
+
+    wt->sync = worker_sync_new();
+    wt->thread = worker_os_thread_start(worker_thread_main, wt);
+
+    return wt;
+}
+
+void worker_thread_submit(WorkerThread *wt, void *job)
+{
+    WorkerJob *j = snew(WorkerJob);
+    j->job = job;
+
+    worker_sync_lock(wt->sync);
+    jobqueue_push(&wt->in, j);
+    wt->unfinished++;
+    worker_sync_signal(wt->sync, WSC_WORK);
+    worker_sync_unlock(wt->sync);
+}
+
+void *worker_thread_collect(WorkerThread *wt)
+{
+    worker_sync_lock(wt->sync);
+    WorkerJob *j = jobqueue_pop(&wt->out);
+    worker_sync_unlock(wt->sync);
+
+    if (!j)
+        return NULL;
+
+    void *job = j->job;
+    sfree(j);
+    return job;
+}
+
+void worker_thread_wait(WorkerThread *wt)
+{
+    worker_sync_lock(wt->sync);
+    while (wt->unfinished)
+        worker_sync_wait(wt->sync, WSC_IDLE);
+    worker_sync_unlock(wt->sync);
+}
+
+void worker_thread_free(WorkerThread *wt)
+{
+    worker_sync_lock(wt->sync);
+    assert(!wt->unfinished && !wt->out.head);
+    wt->exiting = true;
+    worker_sync_signal(wt->sync, WSC_WORK);
+    worker_sync_unlock(wt->sync);
+
+    worker_os_thread_join(wt->thread);
+
+    /* Discard any notification that hasn't been acted on yet */
+    delete_callbacks_for_context(wt->notify_ctx);
+
+    worker_sync_free(wt->sync);
+    sfree(wt);
+}
@@ -0,0 +1,39 @@
+/*
+ * Primitives each platform provides for worker-thread.c, which
+ * implements the worker thread API described in putty.h on top of
+ * them.
+ */
+
+#ifndef PUTTY_WORKER_THREAD_H
+#define PUTTY_WORKER_THREAD_H
+
+/*
+ * A lock with two condition variables attached, named by
+ * WorkerSyncCond. worker_sync_wait must be called with the lock held;
+ * it releases the lock while it sleeps, and takes it again before
+ * returning. It may return without having been signalled, so callers
+ * must check their condition in a loop. Each condition has at most
+ * one thread waiting on it at a time.
+ */
+typedef enum WorkerSyncCond {
+    WSC_WORK,                          /* input queue non-empty, or exiting */
+    WSC_IDLE,                          /* all submitted jobs finished */
+    WSC_COUNT
+} WorkerSyncCond;
+
+typedef struct WorkerSync WorkerSync;
+WorkerSync *worker_sync_new(void);
+void worker_sync_free(WorkerSync *ws);
+void worker_sync_lock(WorkerSync *ws);
+void worker_sync_unlock(WorkerSync *ws);
+void worker_sync_wait(WorkerSync *ws, WorkerSyncCond cond);
+void worker_sync_signal(WorkerSync *ws, WorkerSyncCond cond);
+
+/*
+ * Start a thread running fn(ctx), and wait for it to return.
+ */
+typedef struct WorkerOSThread WorkerOSThread;
+WorkerOSThread *worker_os_thread_start(void (*fn)(void *ctx), void *ctx);
+void worker_os_thread_join(WorkerOSThread *t);
+
+#endif